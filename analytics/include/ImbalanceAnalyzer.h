@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Order.h"
+#include "SeriesKernels.h"
 #include <vector>
 #include <numeric>
 #include <cmath>
@@ -206,32 +207,13 @@ private:
 
     RegressionResult simple_regression(const std::vector<double>& x,
                                         const std::vector<double>& y) const {
-        size_t n = x.size();
-        double mean_x = std::accumulate(x.begin(), x.end(), 0.0) / n;
-        double mean_y = std::accumulate(y.begin(), y.end(), 0.0) / n;
-
-        double ss_xy = 0, ss_xx = 0, ss_yy = 0;
-        for (size_t i = 0; i < n; ++i) {
-            double dx = x[i] - mean_x;
-            double dy = y[i] - mean_y;
-            ss_xy += dx * dy;
-            ss_xx += dx * dx;
-            ss_yy += dy * dy;
-        }
-
-        if (ss_xx == 0) return {0, 0, 0};
+        const auto m = kernels::cross_moments(x, y);
+        if (m.sxx == 0) return {0, 0, 0};
 
-        double beta = ss_xy / ss_xx;
-        double alpha = mean_y - beta * mean_x;
-        double r2 = (ss_yy > 0) ? (ss_xy * ss_xy) / (ss_xx * ss_yy) : 0;
-
-        double sse = 0;
-        for (size_t i = 0; i < n; ++i) {
-            double res = y[i] - alpha - beta * x[i];
-            sse += res * res;
-        }
-        double se = std::sqrt(sse / ((n-2) * ss_xx));
-        double t = (se > 0) ? beta / se : 0;
+        const double beta = m.slope();
+        const double r2 = m.r_squared();
+        const double se = m.std_error();
+        const double t = (se > 0) ? beta / se : 0;
 
         return {beta, r2, t};
     }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Order.h"
+#include "SeriesKernels.h"
 #include <vector>
 #include <numeric>
 #include <cmath>
@@ -103,10 +104,11 @@ public:
             delta_x[bucket] += signed_vol;
         }
 
-        // Compute price changes between interval boundaries
-        for (size_t i = 1; i < num_intervals; ++i) {
-            double t_start = (i - 1) * interval_sec;
-            double t_end   = i * interval_sec;
+        // Price change across each interval: the flow in [iT, (i+1)T) is
+        // regressed on the mid move over the same span, not the one before.
+        for (size_t i = 0; i < num_intervals; ++i) {
+            double t_start = i * interval_sec;
+            double t_end   = (i + 1) * interval_sec;
 
             Price p_start = find_nearest_mid(timed_midprices, t_start);
             Price p_end   = find_nearest_mid(timed_midprices, t_end);
@@ -115,9 +117,8 @@ public:
         }
 
         // ── OLS Regression: ΔP = α + λ · ΔX + ε ──
-        // Skip first interval (no ΔP available)
         std::vector<double> x, y;
-        for (size_t i = 1; i < num_intervals; ++i) {
+        for (size_t i = 0; i < num_intervals; ++i) {
             if (delta_x[i] != 0.0) {  // Skip empty intervals
                 x.push_back(delta_x[i]);
                 y.push_back(delta_p[i]);
@@ -202,39 +203,13 @@ private:
 
         result.num_intervals = n;
 
-        // Compute means
-        double mean_x = std::accumulate(x.begin(), x.end(), 0.0) / n;
-        double mean_y = std::accumulate(y.begin(), y.end(), 0.0) / n;
-
-        // Compute slope (lambda) and intercept (alpha)
-        double ss_xy = 0, ss_xx = 0, ss_yy = 0;
-        for (size_t i = 0; i < n; ++i) {
-            double dx = x[i] - mean_x;
-            double dy = y[i] - mean_y;
-            ss_xy += dx * dy;
-            ss_xx += dx * dx;
-            ss_yy += dy * dy;
-        }
-
-        if (ss_xx == 0) return result;
-
-        result.lambda = ss_xy / ss_xx;
-        result.alpha = mean_y - result.lambda * mean_x;
-
-        // R²
-        if (ss_yy > 0) {
-            result.r_squared = (ss_xy * ss_xy) / (ss_xx * ss_yy);
-        }
-
-        // Standard error and t-statistic
-        double sse = 0;
-        for (size_t i = 0; i < n; ++i) {
-            double residual = y[i] - result.alpha - result.lambda * x[i];
-            sse += residual * residual;
-        }
-        double mse = sse / (n - 2);
-        result.std_error = std::sqrt(mse / ss_xx);
+        const auto m = kernels::cross_moments(x, y);
+        if (m.sxx == 0) return result;
 
+        result.lambda      = m.slope();
+        result.alpha       = m.intercept();
+        result.r_squared   = m.r_squared();
+        result.std_error   = m.std_error();
         if (result.std_error > 0) {
             result.t_statistic = result.lambda / result.std_error;
         }
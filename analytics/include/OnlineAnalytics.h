@@ -0,0 +1,406 @@
+#pragma once
+
+#include "FeedMessage.h"
+#include "SpreadAnalyzer.h"
+#include "ImpactAnalyzer.h"
+#include "ImbalanceAnalyzer.h"
+#include "LatencyRecorder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace micro_exchange::analytics {
+
+/**
+ * Simple OLS of y on x from running means and co-moments — Welford's
+ * update with the cross term added. One pass, O(1) memory, and the same
+ * estimates as the two-pass batch regressions up to rounding.
+ */
+class RunningRegression {
+public:
+    void add(double x, double y) noexcept {
+        ++n_;
+        const double k  = 1.0 / static_cast<double>(n_);
+        const double dx = x - mean_x_;
+        const double dy = y - mean_y_;
+        mean_x_ += dx * k;
+        mean_y_ += dy * k;
+        sxx_ += dx * (x - mean_x_);
+        syy_ += dy * (y - mean_y_);
+        sxy_ += dx * (y - mean_y_);
+    }
+
+    [[nodiscard]] uint64_t n()   const noexcept { return n_; }
+    [[nodiscard]] double   sxx() const noexcept { return sxx_; }
+
+    [[nodiscard]] double slope() const noexcept { return sxx_ != 0 ? sxy_ / sxx_ : 0; }
+    [[nodiscard]] double intercept() const noexcept { return mean_y_ - slope() * mean_x_; }
+    [[nodiscard]] double r_squared() const noexcept {
+        return sxx_ != 0 && syy_ > 0 ? (sxy_ * sxy_) / (sxx_ * syy_) : 0;
+    }
+    // Residual sum of squares is Syy - Sxy²/Sxx; no second pass needed.
+    [[nodiscard]] double std_error() const noexcept {
+        if (n_ < 3 || sxx_ == 0) return 0;
+        const double sse = std::max(0.0, syy_ - sxy_ * sxy_ / sxx_);
+        return std::sqrt(sse / static_cast<double>(n_ - 2) / sxx_);
+    }
+    [[nodiscard]] double t_statistic() const noexcept {
+        const double se = std_error();
+        return se > 0 ? slope() / se : 0;
+    }
+
+private:
+    uint64_t n_ = 0;
+    double mean_x_ = 0, mean_y_ = 0;
+    double sxx_ = 0, syy_ = 0, sxy_ = 0;
+};
+
+/**
+ * Streaming quantiles of a signed series on a fixed grid: LatencyHistogram's
+ * log-linear buckets over |x| in units of `resolution`, one set per sign.
+ * Exact for multiples of `resolution` up to 16 of them (spreads in ticks),
+ * within 1/16 relative beyond; the grid is the memory, whatever the count.
+ * quantile() interpolates between neighbouring ranks as SpreadAnalyzer's
+ * sorted percentile does.
+ */
+class QuantileSketch {
+public:
+    using Grid = core::LatencyHistogram;
+
+    explicit QuantileSketch(double resolution = 1.0)
+        : unit_(resolution), pos_(Grid::BUCKETS, 0), neg_(Grid::BUCKETS, 0) {}
+
+    void add(double x) {
+        const double steps = std::min(std::abs(x) / unit_, 9.0e18);
+        const auto u = static_cast<uint64_t>(std::llround(steps));
+        ++(x < 0 && u ? neg_ : pos_)[Grid::bucket(u)];
+        ++n_;
+    }
+
+    [[nodiscard]] double quantile(double p) const {
+        if (n_ == 0) return 0;
+        const double idx = p * static_cast<double>(n_ - 1);
+        const auto lo = static_cast<uint64_t>(idx);
+        const double frac = idx - static_cast<double>(lo);
+        const double a = at_rank(lo);
+        return frac > 0 ? a + (at_rank(std::min(lo + 1, n_ - 1)) - a) * frac : a;
+    }
+
+    [[nodiscard]] uint64_t count() const noexcept { return n_; }
+
+private:
+    // Value of the rank-th smallest (0-based): negatives first, largest magnitude first.
+    double at_rank(uint64_t rank) const {
+        uint64_t seen = 0;
+        for (size_t i = Grid::BUCKETS; i-- > 0;) {
+            seen += neg_[i];
+            if (seen > rank) return -centre(i);
+        }
+        for (size_t i = 0; i < Grid::BUCKETS; ++i) {
+            seen += pos_[i];
+            if (seen > rank) return centre(i);
+        }
+        return 0;
+    }
+    double centre(size_t i) const {
+        return (static_cast<double>(Grid::lowest(i)) + static_cast<double>(Grid::highest(i))) / 2 * unit_;
+    }
+
+    double                unit_;
+    uint64_t              n_ = 0;
+    std::vector<uint64_t> pos_;   // zero and positive values
+    std::vector<uint64_t> neg_;
+};
+
+/**
+ * OnlineAnalytics — spread decomposition, Kyle's lambda and OFI, kept
+ * current from the market-data stream of one instrument.
+ *
+ * Subscribe it to a FeedPublisher (set_callback) and every metric is
+ * available mid-run in O(1) memory: sums and running regressions instead
+ * of per-trade and per-event vectors, a quantile sketch for the effective-spread
+ * median and p95, and no lookups — each mid is in hand when it is needed.
+ * The only buffer is the trades still inside the reversion window, whose
+ * mid_after isn't known yet; it holds about (trade rate × reversion_sec).
+ *
+ * Time is seconds, passed with each message; a simulation passes its event
+ * clock, a live feed the message timestamps (on_message(m) uses seconds
+ * since the first message). Definitions follow the batch analyzers, which
+ * it matches after finish():
+ *
+ *   • An inbound event is the run of messages sharing a time. Its trades
+ *     are measured against the mid before it (the pre-event mid a per-event
+ *     sample sees) and the quoted spread is sampled once per event. A Quote
+ *     is never the first message of its event, so a conflated quote
+ *     released late still counts towards the event that caused it.
+ *   • Spread decomposition (SpreadAnalyzer): mid_after is the pre-event mid
+ *     of the first event at or past trade time + reversion_sec, so a trade
+ *     enters the decomposition once that event arrives — live figures lag
+ *     by the reversion window.
+ *   • Kyle's lambda (ImpactAnalyzer): signed volume per kyle_interval_sec
+ *     bucket against the mid change across the same bucket, with mids taken
+ *     from the event nearest each boundary. Buckets without trades are
+ *     skipped.
+ *   • OFI (ImbalanceAnalyzer): Cont–Kukanov–Stoikov imbalance summed from
+ *     consecutive quotes per ofi_interval_sec, regressed on the next
+ *     interval's mid return (bps); boundary mids are the first quote at or
+ *     past the boundary. The per-interval series are not kept.
+ */
+class OnlineAnalytics {
+public:
+    struct Options {
+        double reversion_sec     = 5.0;    // spread decomposition Δ
+        double kyle_interval_sec = 5.0;
+        double ofi_interval_sec  = 10.0;
+        Price  initial_mid       = 0;      // trades before the first quote
+    };
+
+    OnlineAnalytics() = default;
+    explicit OnlineAnalytics(Options opts) : opts_(opts) { mid_ = event_mid_ = opts.initial_mid; }
+
+    void on_message(const md::FeedMessage& m, double t) {
+        if (m.type == md::FeedMessageType::QuoteUpdate) return quote(m, t);
+        if (!started_ || t > event_t_) begin_event(t);
+        if (m.type == md::FeedMessageType::Trade) trade(m, t);
+    }
+
+    void on_message(const md::FeedMessage& m) {
+        if (!have_origin_) { origin_ns_ = m.timestamp_ns; have_origin_ = true; }
+        on_message(m, static_cast<double>(m.timestamp_ns - std::min(m.timestamp_ns, origin_ns_)) * 1e-9);
+    }
+
+    /// End of stream: pending trades take the last mid and the open
+    /// intervals close, as a lookup past the end of a batch series would.
+    void finish() {
+        if (finished_) return;
+        finished_ = true;
+        while (!pending_.empty()) resolve_front(event_mid_);
+        if (kyle_open_) close_kyle_bucket(last_mid_);
+        if (quotes_ > 0) close_ofi_interval(mid_);
+        close_volume_bucket();
+    }
+
+    [[nodiscard]] SpreadAnalyzer::SpreadMetrics spread() const {
+        SpreadAnalyzer::SpreadMetrics r{};
+        if (quoted_n_) r.avg_quoted_spread = quoted_sum_ / static_cast<double>(quoted_n_);
+        if (resolved_ == 0) return r;
+        const auto n = static_cast<double>(resolved_);
+        r.num_trades = resolved_;
+        r.avg_effective_spread = sum_effective_ / n;
+        r.avg_realized_spread  = sum_realized_ / n;
+        r.avg_price_impact     = (sum_effective_ - sum_realized_) / n;
+        if (r.avg_effective_spread > 0)
+            r.adverse_selection_pct = r.avg_price_impact / r.avg_effective_spread * 100.0;
+        if (volume_ > 0) {
+            r.vwap_effective_spread = vw_effective_ / static_cast<double>(volume_);
+            r.vwap_realized_spread  = vw_realized_ / static_cast<double>(volume_);
+        }
+        r.median_effective_spread = effective_.quantile(0.5);
+        r.p95_effective_spread    = effective_.quantile(0.95);
+        return r;
+    }
+
+    [[nodiscard]] ImpactAnalyzer::KyleLambdaResult kyle() const {
+        ImpactAnalyzer::KyleLambdaResult r{};
+        if (kyle_.n() < 3) return r;
+        r.num_intervals = kyle_.n();
+        if (kyle_.sxx() == 0) return r;
+        r.lambda      = kyle_.slope();
+        r.alpha       = kyle_.intercept();
+        r.r_squared   = kyle_.r_squared();
+        r.std_error   = kyle_.std_error();
+        r.t_statistic = kyle_.t_statistic();
+        return r;
+    }
+
+    [[nodiscard]] ImbalanceAnalyzer::ImbalanceMetrics imbalance() const {
+        ImbalanceAnalyzer::ImbalanceMetrics r{};
+        if (quotes_ < 2) return r;
+        if (ofi_.n() >= 3) {
+            r.ofi_beta      = ofi_.slope();
+            r.ofi_r_squared = ofi_.r_squared();
+            r.ofi_t_stat    = ofi_.t_statistic();
+        }
+        if (ofi_intervals_) r.avg_volume_imbalance = vi_sum_ / static_cast<double>(ofi_intervals_);
+        r.max_volume_imbalance = vi_max_;
+        r.avg_depth_imbalance  = depth_sum_ / static_cast<double>(quotes_);
+        return r;
+    }
+
+    [[nodiscard]] uint64_t trades()       const noexcept { return trades_; }
+    [[nodiscard]] uint64_t events()       const noexcept { return events_; }
+    [[nodiscard]] size_t   pending()      const noexcept { return pending_.size(); }
+    [[nodiscard]] size_t   peak_pending() const noexcept { return peak_pending_; }
+
+private:
+    struct Pending {
+        double   due;
+        Price    price;
+        Price    mid_before;
+        Quantity volume;
+        Side     aggressor;
+    };
+
+    void begin_event(double t) {
+        started_ = true;
+        event_t_ = t;
+        ++events_;
+        if (!have_mid_) return;
+        event_mid_ = mid_;
+        quoted_sum_ += static_cast<double>(spread_);
+        ++quoted_n_;
+        while (!pending_.empty() && pending_.front().due <= t) resolve_front(event_mid_);
+
+        // Kyle boundaries in (previous event, t]: each takes the nearer mid.
+        const double T = opts_.kyle_interval_sec;
+        for (; static_cast<double>(kyle_next_) * T <= t; ++kyle_next_) {
+            const double b = static_cast<double>(kyle_next_) * T;
+            const Price at = (have_last_ && b - last_t_ < t - b) ? last_mid_ : event_mid_;
+            if (kyle_open_) close_kyle_bucket(at);
+            kyle_open_     = true;
+            kyle_open_mid_ = at;
+        }
+        have_last_ = true;
+        last_t_    = t;
+        last_mid_  = event_mid_;
+    }
+
+    void trade(const md::FeedMessage& m, double t) {
+        ++trades_;
+        pending_.push_back(Pending{t + opts_.reversion_sec, m.price, event_mid_, m.quantity, m.aggressor_side});
+        peak_pending_ = std::max(peak_pending_, pending_.size());
+
+        const double v = static_cast<double>(m.quantity);
+        kyle_flow_ += m.aggressor_side == Side::Buy ? v : -v;
+
+        const auto bucket = static_cast<uint64_t>(t / opts_.ofi_interval_sec);
+        if (bucket != vi_bucket_) {
+            close_volume_bucket();
+            vi_bucket_ = bucket;
+        }
+        (m.aggressor_side == Side::Buy ? vi_buy_ : vi_sell_) += v;
+    }
+
+    void quote(const md::FeedMessage& m, double t) {
+        const Price mid = (m.bid_price + m.ask_price) / 2;
+
+        // OFI boundaries in (previous quote, t] take this quote's mid.
+        const double T = opts_.ofi_interval_sec;
+        for (; static_cast<double>(ofi_next_) * T <= t; ++ofi_next_) {
+            if (ofi_next_ > 0) close_ofi_interval(mid);
+            ofi_open_mid_ = mid;
+        }
+
+        if (quotes_ > 0) {
+            double d_bid, d_ask;
+            if (m.bid_price == bid_)     d_bid = static_cast<double>(m.bid_size) - static_cast<double>(bid_size_);
+            else if (m.bid_price > bid_) d_bid = static_cast<double>(m.bid_size);
+            else                         d_bid = -static_cast<double>(bid_size_);
+            if (m.ask_price == ask_)     d_ask = static_cast<double>(m.ask_size) - static_cast<double>(ask_size_);
+            else if (m.ask_price < ask_) d_ask = -static_cast<double>(m.ask_size);
+            else                         d_ask = static_cast<double>(ask_size_);
+            ofi_open_ += d_bid - d_ask;
+        }
+        const double depth = static_cast<double>(m.bid_size) + static_cast<double>(m.ask_size);
+        if (depth > 0) depth_sum_ += (static_cast<double>(m.bid_size) - static_cast<double>(m.ask_size)) / depth;
+
+        ++quotes_;
+        bid_ = m.bid_price;  bid_size_ = m.bid_size;
+        ask_ = m.ask_price;  ask_size_ = m.ask_size;
+        mid_ = mid;
+        spread_ = m.ask_price - m.bid_price;
+        have_mid_ = true;
+    }
+
+    void resolve_front(Price mid_after) {
+        const Pending& p = pending_.front();
+        const double d    = p.aggressor == Side::Buy ? 1.0 : -1.0;
+        const double eff  = 2.0 * d * static_cast<double>(p.price - p.mid_before);
+        const double real = 2.0 * d * static_cast<double>(p.price - mid_after);
+        const auto   vol  = static_cast<double>(p.volume);
+        ++resolved_;
+        sum_effective_ += eff;
+        sum_realized_  += real;
+        vw_effective_  += std::abs(eff) * vol;
+        vw_realized_   += real * vol;
+        volume_        += p.volume;
+        effective_.add(eff);
+        pending_.pop_front();
+    }
+
+    void close_kyle_bucket(Price end_mid) {
+        if (kyle_flow_ != 0.0) kyle_.add(kyle_flow_, static_cast<double>(end_mid - kyle_open_mid_));
+        kyle_flow_ = 0;
+    }
+
+    // Interval (ofi_next_ - 1) ends at `end_mid`: its return is known, and
+    // with it the previous interval's (OFI, next return) pair.
+    void close_ofi_interval(Price end_mid) {
+        const double ret = ofi_open_mid_ > 0
+            ? static_cast<double>(end_mid - ofi_open_mid_) / static_cast<double>(ofi_open_mid_) * 10000.0 : 0;
+        if (ofi_intervals_ > 0 && (ofi_prev_ != 0.0 || ret != 0.0)) ofi_.add(ofi_prev_, ret);
+        ofi_prev_ = ofi_open_;
+        ofi_open_ = 0;
+        ++ofi_intervals_;
+    }
+
+    void close_volume_bucket() {
+        const double total = vi_buy_ + vi_sell_;
+        if (total > 0) {
+            const double vi = (vi_buy_ - vi_sell_) / total;
+            vi_sum_ += vi;
+            if (std::abs(vi) > std::abs(vi_max_)) vi_max_ = vi;
+        }
+        vi_buy_ = vi_sell_ = 0;
+    }
+
+    Options opts_;
+    uint64_t origin_ns_ = 0;
+    bool     have_origin_ = false;
+    bool     finished_    = false;
+
+    // Book top, from the last quote
+    Price    bid_ = 0, ask_ = 0, mid_ = 0, spread_ = 0;
+    Quantity bid_size_ = 0, ask_size_ = 0;
+    bool     have_mid_ = false;
+    uint64_t quotes_   = 0;
+    double   depth_sum_ = 0;
+
+    // Current inbound event
+    bool     started_   = false;
+    double   event_t_   = 0;
+    Price    event_mid_ = 0;
+    uint64_t events_    = 0;
+    bool     have_last_ = false;   // previous sampled event, for nearest-mid boundaries
+    double   last_t_    = 0;
+    Price    last_mid_  = 0;
+
+    // Spread decomposition
+    std::deque<Pending> pending_;
+    size_t   peak_pending_ = 0;
+    uint64_t trades_ = 0, resolved_ = 0, volume_ = 0, quoted_n_ = 0;
+    double   quoted_sum_ = 0, sum_effective_ = 0, sum_realized_ = 0;
+    double   vw_effective_ = 0, vw_realized_ = 0;
+    QuantileSketch effective_;
+
+    // Kyle's lambda
+    RunningRegression kyle_;
+    uint64_t kyle_next_ = 0;       // next bucket boundary, in intervals
+    bool     kyle_open_ = false;
+    Price    kyle_open_mid_ = 0;
+    double   kyle_flow_ = 0;
+
+    // OFI
+    RunningRegression ofi_;
+    uint64_t ofi_next_ = 0;
+    uint64_t ofi_intervals_ = 0;   // closed intervals
+    Price    ofi_open_mid_ = 0;
+    double   ofi_open_ = 0, ofi_prev_ = 0;
+    uint64_t vi_bucket_ = 0;
+    double   vi_buy_ = 0, vi_sell_ = 0, vi_sum_ = 0, vi_max_ = 0;
+};
+
+} // namespace micro_exchange::analytics
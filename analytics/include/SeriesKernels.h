@@ -0,0 +1,672 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <numbers>
+#include <span>
+#include <thread>
+#include <vector>
+
+// AVX2 is compiled per function (target attribute) and chosen at run time,
+// so the build stays free of -march flags; NEON is baseline on AArch64.
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define MICRO_EXCHANGE_KERNELS_AVX2 1
+#include <immintrin.h>
+#else
+#define MICRO_EXCHANGE_KERNELS_AVX2 0
+#endif
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define MICRO_EXCHANGE_KERNELS_NEON 1
+#include <arm_neon.h>
+#else
+#define MICRO_EXCHANGE_KERNELS_NEON 0
+#endif
+
+/**
+ * Series kernels — the numeric inner loops behind the analytics: sums,
+ * central and cross moments, dot products, log returns and the ACF.
+ *
+ * Reductions run over fixed blocks of BLOCK values, each block on LANES
+ * independent accumulators that are folded in a fixed tree, and the block
+ * partials are added in block order. The scalar, AVX2 and NEON paths do the
+ * same operations lane for lane (no FMA), and threads only change which
+ * worker reduces a block, so every path and thread count gives the same
+ * bits. Series shorter than PARALLEL_MIN stay on the calling thread.
+ *
+ * acf() computes every lag up to max_lag at once: directly (one dot product
+ * per lag) for a few lags, otherwise by FFT. The FFT path correlates the
+ * series block by block (overlap of max_lag), so its memory is a few FFT
+ * buffers whatever the length, and blocks spread across threads.
+ */
+namespace micro_exchange::analytics::kernels {
+
+inline constexpr size_t LANES          = 8;
+inline constexpr size_t BLOCK          = size_t{1} << 16;
+inline constexpr size_t PARALLEL_MIN   = size_t{1} << 21;
+inline constexpr size_t DIRECT_MAX_LAG = 32;   // acf(): above this, FFT
+
+enum class Isa : uint8_t { Auto, Scalar, Avx2, Neon };
+
+/// The widest path this CPU runs (checked once).
+inline Isa detected_isa() noexcept {
+#if MICRO_EXCHANGE_KERNELS_AVX2
+    static const Isa isa = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") ? Isa::Avx2 : Isa::Scalar;
+    }();
+    return isa;
+#elif MICRO_EXCHANGE_KERNELS_NEON
+    return Isa::Neon;
+#else
+    return Isa::Scalar;
+#endif
+}
+
+inline const char* isa_name(Isa isa) noexcept {
+    switch (isa) {
+        case Isa::Avx2: return "avx2";
+        case Isa::Neon: return "neon";
+        case Isa::Scalar: return "scalar";
+        default: return "auto";
+    }
+}
+
+/// How a kernel runs: worker threads for long series and the vector path.
+struct Exec {
+    size_t threads = 0;          // 0 = std::thread::hardware_concurrency()
+    Isa    isa     = Isa::Auto;  // Auto = detected_isa(); one the CPU lacks falls back to scalar
+
+    [[nodiscard]] Isa path() const noexcept {
+        const Isa best = detected_isa();
+        return isa == Isa::Auto || isa == best ? best : Isa::Scalar;
+    }
+    [[nodiscard]] size_t workers(size_t n) const noexcept {
+        if (n < PARALLEL_MIN) return 1;
+        const size_t t = threads ? threads : std::thread::hardware_concurrency();
+        return std::max<size_t>(1, t);
+    }
+};
+
+namespace detail {
+
+struct Sums3 {
+    double a = 0, b = 0, c = 0;
+    Sums3& operator+=(const Sums3& o) noexcept { a += o.a; b += o.b; c += o.c; return *this; }
+};
+
+inline double fold(double* l) noexcept {
+    for (size_t w = LANES / 2; w; w /= 2)
+        for (size_t j = 0; j < w; ++j) l[j] += l[j + w];
+    return l[0];
+}
+
+// ── Scalar: LANES accumulators, one statement per operation ──
+
+inline double sum_scalar(const double* x, size_t n) noexcept {
+    double l[LANES] = {};
+    size_t i = 0;
+    for (; i + LANES <= n; i += LANES)
+        for (size_t j = 0; j < LANES; ++j) l[j] += x[i + j];
+    for (size_t j = 0; i < n; ++i, ++j) l[j] += x[i];
+    return fold(l);
+}
+
+inline double dot_scalar(const double* x, const double* y, size_t n) noexcept {
+    double l[LANES] = {};
+    size_t i = 0;
+    for (; i + LANES <= n; i += LANES)
+        for (size_t j = 0; j < LANES; ++j) { const double p = x[i + j] * y[i + j]; l[j] += p; }
+    for (size_t j = 0; i < n; ++i, ++j) { const double p = x[i] * y[i]; l[j] += p; }
+    return fold(l);
+}
+
+inline void central_step(double x, double m, double& s2, double& s3, double& s4) noexcept {
+    const double d  = x - m;
+    const double d2 = d * d;
+    const double d3 = d2 * d;
+    const double d4 = d2 * d2;
+    s2 += d2;
+    s3 += d3;
+    s4 += d4;
+}
+
+inline Sums3 central_scalar(const double* x, size_t n, double m) noexcept {
+    double s2[LANES] = {}, s3[LANES] = {}, s4[LANES] = {};
+    size_t i = 0;
+    for (; i + LANES <= n; i += LANES)
+        for (size_t j = 0; j < LANES; ++j) central_step(x[i + j], m, s2[j], s3[j], s4[j]);
+    for (size_t j = 0; i < n; ++i, ++j) central_step(x[i], m, s2[j], s3[j], s4[j]);
+    return {fold(s2), fold(s3), fold(s4)};
+}
+
+inline void cross_step(double x, double y, double mx, double my,
+                       double& sxx, double& syy, double& sxy) noexcept {
+    const double dx = x - mx;
+    const double dy = y - my;
+    const double xx = dx * dx;
+    const double yy = dy * dy;
+    const double xy = dx * dy;
+    sxx += xx;
+    syy += yy;
+    sxy += xy;
+}
+
+inline Sums3 cross_scalar(const double* x, const double* y, size_t n, double mx, double my) noexcept {
+    double xx[LANES] = {}, yy[LANES] = {}, xy[LANES] = {};
+    size_t i = 0;
+    for (; i + LANES <= n; i += LANES)
+        for (size_t j = 0; j < LANES; ++j) cross_step(x[i + j], y[i + j], mx, my, xx[j], yy[j], xy[j]);
+    for (size_t j = 0; i < n; ++i, ++j) cross_step(x[i], y[i], mx, my, xx[j], yy[j], xy[j]);
+    return {fold(xx), fold(yy), fold(xy)};
+}
+
+// ── AVX2: two 4-wide registers per accumulator = lanes 0-3 and 4-7 ──
+
+#if MICRO_EXCHANGE_KERNELS_AVX2
+#define MX_AVX2 __attribute__((target("avx2")))
+
+MX_AVX2 inline double sum_avx2(const double* x, size_t n) noexcept {
+    __m256d a0 = _mm256_setzero_pd(), a1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + LANES <= n; i += LANES) {
+        a0 = _mm256_add_pd(a0, _mm256_loadu_pd(x + i));
+        a1 = _mm256_add_pd(a1, _mm256_loadu_pd(x + i + 4));
+    }
+    double l[LANES];
+    _mm256_storeu_pd(l, a0);
+    _mm256_storeu_pd(l + 4, a1);
+    for (size_t j = 0; i < n; ++i, ++j) l[j] += x[i];
+    return fold(l);
+}
+
+MX_AVX2 inline double dot_avx2(const double* x, const double* y, size_t n) noexcept {
+    __m256d a0 = _mm256_setzero_pd(), a1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + LANES <= n; i += LANES) {
+        a0 = _mm256_add_pd(a0, _mm256_mul_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+        a1 = _mm256_add_pd(a1, _mm256_mul_pd(_mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(y + i + 4)));
+    }
+    double l[LANES];
+    _mm256_storeu_pd(l, a0);
+    _mm256_storeu_pd(l + 4, a1);
+    for (size_t j = 0; i < n; ++i, ++j) { const double p = x[i] * y[i]; l[j] += p; }
+    return fold(l);
+}
+
+MX_AVX2 inline Sums3 central_avx2(const double* x, size_t n, double m) noexcept {
+    const __m256d mv = _mm256_set1_pd(m);
+    __m256d s2[2] = {_mm256_setzero_pd(), _mm256_setzero_pd()};
+    __m256d s3[2] = {s2[0], s2[0]}, s4[2] = {s2[0], s2[0]};
+    size_t i = 0;
+    for (; i + LANES <= n; i += LANES) {
+        for (size_t h = 0; h < 2; ++h) {
+            const __m256d d  = _mm256_sub_pd(_mm256_loadu_pd(x + i + 4 * h), mv);
+            const __m256d d2 = _mm256_mul_pd(d, d);
+            s2[h] = _mm256_add_pd(s2[h], d2);
+            s3[h] = _mm256_add_pd(s3[h], _mm256_mul_pd(d2, d));
+            s4[h] = _mm256_add_pd(s4[h], _mm256_mul_pd(d2, d2));
+        }
+    }
+    double l2[LANES], l3[LANES], l4[LANES];
+    for (size_t h = 0; h < 2; ++h) {
+        _mm256_storeu_pd(l2 + 4 * h, s2[h]);
+        _mm256_storeu_pd(l3 + 4 * h, s3[h]);
+        _mm256_storeu_pd(l4 + 4 * h, s4[h]);
+    }
+    for (size_t j = 0; i < n; ++i, ++j) central_step(x[i], m, l2[j], l3[j], l4[j]);
+    return {fold(l2), fold(l3), fold(l4)};
+}
+
+MX_AVX2 inline Sums3 cross_avx2(const double* x, const double* y, size_t n, double mx, double my) noexcept {
+    const __m256d mxv = _mm256_set1_pd(mx), myv = _mm256_set1_pd(my);
+    __m256d sxx[2] = {_mm256_setzero_pd(), _mm256_setzero_pd()};
+    __m256d syy[2] = {sxx[0], sxx[0]}, sxy[2] = {sxx[0], sxx[0]};
+    size_t i = 0;
+    for (; i + LANES <= n; i += LANES) {
+        for (size_t h = 0; h < 2; ++h) {
+            const __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(x + i + 4 * h), mxv);
+            const __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(y + i + 4 * h), myv);
+            sxx[h] = _mm256_add_pd(sxx[h], _mm256_mul_pd(dx, dx));
+            syy[h] = _mm256_add_pd(syy[h], _mm256_mul_pd(dy, dy));
+            sxy[h] = _mm256_add_pd(sxy[h], _mm256_mul_pd(dx, dy));
+        }
+    }
+    double lxx[LANES], lyy[LANES], lxy[LANES];
+    for (size_t h = 0; h < 2; ++h) {
+        _mm256_storeu_pd(lxx + 4 * h, sxx[h]);
+        _mm256_storeu_pd(lyy + 4 * h, syy[h]);
+        _mm256_storeu_pd(lxy + 4 * h, sxy[h]);
+    }
+    for (size_t j = 0; i < n; ++i, ++j) cross_step(x[i], y[i], mx, my, lxx[j], lyy[j], lxy[j]);
+    return {fold(lxx), fold(lyy), fold(lxy)};
+}
+
+#undef MX_AVX2
+#endif
+
+// ── NEON: four 2-wide registers per accumulator ──
+
+#if MICRO_EXCHANGE_KERNELS_NEON
+inline double sum_neon(const double* x, size_t n) noexcept {
+    float64x2_t a[4] = {vdupq_n_f64(0), vdupq_n_f64(0), vdupq_n_f64(0), vdupq_n_f64(0)};
+    size_t i = 0;
+    for (; i + LANES <= n; i += LANES)
+        for (size_t h = 0; h < 4; ++h) a[h] = vaddq_f64(a[h], vld1q_f64(x + i + 2 * h));
+    double l[LANES];
+    for (size_t h = 0; h < 4; ++h) vst1q_f64(l + 2 * h, a[h]);
+    for (size_t j = 0; i < n; ++i, ++j) l[j] += x[i];
+    return fold(l);
+}
+
+inline double dot_neon(const double* x, const double* y, size_t n) noexcept {
+    float64x2_t a[4] = {vdupq_n_f64(0), vdupq_n_f64(0), vdupq_n_f64(0), vdupq_n_f64(0)};
+    size_t i = 0;
+    for (; i + LANES <= n; i += LANES)
+        for (size_t h = 0; h < 4; ++h)
+            a[h] = vaddq_f64(a[h], vmulq_f64(vld1q_f64(x + i + 2 * h), vld1q_f64(y + i + 2 * h)));
+    double l[LANES];
+    for (size_t h = 0; h < 4; ++h) vst1q_f64(l + 2 * h, a[h]);
+    for (size_t j = 0; i < n; ++i, ++j) { const double p = x[i] * y[i]; l[j] += p; }
+    return fold(l);
+}
+
+inline Sums3 central_neon(const double* x, size_t n, double m) noexcept {
+    const float64x2_t mv = vdupq_n_f64(m);
+    float64x2_t s2[4], s3[4], s4[4];
+    for (size_t h = 0; h < 4; ++h) s2[h] = s3[h] = s4[h] = vdupq_n_f64(0);
+    size_t i = 0;
+    for (; i + LANES <= n; i += LANES) {
+        for (size_t h = 0; h < 4; ++h) {
+            const float64x2_t d  = vsubq_f64(vld1q_f64(x + i + 2 * h), mv);
+            const float64x2_t d2 = vmulq_f64(d, d);
+            s2[h] = vaddq_f64(s2[h], d2);
+            s3[h] = vaddq_f64(s3[h], vmulq_f64(d2, d));
+            s4[h] = vaddq_f64(s4[h], vmulq_f64(d2, d2));
+        }
+    }
+    double l2[LANES], l3[LANES], l4[LANES];
+    for (size_t h = 0; h < 4; ++h) {
+        vst1q_f64(l2 + 2 * h, s2[h]);
+        vst1q_f64(l3 + 2 * h, s3[h]);
+        vst1q_f64(l4 + 2 * h, s4[h]);
+    }
+    for (size_t j = 0; i < n; ++i, ++j) central_step(x[i], m, l2[j], l3[j], l4[j]);
+    return {fold(l2), fold(l3), fold(l4)};
+}
+
+inline Sums3 cross_neon(const double* x, const double* y, size_t n, double mx, double my) noexcept {
+    const float64x2_t mxv = vdupq_n_f64(mx), myv = vdupq_n_f64(my);
+    float64x2_t sxx[4], syy[4], sxy[4];
+    for (size_t h = 0; h < 4; ++h) sxx[h] = syy[h] = sxy[h] = vdupq_n_f64(0);
+    size_t i = 0;
+    for (; i + LANES <= n; i += LANES) {
+        for (size_t h = 0; h < 4; ++h) {
+            const float64x2_t dx = vsubq_f64(vld1q_f64(x + i + 2 * h), mxv);
+            const float64x2_t dy = vsubq_f64(vld1q_f64(y + i + 2 * h), myv);
+            sxx[h] = vaddq_f64(sxx[h], vmulq_f64(dx, dx));
+            syy[h] = vaddq_f64(syy[h], vmulq_f64(dy, dy));
+            sxy[h] = vaddq_f64(sxy[h], vmulq_f64(dx, dy));
+        }
+    }
+    double lxx[LANES], lyy[LANES], lxy[LANES];
+    for (size_t h = 0; h < 4; ++h) {
+        vst1q_f64(lxx + 2 * h, sxx[h]);
+        vst1q_f64(lyy + 2 * h, syy[h]);
+        vst1q_f64(lxy + 2 * h, sxy[h]);
+    }
+    for (size_t j = 0; i < n; ++i, ++j) cross_step(x[i], y[i], mx, my, lxx[j], lyy[j], lxy[j]);
+    return {fold(lxx), fold(lyy), fold(lxy)};
+}
+#endif
+
+// ── Dispatch ──
+
+inline double sum(const double* x, size_t n, Isa isa) noexcept {
+#if MICRO_EXCHANGE_KERNELS_AVX2
+    if (isa == Isa::Avx2) return sum_avx2(x, n);
+#elif MICRO_EXCHANGE_KERNELS_NEON
+    if (isa == Isa::Neon) return sum_neon(x, n);
+#endif
+    (void)isa;
+    return sum_scalar(x, n);
+}
+
+inline double dot(const double* x, const double* y, size_t n, Isa isa) noexcept {
+#if MICRO_EXCHANGE_KERNELS_AVX2
+    if (isa == Isa::Avx2) return dot_avx2(x, y, n);
+#elif MICRO_EXCHANGE_KERNELS_NEON
+    if (isa == Isa::Neon) return dot_neon(x, y, n);
+#endif
+    (void)isa;
+    return dot_scalar(x, y, n);
+}
+
+inline Sums3 central(const double* x, size_t n, double m, Isa isa) noexcept {
+#if MICRO_EXCHANGE_KERNELS_AVX2
+    if (isa == Isa::Avx2) return central_avx2(x, n, m);
+#elif MICRO_EXCHANGE_KERNELS_NEON
+    if (isa == Isa::Neon) return central_neon(x, n, m);
+#endif
+    (void)isa;
+    return central_scalar(x, n, m);
+}
+
+inline Sums3 cross(const double* x, const double* y, size_t n, double mx, double my, Isa isa) noexcept {
+#if MICRO_EXCHANGE_KERNELS_AVX2
+    if (isa == Isa::Avx2) return cross_avx2(x, y, n, mx, my);
+#elif MICRO_EXCHANGE_KERNELS_NEON
+    if (isa == Isa::Neon) return cross_neon(x, y, n, mx, my);
+#endif
+    (void)isa;
+    return cross_scalar(x, y, n, mx, my);
+}
+
+/// fn(i) for i in [0, count), dealt round-robin to `workers` threads.
+template <typename Fn>
+void for_each_index(size_t count, size_t workers, Fn&& fn) {
+    workers = std::min(workers, count);
+    if (workers <= 1) {
+        for (size_t i = 0; i < count; ++i) fn(i);
+        return;
+    }
+    std::vector<std::thread> pool;
+    pool.reserve(workers);
+    for (size_t w = 0; w < workers; ++w) {
+        pool.emplace_back([&, w] {
+            for (size_t i = w; i < count; i += workers) fn(i);
+        });
+    }
+    for (auto& t : pool) t.join();
+}
+
+/// block(begin, end) over fixed BLOCK-sized slices of [0, n), added in order.
+template <typename R, typename Block>
+R reduce_blocks(size_t n, const Exec& ex, Block&& block) {
+    const size_t blocks = (n + BLOCK - 1) / BLOCK;
+    std::vector<R> part(blocks);
+    for_each_index(blocks, ex.workers(n), [&](size_t b) {
+        part[b] = block(b * BLOCK, std::min(n, (b + 1) * BLOCK));
+    });
+    R total{};
+    for (const R& p : part) total += p;
+    return total;
+}
+
+} // namespace detail
+
+// ─────────────────────────────────────────────
+// Moments and regressions
+// ─────────────────────────────────────────────
+
+inline double sum(std::span<const double> x, const Exec& ex = {}) {
+    const Isa isa = ex.path();
+    return detail::reduce_blocks<double>(x.size(), ex, [&](size_t b, size_t e) {
+        return detail::sum(x.data() + b, e - b, isa);
+    });
+}
+
+inline double dot(std::span<const double> x, std::span<const double> y, const Exec& ex = {}) {
+    const size_t n = std::min(x.size(), y.size());
+    const Isa isa = ex.path();
+    return detail::reduce_blocks<double>(n, ex, [&](size_t b, size_t e) {
+        return detail::dot(x.data() + b, y.data() + b, e - b, isa);
+    });
+}
+
+inline double mean(std::span<const double> x, const Exec& ex = {}) {
+    return x.empty() ? 0 : sum(x, ex) / static_cast<double>(x.size());
+}
+
+/// Mean and central sums Σd², Σd³, Σd⁴ (d = x - mean), two passes.
+struct Moments {
+    size_t n = 0;
+    double mean = 0, m2 = 0, m3 = 0, m4 = 0;
+
+    [[nodiscard]] double variance() const noexcept { return n ? m2 / static_cast<double>(n) : 0; }   // population
+    [[nodiscard]] double skewness() const noexcept {
+        const double v = variance();
+        return v > 0 ? m3 / static_cast<double>(n) / (v * std::sqrt(v)) : 0;
+    }
+    [[nodiscard]] double excess_kurtosis() const noexcept {
+        const double v = variance();
+        return v > 0 ? m4 / static_cast<double>(n) / (v * v) - 3.0 : 0;
+    }
+};
+
+inline Moments moments(std::span<const double> x, const Exec& ex = {}) {
+    Moments m;
+    m.n = x.size();
+    if (x.empty()) return m;
+    m.mean = mean(x, ex);
+    const Isa isa = ex.path();
+    const auto s = detail::reduce_blocks<detail::Sums3>(x.size(), ex, [&](size_t b, size_t e) {
+        return detail::central(x.data() + b, e - b, m.mean, isa);
+    });
+    m.m2 = s.a;
+    m.m3 = s.b;
+    m.m4 = s.c;
+    return m;
+}
+
+/// Means and co-moments of two series (the shorter length); OLS of y on x.
+struct CrossMoments {
+    size_t n = 0;
+    double mean_x = 0, mean_y = 0;
+    double sxx = 0, syy = 0, sxy = 0;
+
+    [[nodiscard]] double slope() const noexcept { return sxx != 0 ? sxy / sxx : 0; }
+    [[nodiscard]] double intercept() const noexcept { return mean_y - slope() * mean_x; }
+    [[nodiscard]] double correlation() const noexcept {
+        const double d = std::sqrt(sxx * syy);
+        return d > 0 ? sxy / d : 0;
+    }
+    [[nodiscard]] double r_squared() const noexcept {
+        return sxx != 0 && syy > 0 ? (sxy * sxy) / (sxx * syy) : 0;
+    }
+    // Residual sum of squares Syy - Sxy²/Sxx; 0 below three points.
+    [[nodiscard]] double std_error() const noexcept {
+        if (n < 3 || sxx == 0) return 0;
+        const double sse = std::max(0.0, syy - sxy * sxy / sxx);
+        return std::sqrt(sse / static_cast<double>(n - 2) / sxx);
+    }
+};
+
+inline CrossMoments cross_moments(std::span<const double> x, std::span<const double> y, const Exec& ex = {}) {
+    CrossMoments m;
+    m.n = std::min(x.size(), y.size());
+    if (m.n == 0) return m;
+    x = x.first(m.n);
+    y = y.first(m.n);
+    m.mean_x = mean(x, ex);
+    m.mean_y = mean(y, ex);
+    const Isa isa = ex.path();
+    const auto s = detail::reduce_blocks<detail::Sums3>(m.n, ex, [&](size_t b, size_t e) {
+        return detail::cross(x.data() + b, y.data() + b, e - b, m.mean_x, m.mean_y, isa);
+    });
+    m.sxx = s.a;
+    m.syy = s.b;
+    m.sxy = s.c;
+    return m;
+}
+
+/**
+ * ln(p[i] / p[i-1]) for each consecutive pair of positive prices (others
+ * are skipped). Unchanged prices — most pairs of a tick-valued mid — are
+ * exactly 0 and skip the log. The log itself is libm's, one per change.
+ */
+inline std::vector<double> log_returns(std::span<const double> p, const Exec& ex = {}) {
+    std::vector<double> out;
+    if (p.size() < 2) return out;
+    const size_t pairs = p.size() - 1;
+    auto run = [&](size_t b, size_t e, std::vector<double>& r) {
+        for (size_t i = b + 1; i <= e; ++i) {
+            const double a = p[i - 1], c = p[i];
+            if (a > 0.0 && c > 0.0) r.push_back(c == a ? 0.0 : std::log(c / a));
+        }
+    };
+    const size_t workers = ex.workers(pairs);
+    if (workers <= 1) {
+        out.reserve(pairs);
+        run(0, pairs, out);
+        return out;
+    }
+    const size_t blocks = (pairs + BLOCK - 1) / BLOCK;
+    std::vector<std::vector<double>> part(blocks);
+    detail::for_each_index(blocks, workers, [&](size_t b) {
+        part[b].reserve(BLOCK);
+        run(b * BLOCK, std::min(pairs, (b + 1) * BLOCK), part[b]);
+    });
+    out.reserve(pairs);
+    for (const auto& r : part) out.insert(out.end(), r.begin(), r.end());
+    return out;
+}
+
+// ─────────────────────────────────────────────
+// Autocorrelation
+// ─────────────────────────────────────────────
+
+/// In-place radix-2 complex FFT of one power-of-two size.
+class FFT {
+public:
+    explicit FFT(size_t m) : m_(m), twiddle_(m / 2), reverse_(m) {
+        for (size_t k = 0; k < m / 2; ++k)
+            twiddle_[k] = std::polar(1.0, -2.0 * std::numbers::pi * static_cast<double>(k) / static_cast<double>(m));
+        const unsigned bits = static_cast<unsigned>(std::countr_zero(m));
+        for (size_t i = 0; i < m; ++i) {
+            size_t r = 0;
+            for (unsigned b = 0; b < bits; ++b) r |= ((i >> b) & 1) << (bits - 1 - b);
+            reverse_[i] = static_cast<uint32_t>(r);
+        }
+    }
+
+    [[nodiscard]] size_t size() const noexcept { return m_; }
+
+    /// Forward transform, or the inverse (scaled by 1/m) with `inverse`.
+    void transform(std::complex<double>* a, bool inverse) const noexcept {
+        for (size_t i = 0; i < m_; ++i)
+            if (i < reverse_[i]) std::swap(a[i], a[reverse_[i]]);
+        for (size_t len = 2; len <= m_; len <<= 1) {
+            const size_t half = len / 2, step = m_ / len;
+            for (size_t s = 0; s < m_; s += len) {
+                for (size_t j = 0; j < half; ++j) {
+                    const std::complex<double> w = inverse ? std::conj(twiddle_[j * step]) : twiddle_[j * step];
+                    const std::complex<double> v = mul(a[s + j + half], w);
+                    a[s + j + half] = a[s + j] - v;
+                    a[s + j] += v;
+                }
+            }
+        }
+        if (inverse) {
+            const double k = 1.0 / static_cast<double>(m_);
+            for (size_t i = 0; i < m_; ++i) a[i] *= k;
+        }
+    }
+
+    // Plain product: std::complex's operator* pays for C99 inf/NaN recovery.
+    static std::complex<double> mul(std::complex<double> a, std::complex<double> b) noexcept {
+        return {a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real()};
+    }
+
+private:
+    size_t                            m_;
+    std::vector<std::complex<double>> twiddle_;
+    std::vector<uint32_t>             reverse_;
+};
+
+namespace detail {
+
+inline std::vector<double> demeaned(std::span<const double> x, const Exec& ex) {
+    const double m = mean(x, ex);
+    std::vector<double> d(x.size());
+    for (size_t i = 0; i < x.size(); ++i) d[i] = x[i] - m;
+    return d;
+}
+
+} // namespace detail
+
+/**
+ * Sample autocorrelation at lags 0..max_lag (clamped to n - 1):
+ * Σ d[i]·d[i-k] / Σ d² with d the demeaned series — one dot product per
+ * lag. All zeros for a constant series.
+ */
+inline std::vector<double> acf_direct(std::span<const double> x, size_t max_lag, const Exec& ex = {}) {
+    if (x.size() < 2) return std::vector<double>(x.empty() ? 0 : 1, 0.0);
+    max_lag = std::min(max_lag, x.size() - 1);
+    std::vector<double> r(max_lag + 1, 0.0);
+    const auto d = detail::demeaned(x, ex);
+    const std::span<const double> ds(d);
+    const double denom = dot(ds, ds, ex);
+    if (!(denom > 0)) return r;
+    r[0] = 1.0;
+    for (size_t k = 1; k <= max_lag; ++k) r[k] = dot(ds.subspan(k), ds, ex) / denom;
+    return r;
+}
+
+/**
+ * The same autocorrelation by FFT, O(n log M) for any max_lag. The series
+ * is cut into blocks of B = M - max_lag values; each block is correlated
+ * with itself plus the next max_lag values in one M-point transform pair
+ * (block and extension packed as the real and imaginary parts of a single
+ * forward FFT), and the per-block lag sums are added in block order.
+ */
+inline std::vector<double> acf_fft(std::span<const double> x, size_t max_lag, const Exec& ex = {}) {
+    if (x.size() < 2) return std::vector<double>(x.empty() ? 0 : 1, 0.0);
+    const size_t n = x.size();
+    const size_t L = std::min(max_lag, n - 1);
+    std::vector<double> r(L + 1, 0.0);
+    const auto d = detail::demeaned(x, ex);
+    const std::span<const double> ds(d);
+    const double denom = dot(ds, ds, ex);
+    if (!(denom > 0)) return r;
+
+    // M at least 4(L + 1) (so B >= 3/4 M) and 8K, no larger than one block needs.
+    const size_t M = std::min(std::bit_ceil(n + L), std::max(std::bit_ceil(4 * (L + 1)), size_t{1} << 13));
+    const size_t B = M - L;
+    const size_t blocks = (n + B - 1) / B;
+    const FFT fft(M);
+    std::vector<std::vector<double>> part(blocks);
+
+    const size_t workers = std::min(ex.workers(n), blocks);
+    std::vector<std::vector<std::complex<double>>> bufs(std::max<size_t>(1, workers));
+    detail::for_each_index(blocks, workers, [&](size_t b) {
+        // One pair of buffers per worker, picked by the round-robin slot.
+        auto& buf = bufs[workers > 1 ? b % workers : 0];
+        if (buf.empty()) buf.resize(2 * M);
+        std::complex<double>* z = buf.data();
+        std::complex<double>* p = z + M;
+        const size_t s0 = b * B;
+        for (size_t i = 0; i < M; ++i) {
+            const size_t at = s0 + i;
+            const double v = at < n ? d[at] : 0.0;
+            z[i] = {i < B ? v : 0.0, v};   // block | block + extension
+        }
+        fft.transform(z, false);
+        for (size_t f = 0; f < M; ++f) {
+            const std::complex<double> zf = z[f], zg = std::conj(z[(M - f) & (M - 1)]);
+            const std::complex<double> s = (zf + zg) * 0.5;
+            const std::complex<double> dz = zf - zg;
+            const std::complex<double> e{dz.imag() * 0.5, -dz.real() * 0.5};
+            p[f] = FFT::mul(std::conj(s), e);
+        }
+        fft.transform(p, true);
+        part[b].resize(L + 1);
+        for (size_t k = 0; k <= L; ++k) part[b][k] = p[k].real();
+    });
+
+    for (const auto& blk : part)
+        for (size_t k = 0; k <= L; ++k) r[k] += blk[k];
+    for (size_t k = 1; k <= L; ++k) r[k] /= denom;
+    r[0] = 1.0;
+    return r;
+}
+
+/// Autocorrelation at lags 0..max_lag: direct for a few lags, else FFT.
+inline std::vector<double> acf(std::span<const double> x, size_t max_lag, const Exec& ex = {}) {
+    return max_lag <= DIRECT_MAX_LAG ? acf_direct(x, max_lag, ex) : acf_fft(x, max_lag, ex);
+}
+
+} // namespace micro_exchange::analytics::kernels
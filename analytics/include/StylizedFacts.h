@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Order.h"
+#include "SeriesKernels.h"
 #include <vector>
 #include <numeric>
 #include <cmath>
@@ -44,6 +45,8 @@ using namespace micro_exchange::core;
  */
 class StylizedFacts {
 public:
+    static constexpr size_t ACF_LAGS = 100;   // |r| autocorrelation kept up to this lag
+
     struct FactMetrics {
         // Fat tails
         double return_kurtosis;       // Excess kurtosis (Normal = 0)
@@ -55,6 +58,7 @@ public:
         double abs_return_ac_lag5;    // At lag 5
         double abs_return_ac_lag10;   // At lag 10
         double squared_return_ac_lag1;
+        std::vector<double> abs_return_acf;   // lags 0..ACF_LAGS (fewer on short series)
 
         // Volume-volatility
         double volume_volatility_corr;
@@ -120,34 +124,14 @@ public:
             bar_close.assign(midprices.begin(), midprices.end());
         }
 
-        std::vector<double> returns;
-        returns.reserve(bar_close.size());
-        for (size_t i = 1; i < bar_close.size(); ++i) {
-            if (bar_close[i-1] > 0.0 && bar_close[i] > 0.0) {
-                returns.push_back(std::log(bar_close[i] / bar_close[i-1]));
-            }
-        }
+        const std::vector<double> returns = kernels::log_returns(bar_close);
 
         if (returns.size() < 20) return result;
 
         // ── Fat tails ──
-        double mean = std::accumulate(returns.begin(), returns.end(), 0.0) / returns.size();
-        double var = 0, m3 = 0, m4 = 0;
-        for (double r : returns) {
-            double d = r - mean;
-            var += d * d;
-            m3 += d * d * d;
-            m4 += d * d * d * d;
-        }
-        var /= returns.size();
-        m3 /= returns.size();
-        m4 /= returns.size();
-
-        double std_dev = std::sqrt(var);
-        if (std_dev > 0) {
-            result.return_skewness = m3 / (std_dev * std_dev * std_dev);
-            result.return_kurtosis = m4 / (var * var) - 3.0;  // Excess kurtosis
-        }
+        const auto mom = kernels::moments(returns);
+        result.return_skewness = mom.skewness();
+        result.return_kurtosis = mom.excess_kurtosis();
 
         // Jarque-Bera
         double n = returns.size();
@@ -163,10 +147,15 @@ public:
         std::transform(returns.begin(), returns.end(), sq_returns.begin(),
             [](double r) { return r * r; });
 
-        result.abs_return_ac_lag1 = autocorrelation(abs_returns, 1);
-        result.abs_return_ac_lag5 = autocorrelation(abs_returns, 5);
-        result.abs_return_ac_lag10 = autocorrelation(abs_returns, 10);
-        result.squared_return_ac_lag1 = autocorrelation(sq_returns, 1);
+        // The whole |r| ACF in one go (FFT at this many lags), not a pass per lag.
+        result.abs_return_acf = kernels::acf(abs_returns, ACF_LAGS);
+        auto ac_at = [&](size_t lag) {
+            return lag < result.abs_return_acf.size() ? result.abs_return_acf[lag] : 0.0;
+        };
+        result.abs_return_ac_lag1 = ac_at(1);
+        result.abs_return_ac_lag5 = ac_at(5);
+        result.abs_return_ac_lag10 = ac_at(10);
+        result.squared_return_ac_lag1 = kernels::acf(sq_returns, 1)[1];
 
         // ── Volume-volatility correlation ──
         if (!volumes.empty() && volumes.size() >= returns.size()) {
@@ -231,40 +220,9 @@ public:
     }
 
 private:
-    double autocorrelation(const std::vector<double>& x, size_t lag) const {
-        if (x.size() <= lag) return 0;
-        size_t n = x.size();
-        double mean = std::accumulate(x.begin(), x.end(), 0.0) / n;
-
-        double numerator = 0, denominator = 0;
-        for (size_t i = 0; i < n; ++i) {
-            denominator += (x[i] - mean) * (x[i] - mean);
-            if (i >= lag) {
-                numerator += (x[i] - mean) * (x[i - lag] - mean);
-            }
-        }
-
-        return (denominator > 0) ? numerator / denominator : 0;
-    }
-
-    double correlation(const std::vector<double>& x, const std::vector<double>& y) const {
-        size_t n = std::min(x.size(), y.size());
-        if (n < 3) return 0;
-
-        double mean_x = std::accumulate(x.begin(), x.begin() + n, 0.0) / n;
-        double mean_y = std::accumulate(y.begin(), y.begin() + n, 0.0) / n;
-
-        double ss_xy = 0, ss_xx = 0, ss_yy = 0;
-        for (size_t i = 0; i < n; ++i) {
-            double dx = x[i] - mean_x;
-            double dy = y[i] - mean_y;
-            ss_xy += dx * dy;
-            ss_xx += dx * dx;
-            ss_yy += dy * dy;
-        }
-
-        double denom = std::sqrt(ss_xx * ss_yy);
-        return (denom > 0) ? ss_xy / denom : 0;
+    static double correlation(const std::vector<double>& x, const std::vector<double>& y) {
+        if (std::min(x.size(), y.size()) < 3) return 0;
+        return kernels::cross_moments(x, y).correlation();
     }
 };
 
@@ -0,0 +1,415 @@
+/*
+ * bench_gateway.cpp - order-entry gateway throughput over loopback.
+ *
+ * Clients stream NewOrders in windows of --window frames (one write per
+ * window) and read Execs and Acks until the window is acknowledged. The
+ * flow crosses often, so many orders sweep a level or two and draw several
+ * Execs. Throughput scenarios:
+ *
+ *   • per-message — the old wire path, kept here as the baseline: one
+ *                   recv() for each header and one for each payload, and
+ *                   every Exec / Ack written as header then payload
+ *   • blocking    — OrderGateway::serve_one_client(): one recv() takes in
+ *                   every frame that has arrived, one write() answers them
+ *   • epoll       — OrderGateway::run(), Epoll backend, 1 and --sessions
+ *                   clients
+ *   • io_uring    — the IoUring backend, same clients, then with SQPOLL
+ *                   (Linux only)
+ *   • pipelined   — epoll with matching and egress on their own pinned
+ *                   threads; per-stage queue depth and wait are printed
+ *                   for the --sessions run
+ *
+ * "syscalls/msg" is the gateway's kernel crossings per inbound order:
+ * recv + send, plus epoll_wait / epoll_ctl or io_uring_enter.
+ *
+ * Latency is lock-step: one order out, wait for its Ack, --pings times,
+ * against each backend.
+ *
+ * Client and server share the machine, so on one core the rate also pays
+ * for the client's side, and an SQPOLL thread or the pipeline's stage
+ * threads compete with both.
+ *
+ * Usage:
+ *   ./bench_gateway                       # 200k orders, window 32, 8 sessions, 20k pings
+ *   ./bench_gateway --orders 1000000 --window 64 --sessions 16 --pings 100000
+ */
+
+#include "OrderGateway.h"
+#include "OrderEntryProtocol.h"
+#include "MatchingEngine.h"
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace micro_exchange::core;
+using namespace micro_exchange::net;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+constexpr const char* SYM = "BENCH";
+
+struct CliArgs {
+    size_t orders   = 200'000;
+    size_t window   = 32;
+    size_t sessions = 8;
+    size_t pings    = 20'000;
+};
+
+CliArgs parse(int argc, char** argv) {
+    CliArgs a;
+    for (int i = 1; i < argc; ++i) {
+        std::string s = argv[i];
+        if (s == "--orders" && i + 1 < argc)        a.orders   = std::stoull(argv[++i]);
+        else if (s == "--window" && i + 1 < argc)   a.window   = std::max<size_t>(1, std::stoull(argv[++i]));
+        else if (s == "--sessions" && i + 1 < argc) a.sessions = std::max<size_t>(1, std::stoull(argv[++i]));
+        else if (s == "--pings" && i + 1 < argc)    a.pings    = std::stoull(argv[++i]);
+        else if (s == "--help") {
+            std::cout << "usage: bench_gateway [--orders N] [--window N] [--sessions N] [--pings N]\n";
+            std::exit(0);
+        }
+    }
+    return a;
+}
+
+std::vector<WireNewOrder> make_flow(size_t n) {
+    std::mt19937_64 rng(11);
+    std::uniform_int_distribution<Price>    price(97, 103);
+    std::uniform_int_distribution<Quantity> qty(1, 5);
+    std::uniform_int_distribution<int>      side(0, 1);
+    std::uniform_real_distribution<double>  type(0.0, 1.0);
+
+    std::vector<WireNewOrder> v(n);
+    for (size_t i = 0; i < n; ++i) {
+        WireNewOrder& w = v[i];
+        w.id   = i + 1;
+        w.side = static_cast<uint8_t>(side(rng) ? Side::Buy : Side::Sell);
+        if (type(rng) < 0.7) {
+            w.type  = static_cast<uint8_t>(OrderType::Limit);
+            w.tif   = static_cast<uint8_t>(TimeInForce::GTC);
+            w.price = price(rng);
+        } else {
+            w.type  = static_cast<uint8_t>(OrderType::Market);
+            w.tif   = static_cast<uint8_t>(TimeInForce::IOC);
+            w.price = PRICE_MARKET;
+        }
+        w.quantity = qty(rng) * 100;
+        std::strncpy(w.symbol, SYM, sizeof(w.symbol) - 1);
+    }
+    return v;
+}
+
+int listen_loopback(uint16_t& port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    int yes = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    ::listen(fd, 16);
+    socklen_t len = sizeof(addr);
+    ::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+    port = ntohs(addr.sin_port);
+    return fd;
+}
+
+int connect_loopback(uint16_t port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    int yes = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    for (int i = 0; i < 200; ++i) {
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) return fd;
+        usleep(2000);
+    }
+    ::close(fd);
+    return -1;
+}
+
+// The gateway loop before buffered decode: header and payload read
+// separately, each outbound frame written as two writes. Returns syscalls.
+uint64_t serve_per_message(int listen_fd) {
+    int fd = ::accept(listen_fd, nullptr, nullptr);
+    int yes = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+    uint64_t syscalls = 0;
+    auto send_split = [&](MsgType type, const void* p, uint32_t len) {
+        WireHeader h{};
+        h.type = static_cast<uint8_t>(type);
+        h.len  = len;
+        write_full(fd, &h, sizeof(h));
+        write_full(fd, p, len);
+        syscalls += 2;
+    };
+
+    MatchingEngine engine;
+    engine.add_symbol(SYM);
+    engine.set_trade_callback([&](const Trade& t) {
+        WireExec e{};
+        e.buy_order_id  = t.buy_order_id;
+        e.sell_order_id = t.sell_order_id;
+        e.price         = t.price;
+        e.quantity      = t.quantity;
+        e.aggressor     = static_cast<uint8_t>(t.aggressor);
+        send_split(MsgType::Exec, &e, sizeof(e));
+    });
+
+    WireHeader h{};
+    WireNewOrder w{};
+    while (recv_header(fd, h)) {
+        if (h.len != sizeof(w) || !read_full(fd, &w, sizeof(w))) break;
+        syscalls += 2;
+        NewOrderRequest req{};
+        req.id       = w.id;
+        req.side     = static_cast<Side>(w.side);
+        req.type     = static_cast<OrderType>(w.type);
+        req.tif      = static_cast<TimeInForce>(w.tif);
+        req.price    = w.price;
+        req.quantity = w.quantity;
+        std::memcpy(req.symbol, w.symbol, sizeof(req.symbol));
+        Order* o = engine.submit_order(req);
+        WireAck ack{};
+        ack.id         = w.id;
+        ack.status     = static_cast<uint8_t>(o ? AckStatus::Accepted : AckStatus::Rejected);
+        ack.filled_qty = o ? o->filled_qty : 0;
+        send_split(MsgType::Ack, &ack, sizeof(ack));
+    }
+    ::close(fd);
+    return syscalls;
+}
+
+struct ClientResult {
+    uint64_t acks = 0, execs = 0;
+};
+
+// Stream `orders[first], orders[first + stride], ...` in windows; count the
+// replies through a buffered reader. Each window's round trip goes to `rtt_ns`.
+ClientResult run_client(uint16_t port, const std::vector<WireNewOrder>& orders,
+                        size_t first, size_t stride, size_t window,
+                        std::vector<uint64_t>* rtt_ns = nullptr) {
+    ClientResult res;
+    int fd = connect_loopback(port);
+    if (fd < 0) return res;
+
+    std::vector<char> out, in(64 * 1024);
+    size_t in_len = 0;
+    for (size_t i = first; i < orders.size();) {
+        const auto t0 = Clock::now();
+        out.clear();
+        size_t sent = 0;
+        for (; sent < window && i < orders.size(); ++sent, i += stride) {
+            WireHeader h{};
+            h.type = static_cast<uint8_t>(MsgType::NewOrder);
+            h.len  = sizeof(WireNewOrder);
+            const auto* hp = reinterpret_cast<const char*>(&h);
+            const auto* wp = reinterpret_cast<const char*>(&orders[i]);
+            out.insert(out.end(), hp, hp + sizeof(h));
+            out.insert(out.end(), wp, wp + sizeof(WireNewOrder));
+        }
+        if (!write_full(fd, out.data(), out.size())) break;
+
+        size_t acked = 0;
+        while (acked < sent) {
+            const ssize_t r = ::recv(fd, in.data() + in_len, in.size() - in_len, 0);
+            if (r <= 0) { ::close(fd); return res; }
+            in_len += static_cast<size_t>(r);
+            size_t off = 0;
+            WireHeader h;
+            while (in_len - off >= sizeof(h)) {
+                std::memcpy(&h, in.data() + off, sizeof(h));
+                if (in_len - off < sizeof(h) + h.len) break;
+                if (static_cast<MsgType>(h.type) == MsgType::Ack)  { ++acked; ++res.acks; }
+                if (static_cast<MsgType>(h.type) == MsgType::Exec) ++res.execs;
+                off += sizeof(h) + h.len;
+            }
+            std::memmove(in.data(), in.data() + off, in_len - off);
+            in_len -= off;
+        }
+        if (rtt_ns) {
+            rtt_ns->push_back(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count()));
+        }
+    }
+    ::close(fd);
+    return res;
+}
+
+struct Result {
+    double   rate     = 0;   // inbound orders per second
+    double   syscalls = 0;   // gateway syscalls per inbound order
+    uint64_t execs    = 0;
+    bool     complete = false;
+};
+
+Result bench_per_message(const std::vector<WireNewOrder>& orders, size_t window) {
+    uint16_t port = 0;
+    int lfd = listen_loopback(port);
+    uint64_t syscalls = 0;
+    std::thread server([&] { syscalls = serve_per_message(lfd); });
+    const auto start = Clock::now();
+    const ClientResult c = run_client(port, orders, 0, 1, window);
+    const double secs = std::chrono::duration<double>(Clock::now() - start).count();
+    server.join();
+    ::close(lfd);
+    return {orders.size() / secs, double(syscalls) / orders.size(), c.execs, c.acks == orders.size()};
+}
+
+Result bench_blocking(const std::vector<WireNewOrder>& orders, size_t window,
+                      std::vector<uint64_t>* rtt_ns = nullptr) {
+    OrderGateway gateway(0, SYM);
+    std::thread server([&] { gateway.serve_one_client(); });
+    const auto start = Clock::now();
+    const ClientResult c = run_client(gateway.port(), orders, 0, 1, window, rtt_ns);
+    const double secs = std::chrono::duration<double>(Clock::now() - start).count();
+    server.join();
+    return {orders.size() / secs, double(gateway.io_syscalls()) / orders.size(),
+            c.execs, c.acks == orders.size()};
+}
+
+GatewayOptions backend_options(GatewayBackend backend, bool sqpoll = false, bool pipelined = false) {
+    GatewayOptions opts;
+    opts.backend   = backend;
+    opts.sqpoll    = sqpoll;
+    opts.pipelined = pipelined;
+    return opts;
+}
+
+Result bench_event_loop(const std::vector<WireNewOrder>& orders, size_t window, size_t sessions,
+                        const GatewayOptions& opts, std::vector<uint64_t>* rtt_ns = nullptr,
+                        PipelineStats* stages = nullptr) {
+    OrderGateway gateway(opts, SYM);
+    std::thread server([&] { gateway.run(); });
+    std::vector<ClientResult> results(sessions);
+    std::vector<std::thread> clients;
+    const auto start = Clock::now();
+    for (size_t k = 0; k < sessions; ++k) {
+        clients.emplace_back([&, k] {
+            results[k] = run_client(gateway.port(), orders, k, sessions, window, k == 0 ? rtt_ns : nullptr);
+        });
+    }
+    for (auto& t : clients) t.join();
+    const double secs = std::chrono::duration<double>(Clock::now() - start).count();
+    for (int i = 0; i < 400 && gateway.session_counters().closed < sessions; ++i) usleep(5000);
+    gateway.stop();
+    server.join();
+
+    Result r{orders.size() / secs, 0, 0, true};
+    uint64_t acks = 0;
+    for (const auto& c : results) { acks += c.acks; r.execs += c.execs; }
+    r.syscalls = double(gateway.io_syscalls()) / orders.size();
+    r.complete = acks == orders.size();
+    if (stages) *stages = gateway.pipeline_stats();
+    return r;
+}
+
+void report_stages(const PipelineStats& ps) {
+    auto row = [](const char* name, const StageStats& st) {
+        std::cout << "    " << std::left << std::setw(9) << name << std::right
+                  << std::setw(9) << st.items << " items  depth mean " << std::setprecision(1)
+                  << std::setw(6) << st.mean_depth() << " max " << std::setw(5) << st.depth_max
+                  << "  wait mean " << std::setw(7) << st.mean_wait_ns() / 1e3 << " us  max "
+                  << std::setw(7) << double(st.wait_ns_max) / 1e3 << " us  stalls " << st.stalls << "\n";
+    };
+    row("io", ps.io);
+    row("matching", ps.matching);
+    row("egress", ps.egress);
+}
+
+void report_latency(const std::string& name, std::vector<uint64_t> rtt) {
+    std::sort(rtt.begin(), rtt.end());
+    auto at = [&](double p) { return rtt.empty() ? 0.0 : double(rtt[size_t(p * (rtt.size() - 1))]) / 1e3; };
+    std::cout << "  " << std::left << std::setw(18) << name << std::right << std::setprecision(1)
+              << "p50 " << std::setw(6) << at(0.50) << " us   p99 " << std::setw(6) << at(0.99)
+              << " us   p99.9 " << std::setw(7) << at(0.999) << " us\n";
+}
+
+void report(const std::string& name, const Result& r, double base) {
+    std::cout << "  " << std::left << std::setw(18) << name << std::right
+              << std::setw(9) << std::setprecision(0) << r.rate << " msg/s  "
+              << std::setw(6) << std::setprecision(2) << r.syscalls << " syscalls/msg  "
+              << std::setw(8) << r.execs << " execs";
+    if (base > 0) std::cout << "   (" << r.rate / base << "x per-message)";
+    if (!r.complete) std::cout << "   !! missing acks";
+    std::cout << "\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const CliArgs args = parse(argc, argv);
+    const auto orders = make_flow(args.orders);
+
+    std::cout << "\n──────── Order-entry gateway over loopback (" << args.orders << " orders, window "
+              << args.window << ", " << std::thread::hardware_concurrency() << " hw threads) ────────\n";
+    std::cout << std::fixed;
+
+    const std::string xN = " x" + std::to_string(args.sessions);
+    const auto epoll = backend_options(GatewayBackend::Epoll);
+
+    const Result base = bench_per_message(orders, args.window);
+    report("per-message", base, 0);
+    const Result blocking = bench_blocking(orders, args.window);
+    report("blocking", blocking, base.rate);
+    report("epoll x1", bench_event_loop(orders, args.window, 1, epoll), base.rate);
+    report("epoll" + xN, bench_event_loop(orders, args.window, args.sessions, epoll), base.rate);
+    const auto piped = backend_options(GatewayBackend::Epoll, false, true);
+    report("pipelined x1", bench_event_loop(orders, args.window, 1, piped), base.rate);
+    PipelineStats stages;
+    report("pipelined" + xN, bench_event_loop(orders, args.window, args.sessions, piped, nullptr, &stages),
+           base.rate);
+    report_stages(stages);
+#if MICRO_EXCHANGE_HAS_IO_URING
+    const auto uring  = backend_options(GatewayBackend::IoUring);
+    const auto sqpoll = backend_options(GatewayBackend::IoUring, true);
+    report("io_uring x1", bench_event_loop(orders, args.window, 1, uring), base.rate);
+    report("io_uring" + xN, bench_event_loop(orders, args.window, args.sessions, uring), base.rate);
+    report("io_uring+sqpoll x1", bench_event_loop(orders, args.window, 1, sqpoll), base.rate);
+#endif
+
+    // One session, same order: the buffered path must match the same way.
+    if (blocking.execs != base.execs) std::cout << "  !! exec count differs from per-message\n";
+
+    // ── Lock-step round trips ──
+    const std::vector<WireNewOrder> pings(orders.begin(), orders.begin() + std::min(args.pings, orders.size()));
+    std::cout << "\n  lock-step round trip (" << pings.size() << " orders)\n";
+    std::vector<uint64_t> rtt;
+    bench_blocking(pings, 1, &rtt);
+    report_latency("blocking", std::move(rtt));
+    rtt = {};
+    bench_event_loop(pings, 1, 1, epoll, &rtt);
+    report_latency("epoll", std::move(rtt));
+    rtt = {};
+    bench_event_loop(pings, 1, 1, piped, &rtt);
+    report_latency("pipelined", std::move(rtt));
+#if MICRO_EXCHANGE_HAS_IO_URING
+    rtt = {};
+    bench_event_loop(pings, 1, 1, uring, &rtt);
+    report_latency("io_uring", std::move(rtt));
+    rtt = {};
+    {
+        OrderGateway probe(sqpoll, SYM);
+        if (!probe.sqpoll_active()) std::cout << "  (SQPOLL refused here: io_uring+sqpoll ran without it)\n";
+    }
+    bench_event_loop(pings, 1, 1, sqpoll, &rtt);
+    report_latency("io_uring+sqpoll", std::move(rtt));
+#endif
+    return 0;
+}
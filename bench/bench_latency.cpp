@@ -6,15 +6,30 @@
  * along with min/max. The intent is to give a quick "is anything regressing"
  * signal that can be wired into CI or run by hand before tagging a release.
  *
+ * Three scenarios run back to back:
+ *   • limit/market — plain limit and market flow (the original benchmark)
+ *   • stop-heavy   — the same flow on a book with --stops parked stops
+ *                    spread away from the market, plus ~10% new stops near
+ *                    the touch (many trigger) and ~5% stop cancels. This is
+ *                    the cost the per-print stop check adds to every order.
+ *   • probed       — limit/market again with every order timed: each one is
+ *                    submitted under an active OrderTrace, so the books stamp
+ *                    BookEntry and FirstFill. Against limit/market this is
+ *                    the probes' cost on a sampled order; an unsampled one
+ *                    pays a thread-local null check, and configuring with
+ *                    -DMICRO_EXCHANGE_PROBES=OFF compiles even that out.
+ *
  * Usage:
  *   ./bench_latency                 # 1M operations against a 10x5 seeded book
  *   ./bench_latency --ops 5000000   # 5M operations
  *   ./bench_latency --warmup 200000 # warmup count before timing starts
+ *   ./bench_latency --stops 50000   # parked-stop depth for the stop scenario
  */
 
 #include "MatchingEngine.h"
 #include "OrderBook.h"
 #include "Order.h"
+#include "LatencyProbe.h"
 
 #include <algorithm>
 #include <chrono>
@@ -33,6 +48,7 @@ namespace {
 struct CliArgs {
     size_t ops    = 1'000'000;
     size_t warmup =   100'000;
+    size_t stops  =    20'000;
 };
 
 CliArgs parse(int argc, char** argv) {
@@ -41,8 +57,9 @@ CliArgs parse(int argc, char** argv) {
         std::string s = argv[i];
         if (s == "--ops" && i + 1 < argc)    a.ops    = std::stoull(argv[++i]);
         else if (s == "--warmup" && i + 1 < argc) a.warmup = std::stoull(argv[++i]);
+        else if (s == "--stops" && i + 1 < argc)  a.stops  = std::stoull(argv[++i]);
         else if (s == "--help") {
-            std::cout << "usage: bench_latency [--ops N] [--warmup N]\n";
+            std::cout << "usage: bench_latency [--ops N] [--warmup N] [--stops N]\n";
             std::exit(0);
         }
     }
@@ -78,19 +95,27 @@ double percentile(std::vector<uint64_t>& v, double p) {
     return static_cast<double>(v[idx]);
 }
 
-} // namespace
-
-int main(int argc, char** argv) {
-    CliArgs args = parse(argc, argv);
-
-    std::cout << "\n  MicroExchange — Latency Benchmark\n";
-    std::cout << "  ─────────────────────────────────\n";
-    std::cout << "  Operations:  " << args.ops << "\n";
-    std::cout << "  Warmup:      " << args.warmup << "\n\n";
+NewOrderRequest make_stop(OrderId id, Side side, Price stop, SymbolId sym_id, const char* sym) {
+    NewOrderRequest req{};
+    req.id         = id;
+    req.side       = side;
+    req.type       = OrderType::Stop;
+    req.tif        = TimeInForce::GTC;
+    req.price      = PRICE_MARKET;
+    req.stop_price = stop;
+    req.quantity   = 100;
+    req.symbol_id  = sym_id;
+    std::strncpy(req.symbol, sym, 15);
+    return req;
+}
 
+// Runs warmup + timed ops on a fresh seeded book; returns per-op latencies.
+std::vector<uint64_t> run_scenario(const CliArgs& args, bool stop_heavy, bool probed,
+                                   double& wall_sec) {
     const char* sym = "BENCH";
     MatchingEngine engine;
     engine.add_symbol(sym);
+    const SymbolId sym_id = engine.symbol_id(sym);   // resolved once, like a session logon
     seed_book(engine, sym, 10000);
 
     std::mt19937_64 rng(0xBEEFCAFE);
@@ -98,9 +123,46 @@ int main(int argc, char** argv) {
     std::uniform_int_distribution<int>      type_dist(0, 9);
     std::uniform_int_distribution<Price>    price_dist(9990, 10010);
     std::uniform_int_distribution<Quantity> qty_dist(1, 5);
+    std::uniform_int_distribution<int>      op_dist(0, 99);
+    std::uniform_int_distribution<Price>    near_dist(3, 20);
 
     OrderId id = 100'000;
+    OrderTrace trace;
+    std::vector<OrderId> parked;   // stop ids to draw cancels from
+
+    // Deep stop book away from the market: buys above, sells below.
+    if (stop_heavy) {
+        for (size_t i = 0; i < args.stops; ++i) {
+            bool buy = i & 1;
+            Price off = 200 + static_cast<Price>(i % 4000);
+            engine.submit_order(make_stop(id, buy ? Side::Buy : Side::Sell,
+                                          buy ? 10000 + off : 10000 - off, sym_id, sym));
+            parked.push_back(id++);
+        }
+    }
+
     auto submit_random = [&]() {
+        if (stop_heavy) {
+            int op = op_dist(rng);
+            if (op < 10) {                     // stop near the touch
+                bool buy = side_dist(rng);
+                Price stop = buy ? 10000 + near_dist(rng) : 10000 - near_dist(rng);
+                engine.submit_order(make_stop(id, buy ? Side::Buy : Side::Sell, stop, sym_id, sym));
+                parked.push_back(id++);
+                return;
+            }
+            if (op < 15 && !parked.empty()) {  // cancel a (possibly fired) stop
+                size_t k = rng() % parked.size();
+                CancelRequest c{};
+                c.order_id  = parked[k];
+                c.symbol_id = sym_id;
+                std::strncpy(c.symbol, sym, 15);
+                engine.cancel_order(c);
+                parked[k] = parked.back();
+                parked.pop_back();
+                return;
+            }
+        }
         NewOrderRequest req{};
         req.id = id++;
         req.side = side_dist(rng) ? Side::Buy : Side::Sell;
@@ -109,8 +171,15 @@ int main(int argc, char** argv) {
         req.tif  = is_market ? TimeInForce::IOC   : TimeInForce::GTC;
         req.price = is_market ? PRICE_MARKET : price_dist(rng);
         req.quantity = qty_dist(rng) * 100;
+        req.symbol_id = sym_id;
         std::strncpy(req.symbol, sym, 15);
-        engine.submit_order(req);
+        if (probed) {
+            trace = OrderTrace{id, req.id, {}};
+            probe::Scope scope(&trace);
+            engine.submit_order(req);
+        } else {
+            engine.submit_order(req);
+        }
     };
 
     // Warmup
@@ -129,9 +198,16 @@ int main(int argc, char** argv) {
     }
     auto t_end = std::chrono::steady_clock::now();
 
-    double wall_sec =
-        std::chrono::duration<double>(t_end - t_start).count();
+    wall_sec = std::chrono::duration<double>(t_end - t_start).count();
+    if (stop_heavy) {
+        const auto* book = engine.get_book(sym);
+        std::cout << "  parked stops at end: " << book->parked_stop_count()
+                  << ", triggered: " << book->stop_triggered_count() << "\n";
+    }
+    return latencies;
+}
 
+void report(const char* name, std::vector<uint64_t>& latencies, size_t ops, double wall_sec) {
     double p50 = percentile(latencies, 0.50);
     double p90 = percentile(latencies, 0.90);
     double p95 = percentile(latencies, 0.95);
@@ -140,7 +216,8 @@ int main(int argc, char** argv) {
     auto mm = std::minmax_element(latencies.begin(), latencies.end());
 
     std::cout << std::fixed << std::setprecision(0);
-    std::cout << "  Throughput:  " << (args.ops / wall_sec) << " ops/sec\n\n";
+    std::cout << "  [" << name << "]\n";
+    std::cout << "  Throughput:  " << (ops / wall_sec) << " ops/sec\n\n";
 
     std::cout << "  Latency (nanoseconds)\n";
     std::cout << "  ─────────────────────\n";
@@ -151,6 +228,28 @@ int main(int argc, char** argv) {
     std::cout << "  p99        " << p99  << "\n";
     std::cout << "  p99.9      " << p999 << "\n";
     std::cout << "  max        " << *mm.second << "\n\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    CliArgs args = parse(argc, argv);
+
+    std::cout << "\n  MicroExchange — Latency Benchmark\n";
+    std::cout << "  ─────────────────────────────────\n";
+    std::cout << "  Operations:  " << args.ops << "\n";
+    std::cout << "  Warmup:      " << args.warmup << "\n";
+    std::cout << "  Stops:       " << args.stops << " (stop-heavy scenario)\n\n";
+
+    double wall = 0;
+    auto base = run_scenario(args, false, false, wall);
+    report("limit/market", base, args.ops, wall);
+
+    auto stops = run_scenario(args, true, false, wall);
+    report("stop-heavy", stops, args.ops, wall);
+
+    auto probed = run_scenario(args, false, true, wall);
+    report(MICRO_EXCHANGE_PROBES ? "probed" : "probed (compiled out)", probed, args.ops, wall);
 
     return 0;
 }
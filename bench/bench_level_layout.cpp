@@ -0,0 +1,216 @@
+/*
+ * bench_level_layout.cpp - deep-queue sweep: Order/PriceLevel vs hot/cold split.
+ *
+ * An aggressive order that takes out a deep price level walks the whole FIFO
+ * queue. This isolates that walk and compares two resting-order layouts:
+ *
+ *   • Order + PriceLevel  — 128-byte records, 64-bit prev/next, what both
+ *                           books use today (ArenaAllocator slabs)
+ *   • CompactOrderStore   — 32-byte HotOrder (id, seq, leaves, 32-bit links)
+ *                           with cold fields in a parallel array
+ *
+ * Orders for several levels are allocated round-robin so a level's queue is
+ * strided through memory the way it is in a live book, not contiguous. Each
+ * run builds the book (untimed) and then sweeps one level with a single
+ * aggressor that fills every resting order, constructing the same Trade per
+ * fill as ArrayOrderBook::fill_against_level. Reports ns per filled order
+ * (best of --reps) and checks both layouts emit the same fills.
+ *
+ * Usage:
+ *   ./bench_level_layout              # depths 1k, 16k, 256k; 5 reps
+ *   ./bench_level_layout --reps 10
+ */
+
+#include "CompactOrder.h"
+#include "PriceLevel.h"
+#include "ArenaAllocator.h"
+#include "Order.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace micro_exchange::core;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t LEVELS = 4;   // levels interleaved in memory
+constexpr Price  SWEPT  = 10000;
+
+struct CliArgs {
+    size_t reps = 5;
+};
+
+CliArgs parse(int argc, char** argv) {
+    CliArgs a;
+    for (int i = 1; i < argc; ++i) {
+        std::string s = argv[i];
+        if (s == "--reps" && i + 1 < argc) a.reps = std::stoull(argv[++i]);
+        else if (s == "--help") {
+            std::cout << "usage: bench_level_layout [--reps N]\n";
+            std::exit(0);
+        }
+    }
+    return a;
+}
+
+NewOrderRequest resting_req(OrderId id, Price price) {
+    NewOrderRequest r{};
+    r.id       = id;
+    r.side     = Side::Sell;
+    r.type     = OrderType::Limit;
+    r.tif      = TimeInForce::GTC;
+    r.price    = price;
+    r.quantity = 100 + (id % 7) * 100;
+    std::memcpy(r.symbol, "BENCH", 6);
+    return r;
+}
+
+Trade make_trade(SeqNum seq, OrderId buy, OrderId sell, Price px, Quantity q, Timestamp ts) {
+    Trade t{};
+    t.sequence      = seq;
+    t.buy_order_id  = buy;
+    t.sell_order_id = sell;
+    t.price         = px;
+    t.quantity      = q;
+    t.exec_time     = ts;
+    t.aggressor     = Side::Buy;
+    std::memcpy(t.symbol, "BENCH", 6);
+    return t;
+}
+
+struct Result {
+    double   ns_per_fill = 0;
+    uint64_t checksum    = 0;
+    uint64_t fills       = 0;
+};
+
+Result run_legacy(size_t depth, size_t reps) {
+    Result r;
+    double best = 1e300;
+    for (size_t rep = 0; rep < reps; ++rep) {
+        ArenaAllocator<Order> arena(depth * LEVELS);
+        std::vector<PriceLevel> levels;
+        for (size_t l = 0; l < LEVELS; ++l) levels.emplace_back(SWEPT + static_cast<Price>(l));
+
+        const Timestamp ts = now();
+        OrderId id = 1;
+        for (size_t i = 0; i < depth; ++i) {
+            for (size_t l = 0; l < LEVELS; ++l) {
+                NewOrderRequest req = resting_req(id++, levels[l].price());
+                Order* o = arena.construct();
+                o->id = req.id; o->side = req.side; o->type = req.type; o->tif = req.tif;
+                o->price = req.price; o->quantity = req.quantity; o->leaves_qty = req.quantity;
+                o->entry_time = o->last_update = ts;
+                std::memcpy(o->symbol, req.symbol, sizeof(o->symbol));
+                levels[l].push_back(o);
+            }
+        }
+
+        PriceLevel& level = levels[0];
+        Order incoming;
+        incoming.id = id;
+        incoming.side = Side::Buy;
+        incoming.quantity = incoming.leaves_qty = level.total_quantity();
+        SeqNum seq = 1;
+        uint64_t sum = 0, fills = 0;
+
+        auto t0 = Clock::now();
+        while (incoming.leaves_qty > 0 && !level.empty()) {
+            Order* resting = level.front();
+            Quantity q = std::min(incoming.leaves_qty, resting->leaves_qty);
+            Trade t = make_trade(seq++, incoming.id, resting->id, level.price(), q, ts);
+            level.reduce_quantity(q);
+            incoming.fill(q, ts);
+            resting->fill(q, ts);
+            sum += t.sell_order_id * 31 + t.quantity;
+            ++fills;
+            if (resting->is_filled()) level.pop_front();
+        }
+        auto t1 = Clock::now();
+
+        best = std::min(best, std::chrono::duration<double, std::nano>(t1 - t0).count());
+        r.checksum = sum;
+        r.fills    = fills;
+    }
+    r.ns_per_fill = best / static_cast<double>(r.fills);
+    return r;
+}
+
+Result run_compact(size_t depth, size_t reps) {
+    Result r;
+    double best = 1e300;
+    for (size_t rep = 0; rep < reps; ++rep) {
+        CompactOrderStore store(depth * LEVELS);
+        std::vector<CompactPriceLevel> levels;
+        for (size_t l = 0; l < LEVELS; ++l) levels.emplace_back(SWEPT + static_cast<Price>(l));
+
+        const Timestamp ts = now();
+        OrderId id = 1;
+        for (size_t i = 0; i < depth; ++i) {
+            for (size_t l = 0; l < LEVELS; ++l) {
+                OrderHandle h = store.allocate(resting_req(id, levels[l].price()), id, ts);
+                ++id;
+                levels[l].push_back(store, h);
+            }
+        }
+
+        CompactPriceLevel& level = levels[0];
+        const OrderId incoming_id = id;
+        SeqNum seq = 1;
+        uint64_t sum = 0, fills = 0;
+
+        auto t0 = Clock::now();
+        level.sweep(store, level.total_quantity(), [&](OrderHandle h, Quantity q) {
+            Trade t = make_trade(seq++, incoming_id, store.hot(h).id, level.price(), q, ts);
+            sum += t.sell_order_id * 31 + t.quantity;
+            ++fills;
+        });
+        auto t1 = Clock::now();
+
+        best = std::min(best, std::chrono::duration<double, std::nano>(t1 - t0).count());
+        r.checksum = sum;
+        r.fills    = fills;
+    }
+    r.ns_per_fill = best / static_cast<double>(r.fills);
+    return r;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    auto args = parse(argc, argv);
+
+    std::cout << "\n  MicroExchange — Deep-Queue Sweep (resting-order layout)\n";
+    std::cout << "  ────────────────────────────────────────────────────────\n";
+    std::cout << "  sizeof(Order) = " << sizeof(Order) << " B, sizeof(HotOrder) = "
+              << sizeof(HotOrder) << " B, " << LEVELS << " levels interleaved, best of "
+              << args.reps << "\n\n";
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "  " << std::left << std::setw(10) << "depth"
+              << std::right << std::setw(16) << "Order ns/fill"
+              << std::setw(18) << "HotOrder ns/fill"
+              << std::setw(10) << "speedup" << "\n";
+
+    bool identical = true;
+    for (size_t depth : {size_t{1'000}, size_t{16'000}, size_t{256'000}}) {
+        Result a = run_legacy(depth, args.reps);
+        Result b = run_compact(depth, args.reps);
+        identical = identical && a.checksum == b.checksum && a.fills == b.fills;
+        std::cout << "  " << std::left << std::setw(10) << depth
+                  << std::right << std::setw(16) << a.ns_per_fill
+                  << std::setw(18) << b.ns_per_fill
+                  << std::setw(9) << a.ns_per_fill / b.ns_per_fill << "x\n";
+    }
+
+    std::cout << "\n  identical fills: " << (identical ? "YES" : "NO") << "\n\n";
+    return identical ? 0 : 1;
+}
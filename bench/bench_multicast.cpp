@@ -0,0 +1,173 @@
+/*
+ * bench_multicast.cpp - MulticastFeedPublisher send rate and latency.
+ *
+ * A producer thread pushes feed messages (Adds, 4-character symbol) into a
+ * MulticastFeedPublisher; a receiver on the same host joins the group and
+ * timestamps every message as it comes out of its packet. Latency is
+ * receive time minus the time the producer pushed the message, so it
+ * includes the ring, the packing delay, the kernel loopback and the
+ * receiver's wake-up.
+ *
+ * Scenarios:
+ *   • burst   — push as fast as the ring takes them (send rate)
+ *   • paced   — a fixed message rate, once per flush_us setting: small
+ *               flush_us sends more, emptier packets sooner
+ *
+ * Runs on loopback multicast (239.192.0.1) and falls back to unicast
+ * 127.0.0.1 where the host has no multicast route.
+ *
+ * Usage:
+ *   ./bench_multicast                        # 1M burst, 200k paced at 100k msg/s
+ *   ./bench_multicast --messages 5000000 --rate 250000
+ */
+
+#include "MulticastFeed.h"
+#include "FeedMessage.h"
+#include "Order.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace micro_exchange;
+using namespace micro_exchange::net;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct CliArgs {
+    size_t messages = 1'000'000;
+    size_t paced    =   200'000;
+    double rate     =   100'000;   // msg/s in the paced runs
+};
+
+CliArgs parse(int argc, char** argv) {
+    CliArgs a;
+    for (int i = 1; i < argc; ++i) {
+        std::string s = argv[i];
+        if (s == "--messages" && i + 1 < argc)   a.messages = std::stoull(argv[++i]);
+        else if (s == "--paced" && i + 1 < argc) a.paced    = std::stoull(argv[++i]);
+        else if (s == "--rate" && i + 1 < argc)  a.rate     = std::stod(argv[++i]);
+        else if (s == "--help") {
+            std::cout << "usage: bench_multicast [--messages N] [--paced N] [--rate MSG_PER_SEC]\n";
+            std::exit(0);
+        }
+    }
+    return a;
+}
+
+uint64_t now_ns() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count());
+}
+
+double percentile(std::vector<uint64_t>& v, double p) {
+    if (v.empty()) return 0;
+    size_t idx = static_cast<size_t>(p * (v.size() - 1));
+    std::nth_element(v.begin(), v.begin() + idx, v.end());
+    return static_cast<double>(v[idx]);
+}
+
+struct Result {
+    double   send_rate = 0;   // msg/s pushed
+    uint64_t received  = 0;
+    uint64_t lost      = 0;
+    MulticastFeedPublisher::Stats stats;
+    std::vector<uint64_t> latency;
+};
+
+Result run(const std::string& group, size_t n, double rate, uint32_t flush_us) {
+    MulticastFeedReceiver rx(group, 0);
+    MulticastFeedPublisher::Options opts;
+    opts.group    = group;
+    opts.port     = rx.port();
+    opts.flush_us = flush_us;
+    MulticastFeedPublisher pub(opts);
+
+    Result res;
+    res.latency.reserve(n);
+    std::thread receiver([&] {
+        while (auto pkt = rx.receive(2000)) {
+            const uint64_t t = now_ns();
+            res.lost += pkt->gap_count;
+            for (const auto& m : pkt->messages) res.latency.push_back(t - m.timestamp_ns);
+            res.received += pkt->messages.size();
+            if (pkt->end_of_session()) break;
+        }
+    });
+
+    md::FeedMessage m{};
+    m.type       = md::FeedMessageType::AddOrder;
+    m.side       = core::Side::Buy;
+    m.order_type = core::OrderType::Limit;
+    m.quantity   = 100;
+    std::memcpy(m.symbol, "BNCH", 4);
+
+    const auto start = Clock::now();
+    const auto gap   = rate > 0 ? std::chrono::nanoseconds(static_cast<int64_t>(1e9 / rate))
+                                : std::chrono::nanoseconds(0);
+    for (size_t i = 0; i < n; ++i) {
+        if (rate > 0) {
+            const auto due = start + gap * static_cast<int64_t>(i);
+            while (Clock::now() < due) std::this_thread::yield();
+        }
+        m.sequence     = i + 1;
+        m.order_id     = i + 1;
+        m.price        = 10000 + static_cast<core::Price>(i % 50);
+        m.timestamp_ns = now_ns();
+        pub.push(m);
+    }
+    const double secs = std::chrono::duration<double>(Clock::now() - start).count();
+    pub.close();
+    receiver.join();
+
+    res.send_rate = n / secs;
+    res.stats     = pub.stats();
+    return res;
+}
+
+void report(const char* name, Result& r) {
+    const auto& s = r.stats;
+    std::cout << "  " << std::left << std::setw(16) << name << std::right
+              << std::setw(8) << r.send_rate / 1e3 << "k msg/s  "
+              << std::setw(7) << s.packets << " pkts ("
+              << std::setw(5) << (s.packets ? double(s.messages) / s.packets : 0) << " msg/pkt, "
+              << s.flush_timer << " on timer)  "
+              << "lat p50 " << std::setw(8) << percentile(r.latency, 0.50) / 1e3 << " us, p99 "
+              << std::setw(8) << percentile(r.latency, 0.99) / 1e3 << " us"
+              << (r.lost ? "  lost " + std::to_string(r.lost) : std::string()) << "\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const CliArgs args = parse(argc, argv);
+
+    std::string group = "239.192.0.1";
+    {
+        MulticastFeedReceiver probe(group, 0);
+        if (!probe.joined()) group = "127.0.0.1";
+    }
+
+    std::cout << "\n──────── MulticastFeedPublisher (" << group << ") ────────\n";
+    std::cout << std::fixed << std::setprecision(1);
+
+    auto burst = run(group, args.messages, 0, 50);
+    report("burst", burst);
+
+    for (uint32_t flush : {0u, 10u, 50u, 200u}) {
+        auto r = run(group, args.paced, args.rate, flush);
+        const std::string name = "paced, " + std::to_string(flush) + " us";
+        report(name.c_str(), r);
+    }
+    std::cout << "  (latency: push to receive; a lost packet means the receiver fell behind)\n";
+    return 0;
+}
@@ -0,0 +1,186 @@
+/*
+ * bench_order_index.cpp - OrderIndex vs std::unordered_map under add/cancel churn.
+ *
+ * The books look up every cancel and amend by OrderId. This isolates that
+ * index and replays the same operation stream against:
+ *
+ *   • std::unordered_map<OrderId, Order*>  (what the books used to hold)
+ *   • OrderIndex                           (open addressing, pre-sized)
+ *
+ * Two phases per live-order count:
+ *   1. fill  — insert N sequential ids into an empty index. The map grows
+ *              and rehashes as it goes; OrderIndex was reserved for N.
+ *   2. churn — keep N orders live: each step cancels a random live id,
+ *              looks up another (the amend path) and inserts a fresh id.
+ *
+ * Reports ns/op for each phase plus p99 / max per-op latency during churn —
+ * the max column is where rehash stalls and allocator hiccups show up.
+ *
+ * Usage:
+ *   ./bench_order_index               # N = 10k, 100k, 1M; 2M churn steps
+ *   ./bench_order_index --steps 5000000
+ */
+
+#include "OrderIndex.h"
+#include "Order.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace micro_exchange::core;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct CliArgs {
+    size_t steps = 2'000'000;
+};
+
+CliArgs parse(int argc, char** argv) {
+    CliArgs a;
+    for (int i = 1; i < argc; ++i) {
+        std::string s = argv[i];
+        if (s == "--steps" && i + 1 < argc) a.steps = std::stoull(argv[++i]);
+        else if (s == "--help") {
+            std::cout << "usage: bench_order_index [--steps N]\n";
+            std::exit(0);
+        }
+    }
+    return a;
+}
+
+// Thin adapters so one driver runs both containers.
+struct MapIndex {
+    std::unordered_map<OrderId, Order*> m;
+    explicit MapIndex(size_t) {}
+    void   insert(OrderId id, Order* o) { m[id] = o; }
+    Order* find(OrderId id) const { auto it = m.find(id); return it == m.end() ? nullptr : it->second; }
+    bool   erase(OrderId id) { return m.erase(id) != 0; }
+};
+
+struct OpenIndex {
+    OrderIndex ix;
+    explicit OpenIndex(size_t n) : ix(n) {}
+    void   insert(OrderId id, Order* o) { ix.insert(id, o); }
+    Order* find(OrderId id) const { return ix.find(id); }
+    bool   erase(OrderId id) { return ix.erase(id); }
+};
+
+// Pre-generated churn: which live slot to cancel and which to look up.
+struct Step { uint32_t cancel_slot; uint32_t lookup_slot; };
+
+struct Result {
+    double   fill_ns  = 0;
+    double   churn_ns = 0;
+    uint64_t p99_ns   = 0;
+    uint64_t max_ns   = 0;
+    uint64_t checksum = 0;   // must match across containers
+};
+
+template <typename Index>
+Result run(size_t n_live, const std::vector<Step>& steps, std::vector<Order>& pool) {
+    Result r;
+    Index index(n_live);
+
+    // Orders are just addresses to the index; cycle through a fixed pool.
+    auto order_for = [&](OrderId id) { return &pool[id % pool.size()]; };
+
+    std::vector<OrderId> live;
+    live.reserve(n_live);
+
+    auto t0 = Clock::now();
+    for (OrderId id = 1; id <= n_live; ++id) {
+        index.insert(id, order_for(id));
+        live.push_back(id);
+    }
+    auto t1 = Clock::now();
+    r.fill_ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / n_live;
+
+    std::vector<uint64_t> lat;
+    lat.reserve(steps.size());
+    OrderId next_id = n_live + 1;
+
+    auto c0 = Clock::now();
+    for (const Step& s : steps) {
+        auto a = Clock::now();
+        OrderId victim = live[s.cancel_slot % live.size()];
+        r.checksum += index.erase(victim);
+        Order* o = index.find(live[s.lookup_slot % live.size()]);
+        r.checksum += reinterpret_cast<uintptr_t>(o) != 0;
+        index.insert(next_id, order_for(next_id));
+        live[s.cancel_slot % live.size()] = next_id++;
+        auto b = Clock::now();
+        lat.push_back(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(b - a).count()));
+    }
+    auto c1 = Clock::now();
+    r.churn_ns = std::chrono::duration<double, std::nano>(c1 - c0).count() / steps.size();
+
+    // Final sweep: every live id must still resolve.
+    for (OrderId id : live) r.checksum += index.find(id) == order_for(id);
+
+    std::sort(lat.begin(), lat.end());
+    r.p99_ns = lat[static_cast<size_t>(0.99 * (lat.size() - 1))];
+    r.max_ns = lat.back();
+    return r;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    auto args = parse(argc, argv);
+
+    std::cout << "\n  MicroExchange — Order-ID Index Benchmark\n";
+    std::cout << "  ────────────────────────────────────────\n";
+    std::cout << "  Churn steps: " << args.steps << " (cancel + lookup + insert)\n\n";
+
+    std::vector<Order> pool(4096);
+
+    std::mt19937_64 rng(0xC0FFEE);
+    std::vector<Step> steps(args.steps);
+    for (auto& s : steps) {
+        s.cancel_slot = static_cast<uint32_t>(rng());
+        s.lookup_slot = static_cast<uint32_t>(rng());
+    }
+
+    bool identical = true;
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "  " << std::left << std::setw(10) << "live"
+              << std::setw(16) << "index"
+              << std::right << std::setw(10) << "fill ns"
+              << std::setw(11) << "churn ns"
+              << std::setw(10) << "p99 ns"
+              << std::setw(11) << "max ns" << "\n";
+
+    for (size_t n : {size_t{10'000}, size_t{100'000}, size_t{1'000'000}}) {
+        Result m = run<MapIndex>(n, steps, pool);
+        Result o = run<OpenIndex>(n, steps, pool);
+        identical = identical && (m.checksum == o.checksum);
+
+        auto row = [&](const char* name, const Result& r) {
+            std::cout << "  " << std::left << std::setw(10) << n
+                      << std::setw(16) << name
+                      << std::right << std::setw(10) << r.fill_ns
+                      << std::setw(11) << r.churn_ns
+                      << std::setw(10) << r.p99_ns
+                      << std::setw(11) << r.max_ns << "\n";
+        };
+        row("unordered_map", m);
+        row("OrderIndex", o);
+        std::cout << "  " << std::setw(26) << "" << "churn speedup: "
+                  << std::setprecision(2) << (m.churn_ns / o.churn_ns) << "x\n"
+                  << std::setprecision(1);
+    }
+
+    std::cout << "\n  identical lookup results: " << (identical ? "YES" : "NO") << "\n\n";
+    return identical ? 0 : 1;
+}
@@ -16,6 +16,11 @@
  *
  * Methodology: orders are pre-generated, so we time only the matching loop, not
  * RNG. Same seed and same workload feed both books.
+ *
+ * The correctness pass runs two streams: the plain Limit/Market workload used
+ * for timing, and a mixed stream with Stop/StopLimit, cancels, amends and a
+ * drifting mid that walks out of the array book's initial band (forcing it to
+ * re-center). Both must match for the CI gate to pass.
  */
 
 #include "../core/include/OrderBook.h"
@@ -97,6 +102,86 @@ std::vector<TradeKey> collect_trades(Book& book, const std::vector<NewOrderReque
     return trades;
 }
 
+// ─────────────────────────────────────────────
+// Mixed workload: stops, cancels, amends, drifting mid
+// ─────────────────────────────────────────────
+struct MixedOp {
+    enum class Kind : uint8_t { New, Cancel, Amend } kind;
+    NewOrderRequest req{};
+    AmendRequest    amend{};
+    OrderId         cancel_id = 0;
+};
+
+std::vector<MixedOp> generate_mixed(size_t count, uint64_t seed = 7) {
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<int>      roll(0, 99);
+    std::uniform_int_distribution<Price>    offset(0, 12);
+    std::uniform_int_distribution<Quantity> qty_dist(1, 10);
+    std::uniform_int_distribution<int>      drift(-2, 3);   // net upward walk
+
+    std::vector<MixedOp> ops;
+    ops.reserve(count);
+    Price mid = 10000;
+    OrderId next_id = 1;
+    for (size_t i = 0; i < count; ++i) {
+        if (i % 64 == 0) mid += drift(rng);
+        const int r = roll(rng);
+        MixedOp op{};
+        if (r < 12 && next_id > 1) {
+            op.kind = MixedOp::Kind::Cancel;
+            op.cancel_id = 1 + rng() % (next_id - 1);
+        } else if (r < 20 && next_id > 1) {
+            op.kind = MixedOp::Kind::Amend;
+            op.amend.order_id = 1 + rng() % (next_id - 1);
+            if (roll(rng) < 50) op.amend.new_quantity = qty_dist(rng) * 100;
+            else                op.amend.new_price    = mid + offset(rng) - 6;
+        } else {
+            op.kind = MixedOp::Kind::New;
+            NewOrderRequest& q = op.req;
+            q.id   = next_id++;
+            q.side = (rng() % 2) ? Side::Buy : Side::Sell;
+            const bool buy = q.side == Side::Buy;
+            q.quantity = qty_dist(rng) * 100;
+            if (r < 28) {
+                q.type = OrderType::Market; q.tif = TimeInForce::IOC; q.price = PRICE_MARKET;
+            } else if (r < 31) {
+                q.type = OrderType::FOK; q.tif = TimeInForce::FOK;
+                q.price = buy ? mid + offset(rng) : mid - offset(rng);
+            } else if (r < 34) {
+                q.type = OrderType::Stop; q.tif = TimeInForce::GTC;
+                q.stop_price = buy ? mid + offset(rng) : mid - offset(rng);
+            } else if (r < 36) {
+                q.type = OrderType::StopLimit; q.tif = TimeInForce::GTC;
+                q.stop_price = buy ? mid + offset(rng) : mid - offset(rng);
+                q.price      = buy ? q.stop_price + 2 : q.stop_price - 2;
+            } else {
+                q.type = OrderType::Limit; q.tif = TimeInForce::GTC;
+                q.price = buy ? mid - offset(rng) : mid + offset(rng);
+            }
+            std::memcpy(q.symbol, "BENCH", 6);
+        }
+        ops.push_back(op);
+    }
+    return ops;
+}
+
+template <class Book>
+std::vector<TradeKey> collect_mixed(Book& book, const std::vector<MixedOp>& ops) {
+    std::vector<TradeKey> trades;
+    book.set_trade_callback([&](const Trade& t) {
+        trades.push_back({t.buy_order_id, t.sell_order_id, t.price, t.quantity,
+                          static_cast<uint8_t>(t.aggressor)});
+    });
+    for (const auto& op : ops) {
+        switch (op.kind) {
+            case MixedOp::Kind::New:    book.add_order(op.req);          break;
+            case MixedOp::Kind::Cancel: book.cancel_order(op.cancel_id); break;
+            case MixedOp::Kind::Amend:  book.amend_order(op.amend);      break;
+        }
+    }
+    return trades;
+}
+
 template <class Book>
 double time_throughput(Book& book, const std::vector<NewOrderRequest>& orders) {
     auto start = Clock::now();
@@ -139,9 +224,28 @@ int main() {
         bool ok = (map_trades.size() == arr_trades.size()) &&
                   std::equal(map_trades.begin(), map_trades.end(), arr_trades.begin());
 
+        auto ops = generate_mixed(200000);
+        OrderBook      map_mixed("BENCH");
+        ArrayOrderBook arr_mixed("BENCH", 9950, 10050);   // narrow: the mid drifts out
+        auto map_mtrades = collect_mixed(map_mixed, ops);
+        auto arr_mtrades = collect_mixed(arr_mixed, ops);
+
+        bool mixed_ok = (map_mtrades.size() == arr_mtrades.size()) &&
+                        std::equal(map_mtrades.begin(), map_mtrades.end(), arr_mtrades.begin()) &&
+                        map_mixed.best_bid() == arr_mixed.best_bid() &&
+                        map_mixed.best_ask() == arr_mixed.best_ask() &&
+                        map_mixed.stop_triggered_count() == arr_mixed.stop_triggered_count();
+
         std::cout << "\n── Correctness ──\n";
-        std::cout << "  std::map  trades: " << map_trades.size() << "\n";
-        std::cout << "  array     trades: " << arr_trades.size() << "\n";
+        std::cout << "  limit/market flow   std::map " << map_trades.size()
+                  << " trades, array " << arr_trades.size()
+                  << (ok ? "  ✓" : "  ✗") << "\n";
+        std::cout << "  mixed flow          std::map " << map_mtrades.size()
+                  << " trades, array " << arr_mtrades.size()
+                  << (mixed_ok ? "  ✓" : "  ✗") << "\n";
+        std::cout << "    (" << map_mixed.stop_triggered_count() << " stops triggered, "
+                  << arr_mixed.recenter_count() << " band re-centers)\n";
+        ok = ok && mixed_ok;
         std::cout << "  identical trade stream: " << (ok ? "YES ✓" : "NO ✗") << "\n";
         if (!ok) {
             std::cout << "  FATAL: trade streams diverge — aborting benchmark.\n";
@@ -0,0 +1,285 @@
+/*
+ * bench_ring.cpp - SPSC / MPSC ring throughput and round-trip latency.
+ *
+ * Items are FeedMessage-sized (192 bytes), the payload the market-data
+ * rings actually carry. Each throughput scenario moves --items messages
+ * from producer thread(s) to one consumer thread:
+ *
+ *   • lamport      — the plain two-index ring: every push and pop does an
+ *                    acquire load of the other side's index (the old
+ *                    SPSCRingBuffer, kept here as the baseline)
+ *   • push/pop     — SPSCRingBuffer, one item per call, cached indices
+ *   • push_n/pop_n — SPSCRingBuffer, --batch items per call
+ *   • claim/consume— SPSCRingBuffer, written and read in place (no copies
+ *                    through a temporary)
+ *   • mpsc xP      — MPSCRingBuffer with 1, 2 and 4 producers
+ *
+ * Latency is a ping-pong: one message out on one ring, back on another,
+ * timed per round trip (half of it is the one-way hand-off).
+ *
+ * Cross-core numbers need at least two cores; on one core the threads
+ * time-slice and the figures mostly measure the scheduler.
+ *
+ * Usage:
+ *   ./bench_ring                      # 5M items, batch 32, 200k round trips
+ *   ./bench_ring --items 20000000 --batch 64 --pings 1000000
+ */
+
+#include "SPSCRingBuffer.h"
+#include "MPSCRingBuffer.h"
+#include "FeedMessage.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace micro_exchange::md;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+constexpr size_t RING = 1 << 12;
+
+struct CliArgs {
+    size_t items = 5'000'000;
+    size_t batch = 32;
+    size_t pings = 200'000;
+};
+
+CliArgs parse(int argc, char** argv) {
+    CliArgs a;
+    for (int i = 1; i < argc; ++i) {
+        std::string s = argv[i];
+        if (s == "--items" && i + 1 < argc)      a.items = std::stoull(argv[++i]);
+        else if (s == "--batch" && i + 1 < argc) a.batch = std::max<size_t>(1, std::stoull(argv[++i]));
+        else if (s == "--pings" && i + 1 < argc) a.pings = std::stoull(argv[++i]);
+        else if (s == "--help") {
+            std::cout << "usage: bench_ring [--items N] [--batch N] [--pings N]\n";
+            std::exit(0);
+        }
+    }
+    return a;
+}
+
+// The uncached Lamport ring the SPSCRingBuffer started as.
+template <typename T, size_t Capacity>
+class LamportRing {
+    static constexpr size_t MASK = Capacity - 1;
+public:
+    bool push(const T& item) noexcept {
+        const size_t w = write_.load(std::memory_order_relaxed);
+        const size_t next = (w + 1) & MASK;
+        if (next == read_.load(std::memory_order_acquire)) return false;
+        buffer_[w] = item;
+        write_.store(next, std::memory_order_release);
+        return true;
+    }
+    bool pop(T& out) noexcept {
+        const size_t r = read_.load(std::memory_order_relaxed);
+        if (r == write_.load(std::memory_order_acquire)) return false;
+        out = buffer_[r];
+        read_.store((r + 1) & MASK, std::memory_order_release);
+        return true;
+    }
+private:
+    alignas(64) std::atomic<size_t> write_{0};
+    alignas(64) std::atomic<size_t> read_{0};
+    alignas(64) std::array<T, Capacity> buffer_{};
+};
+
+FeedMessage make_message(uint64_t i) {
+    FeedMessage m{};
+    m.type     = FeedMessageType::AddOrder;
+    m.sequence = i;
+    m.order_id = i;
+    m.quantity = 100;
+    return m;
+}
+
+// Runs produce(p) on `producers` threads and consume() on this one; returns
+// items per second. The consumer checks the sequence sum so nothing is lost.
+template <typename Produce, typename Consume>
+double run(size_t producers, size_t total, Produce&& produce, Consume&& consume) {
+    std::atomic<bool> go{false};
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            produce(p);
+        });
+    }
+    const auto start = Clock::now();
+    go.store(true, std::memory_order_release);
+    uint64_t sum = 0;
+    for (size_t got = 0; got < total;) {
+        const size_t n = consume(sum);
+        if (!n) std::this_thread::yield();
+        got += n;
+    }
+    const double secs = std::chrono::duration<double>(Clock::now() - start).count();
+    for (auto& t : threads) t.join();
+    // Producers send sequences 1..per-producer count each.
+    const uint64_t per = total / producers;
+    if (sum != producers * (per * (per + 1) / 2)) std::cout << "  !! checksum mismatch\n";
+    return static_cast<double>(total) / secs;
+}
+
+void report(const char* name, double rate, double base) {
+    std::cout << "  " << std::left << std::setw(16) << name << std::right
+              << std::setw(8) << rate / 1e6 << " M msg/s  "
+              << std::setw(7) << rate * sizeof(FeedMessage) / (1 << 30) << " GiB/s";
+    if (base > 0) std::cout << "   (" << rate / base << "x lamport)";
+    std::cout << "\n";
+}
+
+double bench_lamport(size_t n) {
+    auto ring = std::make_unique<LamportRing<FeedMessage, RING>>();
+    return run(1, n,
+        [&](size_t) {
+            for (uint64_t i = 1; i <= n; ++i) {
+                const FeedMessage m = make_message(i);
+                while (!ring->push(m)) std::this_thread::yield();
+            }
+        },
+        [&](uint64_t& sum) {
+            FeedMessage m;
+            size_t k = 0;
+            while (ring->pop(m)) { sum += m.sequence; ++k; }
+            return k;
+        });
+}
+
+double bench_push_pop(size_t n) {
+    auto ring = std::make_unique<SPSCRingBuffer<FeedMessage, RING>>();
+    return run(1, n,
+        [&](size_t) {
+            for (uint64_t i = 1; i <= n; ++i) {
+                const FeedMessage m = make_message(i);
+                while (!ring->push(m)) std::this_thread::yield();
+            }
+        },
+        [&](uint64_t& sum) {
+            size_t k = 0;
+            while (auto m = ring->pop()) { sum += m->sequence; ++k; }
+            return k;
+        });
+}
+
+double bench_batched(size_t n, size_t batch) {
+    auto ring = std::make_unique<SPSCRingBuffer<FeedMessage, RING>>();
+    std::vector<FeedMessage> out(batch);
+    return run(1, n,
+        [&](size_t) {
+            std::vector<FeedMessage> in(batch);
+            for (uint64_t i = 1; i <= n;) {
+                const size_t k = std::min<uint64_t>(batch, n - i + 1);
+                for (size_t j = 0; j < k; ++j) in[j] = make_message(i + j);
+                for (size_t done = 0; done < k;) {
+                    const size_t pushed = ring->push_n(in.data() + done, k - done);
+                    if (!pushed) std::this_thread::yield();
+                    done += pushed;
+                }
+                i += k;
+            }
+        },
+        [&](uint64_t& sum) {
+            size_t k = 0;
+            while (size_t got = ring->pop_n(out.data(), out.size())) {
+                for (size_t j = 0; j < got; ++j) sum += out[j].sequence;
+                k += got;
+            }
+            return k;
+        });
+}
+
+double bench_in_place(size_t n) {
+    auto ring = std::make_unique<SPSCRingBuffer<FeedMessage, RING>>();
+    return run(1, n,
+        [&](size_t) {
+            for (uint64_t i = 1; i <= n; ++i) {
+                FeedMessage* slot;
+                while (!(slot = ring->claim())) std::this_thread::yield();
+                *slot = make_message(i);
+                ring->commit();
+            }
+        },
+        [&](uint64_t& sum) {
+            return ring->consume([&](const FeedMessage& m) { sum += m.sequence; });
+        });
+}
+
+double bench_mpsc(size_t n, size_t producers) {
+    auto ring = std::make_unique<MPSCRingBuffer<FeedMessage, RING>>();
+    const size_t per = n / producers;
+    return run(producers, per * producers,
+        [&](size_t) {
+            for (uint64_t i = 1; i <= per; ++i) {
+                while (!ring->push_with([&](FeedMessage& slot) { slot = make_message(i); }))
+                    std::this_thread::yield();
+            }
+        },
+        [&](uint64_t& sum) {
+            return ring->consume([&](const FeedMessage& m) { sum += m.sequence; });
+        });
+}
+
+// Round trips: main thread sends on `there`, echo thread returns on `back`.
+void bench_ping_pong(size_t pings) {
+    auto there = std::make_unique<SPSCRingBuffer<FeedMessage, 64>>();
+    auto back  = std::make_unique<SPSCRingBuffer<FeedMessage, 64>>();
+    std::thread echo([&] {
+        for (size_t i = 0; i < pings; ++i) {
+            std::optional<FeedMessage> m;
+            while (!(m = there->pop())) std::this_thread::yield();
+            while (!back->push(*m)) std::this_thread::yield();
+        }
+    });
+    std::vector<uint64_t> rtt;
+    rtt.reserve(pings);
+    for (size_t i = 0; i < pings; ++i) {
+        const auto t0 = Clock::now();
+        while (!there->push(make_message(i))) std::this_thread::yield();
+        while (!back->pop()) std::this_thread::yield();
+        rtt.push_back(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count()));
+    }
+    echo.join();
+    std::sort(rtt.begin(), rtt.end());
+    auto at = [&](double p) { return rtt.empty() ? 0.0 : double(rtt[size_t(p * (rtt.size() - 1))]); };
+    std::cout << "  round trip       p50 " << at(0.50) << " ns, p99 " << at(0.99)
+              << " ns, p99.9 " << at(0.999) << " ns  (" << pings << " pings)\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const CliArgs args = parse(argc, argv);
+
+    std::cout << "\n──────── Ring buffers (" << sizeof(FeedMessage) << "-byte items, "
+              << std::thread::hardware_concurrency() << " hw threads) ────────\n";
+    std::cout << std::fixed << std::setprecision(2);
+
+    const double base = bench_lamport(args.items);
+    report("lamport", base, 0);
+    report("push/pop", bench_push_pop(args.items), base);
+    const std::string batched = "push_n/pop_n " + std::to_string(args.batch);
+    report(batched.c_str(), bench_batched(args.items, args.batch), base);
+    report("claim/consume", bench_in_place(args.items), base);
+    for (size_t p : {1u, 2u, 4u}) {
+        const std::string name = "mpsc x" + std::to_string(p);
+        report(name.c_str(), bench_mpsc(args.items, p), base);
+    }
+
+    std::cout << std::setprecision(0);
+    bench_ping_pong(args.pings);
+    return 0;
+}
@@ -0,0 +1,162 @@
+/*
+ * bench_sharded.cpp - ShardedMatchingEngine throughput vs shard count.
+ *
+ * Pre-generates one interleaved order flow over many symbols and pushes it
+ * through:
+ *   • a single-threaded MatchingEngine (baseline, no rings)
+ *   • ShardedMatchingEngine with 1, 2, 4, ... shards (pinned workers)
+ *
+ * The caller thread is both producer and consumer: it submits, polls the
+ * shard output rings every few hundred orders, and finally waits for all
+ * shards to go idle. Reported throughput is orders in / wall time until the
+ * last event is out. Trade counts must match the baseline for every run.
+ *
+ * Scaling is bounded by the machine: shard counts above the number of
+ * hardware threads are still run but will time-share cores.
+ *
+ * Usage:
+ *   ./bench_sharded                       # 2M orders, 256 symbols
+ *   ./bench_sharded --orders 5000000 --symbols 512 --max-shards 16
+ */
+
+#include "ShardedMatchingEngine.h"
+#include "MatchingEngine.h"
+#include "Order.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace micro_exchange::core;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct CliArgs {
+    size_t orders     = 2'000'000;
+    size_t symbols    = 256;
+    size_t max_shards = 8;
+};
+
+CliArgs parse(int argc, char** argv) {
+    CliArgs a;
+    for (int i = 1; i < argc; ++i) {
+        std::string s = argv[i];
+        if (s == "--orders" && i + 1 < argc)          a.orders     = std::stoull(argv[++i]);
+        else if (s == "--symbols" && i + 1 < argc)    a.symbols    = std::stoull(argv[++i]);
+        else if (s == "--max-shards" && i + 1 < argc) a.max_shards = std::stoull(argv[++i]);
+        else if (s == "--help") {
+            std::cout << "usage: bench_sharded [--orders N] [--symbols N] [--max-shards N]\n";
+            std::exit(0);
+        }
+    }
+    return a;
+}
+
+std::string sym_name(size_t i) { return "SYM" + std::to_string(i); }
+
+// Per-book order capacity: with hundreds of books the 64k default would
+// pre-fault gigabytes of arena/index before the first order.
+constexpr size_t ORDER_CAPACITY = 8192;
+
+// Symbol ids are 1..symbols in both engines (same registration order).
+std::vector<NewOrderRequest> generate(size_t count, size_t symbols) {
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<Price>    price(9950, 10050);
+    std::uniform_int_distribution<Quantity> qty(1, 10);
+    std::uniform_int_distribution<size_t>   sym(0, symbols - 1);
+
+    std::vector<NewOrderRequest> v(count);
+    for (size_t i = 0; i < count; ++i) {
+        auto& r = v[i];
+        size_t s = sym(rng);
+        r.id        = i + 1;
+        r.side      = (rng() & 1) ? Side::Buy : Side::Sell;
+        bool market = rng() % 10 == 0;
+        r.type      = market ? OrderType::Market : OrderType::Limit;
+        r.tif       = market ? TimeInForce::IOC   : TimeInForce::GTC;
+        r.price     = market ? PRICE_MARKET : price(rng);
+        r.quantity  = qty(rng) * 100;
+        r.symbol_id = static_cast<SymbolId>(s + 1);
+        std::string name = sym_name(s);
+        std::memcpy(r.symbol, name.c_str(), name.size());
+    }
+    return v;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    auto args = parse(argc, argv);
+    auto orders = generate(args.orders, args.symbols);
+
+    std::cout << "\n  MicroExchange — Sharded Engine Benchmark\n";
+    std::cout << "  ────────────────────────────────────────\n";
+    std::cout << "  Orders:   " << args.orders << "\n";
+    std::cout << "  Symbols:  " << args.symbols << "\n";
+    std::cout << "  HW threads: " << std::thread::hardware_concurrency() << "\n\n";
+
+    // ── Baseline ──
+    uint64_t base_trades = 0;
+    double base_rate = 0;
+    {
+        MatchingEngine engine;
+        for (size_t i = 0; i < args.symbols; ++i) engine.add_symbol(sym_name(i), ORDER_CAPACITY);
+        auto t0 = Clock::now();
+        for (const auto& r : orders) engine.submit_order(r);
+        auto t1 = Clock::now();
+        base_trades = engine.get_stats().total_trades;
+        base_rate = args.orders / std::chrono::duration<double>(t1 - t0).count();
+    }
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "  " << std::left << std::setw(18) << "engine"
+              << std::right << std::setw(14) << "M orders/s"
+              << std::setw(10) << "vs base"
+              << std::setw(12) << "trades" << "\n";
+    std::cout << "  " << std::left << std::setw(18) << "single-threaded"
+              << std::right << std::setw(14) << base_rate / 1e6
+              << std::setw(10) << 1.0
+              << std::setw(12) << base_trades << "\n";
+
+    bool all_match = true;
+    for (size_t shards = 1; shards <= args.max_shards; shards *= 2) {
+        ShardedMatchingEngine::Config cfg;
+        cfg.num_shards = shards;
+        ShardedMatchingEngine engine(cfg);
+        for (size_t i = 0; i < args.symbols; ++i) engine.add_symbol(sym_name(i), ORDER_CAPACITY);
+        engine.start();
+
+        uint64_t events = 0;
+        auto drain = [&](const ShardEvent&) { ++events; };
+
+        auto t0 = Clock::now();
+        for (size_t i = 0; i < orders.size(); ++i) {
+            engine.submit_order(orders[i]);
+            if ((i & 255) == 0) engine.poll(drain);
+        }
+        engine.wait_idle(drain);
+        auto t1 = Clock::now();
+
+        uint64_t trades = engine.get_stats().total_trades;
+        engine.stop();
+        all_match = all_match && trades == base_trades;
+
+        double rate = args.orders / std::chrono::duration<double>(t1 - t0).count();
+        std::string label = "sharded x" + std::to_string(shards);
+        std::cout << "  " << std::left << std::setw(18) << label
+                  << std::right << std::setw(14) << rate / 1e6
+                  << std::setw(10) << rate / base_rate
+                  << std::setw(12) << trades << "\n";
+    }
+
+    std::cout << "\n  trade counts match baseline: " << (all_match ? "YES" : "NO") << "\n\n";
+    return all_match ? 0 : 1;
+}
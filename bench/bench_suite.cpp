@@ -0,0 +1,1273 @@
+/**
+ * bench_suite.cpp — named, realistic workloads against every book, as JSON.
+ *
+ * The other book benches feed uniform prices over 9900–10100 with no cancels
+ * or amends. Real flow is mostly cancel/replace, sits in deep queues at the
+ * touch and comes in bursts, and that is where the books differ. Each
+ * scenario below pre-generates one operation stream (new / cancel / amend).
+ * Every registered book then runs that stream, so generation is never timed
+ * and every book sees identical input:
+ *
+ *   uniform          the legacy stream: 70% limit over 9900–10100, 30% market
+ *   hawkes_zi        the simulator's own flow (Hawkes arrivals, ZI agents, ZI
+ *                    cancels), recorded from Simulator::Flow
+ *   cancel_heavy_mm  market makers requoting 5 levels a side by amend or
+ *                    cancel + new, fleeting orders joining the touch, small
+ *                    takers eating the queue fronts; ~60% cancels and amends
+ *   stop_cascade     a thin book over ~2400 parked stops, with periodic
+ *                    sweeps that trigger stops that trigger stops
+ *   wide_sparse      resting orders scattered over ±50,000 ticks, a few per
+ *                    level, with cancels and deep marketable sweeps
+ *   replay           a captured feed file (--feed, e.g. from
+ *                    `micro_exchange --feed-out`) decoded back into orders;
+ *                    without --feed, a fresh in-process capture
+ *
+ * Per scenario and book: throughput (median and best of --reps passes),
+ * per-op latency percentiles from a separate pass that times every op
+ * (EventClock), and with --perf the hardware counters per op: cycles,
+ * instructions, IPC, LLC misses, branch misses (PerfCounters.h; left out
+ * where the machine has no PMU). A reference pass with a trade listener
+ * fingerprints each book's trade stream, and every book must print the
+ * identical stream, or the run fails.
+ *
+ * A new book variant is one line in kBooks (plus a make_book overload when
+ * its constructor differs), and every scenario then runs on it.
+ *
+ * Regression gating: --json writes the results, and --compare BASE runs the
+ * suite and exits 1 if any scenario/book got worse than BASE by more than
+ * --threshold percent on a --gate metric. Use --against CUR to compare two
+ * files without running. Instructions per op (with --perf) is the
+ * lowest-noise gate metric where counters are available.
+ *
+ * Usage:
+ *   ./bench_suite                               # all scenarios, all books, 1M ops each
+ *   ./bench_suite --quick                       # 100K ops, 1 rep (CI smoke)
+ *   ./bench_suite --scenario cancel_heavy_mm,stop_cascade --book array
+ *   ./bench_suite --feed capture.feed           # replay a recorded feed
+ *   ./bench_suite --perf --json now.json        # with counters, JSON out
+ *   ./bench_suite --compare base.json --threshold 10 --gate ops_per_sec,p99
+ *   ./bench_suite --compare base.json --against now.json
+ *   ./bench_suite --list                        # scenarios, books, gate metrics
+ */
+
+#include "../core/include/OrderBook.h"
+#include "../core/include/ArrayOrderBook.h"
+#include "../core/include/MatchingEngine.h"
+#include "../core/include/Clock.h"
+#include "../core/include/LatencyRecorder.h"
+#include "../core/include/PerfCounters.h"
+#include "../md/include/FeedPublisher.h"
+#include "../md/include/FeedWriter.h"
+#include "../md/include/MappedFeed.h"
+#include "../sim/include/Simulator.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+using namespace micro_exchange::core;
+using micro_exchange::md::FeedMessage;
+using micro_exchange::md::FeedMessageType;
+using micro_exchange::md::FeedPublisher;
+using micro_exchange::md::FeedWriter;
+using micro_exchange::md::MappedFeed;
+using micro_exchange::sim::Simulator;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// ─────────────────────────────────────────────
+// Operations and scenarios
+// ─────────────────────────────────────────────
+
+// One book operation. Cancel and Amend reuse the request: `id` is the
+// target, `price` / `quantity` the amend's new values (0 = unchanged).
+struct Op {
+    enum class Kind : uint8_t { New, Cancel, Amend };
+    Kind            kind = Kind::New;
+    NewOrderRequest req{};
+};
+
+constexpr size_t KINDS = 3;
+constexpr const char* kind_name(size_t k) {
+    return k == 0 ? "new" : k == 1 ? "cancel" : "amend";
+}
+
+struct Scenario {
+    std::string name;
+    std::string what;
+    std::vector<Op> ops;
+    size_t warm     = 0;        // leading ops that build the book; run, never timed
+    Price  band_lo  = 9800;     // ArrayOrderBook's initial band
+    Price  band_hi  = 10200;
+    size_t capacity = 65536;    // order-index / arena pre-size for every book
+    uint64_t captured_trades = 0;   // replay: trades the capture printed
+
+    [[nodiscard]] size_t timed() const noexcept { return ops.size() - warm; }
+};
+
+NewOrderRequest order(OrderId id, Side side, OrderType type, Price price, Quantity qty) {
+    NewOrderRequest r{};
+    r.id       = id;
+    r.side     = side;
+    r.type     = type;
+    r.tif      = type == OrderType::Market ? TimeInForce::IOC : TimeInForce::GTC;
+    r.price    = type == OrderType::Market ? PRICE_MARKET : price;
+    r.quantity = qty;
+    std::memcpy(r.symbol, "BENCH", 6);
+    return r;
+}
+
+Op make_new(const NewOrderRequest& r) { return Op{Op::Kind::New, r}; }
+
+Op make_cancel(OrderId id) {
+    Op op{Op::Kind::Cancel, {}};
+    op.req.id = id;
+    return op;
+}
+
+Op make_amend(OrderId id, Price price, Quantity qty) {
+    Op op{Op::Kind::Amend, {}};
+    op.req.id       = id;
+    op.req.price    = price;
+    op.req.quantity = qty;
+    return op;
+}
+
+template <class Book>
+inline void apply(Book& book, const Op& op) {
+    switch (op.kind) {
+        case Op::Kind::New:    book.add_order(op.req);       break;
+        case Op::Kind::Cancel: book.cancel_order(op.req.id); break;
+        case Op::Kind::Amend:
+            book.amend_order(AmendRequest{op.req.id, op.req.price, op.req.quantity, SYMBOL_ID_NONE, {}});
+            break;
+    }
+}
+
+// Live ids with O(1) random pick and removal (swap with the last, pop).
+class IdPool {
+public:
+    void add(OrderId id) { ids_.push_back(id); }
+    [[nodiscard]] bool empty() const noexcept { return ids_.empty(); }
+    OrderId take(std::mt19937_64& rng) {
+        const size_t i = rng() % ids_.size();
+        const OrderId id = ids_[i];
+        ids_[i] = ids_.back();
+        ids_.pop_back();
+        return id;
+    }
+private:
+    std::vector<OrderId> ids_;
+};
+
+// ── uniform: the stream bench_throughput / bench_orderbook_compare use ──
+
+Scenario uniform(size_t n, uint64_t seed) {
+    Scenario sc{"uniform", "legacy flow: 70% limit uniform over 9900-10100, 30% market, no cancels", {}};
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<Price>    price_dist(9900, 10100);
+    std::uniform_int_distribution<Quantity> qty_dist(1, 10);
+    std::uniform_int_distribution<int>      side_dist(0, 1);
+    std::uniform_real_distribution<double>  type_dist(0.0, 1.0);
+    sc.ops.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        const Side side = side_dist(rng) ? Side::Buy : Side::Sell;
+        const bool limit = type_dist(rng) < 0.7;
+        const Price px = limit ? price_dist(rng) : 0;
+        sc.ops.push_back(make_new(order(i + 1, side, limit ? OrderType::Limit : OrderType::Market,
+                                        px, qty_dist(rng) * 100)));
+    }
+    return sc;
+}
+
+// ── hawkes_zi: the simulator's flow, recorded ──
+
+// Stands in for the engine under Simulator::Flow: every submit and cancel
+// the agents make is recorded, then forwarded to a real engine so the
+// agents see a real book.
+class RecordingEngine {
+public:
+    using book_type = OrderBook;
+
+    explicit RecordingEngine(std::vector<Op>& ops) : ops_(ops) {}
+
+    BasicMatchingEngine<OrderBook>& inner() noexcept { return inner_; }
+    book_type* get_book(SymbolId id) { return inner_.get_book(id); }
+
+    Order* submit_order(const NewOrderRequest& req) {
+        NewOrderRequest r = req;
+        r.symbol_id = SYMBOL_ID_NONE;
+        ops_.push_back(make_new(r));
+        return inner_.submit_order(req);
+    }
+    bool cancel_order(const CancelRequest& req) {
+        ops_.push_back(make_cancel(req.order_id));
+        return inner_.cancel_order(req);
+    }
+
+private:
+    std::vector<Op>&               ops_;
+    BasicMatchingEngine<OrderBook> inner_;
+};
+
+struct NullFlowSink {
+    void sample(double, Price, Price) {}
+    void bar(const micro_exchange::sim::Bar&) {}
+    void trade(const micro_exchange::sim::TradeSample&) {}
+    void print(const Trade&) {}
+};
+
+Simulator::Config flow_config(uint64_t seed) {
+    Simulator::Config cfg;
+    cfg.symbol   = "BENCH";
+    cfg.seed     = seed;
+    cfg.duration = 1e9;   // advanced in 1 s steps until the stream is long enough
+    return cfg;
+}
+
+Scenario hawkes_zi(size_t n, uint64_t seed) {
+    Scenario sc{"hawkes_zi", "simulator flow: Hawkes arrivals, ZI agents, distance-based cancels", {}};
+    const Simulator::Config cfg = flow_config(seed);
+    sc.ops.reserve(n + 128);
+    RecordingEngine engine(sc.ops);
+    const SymbolId sym = Simulator::add_book(engine.inner(), cfg);
+    NullFlowSink sink;
+    Simulator::Flow<RecordingEngine, NullFlowSink> flow(cfg, engine, sym, sink);
+    sc.warm = sc.ops.size();   // the seeded book
+    for (double t = 1; sc.ops.size() < sc.warm + n; t += 1) flow.advance(t);
+    sc.ops.resize(sc.warm + n);
+    sc.band_lo = cfg.init_price - cfg.array_half_band;
+    sc.band_hi = cfg.init_price + cfg.array_half_band;
+    return sc;
+}
+
+// ── cancel_heavy_mm: quoting market makers ──
+
+Scenario cancel_heavy_mm(size_t n, uint64_t seed) {
+    Scenario sc{"cancel_heavy_mm", "8 makers requoting 5 levels a side, fleeting touch orders, small takers", {}};
+    constexpr size_t MAKERS = 8, LEVELS = 5;
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<int>      roll(0, 99);
+    std::uniform_int_distribution<Quantity> lot(1, 5);
+    Price fv = 10000;
+    OrderId next = 1;
+
+    struct Quote { OrderId id = 0; Price price = 0; };
+    std::vector<Quote> quotes(MAKERS * 2 * LEVELS);   // [maker][side][level]
+    const auto target = [&](size_t side, size_t level) {
+        return side == 0 ? fv - static_cast<Price>(level + 1) : fv + static_cast<Price>(level + 1);
+    };
+    const auto side_of = [](size_t side) { return side == 0 ? Side::Buy : Side::Sell; };
+
+    // Warm: every maker's quotes, then 30 orders a level 10 deep behind them.
+    for (size_t m = 0; m < MAKERS; ++m)
+        for (size_t s = 0; s < 2; ++s)
+            for (size_t l = 0; l < LEVELS; ++l) {
+                Quote& q = quotes[(m * 2 + s) * LEVELS + l];
+                q = {next++, target(s, l)};
+                sc.ops.push_back(make_new(order(q.id, side_of(s), OrderType::Limit, q.price, lot(rng) * 100)));
+            }
+    IdPool fleeting;
+    for (Price d = 1; d <= 10; ++d)
+        for (int k = 0; k < 30; ++k)
+            for (size_t s = 0; s < 2; ++s) {
+                const Price px = s == 0 ? fv - d : fv + d;
+                fleeting.add(next);
+                sc.ops.push_back(make_new(order(next++, side_of(s), OrderType::Limit, px, lot(rng) * 100)));
+            }
+    sc.warm = sc.ops.size();
+
+    sc.ops.reserve(sc.warm + n + 1);
+    while (sc.ops.size() < sc.warm + n) {
+        if (rng() % 20 == 0) fv += (rng() & 1) ? 1 : -1;   // fair value ticks every ~20 ops
+        const int r = roll(rng);
+        if (r < 55) {
+            // A maker brings one quote to the current fair value: amend in
+            // place half the time, cancel + new (a fresh id) otherwise.
+            const size_t m = rng() % MAKERS, s = rng() % 2, l = rng() % LEVELS;
+            Quote& q = quotes[(m * 2 + s) * LEVELS + l];
+            const Price px = target(s, l);
+            if (rng() & 1) {
+                sc.ops.push_back(make_amend(q.id, px != q.price ? px : 0, lot(rng) * 100));
+            } else {
+                sc.ops.push_back(make_cancel(q.id));
+                q.id = next++;
+                sc.ops.push_back(make_new(order(q.id, side_of(s), OrderType::Limit, px, lot(rng) * 100)));
+            }
+            q.price = px;
+        } else if (r < 75) {
+            if (!fleeting.empty()) sc.ops.push_back(make_cancel(fleeting.take(rng)));
+        } else if (r < 93) {
+            const size_t s = rng() % 2;
+            const Price px = target(s, 0) + (s == 0 ? 1 : -1) * static_cast<Price>(rng() % 2);
+            fleeting.add(next);
+            sc.ops.push_back(make_new(order(next++, side_of(s), OrderType::Limit, px, lot(rng) * 100)));
+        } else {
+            // Taker: marketable IOC one tick through the touch.
+            const bool buy = rng() & 1;
+            NewOrderRequest t = order(next++, buy ? Side::Buy : Side::Sell, OrderType::Limit,
+                                      buy ? fv + 2 : fv - 2, lot(rng) * 200);
+            t.tif = TimeInForce::IOC;
+            sc.ops.push_back(make_new(t));
+        }
+    }
+    sc.ops.resize(sc.warm + n);
+    return sc;
+}
+
+// ── stop_cascade: thin book over a wall of parked stops ──
+
+Scenario stop_cascade(size_t n, uint64_t seed) {
+    Scenario sc{"stop_cascade", "thin book over ~2400 parked stops, sweeps that set off cascades", {}};
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<int>      roll(0, 999);
+    std::uniform_int_distribution<Quantity> lot(1, 3);
+    Price fv = 10000;
+    OrderId next = 1;
+    IdPool limits, stops;
+
+    const auto add_stop = [&](Side side, Price trigger) {
+        const bool stop_limit = rng() % 5 == 0;
+        NewOrderRequest q = order(next, side, stop_limit ? OrderType::StopLimit : OrderType::Stop, 0, lot(rng) * 100);
+        q.stop_price = trigger;
+        if (stop_limit) q.price = side == Side::Buy ? trigger + 3 : trigger - 3;
+        stops.add(next++);
+        sc.ops.push_back(make_new(q));
+    };
+    const auto add_limit = [&](Side side, Price px) {
+        limits.add(next);
+        sc.ops.push_back(make_new(order(next++, side, OrderType::Limit, px, lot(rng) * 100)));
+    };
+
+    for (Price d = 1; d <= 20; ++d)
+        for (int k = 0; k < 5; ++k) {
+            add_limit(Side::Buy, fv - d);
+            add_limit(Side::Sell, fv + d);
+        }
+    for (Price d = 5; d <= 400; ++d)
+        for (int k = 0; k < 3; ++k) {
+            add_stop(Side::Sell, fv - d);
+            add_stop(Side::Buy, fv + d);
+        }
+    sc.warm = sc.ops.size();
+
+    sc.ops.reserve(sc.warm + n);
+    while (sc.ops.size() < sc.warm + n) {
+        if (rng() % 200 == 0) fv += (rng() & 1) ? 1 : -1;
+        const int r = roll(rng);
+        const Side side = (rng() & 1) ? Side::Buy : Side::Sell;
+        const bool buy = side == Side::Buy;
+        if (r < 600) {
+            // Liquidity refills around the fair value (crossing if the book moved).
+            const auto d = static_cast<Price>(1 + rng() % 10);
+            add_limit(side, buy ? fv - d : fv + d);
+        } else if (r < 750) {
+            if (!limits.empty()) sc.ops.push_back(make_cancel(limits.take(rng)));
+        } else if (r < 850) {
+            const auto d = static_cast<Price>(5 + rng() % 100);
+            add_stop(side, buy ? fv + d : fv - d);
+        } else if (r < 880) {
+            if (!stops.empty()) sc.ops.push_back(make_cancel(stops.take(rng)));
+        } else if (r < 995) {
+            sc.ops.push_back(make_new(order(next++, side, OrderType::Market, 0, lot(rng) * 100)));
+        } else {
+            // Sweep: clears several levels, trips the nearest stops, whose
+            // market orders clear more levels and trip the next ones.
+            sc.ops.push_back(make_new(order(next++, side, OrderType::Market, 0, 3000 + (rng() % 8) * 1000)));
+            fv += buy ? 10 : -10;
+        }
+    }
+    sc.ops.resize(sc.warm + n);
+    return sc;
+}
+
+// ── wide_sparse: a few orders a level over 100,000 ticks ──
+
+Scenario wide_sparse(size_t n, uint64_t seed) {
+    Scenario sc{"wide_sparse", "resting orders over +/-50,000 ticks, cancels, deep marketable sweeps", {}};
+    constexpr Price MID = 100000, HALF = 50000;
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<int>      roll(0, 99);
+    std::uniform_int_distribution<Price>    far(1, HALF);
+    std::uniform_int_distribution<Price>    near(1, 50);
+    std::uniform_int_distribution<Quantity> lot(1, 10);
+    OrderId next = 1;
+    IdPool live;
+
+    const auto rest = [&](Price offset) {
+        const bool buy = rng() & 1;
+        live.add(next);
+        sc.ops.push_back(make_new(order(next++, buy ? Side::Buy : Side::Sell, OrderType::Limit,
+                                        buy ? MID - offset : MID + offset, lot(rng) * 100)));
+    };
+
+    for (int i = 0; i < 20000; ++i) rest(far(rng));
+    sc.warm = sc.ops.size();
+
+    sc.ops.reserve(sc.warm + n);
+    while (sc.ops.size() < sc.warm + n) {
+        const int r = roll(rng);
+        if (r < 55)      rest(far(rng));
+        else if (r < 65) rest(near(rng));
+        else if (r < 95) { if (!live.empty()) sc.ops.push_back(make_cancel(live.take(rng))); }
+        else {
+            const bool buy = rng() & 1;
+            const auto reach = static_cast<Price>(rng() % 2000);
+            NewOrderRequest t = order(next++, buy ? Side::Buy : Side::Sell, OrderType::Limit,
+                                      buy ? MID + reach : MID - reach, lot(rng) * 1000);
+            t.tif = TimeInForce::IOC;
+            sc.ops.push_back(make_new(t));
+        }
+    }
+    // The array book starts on the simulator's default band and has to
+    // re-center out to the whole range: part of what this scenario measures.
+    sc.band_lo  = MID - 1024;
+    sc.band_hi  = MID + 1024;
+    sc.capacity = 1 << 17;
+    return sc;
+}
+
+// ── replay: a captured feed, back into orders ──
+
+/**
+ * Turns a feed (A / T / D, the messages FeedRecovery rebuilds a book from)
+ * back into the orders that produced it:
+ *
+ *   A New            → the limit / stop order itself
+ *   A Amended        → an amend to the new price and total quantity
+ *   T, unknown aggr. → an incoming order that traded before (or instead
+ *                      of) resting: its prints accumulate into one order at
+ *                      the worst print price, IOC unless the next message
+ *                      is its own A PartiallyFilled (then a GTC limit at that
+ *                      price for prints + rest)
+ *   D                → a cancel
+ *
+ * Trades by orders the replay already placed (triggered stops, amends that
+ * cross) are left to the replayed book to reproduce; quotes and depth
+ * messages carry no order flow.
+ */
+class FeedDecoder {
+public:
+    explicit FeedDecoder(std::vector<Op>& ops) : ops_(ops) {}
+
+    void on(const FeedMessage& m) {
+        switch (m.type) {
+            case FeedMessageType::Trade:       on_trade(m);  break;
+            case FeedMessageType::AddOrder:    on_add(m);    break;
+            case FeedMessageType::DeleteOrder: on_delete(m); break;
+            default: break;
+        }
+    }
+
+    void finish() { flush(); }
+
+    [[nodiscard]] uint64_t trades() const noexcept { return trades_; }
+
+    // Trades printed before ops.size() reached `n` (to compare a truncated replay).
+    [[nodiscard]] uint64_t trades_within(size_t n) const noexcept {
+        auto it = std::upper_bound(trades_at_.begin(), trades_at_.end(), n,
+                                   [](size_t v, const std::pair<size_t, uint64_t>& p) { return v < p.first; });
+        return it == trades_at_.begin() ? 0 : std::prev(it)->second;
+    }
+
+private:
+    struct Pending {
+        OrderId  id    = 0;
+        Side     side  = Side::Buy;
+        Price    price = 0;
+        Quantity qty   = 0;
+    };
+
+    void on_trade(const FeedMessage& m) {
+        ++trades_;
+        const bool buy = m.aggressor_side == Side::Buy;
+        const OrderId aggressor = buy ? m.order_id : m.match_id;
+        const OrderId passive   = buy ? m.match_id : m.order_id;
+        filled_[passive] += m.quantity;
+        if (known_.count(aggressor)) {
+            filled_[aggressor] += m.quantity;
+            return;
+        }
+        if (pending_.qty && pending_.id != aggressor) flush();
+        pending_.id    = aggressor;
+        pending_.side  = m.aggressor_side;
+        pending_.price = pending_.qty == 0 ? m.price
+                       : buy ? std::max(pending_.price, m.price) : std::min(pending_.price, m.price);
+        pending_.qty  += m.quantity;
+    }
+
+    void on_add(const FeedMessage& m) {
+        if (m.order_status == OrderStatus::PartiallyFilled) {
+            // The remainder of an aggressor that traded first. If the prints
+            // were decoded into a pending order, it was one GTC limit.
+            if (pending_.qty && pending_.id == m.order_id) {
+                emit(order(m.order_id, m.side, OrderType::Limit, m.price, pending_.qty + m.quantity));
+                known_.insert(m.order_id);
+                filled_[m.order_id] = pending_.qty;
+                pending_ = {};
+            }
+            return;
+        }
+        flush();
+        if (m.order_status == OrderStatus::Amended) {
+            if (known_.count(m.order_id)) {
+                ops_.push_back(make_amend(m.order_id, m.price, m.quantity + filled_[m.order_id]));
+                mark();
+            }
+            return;
+        }
+        NewOrderRequest q = order(m.order_id, m.side, m.order_type, m.price, m.quantity);
+        q.stop_price = m.stop_price;
+        emit(q);
+        known_.insert(m.order_id);
+    }
+
+    void on_delete(const FeedMessage& m) {
+        flush();
+        if (known_.erase(m.order_id)) {
+            filled_.erase(m.order_id);
+            ops_.push_back(make_cancel(m.order_id));
+            mark();
+        }
+    }
+
+    void flush() {
+        if (!pending_.qty) return;
+        NewOrderRequest q = order(pending_.id, pending_.side, OrderType::Limit, pending_.price, pending_.qty);
+        q.tif = TimeInForce::IOC;
+        emit(q);
+        pending_ = {};
+    }
+
+    void emit(const NewOrderRequest& q) {
+        ops_.push_back(make_new(q));
+        mark();
+    }
+    void mark() { trades_at_.emplace_back(ops_.size(), trades_); }
+
+    std::vector<Op>&                        ops_;
+    std::unordered_set<OrderId>             known_;
+    std::unordered_map<OrderId, Quantity>   filled_;
+    std::vector<std::pair<size_t, uint64_t>> trades_at_;   // (ops emitted, trades seen)
+    Pending                                 pending_;
+    uint64_t                                trades_ = 0;
+};
+
+// A short simulator run with its feed written compactly to `path`.
+bool capture_feed(const std::string& path, size_t min_events, uint64_t seed) {
+    Simulator::Config cfg = flow_config(seed);
+    cfg.num_agents      = 20;
+    cfg.cancel_interval = 20;
+    BasicMatchingEngine<OrderBook> engine;
+    const SymbolId sym = Simulator::add_book(engine, cfg);
+    FeedPublisher::Options opts;
+    opts.retain_messages = false;
+    FeedPublisher feed(opts);
+    FeedWriter writer(path);
+    feed.set_writer(&writer);
+    feed.attach(*engine.get_book(sym));
+    NullFlowSink sink;
+    Simulator::Flow<BasicMatchingEngine<OrderBook>, NullFlowSink> flow(cfg, engine, sym, sink);
+    for (double t = 1; flow.events() + flow.cancels() < min_events; t += 1) flow.advance(t);
+    feed.flush();
+    return writer.close();
+}
+
+Scenario replay(size_t n, uint64_t seed, const std::string& feed_path) {
+    Scenario sc{"replay", "", {}};
+    std::string path = feed_path;
+    if (path.empty()) {
+        path = (std::filesystem::temp_directory_path() / "bench_suite_capture.feed").string();
+        if (!capture_feed(path, n + n / 4, seed)) throw std::runtime_error("feed capture to " + path + " failed");
+    }
+    {
+        const MappedFeed feed(path);
+        if (!feed.ok() || feed.size() == 0) throw std::runtime_error("cannot read feed file " + path);
+        const std::string symbol = feed.symbols().empty() ? "" : feed.symbols().front();
+        FeedDecoder decoder(sc.ops);
+        feed.replay([&](const FeedMessage& m) {
+            if (sc.ops.size() < n && std::strncmp(m.symbol, symbol.c_str(), sizeof(m.symbol)) == 0) decoder.on(m);
+        });
+        decoder.finish();
+        if (sc.ops.size() > n) sc.ops.resize(n);
+        sc.captured_trades = decoder.trades_within(sc.ops.size());
+        sc.what = (feed_path.empty() ? "in-process capture" : "feed " + feed_path) + ", symbol "
+                + symbol + ", " + std::to_string(feed.size()) + " messages decoded to orders";
+    }
+    if (feed_path.empty()) std::filesystem::remove(path);
+
+    // Centre the array book's band on the first priced order.
+    for (const Op& op : sc.ops) {
+        if (op.kind == Op::Kind::New && op.req.type == OrderType::Limit) {
+            sc.band_lo = op.req.price - 1024;
+            sc.band_hi = op.req.price + 1024;
+            break;
+        }
+    }
+    sc.capacity = 1 << 17;
+    return sc;
+}
+
+struct ScenarioDef {
+    const char* name;
+    Scenario  (*make)(size_t n, uint64_t seed, const std::string& feed);
+};
+
+const ScenarioDef kScenarios[] = {
+    {"uniform",         [](size_t n, uint64_t s, const std::string&) { return uniform(n, s); }},
+    {"hawkes_zi",       [](size_t n, uint64_t s, const std::string&) { return hawkes_zi(n, s); }},
+    {"cancel_heavy_mm", [](size_t n, uint64_t s, const std::string&) { return cancel_heavy_mm(n, s); }},
+    {"stop_cascade",    [](size_t n, uint64_t s, const std::string&) { return stop_cascade(n, s); }},
+    {"wide_sparse",     [](size_t n, uint64_t s, const std::string&) { return wide_sparse(n, s); }},
+    {"replay",          [](size_t n, uint64_t s, const std::string& f) { return replay(n, s, f); }},
+};
+
+// ─────────────────────────────────────────────
+// Running one book on one scenario
+// ─────────────────────────────────────────────
+
+struct Options {
+    std::vector<std::string> scenarios;   // empty = all
+    std::vector<std::string> books;       // empty = all
+    size_t ops  = 1'000'000;
+    size_t reps = 3;
+    uint64_t seed = 42;
+    bool perf = false;
+    bool list = false;
+    std::string feed;
+    std::string json;
+    std::string compare;
+    std::string against;
+    double threshold = 10.0;
+    std::vector<std::string> gate = {"ops_per_sec", "p50"};
+};
+
+struct LatencyStats {
+    uint64_t count = 0;
+    double   mean  = 0;
+    uint64_t p50 = 0, p90 = 0, p99 = 0, p999 = 0, max = 0;
+
+    static LatencyStats of(const LatencyHistogram::Snapshot& s) {
+        return {s.count, s.mean(), s.percentile(0.50), s.percentile(0.90),
+                s.percentile(0.99), s.percentile(0.999), s.max};
+    }
+};
+
+struct Result {
+    std::string scenario, book;
+    size_t   ops = 0, warm = 0;
+    std::array<uint64_t, KINDS> kinds{};
+    uint64_t trades = 0, volume = 0, stops_triggered = 0, recenters = 0;
+    size_t   active_orders = 0;
+    uint64_t fingerprint = 0;
+    double   ops_per_sec = 0, best_ops_per_sec = 0;
+    LatencyStats latency;
+    std::array<LatencyStats, KINDS> latency_by_kind;
+    PerfCounters::Reading perf;   // summed over the throughput passes
+    uint64_t perf_ops = 0;
+
+    [[nodiscard]] double per_op(PerfCounters::Event e) const {
+        return perf.valid[e] && perf_ops ? static_cast<double>(perf.value[e]) / static_cast<double>(perf_ops) : -1;
+    }
+    [[nodiscard]] double ipc() const {
+        return perf.valid[PerfCounters::Cycles] && perf.valid[PerfCounters::Instructions] && perf.value[PerfCounters::Cycles]
+            ? static_cast<double>(perf.value[PerfCounters::Instructions]) / static_cast<double>(perf.value[PerfCounters::Cycles])
+            : -1;
+    }
+};
+
+template <class Book> std::unique_ptr<Book> make_book(const Scenario& sc);
+
+template <> std::unique_ptr<OrderBook> make_book<OrderBook>(const Scenario& sc) {
+    return std::make_unique<OrderBook>("BENCH", sc.capacity);
+}
+template <> std::unique_ptr<ArrayOrderBook> make_book<ArrayOrderBook>(const Scenario& sc) {
+    return std::make_unique<ArrayOrderBook>("BENCH", sc.band_lo, sc.band_hi, sc.capacity);
+}
+
+template <OrderBookLike Book>
+Result run_book(const Scenario& sc, const Options& opt, PerfCounters* perf) {
+    Result res;
+    res.scenario = sc.name;
+    res.ops  = sc.timed();
+    res.warm = sc.warm;
+    for (size_t i = sc.warm; i < sc.ops.size(); ++i) ++res.kinds[static_cast<size_t>(sc.ops[i].kind)];
+
+    // Reference pass: the trade stream, fingerprinted (FNV-1a) and counted.
+    {
+        auto book = make_book<Book>(sc);
+        uint64_t h = 1469598103934665603ULL;
+        const auto mix = [&h](uint64_t v) { h = (h ^ v) * 1099511628211ULL; };
+        book->set_trade_callback([&](const Trade& t) {
+            mix(t.buy_order_id); mix(t.sell_order_id);
+            mix(static_cast<uint64_t>(t.price)); mix(t.quantity);
+            mix(static_cast<uint64_t>(t.aggressor));
+            ++res.trades;
+            res.volume += t.quantity;
+        });
+        for (const Op& op : sc.ops) apply(*book, op);
+        res.fingerprint     = h;
+        res.stops_triggered = book->stop_triggered_count();
+        res.active_orders   = book->active_orders();
+        if constexpr (requires { book->recenter_count(); }) res.recenters = book->recenter_count();
+    }
+
+    // Latency pass: every timed op between two clock reads.
+    {
+        auto book = make_book<Book>(sc);
+        for (size_t i = 0; i < sc.warm; ++i) apply(*book, sc.ops[i]);
+        auto all = std::make_unique<LatencyHistogram>();
+        auto by_kind = std::make_unique<std::array<LatencyHistogram, KINDS>>();
+        for (size_t i = sc.warm; i < sc.ops.size(); ++i) {
+            const Op& op = sc.ops[i];
+            const auto t0 = EventClock::now();
+            apply(*book, op);
+            const auto ns = static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(EventClock::now() - t0).count());
+            all->record(ns);
+            (*by_kind)[static_cast<size_t>(op.kind)].record(ns);
+        }
+        res.latency = LatencyStats::of(all->snapshot());
+        for (size_t k = 0; k < KINDS; ++k) res.latency_by_kind[k] = LatencyStats::of((*by_kind)[k].snapshot());
+    }
+
+    // Throughput passes: nothing but the ops (and the counters, if on).
+    std::vector<double> rates;
+    for (size_t r = 0; r < std::max<size_t>(1, opt.reps); ++r) {
+        auto book = make_book<Book>(sc);
+        for (size_t i = 0; i < sc.warm; ++i) apply(*book, sc.ops[i]);
+        if (perf) perf->start();
+        const auto t0 = Clock::now();
+        for (size_t i = sc.warm; i < sc.ops.size(); ++i) apply(*book, sc.ops[i]);
+        const double sec = std::chrono::duration<double>(Clock::now() - t0).count();
+        if (perf) {
+            const PerfCounters::Reading p = perf->stop();
+            for (size_t e = 0; e < PerfCounters::EVENTS; ++e) {
+                res.perf.value[e] += p.value[e];
+                res.perf.valid[e]  = p.valid[e];
+            }
+            res.perf_ops += res.ops;
+        }
+        rates.push_back(static_cast<double>(res.ops) / std::max(sec, 1e-9));
+    }
+    std::sort(rates.begin(), rates.end());
+    res.ops_per_sec      = rates[rates.size() / 2];
+    res.best_ops_per_sec = rates.back();
+    return res;
+}
+
+struct BookImpl {
+    const char* name;
+    const char* what;
+    Result    (*run)(const Scenario&, const Options&, PerfCounters*);
+};
+
+const BookImpl kBooks[] = {
+    {"map",   "OrderBook: std::map price levels",             run_book<OrderBook>},
+    {"array", "ArrayOrderBook: tick-indexed levels + bitmap", run_book<ArrayOrderBook>},
+};
+
+// ─────────────────────────────────────────────
+// JSON out
+// ─────────────────────────────────────────────
+
+std::string json_str(const std::string& s) {
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') { out += '\\'; out += c; }
+        else if (static_cast<unsigned char>(c) < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+        } else out += c;
+    }
+    return out + "\"";
+}
+
+std::string json_num(double v) {
+    if (!std::isfinite(v) || v < 0) return "null";   // -1 marks "not measured"
+    std::ostringstream os;
+    os << std::setprecision(10) << v;
+    return os.str();
+}
+
+std::string json_latency(const LatencyStats& l) {
+    std::ostringstream os;
+    os << "{\"count\": " << l.count << ", \"mean\": " << json_num(l.mean) << ", \"p50\": " << l.p50
+       << ", \"p90\": " << l.p90 << ", \"p99\": " << l.p99 << ", \"p999\": " << l.p999
+       << ", \"max\": " << l.max << "}";
+    return os.str();
+}
+
+std::string cpu_model() {
+    std::ifstream in("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.rfind("model name", 0) == 0) {
+            const auto colon = line.find(':');
+            if (colon != std::string::npos) return line.substr(line.find_first_not_of(' ', colon + 1));
+        }
+    }
+    return "unknown";
+}
+
+void write_json(std::ostream& os, const Options& opt, const std::vector<Result>& results,
+                const std::vector<Scenario>& scenarios, bool perf_on, bool agree) {
+    char fp[24];
+    os << "{\n  \"schema\": \"micro_exchange.bench_suite/1\",\n";
+    os << "  \"host\": {\"cpu\": " << json_str(cpu_model())
+       << ", \"threads\": " << std::thread::hardware_concurrency()
+       << ", \"clock\": " << json_str(TscClock::source())
+#ifdef NDEBUG
+       << ", \"build\": \"release\""
+#else
+       << ", \"build\": \"debug\""
+#endif
+       << "},\n";
+    os << "  \"config\": {\"ops\": " << opt.ops << ", \"reps\": " << opt.reps << ", \"seed\": " << opt.seed
+       << ", \"perf\": " << (perf_on ? "true" : "false") << "},\n";
+    os << "  \"scenarios\": [";
+    for (size_t i = 0; i < scenarios.size(); ++i) {
+        const Scenario& s = scenarios[i];
+        os << (i ? ",\n" : "\n") << "    {\"name\": " << json_str(s.name) << ", \"what\": " << json_str(s.what)
+           << ", \"ops\": " << s.timed() << ", \"warm_ops\": " << s.warm;
+        if (s.name == "replay") os << ", \"captured_trades\": " << s.captured_trades;
+        os << "}";
+    }
+    os << "\n  ],\n  \"books_agree\": " << (agree ? "true" : "false") << ",\n";
+    os << "  \"results\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        std::snprintf(fp, sizeof(fp), "%016llx", static_cast<unsigned long long>(r.fingerprint));
+        os << (i ? ",\n" : "\n") << "    {\n";
+        os << "      \"scenario\": " << json_str(r.scenario) << ", \"book\": " << json_str(r.book) << ",\n";
+        os << "      \"ops\": " << r.ops << ", \"new\": " << r.kinds[0] << ", \"cancel\": " << r.kinds[1]
+           << ", \"amend\": " << r.kinds[2] << ",\n";
+        os << "      \"trades\": " << r.trades << ", \"volume\": " << r.volume
+           << ", \"stops_triggered\": " << r.stops_triggered << ", \"recenters\": " << r.recenters
+           << ", \"active_orders\": " << r.active_orders << ", \"fingerprint\": \"" << fp << "\",\n";
+        os << "      \"throughput\": {\"ops_per_sec\": " << json_num(r.ops_per_sec)
+           << ", \"best_ops_per_sec\": " << json_num(r.best_ops_per_sec)
+           << ", \"ns_per_op\": " << json_num(1e9 / r.ops_per_sec) << "},\n";
+        os << "      \"latency_ns\": " << json_latency(r.latency) << ",\n";
+        os << "      \"latency_by_kind_ns\": {";
+        for (size_t k = 0; k < KINDS; ++k)
+            os << (k ? ", " : "") << "\"" << kind_name(k) << "\": " << json_latency(r.latency_by_kind[k]);
+        os << "},\n";
+        os << "      \"perf\": ";
+        if (!r.perf.any()) os << "null";
+        else {
+            os << "{\"cycles_per_op\": " << json_num(r.per_op(PerfCounters::Cycles))
+               << ", \"instructions_per_op\": " << json_num(r.per_op(PerfCounters::Instructions))
+               << ", \"ipc\": " << json_num(r.ipc())
+               << ", \"cache_misses_per_op\": " << json_num(r.per_op(PerfCounters::CacheMisses))
+               << ", \"branch_misses_per_op\": " << json_num(r.per_op(PerfCounters::BranchMisses)) << "}";
+        }
+        os << "\n    }";
+    }
+    os << "\n  ]\n}\n";
+}
+
+// ─────────────────────────────────────────────
+// JSON in (just enough for the files written above)
+// ─────────────────────────────────────────────
+
+struct Json {
+    enum class Type : uint8_t { Null, Bool, Number, String, Array, Object };
+    Type   type = Type::Null;
+    bool   boolean = false;
+    double number  = 0;
+    std::string str;
+    std::vector<Json> items;
+    std::vector<std::pair<std::string, Json>> members;
+
+    [[nodiscard]] const Json* get(const std::string& key) const {
+        for (const auto& [k, v] : members) if (k == key) return &v;
+        return nullptr;
+    }
+    [[nodiscard]] const Json* path(std::initializer_list<const char*> keys) const {
+        const Json* j = this;
+        for (const char* k : keys) if (!(j = j->get(k))) return nullptr;
+        return j;
+    }
+};
+
+class JsonParser {
+public:
+    explicit JsonParser(const std::string& text) : s_(text) {}
+
+    Json parse() {
+        Json v = value();
+        ws();
+        if (i_ != s_.size()) fail("trailing characters");
+        return v;
+    }
+
+private:
+    [[noreturn]] void fail(const char* what) const {
+        throw std::runtime_error(std::string("JSON: ") + what + " at offset " + std::to_string(i_));
+    }
+    void ws() { while (i_ < s_.size() && std::isspace(static_cast<unsigned char>(s_[i_]))) ++i_; }
+    bool eat(char c) {
+        ws();
+        if (i_ < s_.size() && s_[i_] == c) { ++i_; return true; }
+        return false;
+    }
+    void expect(char c) { if (!eat(c)) fail("unexpected character"); }
+
+    Json value() {
+        ws();
+        if (i_ >= s_.size()) fail("unexpected end");
+        Json v;
+        const char c = s_[i_];
+        if (c == '{') {
+            ++i_;
+            v.type = Json::Type::Object;
+            if (eat('}')) return v;
+            do {
+                ws();
+                std::string k = string();
+                expect(':');
+                v.members.emplace_back(std::move(k), value());
+            } while (eat(','));
+            expect('}');
+        } else if (c == '[') {
+            ++i_;
+            v.type = Json::Type::Array;
+            if (eat(']')) return v;
+            do v.items.push_back(value()); while (eat(','));
+            expect(']');
+        } else if (c == '"') {
+            v.type = Json::Type::String;
+            v.str = string();
+        } else if (s_.compare(i_, 4, "true") == 0)  { i_ += 4; v.type = Json::Type::Bool; v.boolean = true; }
+        else if (s_.compare(i_, 5, "false") == 0)   { i_ += 5; v.type = Json::Type::Bool; }
+        else if (s_.compare(i_, 4, "null") == 0)    { i_ += 4; }
+        else {
+            char* end = nullptr;
+            v.number = std::strtod(s_.c_str() + i_, &end);
+            if (end == s_.c_str() + i_) fail("bad value");
+            i_ = static_cast<size_t>(end - s_.c_str());
+            v.type = Json::Type::Number;
+        }
+        return v;
+    }
+
+    std::string string() {
+        if (i_ >= s_.size() || s_[i_] != '"') fail("expected string");
+        ++i_;
+        std::string out;
+        while (i_ < s_.size() && s_[i_] != '"') {
+            char c = s_[i_++];
+            if (c == '\\' && i_ < s_.size()) {
+                c = s_[i_++];
+                if (c == 'u') {   // only ever \u00XX here
+                    out += static_cast<char>(std::stoi(s_.substr(i_, 4), nullptr, 16));
+                    i_ += 4;
+                    continue;
+                }
+                if (c == 'n') c = '\n';
+                else if (c == 't') c = '\t';
+            }
+            out += c;
+        }
+        if (i_ >= s_.size()) fail("unterminated string");
+        ++i_;
+        return out;
+    }
+
+    const std::string& s_;
+    size_t i_ = 0;
+};
+
+Json load_json(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("cannot open " + path);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return JsonParser(ss.str()).parse();
+}
+
+// ─────────────────────────────────────────────
+// Compare
+// ─────────────────────────────────────────────
+
+struct GateMetric {
+    const char* name;
+    std::initializer_list<const char*> path;
+    bool higher_is_better;
+};
+
+const GateMetric kMetrics[] = {
+    {"ops_per_sec",          {"throughput", "ops_per_sec"},  true},
+    {"p50",                  {"latency_ns", "p50"},          false},
+    {"p90",                  {"latency_ns", "p90"},          false},
+    {"p99",                  {"latency_ns", "p99"},          false},
+    {"p999",                 {"latency_ns", "p999"},         false},
+    {"cycles_per_op",        {"perf", "cycles_per_op"},        false},
+    {"instructions_per_op",  {"perf", "instructions_per_op"},  false},
+    {"ipc",                  {"perf", "ipc"},                  true},
+    {"cache_misses_per_op",  {"perf", "cache_misses_per_op"},  false},
+    {"branch_misses_per_op", {"perf", "branch_misses_per_op"}, false},
+};
+
+const GateMetric* find_metric(const std::string& name) {
+    for (const auto& m : kMetrics) if (name == m.name) return &m;
+    return nullptr;
+}
+
+// Returns the number of regressions beyond the threshold.
+size_t compare(const Json& base, const Json& cur, const Options& opt) {
+    const auto key = [](const Json& r) {
+        const Json* s = r.get("scenario");
+        const Json* b = r.get("book");
+        return (s ? s->str : "?") + "/" + (b ? b->str : "?");
+    };
+    const Json* base_results = base.get("results");
+    const Json* cur_results  = cur.get("results");
+    if (!base_results || !cur_results) throw std::runtime_error("not a bench_suite result file (no \"results\")");
+
+    const Json* bb = base.path({"host", "build"});
+    const Json* cb = cur.path({"host", "build"});
+    if (bb && cb && bb->str != cb->str)
+        std::cout << "  warning: comparing a " << cb->str << " build against a " << bb->str << " baseline\n";
+
+    std::unordered_map<std::string, const Json*> baseline;
+    for (const Json& r : base_results->items) baseline[key(r)] = &r;
+
+    std::cout << "\n── Compare (threshold " << opt.threshold << "%) ──\n";
+    std::cout << "  " << std::left << std::setw(24) << "scenario/book" << std::setw(22) << "metric" << std::right
+              << std::setw(14) << "baseline" << std::setw(14) << "current" << std::setw(10) << "change" << "\n";
+    size_t regressions = 0, compared = 0;
+    for (const Json& r : cur_results->items) {
+        const auto it = baseline.find(key(r));
+        if (it == baseline.end()) {
+            std::cout << "  " << std::left << std::setw(24) << key(r) << std::right << "  (not in baseline)\n";
+            continue;
+        }
+        const Json* bo = it->second->get("ops");
+        const Json* co = r.get("ops");
+        if (bo && co && bo->number != co->number)
+            std::cout << "  " << std::left << std::setw(24) << key(r) << std::right
+                      << "  warning: op counts differ (" << bo->number << " vs " << co->number << ")\n";
+        for (const std::string& g : opt.gate) {
+            const GateMetric* m = find_metric(g);
+            const Json* b = it->second->path(m->path);
+            const Json* c = r.path(m->path);
+            if (!b || !c || b->type != Json::Type::Number || c->type != Json::Type::Number || b->number <= 0) continue;
+            ++compared;
+            const double change = (c->number - b->number) / b->number * 100.0;
+            const bool worse = m->higher_is_better ? change < -opt.threshold : change > opt.threshold;
+            regressions += worse;
+            std::cout << "  " << std::left << std::setw(24) << key(r) << std::setw(22) << m->name << std::right
+                      << std::fixed << std::setprecision(1) << std::setw(14) << b->number << std::setw(14) << c->number
+                      << std::showpos << std::setw(9) << change << "%" << std::noshowpos << std::defaultfloat
+                      << (worse ? "  ✗ REGRESSION" : "") << "\n";
+        }
+    }
+    for (const auto& [k, r] : baseline) {
+        (void)r;
+        bool found = false;
+        for (const Json& c : cur_results->items) found = found || key(c) == k;
+        if (!found) std::cout << "  " << std::left << std::setw(24) << k << std::right << "  (not run)\n";
+    }
+    if (compared == 0) std::cout << "  nothing comparable (missing metrics or scenarios)\n";
+    std::cout << (regressions ? "  REGRESSION: " + std::to_string(regressions) + " metric(s) beyond "
+                                + json_num(opt.threshold) + "%\n"
+                              : std::string("  no regressions\n"));
+    return regressions;
+}
+
+// ─────────────────────────────────────────────
+// CLI
+// ─────────────────────────────────────────────
+
+std::vector<std::string> split(const std::string& s) {
+    std::vector<std::string> out;
+    std::stringstream ss(s);
+    for (std::string item; std::getline(ss, item, ',');) if (!item.empty()) out.push_back(item);
+    return out;
+}
+
+void usage() {
+    std::cout << "usage: bench_suite [--scenario a,b] [--book a,b] [--ops N] [--reps R] [--seed S]\n"
+                 "                   [--quick] [--perf] [--feed FILE] [--json FILE]\n"
+                 "                   [--compare BASE [--against CUR]] [--threshold PCT] [--gate m1,m2]\n"
+                 "                   [--list]\n";
+}
+
+Options parse(int argc, char** argv) {
+    Options o;
+    for (int i = 1; i < argc; ++i) {
+        const std::string s = argv[i];
+        const bool more = i + 1 < argc;
+        if (s == "--scenario" && more)       o.scenarios = split(argv[++i]);
+        else if (s == "--book" && more)      o.books = split(argv[++i]);
+        else if (s == "--ops" && more)       o.ops = std::stoull(argv[++i]);
+        else if (s == "--reps" && more)      o.reps = std::stoull(argv[++i]);
+        else if (s == "--seed" && more)      o.seed = std::stoull(argv[++i]);
+        else if (s == "--quick")             { o.ops = 100'000; o.reps = 1; }
+        else if (s == "--perf")              o.perf = true;
+        else if (s == "--feed" && more)      o.feed = argv[++i];
+        else if (s == "--json" && more)      o.json = argv[++i];
+        else if (s == "--compare" && more)   o.compare = argv[++i];
+        else if (s == "--against" && more)   o.against = argv[++i];
+        else if (s == "--threshold" && more) o.threshold = std::stod(argv[++i]);
+        else if (s == "--gate" && more)      o.gate = split(argv[++i]);
+        else if (s == "--list")              o.list = true;
+        else { usage(); std::exit(s == "--help" ? 0 : 2); }
+    }
+    for (const auto& g : o.gate)
+        if (!find_metric(g)) throw std::runtime_error("unknown gate metric '" + g + "' (see --list)");
+    return o;
+}
+
+bool selected(const std::vector<std::string>& filter, const std::string& name) {
+    return filter.empty() || std::find(filter.begin(), filter.end(), name) != filter.end();
+}
+
+std::string per_op_cell(double v, int precision) {
+    if (v < 0) return "-";
+    std::ostringstream os;
+    os << std::fixed << std::setprecision(precision) << v;
+    return os.str();
+}
+
+void print_scenario(const Scenario& sc, const std::vector<Result>& rows) {
+    const Result& r0 = rows.front();
+    const auto pct = [&](size_t k) { return 100.0 * static_cast<double>(r0.kinds[k]) / static_cast<double>(std::max<size_t>(1, r0.ops)); };
+    std::cout << "\n── " << sc.name << " — " << sc.what << "\n";
+    std::cout << "   " << r0.ops << " ops (" << std::fixed << std::setprecision(0) << pct(0) << "% new, "
+              << pct(1) << "% cancel, " << pct(2) << "% amend) after " << sc.warm << " warm-up ops; "
+              << r0.trades << " trades";
+    if (r0.stops_triggered) std::cout << ", " << r0.stops_triggered << " stops triggered";
+    std::cout << "\n" << std::defaultfloat;
+    std::cout << "   book   │  Mops/s │ ns/op │  p50 │  p90 │   p99 │ p99.9 │    max │  IPC │ LLC/op │ brmiss/op\n";
+    std::cout << "  ────────┼─────────┼───────┼──────┼──────┼───────┼───────┼────────┼──────┼────────┼──────────\n";
+    for (const Result& r : rows) {
+        std::cout << "   " << std::left << std::setw(6) << r.book << std::right << " │ "
+                  << std::fixed << std::setprecision(2) << std::setw(7) << r.ops_per_sec / 1e6 << " │ "
+                  << std::setprecision(0) << std::setw(5) << 1e9 / r.ops_per_sec << " │ "
+                  << std::setw(4) << r.latency.p50 << " │ " << std::setw(4) << r.latency.p90 << " │ "
+                  << std::setw(5) << r.latency.p99 << " │ " << std::setw(5) << r.latency.p999 << " │ "
+                  << std::setw(6) << r.latency.max << " │ "
+                  << std::setw(4) << per_op_cell(r.ipc(), 2) << " │ "
+                  << std::setw(6) << per_op_cell(r.per_op(PerfCounters::CacheMisses), 2) << " │ "
+                  << std::setw(9) << per_op_cell(r.per_op(PerfCounters::BranchMisses), 2)
+                  << std::defaultfloat << "\n";
+    }
+    for (const Result& r : rows)
+        if (r.recenters) std::cout << "   (" << r.book << ": " << r.recenters << " band re-centers)\n";
+    if (sc.name == "replay")
+        std::cout << "   replay fidelity: " << r0.trades << " trades vs " << sc.captured_trades << " in the capture\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        const Options opt = parse(argc, argv);
+
+        if (opt.list) {
+            std::cout << "scenarios:";
+            for (const auto& s : kScenarios) std::cout << " " << s.name;
+            std::cout << "\nbooks:";
+            for (const auto& b : kBooks) std::cout << " " << b.name << " (" << b.what << ")";
+            std::cout << "\ngate metrics:";
+            for (const auto& m : kMetrics) std::cout << " " << m.name;
+            std::cout << "\n";
+            return 0;
+        }
+
+        if (!opt.compare.empty() && !opt.against.empty())
+            return compare(load_json(opt.compare), load_json(opt.against), opt) ? 1 : 0;
+
+        std::unique_ptr<PerfCounters> perf;
+        if (opt.perf) {
+            perf = std::make_unique<PerfCounters>();
+            if (!perf->available()) {
+                std::cout << "  note: hardware counters unavailable (" << perf->error() << "); running without\n";
+                perf.reset();
+            }
+        }
+
+        std::cout << "\n══════════════════════════════════════════════════════════\n";
+        std::cout << "  Benchmark suite — " << opt.ops << " ops per scenario, " << opt.reps << " rep(s), "
+                  << "clock " << TscClock::source() << (perf ? ", perf counters on" : "") << "\n";
+        std::cout << "══════════════════════════════════════════════════════════\n";
+
+        std::vector<Result> results;
+        std::vector<Scenario> ran;
+        bool agree = true;
+        for (const auto& def : kScenarios) {
+            if (!selected(opt.scenarios, def.name)) continue;
+            Scenario sc = def.make(opt.ops, opt.seed, opt.feed);
+            std::vector<Result> rows;
+            for (const auto& b : kBooks) {
+                if (!selected(opt.books, b.name)) continue;
+                rows.push_back(b.run(sc, opt, perf.get()));
+                rows.back().book = b.name;
+            }
+            if (rows.empty()) continue;
+            for (const Result& r : rows) {
+                const Result& f = rows.front();
+                if (r.fingerprint != f.fingerprint || r.trades != f.trades || r.volume != f.volume
+                    || r.stops_triggered != f.stops_triggered) {
+                    std::cout << "  FATAL: " << sc.name << ": " << r.book << " and " << f.book
+                              << " print different trade streams\n";
+                    agree = false;
+                }
+            }
+            print_scenario(sc, rows);
+            results.insert(results.end(), rows.begin(), rows.end());
+            sc.ops.clear();
+            sc.ops.shrink_to_fit();
+            ran.push_back(std::move(sc));
+        }
+        if (ran.empty()) {
+            std::cerr << "no scenario / book matched (see --list)\n";
+            return 2;
+        }
+
+        std::cout << "\n  books agree: " << (agree ? "YES ✓" : "NO ✗") << "\n";
+
+        if (!opt.json.empty()) {
+            std::ofstream out(opt.json);
+            write_json(out, opt, results, ran, perf != nullptr, agree);
+            if (!out) throw std::runtime_error("cannot write " + opt.json);
+            std::cout << "  results: " << opt.json << "\n";
+        }
+
+        int status = agree ? 0 : 1;
+        if (!opt.compare.empty()) {
+            std::stringstream cur;
+            write_json(cur, opt, results, ran, perf != nullptr, agree);
+            if (compare(load_json(opt.compare), JsonParser(cur.str()).parse(), opt)) status = 1;
+        }
+        std::cout << "\n";
+        return status;
+    } catch (const std::exception& e) {
+        std::cerr << "bench_suite: " << e.what() << "\n";
+        return 2;
+    }
+}
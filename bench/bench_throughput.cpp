@@ -6,6 +6,9 @@
  *   • Per-order latency distribution (p50/p95/p99/p999)
  *   • Arena allocator overhead vs raw new/delete
  *   • Book depth impact on matching performance
+ *   • Event dispatch: std::function listeners vs compile-time sinks
+ *   • Batched entry: submit_batch at batch sizes 1 / 8 / 64 / 512
+ *   • Warm restart: checkpoint load vs re-submitting the order history
  *
  * Methodology:
  *   Pre-generate all orders, then measure only the matching hot path.
@@ -15,6 +18,10 @@
 #include "../core/include/MatchingEngine.h"
 #include "../core/include/OrderBook.h"
 #include "../core/include/Order.h"
+#include "../core/include/EventSink.h"
+#include "../core/include/BookCheckpoint.h"
+#include "../md/include/FeedPublisher.h"
+#include "../md/include/FeedRecovery.h"
 
 #include <chrono>
 #include <iostream>
@@ -23,6 +30,11 @@
 #include <random>
 #include <algorithm>
 #include <numeric>
+#include <span>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
 
 using namespace micro_exchange::core;
 
@@ -255,6 +267,305 @@ void bench_depth_impact() {
     }
 }
 
+// ─────────────────────────────────────────────
+// Benchmark: Event dispatch (listeners vs static sinks)
+// ─────────────────────────────────────────────
+
+// Engine + feed publisher on one book, the production wiring. Only the
+// dispatch mechanism differs between the two instantiations.
+template <typename Book>
+double run_dispatch(const std::vector<NewOrderRequest>& orders, uint64_t& trades) {
+    BasicMatchingEngine<Book> engine;
+    Book& book = engine.add_symbol("BENCH");
+    micro_exchange::md::FeedPublisher feed;
+    feed.attach(book);
+
+    auto start = Clock::now();
+    for (const auto& req : orders) engine.submit_order(req);
+    auto end = Clock::now();
+
+    trades = engine.get_stats().total_trades;
+    return orders.size() / (std::chrono::duration_cast<ns>(end - start).count() / 1e9);
+}
+
+void bench_event_dispatch(size_t num_orders) {
+    std::cout << "\n── Event Dispatch (" << num_orders << " orders, engine + feed) ──\n";
+
+    using StaticBook = BasicOrderBook<SinkChain<EngineStatsSink, micro_exchange::md::FeedSink>>;
+    auto orders = generate_orders(num_orders);
+
+    uint64_t dyn_trades = 0, sta_trades = 0;
+    double dyn = run_dispatch<OrderBook>(orders, dyn_trades);
+    double sta = run_dispatch<StaticBook>(orders, sta_trades);
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "  std::function listeners: " << dyn / 1e6 << "M orders/sec\n";
+    std::cout << "  static SinkChain:        " << sta / 1e6 << "M orders/sec  ("
+              << sta / dyn << "x)\n";
+    std::cout << "  trades identical:        " << (dyn_trades == sta_trades ? "YES" : "NO") << "\n";
+}
+
+// ─────────────────────────────────────────────
+// Benchmark: Feed quote modes
+// ─────────────────────────────────────────────
+
+void bench_feed_quotes(size_t num_orders) {
+    std::cout << "\n── Feed Quote Modes (" << num_orders << " orders, engine + feed) ──\n";
+    using micro_exchange::md::FeedPublisher;
+
+    auto orders = generate_orders(num_orders);
+    struct Mode { const char* name; FeedPublisher::QuoteMode mode; size_t depth; };
+    const Mode modes[] = {
+        {"every event", FeedPublisher::QuoteMode::EveryEvent, 0},
+        {"change-only", FeedPublisher::QuoteMode::ChangeOnly, 0},
+        {"conflated  ", FeedPublisher::QuoteMode::Conflated,  0},
+        {"+ L2 top 10", FeedPublisher::QuoteMode::ChangeOnly, 10},
+    };
+
+    std::cout << std::fixed << std::setprecision(2);
+    for (const Mode& m : modes) {
+        MatchingEngine engine;
+        OrderBook& book = engine.add_symbol("BENCH");
+        FeedPublisher::Options opts;
+        opts.quote_mode = m.mode;
+        opts.depth_levels = m.depth;
+        FeedPublisher feed(opts);
+        feed.attach(book);
+
+        auto start = Clock::now();
+        for (const auto& req : orders) engine.submit_order(req);
+        feed.flush();
+        auto end = Clock::now();
+
+        const double secs = std::chrono::duration_cast<ns>(end - start).count() / 1e9;
+        const auto st = feed.get_stats();
+        std::cout << "  " << m.name << ": " << orders.size() / secs / 1e6 << "M orders/sec, "
+                  << st.quote_count << " quotes, " << st.level_update_count << " level updates / "
+                  << st.total_messages << " messages\n";
+    }
+}
+
+// ─────────────────────────────────────────────
+// Benchmark: Feed to disk (retained + dump vs streamed)
+// ─────────────────────────────────────────────
+
+void bench_feed_writer(size_t num_orders) {
+    std::cout << "\n── Feed To Disk (" << num_orders << " orders, engine + feed) ──\n";
+    using namespace micro_exchange::md;
+    namespace fs = std::filesystem;
+    const std::string path = (fs::temp_directory_path() / "mx_bench_feed.bin").string();
+    auto orders = generate_orders(num_orders);
+
+    auto run = [&](const char* name, bool retain, bool stream, FeedFormat fmt) {
+        MatchingEngine engine;
+        OrderBook& book = engine.add_symbol("BENCH");
+        FeedPublisher::Options opts;
+        opts.retain_messages = retain;
+        FeedPublisher feed(opts);
+        std::unique_ptr<FeedWriter> writer;
+        if (stream) {
+            FeedWriter::Options wopts;
+            wopts.format = fmt;
+            writer = std::make_unique<FeedWriter>(path, wopts);
+            feed.set_writer(writer.get());
+        }
+        feed.attach(book);
+
+        auto start = Clock::now();
+        for (const auto& req : orders) engine.submit_order(req);
+        if (writer) writer->close();
+        else        feed.dump_to_file(path, fmt);
+        auto end = Clock::now();
+
+        const double secs = std::chrono::duration_cast<ns>(end - start).count() / 1e9;
+        std::cout << "  " << name << ": " << orders.size() / secs / 1e6 << "M orders/sec, "
+                  << (fs::file_size(path) >> 20) << " MiB on disk, "
+                  << (feed.messages().capacity() * sizeof(FeedMessage) >> 20) << " MiB held\n";
+        fs::remove(path);
+    };
+
+    std::cout << std::fixed << std::setprecision(2);
+    run("retain + dump fixed  ", true,  false, FeedFormat::Fixed);
+    run("retain + dump compact", true,  false, FeedFormat::Compact);
+    run("stream compact       ", false, true,  FeedFormat::Compact);
+}
+
+// ─────────────────────────────────────────────
+// Benchmark: Feed replay (ifstream vs mmap, books rebuilt in parallel)
+// ─────────────────────────────────────────────
+
+void bench_feed_replay(size_t num_orders) {
+    std::cout << "\n── Feed Replay (" << num_orders << " orders, 16 symbols) ──\n";
+    using namespace micro_exchange::md;
+    namespace fs = std::filesystem;
+    const std::string fixed   = (fs::temp_directory_path() / "mx_bench_replay_fixed.bin").string();
+    const std::string compact = (fs::temp_directory_path() / "mx_bench_replay_compact.bin").string();
+
+    {
+        MatchingEngine engine;
+        FeedPublisher feed;
+        std::vector<std::string> syms;
+        for (int s = 0; s < 16; ++s) {
+            syms.push_back("SYM" + std::to_string(s));
+            feed.attach(engine.add_symbol(syms.back()));
+        }
+        auto orders = generate_orders(num_orders);
+        for (size_t i = 0; i < orders.size(); ++i) {
+            const auto& sym = syms[(i / 8) % syms.size()];   // runs of 8 per symbol
+            std::memset(orders[i].symbol, 0, sizeof(orders[i].symbol));
+            std::memcpy(orders[i].symbol, sym.data(), sym.size());
+            engine.submit_order(orders[i]);
+        }
+        feed.dump_to_file(fixed, FeedFormat::Fixed);
+        feed.dump_to_file(compact, FeedFormat::Compact);
+    }
+
+    std::cout << std::fixed << std::setprecision(2);
+    auto timed = [](const char* name, size_t msgs, auto&& fn) {
+        auto start = Clock::now();
+        fn();
+        const double secs = std::chrono::duration_cast<ns>(Clock::now() - start).count() / 1e9;
+        std::cout << "  " << std::left << std::setw(24) << name << std::right << ": " << secs * 1e3 << " ms  (" << msgs / secs / 1e6 << "M msg/sec)\n";
+    };
+
+    const MappedFeed mapped(fixed);
+    const size_t msgs = mapped.size();
+    uint64_t sink = 0;
+    timed("ifstream read, fixed", msgs, [&] {   // the old FeedReplayer loop
+        std::ifstream ifs(fixed, std::ios::binary);
+        FeedMessage msg;
+        while (ifs.read(reinterpret_cast<char*>(&msg), sizeof(msg))) sink += msg.quantity;
+    });
+    timed("mmap open (index), fixed", msgs, [&] { sink += MappedFeed(fixed).size(); });
+    timed("span scan, fixed", msgs, [&] {
+        for (const auto& m : mapped.messages()) sink += m.quantity;
+    });
+    const MappedFeed mapped_compact(compact);
+    timed("decode replay, compact", msgs, [&] {
+        mapped_compact.replay([&](const FeedMessage& m) { sink += m.quantity; });
+    });
+    timed("seek + 10k replay", 10000, [&] {
+        const auto from = mapped.seek_sequence(msgs / 2);
+        mapped.replay(from, {from.ordinal + 10000, 0}, [&](const FeedMessage& m) { sink += m.quantity; });
+    });
+    for (size_t threads : {1, 2, 4}) {
+        const std::string name = "rebuild 16 books, " + std::to_string(threads) + " thr";
+        timed(name.c_str(), msgs, [&] {
+            auto books = rebuild_books<OrderBook>(mapped, threads);
+            for (const auto& b : books) sink += b.book->active_orders();
+        });
+    }
+    if (sink == 42) std::cout << "";   // keep the loops
+    fs::remove(fixed);
+    fs::remove(compact);
+}
+
+// ─────────────────────────────────────────────
+// Benchmark: Batched entry (submit_batch)
+// ─────────────────────────────────────────────
+
+void bench_batch_sizes(size_t num_orders) {
+    std::cout << "\n── Batched Entry (" << num_orders << " orders via MatchingEngine) ──\n";
+
+    auto orders = generate_orders(num_orders);
+    double base = 0;
+    uint64_t ref_trades = 0;
+    bool identical = true;
+
+    std::cout << "  batch │ M orders/sec │ vs submit_order\n";
+    std::cout << "  ──────┼──────────────┼────────────────\n";
+
+    // Batch size 0 = one submit_order() per order, the baseline.
+    for (size_t batch : {size_t{0}, size_t{1}, size_t{8}, size_t{64}, size_t{512}}) {
+        MatchingEngine engine;
+        engine.add_symbol("BENCH");
+        std::span<const NewOrderRequest> all(orders);
+
+        auto start = Clock::now();
+        if (batch == 0) {
+            for (const auto& req : orders) engine.submit_order(req);
+        } else {
+            for (size_t i = 0; i < all.size(); i += batch) {
+                engine.submit_batch(all.subspan(i, std::min(batch, all.size() - i)));
+            }
+        }
+        auto end = Clock::now();
+
+        double rate = num_orders / (std::chrono::duration_cast<ns>(end - start).count() / 1e9);
+        uint64_t trades = engine.get_stats().total_trades;
+        if (batch == 0) { base = rate; ref_trades = trades; }
+        identical = identical && trades == ref_trades;
+
+        std::cout << "  " << std::setw(5);
+        if (batch == 0) std::cout << "-"; else std::cout << batch;
+        std::cout << " │ " << std::fixed << std::setprecision(2) << std::setw(12) << rate / 1e6
+                  << " │ " << std::setw(6) << rate / base << "x\n";
+    }
+    std::cout << "  trades identical:  " << (identical ? "YES" : "NO") << "\n";
+}
+
+// ─────────────────────────────────────────────
+// Benchmark: Warm restart (checkpoint vs re-submit)
+// ─────────────────────────────────────────────
+
+void bench_warm_restart(size_t num_orders) {
+    std::cout << "\n── Warm Restart (" << num_orders << " resting orders) ──\n";
+
+    // A deep two-sided book (1000 levels a side) plus 5% parked stops.
+    std::mt19937_64 rng(7);
+    std::vector<NewOrderRequest> orders(num_orders);
+    for (size_t i = 0; i < num_orders; ++i) {
+        NewOrderRequest& req = orders[i];
+        req.id       = i + 1;
+        req.side     = (i & 1) ? Side::Buy : Side::Sell;
+        req.type     = OrderType::Limit;
+        req.tif      = TimeInForce::GTC;
+        req.quantity = 100 * (1 + rng() % 10);
+        const Price off = 1 + static_cast<Price>(rng() % 1000);
+        req.price = req.side == Side::Buy ? 10000 - off : 10000 + off;
+        if (i % 20 == 0) {
+            req.type       = OrderType::Stop;
+            req.stop_price = req.side == Side::Buy ? 11000 + off : 9000 - off;
+            req.price      = PRICE_MARKET;
+        }
+        std::memcpy(req.symbol, "BENCH", 6);
+    }
+    const std::string path =
+        (std::filesystem::temp_directory_path() / "mx_bench_checkpoint.bin").string();
+    auto secs = [](auto a, auto b) { return std::chrono::duration_cast<ns>(b - a).count() / 1e9; };
+
+    OrderBook live("BENCH", num_orders);
+    for (const auto& req : orders) live.add_order(req);
+
+    auto t0 = Clock::now();
+    write_checkpoint(live, path);
+    auto t1 = Clock::now();
+
+    OrderBook resubmitted("BENCH", num_orders);
+    auto t2 = Clock::now();
+    for (const auto& req : orders) resubmitted.add_order(req);
+    auto t3 = Clock::now();
+
+    OrderBook loaded("BENCH", num_orders);
+    auto t4 = Clock::now();
+    bool ok = load_checkpoint(loaded, path).has_value();
+    auto t5 = Clock::now();
+    std::remove(path.c_str());
+
+    ok = ok && loaded.active_orders() == live.active_orders()
+            && loaded.bid_depth() == live.bid_depth() && loaded.ask_depth() == live.ask_depth()
+            && loaded.sequence() == live.sequence();
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "  live orders:          " << live.active_orders() << " ("
+              << live.parked_stop_count() << " parked stops)\n";
+    std::cout << "  write checkpoint:     " << secs(t0, t1) * 1e3 << " ms\n";
+    std::cout << "  re-submit orders:     " << secs(t2, t3) * 1e3 << " ms\n";
+    std::cout << "  load checkpoint:      " << secs(t4, t5) * 1e3 << " ms  ("
+              << secs(t2, t3) / secs(t4, t5) << "x faster)\n";
+    std::cout << "  state identical:      " << (ok ? "YES" : "NO") << "\n";
+}
+
 // ─────────────────────────────────────────────
 // Main
 // ─────────────────────────────────────────────
@@ -268,6 +579,12 @@ int main() {
     bench_throughput(1000000);
     bench_latency(100000);
     bench_depth_impact();
+    bench_event_dispatch(300000);
+    bench_feed_quotes(300000);
+    bench_feed_writer(1000000);
+    bench_feed_replay(1000000);
+    bench_batch_sizes(1000000);
+    bench_warm_restart(1000000);
 
     std::cout << "\n══════════════════════════════════════════════\n";
     std::cout << "  Benchmarks complete\n";
@@ -2,13 +2,53 @@
 
 #include <cstdint>
 #include <cstddef>
+#include <cstring>
 #include <vector>
 #include <memory>
 #include <cassert>
 #include <new>
 
+#include <sys/mman.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
 namespace micro_exchange::core {
 
+/**
+ * How an ArenaAllocator backs its slabs.
+ *
+ *   use_mmap    — anonymous mmap instead of the heap. Slabs are page-aligned
+ *                 and munmap'd on destruction.
+ *   huge_pages  — (needs use_mmap) try MAP_HUGETLB 2 MiB pages first; if the
+ *                 hugetlbfs pool is empty fall back to normal pages with
+ *                 madvise(MADV_HUGEPAGE) so THP can still back the slab.
+ *   prefault    — fault every page in when the slab is created (MAP_POPULATE
+ *                 where available, else a write per page) so the first order
+ *                 into a cold slab doesn't take a page fault.
+ *   numa_node   — (Linux, needs use_mmap) mbind the slab to this node before
+ *                 it is faulted in; -1 leaves placement to the kernel.
+ *
+ * Every option degrades silently — a box without huge pages or NUMA still
+ * gets a working arena; ArenaStats says what was actually obtained.
+ */
+struct ArenaOptions {
+    bool use_mmap   = false;
+    bool huge_pages = false;
+    bool prefault   = false;
+    int  numa_node  = -1;
+};
+
+struct ArenaStats {
+    size_t allocated    = 0;   // live elements
+    size_t capacity     = 0;   // elements across all slabs
+    size_t slabs        = 0;   // slab count (1 = never grew)
+    size_t bytes        = 0;   // bytes reserved for slabs
+    size_t huge_slabs   = 0;   // slabs backed by MAP_HUGETLB pages
+    size_t numa_bound   = 0;   // slabs successfully mbind'ed
+};
+
     /**
      * ArenaAllocator — Fixed-type slab allocator for Order objects.
      *
@@ -16,8 +56,15 @@ namespace micro_exchange::core {
      * malloc is ~50-200ns; this is ~5ns. The difference matters when you're
      * doing millions of allocations per second.
      *
-     * Growth: when exhausted, allocate new slab of 2x size.
-     * Deallocation: push back to free-list (no system call).
+     * Growth: when exhausted, allocate a new slab as large as the current
+     * capacity (total doubles). Deallocation: push back to free-list (no
+     * system call). Size the initial capacity for the session's peak and a
+     * warmed arena never grows — `stats().slabs == 1` confirms it.
+     *
+     * Slabs are aligned to max(alignof(T), 64) so `alignas(64)` elements
+     * really start on a cache line (plain `new std::byte[]` only promises
+     * max_align_t). ArenaOptions selects mmap / huge-page / prefaulted /
+     * NUMA-bound backing.
      *
      * NOTE: currently never returns memory to the OS. This is fine for
      * the simulation (it exits when done) but would need periodic cleanup
@@ -26,10 +73,10 @@ namespace micro_exchange::core {
 template <typename T>
 class ArenaAllocator {
 public:
-    explicit ArenaAllocator(size_t initial_capacity = 65536)
-        : capacity_(initial_capacity)
+    explicit ArenaAllocator(size_t initial_capacity = 65536, ArenaOptions opts = {})
+        : opts_(opts)
     {
-        grow(initial_capacity);
+        grow(initial_capacity ? initial_capacity : 1);
     }
 
     ~ArenaAllocator() = default;
@@ -47,7 +94,7 @@ public:
      */
     [[nodiscard]] T* allocate() {
         if (!free_head_) [[unlikely]] {
-            grow(capacity_ * 2);
+            grow(capacity_);
         }
 
         FreeNode* node = free_head_;
@@ -84,9 +131,32 @@ public:
         deallocate(ptr);
     }
 
+    /**
+     * Make sure at least `count` elements fit without growing mid-session.
+     * Adds one slab for the shortfall; a no-op if capacity already covers it.
+     */
+    void reserve(size_t count) {
+        if (count > capacity_) grow(count - capacity_);
+    }
+
     [[nodiscard]] size_t allocated() const noexcept { return allocated_; }
     [[nodiscard]] size_t capacity() const noexcept { return capacity_; }
 
+    [[nodiscard]] ArenaStats stats() const noexcept {
+        ArenaStats s;
+        s.allocated = allocated_;
+        s.capacity  = capacity_;
+        s.slabs     = slabs_.size();
+        for (const auto& slab : slabs_) {
+            s.bytes      += slab.get_deleter().bytes;
+            s.huge_slabs += slab.get_deleter().huge;
+            s.numa_bound += slab.get_deleter().bound;
+        }
+        return s;
+    }
+
+    [[nodiscard]] const ArenaOptions& options() const noexcept { return opts_; }
+
 private:
     struct FreeNode {
         FreeNode* next = nullptr;
@@ -95,11 +165,87 @@ private:
     static_assert(sizeof(T) >= sizeof(FreeNode),
         "Arena element must be at least pointer-sized");
 
+    static constexpr size_t kAlign     = alignof(T) > 64 ? alignof(T) : 64;
+    static constexpr size_t kHugePage  = size_t{2} << 20;
+
+    // Frees a slab the way it was obtained.
+    struct SlabDeleter {
+        size_t bytes  = 0;
+        bool   mapped = false;
+        bool   huge   = false;
+        bool   bound  = false;
+        bool   populated = false;   // mapped with MAP_POPULATE: already faulted in
+
+        void operator()(std::byte* p) const noexcept {
+            if (!p) return;
+            if (mapped) ::munmap(p, bytes);
+            else        ::operator delete(p, std::align_val_t{kAlign});
+        }
+    };
+    using Slab = std::unique_ptr<std::byte, SlabDeleter>;
+
+    static size_t round_up(size_t n, size_t to) { return (n + to - 1) / to * to; }
+
+    Slab map_slab(size_t bytes) const {
+        SlabDeleter d;
+        d.mapped = true;
+        const int prot = PROT_READ | PROT_WRITE;
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_POPULATE
+        // Binding must happen before the pages exist, so populate later.
+        if (opts_.prefault && opts_.numa_node < 0) flags |= MAP_POPULATE;
+        d.populated = (flags & MAP_POPULATE) != 0;   // holds once the mmap below succeeds
+#endif
+        void* p = MAP_FAILED;
+#ifdef MAP_HUGETLB
+        if (opts_.huge_pages) {
+            d.bytes = round_up(bytes, kHugePage);
+            p = ::mmap(nullptr, d.bytes, prot, flags | MAP_HUGETLB, -1, 0);
+            d.huge = p != MAP_FAILED;
+        }
+#endif
+        if (p == MAP_FAILED) {
+            const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+            d.bytes = round_up(bytes, opts_.huge_pages ? kHugePage : page);
+            p = ::mmap(nullptr, d.bytes, prot, flags, -1, 0);
+            if (p == MAP_FAILED) throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+            if (opts_.huge_pages) ::madvise(p, d.bytes, MADV_HUGEPAGE);
+#endif
+        }
+#if defined(__linux__) && defined(SYS_mbind)
+        if (opts_.numa_node >= 0 && opts_.numa_node < 64) {
+            constexpr int kMpolBind = 2;          // MPOL_BIND, without <numaif.h>
+            unsigned long mask = 1UL << opts_.numa_node;
+            d.bound = ::syscall(SYS_mbind, p, d.bytes, kMpolBind, &mask,
+                                sizeof(mask) * 8, 0) == 0;
+        }
+#endif
+        return Slab(static_cast<std::byte*>(p), d);
+    }
+
     void grow(size_t count) {
-        // Allocate a contiguous slab
-        auto slab = std::make_unique<std::byte[]>(count * sizeof(T));
+        const size_t bytes = count * sizeof(T);
+        Slab slab;
+        if (opts_.use_mmap) {
+            slab = map_slab(bytes);
+        } else {
+            auto* p = static_cast<std::byte*>(::operator new(bytes, std::align_val_t{kAlign}));
+            slab = Slab(p, SlabDeleter{bytes, false, false, false, false});
+        }
         std::byte* raw = slab.get();
 
+        // Touch one byte per page so the fault cost is paid here, not on the
+        // first order into the slab. A MAP_POPULATE mapping is already
+        // faulted in; only the heap and NUMA-bound slabs need the walk.
+        if (opts_.prefault && !slab.get_deleter().populated) {
+            const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+            const size_t len  = slab.get_deleter().bytes;
+            for (size_t off = 0; off < len; off += page) {
+                static_cast<volatile std::byte*>(raw)[off] = std::byte{0};
+            }
+        }
+
         // Thread the free-list through the slab
         for (size_t i = 0; i < count; ++i) {
             auto* node = reinterpret_cast<FreeNode*>(raw + i * sizeof(T));
@@ -113,10 +259,11 @@ private:
         slabs_.push_back(std::move(slab));
     }
 
-    FreeNode*                                  free_head_  = nullptr;
-    size_t                                     capacity_   = 0;
-    size_t                                     allocated_  = 0;
-    std::vector<std::unique_ptr<std::byte[]>>  slabs_;
+    ArenaOptions        opts_;
+    FreeNode*           free_head_  = nullptr;
+    size_t              capacity_   = 0;
+    size_t              allocated_  = 0;
+    std::vector<Slab>   slabs_;
 };
 
 } // namespace micro_exchange::core
@@ -3,15 +3,22 @@
 #include "Order.h"
 #include "PriceLevel.h"
 #include "ArenaAllocator.h"
+#include "OrderIndex.h"
+#include "StopBook.h"
+#include "BookConcept.h"
+#include "EventSink.h"
+#include "LatencyProbe.h"
 
 #include <vector>
-#include <unordered_map>
 #include <functional>
 #include <optional>
+#include <span>
 #include <string>
 #include <cstring>
 #include <cstdint>
 #include <algorithm>
+#include <limits>
+#include <utility>
 
 namespace micro_exchange::core {
 
@@ -35,34 +42,66 @@ namespace micro_exchange::core {
  * cursor advance into a word-skipping scan (64 levels per instruction) instead
  * of one-level-at-a-time, making the array robust across band widths.
  *
+ * Band re-centering
+ * ─────────────────
+ * `[min_price, max_price]` is the *initial* window, not a hard limit. When a
+ * limit order has to rest outside it, the band is rebuilt around the union of
+ * the new price and every occupied level: same width if that span fits in
+ * half the current band (the market drifted), doubled otherwise (the book got
+ * wider). Levels are moved, not re-inserted, so FIFO queues are untouched.
+ * Re-centering is O(band) but amortised — a drifting market pays it once per
+ * half-band of travel.
+ *
+ * Growth is capped the way StopLadder caps its buckets: a limit price that
+ * would need more than MAX_BAND levels (a span over MAX_BAND / 2 ticks from
+ * everything resting, i.e. a price nowhere near the market) is rejected
+ * before it matches — status Rejected, no fills — and an amend to such a
+ * price fails. A single message can't make the book allocate an unbounded
+ * array; an initial band wider than MAX_BAND is kept as given.
+ *
  * This class is a drop-in alternative to `OrderBook` for the matching hot path
  * and reuses the SAME Order, PriceLevel, and ArenaAllocator, so a head-to-head
  * benchmark isolates exactly one variable: the level container. See
  * `bench/bench_orderbook_compare.cpp`, which cross-checks that both books emit
  * an identical trade stream and then compares throughput/latency.
  *
- * Scope: Limit / Market / IOC / FOK + cancel (the types the simulator and
- * benchmarks use). Stop / StopLimit / amend live in the full `OrderBook`.
+ * Scope: full parity with `OrderBook` — Limit / Market / IOC / FOK, Stop /
+ * StopLimit parking, cancel and amend — so it satisfies `OrderBookLike` and
+ * can back a `BasicMatchingEngine`.
  *
  * Matching semantics are identical to `OrderBook`: price-time priority, FIFO
  * within a level, trade prints at the resting order's price, Limit remainder
  * rests while Market / IOC / unfilled-FOK remainder cancels.
+ *
+ * Like `BasicOrderBook`, it is a template over a compile-time event `Sink`;
+ * `ArrayOrderBook` is the `NullSink` (runtime listeners only) instantiation.
  */
-class ArrayOrderBook {
+template <typename Sink = NullSink>
+class BasicArrayOrderBook {
 public:
+    using sink_type     = Sink;
     using TradeCallback = std::function<void(const Trade&)>;
     using OrderCallback = std::function<void(const Order&)>;
+    using BookLevel     = core::BookLevel;
+    using LevelCallback = std::function<void(Side, const BookLevel&)>;
+
+    static constexpr size_t MAX_BAND = size_t{1} << 20;   // levels re-centering may grow to
 
     /**
      * @param symbol     instrument symbol
-     * @param min_price  lowest supported limit price (ticks), inclusive
-     * @param max_price  highest supported limit price (ticks), inclusive
+     * @param min_price  lowest price (ticks) of the initial band, inclusive
+     * @param max_price  highest price (ticks) of the initial band, inclusive
+     * @param order_capacity  expected peak of live orders; pre-sizes the
+     *                        order index and the order arena
+     * @param arena           slab backing for the order arena (see OrderBook)
      */
-    ArrayOrderBook(const std::string& symbol, Price min_price, Price max_price)
+    BasicArrayOrderBook(const std::string& symbol, Price min_price, Price max_price,
+                        size_t order_capacity = 65536, ArenaOptions arena = {})
         : symbol_(symbol)
         , min_price_(min_price)
         , max_price_(max_price)
-        , order_arena_(65536)
+        , order_index_(order_capacity)
+        , order_arena_(order_capacity, arena)
     {
         const size_t n = static_cast<size_t>(max_price_ - min_price_ + 1);
         levels_.reserve(n);
@@ -77,9 +116,17 @@ public:
     // ── Multi-subscriber dispatch (mirrors OrderBook's API) ──
     void add_trade_listener(TradeCallback cb) { trade_listeners_.push_back(std::move(cb)); }
     void add_order_listener(OrderCallback cb) { order_listeners_.push_back(std::move(cb)); }
+    void add_level_listener(LevelCallback cb) { level_listeners_.push_back(std::move(cb)); }
     void set_trade_callback(TradeCallback cb) { add_trade_listener(std::move(cb)); }
     void set_order_callback(OrderCallback cb) { add_order_listener(std::move(cb)); }
-    void clear_listeners() { trade_listeners_.clear(); order_listeners_.clear(); }
+    void clear_listeners() {
+        trade_listeners_.clear();
+        order_listeners_.clear();
+        level_listeners_.clear();
+    }
+
+    [[nodiscard]] Sink&       sink()       noexcept { return sink_; }
+    [[nodiscard]] const Sink& sink() const noexcept { return sink_; }
 
     // ═══════════════════════════════════════════
     // Order operations
@@ -87,60 +134,110 @@ public:
 
     Order* add_order(const NewOrderRequest& req) {
         ts_ = now();                 // one clock read per event; reused for every fill
-        Order* order = order_arena_.allocate();
-        new (order) Order{};
+        probe::book_entry(ts_);
+        return process_new(req);
+    }
 
-        order->id         = req.id;
-        order->sequence   = next_sequence_++;
-        order->side       = req.side;
-        order->type       = req.type;
-        order->tif        = req.tif;
-        order->price      = req.price;
-        order->stop_price = req.stop_price;
-        order->quantity   = req.quantity;
-        order->leaves_qty = req.quantity;
-        order->filled_qty = 0;
-        order->entry_time = ts_;
-        order->last_update = ts_;
-        order->status     = OrderStatus::New;
-        std::memcpy(order->symbol, req.symbol, sizeof(order->symbol));
+    bool cancel_order(OrderId id) {
+        ts_ = now();
+        return process_cancel(id);
+    }
 
-        order_index_[order->id] = order;
+    // ───────────────────────────────────────────
+    // Batched entry
+    //
+    // Results are identical to calling add_order / cancel_order in sequence
+    // (timestamps aside): one clock read covers the whole batch, and the
+    // index slot of request i + BATCH_PREFETCH is prefetched while request i
+    // is processed.
+    // ───────────────────────────────────────────
+    static constexpr size_t BATCH_PREFETCH = 4;
 
-        // FOK: only execute if the whole quantity can be filled right now.
-        if (order->type == OrderType::FOK && !can_fill_completely(order)) {
-            order->cancel(ts_);
-            order_index_.erase(order->id);
-            notify_order(*order);
-            return order;
+    /**
+     * Submit `reqs` in order. If `out` is non-empty, out[i] receives the
+     * Order* for reqs[i] (as add_order would return). Returns reqs.size().
+     */
+    size_t submit_batch(std::span<const NewOrderRequest> reqs, std::span<Order*> out = {}) {
+        ts_ = now();
+        for (size_t i = 0; i < reqs.size(); ++i) {
+            if (i + BATCH_PREFETCH < reqs.size()) prefetch_new(reqs[i + BATCH_PREFETCH]);
+            Order* o = process_new(reqs[i]);
+            if (i < out.size()) out[i] = o;
         }
+        return reqs.size();
+    }
 
-        match(order);
+    /// Cancel `ids` in order. Returns how many were live and got cancelled.
+    size_t cancel_batch(std::span<const OrderId> ids) {
+        ts_ = now();
+        size_t cancelled = 0;
+        for (size_t i = 0; i < ids.size(); ++i) {
+            if (i + BATCH_PREFETCH < ids.size()) order_index_.prefetch(ids[i + BATCH_PREFETCH]);
+            cancelled += process_cancel(ids[i]);
+        }
+        return cancelled;
+    }
 
-        if (order->leaves_qty > 0) {
-            if (order->type == OrderType::Limit && in_band(order->price)) {
-                rest_order(order);
-            } else {
-                // Market / IOC / FOK remainder, or out-of-band limit, cancels.
-                order->cancel(ts_);
+    /**
+     * Amend price and/or quantity — same rules as OrderBook::amend_order:
+     * a price change or size-up loses priority (remove, re-match, re-rest);
+     * a size-down keeps the order's queue position.
+     */
+    bool amend_order(const AmendRequest& req) {
+        Order* order = order_index_.find(req.order_id);
+        if (!order || !order->is_active()) return false;
+
+        ts_ = now();
+        bool price_changed = (req.new_price != 0 && req.new_price != order->price);
+        bool qty_increased = (req.new_quantity != 0 && req.new_quantity > order->leaves_qty);
+        std::optional<BookLevel> left, joined;   // levels reported after the order event
+
+        if (order->type == OrderType::Stop || order->type == OrderType::StopLimit) {
+            if (req.new_price != 0 && order->type == OrderType::StopLimit) {
+                order->price = req.new_price;
+            }
+            if (req.new_quantity != 0) {
+                order->quantity = req.new_quantity;
+                order->leaves_qty = req.new_quantity - order->filled_qty;
+            }
+            order->status = OrderStatus::Amended;
+            order->last_update = ts_;
+        } else if (price_changed || qty_increased) {
+            if (price_changed && !can_rest_at(req.new_price)) return false;
+            left = remove_from_book(order);
+
+            if (req.new_price != 0) order->price = req.new_price;
+            if (req.new_quantity != 0) {
+                order->quantity = req.new_quantity;
+                order->leaves_qty = req.new_quantity - order->filled_qty;
+            }
+            order->sequence = next_sequence_++;
+            order->status = OrderStatus::Amended;
+            order->last_update = ts_;
+
+            match(order);
+            if (order->leaves_qty > 0 && order->type == OrderType::Limit) {
+                joined = rest_order(order);
+            } else if (order->leaves_qty == 0) {
                 order_index_.erase(order->id);
-                notify_order(*order);
+            }
+        } else if (req.new_quantity != 0 && req.new_quantity < order->leaves_qty) {
+            Quantity reduction = order->leaves_qty - req.new_quantity;
+            order->leaves_qty = req.new_quantity;
+            order->quantity -= reduction;
+            order->status = OrderStatus::Amended;
+            order->last_update = ts_;
+
+            if (in_band(order->price)) {
+                PriceLevel& level = levels_[idx(order->price)];
+                level.reduce_quantity(reduction);
+                joined = aggregate(level);
             }
         }
-        return order;
-    }
-
-    bool cancel_order(OrderId id) {
-        auto it = order_index_.find(id);
-        if (it == order_index_.end()) return false;
 
-        Order* order = it->second;
-        if (!order->is_active()) return false;
-
-        remove_from_book(order);
-        order->cancel();
-        order_index_.erase(it);
         notify_order(*order);
+        if (left)   notify_level(order->side, *left);
+        if (joined) notify_level(order->side, *joined);
         return true;
     }
 
@@ -172,6 +269,50 @@ public:
         return *ba - *bb;
     }
 
+    // Depth walks the bitmap from the touch outward, so an N-level query is
+    // O(N) occupied levels plus the empty words skipped between them.
+    [[nodiscard]] Quantity bid_depth(size_t max_levels = 0) const {
+        Quantity total = 0;
+        size_t count = 0;
+        for (long i = best_bid_idx_; i >= 0; i = next_occ_le(i - 1)) {
+            total += levels_[static_cast<size_t>(i)].total_quantity();
+            if (max_levels > 0 && ++count >= max_levels) break;
+        }
+        return total;
+    }
+
+    [[nodiscard]] Quantity ask_depth(size_t max_levels = 0) const {
+        Quantity total = 0;
+        size_t count = 0;
+        const long n = static_cast<long>(levels_.size());
+        for (long i = best_ask_idx_; i < n; i = next_occ_ge(i + 1)) {
+            total += levels_[static_cast<size_t>(i)].total_quantity();
+            if (max_levels > 0 && ++count >= max_levels) break;
+        }
+        return total;
+    }
+
+    [[nodiscard]] std::vector<BookLevel> get_bids(size_t max_levels = 10) const {
+        std::vector<BookLevel> result;
+        result.reserve(max_levels);
+        for (long i = best_bid_idx_; i >= 0 && result.size() < max_levels; i = next_occ_le(i - 1)) {
+            const PriceLevel& l = levels_[static_cast<size_t>(i)];
+            result.push_back({l.price(), l.total_quantity(), l.order_count()});
+        }
+        return result;
+    }
+
+    [[nodiscard]] std::vector<BookLevel> get_asks(size_t max_levels = 10) const {
+        std::vector<BookLevel> result;
+        result.reserve(max_levels);
+        const long n = static_cast<long>(levels_.size());
+        for (long i = best_ask_idx_; i < n && result.size() < max_levels; i = next_occ_ge(i + 1)) {
+            const PriceLevel& l = levels_[static_cast<size_t>(i)];
+            result.push_back({l.price(), l.total_quantity(), l.order_count()});
+        }
+        return result;
+    }
+
     // ── Statistics ──
     [[nodiscard]] uint64_t trade_count()      const { return trade_count_; }
     [[nodiscard]] uint64_t total_volume()     const { return total_volume_; }
@@ -179,6 +320,130 @@ public:
     [[nodiscard]] size_t   active_orders()    const { return order_index_.size(); }
     [[nodiscard]] const std::string& symbol() const { return symbol_; }
     [[nodiscard]] Price    last_trade_price() const { return last_trade_price_; }
+    [[nodiscard]] uint64_t stop_triggered_count() const { return stop_triggered_count_; }
+    [[nodiscard]] size_t   parked_stop_count()    const {
+        return stops_.size();
+    }
+    [[nodiscard]] ArenaStats arena_stats() const { return order_arena_.stats(); }
+    [[nodiscard]] Price    min_price()        const { return min_price_; }
+    [[nodiscard]] Price    max_price()        const { return max_price_; }
+    [[nodiscard]] uint64_t recenter_count()   const { return recenter_count_; }
+
+    // ═══════════════════════════════════════════
+    // Warm restart (same contract as OrderBook's: no matching, no events)
+    // ═══════════════════════════════════════════
+
+    /// Visit resting orders: bids best→worst, then asks best→worst, FIFO within a level.
+    template <typename F>
+    void for_each_resting(F&& fn) const {
+        for (long i = best_bid_idx_; i >= 0; i = next_occ_le(i - 1)) {
+            for (const Order& o : levels_[static_cast<size_t>(i)]) fn(o);
+        }
+        const long n = static_cast<long>(levels_.size());
+        for (long i = best_ask_idx_; i < n; i = next_occ_ge(i + 1)) {
+            for (const Order& o : levels_[static_cast<size_t>(i)]) fn(o);
+        }
+    }
+
+    template <typename F>
+    void for_each_parked_stop(F&& fn) const { stops_.for_each(fn); }
+
+    [[nodiscard]] BookCounters counters() const {
+        return {next_sequence_, trade_count_, total_volume_, last_trade_price_, stop_triggered_count_};
+    }
+
+    void restore_counters(const BookCounters& c) {
+        next_sequence_        = c.next_sequence;
+        trade_count_          = c.trade_count;
+        total_volume_         = c.total_volume;
+        last_trade_price_     = c.last_trade_price;
+        stop_triggered_count_ = c.stop_triggered_count;
+    }
+
+    void reserve_orders(size_t n) {
+        order_index_.reserve(n);
+        order_arena_.reserve(n);
+    }
+
+    [[nodiscard]] const Order* find_order(OrderId id) const { return order_index_.find(id); }
+    void prefetch_restore(OrderId id) const noexcept { order_index_.prefetch(id); }
+
+    /// Rest (re-centering if needed) or park a copy of `snap`; see OrderBook.
+    /// A resting order beyond MAX_BAND's reach (only a map-book source can
+    /// hold one) is not restored, and nullptr is returned.
+    Order* restore_order(const Order& snap) {
+        const bool stop = snap.type == OrderType::Stop || snap.type == OrderType::StopLimit;
+        if (!stop && !can_rest_at(snap.price)) return nullptr;
+
+        Order* order = order_arena_.allocate();
+        new (order) Order(snap);
+        order->prev = order->next = nullptr;
+        if (order->sequence == 0) order->sequence = next_sequence_++;
+
+        order_index_.insert(order->id, order);
+        if (stop) {
+            stops_.park(order);
+        } else {
+            rest_order(order);
+        }
+        return order;
+    }
+
+    Order* restore_amend(const Order& snap) {
+        Order* order = order_index_.find(snap.id);
+        if (!order) return restore_order(snap);
+
+        const bool stop = order->type == OrderType::Stop || order->type == OrderType::StopLimit;
+        const bool keeps_place = order->side == snap.side && order->type == snap.type
+                              && (stop ? order->stop_price == snap.stop_price
+                                       : order->price == snap.price && snap.leaves_qty <= order->leaves_qty);
+        if (!keeps_place) {
+            restore_remove(snap.id);
+            return restore_order(snap);
+        }
+        if (!stop) {
+            levels_[idx(order->price)].reduce_quantity(order->leaves_qty - snap.leaves_qty);
+        }
+        order->price       = snap.price;
+        order->quantity    = snap.quantity;
+        order->filled_qty  = snap.filled_qty;
+        order->leaves_qty  = snap.leaves_qty;
+        order->status      = snap.status;
+        order->last_update = snap.last_update;
+        return order;
+    }
+
+    bool restore_remove(OrderId id) {
+        Order* order = order_index_.find(id);
+        if (!order) return false;
+        if (order->type == OrderType::Stop || order->type == OrderType::StopLimit) {
+            unpark_stop_order(order);
+        } else {
+            remove_from_book(order);
+        }
+        order->cancel(order->last_update);
+        order_index_.erase(id);
+        return true;
+    }
+
+    bool restore_fill(OrderId id, Quantity qty, Price price, Timestamp ts) {
+        Order* order = order_index_.find(id);
+        if (!order || qty > order->leaves_qty) return false;
+        if (order->type == OrderType::Stop || order->type == OrderType::StopLimit) return false;
+        if (!in_band(order->price)) return false;
+
+        levels_[idx(order->price)].reduce_quantity(qty);
+        order->fill(qty, ts);
+        if (order->is_filled()) {
+            remove_from_book(order);
+            order_index_.erase(id);
+        }
+        ++next_sequence_;
+        ++trade_count_;
+        total_volume_    += qty;
+        last_trade_price_ = price;
+        return true;
+    }
 
     [[nodiscard]] bool check_no_crossed_book() const {
         auto bb = best_bid();
@@ -187,7 +452,110 @@ public:
         return *bb < *ba;
     }
 
+    [[nodiscard]] bool check_fifo_invariant() const {
+        for (long i = next_occ_ge(0); i < static_cast<long>(levels_.size()); i = next_occ_ge(i + 1)) {
+            SeqNum prev_seq = 0;
+            for (const auto& order : levels_[static_cast<size_t>(i)]) {
+                if (order.sequence <= prev_seq) return false;
+                prev_seq = order.sequence;
+            }
+        }
+        return true;
+    }
+
 private:
+    void prefetch_new(const NewOrderRequest& req) const noexcept {
+        order_index_.prefetch(req.id);
+        if (req.type != OrderType::Market && in_band(req.price)) {
+            __builtin_prefetch(&levels_[idx(req.price)]);
+        }
+    }
+
+    // add_order body; the caller has already set ts_ for this event.
+    Order* process_new(const NewOrderRequest& req) {
+        Order* order = order_arena_.allocate();
+        new (order) Order{};
+
+        order->id         = req.id;
+        order->sequence   = next_sequence_++;
+        order->side       = req.side;
+        order->type       = req.type;
+        order->tif        = req.tif;
+        order->price      = req.price;
+        order->stop_price = req.stop_price;
+        order->quantity   = req.quantity;
+        order->leaves_qty = req.quantity;
+        order->filled_qty = 0;
+        order->entry_time = ts_;
+        order->last_update = ts_;
+        order->status     = OrderStatus::New;
+        std::memcpy(order->symbol, req.symbol, sizeof(order->symbol));
+
+        // A limit the band can't grow to reach never matches or rests.
+        if (order->type == OrderType::Limit && !can_rest_at(order->price)) [[unlikely]] {
+            order->status     = OrderStatus::Rejected;
+            order->leaves_qty = 0;
+            notify_order(*order);
+            return order;
+        }
+
+        order_index_.insert(order->id, order);
+
+        // Stops park until the last print crosses the trigger (see OrderBook).
+        if (order->type == OrderType::Stop || order->type == OrderType::StopLimit) {
+            park_stop_order(order);
+            notify_order(*order);
+            check_stop_triggers();
+            return order;
+        }
+
+        // FOK: only execute if the whole quantity can be filled right now.
+        if (order->type == OrderType::FOK && !can_fill_completely(order)) {
+            order->cancel(ts_);
+            order_index_.erase(order->id);
+            notify_order(*order);
+            check_stop_triggers();
+            return order;
+        }
+
+        match(order);
+
+        if (order->leaves_qty > 0) {
+            if (order->type == OrderType::Limit) {
+                const BookLevel lvl = rest_order(order);
+                notify_order(*order);
+                notify_level(order->side, lvl);
+            } else {
+                // Market / IOC / FOK remainder cancels.
+                order->cancel(ts_);
+                order_index_.erase(order->id);
+                notify_order(*order);
+            }
+        } else {
+            order_index_.erase(order->id);   // fully filled on entry
+        }
+
+        check_stop_triggers();
+        return order;
+    }
+
+    bool process_cancel(OrderId id) {
+        Order* order = order_index_.find(id);
+        if (!order || !order->is_active()) return false;
+
+        std::optional<BookLevel> left;
+        if (order->type == OrderType::Stop || order->type == OrderType::StopLimit) {
+            unpark_stop_order(order);
+        } else {
+            left = remove_from_book(order);
+        }
+        order->cancel(ts_);
+        order_index_.erase(id);
+        notify_order(*order);
+        if (left) notify_level(order->side, *left);
+        return true;
+    }
+
     // ── Index helpers ──
     [[nodiscard]] size_t idx(Price p)      const { return static_cast<size_t>(p - min_price_); }
     [[nodiscard]] Price  price_at(size_t i) const { return min_price_ + static_cast<Price>(i); }
@@ -229,18 +597,93 @@ private:
         return -1;
     }
 
+    // ── Band re-centering ──
+
+    // Lowest / highest price a band built around `p` and every occupied
+    // level has to cover.
+    [[nodiscard]] std::pair<Price, Price> span_with(Price p) const {
+        const long n = static_cast<long>(levels_.size());
+        Price lo = p, hi = p;
+        const long lo_occ = next_occ_ge(0);
+        const long hi_occ = next_occ_le(n - 1);
+        if (lo_occ < n)   lo = std::min(lo, price_at(static_cast<size_t>(lo_occ)));
+        if (hi_occ >= 0)  hi = std::max(hi, price_at(static_cast<size_t>(hi_occ)));
+        return {lo, hi};
+    }
+
+    // `p` is in the band, or recenter(p) fits in MAX_BAND levels (and clear
+    // of the ends of Price, so the band's bounds can't overflow). Matching
+    // only empties levels, so this still holds once an order has matched.
+    [[nodiscard]] bool can_rest_at(Price p) const {
+        if (in_band(p)) [[likely]] return true;
+        constexpr Price kEdge = static_cast<Price>(MAX_BAND);
+        if (p < std::numeric_limits<Price>::min() + kEdge
+            || p > std::numeric_limits<Price>::max() - kEdge) return false;
+        const auto [lo, hi] = span_with(p);
+        return static_cast<uint64_t>(hi) - static_cast<uint64_t>(lo) + 1 <= MAX_BAND / 2;
+    }
+
+    // Rebuild the level array so `p` is addressable; the caller has checked
+    // can_rest_at(p). Occupied levels keep their PriceLevel (head/tail/
+    // aggregates) — orders link to each other, not to the level, so moving
+    // the level object is safe.
+    void recenter(Price p) {
+        const long n = static_cast<long>(levels_.size());
+        const long lo_occ = next_occ_ge(0);
+        const auto [lo, hi] = span_with(p);
+
+        const Price span = hi - lo + 1;
+        Price width = static_cast<Price>(n);
+        while (width < 2 * span) width *= 2;          // keep half a band of headroom
+        width = std::max(static_cast<Price>(n), std::min(width, static_cast<Price>(MAX_BAND)));
+
+        const Price new_min = lo + (hi - lo) / 2 - width / 2;
+        std::vector<PriceLevel> levels;
+        levels.reserve(static_cast<size_t>(width));
+        for (Price i = 0; i < width; ++i) levels.emplace_back(new_min + i);
+
+        std::vector<uint64_t> occ((static_cast<size_t>(width) + 63) / 64, 0ULL);
+        for (long i = lo_occ; i < n; i = next_occ_ge(i + 1)) {
+            const size_t j = static_cast<size_t>(price_at(static_cast<size_t>(i)) - new_min);
+            levels[j] = levels_[static_cast<size_t>(i)];
+            occ[j >> 6] |= (1ULL << (j & 63));
+        }
+
+        const auto remap = [&](long i) {
+            return static_cast<long>(price_at(static_cast<size_t>(i)) - new_min);
+        };
+        best_bid_idx_ = (best_bid_idx_ >= 0) ? remap(best_bid_idx_) : -1;
+        best_ask_idx_ = (best_ask_idx_ < n)  ? remap(best_ask_idx_) : static_cast<long>(width);
+
+        levels_.swap(levels);
+        occ_.swap(occ);
+        min_price_ = new_min;
+        max_price_ = new_min + width - 1;
+        ++recenter_count_;
+    }
+
     // ── Matching ──
     void match(Order* incoming) {
         if (incoming->is_buy()) match_buy(incoming);
         else                    match_sell(incoming);
     }
 
-    void match_buy(Order* incoming) {
-        const bool is_market =
-            incoming->type == OrderType::Market || incoming->price == PRICE_MARKET;
-        long limit_idx = is_market ? static_cast<long>(levels_.size()) - 1
-                                   : static_cast<long>(idx(std::min(incoming->price, max_price_)));
+    // Highest (buy) / lowest (sell) level index `incoming` may trade at; may
+    // fall outside [0, n) when the limit is beyond the band, which the scan
+    // loops treat as "everything" / "nothing" respectively.
+    [[nodiscard]] long buy_limit_idx(const Order* o) const {
+        const bool is_market = o->type == OrderType::Market || o->price == PRICE_MARKET;
+        if (is_market || o->price > max_price_) return static_cast<long>(levels_.size()) - 1;
+        return static_cast<long>(o->price - min_price_);
+    }
+    [[nodiscard]] long sell_limit_idx(const Order* o) const {
+        const bool is_market = o->type == OrderType::Market || o->price == PRICE_MARKET;
+        if (is_market || o->price < min_price_) return 0;
+        return static_cast<long>(o->price - min_price_);
+    }
 
+    void match_buy(Order* incoming) {
+        const long limit_idx = buy_limit_idx(incoming);
         const long n = static_cast<long>(levels_.size());
         while (incoming->leaves_qty > 0 && best_ask_idx_ < n && best_ask_idx_ <= limit_idx) {
             PriceLevel& level = levels_[static_cast<size_t>(best_ask_idx_)];
@@ -254,11 +697,7 @@ private:
     }
 
     void match_sell(Order* incoming) {
-        const bool is_market =
-            incoming->type == OrderType::Market || incoming->price == PRICE_MARKET;
-        long limit_idx = is_market ? 0
-                                   : static_cast<long>(idx(std::max(incoming->price, min_price_)));
-
+        const long limit_idx = sell_limit_idx(incoming);
         while (incoming->leaves_qty > 0 && best_bid_idx_ >= 0 && best_bid_idx_ >= limit_idx) {
             PriceLevel& level = levels_[static_cast<size_t>(best_bid_idx_)];
             fill_against_level(incoming, level);
@@ -308,26 +747,23 @@ private:
                 level.pop_front();
                 order_index_.erase(resting->id);
             }
+            notify_level(resting->side, aggregate(level));
         }
     }
 
     bool can_fill_completely(const Order* order) const {
         Quantity needed = order->leaves_qty;
-        const bool is_market =
-            order->type == OrderType::Market || order->price == PRICE_MARKET;
 
         if (order->is_buy()) {
-            long limit_idx = is_market ? static_cast<long>(levels_.size()) - 1
-                                       : static_cast<long>(idx(std::min(order->price, max_price_)));
+            const long limit_idx = buy_limit_idx(order);
             const long n = static_cast<long>(levels_.size());
-            for (long i = best_ask_idx_; i < n && i <= limit_idx; ++i) {
+            for (long i = best_ask_idx_; i < n && i <= limit_idx; i = next_occ_ge(i + 1)) {
                 needed -= std::min(needed, levels_[static_cast<size_t>(i)].total_quantity());
                 if (needed == 0) return true;
             }
         } else {
-            long limit_idx = is_market ? 0
-                                       : static_cast<long>(idx(std::max(order->price, min_price_)));
-            for (long i = best_bid_idx_; i >= 0 && i >= limit_idx; --i) {
+            const long limit_idx = sell_limit_idx(order);
+            for (long i = best_bid_idx_; i >= 0 && i >= limit_idx; i = next_occ_le(i - 1)) {
                 needed -= std::min(needed, levels_[static_cast<size_t>(i)].total_quantity());
                 if (needed == 0) return true;
             }
@@ -335,8 +771,68 @@ private:
         return needed == 0;
     }
 
+    // ── Stop-order parking (same trigger rules as OrderBook) ──
+    void park_stop_order(Order* order) {
+        order->status = OrderStatus::New;
+        stops_.park(order);
+    }
+
+    void unpark_stop_order(Order* order) { stops_.unpark(order); }
+
+    void check_stop_triggers() {
+        if (in_stop_check_) return;
+        // O(1): the nearest trigger on each side is cached, so a print that
+        // crosses neither costs two compares.
+        if (!stops_.triggered(last_trade_price_)) return;
+        in_stop_check_ = true;
+
+        while (true) {
+            stop_scratch_.clear();
+            stops_.collect(last_trade_price_, stop_scratch_);
+            if (stop_scratch_.empty()) break;
+
+            for (Order* o : stop_scratch_) {
+                if (o->type == OrderType::Stop) {
+                    o->type  = OrderType::Market;
+                    o->price = PRICE_MARKET;
+                    o->tif   = TimeInForce::IOC;
+                } else { // StopLimit
+                    o->type = OrderType::Limit;
+                    o->tif  = TimeInForce::GTC;
+                }
+                o->sequence    = next_sequence_++;
+                o->last_update = ts_;
+                ++stop_triggered_count_;
+
+                match(o);
+
+                if (o->leaves_qty > 0) {
+                    // A StopLimit whose limit the band can't reach cancels
+                    // its remainder like a Stop's.
+                    if (o->type == OrderType::Limit && can_rest_at(o->price)) {
+                        const BookLevel lvl = rest_order(o);
+                        notify_order(*o);
+                        notify_level(o->side, lvl);
+                    } else {
+                        o->cancel(ts_);
+                        order_index_.erase(o->id);
+                        notify_order(*o);
+                    }
+                } else {
+                    order_index_.erase(o->id);
+                    notify_order(*o);
+                }
+            }
+        }
+
+        in_stop_check_ = false;
+    }
+
     // ── Book management ──
-    void rest_order(Order* order) {
+    // Both return the level's aggregate afterwards, for notify_level.
+    BookLevel rest_order(Order* order) {
+        if (!in_band(order->price)) [[unlikely]] recenter(order->price);
+
         const size_t i = idx(order->price);
         const bool was_empty = levels_[i].empty();
         levels_[i].push_back(order);
@@ -346,10 +842,11 @@ private:
         } else {
             if (static_cast<long>(i) < best_ask_idx_) best_ask_idx_ = static_cast<long>(i);
         }
+        return aggregate(levels_[i]);
     }
 
-    void remove_from_book(Order* order) {
-        if (!in_band(order->price)) return;
+    BookLevel remove_from_book(Order* order) {
+        if (!in_band(order->price)) return {order->price, 0, 0};
         const size_t i = idx(order->price);
         levels_[i].remove(order);
         if (levels_[i].empty()) {
@@ -360,11 +857,27 @@ private:
                 best_ask_idx_ = next_occ_ge(best_ask_idx_ + 1);
             }
         }
+        return aggregate(levels_[i]);
+    }
+
+    static BookLevel aggregate(const PriceLevel& level) {
+        return {level.price(), level.total_quantity(), level.order_count()};
     }
 
     // ── Notifications ──
-    void notify_trade(const Trade& t) { for (auto& cb : trade_listeners_) cb(t); }
-    void notify_order(const Order& o) { for (auto& cb : order_listeners_) cb(o); }
+    void notify_trade(const Trade& t) {
+        probe::fill();
+        sink_.on_trade(*this, t);
+        for (auto& cb : trade_listeners_) cb(t);
+    }
+    void notify_order(const Order& o) {
+        sink_.on_order(*this, o);
+        for (auto& cb : order_listeners_) cb(o);
+    }
+    void notify_level(Side side, const BookLevel& l) {
+        if constexpr (LevelSink<Sink, BasicArrayOrderBook>) sink_.on_level(*this, side, l);
+        for (auto& cb : level_listeners_) cb(side, l);
+    }
 
     // ── Members ──
     std::string             symbol_;
@@ -376,7 +889,7 @@ private:
     long best_bid_idx_ = -1;                  // highest occupied bid level, or -1
     long best_ask_idx_ = 0;                   // lowest occupied ask level, or levels_.size()
 
-    std::unordered_map<OrderId, Order*> order_index_;
+    OrderIndex                          order_index_;
     ArenaAllocator<Order>               order_arena_;
 
     Timestamp ts_{};   // wall-clock captured once per inbound event (hot path)
@@ -385,9 +898,19 @@ private:
     uint64_t trade_count_       = 0;
     uint64_t total_volume_      = 0;
     Price    last_trade_price_  = 0;
+    uint64_t stop_triggered_count_ = 0;
+    uint64_t recenter_count_    = 0;
+    bool     in_stop_check_     = false;
+
+    StopBook            stops_;          // parked Stop / StopLimit orders
+    std::vector<Order*> stop_scratch_;   // released stops, reused across passes
 
+    [[no_unique_address]] Sink sink_{};
     std::vector<TradeCallback> trade_listeners_;
     std::vector<OrderCallback> order_listeners_;
+    std::vector<LevelCallback> level_listeners_;
 };
 
+using ArrayOrderBook = BasicArrayOrderBook<>;
+
 } // namespace micro_exchange::core
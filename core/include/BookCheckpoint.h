@@ -0,0 +1,231 @@
+#pragma once
+
+#include "Order.h"
+#include "BookConcept.h"
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace micro_exchange::core {
+
+/**
+ * Binary book checkpoint — fast warm restart without re-running matching.
+ *
+ * File layout (native endianness; a checkpoint is read back on the same
+ * kind of box that wrote it):
+ *
+ *   CheckpointHeader                 magic, version, record size, symbol,
+ *                                    BookCounters, feed sequence, counts,
+ *                                    word-wise FNV-1a checksum of the records
+ *   CheckpointOrder × resting_count  bids best→worst, then asks best→worst,
+ *                                    FIFO within each level
+ *   CheckpointOrder × stop_count     parked stops, buys then sells, each in
+ *                                    release order
+ *
+ * Records are fixed-size and 8-byte aligned, so `load_checkpoint` mmaps the
+ * file and walks them in place. Loading reserves the index and arena once
+ * and appends every order straight into its level (or the stop book) with
+ * its original sequence — no matching, no stop checks, no events — so a
+ * restored book continues exactly where the checkpointed one stopped.
+ *
+ * `feed_sequence` is the first FeedPublisher sequence the checkpoint does
+ * NOT reflect (FeedPublisher::sequence() when it was taken); FeedRecovery.h
+ * applies the feed tail from there on.
+ */
+
+inline constexpr char     CHECKPOINT_MAGIC[8]  = {'M', 'X', 'C', 'K', 'P', 'T', '\0', '\0'};
+inline constexpr uint32_t CHECKPOINT_VERSION   = 1;
+
+struct CheckpointHeader {
+    char         magic[8]      = {};
+    uint32_t     version       = CHECKPOINT_VERSION;
+    uint32_t     record_bytes  = 0;   // sizeof(CheckpointOrder) at write time
+    char         symbol[16]    = {};
+    BookCounters counters      = {};
+    uint64_t     feed_sequence = 0;
+    uint64_t     resting_count = 0;
+    uint64_t     stop_count    = 0;
+    uint64_t     checksum      = 0;
+};
+
+struct CheckpointOrder {
+    OrderId     id          = 0;
+    SeqNum      sequence    = 0;
+    Price       price       = 0;
+    Price       stop_price  = 0;
+    Quantity    quantity    = 0;
+    Quantity    filled_qty  = 0;
+    Quantity    leaves_qty  = 0;
+    uint64_t    entry_ns    = 0;
+    uint64_t    update_ns   = 0;
+    Side        side        = Side::Buy;
+    OrderType   type        = OrderType::Limit;
+    TimeInForce tif         = TimeInForce::GTC;
+    OrderStatus status      = OrderStatus::New;
+    uint32_t    reserved    = 0;
+};
+static_assert(sizeof(CheckpointOrder) == 80, "checkpoint record layout is part of the format");
+static_assert(sizeof(CheckpointHeader) % alignof(CheckpointOrder) == 0,
+    "records must stay aligned when read in place from the mapping");
+
+/// A book that can be checkpointed and bulk-restored (both books model it).
+template <typename B>
+concept RestorableBook = OrderBookLike<B> && requires(B book, const B cbook, const Order& o,
+                                                      const BookCounters& c, OrderId id, size_t n,
+                                                      Quantity q, Price px, Timestamp ts) {
+    cbook.for_each_resting([](const Order&) {});
+    cbook.for_each_parked_stop([](const Order&) {});
+    { cbook.counters() }       -> std::same_as<BookCounters>;
+    book.restore_counters(c);
+    book.reserve_orders(n);
+    cbook.prefetch_restore(id);
+    { cbook.find_order(id) }   -> std::same_as<const Order*>;
+    { book.restore_order(o) }  -> std::same_as<Order*>;
+    { book.restore_amend(o) }  -> std::same_as<Order*>;
+    { book.restore_remove(id) } -> std::same_as<bool>;
+    { book.restore_fill(id, q, px, ts) } -> std::same_as<bool>;
+};
+
+namespace detail {
+
+// FNV-1a over 64-bit words rather than bytes: records are word-sized
+// multiples, and a byte loop would cost more than the load it protects.
+inline uint64_t checksum_words(const void* data, size_t len) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    const auto* p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i + 8 <= len; i += 8) {
+        uint64_t w;
+        std::memcpy(&w, p + i, sizeof(w));
+        h = (h ^ w) * 0x100000001b3ULL;
+    }
+    return h ^ (h >> 29);
+}
+
+inline CheckpointOrder to_record(const Order& o) {
+    CheckpointOrder r;
+    r.id         = o.id;
+    r.sequence   = o.sequence;
+    r.price      = o.price;
+    r.stop_price = o.stop_price;
+    r.quantity   = o.quantity;
+    r.filled_qty = o.filled_qty;
+    r.leaves_qty = o.leaves_qty;
+    r.entry_ns   = timestamp_ns(o.entry_time);
+    r.update_ns  = timestamp_ns(o.last_update);
+    r.side       = o.side;
+    r.type       = o.type;
+    r.tif        = o.tif;
+    r.status     = o.status;
+    return r;
+}
+
+inline Order from_record(const CheckpointOrder& r, const char (&symbol)[16]) {
+    Order o;
+    o.id          = r.id;
+    o.sequence    = r.sequence;
+    o.side        = r.side;
+    o.type        = r.type;
+    o.tif         = r.tif;
+    o.price       = r.price;
+    o.stop_price  = r.stop_price;
+    o.quantity    = r.quantity;
+    o.filled_qty  = r.filled_qty;
+    o.leaves_qty  = r.leaves_qty;
+    o.entry_time  = Timestamp(std::chrono::duration_cast<Timestamp::duration>(std::chrono::nanoseconds(r.entry_ns)));
+    o.last_update = Timestamp(std::chrono::duration_cast<Timestamp::duration>(std::chrono::nanoseconds(r.update_ns)));
+    o.status      = r.status;
+    std::memcpy(o.symbol, symbol, sizeof(o.symbol));
+    return o;
+}
+
+inline void copy_symbol(char (&dst)[16], const std::string& sym) {
+    std::memset(dst, 0, sizeof(dst));
+    std::memcpy(dst, sym.data(), std::min(sym.size(), sizeof(dst)));
+}
+
+} // namespace detail
+
+/**
+ * Write `book` to `path`. The file is written beside the target and renamed
+ * over it, so a crash mid-write never leaves a torn checkpoint behind.
+ * Returns false on any I/O failure.
+ */
+template <RestorableBook Book>
+bool write_checkpoint(const Book& book, const std::string& path, SeqNum feed_sequence = 0) {
+    std::vector<CheckpointOrder> records;
+    records.reserve(book.active_orders());
+    book.for_each_resting([&](const Order& o) { records.push_back(detail::to_record(o)); });
+    const size_t resting = records.size();
+    book.for_each_parked_stop([&](const Order& o) { records.push_back(detail::to_record(o)); });
+
+    CheckpointHeader h;
+    std::memcpy(h.magic, CHECKPOINT_MAGIC, sizeof(h.magic));
+    h.record_bytes  = sizeof(CheckpointOrder);
+    detail::copy_symbol(h.symbol, book.symbol());
+    h.counters      = book.counters();
+    h.feed_sequence = feed_sequence;
+    h.resting_count = resting;
+    h.stop_count    = records.size() - resting;
+    h.checksum      = detail::checksum_words(records.data(), records.size() * sizeof(CheckpointOrder));
+
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream ofs(tmp, std::ios::binary | std::ios::trunc);
+        ofs.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        ofs.write(reinterpret_cast<const char*>(records.data()),
+                  static_cast<std::streamsize>(records.size() * sizeof(CheckpointOrder)));
+        if (!ofs.flush()) return false;
+    }
+    return std::rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+/**
+ * Restore a checkpoint into `book`, which must be empty and constructed for
+ * the same symbol. Returns the header (counters, feed_sequence, counts) or
+ * nullopt if the file is missing, truncated, from another version or
+ * symbol, or fails its checksum — in which case the book is left untouched.
+ */
+template <RestorableBook Book>
+std::optional<CheckpointHeader> load_checkpoint(Book& book, const std::string& path) {
+    MappedFile file(path);
+    if (!file.ok() || file.size() < sizeof(CheckpointHeader)) return std::nullopt;
+
+    CheckpointHeader h;
+    std::memcpy(&h, file.data(), sizeof(h));
+    if (std::memcmp(h.magic, CHECKPOINT_MAGIC, sizeof(h.magic)) != 0) return std::nullopt;
+    if (h.version != CHECKPOINT_VERSION || h.record_bytes != sizeof(CheckpointOrder)) return std::nullopt;
+
+    const uint64_t count = h.resting_count + h.stop_count;
+    if (count > (file.size() - sizeof(h)) / sizeof(CheckpointOrder)) return std::nullopt;
+    if (file.size() != sizeof(h) + count * sizeof(CheckpointOrder)) return std::nullopt;
+
+    char sym[16];
+    detail::copy_symbol(sym, book.symbol());
+    if (std::memcmp(sym, h.symbol, sizeof(sym)) != 0 || book.active_orders() != 0) return std::nullopt;
+
+    // Page-aligned mapping + 8-byte-multiple header: records are aligned in place.
+    const auto* records = reinterpret_cast<const CheckpointOrder*>(file.data() + sizeof(h));
+    if (detail::checksum_words(records, count * sizeof(CheckpointOrder)) != h.checksum) return std::nullopt;
+
+    // Index inserts are the one random access per order; prefetch ahead
+    // the way submit_batch does.
+    constexpr uint64_t AHEAD = 8;
+    book.reserve_orders(count);
+    for (uint64_t i = 0; i < count; ++i) {
+        if (i + AHEAD < count) book.prefetch_restore(records[i + AHEAD].id);
+        book.restore_order(detail::from_record(records[i], h.symbol));
+    }
+    book.restore_counters(h.counters);
+    return h;
+}
+
+} // namespace micro_exchange::core
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Order.h"
+#include "ArenaAllocator.h"
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace micro_exchange::core {
+
+/**
+ * BookLevel — aggregated view of one price level (price, total leaves, count).
+ * Shared by every book implementation so depth snapshots are interchangeable.
+ */
+struct BookLevel {
+    Price    price;
+    Quantity quantity;
+    uint32_t order_count;
+};
+
+/**
+ * BookCounters — the book-wide sequence and trade counters a checkpoint has
+ * to carry so a restored book numbers its next event where the old one
+ * stopped (see BookCheckpoint.h).
+ */
+struct BookCounters {
+    SeqNum   next_sequence        = 1;
+    uint64_t trade_count          = 0;
+    uint64_t total_volume         = 0;
+    Price    last_trade_price     = 0;
+    uint64_t stop_triggered_count = 0;
+};
+
+/**
+ * OrderBookLike — the contract a book must satisfy to sit behind the
+ * MatchingEngine, the FeedPublisher, the Simulator and the OrderGateway.
+ *
+ * Both `OrderBook` (std::map levels) and `ArrayOrderBook` (tick-indexed array
+ * + bitmap) model it, so the engine can be instantiated on either without any
+ * loss of order types: Limit / Market / IOC / FOK / Stop / StopLimit, cancel
+ * and amend all go through the same entry points.
+ */
+template <typename B>
+concept OrderBookLike = requires(B book, const B cbook,
+                                 const NewOrderRequest& nreq,
+                                 const AmendRequest& areq,
+                                 OrderId id, size_t n,
+                                 std::span<const NewOrderRequest> nbatch,
+                                 std::span<const OrderId> cbatch,
+                                 std::function<void(const Trade&)> tcb,
+                                 std::function<void(const Order&)> ocb,
+                                 std::function<void(Side, const BookLevel&)> lcb) {
+    // ── Order entry ──
+    { book.add_order(nreq) }   -> std::same_as<Order*>;
+    { book.cancel_order(id) }  -> std::same_as<bool>;
+    { book.amend_order(areq) } -> std::same_as<bool>;
+    { book.submit_batch(nbatch) } -> std::same_as<size_t>;
+    { book.cancel_batch(cbatch) } -> std::same_as<size_t>;
+
+    // ── Event fan-out ──
+    book.add_trade_listener(tcb);
+    book.add_order_listener(ocb);
+    book.add_level_listener(lcb);
+
+    // ── Top of book / depth ──
+    { cbook.best_bid() }  -> std::same_as<std::optional<Price>>;
+    { cbook.best_ask() }  -> std::same_as<std::optional<Price>>;
+    { cbook.midprice() }  -> std::same_as<std::optional<Price>>;
+    { cbook.spread() }    -> std::same_as<std::optional<Price>>;
+    { cbook.bid_depth(n) } -> std::same_as<Quantity>;
+    { cbook.ask_depth(n) } -> std::same_as<Quantity>;
+    { cbook.get_bids(n) } -> std::same_as<std::vector<BookLevel>>;
+    { cbook.get_asks(n) } -> std::same_as<std::vector<BookLevel>>;
+
+    // ── Statistics ──
+    { cbook.active_orders() } -> std::convertible_to<size_t>;
+    { cbook.symbol() }        -> std::convertible_to<const std::string&>;
+    { cbook.arena_stats() }   -> std::same_as<ArenaStats>;
+};
+
+} // namespace micro_exchange::core
@@ -0,0 +1,163 @@
+#pragma once
+
+// ─────────────────────────────────────────────────────────────────────────
+// Clock — EventClock, the timestamp source behind now().
+//
+// Every event timestamp (order entry, fills, cancels, trade prints, feed
+// messages, latency probes) comes from EventClock::now(). By default that is
+// TscClock: one rdtscp (x86-64) or cntvct_el0 (AArch64) read scaled to
+// nanoseconds, a few ns against the ~20 ns of a steady_clock call that
+// falls into the vDSO.
+//
+// TscClock calibrates once, on first use: it samples the counter and
+// steady_clock ~10 ms apart and derives a fixed-point ns-per-tick factor,
+// anchored so TscClock and steady_clock share an epoch. Timestamps stay
+// comparable with steady_clock ones, and checkpoints taken under either
+// restore under the other. Over a long run the two drift apart by the
+// counter's frequency error (ppm), which is fine for event times and
+// latency deltas.
+//
+// TscClock falls back to steady_clock when the counter can't be trusted:
+// no invariant TSC (CPUID 0x80000007 EDX[8]), a calibration that comes
+// out of range, any other architecture, or MICRO_EXCHANGE_CLOCK=steady in
+// the environment. Building with MICRO_EXCHANGE_TSC_CLOCK=0 makes
+// EventClock steady_clock outright.
+// ─────────────────────────────────────────────────────────────────────────
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+
+#ifndef MICRO_EXCHANGE_TSC_CLOCK
+#define MICRO_EXCHANGE_TSC_CLOCK 1
+#endif
+
+namespace micro_exchange::core {
+
+class TscClock {
+public:
+    using rep        = int64_t;
+    using period     = std::nano;
+    using duration   = std::chrono::nanoseconds;
+    using time_point = std::chrono::time_point<TscClock>;
+    static constexpr bool is_steady = true;
+
+    struct Calibration {
+        bool     tsc     = false;   // false: every read goes to steady_clock
+        uint64_t tick0   = 0;       // counter at the anchor
+        int64_t  ns0     = 0;       // steady_clock ns at the anchor
+        uint64_t mult    = 0;       // ns per tick, 32.32 fixed point
+        double   hz      = 0;       // measured counter frequency
+
+        [[nodiscard]] int64_t to_ns(uint64_t tick) const noexcept {
+            __extension__ typedef __int128 wide;
+            const auto delta = static_cast<wide>(static_cast<int64_t>(tick - tick0));
+            return ns0 + static_cast<int64_t>((delta * static_cast<wide>(mult)) >> 32);
+        }
+    };
+
+    static time_point now() noexcept {
+        const Calibration& c = calibration();
+        if (!c.tsc) [[unlikely]] return time_point(duration(steady_ns()));
+        return time_point(duration(c.to_ns(read_counter())));
+    }
+
+    /// The calibration every read uses (computed on the first call).
+    static const Calibration& calibration() noexcept {
+        static const Calibration c = calibrate();
+        return c;
+    }
+
+    [[nodiscard]] static bool uses_tsc() noexcept { return calibration().tsc; }
+    [[nodiscard]] static const char* source() noexcept {
+        if (!uses_tsc()) return "steady_clock";
+#if defined(__x86_64__)
+        return "rdtscp";
+#else
+        return "cntvct_el0";
+#endif
+    }
+
+    /// Raw counter read; 0 where there is no usable counter.
+    static uint64_t read_counter() noexcept {
+#if defined(__x86_64__)
+        unsigned aux;
+        return __rdtscp(&aux);   // waits for earlier instructions, unlike rdtsc
+#elif defined(__aarch64__)
+        uint64_t v;
+        asm volatile("isb; mrs %0, cntvct_el0" : "=r"(v) :: "memory");
+        return v;
+#else
+        return 0;
+#endif
+    }
+
+    /// Does the counter tick at a constant rate through P/C-states?
+    static bool invariant_counter() noexcept {
+#if defined(__x86_64__)
+        unsigned a, b, c, d;
+        if (!__get_cpuid(0x80000000, &a, &b, &c, &d) || a < 0x80000007) return false;
+        __get_cpuid(0x80000007, &a, &b, &c, &d);
+        if (!(d & (1u << 8))) return false;
+        __get_cpuid(0x80000001, &a, &b, &c, &d);
+        return d & (1u << 27);   // rdtscp
+#elif defined(__aarch64__)
+        return true;             // the generic timer is architecturally constant-rate
+#else
+        return false;
+#endif
+    }
+
+private:
+    static int64_t steady_ns() noexcept {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // A counter read bracketed by two steady_clock reads; `ns` is their midpoint.
+    // Retried a few times to keep the tightest bracket (no preemption inside).
+    static void sample(uint64_t& tick, int64_t& ns) noexcept {
+        int64_t best = INT64_MAX;
+        for (int i = 0; i < 5; ++i) {
+            const int64_t  a = steady_ns();
+            const uint64_t t = read_counter();
+            const int64_t  b = steady_ns();
+            if (b - a < best) { best = b - a; tick = t; ns = a + (b - a) / 2; }
+        }
+    }
+
+    static Calibration calibrate() noexcept {
+        Calibration c;
+        const char* env = std::getenv("MICRO_EXCHANGE_CLOCK");
+        if ((env && std::strcmp(env, "steady") == 0) || !invariant_counter()) return c;
+
+        uint64_t t0 = 0, t1 = 0;
+        int64_t  n0 = 0, n1 = 0;
+        sample(t0, n0);
+        while (steady_ns() - n0 < 10'000'000) {}
+        sample(t1, n1);
+        if (t1 <= t0) return c;
+
+        c.hz = static_cast<double>(t1 - t0) * 1e9 / static_cast<double>(n1 - n0);
+        if (c.hz < 1e6 || c.hz > 2e10) return c;
+        c.mult  = (static_cast<uint64_t>(n1 - n0) << 32) / (t1 - t0);
+        c.tick0 = t1;
+        c.ns0   = n1;
+        c.tsc   = true;
+        return c;
+    }
+};
+
+#if MICRO_EXCHANGE_TSC_CLOCK
+using EventClock = TscClock;
+#else
+using EventClock = std::chrono::steady_clock;
+#endif
+
+} // namespace micro_exchange::core
@@ -0,0 +1,280 @@
+#pragma once
+
+#include "Order.h"
+
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+#include <vector>
+
+namespace micro_exchange::core {
+
+/**
+ * Hot/cold split resting-order layout.
+ *
+ * `Order` is one 128-byte record: walking a deep PriceLevel touches two
+ * cache lines per order even though matching only reads the id and leaves
+ * and follows `next`. This layout keeps just that in a 32-byte `HotOrder`
+ * (two per cache line) and moves the rest into a parallel `ColdOrder`
+ * array indexed by the same 32-bit handle:
+ *
+ *   HotOrder  — id, sequence, leaves_qty, prev/next as arena indices
+ *   ColdOrder — side, type, tif, price, stop, original qty, timestamps,
+ *               explicit status, symbol
+ *
+ * A sweep through a level reads and writes only HotOrder. Nothing that
+ * matching changes is duplicated in ColdOrder: filled_qty is
+ * quantity - leaves_qty and status() derives Filled / PartiallyFilled from
+ * the hot leaves, so ColdOrder is written only on entry, amend and cancel.
+ * `last_update` is therefore the last *non-fill* change; fill times are on
+ * the trades.
+ *
+ * CompactOrderStore owns both arrays and a free list; CompactPriceLevel is
+ * PriceLevel's FIFO over handles. This is the alternative layout under
+ * evaluation (`bench_level_layout`); the books still use `Order*`, which
+ * their listener and gateway APIs hand out.
+ */
+
+using OrderHandle = uint32_t;
+inline constexpr OrderHandle HANDLE_NONE = UINT32_MAX;
+
+struct alignas(32) HotOrder {
+    OrderId     id          = 0;
+    SeqNum      sequence    = 0;
+    Quantity    leaves_qty  = 0;
+    OrderHandle prev        = HANDLE_NONE;
+    OrderHandle next        = HANDLE_NONE;   // doubles as the free-list link
+};
+static_assert(sizeof(HotOrder) == 32, "two hot records per cache line");
+
+struct ColdOrder {
+    Side        side        = Side::Buy;
+    OrderType   type        = OrderType::Limit;
+    TimeInForce tif         = TimeInForce::GTC;
+    OrderStatus status      = OrderStatus::New;   // explicit (non-fill) status
+    Price       price       = 0;
+    Price       stop_price  = 0;
+    Quantity    quantity    = 0;
+    Timestamp   entry_time  = {};
+    Timestamp   last_update = {};
+    char        symbol[16]  = {};
+};
+
+class CompactOrderStore {
+public:
+    explicit CompactOrderStore(size_t capacity = 65536) { reserve(capacity); }
+
+    CompactOrderStore(const CompactOrderStore&) = delete;
+    CompactOrderStore& operator=(const CompactOrderStore&) = delete;
+    CompactOrderStore(CompactOrderStore&&) noexcept = default;
+    CompactOrderStore& operator=(CompactOrderStore&&) noexcept = default;
+
+    /// Pre-size both arrays so allocate() never reallocates below `n` live.
+    void reserve(size_t n) {
+        hot_.reserve(n);
+        cold_.reserve(n);
+    }
+
+    /// New resting record for `req`. Handles stay valid until release().
+    [[nodiscard]] OrderHandle allocate(const NewOrderRequest& req, SeqNum seq, Timestamp ts) {
+        OrderHandle h;
+        if (free_head_ != HANDLE_NONE) {
+            h = free_head_;
+            free_head_ = hot_[h].next;
+        } else {
+            assert(hot_.size() < HANDLE_NONE);
+            h = static_cast<OrderHandle>(hot_.size());
+            hot_.emplace_back();
+            cold_.emplace_back();
+        }
+        HotOrder& ho = hot_[h];
+        ho = HotOrder{};
+        ho.id         = req.id;
+        ho.sequence   = seq;
+        ho.leaves_qty = req.quantity;
+
+        ColdOrder& co = cold_[h];
+        co = ColdOrder{};
+        co.side        = req.side;
+        co.type        = req.type;
+        co.tif         = req.tif;
+        co.price       = req.price;
+        co.stop_price  = req.stop_price;
+        co.quantity    = req.quantity;
+        co.entry_time  = ts;
+        co.last_update = ts;
+        std::memcpy(co.symbol, req.symbol, sizeof(co.symbol));
+        ++live_;
+        return h;
+    }
+
+    /// Return `h` to the free list. It must not be in any level.
+    void release(OrderHandle h) noexcept {
+        hot_[h].next = free_head_;
+        free_head_ = h;
+        --live_;
+    }
+
+    [[nodiscard]] HotOrder&        hot(OrderHandle h)        noexcept { return hot_[h]; }
+    [[nodiscard]] const HotOrder&  hot(OrderHandle h)  const noexcept { return hot_[h]; }
+    [[nodiscard]] ColdOrder&       cold(OrderHandle h)       noexcept { return cold_[h]; }
+    [[nodiscard]] const ColdOrder& cold(OrderHandle h) const noexcept { return cold_[h]; }
+
+    [[nodiscard]] OrderStatus status(OrderHandle h) const noexcept {
+        const ColdOrder& c = cold_[h];
+        if (c.status == OrderStatus::Cancelled || c.status == OrderStatus::Rejected) return c.status;
+        const Quantity leaves = hot_[h].leaves_qty;
+        if (leaves == 0)           return OrderStatus::Filled;
+        if (leaves < c.quantity)   return OrderStatus::PartiallyFilled;
+        return c.status;
+    }
+
+    /// Reassemble the full `Order` view (for reports and snapshots).
+    [[nodiscard]] Order materialize(OrderHandle h) const {
+        const HotOrder&  ho = hot_[h];
+        const ColdOrder& c  = cold_[h];
+        Order o;
+        o.id          = ho.id;
+        o.sequence    = ho.sequence;
+        o.side        = c.side;
+        o.type        = c.type;
+        o.tif         = c.tif;
+        o.price       = c.price;
+        o.stop_price  = c.stop_price;
+        o.quantity    = c.quantity;
+        o.leaves_qty  = ho.leaves_qty;
+        o.filled_qty  = c.quantity - ho.leaves_qty;
+        o.entry_time  = c.entry_time;
+        o.last_update = c.last_update;
+        o.status      = status(h);
+        std::memcpy(o.symbol, c.symbol, sizeof(o.symbol));
+        return o;
+    }
+
+    [[nodiscard]] size_t live()     const noexcept { return live_; }
+    [[nodiscard]] size_t capacity() const noexcept { return hot_.capacity(); }
+
+private:
+    std::vector<HotOrder>  hot_;
+    std::vector<ColdOrder> cold_;
+    OrderHandle            free_head_ = HANDLE_NONE;
+    size_t                 live_      = 0;
+};
+
+/**
+ * CompactPriceLevel — PriceLevel's FIFO over OrderHandles.
+ *
+ * Same invariants as PriceLevel (arrival order, total_quantity == sum of
+ * leaves, order_count == list length); every operation takes the store the
+ * handles index into.
+ */
+class CompactPriceLevel {
+public:
+    explicit CompactPriceLevel(Price price = 0) noexcept : price_(price) {}
+
+    // ── Queue operations ──
+
+    void push_back(CompactOrderStore& s, OrderHandle h) noexcept {
+        HotOrder& o = s.hot(h);
+        o.prev = tail_;
+        o.next = HANDLE_NONE;
+        if (tail_ != HANDLE_NONE) s.hot(tail_).next = h;
+        else                      head_ = h;
+        tail_ = h;
+        total_quantity_ += o.leaves_qty;
+        ++order_count_;
+    }
+
+    void remove(CompactOrderStore& s, OrderHandle h) noexcept {
+        HotOrder& o = s.hot(h);
+        if (o.prev != HANDLE_NONE) s.hot(o.prev).next = o.next;
+        else                       head_ = o.next;
+        if (o.next != HANDLE_NONE) s.hot(o.next).prev = o.prev;
+        else                       tail_ = o.prev;
+        o.prev = o.next = HANDLE_NONE;
+        total_quantity_ -= o.leaves_qty;
+        --order_count_;
+    }
+
+    [[nodiscard]] OrderHandle front() const noexcept { return head_; }
+
+    OrderHandle pop_front(CompactOrderStore& s) noexcept {
+        if (head_ == HANDLE_NONE) return HANDLE_NONE;
+        OrderHandle h = head_;
+        HotOrder& o = s.hot(h);
+        head_ = o.next;
+        if (head_ != HANDLE_NONE) s.hot(head_).prev = HANDLE_NONE;
+        else                      tail_ = HANDLE_NONE;
+        total_quantity_ -= o.leaves_qty;
+        --order_count_;
+        o.prev = o.next = HANDLE_NONE;
+        return h;
+    }
+
+    /**
+     * Fill up to `qty` against the queue in FIFO order, touching only
+     * HotOrder records. Calls `on_fill(handle, fill_qty)` per execution after
+     * a fully filled order has been unlinked, so the callback may release()
+     * it. Returns the quantity left unfilled.
+     */
+    template <typename OnFill>
+    Quantity sweep(CompactOrderStore& s, Quantity qty, OnFill&& on_fill) {
+        while (qty > 0 && head_ != HANDLE_NONE) {
+            const OrderHandle h = head_;
+            HotOrder& o = s.hot(h);
+            const Quantity fill = qty < o.leaves_qty ? qty : o.leaves_qty;
+            qty -= fill;
+            o.leaves_qty    -= fill;
+            total_quantity_ -= fill;
+            if (o.leaves_qty == 0) {
+                head_ = o.next;
+                if (head_ != HANDLE_NONE) s.hot(head_).prev = HANDLE_NONE;
+                else                      tail_ = HANDLE_NONE;
+                o.prev = o.next = HANDLE_NONE;
+                --order_count_;
+            }
+            on_fill(h, fill);
+        }
+        return qty;
+    }
+
+    // ── Accessors ──
+
+    [[nodiscard]] Price    price()          const noexcept { return price_; }
+    [[nodiscard]] Quantity total_quantity() const noexcept { return total_quantity_; }
+    [[nodiscard]] uint32_t order_count()    const noexcept { return order_count_; }
+    [[nodiscard]] bool     empty()          const noexcept { return order_count_ == 0; }
+
+    // ── Iterator support (yields handles, arrival order) ──
+
+    class Iterator {
+    public:
+        Iterator(const CompactOrderStore* s, OrderHandle h) : store_(s), current_(h) {}
+        OrderHandle operator*() const { return current_; }
+        Iterator& operator++() { current_ = store_->hot(current_).next; return *this; }
+        bool operator!=(const Iterator& other) const { return current_ != other.current_; }
+    private:
+        const CompactOrderStore* store_;
+        OrderHandle              current_;
+    };
+
+    [[nodiscard]] Iterator begin(const CompactOrderStore& s) const { return Iterator(&s, head_); }
+    [[nodiscard]] Iterator end(const CompactOrderStore& s)   const { return Iterator(&s, HANDLE_NONE); }
+
+    /// `for (OrderHandle h : level.orders(store))`
+    struct Range {
+        Iterator b, e;
+        Iterator begin() const { return b; }
+        Iterator end()   const { return e; }
+    };
+    [[nodiscard]] Range orders(const CompactOrderStore& s) const { return {begin(s), end(s)}; }
+
+private:
+    Price       price_          = 0;
+    Quantity    total_quantity_ = 0;
+    uint32_t    order_count_    = 0;
+    OrderHandle head_           = HANDLE_NONE;
+    OrderHandle tail_           = HANDLE_NONE;
+};
+
+} // namespace micro_exchange::core
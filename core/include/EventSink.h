@@ -0,0 +1,125 @@
+#pragma once
+
+#include "Order.h"
+#include "BookConcept.h"
+
+#include <tuple>
+#include <type_traits>
+
+namespace micro_exchange::core {
+
+/**
+ * Compile-time event sinks for the order books.
+ *
+ * A book is templated on a `Sink` policy and calls
+ *
+ *     sink.on_trade(book, trade);          // every execution
+ *     sink.on_order(book, order);          // every order-state change
+ *     sink.on_level(book, side, level);    // a price level's new aggregate
+ *
+ * directly from the matching path — no std::function, no vector walk, and
+ * the calls inline into the book. The book is passed in so a sink can read
+ * BBO/depth without holding a pointer to it (which would make the sink type
+ * depend on the book type that depends on the sink).
+ *
+ * `on_level` is optional: sinks without it are skipped at compile time, so
+ * only the market-by-price feed pays for level events.
+ *
+ *   NullSink          — the default; compiles to nothing.
+ *   SinkRef<T>        — forwards to a T* bound after construction (null = off).
+ *   SinkChain<S...>   — a tuple of sinks, dispatched in declaration order.
+ *
+ * Components find "their" sink in a book with `has_sink_v` / `sink_get`, so
+ * e.g. `MatchingEngine::add_symbol` and `FeedPublisher::attach` bind the
+ * static path when the book type carries their sink and fall back to the
+ * runtime `add_*_listener` API otherwise. Static sinks run before runtime
+ * listeners.
+ */
+
+struct NullSink {
+    template <typename Book> void on_trade(const Book&, const Trade&) noexcept {}
+    template <typename Book> void on_order(const Book&, const Order&) noexcept {}
+};
+
+/// A sink that takes level events; books and chains skip the rest.
+template <typename S, typename Book>
+concept LevelSink = requires(S& s, const Book& b, Side side, const BookLevel& l) {
+    s.on_level(b, side, l);
+};
+
+/**
+ * Non-owning forwarder to any object with `on_trade(book, t)` /
+ * `on_order(book, o)` members. Unbound (null) it is a predictable branch.
+ */
+template <typename T>
+struct SinkRef {
+    T* target = nullptr;
+
+    template <typename Book> void on_trade(const Book& b, const Trade& t) {
+        if (target) target->on_trade(b, t);
+    }
+    template <typename Book> void on_order(const Book& b, const Order& o) {
+        if (target) target->on_order(b, o);
+    }
+    template <typename Book> void on_level(const Book& b, Side side, const BookLevel& l) {
+        if constexpr (LevelSink<T, Book>) {
+            if (target) target->on_level(b, side, l);
+        }
+    }
+};
+
+template <typename... Sinks>
+class SinkChain {
+public:
+    template <typename Book> void on_trade(const Book& b, const Trade& t) {
+        std::apply([&](auto&... s) { (s.on_trade(b, t), ...); }, sinks_);
+    }
+    template <typename Book> void on_order(const Book& b, const Order& o) {
+        std::apply([&](auto&... s) { (s.on_order(b, o), ...); }, sinks_);
+    }
+    template <typename Book> void on_level(const Book& b, Side side, const BookLevel& l) {
+        std::apply([&](auto&... s) { (level_to(s, b, side, l), ...); }, sinks_);
+    }
+
+    template <typename S> [[nodiscard]] S& get() { return std::get<S>(sinks_); }
+
+private:
+    template <typename S, typename Book>
+    static void level_to(S& s, const Book& b, Side side, const BookLevel& l) {
+        if constexpr (LevelSink<S, Book>) s.on_level(b, side, l);
+    }
+
+    std::tuple<Sinks...> sinks_;
+};
+
+// ── Sink lookup ──
+
+template <typename S, typename Sink>
+struct sink_contains : std::is_same<S, Sink> {};
+
+template <typename S, typename... Sinks>
+struct sink_contains<S, SinkChain<Sinks...>>
+    : std::bool_constant<(std::is_same_v<S, Sinks> || ...)> {};
+
+/// True if `Book` was instantiated with a static sink that is (or chains) `S`.
+template <typename S, typename Book>
+inline constexpr bool has_sink_v = [] {
+    if constexpr (requires { typename Book::sink_type; }) {
+        return sink_contains<S, typename Book::sink_type>::value;
+    } else {
+        return false;
+    }
+}();
+
+/// The `S` inside a book's static sink; only valid when `has_sink_v<S, Book>`.
+template <typename S, typename Book>
+[[nodiscard]] S& sink_get(Book& book) {
+    static_assert(has_sink_v<S, Book>, "book has no such static sink");
+    if constexpr (std::is_same_v<S, typename Book::sink_type>) {
+        return book.sink();
+    } else {
+        return book.sink().template get<S>();
+    }
+}
+
+} // namespace micro_exchange::core
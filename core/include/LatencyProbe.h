@@ -0,0 +1,100 @@
+#pragma once
+
+// ─────────────────────────────────────────────────────────────────────────
+// LatencyProbe — where an order's wire-to-wire time goes.
+//
+// A timed order carries an OrderTrace: one ns timestamp per probe point,
+//
+//   Recv       the read that brought its frame in        (gateway)
+//   Decode     frame decoded into a NewOrderRequest       (gateway)
+//   BookEntry  the book's add_order                       (book)
+//   FirstFill  its first execution, if any                (book)
+//   Ack        the send() carrying its Ack has returned   (gateway)
+//
+// The gateway picks which orders are timed (1 in ProbeOptions::sample_every),
+// numbers each with a trace id, and makes its trace the thread's active one
+// around submit_order(); the books stamp BookEntry and FirstFill into
+// whatever trace is active. Nothing travels through the book API, so an
+// untimed order costs the books one thread-local null check per add and per
+// trade, and building with MICRO_EXCHANGE_PROBES=0 removes even that.
+//
+// A finished trace is cut into spans, each recorded into a LatencyHistogram:
+// log-linear buckets (16 per power of two, ~6% resolution) held in counters
+// that one recording thread writes and any thread reads without locks.
+// Traces at least ProbeOptions::trace_over_ns long are also kept whole on an
+// SPSC ring for one reader to drain. LatencyExporter rewrites a text report
+// of every span's percentiles each export_ms and appends the drained traces
+// to a file next to it. Those live in LatencyRecorder.h; this header is only
+// what the books need.
+// ─────────────────────────────────────────────────────────────────────────
+
+#include "Order.h"
+
+#include <array>
+#include <cstdint>
+
+#ifndef MICRO_EXCHANGE_PROBES
+#define MICRO_EXCHANGE_PROBES 1
+#endif
+
+namespace micro_exchange::core {
+
+enum class ProbePoint : uint8_t { Recv, Decode, BookEntry, FirstFill, Ack };
+inline constexpr size_t PROBE_POINTS = 5;
+
+struct OrderTrace {
+    uint64_t trace_id = 0;    // 0 = untimed
+    OrderId  order_id = 0;
+    std::array<uint64_t, PROBE_POINTS> at{};   // ns; 0 = not reached
+
+    void mark(ProbePoint p, uint64_t ns) noexcept { at[static_cast<size_t>(p)] = ns; }
+    [[nodiscard]] uint64_t operator[](ProbePoint p) const noexcept { return at[static_cast<size_t>(p)]; }
+};
+
+inline uint64_t probe_now() noexcept { return timestamp_ns(now()); }
+
+// ─────────────────────────────────────────────
+// Hot-path hooks (called from the books)
+// ─────────────────────────────────────────────
+
+namespace probe {
+
+#if MICRO_EXCHANGE_PROBES
+inline thread_local OrderTrace* active = nullptr;
+
+// add_order: reuses the book's own event timestamp, no extra clock read.
+inline void book_entry(Timestamp ts) noexcept {
+    if (active) [[unlikely]] active->mark(ProbePoint::BookEntry, timestamp_ns(ts));
+}
+
+// A trade print while the active order is matching: only the first counts.
+inline void fill() noexcept {
+    if (active && !(*active)[ProbePoint::FirstFill]) [[unlikely]]
+        active->mark(ProbePoint::FirstFill, probe_now());
+}
+#else
+inline void book_entry(Timestamp) noexcept {}
+inline void fill() noexcept {}
+#endif
+
+/// Make `t` (nullptr: none) the thread's active trace for this scope.
+class Scope {
+public:
+#if MICRO_EXCHANGE_PROBES
+    explicit Scope(OrderTrace* t) noexcept : prev_(active) { active = t; }
+    ~Scope() { active = prev_; }
+#else
+    explicit Scope(OrderTrace*) noexcept {}
+#endif
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+#if MICRO_EXCHANGE_PROBES
+    OrderTrace* prev_;
+#endif
+};
+
+} // namespace probe
+
+} // namespace micro_exchange::core
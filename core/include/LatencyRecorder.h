@@ -0,0 +1,345 @@
+#pragma once
+
+// ─────────────────────────────────────────────────────────────────────────
+// LatencyRecorder — histograms, kept traces and export for the latency
+// probes (LatencyProbe.h describes the probe points and spans).
+// ─────────────────────────────────────────────────────────────────────────
+
+#include "LatencyProbe.h"
+#include "SPSCRingBuffer.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace micro_exchange::core {
+
+// ─────────────────────────────────────────────
+// Histogram
+// ─────────────────────────────────────────────
+
+/**
+ * HDR-style latency histogram over ns values: exact below 16, then 16
+ * linear buckets per power of two. Single writer; snapshot() from anywhere.
+ */
+class LatencyHistogram {
+public:
+    static constexpr unsigned SUB_BITS = 4;
+    static constexpr size_t   SUB      = size_t{1} << SUB_BITS;
+    static constexpr size_t   BUCKETS  = (64 - SUB_BITS + 1) * SUB;
+
+    static size_t bucket(uint64_t v) noexcept {
+        if (v < SUB) return static_cast<size_t>(v);
+        const unsigned shift = static_cast<unsigned>(std::bit_width(v)) - 1 - SUB_BITS;
+        return (shift + 1) * SUB + static_cast<size_t>((v >> shift) & (SUB - 1));
+    }
+    static uint64_t lowest(size_t i) noexcept {
+        if (i < SUB) return i;
+        const size_t shift = i / SUB - 1;
+        return (SUB + i % SUB) << shift;
+    }
+    static uint64_t highest(size_t i) noexcept {
+        return i < SUB ? i : lowest(i) + ((uint64_t{1} << (i / SUB - 1)) - 1);
+    }
+
+    struct Snapshot {
+        std::array<uint64_t, BUCKETS> counts{};
+        uint64_t count = 0;
+        uint64_t sum   = 0;
+        uint64_t max   = 0;
+
+        [[nodiscard]] double mean() const noexcept {
+            return count ? static_cast<double>(sum) / static_cast<double>(count) : 0.0;
+        }
+
+        // Highest value in the bucket holding the p-quantile (never above max).
+        [[nodiscard]] uint64_t percentile(double p) const noexcept {
+            if (!count) return 0;
+            const auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(p * static_cast<double>(count) + 0.5));
+            uint64_t seen = 0;
+            for (size_t i = 0; i < BUCKETS; ++i) {
+                seen += counts[i];
+                if (seen >= rank) return std::min(highest(i), max);
+            }
+            return max;
+        }
+
+        void merge(const Snapshot& o) noexcept {
+            for (size_t i = 0; i < BUCKETS; ++i) counts[i] += o.counts[i];
+            count += o.count;
+            sum   += o.sum;
+            max    = std::max(max, o.max);
+        }
+    };
+
+    void record(uint64_t v) noexcept {
+        add(counts_[bucket(v)], 1);
+        add(count_, 1);
+        add(sum_, v);
+        if (v > max_.load(std::memory_order_relaxed)) max_.store(v, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] Snapshot snapshot() const noexcept {
+        Snapshot s;
+        for (size_t i = 0; i < BUCKETS; ++i) s.counts[i] = counts_[i].load(std::memory_order_relaxed);
+        s.count = count_.load(std::memory_order_relaxed);
+        s.sum   = sum_.load(std::memory_order_relaxed);
+        s.max   = max_.load(std::memory_order_relaxed);
+        return s;
+    }
+
+private:
+    // Single writer: a plain load + store, no read-modify-write.
+    static void add(std::atomic<uint64_t>& a, uint64_t v) noexcept {
+        a.store(a.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+    }
+
+    std::array<std::atomic<uint64_t>, BUCKETS> counts_{};
+    std::atomic<uint64_t> count_{0}, sum_{0}, max_{0};
+};
+
+// ─────────────────────────────────────────────
+// Recorder
+// ─────────────────────────────────────────────
+
+/// What a finished trace is cut into.
+enum class ProbeSpan : uint8_t {
+    RecvToDecode,   // read → decoded
+    DecodeToBook,   // decoded → add_order (pipelined: includes the command ring)
+    BookToFill,     // add_order → first fill (filled orders only)
+    ToAck,          // last of the above reached → Ack written
+    WireToWire,     // read → Ack written
+};
+inline constexpr size_t PROBE_SPANS = 5;
+
+inline constexpr const char* probe_span_name(ProbeSpan s) {
+    constexpr const char* names[PROBE_SPANS] = {
+        "recv_to_decode", "decode_to_book", "book_to_fill", "to_ack", "wire_to_wire"};
+    return names[static_cast<size_t>(s)];
+}
+
+struct ProbeOptions {
+    uint32_t    sample_every  = 0;      // time 1 NewOrder in N; 0 = probes off
+    uint64_t    trace_over_ns = 0;      // keep whole traces at least this long, wire to wire
+    std::string export_path;            // periodic report ("" = none); traces go to <path>.traces
+    unsigned    export_ms     = 1000;
+};
+
+struct LatencySnapshot {
+    std::array<LatencyHistogram::Snapshot, PROBE_SPANS> spans{};
+    uint64_t traces_kept    = 0;
+    uint64_t traces_dropped = 0;   // trace ring full (nobody draining)
+
+    [[nodiscard]] const LatencyHistogram::Snapshot& operator[](ProbeSpan s) const noexcept {
+        return spans[static_cast<size_t>(s)];
+    }
+};
+
+/**
+ * Sampling happens on the decoding thread (start()); everything else —
+ * ack_queued(), acks_written(), record() — on one recording thread, which
+ * may be the same one.
+ */
+class LatencyRecorder {
+public:
+    static constexpr size_t TRACE_RING = 1024;
+
+    explicit LatencyRecorder(const ProbeOptions& opts)
+        : opts_(opts), traces_(std::make_unique<TraceRing>()) {}
+
+    [[nodiscard]] const ProbeOptions& options() const noexcept { return opts_; }
+
+    // Begin timing `order` if it is due (1 in sample_every): resets `t`,
+    // numbers it, and stamps Recv (`recv_ns`) and Decode (now). Otherwise
+    // marks `t` untimed.
+    bool start(OrderTrace& t, OrderId order, uint64_t recv_ns) noexcept {
+        if (!opts_.sample_every || ++seen_ < opts_.sample_every) {
+            t.trace_id = 0;
+            return false;
+        }
+        seen_ = 0;
+        t = OrderTrace{};
+        t.trace_id = ++next_trace_;
+        t.order_id = order;
+        t.mark(ProbePoint::Recv, recv_ns);
+        t.mark(ProbePoint::Decode, probe_now());
+        return true;
+    }
+
+    // The order's Ack is queued; it is recorded once acks_written() says the
+    // send() that carried it has returned.
+    void ack_queued(const OrderTrace& t) { pending_.push_back(t); }
+
+    void acks_written() {
+        if (pending_.empty()) return;
+        const uint64_t ns = probe_now();
+        for (auto& t : pending_) {
+            t.mark(ProbePoint::Ack, ns);
+            record(t);
+        }
+        pending_.clear();
+    }
+
+    void record(const OrderTrace& t) noexcept {
+        const uint64_t recv = t[ProbePoint::Recv], dec = t[ProbePoint::Decode];
+        const uint64_t book = t[ProbePoint::BookEntry], fill = t[ProbePoint::FirstFill];
+        const uint64_t ack  = t[ProbePoint::Ack];
+        span(ProbeSpan::RecvToDecode, recv, dec);
+        span(ProbeSpan::DecodeToBook, dec, book);
+        span(ProbeSpan::BookToFill, book, fill);
+        span(ProbeSpan::ToAck, fill ? fill : book ? book : dec, ack);
+        span(ProbeSpan::WireToWire, recv, ack);
+        if (recv && ack >= recv && ack - recv >= opts_.trace_over_ns) {
+            if (traces_->push(t)) bump(kept_);
+            else                  bump(dropped_);
+        }
+    }
+
+    [[nodiscard]] LatencySnapshot snapshot() const noexcept {
+        LatencySnapshot s;
+        for (size_t i = 0; i < PROBE_SPANS; ++i) s.spans[i] = hist_[i].snapshot();
+        s.traces_kept    = kept_.load(std::memory_order_relaxed);
+        s.traces_dropped = dropped_.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    // Pass kept traces to f(const OrderTrace&), oldest first (one reader).
+    template <typename F>
+    size_t drain_traces(F&& f) { return traces_->consume(std::forward<F>(f)); }
+
+private:
+    using TraceRing = md::SPSCRingBuffer<OrderTrace, TRACE_RING>;
+
+    void span(ProbeSpan s, uint64_t from, uint64_t to) noexcept {
+        if (from && to >= from) hist_[static_cast<size_t>(s)].record(to - from);
+    }
+    static void bump(std::atomic<uint64_t>& a) noexcept {
+        a.store(a.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    ProbeOptions                                   opts_;
+    std::array<LatencyHistogram, PROBE_SPANS>      hist_;
+    std::unique_ptr<TraceRing>                     traces_;
+    std::vector<OrderTrace>                        pending_;   // recording thread
+    uint32_t                                       seen_       = 0;   // decoding thread
+    uint64_t                                       next_trace_ = 0;
+    std::atomic<uint64_t>                          kept_{0}, dropped_{0};
+};
+
+// ─────────────────────────────────────────────
+// Export
+// ─────────────────────────────────────────────
+
+/// One line per span: count, mean and percentiles in ns.
+inline void write_latency_report(std::ostream& os, const LatencySnapshot& s) {
+    char line[160];
+    std::snprintf(line, sizeof(line), "# traces kept %llu dropped %llu\n",
+                  static_cast<unsigned long long>(s.traces_kept),
+                  static_cast<unsigned long long>(s.traces_dropped));
+    os << line;
+    std::snprintf(line, sizeof(line), "%-16s %10s %10s %10s %10s %10s %10s %10s\n",
+                  "span_ns", "count", "mean", "p50", "p90", "p99", "p99.9", "max");
+    os << line;
+    for (size_t i = 0; i < PROBE_SPANS; ++i) {
+        const auto& h = s.spans[i];
+        std::snprintf(line, sizeof(line), "%-16s %10llu %10.0f %10llu %10llu %10llu %10llu %10llu\n",
+                      probe_span_name(static_cast<ProbeSpan>(i)),
+                      static_cast<unsigned long long>(h.count), h.mean(),
+                      static_cast<unsigned long long>(h.percentile(0.50)),
+                      static_cast<unsigned long long>(h.percentile(0.90)),
+                      static_cast<unsigned long long>(h.percentile(0.99)),
+                      static_cast<unsigned long long>(h.percentile(0.999)),
+                      static_cast<unsigned long long>(h.max));
+        os << line;
+    }
+}
+
+/// One trace per line: absolute Recv, then each later point as +ns from it
+/// ("-" if not reached).
+inline void write_trace(std::ostream& os, const OrderTrace& t) {
+    const uint64_t base = t[ProbePoint::Recv];
+    os << "trace " << t.trace_id << " order " << t.order_id << " recv " << base;
+    constexpr const char* names[PROBE_POINTS] = {"recv", "decode", "book", "fill", "ack"};
+    for (size_t p = 1; p < PROBE_POINTS; ++p) {
+        os << ' ' << names[p] << ' ';
+        if (t.at[p] >= base && t.at[p]) os << '+' << t.at[p] - base;
+        else                            os << '-';
+    }
+    os << '\n';
+}
+
+/**
+ * Rewrites `path` with the recorder's report every `period_ms` (through a
+ * temporary file and rename, so a reader never sees half a report) and
+ * appends drained traces to `path`.traces. Owns the trace ring's reading
+ * end. Writes a final report when destroyed.
+ */
+class LatencyExporter {
+public:
+    LatencyExporter(LatencyRecorder& recorder, std::string path, unsigned period_ms)
+        : recorder_(recorder), path_(std::move(path)), period_ms_(std::max(1u, period_ms)),
+          thread_([this] { run(); }) {}
+
+    ~LatencyExporter() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_one();
+        thread_.join();
+        write_now();
+    }
+
+    LatencyExporter(const LatencyExporter&) = delete;
+    LatencyExporter& operator=(const LatencyExporter&) = delete;
+
+    [[nodiscard]] const std::string& path() const noexcept { return path_; }
+
+    // Export immediately (any thread).
+    void write_now() {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        {
+            std::ofstream traces(path_ + ".traces", std::ios::app);
+            recorder_.drain_traces([&](const OrderTrace& t) { write_trace(traces, t); });
+        }
+        const std::string tmp = path_ + ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::trunc);
+            write_latency_report(out, recorder_.snapshot());
+        }
+        std::rename(tmp.c_str(), path_.c_str());
+    }
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!wake_.wait_for(lock, std::chrono::milliseconds(period_ms_), [this] { return stop_; })) {
+            lock.unlock();
+            write_now();
+            lock.lock();
+        }
+    }
+
+    LatencyRecorder&        recorder_;
+    std::string             path_;
+    unsigned                period_ms_;
+    std::mutex              mutex_;
+    std::mutex              write_mutex_;
+    std::condition_variable wake_;
+    bool                    stop_ = false;
+    std::thread             thread_;   // last: starts once the rest is built
+};
+
+} // namespace micro_exchange::core
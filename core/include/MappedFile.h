@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace micro_exchange::core {
+
+/**
+ * MappedFile — read-only mmap of a whole file, unmapped on destruction.
+ *
+ * Loaders read records straight out of the page cache instead of copying
+ * them through an ifstream buffer. `ok()` is false if the file is missing,
+ * empty, or cannot be mapped; callers treat that like a short read.
+ */
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat st {};
+        if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* p = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                data_ = static_cast<const std::byte*>(p);
+                size_ = static_cast<size_t>(st.st_size);
+#ifdef MADV_SEQUENTIAL
+                ::madvise(p, size_, MADV_SEQUENTIAL);
+#endif
+            }
+        }
+        ::close(fd);   // the mapping keeps the file referenced
+    }
+
+    ~MappedFile() {
+        if (data_) ::munmap(const_cast<std::byte*>(data_), size_);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    [[nodiscard]] bool             ok()   const noexcept { return data_ != nullptr; }
+    [[nodiscard]] const std::byte* data() const noexcept { return data_; }
+    [[nodiscard]] size_t           size() const noexcept { return size_; }
+
+private:
+    const std::byte* data_ = nullptr;
+    size_t           size_ = 0;
+};
+
+} // namespace micro_exchange::core
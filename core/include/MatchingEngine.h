@@ -1,17 +1,67 @@
 #pragma once
 
 #include "Order.h"
+#include "BookConcept.h"
+#include "EventSink.h"
 #include "OrderBook.h"
+#include "ArrayOrderBook.h"
 
 #include <unordered_map>
 #include <string>
+#include <string_view>
+#include <cstring>
 #include <vector>
 #include <memory>
-#include <mutex>
-#include <atomic>
+#include <span>
+#include <algorithm>
+#include <cassert>
 
 namespace micro_exchange::core {
 
+struct EngineStats {
+    uint64_t total_orders    = 0;
+    uint64_t total_cancels   = 0;
+    uint64_t total_amends    = 0;
+    uint64_t total_trades    = 0;
+    uint64_t total_volume    = 0;
+    uint64_t total_rejects   = 0;
+    uint64_t active_orders   = 0;
+    uint64_t symbols_active  = 0;
+
+    // Order-arena footprint summed over books. A warmed engine that never
+    // grew has arena_slabs == symbols_active.
+    uint64_t arena_allocated  = 0;   // order slots handed out
+    uint64_t arena_capacity   = 0;   // order slots reserved
+    uint64_t arena_slabs      = 0;
+    uint64_t arena_bytes      = 0;
+    uint64_t arena_huge_slabs = 0;   // slabs on MAP_HUGETLB pages
+};
+
+/// Transparent symbol hash so string_view lookups don't build a std::string.
+struct SymbolHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view s) const noexcept {
+        return std::hash<std::string_view>{}(s);
+    }
+};
+
+/**
+ * Static-sink counterpart of the engine's trade listener: a book whose sink
+ * chains an EngineStatsSink feeds trade/volume counters straight into the
+ * engine that owns it, with no std::function in between.
+ */
+struct EngineStatsSink {
+    EngineStats* stats = nullptr;
+
+    template <typename Book> void on_trade(const Book&, const Trade& t) noexcept {
+        if (stats) {
+            ++stats->total_trades;
+            stats->total_volume += t.quantity;
+        }
+    }
+    template <typename Book> void on_order(const Book&, const Order&) noexcept {}
+};
+
 /**
  * MatchingEngine — Multi-symbol matching engine facade.
  *
@@ -25,10 +75,11 @@ namespace micro_exchange::core {
  *
  *   2. Per-symbol sharding: Each OrderBook can be assigned to a
  *      dedicated thread. Cross-symbol operations (rare in equity markets)
- *      require coordination. This is how CME and ICE scale.
+ *      require coordination. This is how CME and ICE scale. See
+ *      ShardedMatchingEngine.h, which runs one of these engines per pinned
+ *      worker thread behind SPSC rings.
  *
- * For the single-threaded hot path, we avoid all locking.
- * The optional mutex is for multi-threaded access patterns only.
+ * The engine itself takes no locks: it is only ever touched by one thread.
  *
  * Sequencing:
  * ───────────
@@ -37,43 +88,78 @@ namespace micro_exchange::core {
  *   • Deterministic replay
  *   • Gap detection in market data feeds
  *   • Consistent ordering across undo/redo
+ *
+ * Book backend:
+ * ─────────────
+ * The engine is a template over any `OrderBookLike` book. `MatchingEngine`
+ * is the std::map-backed default; `ArrayMatchingEngine` runs the
+ * tick-indexed, bitmap-indexed `ArrayOrderBook`. Extra `add_symbol`
+ * arguments are forwarded to the book constructor (e.g. the initial price
+ * band for the array book).
+ *
+ * If the book's compile-time sink chains an `EngineStatsSink`, the engine
+ * binds it instead of registering a trade listener, so trade accounting is
+ * inlined into matching. The global trade callback is then only wired into
+ * the books (as a runtime listener) once set_trade_callback is called.
  */
-class MatchingEngine {
+template <OrderBookLike Book = OrderBook>
+class BasicMatchingEngine {
 public:
-    struct EngineStats {
-        uint64_t total_orders    = 0;
-        uint64_t total_cancels   = 0;
-        uint64_t total_amends    = 0;
-        uint64_t total_trades    = 0;
-        uint64_t total_volume    = 0;
-        uint64_t total_rejects   = 0;
-        uint64_t active_orders   = 0;
-        uint64_t symbols_active  = 0;
-    };
-
-    MatchingEngine() = default;
+    using book_type   = Book;
+    using EngineStats = core::EngineStats;
+
+    BasicMatchingEngine() = default;
 
     // ═══════════════════════════════════════════
     // Symbol management
+    //
+    // Symbols are interned once to a dense SymbolId (1, 2, 3, ...) which
+    // indexes a flat vector of books. Requests that carry a resolved
+    // symbol_id route with one bounds check and one load; requests that
+    // only carry the char[16] symbol take the slow path through the
+    // string → id table (heterogeneous lookup, no std::string temporary).
     // ═══════════════════════════════════════════
 
     /**
      * Register a tradeable symbol. Must be called before any orders.
+     * Idempotent: re-adding a symbol returns the existing book.
      */
-    OrderBook& add_symbol(const std::string& symbol) {
-        auto [it, inserted] = books_.try_emplace(symbol, symbol);
+    template <typename... BookArgs>
+    Book& add_symbol(const std::string& symbol, BookArgs&&... book_args) {
+        auto [it, inserted] = symbol_ids_.try_emplace(symbol, SYMBOL_ID_NONE);
         if (inserted) {
+            books_.push_back(std::make_unique<Book>(symbol,
+                                                    std::forward<BookArgs>(book_args)...));
+            it->second = static_cast<SymbolId>(books_.size());
             // Wire up callbacks
-            it->second.set_trade_callback([this](const Trade& trade) {
-                on_trade(trade);
-            });
+            Book& book = *books_.back();
+            if constexpr (kStaticStats) {
+                sink_get<EngineStatsSink>(book).stats = &stats_;
+                if (global_wired_) wire_global_callback(book);
+            } else {
+                book.add_trade_listener([this](const Trade& trade) {
+                    on_trade(trade);
+                });
+            }
         }
-        return it->second;
+        return *books_[it->second - 1];
+    }
+
+    /**
+     * Resolve a symbol to its SymbolId, or SYMBOL_ID_NONE if not registered.
+     * Intended for session logon / order-source setup, not per message.
+     */
+    [[nodiscard]] SymbolId symbol_id(std::string_view symbol) const {
+        auto it = symbol_ids_.find(symbol);
+        return (it != symbol_ids_.end()) ? it->second : SYMBOL_ID_NONE;
+    }
+
+    [[nodiscard]] Book* get_book(SymbolId id) {
+        return (id - 1 < books_.size()) ? books_[id - 1].get() : nullptr;
     }
 
-    [[nodiscard]] OrderBook* get_book(const std::string& symbol) {
-        auto it = books_.find(symbol);
-        return (it != books_.end()) ? &it->second : nullptr;
+    [[nodiscard]] Book* get_book(const std::string& symbol) {
+        return get_book(symbol_id(symbol));
     }
 
     // ═══════════════════════════════════════════
@@ -81,37 +167,92 @@ public:
     // ═══════════════════════════════════════════
 
     Order* submit_order(const NewOrderRequest& req) {
-        std::string sym(req.symbol, std::strlen(req.symbol));
-        auto it = books_.find(sym);
-        if (it == books_.end()) {
+        Book* book = route(req.symbol_id, req.symbol);
+        if (!book) {
             ++stats_.total_rejects;
             return nullptr;
         }
 
         ++stats_.total_orders;
-        return it->second.add_order(req);
+        return book->add_order(req);
     }
 
     bool cancel_order(const CancelRequest& req) {
-        std::string sym(req.symbol, std::strlen(req.symbol));
-        auto it = books_.find(sym);
-        if (it == books_.end()) return false;
+        Book* book = route(req.symbol_id, req.symbol);
+        if (!book) return false;
 
-        bool success = it->second.cancel_order(req.order_id);
+        bool success = book->cancel_order(req.order_id);
         if (success) ++stats_.total_cancels;
         return success;
     }
 
     bool amend_order(const AmendRequest& req) {
-        std::string sym(req.symbol, std::strlen(req.symbol));
-        auto it = books_.find(sym);
-        if (it == books_.end()) return false;
+        Book* book = route(req.symbol_id, req.symbol);
+        if (!book) return false;
 
-        bool success = it->second.amend_order(req);
+        bool success = book->amend_order(req);
         if (success) ++stats_.total_amends;
         return success;
     }
 
+    // ═══════════════════════════════════════════
+    // Batched order entry
+    //
+    // Equivalent to calling submit_order / cancel_order on each element in
+    // order. Consecutive requests for the same book are handed to the book's
+    // own submit_batch / cancel_batch, which shares one timestamp and
+    // prefetches ahead; a symbol change just starts a new run.
+    // ═══════════════════════════════════════════
+
+    /**
+     * Returns the number of accepted requests. If `out` is non-empty,
+     * out[i] receives what submit_order(reqs[i]) would have returned.
+     */
+    size_t submit_batch(std::span<const NewOrderRequest> reqs, std::span<Order*> out = {}) {
+        size_t accepted = 0;
+        size_t i = 0;
+        while (i < reqs.size()) {
+            Book* book = route(reqs[i].symbol_id, reqs[i].symbol);
+            if (!book) {
+                ++stats_.total_rejects;
+                if (i < out.size()) out[i] = nullptr;
+                ++i;
+                continue;
+            }
+            size_t j = i + 1;
+            while (j < reqs.size() && route(reqs[j].symbol_id, reqs[j].symbol) == book) ++j;
+
+            std::span<Order*> run_out =
+                i < out.size() ? out.subspan(i, std::min(j, out.size()) - i) : std::span<Order*>{};
+            book->submit_batch(reqs.subspan(i, j - i), run_out);
+            stats_.total_orders += j - i;
+            accepted += j - i;
+            i = j;
+        }
+        return accepted;
+    }
+
+    /// Returns the number of orders actually cancelled.
+    size_t cancel_batch(std::span<const CancelRequest> reqs) {
+        size_t cancelled = 0;
+        size_t i = 0;
+        while (i < reqs.size()) {
+            Book* book = route(reqs[i].symbol_id, reqs[i].symbol);
+            if (!book) { ++i; continue; }
+
+            batch_ids_.clear();
+            size_t j = i;
+            for (; j < reqs.size() && route(reqs[j].symbol_id, reqs[j].symbol) == book; ++j) {
+                batch_ids_.push_back(reqs[j].order_id);
+            }
+            size_t n = book->cancel_batch(batch_ids_);
+            stats_.total_cancels += n;
+            cancelled += n;
+            i = j;
+        }
+        return cancelled;
+    }
+
     // ═══════════════════════════════════════════
     // Global trade callback
     // ═══════════════════════════════════════════
@@ -119,6 +260,12 @@ public:
     using GlobalTradeCallback = std::function<void(const Trade&)>;
 
     void set_trade_callback(GlobalTradeCallback cb) {
+        if constexpr (kStaticStats) {
+            if (!global_wired_ && cb) {
+                for (auto& book : books_) wire_global_callback(*book);
+                global_wired_ = true;
+            }
+        }
         global_trade_callback_ = std::move(cb);
     }
 
@@ -130,17 +277,47 @@ public:
         EngineStats s = stats_;
         s.active_orders = 0;
         s.symbols_active = books_.size();
-        for (const auto& [sym, book] : books_) {
-            s.active_orders += book.active_orders();
+        for (const auto& book : books_) {
+            s.active_orders += book->active_orders();
+            const ArenaStats a = book->arena_stats();
+            s.arena_allocated  += a.allocated;
+            s.arena_capacity   += a.capacity;
+            s.arena_slabs      += a.slabs;
+            s.arena_bytes      += a.bytes;
+            s.arena_huge_slabs += a.huge_slabs;
         }
         return s;
     }
 
-    [[nodiscard]] const std::unordered_map<std::string, OrderBook>& books() const {
+    // Books in SymbolId order: books()[id - 1] is the book for `id`.
+    [[nodiscard]] const std::vector<std::unique_ptr<Book>>& books() const {
         return books_;
     }
 
 private:
+    static constexpr bool kStaticStats = has_sink_v<EngineStatsSink, Book>;
+
+    // Static-stats books only: the user callback rides the runtime listener
+    // path, registered once per book and only if a callback is ever set.
+    void wire_global_callback(Book& book) {
+        book.add_trade_listener([this](const Trade& trade) {
+            if (global_trade_callback_) global_trade_callback_(trade);
+        });
+    }
+
+    // Fast path: a resolved id (unsigned wrap makes SYMBOL_ID_NONE fail the
+    // bounds check). Slow path: the fixed-width, possibly unterminated symbol.
+    // The id wins without a string compare, so callers must not pass one that
+    // disagrees with a non-blank symbol (the gateway replaces untrusted ids).
+    Book* route(SymbolId id, const char (&symbol)[16]) {
+        if (id - 1 < books_.size()) [[likely]] {
+            assert(symbol[0] == '\0'
+                   || books_[id - 1]->symbol() == std::string_view(symbol, ::strnlen(symbol, sizeof(symbol))));
+            return books_[id - 1].get();
+        }
+        return get_book(symbol_id(std::string_view(symbol, ::strnlen(symbol, sizeof(symbol)))));
+    }
+
     void on_trade(const Trade& trade) {
         ++stats_.total_trades;
         stats_.total_volume += trade.quantity;
@@ -149,9 +326,15 @@ private:
         }
     }
 
-    std::unordered_map<std::string, OrderBook> books_;
+    std::vector<std::unique_ptr<Book>>                                books_;
+    std::unordered_map<std::string, SymbolId, SymbolHash, std::equal_to<>> symbol_ids_;
     EngineStats stats_;
+    std::vector<OrderId> batch_ids_;   // cancel_batch scratch, reused across calls
     GlobalTradeCallback global_trade_callback_;
+    bool global_wired_ = false;   // static-stats books: callback listener registered
 };
 
+using MatchingEngine      = BasicMatchingEngine<OrderBook>;
+using ArrayMatchingEngine = BasicMatchingEngine<ArrayOrderBook>;
+
 } // namespace micro_exchange::core
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "Clock.h"
+
 #include <cstdint>
 #include <chrono>
 #include <string>
@@ -53,14 +55,19 @@ using Quantity = uint64_t;
 using OrderId  = uint64_t;
 using SeqNum   = uint64_t;
 
+// Dense per-engine instrument handle, assigned by MatchingEngine::add_symbol.
+// 0 means "not resolved": the engine falls back to the char[16] symbol lookup.
+using SymbolId = uint32_t;
+static constexpr SymbolId SYMBOL_ID_NONE = 0;
+
 static constexpr Price PRICE_INVALID = std::numeric_limits<Price>::max();
 static constexpr Price PRICE_MARKET  = 0;  // Market orders have no price limit
 
 // ─────────────────────────────────────────────
-// Timestamp: nanosecond precision
+// Timestamp: nanosecond precision, from EventClock (TSC by default; Clock.h)
 // ─────────────────────────────────────────────
 
-using Timestamp = std::chrono::time_point<std::chrono::steady_clock>;
+using Timestamp = EventClock::time_point;
 
 inline uint64_t timestamp_ns(Timestamp ts) {
     return static_cast<uint64_t>(
@@ -71,7 +78,7 @@ inline uint64_t timestamp_ns(Timestamp ts) {
 }
 
 inline Timestamp now() {
-    return std::chrono::steady_clock::now();
+    return EventClock::now();
 }
 
 // ─────────────────────────────────────────────
@@ -119,7 +126,7 @@ struct alignas(64) Order {
 
     // Hot-path variants take a caller-supplied timestamp. The matching engine
     // captures now() once per inbound event and threads it through every fill,
-    // rather than re-reading the clock (~17ns) several times per order.
+    // rather than re-reading the clock several times per order.
     void fill(Quantity qty, Timestamp ts) noexcept {
         filled_qty += qty;
         leaves_qty -= qty;
@@ -164,11 +171,13 @@ struct NewOrderRequest {
     Price       price       = 0;
     Price       stop_price  = 0;   // Stop / StopLimit trigger
     Quantity    quantity    = 0;
+    SymbolId    symbol_id   = SYMBOL_ID_NONE;   // fast-path routing; see MatchingEngine
     char        symbol[16]  = {};
 };
 
 struct CancelRequest {
     OrderId     order_id;
+    SymbolId    symbol_id = SYMBOL_ID_NONE;
     char        symbol[16];
 };
 
@@ -176,6 +185,7 @@ struct AmendRequest {
     OrderId     order_id;
     Price       new_price;     // 0 = no change
     Quantity    new_quantity;   // 0 = no change
+    SymbolId    symbol_id = SYMBOL_ID_NONE;
     char        symbol[16];
 };
 
@@ -3,12 +3,17 @@
 #include "Order.h"
 #include "PriceLevel.h"
 #include "ArenaAllocator.h"
+#include "OrderIndex.h"
+#include "StopBook.h"
+#include "BookConcept.h"
+#include "EventSink.h"
+#include "LatencyProbe.h"
 
 #include <map>
-#include <unordered_map>
 #include <vector>
 #include <functional>
 #include <optional>
+#include <span>
 #include <string>
 #include <cassert>
 
@@ -34,8 +39,9 @@ namespace micro_exchange::core {
  *     exchanges (e.g., LMAX). We use std::map for clarity; the array
  *     optimization is documented as a design note.
  *
- *   • We additionally maintain a hash map from OrderId → Order* for O(1)
- *     cancel/amend operations.
+ *   • We additionally maintain an open-addressing OrderIndex (OrderId →
+ *     Order*) for O(1) cancel/amend, pre-sized from `order_capacity` so
+ *     churn never allocates or rehashes.
  *
  * Matching algorithm:
  *   1. Incoming order scans the opposite side from best price inward
@@ -49,18 +55,40 @@ namespace micro_exchange::core {
  *   • FIFO: within a price level, earlier orders fill first
  *   • Determinism: given identical input sequence, output is identical
  *   • Conservation: total filled quantity on both sides of every trade is equal
+ *
+ * Event dispatch:
+ *   The book is a template over a compile-time `Sink` (see EventSink.h) that
+ *   receives every trade and order-state change with no type erasure.
+ *   `OrderBook` is `BasicOrderBook<NullSink>`; the runtime add_*_listener
+ *   fan-out is kept for tests and tooling and runs after the static sink.
  */
-class OrderBook {
+template <typename Sink = NullSink>
+class BasicOrderBook {
 public:
+    using sink_type = Sink;
+
     // Trade callback: invoked for each execution
     using TradeCallback = std::function<void(const Trade&)>;
 
     // Order update callback: invoked for status changes
     using OrderCallback = std::function<void(const Order&)>;
 
-    explicit OrderBook(const std::string& symbol = "")
+    // Level callback: a price level's aggregate after it changed (a level
+    // that emptied reports quantity and order_count 0)
+    using LevelCallback = std::function<void(Side, const BookLevel&)>;
+
+    /**
+     * @param symbol          instrument symbol
+     * @param order_capacity  expected peak of live orders; pre-sizes the
+     *                        order index and the order arena
+     * @param arena           slab backing for the order arena (mmap / huge
+     *                        pages / prefault / NUMA node)
+     */
+    explicit BasicOrderBook(const std::string& symbol = "", size_t order_capacity = 65536,
+                            ArenaOptions arena = {})
         : symbol_(symbol)
-        , order_arena_(65536)
+        , order_index_(order_capacity)
+        , order_arena_(order_capacity, arena)
     {}
 
     // ───────────────────────────────────────────
@@ -77,11 +105,19 @@ public:
     void add_order_listener(OrderCallback cb) {
         order_listeners_.push_back(std::move(cb));
     }
+    void add_level_listener(LevelCallback cb) {
+        level_listeners_.push_back(std::move(cb));
+    }
     void clear_listeners() {
         trade_listeners_.clear();
         order_listeners_.clear();
+        level_listeners_.clear();
     }
 
+    // Compile-time sink (EventSink.h). Components bind into it via sink_get.
+    [[nodiscard]] Sink&       sink()       noexcept { return sink_; }
+    [[nodiscard]] const Sink& sink() const noexcept { return sink_; }
+
     // ═══════════════════════════════════════════
     // Order Operations
     // ═══════════════════════════════════════════
@@ -91,104 +127,52 @@ public:
      * Returns the order pointer (owned by arena).
      */
     Order* add_order(const NewOrderRequest& req) {
-        // Allocate from arena (zero malloc)
         ts_ = now();                 // one clock read per event; reused for every fill
-        Order* order = order_arena_.allocate();
-        new (order) Order{};
-
-        order->id        = req.id;
-        order->sequence  = next_sequence_++;
-        order->side      = req.side;
-        order->type      = req.type;
-        order->tif       = req.tif;
-        order->price     = req.price;
-        order->stop_price = req.stop_price;
-        order->quantity  = req.quantity;
-        order->leaves_qty = req.quantity;
-        order->filled_qty = 0;
-        order->entry_time = ts_;
-        order->last_update = ts_;
-        order->status    = OrderStatus::New;
-        std::memcpy(order->symbol, req.symbol, sizeof(order->symbol));
-
-        // Index by ID for O(1) cancel/amend
-        order_index_[order->id] = order;
-
-        // Stop / StopLimit orders are parked until last-traded price crosses
-        // the trigger. We park them first; if the trigger is already in the
-        // money relative to the current best they will be released by the
-        // explicit check_stop_triggers() call below.
-        if (order->type == OrderType::Stop || order->type == OrderType::StopLimit) {
-            park_stop_order(order);
-            notify_order(*order);
-            check_stop_triggers();
-            return order;
-        }
-
-        // Attempt matching
-        match(order);
-
-        // Handle post-match: rest or cancel based on type
-        if (order->leaves_qty > 0) {
-            switch (order->type) {
-                case OrderType::Limit:
-                    rest_order(order);
-                    break;
-                case OrderType::Market:
-                case OrderType::IOC:
-                    // Cancel unfilled remainder
-                    order->cancel(ts_);
-                    order_index_.erase(order->id);
-                    notify_order(*order);
-                    break;
-                case OrderType::FOK:
-                    // Should have been fully filled or not at all
-                    // (FOK pre-check happens in match())
-                    order->cancel(ts_);
-                    order_index_.erase(order->id);
-                    notify_order(*order);
-                    break;
-                case OrderType::Stop:
-                case OrderType::StopLimit:
-                    // Handled above before reaching match() — should not get here.
-                    break;
-            }
-        }
-
-        // Each successful aggressive cycle may move the last-traded price and
-        // therefore activate parked stop orders.
-        check_stop_triggers();
-
-        return order;
+        probe::book_entry(ts_);
+        return process_new(req);
     }
 
     /**
      * Cancel an existing order. O(1) lookup + O(1) removal from level.
      */
     bool cancel_order(OrderId id) {
-        auto it = order_index_.find(id);
-        if (it == order_index_.end()) return false;
+        ts_ = now();
+        return process_cancel(id);
+    }
 
-        Order* order = it->second;
-        if (!order->is_active()) return false;
+    // ───────────────────────────────────────────
+    // Batched entry
+    //
+    // Results are identical to calling add_order / cancel_order in sequence
+    // (timestamps aside): one clock read covers the whole batch, and the
+    // index slot of request i + BATCH_PREFETCH is prefetched while request i
+    // is processed.
+    // ───────────────────────────────────────────
+    static constexpr size_t BATCH_PREFETCH = 4;
 
-        // Stop orders live in stop_orders_, not in the price levels
-        if (order->type == OrderType::Stop || order->type == OrderType::StopLimit) {
-            unpark_stop_order(order);
-            order->cancel();
-            order_index_.erase(it);
-            notify_order(*order);
-            return true;
+    /**
+     * Submit `reqs` in order. If `out` is non-empty, out[i] receives the
+     * Order* for reqs[i] (as add_order would return). Returns reqs.size().
+     */
+    size_t submit_batch(std::span<const NewOrderRequest> reqs, std::span<Order*> out = {}) {
+        ts_ = now();
+        for (size_t i = 0; i < reqs.size(); ++i) {
+            if (i + BATCH_PREFETCH < reqs.size()) prefetch_new(reqs[i + BATCH_PREFETCH]);
+            Order* o = process_new(reqs[i]);
+            if (i < out.size()) out[i] = o;
         }
+        return reqs.size();
+    }
 
-        // Remove from price level
-        remove_from_book(order);
-
-        order->cancel();
-        order_index_.erase(it);
-
-        notify_order(*order);
-        return true;
+    /// Cancel `ids` in order. Returns how many were live and got cancelled.
+    size_t cancel_batch(std::span<const OrderId> ids) {
+        ts_ = now();
+        size_t cancelled = 0;
+        for (size_t i = 0; i < ids.size(); ++i) {
+            if (i + BATCH_PREFETCH < ids.size()) order_index_.prefetch(ids[i + BATCH_PREFETCH]);
+            cancelled += process_cancel(ids[i]);
+        }
+        return cancelled;
     }
 
     /**
@@ -196,19 +180,30 @@ public:
      * Quantity reduction preserves priority.
      */
     bool amend_order(const AmendRequest& req) {
-        auto it = order_index_.find(req.order_id);
-        if (it == order_index_.end()) return false;
-
-        Order* order = it->second;
-        if (!order->is_active()) return false;
+        Order* order = order_index_.find(req.order_id);
+        if (!order || !order->is_active()) return false;
 
         ts_ = now();
         bool price_changed = (req.new_price != 0 && req.new_price != order->price);
         bool qty_increased = (req.new_quantity != 0 && req.new_quantity > order->leaves_qty);
+        std::optional<BookLevel> left, joined;   // levels reported after the order event
 
-        if (price_changed || qty_increased) {
+        if (order->type == OrderType::Stop || order->type == OrderType::StopLimit) {
+            // Parked stops are not in any price level — calling
+            // remove_from_book() on one would unlink a stranger's queue.
+            // Amend the parked fields in place; the trigger is unchanged.
+            if (req.new_price != 0 && order->type == OrderType::StopLimit) {
+                order->price = req.new_price;
+            }
+            if (req.new_quantity != 0) {
+                order->quantity = req.new_quantity;
+                order->leaves_qty = req.new_quantity - order->filled_qty;
+            }
+            order->status = OrderStatus::Amended;
+            order->last_update = ts_;
+        } else if (price_changed || qty_increased) {
             // Loses queue priority: remove and re-insert
-            remove_from_book(order);
+            left = remove_from_book(order);
 
             if (req.new_price != 0) order->price = req.new_price;
             if (req.new_quantity != 0) {
@@ -222,7 +217,9 @@ public:
             // Re-match then rest
             match(order);
             if (order->leaves_qty > 0 && order->type == OrderType::Limit) {
-                rest_order(order);
+                joined = rest_order(order);
+            } else if (order->leaves_qty == 0) {
+                order_index_.erase(order->id);
             }
         } else if (req.new_quantity != 0 && req.new_quantity < order->leaves_qty) {
             // Quantity reduction: preserves priority
@@ -237,10 +234,13 @@ public:
             auto level_it = levels.find(order->price);
             if (level_it != levels.end()) {
                 level_it->second.reduce_quantity(reduction);
+                joined = aggregate(level_it->second);
             }
         }
 
         notify_order(*order);
+        if (left)   notify_level(order->side, *left);
+        if (joined) notify_level(order->side, *joined);
         return true;
     }
 
@@ -273,18 +273,14 @@ public:
     }
 
     [[nodiscard]] Quantity bid_depth(size_t levels = 0) const {
-        return side_depth(bids_, levels);
+        return side_depth(bids_.rbegin(), bids_.rend(), levels);   // best bid first
     }
 
     [[nodiscard]] Quantity ask_depth(size_t levels = 0) const {
-        return side_depth(asks_, levels);
+        return side_depth(asks_.begin(), asks_.end(), levels);
     }
 
-    struct BookLevel {
-        Price    price;
-        Quantity quantity;
-        uint32_t order_count;
-    };
+    using BookLevel = core::BookLevel;
 
     [[nodiscard]] std::vector<BookLevel> get_bids(size_t max_levels = 10) const {
         return get_side_levels(bids_, max_levels, true);
@@ -316,7 +312,146 @@ public:
     [[nodiscard]] Price    last_trade_price()    const { return last_trade_price_; }
     [[nodiscard]] uint64_t stop_triggered_count() const { return stop_triggered_count_; }
     [[nodiscard]] size_t   parked_stop_count()   const {
-        return buy_stops_.size() + sell_stops_.size();
+        return stops_.size();
+    }
+    [[nodiscard]] ArenaStats arena_stats() const { return order_arena_.stats(); }
+
+    // ═══════════════════════════════════════════
+    // Warm restart
+    //
+    // Entry points for BookCheckpoint.h and FeedRecovery.h. They rebuild
+    // state directly — no matching, no stop checks, no events — so they are
+    // only for a book that is being restored, before it takes order flow.
+    // ═══════════════════════════════════════════
+
+    /// Visit resting orders: bids best→worst, then asks best→worst, FIFO within a level.
+    template <typename F>
+    void for_each_resting(F&& fn) const {
+        for (auto it = bids_.rbegin(); it != bids_.rend(); ++it) {
+            for (const Order& o : it->second) fn(o);
+        }
+        for (const auto& [price, level] : asks_) {
+            for (const Order& o : level) fn(o);
+        }
+    }
+
+    /// Visit parked Stop / StopLimit orders in release order.
+    template <typename F>
+    void for_each_parked_stop(F&& fn) const { stops_.for_each(fn); }
+
+    [[nodiscard]] BookCounters counters() const {
+        return {next_sequence_, trade_count_, total_volume_, last_trade_price_, stop_triggered_count_};
+    }
+
+    void restore_counters(const BookCounters& c) {
+        next_sequence_        = c.next_sequence;
+        trade_count_          = c.trade_count;
+        total_volume_         = c.total_volume;
+        last_trade_price_     = c.last_trade_price;
+        stop_triggered_count_ = c.stop_triggered_count;
+    }
+
+    /// Size the index and arena for `n` live orders before a bulk load.
+    void reserve_orders(size_t n) {
+        order_index_.reserve(n);
+        order_arena_.reserve(n);
+    }
+
+    /// Live (resting or parked) order by id, or nullptr.
+    [[nodiscard]] const Order* find_order(OrderId id) const { return order_index_.find(id); }
+
+    /// Warm the index slot a later restore_order(id) will write (bulk loads).
+    void prefetch_restore(OrderId id) const noexcept { order_index_.prefetch(id); }
+
+    /**
+     * Put a copy of `snap` back as-is: parked if it is a Stop / StopLimit,
+     * else at the back of its price level. A zero `snap.sequence` takes the
+     * next book sequence. The id must not already be live.
+     */
+    Order* restore_order(const Order& snap) {
+        Order* order = order_arena_.allocate();
+        new (order) Order(snap);
+        order->prev = order->next = nullptr;
+        if (order->sequence == 0) order->sequence = next_sequence_++;
+
+        order_index_.insert(order->id, order);
+        if (order->type == OrderType::Stop || order->type == OrderType::StopLimit) {
+            stops_.park(order);
+        } else {
+            rest_order(order);
+        }
+        return order;
+    }
+
+    /**
+     * Replace live order `snap.id` with `snap`. It keeps its queue position
+     * when amend_order would (same side, type and price and no size-up — a
+     * parked stop just needs the same trigger); otherwise it goes to the
+     * back of its new queue. An id that is not live is simply restored.
+     */
+    Order* restore_amend(const Order& snap) {
+        Order* order = order_index_.find(snap.id);
+        if (!order) return restore_order(snap);
+
+        const bool stop = order->type == OrderType::Stop || order->type == OrderType::StopLimit;
+        const bool keeps_place = order->side == snap.side && order->type == snap.type
+                              && (stop ? order->stop_price == snap.stop_price
+                                       : order->price == snap.price && snap.leaves_qty <= order->leaves_qty);
+        if (!keeps_place) {
+            restore_remove(snap.id);
+            return restore_order(snap);
+        }
+        if (!stop) {
+            auto& levels = order->is_buy() ? bids_ : asks_;
+            levels.find(order->price)->second.reduce_quantity(order->leaves_qty - snap.leaves_qty);
+        }
+        order->price       = snap.price;
+        order->quantity    = snap.quantity;
+        order->filled_qty  = snap.filled_qty;
+        order->leaves_qty  = snap.leaves_qty;
+        order->status      = snap.status;
+        order->last_update = snap.last_update;
+        return order;
+    }
+
+    /// Take a resting or parked order out of the book without a cancel event.
+    bool restore_remove(OrderId id) {
+        Order* order = order_index_.find(id);
+        if (!order) return false;
+        if (order->type == OrderType::Stop || order->type == OrderType::StopLimit) {
+            unpark_stop_order(order);
+        } else {
+            remove_from_book(order);
+        }
+        order->cancel(order->last_update);
+        order_index_.erase(id);
+        return true;
+    }
+
+    /**
+     * Apply one print against resting order `id` as its passive side: reduce
+     * it and its level, drop it once filled, and advance the trade counters
+     * and last price exactly as match() does.
+     */
+    bool restore_fill(OrderId id, Quantity qty, Price price, Timestamp ts) {
+        Order* order = order_index_.find(id);
+        if (!order || qty > order->leaves_qty) return false;
+        if (order->type == OrderType::Stop || order->type == OrderType::StopLimit) return false;
+        auto& levels = order->is_buy() ? bids_ : asks_;
+        auto it = levels.find(order->price);
+        if (it == levels.end()) return false;
+
+        it->second.reduce_quantity(qty);
+        order->fill(qty, ts);
+        if (order->is_filled()) {
+            remove_from_book(order);
+            order_index_.erase(id);
+        }
+        ++next_sequence_;
+        ++trade_count_;
+        total_volume_    += qty;
+        last_trade_price_ = price;
+        return true;
     }
 
     // ═══════════════════════════════════════════
@@ -352,6 +487,111 @@ public:
     }
 
 private:
+    void prefetch_new(const NewOrderRequest& req) const noexcept {
+        order_index_.prefetch(req.id);
+    }
+
+    // add_order body; the caller has already set ts_ for this event.
+    Order* process_new(const NewOrderRequest& req) {
+        // Allocate from arena (zero malloc)
+        Order* order = order_arena_.allocate();
+        new (order) Order{};
+
+        order->id        = req.id;
+        order->sequence  = next_sequence_++;
+        order->side      = req.side;
+        order->type      = req.type;
+        order->tif       = req.tif;
+        order->price     = req.price;
+        order->stop_price = req.stop_price;
+        order->quantity  = req.quantity;
+        order->leaves_qty = req.quantity;
+        order->filled_qty = 0;
+        order->entry_time = ts_;
+        order->last_update = ts_;
+        order->status    = OrderStatus::New;
+        std::memcpy(order->symbol, req.symbol, sizeof(order->symbol));
+
+        // Index by ID for O(1) cancel/amend
+        order_index_.insert(order->id, order);
+
+        // Stop / StopLimit orders are parked until last-traded price crosses
+        // the trigger. We park them first; if the trigger is already in the
+        // money relative to the current best they will be released by the
+        // explicit check_stop_triggers() call below.
+        if (order->type == OrderType::Stop || order->type == OrderType::StopLimit) {
+            park_stop_order(order);
+            notify_order(*order);
+            check_stop_triggers();
+            return order;
+        }
+
+        // Attempt matching
+        match(order);
+
+        // Handle post-match: rest or cancel based on type
+        if (order->leaves_qty > 0) {
+            switch (order->type) {
+                case OrderType::Limit: {
+                    const BookLevel lvl = rest_order(order);
+                    notify_order(*order);
+                    notify_level(order->side, lvl);
+                    break;
+                }
+                case OrderType::Market:
+                case OrderType::IOC:
+                    // Cancel unfilled remainder
+                    order->cancel(ts_);
+                    order_index_.erase(order->id);
+                    notify_order(*order);
+                    break;
+                case OrderType::FOK:
+                    // Should have been fully filled or not at all
+                    // (FOK pre-check happens in match())
+                    order->cancel(ts_);
+                    order_index_.erase(order->id);
+                    notify_order(*order);
+                    break;
+                case OrderType::Stop:
+                case OrderType::StopLimit:
+                    // Handled above before reaching match() — should not get here.
+                    break;
+            }
+        } else {
+            order_index_.erase(order->id);   // fully filled on entry
+        }
+
+        // Each successful aggressive cycle may move the last-traded price and
+        // therefore activate parked stop orders.
+        check_stop_triggers();
+
+        return order;
+    }
+
+    bool process_cancel(OrderId id) {
+        Order* order = order_index_.find(id);
+        if (!order || !order->is_active()) return false;
+
+        // Stop orders live in stop_orders_, not in the price levels
+        if (order->type == OrderType::Stop || order->type == OrderType::StopLimit) {
+            unpark_stop_order(order);
+            order->cancel(ts_);
+            order_index_.erase(id);
+            notify_order(*order);
+            return true;
+        }
+
+        // Remove from price level
+        const BookLevel lvl = remove_from_book(order);
+
+        order->cancel(ts_);
+        order_index_.erase(id);
+
+        notify_order(*order);
+        notify_level(order->side, lvl);
+        return true;
+    }
+
     // TODO: this should really be a contiguous array indexed by
     // (price - min_price) / tick_size for O(1) BBO lookup.
     // std::map is fine for now but the tree traversal kills cache locality.
@@ -441,6 +681,7 @@ private:
                     order_index_.erase(resting->id);
                     // Note: we don't deallocate yet — arena manages lifetime
                 }
+                notify_level(resting->side, aggregate(level));
             }
 
             // Remove empty level
@@ -452,51 +693,53 @@ private:
 
     bool can_fill_completely(const Order* order) const {
         Quantity needed = order->leaves_qty;
-        const auto& contra = order->is_buy() ? asks_ : bids_;
 
-        for (const auto& [price, level] : contra) {
-            if (order->is_buy() && order->price < price && order->price != PRICE_MARKET) break;
-            if (!order->is_buy() && order->price > price && order->price != PRICE_MARKET) break;
-
-            needed -= std::min(needed, level.total_quantity());
-            if (needed == 0) return true;
+        // Walk the contra side from its best level inward: asks ascending,
+        // bids descending (iterating bids from begin() would start at the
+        // *worst* bid and bail out before reaching the matchable ones).
+        if (order->is_buy()) {
+            for (const auto& [price, level] : asks_) {
+                if (order->price < price && order->price != PRICE_MARKET) break;
+                needed -= std::min(needed, level.total_quantity());
+                if (needed == 0) return true;
+            }
+        } else {
+            for (auto it = bids_.rbegin(); it != bids_.rend(); ++it) {
+                if (order->price > it->first && order->price != PRICE_MARKET) break;
+                needed -= std::min(needed, it->second.total_quantity());
+                if (needed == 0) return true;
+            }
         }
         return needed == 0;
     }
 
     // ── Book management ──
 
-    void rest_order(Order* order) {
+    // rest_order / remove_from_book return the level's aggregate afterwards
+    // for notify_level; the silent restore_* paths just drop it.
+    BookLevel rest_order(Order* order) {
         auto& levels = order->is_buy() ? bids_ : asks_;
         auto [it, inserted] = levels.try_emplace(order->price, order->price);
         it->second.push_back(order);
+        return aggregate(it->second);
+    }
+
+    static BookLevel aggregate(const PriceLevel& level) {
+        return {level.price(), level.total_quantity(), level.order_count()};
     }
 
     // ── Stop-order parking ──
     //
     // Buy stops trigger when last_trade_price_ >= stop_price (price rising
     // through the stop). Sell stops trigger when last_trade_price_ <=
-    // stop_price. We keep two ordered sets keyed by stop_price so the next
-    // order to release is always at one end.
+    // stop_price. StopBook buckets them by trigger tick, so the next order
+    // to release is always at the cached nearest bucket.
     void park_stop_order(Order* order) {
         order->status = OrderStatus::New;
-        if (order->is_buy()) {
-            buy_stops_.insert({order->stop_price, order});
-        } else {
-            sell_stops_.insert({order->stop_price, order});
-        }
+        stops_.park(order);
     }
 
-    void unpark_stop_order(Order* order) {
-        auto& set = order->is_buy() ? buy_stops_ : sell_stops_;
-        auto range = set.equal_range(order->stop_price);
-        for (auto it = range.first; it != range.second; ++it) {
-            if (it->second == order) {
-                set.erase(it);
-                return;
-            }
-        }
-    }
+    void unpark_stop_order(Order* order) { stops_.unpark(order); }
 
     // Activate any parked stop orders whose trigger has been crossed by the
     // most recent print. Triggered orders re-enter the book as Market (Stop)
@@ -504,31 +747,17 @@ private:
     // we use a re-entry guard to keep that bounded.
     void check_stop_triggers() {
         if (in_stop_check_) return;
+        // O(1): the nearest trigger on each side is cached, so a print that
+        // crosses neither costs two compares.
+        if (!stops_.triggered(last_trade_price_)) return;
         in_stop_check_ = true;
 
-        std::vector<Order*> to_release;
-
         while (true) {
-            to_release.clear();
+            stop_scratch_.clear();
+            stops_.collect(last_trade_price_, stop_scratch_);
+            if (stop_scratch_.empty()) break;
 
-            // Buy stops fire when last print >= stop_price (lowest stops first)
-            while (!buy_stops_.empty() &&
-                   buy_stops_.begin()->first <= last_trade_price_) {
-                to_release.push_back(buy_stops_.begin()->second);
-                buy_stops_.erase(buy_stops_.begin());
-            }
-            // Sell stops fire when last print <= stop_price (highest stops first)
-            while (!sell_stops_.empty() &&
-                   sell_stops_.rbegin()->first >= last_trade_price_ &&
-                   last_trade_price_ != 0) {
-                auto it = std::prev(sell_stops_.end());
-                to_release.push_back(it->second);
-                sell_stops_.erase(it);
-            }
-
-            if (to_release.empty()) break;
-
-            for (Order* o : to_release) {
+            for (Order* o : stop_scratch_) {
                 if (o->type == OrderType::Stop) {
                     o->type = OrderType::Market;
                     o->price = PRICE_MARKET;
@@ -545,13 +774,16 @@ private:
 
                 if (o->leaves_qty > 0) {
                     if (o->type == OrderType::Limit) {
-                        rest_order(o);
+                        const BookLevel lvl = rest_order(o);
+                        notify_order(*o);
+                        notify_level(o->side, lvl);
                     } else {
                         o->cancel(ts_);
                         order_index_.erase(o->id);
                         notify_order(*o);
                     }
                 } else {
+                    order_index_.erase(o->id);
                     notify_order(*o);
                 }
             }
@@ -560,22 +792,26 @@ private:
         in_stop_check_ = false;
     }
 
-    void remove_from_book(Order* order) {
+    BookLevel remove_from_book(Order* order) {
         auto& levels = order->is_buy() ? bids_ : asks_;
         auto it = levels.find(order->price);
-        if (it != levels.end()) {
-            it->second.remove(order);
-            if (it->second.empty()) {
-                levels.erase(it);
-            }
+        if (it == levels.end()) return {order->price, 0, 0};
+        it->second.remove(order);
+        const BookLevel after = aggregate(it->second);
+        if (it->second.empty()) {
+            levels.erase(it);
         }
+        return after;
     }
 
-    Quantity side_depth(const auto& side, size_t max_levels) const {
+    // Walks from the touch outward; an N-level depth must count the N best
+    // levels, so bids are passed as reverse iterators.
+    template <typename It>
+    Quantity side_depth(It first, It last, size_t max_levels) const {
         Quantity total = 0;
         size_t count = 0;
-        for (const auto& [price, level] : side) {
-            total += level.total_quantity();
+        for (; first != last; ++first) {
+            total += first->second.total_quantity();
             if (max_levels > 0 && ++count >= max_levels) break;
         }
         return total;
@@ -604,7 +840,7 @@ private:
     BidMap      bids_;
     AskMap      asks_;
 
-    std::unordered_map<OrderId, Order*> order_index_;
+    OrderIndex                          order_index_;
     ArenaAllocator<Order>               order_arena_;
 
     Timestamp ts_{};   // wall-clock captured once per inbound event (hot path)
@@ -616,21 +852,29 @@ private:
     uint64_t stop_triggered_count_ = 0;
     bool     in_stop_check_        = false;
 
-    // Buy stops keyed ascending: lowest stop_price triggers first.
-    // Sell stops keyed ascending: highest stop_price triggers first
-    // (we walk from rbegin in check_stop_triggers).
-    std::multimap<Price, Order*> buy_stops_;
-    std::multimap<Price, Order*> sell_stops_;
+    StopBook            stops_;          // parked Stop / StopLimit orders
+    std::vector<Order*> stop_scratch_;   // released stops, reused across passes
 
+    [[no_unique_address]] Sink sink_{};
     std::vector<TradeCallback> trade_listeners_;
     std::vector<OrderCallback> order_listeners_;
+    std::vector<LevelCallback> level_listeners_;
 
     void notify_trade(const Trade& t) {
+        probe::fill();
+        sink_.on_trade(*this, t);
         for (auto& cb : trade_listeners_) cb(t);
     }
     void notify_order(const Order& o) {
+        sink_.on_order(*this, o);
         for (auto& cb : order_listeners_) cb(o);
     }
+    void notify_level(Side side, const BookLevel& l) {
+        if constexpr (LevelSink<Sink, BasicOrderBook>) sink_.on_level(*this, side, l);
+        for (auto& cb : level_listeners_) cb(side, l);
+    }
 };
 
+using OrderBook = BasicOrderBook<>;
+
 } // namespace micro_exchange::core
@@ -0,0 +1,163 @@
+#pragma once
+
+#include "Order.h"
+
+#include <cstdint>
+#include <cstddef>
+#include <bit>
+#include <memory>
+
+namespace micro_exchange::core {
+
+/**
+ * OrderIndex — open-addressing OrderId → Order* map for the books.
+ *
+ * Replaces std::unordered_map on the cancel/amend path. One flat array of
+ * {id, Order*} slots, linear probing, capacity always a power of two:
+ *
+ *   • No per-insert node allocation — slots are reserved up front from
+ *     the configured order capacity, so steady-state churn never touches
+ *     malloc and never rehashes.
+ *   • A cancel is one multiply-shift hash and (usually) one cache line.
+ *   • Deletion is tombstone-free (backward-shift): the cluster after the
+ *     erased slot is compacted in place, so probe lengths don't degrade
+ *     under add/cancel churn the way tombstoned tables do.
+ *
+ * An empty slot is marked by a null Order*, so every OrderId (including
+ * 0) is a valid key. Growth (2x) only happens if the live count exceeds
+ * 3/4 of capacity — i.e. the configured capacity was too small.
+ */
+class OrderIndex {
+public:
+    explicit OrderIndex(size_t expected_orders = 65536) {
+        reserve(expected_orders);
+    }
+
+    OrderIndex(const OrderIndex&) = delete;
+    OrderIndex& operator=(const OrderIndex&) = delete;
+    OrderIndex(OrderIndex&&) noexcept = default;
+    OrderIndex& operator=(OrderIndex&&) noexcept = default;
+
+    /**
+     * Map `id` to `order`, replacing any existing mapping (same semantics as
+     * `unordered_map::operator[] =`).
+     */
+    void insert(OrderId id, Order* order) {
+        if ((size_ + 1) * 4 > capacity() * 3) [[unlikely]] {
+            rehash(capacity() * 2);
+        }
+        size_t i = slot_of(id);
+        while (slots_[i].order) {
+            if (slots_[i].id == id) { slots_[i].order = order; return; }
+            i = (i + 1) & mask_;
+        }
+        slots_[i] = Slot{id, order};
+        ++size_;
+    }
+
+    /// Order for `id`, or nullptr if not indexed.
+    [[nodiscard]] Order* find(OrderId id) const noexcept {
+        size_t i = slot_of(id);
+        while (slots_[i].order) {
+            if (slots_[i].id == id) return slots_[i].order;
+            i = (i + 1) & mask_;
+        }
+        return nullptr;
+    }
+
+    /// Pull the home slot of `id` into cache ahead of a find/insert/erase.
+    void prefetch(OrderId id) const noexcept {
+        __builtin_prefetch(&slots_[slot_of(id)]);
+    }
+
+    /// Remove `id`. Returns false if it was not indexed.
+    bool erase(OrderId id) noexcept {
+        size_t i = slot_of(id);
+        while (slots_[i].order) {
+            if (slots_[i].id == id) {
+                erase_slot(i);
+                return true;
+            }
+            i = (i + 1) & mask_;
+        }
+        return false;
+    }
+
+    /// Ensure `n` orders fit without growing.
+    void reserve(size_t n) {
+        size_t want = std::bit_ceil((n < 8 ? size_t{8} : n) * 4 / 3 + 1);
+        if (want > capacity()) rehash(want);
+    }
+
+    /// Visit every (id, Order*) pair in unspecified order.
+    template <typename Fn>
+    void for_each(Fn&& fn) const {
+        for (size_t i = 0; i < capacity(); ++i) {
+            if (slots_[i].order) fn(slots_[i].id, slots_[i].order);
+        }
+    }
+
+    void clear() noexcept {
+        for (size_t i = 0; i < capacity(); ++i) slots_[i] = Slot{};
+        size_ = 0;
+    }
+
+    [[nodiscard]] size_t size()     const noexcept { return size_; }
+    [[nodiscard]] bool   empty()    const noexcept { return size_ == 0; }
+    [[nodiscard]] size_t capacity() const noexcept { return slots_ ? mask_ + 1 : 0; }
+
+private:
+    struct Slot {
+        OrderId id    = 0;
+        Order*  order = nullptr;   // nullptr = empty
+    };
+
+    // Fibonacci hashing: sequential ids (the common case) spread evenly and
+    // the top bits are used, so the low-entropy low bits don't cluster.
+    [[nodiscard]] size_t slot_of(OrderId id) const noexcept {
+        return static_cast<size_t>((id * 0x9E3779B97F4A7C15ULL) >> shift_);
+    }
+
+    // Backward-shift deletion: pull later members of the cluster into the
+    // hole whenever their home slot does not lie in (hole, current].
+    void erase_slot(size_t hole) noexcept {
+        size_t i = hole;
+        for (;;) {
+            i = (i + 1) & mask_;
+            if (!slots_[i].order) break;
+            size_t home = slot_of(slots_[i].id);
+            // Movable iff its probe distance covers the hole (cyclic).
+            if (((i - home) & mask_) >= ((i - hole) & mask_)) {
+                slots_[hole] = slots_[i];
+                hole = i;
+            }
+        }
+        slots_[hole] = Slot{};
+        --size_;
+    }
+
+    void rehash(size_t new_capacity) {
+        size_t old_cap = capacity();
+        auto old       = std::move(slots_);
+
+        slots_ = std::make_unique<Slot[]>(new_capacity);
+        mask_  = new_capacity - 1;
+        shift_ = 64 - static_cast<unsigned>(std::countr_zero(new_capacity));
+        size_  = 0;
+
+        for (size_t i = 0; i < old_cap; ++i) {
+            if (!old[i].order) continue;
+            size_t j = slot_of(old[i].id);
+            while (slots_[j].order) j = (j + 1) & mask_;
+            slots_[j] = old[i];
+            ++size_;
+        }
+    }
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t                  mask_  = 0;
+    unsigned                shift_ = 64;
+    size_t                  size_  = 0;
+};
+
+} // namespace micro_exchange::core
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#if defined(__linux__) && __has_include(<linux/perf_event.h>)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define MICRO_EXCHANGE_HAS_PERF_EVENT 1
+#else
+#define MICRO_EXCHANGE_HAS_PERF_EVENT 0
+#endif
+
+namespace micro_exchange::core {
+
+/**
+ * PerfCounters — hardware counters for the calling thread, via perf_event_open.
+ *
+ * Counts cycles, retired instructions, last-level cache misses and branch
+ * misses between start() and stop(), user space only (what
+ * perf_event_paranoid ≤ 2 allows an unprivileged process). Each counter is
+ * opened on its own rather than as a group, so a PMU that lacks one event
+ * (or a VM that exposes none) still reports the rest; when the kernel
+ * multiplexes them the counts are scaled by enabled / running time.
+ *
+ * Nothing here is required: off Linux, in a container without a PMU, or
+ * with counters forbidden, every event is invalid and `available()` is
+ * false, with the reason in `error()`.
+ */
+class PerfCounters {
+public:
+    enum Event : size_t { Cycles, Instructions, CacheMisses, BranchMisses, EVENTS };
+
+    struct Reading {
+        std::array<uint64_t, EVENTS> value{};
+        std::array<bool, EVENTS>     valid{};
+
+        [[nodiscard]] bool any() const noexcept {
+            for (bool v : valid) if (v) return true;
+            return false;
+        }
+    };
+
+    static const char* name(Event e) noexcept {
+        static constexpr const char* names[EVENTS] = {"cycles", "instructions", "cache_misses", "branch_misses"};
+        return names[e];
+    }
+
+    PerfCounters() {
+#if MICRO_EXCHANGE_HAS_PERF_EVENT
+        static constexpr uint64_t configs[EVENTS] = {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+        for (size_t e = 0; e < EVENTS; ++e) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.type           = PERF_TYPE_HARDWARE;
+            attr.size           = sizeof(attr);
+            attr.config         = configs[e];
+            attr.disabled       = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv     = 1;
+            attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fd_[e] = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+            if (fd_[e] < 0 && error_.empty())
+                error_ = std::string("perf_event_open: ") + std::strerror(errno);
+        }
+        if (available()) error_.clear();
+#else
+        error_ = "perf_event not supported on this platform";
+#endif
+    }
+
+    ~PerfCounters() {
+#if MICRO_EXCHANGE_HAS_PERF_EVENT
+        for (int fd : fd_) if (fd >= 0) ::close(fd);
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    [[nodiscard]] bool available() const noexcept {
+        for (int fd : fd_) if (fd >= 0) return true;
+        return false;
+    }
+    [[nodiscard]] const std::string& error() const noexcept { return error_; }
+
+    void start() noexcept {
+#if MICRO_EXCHANGE_HAS_PERF_EVENT
+        for (int fd : fd_) {
+            if (fd < 0) continue;
+            ::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    Reading stop() noexcept {
+        Reading r;
+#if MICRO_EXCHANGE_HAS_PERF_EVENT
+        for (int fd : fd_) if (fd >= 0) ::ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        for (size_t e = 0; e < EVENTS; ++e) {
+            if (fd_[e] < 0) continue;
+            uint64_t buf[3] = {};   // value, time enabled, time running
+            if (::read(fd_[e], buf, sizeof(buf)) != static_cast<ssize_t>(sizeof(buf)) || buf[2] == 0) continue;
+            r.value[e] = buf[2] < buf[1]
+                ? static_cast<uint64_t>(static_cast<double>(buf[0]) * static_cast<double>(buf[1]) / static_cast<double>(buf[2]))
+                : buf[0];
+            r.valid[e] = true;
+        }
+#endif
+        return r;
+    }
+
+private:
+    std::array<int, EVENTS> fd_{-1, -1, -1, -1};
+    std::string             error_;
+};
+
+} // namespace micro_exchange::core
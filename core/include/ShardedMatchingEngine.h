@@ -0,0 +1,419 @@
+#pragma once
+
+#include "Order.h"
+#include "BookConcept.h"
+#include "MatchingEngine.h"
+#include "SPSCRingBuffer.h"
+#include "MPSCRingBuffer.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace micro_exchange::core {
+
+// ─────────────────────────────────────────────
+// Shard wire types (what travels over the rings)
+// ─────────────────────────────────────────────
+
+struct ShardCommand {
+    enum class Kind : uint8_t { New, Cancel, Amend };
+
+    Kind kind = Kind::New;
+    union {
+        NewOrderRequest new_order;
+        CancelRequest   cancel;
+        AmendRequest    amend;
+    };
+
+    ShardCommand() : new_order{} {}
+};
+
+/// Order-state change as published by a shard (the feed-relevant fields).
+struct OrderEvent {
+    OrderId     id         = 0;
+    Price       price      = 0;
+    Quantity    leaves_qty = 0;
+    Quantity    filled_qty = 0;
+    Side        side       = Side::Buy;
+    OrderStatus status     = OrderStatus::New;
+};
+
+struct ShardEvent {
+    enum class Kind : uint8_t { Trade, Order };
+
+    Kind     kind       = Kind::Trade;
+    SymbolId symbol_id  = SYMBOL_ID_NONE;  // global id (ShardedMatchingEngine::symbol_id)
+    SeqNum   symbol_seq = 0;               // 1, 2, 3, ... per symbol, trades + order events
+    union {
+        Trade      trade;
+        OrderEvent order;
+    };
+
+    ShardEvent() : trade{} {}
+};
+
+/**
+ * ShardedMatchingEngine — symbols partitioned across N pinned matching threads.
+ *
+ * This is threading model 2 from MatchingEngine.h ("one book per thread"):
+ *
+ *   [callers] ──MPSC──▶ shard 0: BasicMatchingEngine<Book> ──SPSC──▶ [poll()]
+ *             ──MPSC──▶ shard 1: BasicMatchingEngine<Book> ──SPSC──▶
+ *             ...
+ *
+ * Each symbol is owned by exactly one shard (round-robin in add_symbol
+ * order), and each shard is an ordinary single-threaded engine, so per-symbol
+ * matching is untouched: the trade and order-event stream of any one symbol
+ * is identical to a single-threaded engine fed the same requests in the same
+ * order. Events carry the symbol's global id and a per-symbol sequence number
+ * so a consumer can merge shard outputs deterministically.
+ *
+ * Threading contract:
+ *   • add_symbol() only before start().
+ *   • submit/cancel/amend from any number of producer threads (say one per
+ *     gateway session): the input rings are MPSC. Each producer's requests
+ *     keep their order; requests from different producers interleave, so
+ *     the per-symbol determinism above holds for any one producer's order.
+ *   • poll() from ONE consumer thread (may be the producer). Shards block
+ *     when their output ring is full, so somebody must keep polling. A
+ *     thread that is both producer and consumer must submit through the
+ *     overloads taking a handler: the plain ones spin while the input ring
+ *     is full, and with nobody polling the shard never drains it.
+ *   • wait_idle() returns once every submitted command has been processed;
+ *     get_stats()/get_book() are safe after wait_idle() or stop().
+ *
+ * Pinning: worker i is pinned to core (first_core + i) % hardware threads on
+ * Linux when Config::pin_threads is set; elsewhere pinning is a no-op.
+ */
+template <OrderBookLike Book = OrderBook>
+class BasicShardedMatchingEngine {
+public:
+    static constexpr size_t INPUT_RING  = 1 << 14;
+    static constexpr size_t OUTPUT_RING = 1 << 16;
+
+    struct Config {
+        size_t   num_shards  = 1;
+        bool     pin_threads = true;
+        unsigned first_core  = 0;
+    };
+
+    explicit BasicShardedMatchingEngine(Config cfg = {})
+        : cfg_(cfg)
+    {
+        if (cfg_.num_shards == 0) throw std::invalid_argument("num_shards must be > 0");
+        for (size_t i = 0; i < cfg_.num_shards; ++i) {
+            shards_.push_back(std::make_unique<Shard>());
+        }
+    }
+
+    ~BasicShardedMatchingEngine() { stop(); }
+
+    BasicShardedMatchingEngine(const BasicShardedMatchingEngine&) = delete;
+    BasicShardedMatchingEngine& operator=(const BasicShardedMatchingEngine&) = delete;
+
+    // ═══════════════════════════════════════════
+    // Setup
+    // ═══════════════════════════════════════════
+
+    /**
+     * Register a symbol on the next shard (round-robin). Returns its global
+     * SymbolId. Idempotent. Must be called before start().
+     */
+    template <typename... BookArgs>
+    SymbolId add_symbol(const std::string& symbol, BookArgs&&... book_args) {
+        if (running_) throw std::logic_error("add_symbol after start()");
+        if (SymbolId id = symbol_id(symbol); id != SYMBOL_ID_NONE) return id;
+
+        const auto gid   = static_cast<SymbolId>(routes_.size() + 1);
+        const auto shard = static_cast<uint32_t>(routes_.size() % shards_.size());
+        Shard& s = *shards_[shard];
+
+        Book& book = s.engine.add_symbol(symbol, std::forward<BookArgs>(book_args)...);
+        const SymbolId local = s.engine.symbol_id(symbol);
+        s.symbol_seq.resize(local + 1, 0);
+
+        book.add_trade_listener([&s, gid, local](const Trade& t) {
+            ShardEvent e;
+            e.kind       = ShardEvent::Kind::Trade;
+            e.symbol_id  = gid;
+            e.symbol_seq = ++s.symbol_seq[local];
+            e.trade      = t;
+            s.emit(e);
+        });
+        book.add_order_listener([&s, gid, local](const Order& o) {
+            ShardEvent e;
+            e.kind       = ShardEvent::Kind::Order;
+            e.symbol_id  = gid;
+            e.symbol_seq = ++s.symbol_seq[local];
+            e.order      = OrderEvent{o.id, o.price, o.leaves_qty, o.filled_qty, o.side, o.status};
+            s.emit(e);
+        });
+
+        routes_.push_back(Route{shard, local});
+        symbol_ids_.emplace(symbol, gid);
+        return gid;
+    }
+
+    [[nodiscard]] SymbolId symbol_id(std::string_view symbol) const {
+        auto it = symbol_ids_.find(symbol);
+        return (it != symbol_ids_.end()) ? it->second : SYMBOL_ID_NONE;
+    }
+
+    /// Shard that owns a symbol (for tests and placement diagnostics).
+    [[nodiscard]] size_t shard_of(SymbolId id) const { return routes_.at(id - 1).shard; }
+
+    void start() {
+        if (running_) return;
+        running_ = true;
+        for (size_t i = 0; i < shards_.size(); ++i) {
+            Shard& s = *shards_[i];
+            s.stop.store(false, std::memory_order_relaxed);
+            s.worker = std::thread([&s] { s.run(); });
+            if (cfg_.pin_threads) pin(s.worker, i);
+        }
+    }
+
+    /**
+     * Process everything already submitted, then join the workers. Output not
+     * yet polled is discarded — call wait_idle(handler) first to keep it.
+     */
+    void stop() {
+        if (!running_) return;
+        wait_idle();
+        for (auto& s : shards_) s->stop.store(true, std::memory_order_release);
+        for (auto& s : shards_) if (s->worker.joinable()) s->worker.join();
+        running_ = false;
+    }
+
+    // ═══════════════════════════════════════════
+    // Order entry (any number of producers)
+    // ═══════════════════════════════════════════
+
+    bool submit_order(const NewOrderRequest& req) {
+        return submit_order(req, yield_while_full);
+    }
+
+    bool cancel_order(const CancelRequest& req) {
+        return cancel_order(req, yield_while_full);
+    }
+
+    bool amend_order(const AmendRequest& req) {
+        return amend_order(req, yield_while_full);
+    }
+
+    /**
+     * For the consumer thread: while the owning shard's input ring is full,
+     * pass that shard's output to `handler(const ShardEvent&)` (as poll()
+     * would) instead of spinning, so a shard stalled on its output ring can
+     * make room. Returns false only for an unknown symbol, like the above.
+     */
+    template <typename Handler>
+    bool submit_order(const NewOrderRequest& req, Handler&& handler) {
+        ShardCommand c;
+        c.kind      = ShardCommand::Kind::New;
+        c.new_order = req;
+        return dispatch(c, c.new_order, handler);
+    }
+
+    template <typename Handler>
+    bool cancel_order(const CancelRequest& req, Handler&& handler) {
+        ShardCommand c;
+        c.kind   = ShardCommand::Kind::Cancel;
+        c.cancel = req;
+        return dispatch(c, c.cancel, handler);
+    }
+
+    template <typename Handler>
+    bool amend_order(const AmendRequest& req, Handler&& handler) {
+        ShardCommand c;
+        c.kind  = ShardCommand::Kind::Amend;
+        c.amend = req;
+        return dispatch(c, c.amend, handler);
+    }
+
+    // ═══════════════════════════════════════════
+    // Output (single consumer)
+    // ═══════════════════════════════════════════
+
+    /**
+     * Drain every shard's output ring into `handler(const ShardEvent&)`.
+     * Returns the number of events delivered. Events of one symbol arrive in
+     * symbol_seq order; events of different shards are not ordered.
+     */
+    template <typename Handler>
+    size_t poll(Handler&& handler) {
+        size_t n = 0;
+        for (auto& s : shards_) {
+            while (size_t got = s->out.consume(handler, 256)) n += got;
+        }
+        return n;
+    }
+
+    /**
+     * Block until every command submitted so far has been processed, passing
+     * any output produced meanwhile to `handler` so shards can't stall on a
+     * full output ring.
+     */
+    template <typename Handler>
+    void wait_idle(Handler&& handler) {
+        for (;;) {
+            bool idle = true;
+            for (auto& s : shards_) {
+                if (s->processed.load(std::memory_order_acquire)
+                    != s->submitted.load(std::memory_order_acquire)) idle = false;
+            }
+            poll(handler);
+            if (idle) return;
+            std::this_thread::yield();
+        }
+    }
+
+    void wait_idle() { wait_idle([](const ShardEvent&) {}); }
+
+    // ═══════════════════════════════════════════
+    // Statistics (after wait_idle() / stop())
+    // ═══════════════════════════════════════════
+
+    [[nodiscard]] EngineStats get_stats() const {
+        EngineStats s{};
+        for (const auto& sh : shards_) {
+            EngineStats e = sh->engine.get_stats();
+            s.total_orders   += e.total_orders;
+            s.total_cancels  += e.total_cancels;
+            s.total_amends   += e.total_amends;
+            s.total_trades   += e.total_trades;
+            s.total_volume   += e.total_volume;
+            s.total_rejects  += e.total_rejects;
+            s.active_orders  += e.active_orders;
+            s.symbols_active += e.symbols_active;
+            s.arena_allocated  += e.arena_allocated;
+            s.arena_capacity   += e.arena_capacity;
+            s.arena_slabs      += e.arena_slabs;
+            s.arena_bytes      += e.arena_bytes;
+            s.arena_huge_slabs += e.arena_huge_slabs;
+        }
+        s.total_rejects += front_rejects_.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    [[nodiscard]] Book* get_book(SymbolId id) {
+        if (id - 1 >= routes_.size()) return nullptr;
+        const Route& r = routes_[id - 1];
+        return shards_[r.shard]->engine.get_book(r.local);
+    }
+
+    [[nodiscard]] size_t num_shards() const { return shards_.size(); }
+
+private:
+    struct Route {
+        uint32_t shard;
+        SymbolId local;   // id inside the shard's own engine
+    };
+
+    struct Shard {
+        BasicMatchingEngine<Book>                        engine;
+        md::MPSCRingBuffer<ShardCommand, INPUT_RING>     in;
+        md::SPSCRingBuffer<ShardEvent, OUTPUT_RING>      out;
+        std::vector<SeqNum>                              symbol_seq;  // by local id
+        std::thread                                      worker;
+        std::atomic<bool>                                stop{false};
+        alignas(64) std::atomic<uint64_t>                processed{0};
+        alignas(64) std::atomic<uint64_t>                submitted{0};   // producers
+
+        void emit(const ShardEvent& e) {
+            while (!out.push(e)) std::this_thread::yield();   // back-pressure
+        }
+
+        void run() {
+            uint64_t done = processed.load(std::memory_order_relaxed);
+            unsigned idle = 0;
+            for (;;) {
+                // Commands are read in place, and `processed` is published
+                // once per batch rather than per command.
+                const size_t got = in.consume([&](const ShardCommand& c) {
+                    switch (c.kind) {
+                        case ShardCommand::Kind::New:    engine.submit_order(c.new_order); break;
+                        case ShardCommand::Kind::Cancel: engine.cancel_order(c.cancel);    break;
+                        case ShardCommand::Kind::Amend:  engine.amend_order(c.amend);      break;
+                    }
+                }, 64);
+                if (got) {
+                    idle = 0;
+                    processed.store(done += got, std::memory_order_release);
+                    continue;
+                }
+                if (stop.load(std::memory_order_acquire) && in.empty()) return;
+                // Spin briefly for latency, then give the core away.
+                if (++idle > 64) std::this_thread::yield();
+            }
+        }
+    };
+
+    // Marks the plain producer overloads: nothing to drain, just yield.
+    struct YieldWhileFull {};
+    static constexpr YieldWhileFull yield_while_full{};
+
+    // Resolve the global symbol on the producer side, rewrite it to the
+    // owning shard's local id, and enqueue. While the ring is full, drain the
+    // shard's output into `handler`, or just yield for the plain overloads.
+    template <typename Req, typename Handler>
+    bool dispatch(ShardCommand& c, Req& req, Handler& handler) {
+        SymbolId gid = req.symbol_id;
+        if (gid - 1 >= routes_.size()) {
+            gid = symbol_id(std::string_view(req.symbol, ::strnlen(req.symbol, sizeof(req.symbol))));
+            if (gid == SYMBOL_ID_NONE) {
+                front_rejects_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        const Route& r = routes_[gid - 1];
+        req.symbol_id = r.local;
+
+        Shard& s = *shards_[r.shard];
+        s.submitted.fetch_add(1, std::memory_order_relaxed);
+        while (!s.in.push(c)) {
+            if constexpr (std::is_same_v<std::decay_t<Handler>, YieldWhileFull>) {
+                std::this_thread::yield();
+            } else if (!s.out.consume(handler, 256)) {
+                std::this_thread::yield();
+            }
+        }
+        return true;
+    }
+
+    void pin([[maybe_unused]] std::thread& t, [[maybe_unused]] size_t shard) const {
+#ifdef __linux__
+        unsigned n = std::thread::hardware_concurrency();
+        if (n == 0) return;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET((cfg_.first_core + shard) % n, &set);
+        pthread_setaffinity_np(t.native_handle(), sizeof(set), &set);
+#endif
+    }
+
+    Config                                    cfg_;
+    std::vector<std::unique_ptr<Shard>>       shards_;
+    std::vector<Route>                        routes_;      // global id - 1 → route
+    std::unordered_map<std::string, SymbolId, SymbolHash, std::equal_to<>> symbol_ids_;
+    std::atomic<uint64_t>                     front_rejects_{0};
+    bool                                      running_       = false;
+};
+
+using ShardedMatchingEngine = BasicShardedMatchingEngine<OrderBook>;
+
+} // namespace micro_exchange::core
@@ -0,0 +1,317 @@
+#pragma once
+
+#include "Order.h"
+
+#include <cstdint>
+#include <cstddef>
+#include <iterator>
+#include <map>
+#include <vector>
+
+namespace micro_exchange::core {
+
+/**
+ * StopLadder — one side of the parked-stop book.
+ *
+ * Stops are bucketed by trigger price in a tick-indexed array (one bucket
+ * per tick over a band) with an occupancy bitmap, the same layout as
+ * ArrayOrderBook's price levels. Each bucket is a FIFO of parked orders
+ * linked through Order::prev/next — a parked stop is in no price level, so
+ * those pointers are free — which makes park/unpark O(1) and allocation-free.
+ *
+ * `LowFirst` picks the direction: buy stops fire when the last print rises
+ * to their trigger, so the lowest trigger is nearest; sell stops fire on the
+ * way down, so the highest is. The nearest trigger is kept as a bucket index
+ * so "can anything fire at this print?" is one compare.
+ *
+ * The band is rebuilt around the occupied buckets when a stop lands outside
+ * it (O(band), amortised like ArrayOrderBook::recenter). A stop so far from
+ * the rest that the band would exceed MAX_BAND ticks is kept in a small
+ * ordered overflow map instead, so an outlier trigger can't allocate a
+ * gigantic array; it migrates into the band if a later rebuild covers it.
+ */
+template <bool LowFirst>
+class StopLadder {
+public:
+    static constexpr size_t MIN_BAND = 256;
+    static constexpr size_t MAX_BAND = size_t{1} << 18;
+
+    /// Append `o` behind any stop already parked at its trigger price.
+    void push(Order* o) {
+        const Price p = o->stop_price;
+        ++size_;
+        if (!in_band(p) && !rebuild_for(p)) {
+            far_.emplace(p, o);
+            return;
+        }
+        link(idx(p), o);
+    }
+
+    /// Remove a parked `o` from wherever it sits in its bucket.
+    void remove(Order* o) {
+        const Price p = o->stop_price;
+        if (!in_band(p)) {
+            auto range = far_.equal_range(p);
+            for (auto it = range.first; it != range.second; ++it) {
+                if (it->second == o) { far_.erase(it); --size_; return; }
+            }
+            return;
+        }
+        const size_t i = idx(p);
+        Bucket& b = buckets_[i];
+        if (o->prev) o->prev->next = o->next; else b.head = o->next;
+        if (o->next) o->next->prev = o->prev; else b.tail = o->prev;
+        o->prev = o->next = nullptr;
+        --size_;
+        --band_count_;
+        if (!b.head) {
+            clr_occ(i);
+            if (static_cast<long>(i) == best_) best_ = step_best(best_);
+        }
+    }
+
+    [[nodiscard]] size_t size()  const noexcept { return size_; }
+    [[nodiscard]] bool   empty() const noexcept { return size_ == 0; }
+
+    /// Trigger price that fires first. Only meaningful when !empty().
+    [[nodiscard]] Price nearest() const noexcept {
+        Price n = band_count_ ? base_ + best_ : far_nearest();
+        if (band_count_ && !far_.empty()) {
+            Price f = far_nearest();
+            n = LowFirst ? (f < n ? f : n) : (f > n ? f : n);
+        }
+        return n;
+    }
+
+    /// True if a print at `last` fires at least one stop on this side.
+    [[nodiscard]] bool crossed_by(Price last) const noexcept {
+        return size_ != 0 && crosses(nearest(), last);
+    }
+
+    /**
+     * Unlink every stop a print at `last` fires and append it to `out`:
+     * nearest trigger first, FIFO (time priority) within a trigger price.
+     */
+    void release(Price last, std::vector<Order*>& out) {
+        while (size_ != 0) {
+            const Price p = nearest();
+            if (!crosses(p, last)) break;
+            if (band_count_ && base_ + best_ == p) {
+                Bucket& b = buckets_[static_cast<size_t>(best_)];
+                for (Order* o = b.head; o;) {
+                    Order* next = o->next;
+                    o->prev = o->next = nullptr;
+                    out.push_back(o);
+                    --size_;
+                    --band_count_;
+                    o = next;
+                }
+                b = Bucket{};
+                clr_occ(static_cast<size_t>(best_));
+                best_ = step_best(best_);
+            } else {
+                auto range = far_.equal_range(p);
+                for (auto it = range.first; it != range.second; ++it) out.push_back(it->second);
+                size_ -= static_cast<size_t>(std::distance(range.first, range.second));
+                far_.erase(range.first, range.second);
+            }
+        }
+    }
+
+    /**
+     * Visit every parked stop in release order without unlinking it:
+     * nearest trigger first, FIFO within a trigger price. Overflow stops
+     * never overlap the band, so they come before or after it whole.
+     */
+    template <typename F>
+    void for_each(F&& fn) const {
+        const auto split = far_.lower_bound(base_);   // [begin, split) lies below the band
+        if constexpr (LowFirst) {
+            for (auto it = far_.begin(); it != split; ++it) fn(*it->second);
+            for_each_in_band(fn);
+            for (auto it = split; it != far_.end(); ++it) fn(*it->second);
+        } else {
+            for_each_far_desc(split, far_.end(), fn);
+            for_each_in_band(fn);
+            for_each_far_desc(far_.begin(), split, fn);
+        }
+    }
+
+private:
+    using FarMap = std::multimap<Price, Order*>;
+
+    template <typename F>
+    void for_each_in_band(F& fn) const {
+        if (!band_count_) return;
+        const long n = static_cast<long>(buckets_.size());
+        for (long i = best_; i >= 0 && i < n; i = step_best(i)) {
+            for (const Order* o = buckets_[static_cast<size_t>(i)].head; o; o = o->next) fn(*o);
+        }
+    }
+
+    // Highest trigger first, but arrival order within one trigger price.
+    template <typename F>
+    static void for_each_far_desc(FarMap::const_iterator first, FarMap::const_iterator last, F& fn) {
+        while (last != first) {
+            const auto lo = std::prev(last);
+            auto run = lo;
+            while (run != first && std::prev(run)->first == lo->first) --run;
+            for (auto it = run; it != last; ++it) fn(*it->second);
+            last = run;
+        }
+    }
+
+    struct Bucket {
+        Order* head = nullptr;
+        Order* tail = nullptr;
+    };
+
+    // A stop at trigger `p` fires on a print at `last`.
+    [[nodiscard]] static bool crosses(Price p, Price last) noexcept {
+        return LowFirst ? p <= last : p >= last;
+    }
+
+    // Unsigned offset so prices below base_ wrap out of range instead of
+    // overflowing a signed subtraction.
+    [[nodiscard]] uint64_t offset(Price p) const noexcept {
+        return static_cast<uint64_t>(p) - static_cast<uint64_t>(base_);
+    }
+    [[nodiscard]] bool   in_band(Price p) const noexcept { return offset(p) < buckets_.size(); }
+    [[nodiscard]] size_t idx(Price p)     const noexcept { return static_cast<size_t>(offset(p)); }
+
+    [[nodiscard]] Price far_nearest() const noexcept {
+        return LowFirst ? far_.begin()->first : far_.rbegin()->first;
+    }
+
+    void link(size_t i, Order* o) {
+        Bucket& b = buckets_[i];
+        o->next = nullptr;
+        o->prev = b.tail;
+        if (b.tail) b.tail->next = o;
+        else        { b.head = o; set_occ(i); }
+        b.tail = o;
+        const long li = static_cast<long>(i);
+        if (band_count_++ == 0 || (LowFirst ? li < best_ : li > best_)) best_ = li;
+    }
+
+    void set_occ(size_t i) { occ_[i >> 6] |=  (1ULL << (i & 63)); }
+    void clr_occ(size_t i) { occ_[i >> 6] &= ~(1ULL << (i & 63)); }
+
+    // Next occupied bucket after `i` in release order, or out of range.
+    [[nodiscard]] long step_best(long i) const noexcept {
+        return LowFirst ? next_occ_ge(i + 1) : next_occ_le(i - 1);
+    }
+
+    [[nodiscard]] long next_occ_ge(long i) const noexcept {
+        const long n = static_cast<long>(buckets_.size());
+        if (i >= n) return n;
+        size_t w = static_cast<size_t>(i) >> 6;
+        uint64_t word = occ_[w] & (~0ULL << (i & 63));
+        while (!word) {
+            if (++w == occ_.size()) return n;
+            word = occ_[w];
+        }
+        return static_cast<long>(w << 6) + __builtin_ctzll(word);
+    }
+
+    [[nodiscard]] long next_occ_le(long i) const noexcept {
+        if (i < 0) return -1;
+        long w = i >> 6;
+        const unsigned b = static_cast<unsigned>(i & 63);
+        uint64_t word = occ_[static_cast<size_t>(w)] & (b == 63 ? ~0ULL : ((1ULL << (b + 1)) - 1));
+        while (!word) {
+            if (--w < 0) return -1;
+            word = occ_[static_cast<size_t>(w)];
+        }
+        return (w << 6) + (63 - __builtin_clzll(word));
+    }
+
+    // Re-place the band so it covers `p` and every occupied bucket. Returns
+    // false (band untouched) if that would need more than MAX_BAND ticks.
+    bool rebuild_for(Price p) {
+        Price lo = p, hi = p;
+        if (band_count_) {
+            const Price occ_lo = base_ + next_occ_ge(0);
+            const Price occ_hi = base_ + next_occ_le(static_cast<long>(buckets_.size()) - 1);
+            lo = occ_lo < p ? occ_lo : p;
+            hi = occ_hi > p ? occ_hi : p;
+        }
+        const uint64_t span = static_cast<uint64_t>(hi) - static_cast<uint64_t>(lo) + 1;
+        if (span > MAX_BAND / 2) return false;
+
+        size_t width = buckets_.empty() ? MIN_BAND : buckets_.size();
+        while (width < 2 * span) width *= 2;
+        const Price new_base = lo - static_cast<Price>((width - span) / 2);
+
+        std::vector<Bucket>   buckets(width);
+        std::vector<uint64_t> occ((width + 63) / 64, 0ULL);
+        long best = -1;
+        for (long i = band_count_ ? next_occ_ge(0) : static_cast<long>(buckets_.size());
+             i < static_cast<long>(buckets_.size()); i = next_occ_ge(i + 1)) {
+            const size_t j = static_cast<size_t>(base_ + i - new_base);
+            buckets[j] = buckets_[static_cast<size_t>(i)];
+            occ[j >> 6] |= 1ULL << (j & 63);
+            const long lj = static_cast<long>(j);
+            if (best < 0 || (LowFirst ? lj < best : lj > best)) best = lj;
+        }
+        buckets_.swap(buckets);
+        occ_.swap(occ);
+        base_ = new_base;
+        best_ = best;
+
+        // Overflow stops the new band now covers move in, keeping FIFO order.
+        for (auto it = far_.lower_bound(base_); it != far_.end() && in_band(it->first);) {
+            link(idx(it->first), it->second);
+            it = far_.erase(it);
+        }
+        return true;
+    }
+
+    std::vector<Bucket>   buckets_;
+    std::vector<uint64_t> occ_;              // occupied-bucket bitmap (1 bit / tick)
+    Price  base_       = 0;                  // trigger price of buckets_[0]
+    long   best_       = -1;                 // nearest occupied bucket, if band_count_
+    size_t band_count_ = 0;                  // stops in buckets_
+    size_t size_       = 0;                  // band_count_ + far_.size()
+    FarMap far_;                             // outliers beyond MAX_BAND
+};
+
+/**
+ * StopBook — parked Stop / StopLimit orders for one book.
+ *
+ * Buy stops trigger when the last print >= stop_price, sell stops when it is
+ * <= stop_price (and non-zero: no print yet means no sell trigger).
+ * `triggered(last)` is the O(1) pre-check run after every aggressive order;
+ * `collect(last, out)` unlinks everything that fired — buys nearest-first,
+ * then sells nearest-first, FIFO within a trigger price — into the caller's
+ * reusable scratch vector.
+ */
+class StopBook {
+public:
+    void park(Order* o)   { if (o->is_buy()) buy_.push(o);   else sell_.push(o); }
+    void unpark(Order* o) { if (o->is_buy()) buy_.remove(o); else sell_.remove(o); }
+
+    [[nodiscard]] size_t size() const noexcept { return buy_.size() + sell_.size(); }
+
+    [[nodiscard]] bool triggered(Price last) const noexcept {
+        return buy_.crossed_by(last) || (last != 0 && sell_.crossed_by(last));
+    }
+
+    void collect(Price last, std::vector<Order*>& out) {
+        buy_.release(last, out);
+        if (last != 0) sell_.release(last, out);
+    }
+
+    /// Visit every parked stop: buys, then sells, each in release order.
+    template <typename F>
+    void for_each(F&& fn) const {
+        buy_.for_each(fn);
+        sell_.for_each(fn);
+    }
+
+private:
+    StopLadder<true>  buy_;
+    StopLadder<false> sell_;
+};
+
+} // namespace micro_exchange::core
@@ -19,7 +19,24 @@
 
 #include "../include/MatchingEngine.h"
 #include "../include/OrderBook.h"
+#include "../include/ArrayOrderBook.h"
 #include "../include/Order.h"
+#include "../include/OrderIndex.h"
+#include "../include/StopBook.h"
+#include "../include/CompactOrder.h"
+#include "../include/BookCheckpoint.h"
+#include "../include/EventSink.h"
+#include "../include/ShardedMatchingEngine.h"
+#include "../include/LatencyRecorder.h"
+#include "../../md/include/FeedPublisher.h"
+#include "../../md/include/FeedRecovery.h"
+#include "../../md/include/DepthBook.h"
+#include "../../md/include/MPSCRingBuffer.h"
+#include "../../sim/include/SimulationBatch.h"
+#include "../../sim/include/MultiSymbolSimulator.h"
+#include "../../analytics/include/OnlineAnalytics.h"
+#include "../../analytics/include/SeriesKernels.h"
+#include "../../analytics/include/StylizedFacts.h"
 
 #include <cassert>
 #include <iostream>
@@ -27,6 +44,19 @@
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <unordered_map>
+#include <tuple>
+#include <array>
+#include <optional>
+#include <memory>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <type_traits>
+#include <limits>
 
 using namespace micro_exchange::core;
 
@@ -343,7 +373,8 @@ void test_fuzz_random_sequence() {
 
 namespace {
 
-void seed_two_sided_book(OrderBook& book) {
+template <class Book>
+void seed_two_sided_book(Book& book) {
     // Ten levels each side around 10000
     OrderId id = 1;
     for (int lvl = 1; lvl <= 10; ++lvl) {
@@ -491,10 +522,2119 @@ void test_multi_listener_fanout() {
     std::cout << "PASSED (" << trades_a << " trades broadcast to 2 listeners)\n";
 }
 
+// ─────────────────────────────────────────────
+// Test 9: ArrayOrderBook parity (stops, amend, band re-centering)
+// ─────────────────────────────────────────────
+
+void test_array_book_stops_and_amend() {
+    std::cout << "TEST: ArrayOrderBook stops + amend parity... ";
+
+    ArrayOrderBook book("TEST", 9900, 10100);
+    seed_two_sided_book(book);
+
+    // Same scenario as test_stop_market_triggers.
+    book.add_order(mk(1000, Side::Buy, OrderType::Stop, 0, 200, 10005));
+    assert(book.parked_stop_count() == 1);
+    book.add_order(mk(1001, Side::Buy, OrderType::Market, PRICE_MARKET, 1500));
+    book.add_order(mk(1010, Side::Buy, OrderType::Market, PRICE_MARKET, 1100));
+    assert(book.last_trade_price() >= 10005);
+    assert(book.parked_stop_count() == 0);
+    assert(book.stop_triggered_count() == 1);
+
+    // StopLimit rests at its limit once triggered.
+    book.add_order(mk(1100, Side::Sell, OrderType::StopLimit, 9998, 200, 9998));
+    book.add_order(mk(1101, Side::Sell, OrderType::Market, PRICE_MARKET, 1000));
+    assert(book.stop_triggered_count() == 2);
+    assert(book.check_no_crossed_book());
+
+    // Size-down keeps priority; price change re-queues at the new level.
+    book.add_order(mk(1200, Side::Buy, OrderType::Limit, 9995, 500));
+    book.add_order(mk(1201, Side::Buy, OrderType::Limit, 9995, 100));
+    AmendRequest down{};
+    down.order_id = 1200;
+    down.new_quantity = 300;
+    bool ok = book.amend_order(down);
+    assert(ok);
+    auto bids = book.get_bids(20);
+    auto lvl = std::find_if(bids.begin(), bids.end(),
+                            [](const BookLevel& l) { return l.price == 9995; });
+    assert(lvl != bids.end() && lvl->quantity == 500 + 300 + 100);
+    (void)lvl;
+
+    AmendRequest move{};
+    move.order_id = 1201;
+    move.new_price = 9994;
+    ok = book.amend_order(move);
+    assert(ok);
+    assert(book.check_fifo_invariant());
+
+    // Parked stop cancel.
+    book.add_order(mk(1300, Side::Buy, OrderType::Stop, 0, 100, 20000));
+    ok = book.cancel_order(1300);
+    (void)ok;
+    assert(ok);
+    assert(book.parked_stop_count() == 0);
+
+    std::cout << "PASSED\n";
+}
+
+void test_array_book_recenter() {
+    std::cout << "TEST: ArrayOrderBook band re-centering... ";
+
+    // Deliberately tiny band so drift forces re-centering several times.
+    ArrayOrderBook arr("TEST", 9990, 10010);
+    OrderBook      ref("TEST");
+
+    std::vector<Trade> at, rt;
+    arr.add_trade_listener([&](const Trade& t) { at.push_back(t); });
+    ref.add_trade_listener([&](const Trade& t) { rt.push_back(t); });
+
+    std::mt19937_64 rng(2024);
+    std::uniform_int_distribution<int> step(-3, 4);   // upward drift
+    Price mid = 10000;
+    for (OrderId id = 1; id <= 20000; ++id) {
+        mid += (id % 16 == 0) ? step(rng) : 0;
+        Side side = (rng() % 2) ? Side::Buy : Side::Sell;
+        bool mkt = rng() % 6 == 0;
+        Price px = side == Side::Buy ? mid - Price(rng() % 8) : mid + Price(rng() % 8);
+        auto req = mkt ? mk(id, side, OrderType::Market, PRICE_MARKET, 100)
+                       : mk(id, side, OrderType::Limit, px, 100 * (1 + rng() % 5));
+        arr.add_order(req);
+        ref.add_order(req);
+        if (id % 7 == 0) { arr.cancel_order(id - 3); ref.cancel_order(id - 3); }
+        assert(arr.check_no_crossed_book());
+    }
+
+    assert(arr.recenter_count() > 0 && "drift should have forced a re-center");
+    assert(at.size() == rt.size());
+    for (size_t i = 0; i < at.size(); ++i) {
+        assert(at[i].buy_order_id == rt[i].buy_order_id);
+        assert(at[i].sell_order_id == rt[i].sell_order_id);
+        assert(at[i].price == rt[i].price && at[i].quantity == rt[i].quantity);
+    }
+    assert(arr.best_bid() == ref.best_bid() && arr.best_ask() == ref.best_ask());
+    assert(arr.bid_depth(5) == ref.bid_depth(5) && arr.ask_depth() == ref.ask_depth());
+    assert(arr.check_fifo_invariant());
+
+    std::cout << "PASSED (" << arr.recenter_count() << " re-centers, "
+              << at.size() << " identical trades)\n";
+}
+
+void test_array_book_band_cap() {
+    std::cout << "TEST: ArrayOrderBook caps band growth at MAX_BAND... ";
+
+    ArrayMatchingEngine engine;
+    engine.add_symbol("X", 9900, 10100);
+    auto* book = engine.get_book("X");
+    std::vector<Order> events;
+    book->add_order_listener([&](const Order& o) { events.push_back(o); });
+    auto mkx = [](OrderId id, Side side, OrderType type, Price px, Quantity q, Price stop = 0) {
+        NewOrderRequest r = mk(id, side, type, px, q, stop);
+        std::memcpy(r.symbol, "X", 2);
+        return r;
+    };
+
+    // A resting bid, then a sell limit ten billion ticks away: rejected
+    // without matching or growing the band (this used to throw bad_alloc).
+    engine.submit_order(mkx(1, Side::Buy, OrderType::Limit, 10000, 100));
+    engine.submit_order(mkx(2, Side::Sell, OrderType::Limit, 10020, 100));
+    Order* far = engine.submit_order(mkx(3, Side::Sell, OrderType::Limit, 10'000'000'000, 100));
+    bool ok = far && far->status == OrderStatus::Rejected && far->filled_qty == 0
+           && !events.empty() && events.back().id == 3 && events.back().status == OrderStatus::Rejected
+           && book->recenter_count() == 0 && book->max_price() == 10100
+           && book->active_orders() == 2 && book->find_order(3) == nullptr;
+
+    // The ends of Price, and a marketable buy limit beyond reach: rejected
+    // before it can trade.
+    for (Price px : {std::numeric_limits<Price>::max(), std::numeric_limits<Price>::min() + 1})
+        ok = ok && engine.submit_order(mkx(4, Side::Sell, OrderType::Limit, px, 100))->status
+                   == OrderStatus::Rejected;
+    ok = ok && engine.submit_order(mkx(5, Side::Buy, OrderType::Limit, 10'000'000'000, 100))->status
+               == OrderStatus::Rejected
+            && book->trade_count() == 0;
+
+    // Amending a resting order that far fails and leaves it where it was.
+    AmendRequest move{};
+    move.order_id  = 2;
+    move.new_price = 10'000'000'000;
+    std::memcpy(move.symbol, "X", 2);
+    ok = ok && !engine.amend_order(move)
+            && book->best_ask() == 10020 && book->find_order(2)->price == 10020
+            && book->recenter_count() == 0;
+
+    // Within the cap the band still grows: a re-center, both sides intact.
+    const Price reachable = 10000 + static_cast<Price>(ArrayOrderBook::MAX_BAND / 4);
+    ok = ok && engine.submit_order(mkx(6, Side::Sell, OrderType::Limit, reachable, 100))->status
+               == OrderStatus::New
+            && book->recenter_count() == 1 && book->max_price() - book->min_price() + 1
+               <= static_cast<Price>(ArrayOrderBook::MAX_BAND)
+            && book->best_bid() == 10000 && book->best_ask() == 10020 && book->get_asks(5).size() == 2;
+    move.order_id  = 6;
+    move.new_price = reachable + 1;
+    ok = ok && engine.amend_order(move) && book->get_asks(5).back().price == reachable + 1;
+
+    // A StopLimit whose limit is out of reach (and not marketable) when it
+    // fires cancels instead of resting.
+    engine.submit_order(mkx(7, Side::Buy, OrderType::StopLimit, -10'000'000'000, 50, 10020));
+    engine.submit_order(mkx(8, Side::Buy, OrderType::Limit, 10020, 100));   // prints at 10020
+    const Order* fired = book->find_order(7);
+    ok = ok && book->stop_triggered_count() == 1 && fired == nullptr
+            && events.back().id == 7 && events.back().status == OrderStatus::Cancelled
+            && book->check_no_crossed_book() && book->check_fifo_invariant();
+
+    (void)ok;
+    assert(ok);
+    std::cout << "PASSED (" << book->max_price() - book->min_price() + 1 << " levels)\n";
+}
+
+void test_array_matching_engine() {
+    std::cout << "TEST: MatchingEngine over ArrayOrderBook... ";
+
+    ArrayMatchingEngine engine;
+    engine.add_symbol("TEST", 9900, 10100);
+    uint64_t trades = 0;
+    engine.set_trade_callback([&](const Trade&) { ++trades; });
+
+    auto* book = engine.get_book("TEST");
+    assert(book != nullptr);
+    seed_two_sided_book(*book);
+    engine.submit_order(mk(5000, Side::Buy, OrderType::Market, PRICE_MARKET, 700));
+
+    AmendRequest a{};
+    a.order_id = 1;                 // seeded bid @ 9999
+    a.new_quantity = 100;
+    std::memcpy(a.symbol, "TEST", 5);
+    bool ok = engine.amend_order(a);
+    (void)ok;
+    assert(ok);
+
+    auto stats = engine.get_stats();
+    (void)stats;
+    assert(trades == 2 && stats.total_trades == 2);
+    assert(stats.total_amends == 1);
+
+    std::cout << "PASSED\n";
+}
+
+void test_symbol_id_routing() {
+    std::cout << "TEST: SymbolId fast path routes like the by-name path... ";
+
+    MatchingEngine engine;
+    engine.add_symbol("AAA");
+    engine.add_symbol("BBB");
+    engine.add_symbol("AAA");                       // idempotent
+    SymbolId aaa = engine.symbol_id("AAA");
+    SymbolId bbb = engine.symbol_id("BBB");
+    assert(aaa == 1 && bbb == 2);
+    assert(engine.symbol_id("CCC") == SYMBOL_ID_NONE);
+    assert(engine.get_book(bbb) == engine.get_book("BBB"));
+
+    // By id only (symbol left blank) vs by name only: same book, same result.
+    NewOrderRequest by_id = mk(1, Side::Buy, OrderType::Limit, 100, 10);
+    std::memset(by_id.symbol, 0, sizeof(by_id.symbol));
+    by_id.symbol_id = bbb;
+    NewOrderRequest by_name = mk(2, Side::Buy, OrderType::Limit, 101, 10);
+    std::memcpy(by_name.symbol, "BBB", 4);
+    bool ok = engine.submit_order(by_id) != nullptr
+           && engine.submit_order(by_name) != nullptr;
+    ok = ok && engine.get_book(bbb)->active_orders() == 2
+            && engine.get_book(aaa)->active_orders() == 0;
+
+    // Unresolvable id and an unknown name are both rejected.
+    NewOrderRequest bad = mk(3, Side::Buy, OrderType::Limit, 100, 10);
+    std::memset(bad.symbol, 0, sizeof(bad.symbol));
+    bad.symbol_id = 99;
+    ok = ok && engine.submit_order(bad) == nullptr;
+    std::memcpy(bad.symbol, "CCC", 4);
+    bad.symbol_id = SYMBOL_ID_NONE;
+    ok = ok && engine.submit_order(bad) == nullptr;
+
+    CancelRequest c{};
+    c.order_id  = 1;
+    c.symbol_id = bbb;
+    ok = ok && engine.cancel_order(c) && engine.get_book(bbb)->active_orders() == 1;
+
+    auto stats = engine.get_stats();
+    ok = ok && stats.total_rejects == 2 && stats.total_orders == 2 && stats.symbols_active == 2;
+    (void)ok;
+    assert(ok);
+
+    std::cout << "PASSED\n";
+}
+
+void test_order_index_fuzz() {
+    std::cout << "TEST: OrderIndex matches unordered_map under churn... ";
+
+    // Start tiny so growth, wrap-around and long clusters are all exercised.
+    OrderIndex index(4);
+    std::unordered_map<OrderId, Order*> ref;
+    std::vector<Order> pool(64);
+    std::mt19937_64 rng(7);
+
+    bool ok = true;
+    for (int i = 0; i < 200000 && ok; ++i) {
+        OrderId id = rng() % 2048;          // dense ids → frequent collisions
+        Order* o = &pool[rng() % pool.size()];
+        switch (rng() % 3) {
+            case 0: index.insert(id, o); ref[id] = o; break;
+            case 1: ok = index.erase(id) == (ref.erase(id) != 0); break;
+            case 2: {
+                auto it = ref.find(id);
+                ok = index.find(id) == (it == ref.end() ? nullptr : it->second);
+                break;
+            }
+        }
+        ok = ok && index.size() == ref.size();
+    }
+    size_t visited = 0;
+    index.for_each([&](OrderId id, Order* o) { ++visited; ok = ok && ref.at(id) == o; });
+    ok = ok && visited == ref.size();
+    (void)ok;
+    assert(ok);
+
+    std::cout << "PASSED (capacity " << index.capacity() << ")\n";
+}
+
+// Engine + feed wired through runtime listeners vs. compile-time sinks:
+// the feed stream, engine stats and global callback must all agree.
+struct SinkRun {
+    std::vector<micro_exchange::md::FeedMessage> feed;
+    EngineStats stats;
+    uint64_t callback_trades = 0;
+};
+
+template <typename Book>
+SinkRun run_sink_flow() {
+    BasicMatchingEngine<Book> engine;
+    Book& book = engine.add_symbol("TEST");
+    micro_exchange::md::FeedPublisher feed;
+    feed.attach(book);
+
+    SinkRun r;
+    engine.set_trade_callback([&](const Trade&) { ++r.callback_trades; });
+
+    RandomOrderGenerator gen(99);
+    for (OrderId id = 1; id <= 20000; ++id) {
+        engine.submit_order(gen.generate(id));
+        if (id % 7 == 0) {
+            CancelRequest c{};
+            c.order_id = id - 3;
+            std::memcpy(c.symbol, "TEST", 5);
+            engine.cancel_order(c);
+        }
+    }
+    r.feed  = feed.messages();
+    r.stats = engine.get_stats();
+    return r;
+}
+
+void test_stop_book_fuzz() {
+    std::cout << "TEST: StopBook release order matches reference... ";
+
+    // Reference: flat list of parked stops, released by (nearest trigger,
+    // arrival) with a full sort — the order the books promise.
+    struct Ref { Order* o; uint64_t arrival; };
+    std::vector<Ref> ref;
+    StopBook stops;
+    std::vector<Order> pool(4096);
+    std::vector<Order*> out, expect;
+    std::mt19937_64 rng(1234);
+    uint64_t arrival = 0;
+    size_t next_free = 0;
+
+    bool ok = true;
+    for (int step = 0; step < 100000 && ok; ++step) {
+        unsigned op = rng() % 10;
+        if (op < 5 && next_free < pool.size()) {
+            Order* o = &pool[next_free++];
+            o->side = (rng() & 1) ? Side::Buy : Side::Sell;
+            o->stop_price = 10000 + static_cast<Price>(rng() % 601) - 300;
+            if (rng() % 50 == 0) o->stop_price += (rng() & 1 ? 1 : -1) * 5'000'000;   // outlier
+            stops.park(o);
+            ref.push_back({o, arrival++});
+        } else if (op < 7 && !ref.empty()) {
+            size_t k = rng() % ref.size();
+            stops.unpark(ref[k].o);
+            ref.erase(ref.begin() + static_cast<long>(k));
+        } else {
+            Price last = 10000 + static_cast<Price>(rng() % 401) - 200;
+            if (rng() % 20 == 0) last = (rng() & 1) ? 20'000'000 : 0;
+
+            bool any = std::any_of(ref.begin(), ref.end(), [&](const Ref& r) {
+                return r.o->is_buy() ? r.o->stop_price <= last
+                                     : (last != 0 && r.o->stop_price >= last);
+            });
+            ok = stops.triggered(last) == any;
+
+            std::vector<Ref> fired, kept;
+            for (const Ref& r : ref) {
+                bool f = r.o->is_buy() ? r.o->stop_price <= last
+                                       : (last != 0 && r.o->stop_price >= last);
+                (f ? fired : kept).push_back(r);
+            }
+            std::stable_sort(fired.begin(), fired.end(), [](const Ref& a, const Ref& b) {
+                if (a.o->is_buy() != b.o->is_buy()) return a.o->is_buy();
+                if (a.o->stop_price != b.o->stop_price)
+                    return a.o->is_buy() ? a.o->stop_price < b.o->stop_price
+                                         : a.o->stop_price > b.o->stop_price;
+                return a.arrival < b.arrival;
+            });
+            expect.clear();
+            for (const Ref& r : fired) expect.push_back(r.o);
+            out.clear();
+            stops.collect(last, out);
+            ok = ok && out == expect;
+            ref.swap(kept);
+        }
+        ok = ok && stops.size() == ref.size();
+    }
+    (void)ok;
+    assert(ok);
+
+    std::cout << "PASSED\n";
+}
+
+void test_arena_backing() {
+    std::cout << "TEST: ArenaAllocator heap/mmap/huge backings... ";
+
+    ArenaOptions heap, mapped, huge;
+    mapped.use_mmap = true;
+    mapped.prefault = true;
+    huge = mapped;
+    huge.huge_pages = true;
+
+    bool ok = true;
+    for (const ArenaOptions& opts : {heap, mapped, huge}) {
+        ArenaAllocator<Order> arena(1000, opts);
+        ok = ok && arena.stats().slabs == 1 && arena.capacity() == 1000;
+        std::vector<Order*> got;
+        for (int i = 0; i < 2500; ++i) {            // forces two growths
+            Order* o = arena.construct();
+            o->id = static_cast<OrderId>(i);
+            ok = ok && reinterpret_cast<uintptr_t>(o) % 64 == 0;
+            got.push_back(o);
+        }
+        for (int i = 0; i < 2500; ++i) ok = ok && got[i]->id == static_cast<OrderId>(i);
+        ArenaStats st = arena.stats();
+        ok = ok && st.allocated == 2500 && st.capacity == 4000 && st.slabs == 3
+                && st.bytes >= st.capacity * sizeof(Order);
+        arena.reserve(10000);
+        ok = ok && arena.capacity() == 10000 && arena.stats().slabs == 4;
+        for (Order* o : got) arena.destroy(o);
+        ok = ok && arena.allocated() == 0;
+    }
+
+    // EngineStats sums the books' arenas.
+    MatchingEngine engine;
+    engine.add_symbol("AAA", 4096, mapped);
+    engine.add_symbol("BBB", 4096);
+    EngineStats es = engine.get_stats();
+    ok = ok && es.arena_capacity == 8192 && es.arena_slabs == 2 && es.arena_allocated == 0;
+    (void)ok;
+    assert(ok);
+
+    std::cout << "PASSED\n";
+}
+
+void test_compact_level_matches_price_level() {
+    std::cout << "TEST: CompactPriceLevel matches PriceLevel... ";
+
+    ArenaAllocator<Order> arena(1024);
+    PriceLevel ref(10000);
+    CompactOrderStore store(16);                    // small: exercises growth
+    CompactPriceLevel level(10000);
+    std::vector<std::pair<Order*, OrderHandle>> live;
+    std::mt19937_64 rng(99);
+    const Timestamp ts = now();
+
+    bool ok = true;
+    OrderId next_id = 1;
+    for (int step = 0; step < 20000 && ok; ++step) {
+        unsigned op = rng() % 4;
+        if (op < 2) {
+            NewOrderRequest req{};
+            req.id = next_id++;
+            req.price = 10000;
+            req.quantity = 100 * (1 + rng() % 5);
+            Order* o = arena.construct();
+            o->id = req.id; o->price = req.price; o->quantity = o->leaves_qty = req.quantity;
+            ref.push_back(o);
+            OrderHandle h = store.allocate(req, req.id, ts);
+            level.push_back(store, h);
+            live.emplace_back(o, h);
+        } else if (op == 2 && !live.empty()) {
+            size_t k = rng() % live.size();
+            ref.remove(live[k].first);
+            level.remove(store, live[k].second);
+            store.cold(live[k].second).status = OrderStatus::Cancelled;
+            ok = store.status(live[k].second) == OrderStatus::Cancelled;
+            store.release(live[k].second);
+            live.erase(live.begin() + static_cast<long>(k));
+        } else {
+            Quantity want = 50 * (1 + rng() % 20);
+            std::vector<std::pair<OrderId, Quantity>> a, b;
+            Quantity left = want;
+            while (left > 0 && !ref.empty()) {
+                Order* r = ref.front();
+                Quantity q = std::min(left, r->leaves_qty);
+                ref.reduce_quantity(q);
+                r->fill(q, ts);
+                left -= q;
+                a.emplace_back(r->id, q);
+                if (r->is_filled()) ref.pop_front();
+            }
+            std::vector<OrderHandle> filled;
+            Quantity left2 = level.sweep(store, want, [&](OrderHandle h, Quantity q) {
+                b.emplace_back(store.hot(h).id, q);
+                if (store.hot(h).leaves_qty == 0) filled.push_back(h);
+                else ok = ok && store.status(h) == OrderStatus::PartiallyFilled;
+            });
+            ok = ok && a == b && left == left2;
+            for (OrderHandle h : filled) {
+                ok = ok && store.status(h) == OrderStatus::Filled
+                        && store.materialize(h).filled_qty == store.cold(h).quantity;
+                auto it = std::find_if(live.begin(), live.end(),
+                                       [h](const auto& p) { return p.second == h; });
+                live.erase(it);
+                store.release(h);
+            }
+        }
+        ok = ok && ref.total_quantity() == level.total_quantity()
+                && ref.order_count() == level.order_count()
+                && store.live() == live.size();
+    }
+
+    std::vector<OrderId> ids_a, ids_b;
+    for (const Order& o : ref) ids_a.push_back(o.id);
+    for (OrderHandle h : level.orders(store)) ids_b.push_back(store.hot(h).id);
+    ok = ok && ids_a == ids_b;
+    (void)ok;
+    assert(ok);
+
+    std::cout << "PASSED\n";
+}
+
+void test_static_sink_dispatch() {
+    std::cout << "TEST: Static event sinks match runtime listeners... ";
+
+    using StaticBook = BasicOrderBook<SinkChain<EngineStatsSink, micro_exchange::md::FeedSink>>;
+    static_assert(has_sink_v<EngineStatsSink, StaticBook>);
+    static_assert(!has_sink_v<EngineStatsSink, OrderBook>);
+
+    auto dyn = run_sink_flow<OrderBook>();
+    auto sta = run_sink_flow<StaticBook>();
+
+    bool ok = dyn.feed.size() == sta.feed.size()
+           && dyn.stats.total_trades == sta.stats.total_trades
+           && dyn.stats.total_volume == sta.stats.total_volume
+           && dyn.stats.active_orders == sta.stats.active_orders
+           && dyn.callback_trades == dyn.stats.total_trades
+           && sta.callback_trades == sta.stats.total_trades
+           && dyn.stats.total_trades > 0;
+    for (size_t i = 0; ok && i < dyn.feed.size(); ++i) {
+        const auto& a = dyn.feed[i];
+        const auto& b = sta.feed[i];
+        ok = a.type == b.type && a.sequence == b.sequence && a.order_id == b.order_id
+          && a.price == b.price && a.quantity == b.quantity
+          && a.bid_price == b.bid_price && a.ask_price == b.ask_price
+          && a.bid_size == b.bid_size && a.ask_size == b.ask_size;
+    }
+    (void)ok;
+    assert(ok);
+
+    std::cout << "PASSED (" << sta.feed.size() << " identical feed messages)\n";
+}
+
+// Per-symbol event fingerprint: kind, ids, price, qty/leaves, status.
+using EventKey = std::tuple<int, OrderId, OrderId, Price, Quantity, int>;
+
+void test_sharded_engine_determinism() {
+    std::cout << "TEST: ShardedMatchingEngine per-symbol streams match single-threaded... ";
+
+    const std::vector<std::string> syms = {"S0", "S1", "S2", "S3", "S4", "S5", "S6"};
+
+    // One interleaved flow across all symbols, with cancels.
+    struct Op { bool cancel; NewOrderRequest req; CancelRequest c; };
+    std::vector<Op> flow;
+    RandomOrderGenerator gen(2024);
+    for (OrderId id = 1; id <= 30000; ++id) {
+        const std::string& sym = syms[id % syms.size()];
+        Op op{};
+        op.req = gen.generate(id);
+        std::memset(op.req.symbol, 0, sizeof(op.req.symbol));
+        std::memcpy(op.req.symbol, sym.c_str(), sym.size());
+        flow.push_back(op);
+        if (id % 5 == 0) {
+            Op c{};
+            c.cancel = true;
+            c.c.order_id = id - 2 * syms.size();              // same symbol, earlier order
+            std::memset(c.c.symbol, 0, sizeof(c.c.symbol));
+            std::memcpy(c.c.symbol, syms[c.c.order_id % syms.size()].c_str(), 2);
+            flow.push_back(c);
+        }
+    }
+
+    // Reference: one single-threaded engine, listeners per book.
+    std::vector<std::vector<EventKey>> ref(syms.size() + 1);
+    {
+        MatchingEngine engine;
+        for (const auto& sym : syms) {
+            auto& book = engine.add_symbol(sym);
+            SymbolId id = engine.symbol_id(sym);
+            book.add_trade_listener([&ref, id](const Trade& t) {
+                ref[id].emplace_back(0, t.buy_order_id, t.sell_order_id, t.price, t.quantity, 0);
+            });
+            book.add_order_listener([&ref, id](const Order& o) {
+                ref[id].emplace_back(1, o.id, 0, o.price, o.leaves_qty, static_cast<int>(o.status));
+            });
+        }
+        for (const auto& op : flow) {
+            if (op.cancel) engine.cancel_order(op.c); else engine.submit_order(op.req);
+        }
+    }
+
+    ShardedMatchingEngine::Config cfg;
+    cfg.num_shards  = 3;
+    cfg.pin_threads = false;
+    ShardedMatchingEngine sharded(cfg);
+    for (const auto& sym : syms) sharded.add_symbol(sym);
+
+    std::vector<std::vector<EventKey>> got(syms.size() + 1);
+    std::vector<SeqNum> last_seq(syms.size() + 1, 0);
+    bool seq_ok = true;
+    auto on_event = [&](const ShardEvent& e) {
+        seq_ok = seq_ok && e.symbol_seq == last_seq[e.symbol_id] + 1;
+        last_seq[e.symbol_id] = e.symbol_seq;
+        if (e.kind == ShardEvent::Kind::Trade) {
+            got[e.symbol_id].emplace_back(0, e.trade.buy_order_id, e.trade.sell_order_id,
+                                          e.trade.price, e.trade.quantity, 0);
+        } else {
+            got[e.symbol_id].emplace_back(1, e.order.id, 0, e.order.price, e.order.leaves_qty,
+                                          static_cast<int>(e.order.status));
+        }
+    };
+
+    sharded.start();
+    for (const auto& op : flow) {
+        if (op.cancel) sharded.cancel_order(op.c); else sharded.submit_order(op.req);
+        sharded.poll(on_event);
+    }
+    sharded.wait_idle(on_event);
+    auto stats = sharded.get_stats();
+    sharded.stop();
+
+    // Symbol ids are assigned in the same order by both engines.
+    bool ok = seq_ok && got == ref && stats.symbols_active == syms.size()
+           && sharded.shard_of(1) != sharded.shard_of(2);
+    (void)ok;
+    assert(ok);
+
+    std::cout << "PASSED (" << stats.total_trades << " trades over "
+              << cfg.num_shards << " shards)\n";
+}
+
+void test_sharded_submit_drains_output() {
+    std::cout << "TEST: ShardedMatchingEngine submit from the consumer thread drains output... ";
+
+    // One thread, no poll(): more resting orders than the input and output
+    // rings hold together. The plain submit_order() would spin forever once
+    // the shard stalls on its full output ring; the handler overload drains
+    // it while the input ring is full.
+    ShardedMatchingEngine::Config cfg;
+    cfg.pin_threads = false;
+    ShardedMatchingEngine sharded(cfg);
+    const SymbolId sym = sharded.add_symbol("S0");
+    sharded.start();
+
+    constexpr size_t n = ShardedMatchingEngine::INPUT_RING + ShardedMatchingEngine::OUTPUT_RING + 20000;
+    size_t events = 0, rested = 0;
+    auto on_event = [&](const ShardEvent& e) {
+        ++events;
+        if (e.kind == ShardEvent::Kind::Order && e.order.status == OrderStatus::New) ++rested;
+    };
+    bool ok = true;
+    for (OrderId id = 1; id <= n; ++id) {
+        NewOrderRequest req = mk(id, Side::Buy, OrderType::Limit, 100 - static_cast<Price>(id % 50), 10);
+        std::memcpy(req.symbol, "S0", 3);
+        req.symbol_id = sym;
+        ok = sharded.submit_order(req, on_event) && ok;
+    }
+    const bool drained_early = events > 0;
+    sharded.wait_idle(on_event);
+    const auto stats = sharded.get_stats();
+    sharded.stop();
+
+    ok = ok && drained_early && rested == n && stats.total_orders == n && stats.active_orders == n;
+    (void)ok;
+    assert(ok);
+
+    std::cout << "PASSED (" << n << " orders, " << events << " events)\n";
+}
+
+// Run the same mixed two-symbol flow sequentially and through
+// submit_batch / cancel_batch in random-sized chunks; trades, order states
+// and final books must match exactly.
+template <typename Book, typename... BookArgs>
+bool batch_matches_sequential(BookArgs... book_args) {
+    std::mt19937_64 rng(31337);
+    std::vector<NewOrderRequest> news;
+    RandomOrderGenerator gen(5);
+    for (OrderId id = 1; id <= 20000; ++id) {
+        NewOrderRequest r = gen.generate(id);
+        if (id % 23 == 0) {            // sprinkle stops around the mid
+            r.type = (id % 2) ? OrderType::Stop : OrderType::StopLimit;
+            r.tif  = TimeInForce::GTC;
+            r.stop_price = 9990 + static_cast<Price>(rng() % 21);
+            r.price = (r.type == OrderType::Stop) ? PRICE_MARKET : r.stop_price;
+        }
+        // Runs of ~8 orders per symbol so batches cross symbol boundaries.
+        std::memcpy(r.symbol, ((id / 8) % 2) ? "BBB" : "AAA", 4);
+        news.push_back(r);
+    }
+
+    using Key = std::tuple<SeqNum, OrderId, OrderId, Price, Quantity, int>;
+    struct Run {
+        std::vector<Key> trades;
+        std::vector<std::pair<OrderId, int>> order_events;
+        EngineStats stats;
+        std::vector<BookLevel> bids, asks;
+    };
+
+    auto setup = [&](BasicMatchingEngine<Book>& e, Run& r) {
+        for (const char* sym : {"AAA", "BBB"}) {
+            Book& b = e.add_symbol(sym, book_args...);
+            b.add_order_listener([&r](const Order& o) {
+                r.order_events.emplace_back(o.id, static_cast<int>(o.status));
+            });
+        }
+        e.set_trade_callback([&r](const Trade& t) {
+            r.trades.emplace_back(t.sequence, t.buy_order_id, t.sell_order_id, t.price,
+                                  t.quantity, static_cast<int>(t.aggressor));
+        });
+    };
+    auto cancel_for = [](OrderId id) {
+        CancelRequest c{};
+        c.order_id = id;
+        std::memcpy(c.symbol, ((id / 8) % 2) ? "BBB" : "AAA", 4);
+        return c;
+    };
+    auto finish = [](BasicMatchingEngine<Book>& e, Run& r) {
+        r.stats = e.get_stats();
+        r.bids  = e.get_book("AAA")->get_bids(50);
+        r.asks  = e.get_book("BBB")->get_asks(50);
+    };
+
+    auto same_level = [](const BookLevel& a, const BookLevel& b) {
+        return a.price == b.price && a.quantity == b.quantity;
+    };
+
+    Run seq, bat;
+    {
+        rng.seed(7);   // chunk sizes: same sequence for both runs
+        BasicMatchingEngine<Book> e;
+        setup(e, seq);
+        for (size_t i = 0; i < news.size();) {
+            size_t n = 1 + rng() % 64;
+            for (size_t k = i; k < std::min(i + n, news.size()); ++k) e.submit_order(news[k]);
+            for (size_t k = i; k < std::min(i + n, news.size()); k += 3) e.cancel_order(cancel_for(news[k].id / 2 + 1));
+            i += n;
+        }
+        finish(e, seq);
+    }
+    {
+        rng.seed(7);
+        BasicMatchingEngine<Book> e;
+        setup(e, bat);
+        std::vector<Order*> out(64);
+        std::vector<CancelRequest> cancels;
+        for (size_t i = 0; i < news.size();) {
+            size_t n = 1 + rng() % 64;
+            size_t end = std::min(i + n, news.size());
+            std::span<const NewOrderRequest> chunk(news.data() + i, end - i);
+            e.submit_batch(chunk, std::span<Order*>(out.data(), chunk.size()));
+            cancels.clear();
+            for (size_t k = i; k < end; k += 3) cancels.push_back(cancel_for(news[k].id / 2 + 1));
+            e.cancel_batch(cancels);
+            for (size_t k = 0; k < chunk.size(); ++k) {
+                if (!out[k] || out[k]->id != chunk[k].id) return false;
+            }
+            i += n;
+        }
+        finish(e, bat);
+    }
+
+    return !seq.trades.empty()
+        && seq.trades == bat.trades
+        && seq.order_events == bat.order_events
+        && seq.stats.total_trades  == bat.stats.total_trades
+        && seq.stats.total_cancels == bat.stats.total_cancels
+        && seq.stats.active_orders == bat.stats.active_orders
+        && seq.bids.size() == bat.bids.size()
+        && seq.asks.size() == bat.asks.size()
+        && std::equal(seq.bids.begin(), seq.bids.end(), bat.bids.begin(), same_level)
+        && std::equal(seq.asks.begin(), seq.asks.end(), bat.asks.begin(), same_level);
+}
+
+void test_batch_matches_sequential() {
+    std::cout << "TEST: submit_batch / cancel_batch match sequential entry... ";
+
+    bool ok = batch_matches_sequential<OrderBook>()
+           && batch_matches_sequential<ArrayOrderBook>(Price{9800}, Price{10200});
+    (void)ok;
+    assert(ok);
+
+    std::cout << "PASSED\n";
+}
+
+// ─────────────────────────────────────────────
+// Checkpoint / warm restart: a checkpointed book must continue exactly like
+// the live one, and checkpoint + feed tail must reproduce the live book.
+// ─────────────────────────────────────────────
+
+namespace {
+
+struct FlowOp {
+    enum class Kind { New, Cancel, Amend } kind = Kind::New;
+    NewOrderRequest req{};
+    OrderId  id = 0;
+    Price    price = 0;
+    Quantity qty = 0;
+};
+
+std::vector<FlowOp> restart_flow(size_t n) {
+    std::mt19937_64 rng(2718);
+    RandomOrderGenerator gen(11);
+    std::vector<FlowOp> ops;
+    OrderId next_id = 1;
+    for (size_t i = 0; i < n; ++i) {
+        FlowOp op;
+        const OrderId target = 1 + rng() % next_id;
+        if (i % 5 == 4) {
+            op.kind = FlowOp::Kind::Cancel;
+            op.id   = target;
+        } else if (i % 7 == 6) {
+            op.kind  = FlowOp::Kind::Amend;    // reprice, size up, or size down
+            op.id    = target;
+            op.price = (rng() % 3 == 0) ? 9900 + static_cast<Price>(rng() % 201) : 0;
+            op.qty   = 100 * (1 + rng() % 8);
+        } else {
+            op.req = gen.generate(next_id++);
+            if (op.req.id % 13 == 0) {
+                op.req.type = (op.req.id % 2) ? OrderType::Stop : OrderType::StopLimit;
+                op.req.tif  = TimeInForce::GTC;
+                // Half near the touch (fire during the run), half far out (stay parked).
+                const Price off = (rng() % 2) ? static_cast<Price>(rng() % 40)
+                                              : 90 + static_cast<Price>(rng() % 60);
+                op.req.stop_price = op.req.side == Side::Buy ? 10000 + off : 10000 - off;
+                op.req.price = (op.req.type == OrderType::Stop) ? PRICE_MARKET : op.req.stop_price;
+            }
+        }
+        ops.push_back(op);
+    }
+    return ops;
+}
+
+template <typename Book>
+void apply_op(Book& book, const FlowOp& op) {
+    switch (op.kind) {
+        case FlowOp::Kind::New:    book.add_order(op.req); break;
+        case FlowOp::Kind::Cancel: book.cancel_order(op.id); break;
+        case FlowOp::Kind::Amend: {
+            AmendRequest a{};
+            a.order_id = op.id;
+            a.new_price = op.price;
+            a.new_quantity = op.qty;
+            book.amend_order(a);
+            break;
+        }
+    }
+}
+
+using RestingKey = std::tuple<OrderId, int, Price, Price, Quantity>;
+
+template <typename Book>
+std::pair<std::vector<RestingKey>, std::vector<RestingKey>> book_orders(const Book& book) {
+    std::vector<RestingKey> resting, stops;
+    auto key = [](const Order& o) {
+        return RestingKey{o.id, static_cast<int>(o.side), o.price, o.stop_price, o.leaves_qty};
+    };
+    book.for_each_resting([&](const Order& o) { resting.push_back(key(o)); });
+    book.for_each_parked_stop([&](const Order& o) { stops.push_back(key(o)); });
+    return {resting, stops};
+}
+
+template <typename Book>
+bool same_state(const Book& a, const Book& b) {
+    const BookCounters ca = a.counters(), cb = b.counters();
+    return book_orders(a) == book_orders(b)
+        && a.active_orders() == b.active_orders()
+        && a.bid_depth() == b.bid_depth() && a.ask_depth() == b.ask_depth()
+        && ca.trade_count == cb.trade_count && ca.total_volume == cb.total_volume
+        && ca.last_trade_price == cb.last_trade_price
+        && ca.stop_triggered_count == cb.stop_triggered_count
+        && b.check_fifo_invariant() && b.check_no_crossed_book();
+}
+
+using TradeKey = std::tuple<SeqNum, OrderId, OrderId, Price, Quantity, int>;
+
+template <typename Book, typename MakeBook>
+bool checkpoint_restart_matches(MakeBook make_book) {
+    const std::vector<FlowOp> ops = restart_flow(16000);
+    const size_t cut = ops.size() / 2;
+    const std::string path =
+        (std::filesystem::temp_directory_path() / "mx_test_checkpoint.bin").string();
+
+    auto record = [](Book& b, std::vector<TradeKey>& out) {
+        b.add_trade_listener([&out](const Trade& t) {
+            out.emplace_back(t.sequence, t.buy_order_id, t.sell_order_id, t.price,
+                             t.quantity, static_cast<int>(t.aggressor));
+        });
+    };
+
+    Book live = make_book();
+    micro_exchange::md::FeedPublisher pub;
+    pub.attach(live);
+    std::vector<TradeKey> live_trades;
+    record(live, live_trades);
+
+    for (size_t i = 0; i < cut; ++i) apply_op(live, ops[i]);
+    if (!write_checkpoint(live, path, pub.sequence())) return false;
+    const size_t trades_at_cut = live_trades.size();
+    const size_t parked_at_cut = live.parked_stop_count();
+    for (size_t i = cut; i < ops.size(); ++i) apply_op(live, ops[i]);
+
+    // 1) Load and continue the same flow: byte-identical trades, sequences included.
+    Book resumed = make_book();
+    auto header = load_checkpoint(resumed, path);
+    if (!header || parked_at_cut == 0 || header->stop_count != parked_at_cut) return false;
+    std::vector<TradeKey> resumed_trades;
+    record(resumed, resumed_trades);
+    for (size_t i = cut; i < ops.size(); ++i) apply_op(resumed, ops[i]);
+    const bool continued =
+        !resumed_trades.empty()
+        && std::equal(resumed_trades.begin(), resumed_trades.end(),
+                      live_trades.begin() + static_cast<long>(trades_at_cut), live_trades.end())
+        && resumed_trades.size() == live_trades.size() - trades_at_cut
+        && same_state(live, resumed)
+        && resumed.sequence() == live.sequence();
+
+    // 2) Load and apply the feed tail instead: same book, no matching run.
+    Book recovered = make_book();
+    if (!load_checkpoint(recovered, path)) return false;
+    micro_exchange::md::FeedRecovery<Book> rec(recovered, header->feed_sequence);
+    for (const auto& m : pub.messages()) rec.apply(m);
+    const bool tail_ok = rec.stats().unmatched == 0 && rec.stats().gaps == 0
+                      && rec.stats().applied > 0 && same_state(live, recovered);
+
+    // 3) A damaged or foreign file is refused and leaves the book empty.
+    {
+        std::fstream f(path, std::ios::binary | std::ios::in | std::ios::out);
+        f.seekp(static_cast<std::streamoff>(sizeof(CheckpointHeader) + 8));
+        f.put('\x5a');
+    }
+    Book damaged = make_book();
+    const bool refused = !load_checkpoint(damaged, path) && damaged.active_orders() == 0
+                      && !load_checkpoint(damaged, path + ".missing");
+    std::filesystem::remove(path);
+
+    return continued && tail_ok && refused;
+}
+
+} // namespace
+
+void test_checkpoint_warm_restart() {
+    std::cout << "TEST: checkpoint reload and feed-tail recovery match the live book... ";
+
+    bool ok = checkpoint_restart_matches<OrderBook>([] { return OrderBook("TEST"); })
+           && checkpoint_restart_matches<ArrayOrderBook>([] {
+                  return ArrayOrderBook("TEST", 9950, 10050);   // narrow: restores re-center
+              });
+    (void)ok;
+    assert(ok);
+
+    std::cout << "PASSED\n";
+}
+
+// ─────────────────────────────────────────────
+// Feed quote modes
+// ─────────────────────────────────────────────
+
+void test_feed_quote_modes() {
+    std::cout << "TEST: change-only / conflated quotes track the book... ";
+    using micro_exchange::md::FeedPublisher;
+    using micro_exchange::md::FeedMessage;
+    using micro_exchange::md::FeedMessageType;
+    using Top = std::optional<std::array<int64_t, 4>>;
+
+    auto opts = [](FeedPublisher::QuoteMode m, uint64_t slice = 0) {
+        FeedPublisher::Options o;
+        o.quote_mode = m;
+        o.conflation_ns = slice;
+        return o;
+    };
+    FeedPublisher every(opts(FeedPublisher::QuoteMode::EveryEvent));
+    FeedPublisher change(opts(FeedPublisher::QuoteMode::ChangeOnly));
+    FeedPublisher conflate(opts(FeedPublisher::QuoteMode::Conflated));
+    FeedPublisher hour(opts(FeedPublisher::QuoteMode::Conflated, 3600ull * 1000000000ull));
+
+    OrderBook book("TEST");
+    for (auto* f : {&every, &change, &conflate, &hour}) f->attach(book);
+
+    // Top of book after each inbound call, keyed by that call's event time.
+    uint64_t event_ns = 0;
+    book.add_trade_listener([&](const Trade& t) { event_ns = timestamp_ns(t.exec_time); });
+    book.add_order_listener([&](const Order& o) { event_ns = timestamp_ns(o.last_update); });
+    auto top = [&]() -> Top {
+        auto b = book.get_bids(1), a = book.get_asks(1);
+        if (b.empty() || a.empty()) return std::nullopt;
+        return std::array<int64_t, 4>{b[0].price, int64_t(b[0].quantity), a[0].price, int64_t(a[0].quantity)};
+    };
+    std::vector<std::pair<uint64_t, Top>> tops;
+
+    RandomOrderGenerator gen(4242);
+    for (OrderId id = 1; id <= 20000; ++id) {
+        event_ns = 0;
+        book.add_order(gen.generate(id));
+        if (id % 5 == 0) {
+            if (event_ns) tops.emplace_back(event_ns, top());
+            event_ns = 0;
+            book.cancel_order(id - 2);
+        }
+        if (event_ns) tops.emplace_back(event_ns, top());
+    }
+    for (auto* f : {&every, &change, &conflate, &hour}) f->flush();
+
+    auto quotes = [](const FeedPublisher& f) {
+        std::vector<std::array<int64_t, 4>> q;
+        for (const FeedMessage& m : f.messages())
+            if (m.type == FeedMessageType::QuoteUpdate)
+                q.push_back({m.bid_price, int64_t(m.bid_size), m.ask_price, int64_t(m.ask_size)});
+        return q;
+    };
+    auto non_quotes = [](const FeedPublisher& f) {
+        std::vector<std::pair<FeedMessageType, OrderId>> v;
+        for (const FeedMessage& m : f.messages())
+            if (m.type != FeedMessageType::QuoteUpdate) v.emplace_back(m.type, m.order_id);
+        return v;
+    };
+
+    // Conflated per event: one quote per distinct end-of-event top.
+    std::vector<std::array<int64_t, 4>> expect;
+    Top last;
+    for (size_t i = 0; i < tops.size(); ++i) {
+        if (i + 1 < tops.size() && tops[i + 1].first == tops[i].first) continue;   // same event
+        const Top& t = tops[i].second;
+        if (!t) { last.reset(); continue; }
+        if (t != last) expect.push_back(*t);
+        last = t;
+    }
+
+    const auto q_every = quotes(every), q_change = quotes(change), q_conf = quotes(conflate);
+    const auto q_hour = quotes(hour);
+    bool ok = q_conf == expect;
+
+    bool change_ok = !q_change.empty() && q_change.back() == *top();
+    for (size_t i = 0; i < q_change.size(); ++i) {
+        const auto& q = q_change[i];
+        change_ok = change_ok && q[1] > 0 && q[3] > 0 && q[0] < q[2]
+                 && (i == 0 || q != q_change[i - 1]);
+    }
+    ok = ok && change_ok;
+
+    // Everything but quotes is identical; fewer quotes, each accounted for.
+    ok = ok && non_quotes(every) == non_quotes(change) && non_quotes(every) == non_quotes(conflate);
+    const auto sc = change.get_stats(), sf = conflate.get_stats();
+    ok = ok && q_conf.size() < q_change.size() && q_change.size() < q_every.size()
+            && sc.quotes_conflated == 0
+            && sc.quote_count + sc.quotes_suppressed <= q_every.size()
+            && sf.quote_count + sf.quotes_suppressed + sf.quotes_conflated <= q_every.size()
+            && every.get_stats().quotes_suppressed == 0;
+
+    // One slice covering the whole run: a single quote, the final top.
+    ok = ok && q_hour.size() == 1 && q_hour[0] == *top();
+    (void)ok;
+    assert(ok);
+
+    std::cout << "PASSED (" << q_every.size() << " every-event, " << q_change.size()
+              << " change-only, " << q_conf.size() << " conflated)\n";
+}
+
+// ─────────────────────────────────────────────
+// Market-by-price depth feed
+// ─────────────────────────────────────────────
+
+namespace {
+
+bool same_levels(const std::vector<BookLevel>& a, const std::vector<BookLevel>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].price != b[i].price || a[i].quantity != b[i].quantity
+            || a[i].order_count != b[i].order_count) return false;
+    }
+    return true;
+}
+
+// A consumer fed only L / S / M messages tracks the book's top levels after
+// every inbound call; a second one that joins mid-stream catches up at the
+// next periodic snapshot.
+template <typename Book>
+bool depth_feed_tracks_book(Book book) {
+    using namespace micro_exchange::md;
+    constexpr size_t N = 5;
+    const auto ops = restart_flow(20000);
+    for (size_t i = 0; i < 2000; ++i) apply_op(book, ops[i]);   // attach to a live book
+
+    FeedPublisher::Options opts;
+    opts.depth_levels = N;
+    opts.depth_snapshot_every = 1000;
+    FeedPublisher feed(opts);
+    DepthBook early("TEST"), late("TEST");
+    bool joined = false, in_sync = true;
+    size_t msgs = 0;
+    feed.set_callback([&](const FeedMessage& m) {
+        in_sync = in_sync && (early.apply(m) || m.type != FeedMessageType::LevelUpdate);
+        joined = joined || (msgs > 5000 && m.type == FeedMessageType::Snapshot);
+        if (joined) late.apply(m);
+        ++msgs;
+    });
+    feed.attach(book);
+
+    bool ok = true;
+    for (size_t i = 2000; i < ops.size(); ++i) {
+        apply_op(book, ops[i]);
+        ok = ok && in_sync
+                && same_levels(early.bids(), book.get_bids(N))
+                && same_levels(early.asks(), book.get_asks(N));
+    }
+    const auto st = feed.get_stats();
+    return ok && joined && same_levels(late.bids(), book.get_bids(N))
+              && same_levels(late.asks(), book.get_asks(N))
+              && st.level_update_count > 0 && st.level_snapshot_count > 0
+              && std::equal(early.bids().begin(), early.bids().end(),
+                            feed.depth(book, Side::Buy).begin(),
+                            [](const BookLevel& a, const BookLevel& b) { return a.price == b.price; });
+}
+
+} // namespace
+
+void test_depth_feed() {
+    std::cout << "TEST: L2 depth feed tracks the book's top levels... ";
+
+    bool ok = depth_feed_tracks_book(OrderBook("TEST"))
+           && depth_feed_tracks_book(ArrayOrderBook("TEST", 9950, 10050));
+    (void)ok;
+    assert(ok);
+
+    std::cout << "PASSED\n";
+}
+
+// ─────────────────────────────────────────────
+// Compact feed encoding + streaming writer
+// ─────────────────────────────────────────────
+
+namespace {
+
+bool same_message(const micro_exchange::md::FeedMessage& a, const micro_exchange::md::FeedMessage& b) {
+    return a.type == b.type && a.sequence == b.sequence && a.timestamp_ns == b.timestamp_ns
+        && std::memcmp(a.symbol, b.symbol, sizeof(a.symbol)) == 0
+        && a.order_id == b.order_id && a.side == b.side && a.order_type == b.order_type
+        && a.order_status == b.order_status && a.level_action == b.level_action
+        && a.level_orders == b.level_orders && a.price == b.price && a.quantity == b.quantity
+        && a.match_id == b.match_id && a.aggressor_side == b.aggressor_side
+        && a.best_bid == b.best_bid && a.best_ask == b.best_ask
+        && a.bid_depth == b.bid_depth && a.ask_depth == b.ask_depth
+        && a.bid_price == b.bid_price && a.ask_price == b.ask_price
+        && a.bid_size == b.bid_size && a.ask_size == b.ask_size
+        && a.stop_price == b.stop_price && a.level_index == b.level_index;
+}
+
+bool replays_as(const std::string& path, const std::vector<micro_exchange::md::FeedMessage>& want) {
+    const auto got = micro_exchange::md::FeedReplayer(path).load_all();
+    return got.size() == want.size()
+        && std::equal(got.begin(), got.end(), want.begin(), same_message);
+}
+
+} // namespace
+
+void test_feed_compact_stream() {
+    std::cout << "TEST: compact feed frames and streamed files replay exactly... ";
+    using namespace micro_exchange::md;
+    namespace fs = std::filesystem;
+    const std::string dir = fs::temp_directory_path().string();
+    const std::string compact = dir + "/mx_feed_compact.bin";
+    const std::string direct  = dir + "/mx_feed_direct.bin";
+    const std::string fixed   = dir + "/mx_feed_fixed.bin";
+    const std::string dumped  = dir + "/mx_feed_dump.bin";
+
+    FeedPublisher::Options opts;
+    opts.depth_levels = 5;
+    FeedPublisher kept(opts);
+    opts.retain_messages = false;
+    FeedPublisher streamed(opts);
+
+    FeedWriter w_compact(compact);
+    FeedWriter::Options dopts;
+    dopts.direct = true;
+    dopts.buffer_bytes = 8192;   // many page-sized writes and a partial tail
+    FeedWriter w_direct(direct, dopts);
+    FeedWriter::Options fopts;
+    fopts.format = FeedFormat::Fixed;
+    FeedWriter w_fixed(fixed, fopts);
+    kept.set_writer(&w_compact);
+    streamed.set_writer(&w_direct);
+    std::vector<FeedMessage> seen;   // quotes carry publish time, so keep streamed's own
+    streamed.set_callback([&](const FeedMessage& m) { seen.push_back(m); });
+
+    OrderBook book("TEST");
+    kept.attach(book);
+    streamed.attach(book);
+    for (const FlowOp& op : restart_flow(20000)) apply_op(book, op);
+    for (const auto& m : kept.messages()) w_fixed.push(m);
+
+    bool ok = w_compact.close() && w_direct.close() && w_fixed.close();
+    kept.dump_to_file(dumped, FeedFormat::Compact);
+
+    const auto& want = kept.messages();
+    const auto ks = kept.get_stats(), ss = streamed.get_stats();
+    ok = ok && streamed.messages().empty() && !want.empty()
+            && ks.total_messages == want.size() && ss.total_messages == want.size()
+            && ss.add_count == ks.add_count && ss.level_update_count == ks.level_update_count
+            && w_direct.stats().messages == want.size()
+            && replays_as(compact, want) && replays_as(direct, seen)
+            && replays_as(fixed, want) && replays_as(dumped, want)
+            && fs::file_size(compact) * 3 < fs::file_size(fixed);
+
+    // A torn last frame is dropped, not misread.
+    fs::resize_file(compact, fs::file_size(compact) - 3);
+    ok = ok && FeedReplayer(compact).load_all().size() == want.size() - 1;
+
+    const double ratio = double(fs::file_size(fixed)) / double(fs::file_size(compact));
+    for (const auto& f : {compact, direct, fixed, dumped}) fs::remove(f);
+    (void)ok;
+    assert(ok);
+
+    std::cout << "PASSED (" << want.size() << " messages, " << std::fixed << std::setprecision(1)
+              << ratio << "x smaller" << (w_direct.direct_active() ? ", O_DIRECT" : "") << ")\n";
+}
+
+// ─────────────────────────────────────────────
+// Mapped feed replay
+// ─────────────────────────────────────────────
+
+void test_mapped_feed_replay() {
+    std::cout << "TEST: mapped feed seeks, replays in place and rebuilds books in parallel... ";
+    using namespace micro_exchange::md;
+    namespace fs = std::filesystem;
+    const std::string fixed   = (fs::temp_directory_path() / "mx_mapped_fixed.bin").string();
+    const std::string compact = (fs::temp_directory_path() / "mx_mapped_compact.bin").string();
+
+    // Four books on one publisher: one sequence across interleaved symbols.
+    const std::vector<std::string> syms = {"AAA", "BBB", "CCC", "DDD"};
+    std::vector<std::unique_ptr<OrderBook>> books;
+    for (const auto& sym : syms) books.push_back(std::make_unique<OrderBook>(sym));
+    FeedPublisher pub;
+    for (auto& b : books) pub.attach(*b);
+    const std::vector<FlowOp> ops = restart_flow(12000);
+    for (size_t i = 0; i < ops.size(); ++i) {
+        for (size_t k = 0; k < books.size(); ++k) {
+            if (i % (k + 2) == 0) continue;   // each book sees a different subset
+            FlowOp op = ops[i];
+            std::memset(op.req.symbol, 0, sizeof(op.req.symbol));
+            std::memcpy(op.req.symbol, syms[k].data(), syms[k].size());
+            apply_op(*books[k], op);
+        }
+    }
+    pub.dump_to_file(fixed, FeedFormat::Fixed);
+    pub.dump_to_file(compact, FeedFormat::Compact);
+    const auto& want = pub.messages();
+
+    bool ok = true;
+    for (const auto& path : {fixed, compact}) {
+        MappedFeed feed(path, 256);
+        ok = ok && feed.ok() && feed.size() == want.size() && feed.gaps() == 0
+                && feed.symbols() == syms;
+
+        // In-order replay; Fixed files are a span over the mapping itself.
+        size_t i = 0;
+        feed.replay([&](const FeedMessage& m) { ok = ok && same_message(m, want[i++]); });
+        ok = ok && i == want.size();
+        if (feed.format() == FeedFormat::Fixed) {
+            ok = ok && feed.messages().size() == want.size()
+                    && std::equal(want.begin(), want.end(), feed.messages().begin(), same_message);
+        } else {
+            ok = ok && feed.messages().empty();
+        }
+
+        // Seek by sequence and by time, then replay a window from there.
+        for (size_t k : {size_t(0), size_t(1), size_t(255), size_t(256), size_t(7777), want.size() - 1}) {
+            const auto by_seq = feed.seek_sequence(want[k].sequence);
+            uint64_t clock = 0;
+            size_t first_at = 0;
+            for (size_t j = 0; j <= k; ++j) clock = std::max(clock, want[j].timestamp_ns);
+            while (want[first_at].timestamp_ns < clock) ++first_at;
+            const auto by_time = feed.seek_time(clock);
+            std::vector<FeedMessage> window;
+            feed.replay(by_seq, feed.end(), [&](const FeedMessage& m) {
+                if (window.size() < 100) window.push_back(m);
+            });
+            ok = ok && by_seq.ordinal == k && by_time.ordinal == first_at
+                    && same_message(window.front(), want[k]);
+        }
+        ok = ok && feed.seek_sequence(want.back().sequence + 1) == feed.end()
+                && feed.seek_time(want.back().timestamp_ns + 1) == feed.end();
+
+        // Books rebuilt per symbol on 1 and 3 workers match the live ones.
+        for (size_t threads : {1, 3}) {
+            auto rebuilt = rebuild_books<OrderBook>(feed, threads);
+            ok = ok && rebuilt.size() == syms.size();
+            for (size_t k = 0; ok && k < rebuilt.size(); ++k) {
+                ok = rebuilt[k].symbol == syms[k] && rebuilt[k].stats.unmatched == 0
+                  && rebuilt[k].stats.gaps == 0 && same_state(*books[k], *rebuilt[k].book);
+            }
+        }
+    }
+
+    // Real-time pacing at 1000x: a replay takes about the recorded span / 1000.
+    {
+        MappedFeed feed(compact);
+        const uint64_t span = want.back().timestamp_ns - want.front().timestamp_ns;
+        MappedFeed::Pacing pacing{MappedFeed::Pacing::Mode::RealTime, 1000.0};
+        const auto t0 = std::chrono::steady_clock::now();
+        const size_t n = feed.replay([](const FeedMessage&) {}, pacing);
+        const auto took = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0);
+        ok = ok && n == want.size() && static_cast<uint64_t>(took.count()) * 1000 >= span * 9 / 10;
+    }
+    fs::remove(fixed);
+    fs::remove(compact);
+    (void)ok;
+    assert(ok);
+
+    std::cout << "PASSED (" << want.size() << " messages)\n";
+}
+
+// Bulk, in-place and multi-producer ring access: contents and order survive
+// wrap-around, and a ShardedMatchingEngine fed from several threads (each
+// owning its own symbols) produces the single-threaded streams.
+void test_ring_buffers() {
+    using namespace micro_exchange::md;
+    std::cout << "TEST: SPSC bulk/in-place and MPSC rings, multi-producer sharded engine... ";
+    bool ok = true;
+
+    // SPSC, single thread, across several wraps.
+    {
+        SPSCRingBuffer<uint64_t, 64> ring;
+        std::vector<uint64_t> in(40), out(40);
+        uint64_t next = 0, expect = 0;
+        for (int round = 0; round < 50; ++round) {
+            for (auto& v : in) v = next++;
+            const size_t pushed = ring.push_n(in.data(), in.size());
+            next -= in.size() - pushed;
+            ok = ok && pushed <= ring.capacity();
+            if (uint64_t* slot = ring.claim()) { *slot = next++; ring.commit(); }
+            const size_t half = ring.pop_n(out.data(), 20);
+            for (size_t i = 0; i < half; ++i) ok = ok && out[i] == expect++;
+            ring.consume([&](const uint64_t& v) { ok = ok && v == expect++; });
+            ok = ok && ring.empty() && !ring.pop();
+        }
+        ok = ok && expect == next;
+    }
+
+    // SPSC, two threads, batched on both sides.
+    {
+        constexpr uint64_t N = 200000;
+        SPSCRingBuffer<uint64_t, 1024> ring;
+        std::thread producer([&] {
+            uint64_t batch[32];
+            for (uint64_t v = 0; v < N;) {
+                const size_t n = std::min<uint64_t>(32, N - v);
+                for (size_t i = 0; i < n; ++i) batch[i] = v + i;
+                const size_t pushed = ring.push_n(batch, n);
+                if (!pushed) std::this_thread::yield();
+                v += pushed;
+            }
+        });
+        uint64_t expect = 0;
+        while (expect < N) {
+            if (!ring.consume([&](const uint64_t& v) { ok = ok && v == expect++; }, 100))
+                std::this_thread::yield();
+        }
+        producer.join();
+    }
+
+    // MPSC: each producer's items arrive in its order, nothing lost.
+    {
+        constexpr size_t P = 4;
+        constexpr uint64_t N = 50000;
+        MPSCRingBuffer<uint64_t, 256> ring;
+        std::vector<std::thread> producers;
+        for (uint64_t p = 0; p < P; ++p) {
+            producers.emplace_back([&ring, p] {
+                for (uint64_t i = 0; i < N; ++i) {
+                    while (!ring.push((p << 32) | i)) std::this_thread::yield();
+                }
+            });
+        }
+        std::array<uint64_t, P> expect{};
+        uint64_t total = 0;
+        while (total < P * N) {
+            const size_t got = ring.consume([&](const uint64_t& v) {
+                const auto p = static_cast<size_t>(v >> 32);
+                ok = ok && p < P && (v & 0xFFFFFFFFu) == expect[p]++;
+            });
+            if (!got) std::this_thread::yield();
+            total += got;
+        }
+        for (auto& t : producers) t.join();
+        ok = ok && ring.empty() && expect == std::array<uint64_t, P>{N, N, N, N};
+    }
+
+    // Sharded engine with one submitting thread per pair of symbols.
+    {
+        const std::vector<std::string> syms = {"M0", "M1", "M2", "M3", "M4", "M5"};
+        constexpr size_t THREADS = 3;
+        std::vector<std::vector<NewOrderRequest>> flows(THREADS);
+        RandomOrderGenerator gen(77);
+        for (OrderId id = 1; id <= 12000; ++id) {
+            NewOrderRequest req = gen.generate(id);
+            const size_t s = id % syms.size();
+            std::memset(req.symbol, 0, sizeof(req.symbol));
+            std::memcpy(req.symbol, syms[s].c_str(), syms[s].size());
+            flows[s % THREADS].push_back(req);
+        }
+
+        std::vector<std::vector<EventKey>> ref(syms.size() + 1);
+        {
+            MatchingEngine engine;
+            for (const auto& sym : syms) {
+                auto& book = engine.add_symbol(sym);
+                SymbolId id = engine.symbol_id(sym);
+                book.add_trade_listener([&ref, id](const Trade& t) {
+                    ref[id].emplace_back(0, t.buy_order_id, t.sell_order_id, t.price, t.quantity, 0);
+                });
+            }
+            for (const auto& flow : flows)
+                for (const auto& req : flow) engine.submit_order(req);
+        }
+
+        ShardedMatchingEngine::Config cfg;
+        cfg.num_shards  = 2;
+        cfg.pin_threads = false;
+        ShardedMatchingEngine sharded(cfg);
+        for (const auto& sym : syms) sharded.add_symbol(sym);
+        std::vector<std::vector<EventKey>> got(syms.size() + 1);
+        auto on_event = [&](const ShardEvent& e) {
+            if (e.kind != ShardEvent::Kind::Trade) return;
+            got[e.symbol_id].emplace_back(0, e.trade.buy_order_id, e.trade.sell_order_id,
+                                          e.trade.price, e.trade.quantity, 0);
+        };
+
+        sharded.start();
+        std::vector<std::thread> producers;
+        for (const auto& flow : flows) {
+            producers.emplace_back([&sharded, &flow] {
+                for (const auto& req : flow) sharded.submit_order(req);
+            });
+        }
+        std::atomic<bool> done{false};
+        std::thread joiner([&] { for (auto& t : producers) t.join(); done = true; });
+        while (!done.load()) {
+            if (!sharded.poll(on_event)) std::this_thread::yield();
+        }
+        joiner.join();
+        sharded.wait_idle(on_event);
+        sharded.stop();
+        ok = ok && got == ref;
+    }
+
+    (void)ok;
+    assert(ok);
+
+    std::cout << "PASSED\n";
+}
+
 // ─────────────────────────────────────────────
 // Main
 // ─────────────────────────────────────────────
 
+void test_latency_probes() {
+    std::cout << "TEST: Latency histogram buckets, sampling and book probes... ";
+    bool ok = true;
+
+    // Every value lands in a bucket that contains it, at most 1/16 wide.
+    std::mt19937_64 rng(7);
+    for (int i = 0; i < 100000 && ok; ++i) {
+        const uint64_t v = rng() >> (rng() % 64);
+        const size_t b = LatencyHistogram::bucket(v);
+        ok = b < LatencyHistogram::BUCKETS
+          && LatencyHistogram::lowest(b) <= v && v <= LatencyHistogram::highest(b)
+          && (LatencyHistogram::highest(b) - LatencyHistogram::lowest(b)) <= v / 16;
+    }
+
+    // Percentiles of 1..100000 within one bucket of exact.
+    LatencyHistogram h;
+    for (uint64_t v = 1; v <= 100000; ++v) h.record(v);
+    const auto hs = h.snapshot();
+    for (double p : {0.5, 0.9, 0.99, 0.999}) {
+        const double exact = p * 100000;
+        ok = ok && std::abs(static_cast<double>(hs.percentile(p)) - exact) <= exact / 16 + 1;
+    }
+    ok = ok && hs.count == 100000 && hs.max == 100000 && hs.percentile(1.0) == 100000;
+
+    // 1 in 3 sampled; spans need both ends.
+    ProbeOptions po;
+    po.sample_every = 3;
+    LatencyRecorder rec(po);
+    size_t timed = 0;
+    for (OrderId id = 1; id <= 30; ++id) {
+        OrderTrace t;
+        if (!rec.start(t, id, 1000)) continue;
+        ++timed;
+        t.at = {1000, 1100, 1300, (id % 2) ? 1700u : 0u, 2000};
+        rec.record(t);
+    }
+    const auto ls = rec.snapshot();
+    ok = ok && timed == 10
+       && ls[ProbeSpan::WireToWire].count == 10 && ls[ProbeSpan::WireToWire].max == 1000
+       && ls[ProbeSpan::RecvToDecode].max == 100 && ls[ProbeSpan::DecodeToBook].max == 200
+       && ls[ProbeSpan::BookToFill].count == 5 && ls[ProbeSpan::ToAck].count == 10
+       && ls.traces_kept == 10;
+
+    // The books stamp entry and first fill into the active trace only.
+    auto book_stamps = [&](auto& book) {
+        NewOrderRequest rest{};
+        rest.id = 1; rest.side = Side::Sell; rest.price = 100; rest.quantity = 10;
+        book.add_order(rest);   // no trace active
+        NewOrderRequest cross = rest;
+        cross.id = 2; cross.side = Side::Buy; cross.quantity = 4;
+        OrderTrace t;
+        t.trace_id = 1;
+        {
+            probe::Scope scope(&t);
+            book.add_order(cross);
+        }
+        NewOrderRequest passive = rest;
+        passive.id = 3; passive.side = Side::Buy; passive.price = 90;
+        OrderTrace p;
+        p.trace_id = 2;
+        {
+            probe::Scope scope(&p);
+            book.add_order(passive);
+        }
+        const bool stamped = !MICRO_EXCHANGE_PROBES
+            || (t[ProbePoint::BookEntry] && t[ProbePoint::FirstFill] >= t[ProbePoint::BookEntry]
+                && p[ProbePoint::BookEntry] && !p[ProbePoint::FirstFill]);
+#if MICRO_EXCHANGE_PROBES
+        return stamped && probe::active == nullptr;
+#else
+        return stamped;
+#endif
+    };
+    OrderBook mb("TEST");
+    ArrayOrderBook ab("TEST", 0, 200);
+    ok = ok && book_stamps(mb) && book_stamps(ab);
+
+    (void)ok;
+    assert(ok);
+    std::cout << "PASSED (" << LatencyHistogram::BUCKETS << " buckets)\n";
+}
+
+void test_event_clock() {
+    std::cout << "TEST: Event clock is monotonic and tracks steady_clock... ";
+    static_assert(std::is_same_v<Timestamp, EventClock::time_point>);
+    static_assert(EventClock::is_steady);
+
+    // Non-decreasing across back-to-back reads.
+    bool ok = true;
+    Timestamp prev = now();
+    for (int i = 0; i < 100000 && ok; ++i) {
+        const Timestamp t = now();
+        ok = t >= prev;
+        prev = t;
+    }
+
+    // Shares steady_clock's epoch and rate: same reading to within 1 ms, and
+    // the same elapsed time across a sleep to within 2%.
+    auto ns = [](auto tp) {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(tp.time_since_epoch()).count());
+    };
+    const uint64_t s0 = ns(std::chrono::steady_clock::now()), t0 = ns(TscClock::now());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    const uint64_t t1 = ns(TscClock::now()), s1 = ns(std::chrono::steady_clock::now());
+    const double elapsed = static_cast<double>(t1 - t0), want = static_cast<double>(s1 - s0);
+    ok = ok && std::abs(static_cast<double>(t0) - static_cast<double>(s0)) < 1e6
+       && std::abs(elapsed - want) < want * 0.02;
+
+    // Calibration is in range whenever the counter is in use.
+    const auto& cal = TscClock::calibration();
+    ok = ok && (!cal.tsc || (cal.hz > 1e6 && cal.mult > 0));
+
+    (void)ok;
+    assert(ok);
+    std::cout << "PASSED (" << TscClock::source() << ")\n";
+}
+
+void test_simulation_batch() {
+    std::cout << "TEST: Simulation batch is reproducible per seed across thread counts... ";
+    using namespace micro_exchange::sim;
+
+    Simulator::Config cfg;
+    cfg.duration = 4.0;
+
+    auto same = [](const RunSummary& a, const RunSummary& b) {
+        return a.run == b.run && a.seed == b.seed && a.orders == b.orders && a.trades == b.trades
+            && a.volume == b.volume && a.cancels == b.cancels && a.mean_spread == b.mean_spread
+            && a.mid_change_sd == b.mid_change_sd && a.vwap == b.vwap
+            && a.buy_aggressor == b.buy_aggressor && a.final_mid == b.final_mid;
+    };
+    auto same_stat = [](const StreamingStat& a, const StreamingStat& b) {
+        return a.n == b.n && a.mean == b.mean && a.m2 == b.m2 && a.min == b.min && a.max == b.max;
+    };
+
+    std::vector<RunSummary> one, four;
+    SimulationBatch::Options opts;
+    opts.runs = 6;
+    opts.base_seed = 100;
+    opts.threads = 1;
+    const auto s1 = SimulationBatch(cfg, opts).run([&](const RunSummary& r) { one.push_back(r); });
+    opts.threads = 4;
+    const auto s4 = SimulationBatch(cfg, opts).run([&](const RunSummary& r) { four.push_back(r); });
+
+    bool ok = one.size() == 6 && four.size() == 6 && s1.threads == 1 && s4.threads == 4;
+    for (size_t i = 0; ok && i < one.size(); ++i)
+        ok = one[i].run == i && one[i].seed == 100 + i && same(one[i], four[i]);
+    ok = ok && s1.runs == 6 && s1.trades == s4.trades && s1.volume == s4.volume
+       && same_stat(s1.mean_spread, s4.mean_spread) && same_stat(s1.vwap, s4.vwap)
+       && same_stat(s1.final_mid, s4.final_mid) && same_stat(s1.mid_change_sd, s4.mid_change_sd);
+
+    // A batch run is the standalone run with that seed; different seeds differ.
+    Simulator::Config c2 = cfg;
+    c2.seed = 102;
+    ok = ok && same(RunSummary::of(Simulator(c2).run(), 2, 102), one[2])
+       && (one[0].trades != one[1].trades || one[0].vwap != one[1].vwap);
+
+    // Chan merge of two halves matches one pass over the whole stream.
+    StreamingStat whole, a, b;
+    for (int i = 0; i < 1000; ++i) {
+        const double x = std::sin(i * 0.37) * 50 + i * 0.01;
+        whole.add(x);
+        (i < 400 ? a : b).add(x);
+    }
+    a.merge(b);
+    ok = ok && a.n == whole.n && std::abs(a.mean - whole.mean) < 1e-9
+       && std::abs(a.variance() - whole.variance()) < 1e-6 && a.min == whole.min && a.max == whole.max;
+
+    (void)ok;
+    assert(ok);
+    std::cout << "PASSED (" << s1.trades << " trades over " << s1.runs << " runs)\n";
+}
+
+void test_hawkes_stream() {
+    std::cout << "TEST: Streaming Hawkes recursion, chunking and cross-excitation... ";
+    using namespace micro_exchange::sim;
+
+    HawkesProcess::Parameters hp;
+    hp.mu = 50; hp.alpha = 35; hp.beta = 50;
+
+    // Pulling events one at a time is the vector generator, event for event.
+    HawkesProcess a(hp, 9), b(hp, 9);
+    const auto all = a.generate_sided(200.0);
+    bool ok = !all.empty();
+    size_t k = 0;
+    while (auto e = b.next_sided(200.0)) {
+        ok = ok && k < all.size() && e->timestamp == all[k].timestamp && e->is_buy == all[k].is_buy;
+        ++k;
+    }
+    ok = ok && k == all.size();
+
+    // Long-run rate μ / (1 - n): 50 / 0.3 per second, within 5%.
+    const double rate = static_cast<double>(all.size()) / 200.0;
+    ok = ok && std::abs(rate - hp.mu / (1 - hp.branching_ratio())) < 0.05 * hp.mu / 0.3;
+
+    // The O(1) state equals the full sum over every past event.
+    HawkesProcess c(hp, 3);
+    std::vector<double> times;
+    while (auto t = c.next(20.0)) times.push_back(*t);
+    double direct = hp.mu;
+    for (double t : times) direct += hp.alpha * std::exp(-hp.beta * (20.0 - t));
+    ok = ok && std::abs(c.intensity() - direct) < 1e-9 * direct;
+
+    // Chunked pulls stay increasing and inside each chunk's horizon.
+    HawkesProcess d(hp, 4);
+    double last = 0;
+    size_t chunked = 0;
+    for (double h = 1.0; h <= 20.0; h += 1.0) {
+        while (auto t = d.next(h)) {
+            ok = ok && *t > last && *t < h;
+            last = *t;
+            ++chunked;
+        }
+    }
+    ok = ok && chunked > 0;
+
+    // Buy/sell cross-excitation: each side's rate is μ / (1 - (self + cross) / β).
+    BuySellHawkes bs(BuySellHawkes::symmetric(20, 15, 10, 50), 5);
+    size_t side[2] = {0, 0};
+    while (auto e = bs.next(300.0)) ++side[e->dim];
+    const double want = 20 / (1 - 25.0 / 50) * 300;
+    ok = ok && std::abs(side[0] - want) < 0.08 * want && std::abs(side[1] - want) < 0.08 * want
+       && std::abs(bs.params().branching_ratio() - 0.5) < 1e-12;
+
+    // The Simulator runs on either stream.
+    Simulator::Config cfg;
+    cfg.duration = 4.0;
+    cfg.seed = 7;
+    cfg.buy_sell = BuySellHawkes::symmetric(25, 20, 10, 50);
+    const auto data = Simulator(cfg).run();
+    ok = ok && data.total_orders == data.event_times.size() && !data.trades.empty();
+
+    (void)ok;
+    assert(ok);
+    std::cout << "PASSED (" << all.size() << " events, " << side[0] << "/" << side[1] << " buy/sell)\n";
+}
+
+void test_hawkes_clustering() {
+    std::cout << "TEST: Hawkes flow keeps its rate, fat tails and |r| clustering across seeds... ";
+    using namespace micro_exchange::sim;
+    using micro_exchange::analytics::StylizedFacts;
+
+    // Realised rate over 8 seeds x 1000 s, within 1% of μ / (1 - n). The
+    // old 5/β lookback dropped e^-5 of every kernel and ran ~1.5% low.
+    HawkesProcess::Parameters hp;
+    hp.mu = 50; hp.alpha = 35; hp.beta = 50;
+    size_t events = 0;
+    for (uint64_t seed = 1; seed <= 8; ++seed) {
+        HawkesProcess h(hp, seed);
+        while (h.next(1000.0)) ++events;
+    }
+    const double rate = static_cast<double>(events) / 8000.0;
+    const double want = hp.mu / (1 - hp.branching_ratio());
+    bool ok = std::abs(rate - want) < 0.01 * want;
+
+    // Simulated mids on 100 ms bars, near the kernel's 1/β = 20 ms: every
+    // seed has fat tails and positive lag-1 |r| autocorrelation, and the
+    // autocorrelation is still positive at lags 5 and 10 on average. (On
+    // 300 one-second bars a single seed's lag-10 value is noise, ±0.06.)
+    constexpr int seeds = 4;
+    double ac5 = 0, ac10 = 0, min_kurtosis = 1e9, min_ac1 = 1e9;
+    for (uint64_t seed = 1; seed <= seeds; ++seed) {
+        Simulator::Config cfg;
+        cfg.duration = 300.0;
+        cfg.seed = seed;
+        const auto data = Simulator(cfg).run();
+        const auto facts = StylizedFacts().compute(data.midprices, data.event_times, 0.1);
+        min_kurtosis = std::min(min_kurtosis, facts.return_kurtosis);
+        min_ac1 = std::min(min_ac1, facts.abs_return_ac_lag1);
+        ac5 += facts.abs_return_ac_lag5 / seeds;
+        ac10 += facts.abs_return_ac_lag10 / seeds;
+    }
+    ok = ok && min_kurtosis > 1.0 && min_ac1 > 0.05 && ac5 > 0 && ac10 > 0;
+
+    (void)ok;
+    assert(ok);
+    std::cout << "PASSED (" << std::fixed << std::setprecision(2) << rate << "/s vs " << want
+              << ", AC(|r|) 5/10 " << std::setprecision(3) << ac5 << "/" << ac10 << ")\n"
+              << std::defaultfloat;
+}
+
+void test_streaming_collection() {
+    std::cout << "TEST: Streamed column files match the in-memory series... ";
+    using namespace micro_exchange::sim;
+    namespace fs = std::filesystem;
+
+    // Horizons on a hand-built sequence: a trade at t=0.5 takes the mid of
+    // the first event at or after 1.5 s (short) and 5.5 s (long).
+    struct Capture {
+        std::vector<TradeSample> trades;
+        std::vector<Bar> bars;
+        size_t samples = 0;
+        void sample(double, Price, Price) { ++samples; }
+        void bar(const Bar& b) { bars.push_back(b); }
+        void trade(const TradeSample& s) { trades.push_back(s); }
+    } cap;
+    CollectOptions co;
+    co.bar_sec = 2.0;
+    DataCollector<Capture> dc(co, cap);
+    Trade tr{};
+    tr.price = 101; tr.quantity = 3; tr.aggressor = Side::Sell;
+    dc.event(0.5, 100, 2);
+    dc.trade(0.5, tr, 100);
+    dc.event(1.0, 101, 2);
+    dc.event(1.5, 102, 2);
+    dc.event(4.0, 103, 4);
+    dc.event(6.0, 104, 2);
+    dc.finish();
+    bool ok = cap.trades.size() == 1 && cap.trades[0].mid_after_short == 102
+           && cap.trades[0].mid_after_long == 104 && cap.samples == 0
+           && cap.bars.size() == 3 && cap.bars[0].events == 3 && cap.bars[0].trades == 1
+           && cap.bars[0].low == 100 && cap.bars[0].high == 102 && cap.bars[2].start == 6.0
+           && dc.stats().volume == 3 && dc.stats().spread.mean == 2.4;
+
+    Simulator::Config cfg;
+    cfg.duration = 60.0;
+    cfg.seed = 11;
+    const auto mem = Simulator(cfg).run();
+
+    // Streamed: same run, every series on disk, nothing in SimulationData.
+    const std::string dir = (fs::temp_directory_path() / "mx_test_columns").string();
+    fs::remove_all(dir);
+    cfg.collect.dir = dir;
+    const auto streamed = Simulator(cfg).run();
+    const auto& a = mem.collected;
+    const auto& b = streamed.collected;
+    ok = ok && streamed.columns_ok && streamed.trade_records.empty() && streamed.midprices.empty()
+       && a.trades == b.trades && a.volume == b.volume && a.notional == b.notional
+       && a.spread.mean == b.spread.mean && a.mid_change.m2 == b.mid_change.m2
+       && a.last_mid == b.last_mid && b.trades == mem.trade_records.size()
+       && b.peak_pending < b.trades / 4;
+
+    ColumnSink names(dir);
+    const auto mids  = read_column<int64_t>(names.path("mid"));
+    const auto times = read_column<double>(names.path("event_time"));
+    const auto px    = read_column<int64_t>(names.path("trade_price"));
+    const auto m5    = read_column<int64_t>(names.path("mid_after_long"));
+    const auto side  = read_column<uint8_t>(names.path("trade_side"));
+    ok = ok && mids == mem.midprices && times == mem.event_times
+       && px.size() == mem.trade_records.size() && m5.size() == px.size() && side.size() == px.size();
+    for (size_t i = 0; ok && i < px.size(); ++i) {
+        const auto& r = mem.trade_records[i];
+        ok = px[i] == r.trade_price && m5[i] == r.mid_after_5s
+          && side[i] == static_cast<uint8_t>(r.aggressor);
+    }
+    ok = ok && read_column<double>(names.path("mid")).empty();   // wrong type reads nothing
+
+    // Decimated samples and 1 s bars.
+    cfg.collect.dir.clear();
+    cfg.collect.decimate = 10;
+    const auto dec = Simulator(cfg).run();
+    ok = ok && dec.midprices.size() == (mem.midprices.size() + 9) / 10
+       && dec.midprices[1] == mem.midprices[10];
+
+    cfg.collect.decimate = 1;
+    cfg.collect.bar_sec = 1.0;
+    const auto bars = Simulator(cfg).run();
+    uint64_t events = 0, trades = 0;
+    for (const auto& bar : bars.bars) { events += bar.events; trades += bar.trades; }
+    ok = ok && bars.midprices.empty() && bars.bars.size() <= 60 && bars.bars.size() >= 55
+       && events == mem.total_orders && trades == mem.trade_records.size();
+
+    fs::remove_all(dir);
+    (void)ok;
+    assert(ok);
+    std::cout << "PASSED (" << b.trades << " trades, peak window " << b.peak_pending << ")\n";
+}
+
+void test_agent_order_tracking() {
+    std::cout << "TEST: Per-agent order tracking and strategic cancels... ";
+    using namespace micro_exchange::sim;
+
+    // Swap-remove keeps each agent's list dense; unknown ids are a no-op.
+    AgentOrders live(2);
+    for (OrderId id = 1; id <= 5; ++id) live.add(0, id, static_cast<Price>(100 + id));
+    live.add(1, 9, 90);
+    bool ok = live.size() == 6 && live.peak() == 6 && live.remove(2) && !live.remove(2)
+           && !live.remove(42) && live.size(0) == 4 && live.of(0)[1].id == 5
+           && live.of(0)[1].price == 105 && live.remove(5) && live.of(0)[1].id == 4
+           && live.remove(9) && live.size(1) == 0 && live.peak() == 6;
+
+    // review() resumes where it stopped and stays put over a removed slot.
+    std::vector<OrderId> seen;
+    size_t cancelled = live.review(0, 2, [&](const AgentOrders::Live& o) {
+        seen.push_back(o.id);
+        return o.id == 1 && live.remove(o.id);
+    });
+    cancelled += live.review(0, 2, [&](const AgentOrders::Live& o) {
+        seen.push_back(o.id);
+        return false;
+    });
+    ok = ok && cancelled == 1 && live.size(0) == 2
+       && seen == std::vector<OrderId>{1, 3, 4, 3};
+
+    // Simulated: agents' depth settles instead of piling up, and every
+    // cancel is a real one the book accepted.
+    Simulator::Config cfg;
+    cfg.duration = 300.0;
+    cfg.seed = 5;
+    const auto d = Simulator(cfg).run();
+    cfg.cancel_interval = 1e12;
+    const auto never = Simulator(cfg).run();
+    ok = ok && d.total_cancels > d.total_orders / 2 && d.peak_live_orders < 2000
+       && d.live_orders <= d.peak_live_orders && never.total_cancels == 0
+       && never.live_orders > 10 * d.peak_live_orders;
+
+    (void)ok;
+    assert(ok);
+    std::cout << "PASSED (peak " << d.peak_live_orders << " live vs " << never.live_orders
+              << " without cancels)\n";
+}
+
+void test_multi_symbol_simulation() {
+    std::cout << "TEST: Multi-symbol simulation is thread-count independent... ";
+    using namespace micro_exchange::sim;
+
+    MultiSymbolSimulator::Config mc;
+    mc.base.duration = 20.0;
+    mc.symbols = 6;
+    mc.seed = 3;
+    mc.cross_alpha = 5.0;
+
+    auto run = [&](size_t threads) {
+        mc.threads = threads;
+        return MultiSymbolSimulator(mc).run();
+    };
+    const auto one = run(1);
+    const auto many = run(4);
+
+    // Same seeds and barrier-published counts: same paths on any thread layout.
+    bool ok = one.symbols.size() == 6 && many.threads == 4 && one.events == many.events
+           && one.slices == 200 && one.trades > 0;
+    for (size_t i = 0; ok && i < one.symbols.size(); ++i) {
+        const auto& a = one.symbols[i];
+        const auto& b = many.symbols[i];
+        ok = a.symbol == b.symbol && a.events == b.events && a.trades == b.trades
+          && a.volume == b.volume && a.cancels == b.cancels && a.mean_spread == b.mean_spread
+          && a.mid_change_sd == b.mid_change_sd && a.final_mid == b.final_mid
+          && b.thread == i % 4 && a.peak_live_orders < 2000;
+    }
+    ok = ok && one.symbols[0].events != one.symbols[1].events;   // independent seeds
+
+    // Cross-excitation lifts everyone's rate: n = (35 + 5) / 50 against 35 / 50.
+    mc.cross_alpha = 0;
+    const auto alone = run(2);
+    const double lift = static_cast<double>(one.events) / static_cast<double>(alone.events);
+    ok = ok && lift > 1.25 && lift < 1.75;
+
+    (void)ok;
+    assert(ok);
+    std::cout << "PASSED (" << one.events << " events over " << one.symbols.size()
+              << " symbols, cross-excitation x" << std::fixed << std::setprecision(2) << lift << ")\n";
+}
+
+void test_online_analytics() {
+    std::cout << "TEST: Feed-driven online analytics match the batch analyzers... ";
+    using namespace micro_exchange::sim;
+    using namespace micro_exchange::analytics;
+    using micro_exchange::md::FeedPublisher;
+    using micro_exchange::md::FeedMessage;
+    using micro_exchange::md::FeedMessageType;
+
+    // The sketch: exact on a tick grid (either sign), ~3% relative off it.
+    QuantileSketch ticks;
+    for (double x : {5.0, -3.0, 0.0, 2.0, -1.0}) ticks.add(x);
+    bool ok = ticks.quantile(0.5) == 0 && ticks.quantile(0.25) == -1 && ticks.quantile(0) == -3
+           && ticks.quantile(1) == 5 && ticks.quantile(0.875) == 3.5;
+    std::mt19937_64 rng(7);
+    std::lognormal_distribution<double> dist(0.0, 0.75);
+    QuantileSketch fine(1e-3);
+    std::vector<double> xs;
+    for (int i = 0; i < 100000; ++i) {
+        xs.push_back(dist(rng));
+        fine.add(xs.back());
+    }
+    std::sort(xs.begin(), xs.end());
+    ok = ok && fine.count() == xs.size() && std::abs(fine.quantile(0.5) / xs[49999] - 1) < 0.035
+       && std::abs(fine.quantile(0.95) / xs[94999] - 1) < 0.035;
+
+    // A simulated session. The feed drives the online engine; the book and
+    // the engine's trade callback record what the batch analyzers need.
+    constexpr Price MID = 10000;
+    MatchingEngine engine;
+    auto& book = engine.add_symbol("TEST");
+    FeedPublisher::Options fo;
+    fo.retain_messages = false;
+    FeedPublisher feed(fo);
+    OnlineAnalytics::Options oo;
+    oo.initial_mid = MID;
+    OnlineAnalytics live(oo);
+    double now = 0;
+    std::vector<ImbalanceAnalyzer::BBOSnapshot> quotes;
+    feed.set_callback([&](const FeedMessage& m) {
+        live.on_message(m, now);
+        if (m.type == FeedMessageType::QuoteUpdate)
+            quotes.push_back({now, m.bid_price, m.bid_size, m.ask_price, m.ask_size});
+    });
+    feed.attach(book);
+    std::vector<std::pair<double, Trade>> trades;
+    engine.set_trade_callback([&](const Trade& t) { trades.emplace_back(now, t); });
+
+    OrderId id = 1;
+    for (int lvl = 1; lvl <= 10; ++lvl) {
+        for (Side side : {Side::Buy, Side::Sell}) {
+            NewOrderRequest r{};
+            r.id = id++;
+            r.side = side;
+            r.price = side == Side::Buy ? MID - lvl : MID + lvl;
+            r.quantity = 500;
+            std::strncpy(r.symbol, "TEST", 15);
+            engine.submit_order(r);
+        }
+    }
+
+    std::vector<ZIAgent> agents;
+    for (size_t i = 0; i < 10; ++i) {
+        ZIAgent::Parameters p;
+        p.agent_id = i;
+        p.sigma_price = 3.0 + (i % 3) * 1.5;
+        p.market_order_prob = 0.15 + (i % 4) * 0.02;
+        agents.emplace_back(p, 42 + i);
+    }
+    HawkesProcess::Parameters hp;
+    hp.mu = 50.0;
+    hp.alpha = 35.0;
+    hp.beta = 50.0;
+    HawkesProcess hawkes(hp, 99);
+    std::vector<std::pair<double, Price>> mids;
+    std::vector<Price> spreads;
+    size_t halfway_trades = 0, halfway_pending = 0;
+    while (auto ev = hawkes.next_sided(600.0)) {
+        now = ev->timestamp;
+        const Price mid = book.midprice().value_or(MID);
+        const Price sprd = book.spread().value_or(2);
+        mids.emplace_back(now, mid);
+        spreads.push_back(sprd);
+        auto req = agents[id % agents.size()].generate_order(mid, sprd, ev->is_buy, id, "TEST");
+        ++id;
+        engine.submit_order(req);
+        if (!halfway_trades && now > 300.0) {
+            halfway_trades  = live.spread().num_trades;   // live, mid-run
+            halfway_pending = live.pending();
+        }
+    }
+    feed.flush();
+    live.finish();
+
+    // Batch: the same definitions over the stored series.
+    auto mid_at = [&](double t) {
+        auto it = std::lower_bound(mids.begin(), mids.end(), t,
+                                   [](const auto& m, double v) { return m.first < v; });
+        return it == mids.end() ? mids.back().second : it->second;
+    };
+    std::vector<SpreadAnalyzer::TradeInput> si;
+    std::vector<ImpactAnalyzer::TradeInput> ki;
+    std::vector<ImbalanceAnalyzer::TradeInput> oi;
+    for (const auto& [t, tr] : trades) {
+        si.push_back({tr.price, mid_at(t), mid_at(t + 5.0), tr.quantity, tr.aggressor});
+        ki.push_back({t, tr.price, tr.quantity, tr.aggressor});
+        oi.push_back({t, tr.quantity, tr.aggressor});
+    }
+    const auto bs = SpreadAnalyzer().compute(si, spreads);
+    const auto bk = ImpactAnalyzer().estimate_kyle_lambda(ki, mids, 5.0);
+    const auto bo = ImbalanceAnalyzer().compute(quotes, oi, 10.0);
+    const auto ls = live.spread();
+    const auto lk = live.kyle();
+    const auto lo = live.imbalance();
+
+    auto near = [](double a, double b, double tol = 1e-9) {
+        return std::abs(a - b) <= tol * std::max(1.0, std::abs(b));
+    };
+    ok = ok && ls.num_trades == bs.num_trades && bs.num_trades > 1000
+       && near(ls.avg_quoted_spread, bs.avg_quoted_spread)
+       && near(ls.avg_effective_spread, bs.avg_effective_spread)
+       && near(ls.avg_realized_spread, bs.avg_realized_spread)
+       && near(ls.avg_price_impact, bs.avg_price_impact)
+       && near(ls.adverse_selection_pct, bs.adverse_selection_pct)
+       && near(ls.vwap_effective_spread, bs.vwap_effective_spread)
+       && near(ls.vwap_realized_spread, bs.vwap_realized_spread)
+       && ls.median_effective_spread == bs.median_effective_spread
+       && ls.p95_effective_spread == bs.p95_effective_spread;
+    ok = ok && lk.num_intervals == bk.num_intervals && bk.num_intervals > 100
+       && near(lk.lambda, bk.lambda, 1e-6) && near(lk.alpha, bk.alpha, 1e-6)
+       && near(lk.r_squared, bk.r_squared, 1e-6) && near(lk.t_statistic, bk.t_statistic, 1e-6);
+    ok = ok && near(lo.ofi_beta, bo.ofi_beta, 1e-6) && near(lo.ofi_r_squared, bo.ofi_r_squared, 1e-6)
+       && near(lo.ofi_t_stat, bo.ofi_t_stat, 1e-6) && bo.ofi_beta != 0
+       && near(lo.avg_volume_imbalance, bo.avg_volume_imbalance)
+       && near(lo.max_volume_imbalance, bo.max_volume_imbalance);
+
+    // Live mid-run, with only the reversion window buffered.
+    ok = ok && halfway_trades > bs.num_trades / 3 && halfway_pending > 0
+       && live.peak_pending() < bs.num_trades / 20;
+
+    (void)ok;
+    assert(ok);
+    std::cout << "PASSED (" << bs.num_trades << " trades, lambda " << std::scientific << std::setprecision(2)
+              << lk.lambda << std::defaultfloat << ", peak window " << live.peak_pending() << ")\n";
+}
+
+void test_series_kernels() {
+    std::cout << "TEST: Series kernels agree across paths, threads and the naive loops... ";
+    namespace k = micro_exchange::analytics::kernels;
+
+    // AR(1) with a mean, long enough for the threaded path, odd length for the tails.
+    std::mt19937_64 rng(17);
+    std::normal_distribution<double> eps(0.0, 1.0);
+    std::vector<double> x(k::PARALLEL_MIN + 13), y(x.size());
+    double prev = 0;
+    for (size_t i = 0; i < x.size(); ++i) {
+        prev = 0.6 * prev + eps(rng);
+        x[i] = 3.0 + prev;
+        y[i] = 0.5 * x[i] + eps(rng);
+    }
+
+    // Bitwise: vector path vs scalar, one thread vs four.
+    const k::Exec scalar{1, k::Isa::Scalar}, simd{1, k::Isa::Auto}, four{4, k::Isa::Auto};
+    const auto ms = k::moments(x, scalar), mv = k::moments(x, simd), mt = k::moments(x, four);
+    const auto cs = k::cross_moments(x, y, scalar), ct = k::cross_moments(x, y, four);
+    bool ok = ms.mean == mv.mean && ms.m2 == mv.m2 && ms.m3 == mv.m3 && ms.m4 == mv.m4
+           && mv.m2 == mt.m2 && mv.m4 == mt.m4 && cs.sxy == ct.sxy && cs.syy == ct.syy
+           && k::dot(x, y, scalar) == k::dot(x, y, four);
+
+    // Against the plain two-pass loops.
+    double mean = 0, m2 = 0, m4 = 0, sxy = 0;
+    for (double v : x) mean += v;
+    mean /= static_cast<double>(x.size());
+    double my = 0;
+    for (double v : y) my += v;
+    my /= static_cast<double>(y.size());
+    for (size_t i = 0; i < x.size(); ++i) {
+        const double d = x[i] - mean;
+        m2 += d * d;
+        m4 += d * d * d * d;
+        sxy += d * (y[i] - my);
+    }
+    auto rel = [](double a, double b) { return std::abs(a - b) <= 1e-10 * std::abs(b); };
+    ok = ok && rel(ms.mean, mean) && rel(ms.m2, m2) && rel(ms.m4, m4) && rel(cs.sxy, sxy)
+       && std::abs(cs.slope() - 0.5) < 0.01 && ms.excess_kurtosis() < 0.05;
+
+    // ACF: FFT (blocked, threaded) vs direct vs the per-lag loop it replaces.
+    const std::span<const double> head(x.data(), 300'000);
+    const auto direct = k::acf_direct(head, 200);
+    const auto fft = k::acf_fft(head, 200);
+    const auto fft4 = k::acf_fft(x, 200, four);
+    const auto fft1 = k::acf_fft(x, 200, k::Exec{1});
+    ok = ok && direct.size() == 201 && fft.size() == 201 && direct[0] == 1.0
+       && std::abs(direct[1] - 0.6) < 0.01 && fft4 == fft1;
+    for (size_t lag = 0; ok && lag <= 200; ++lag) ok = std::abs(fft[lag] - direct[lag]) < 1e-10;
+    for (size_t lag : {1, 7, 200}) {
+        double num = 0, den = 0;
+        double hm = 0;
+        for (double v : head) hm += v;
+        hm /= static_cast<double>(head.size());
+        for (size_t i = 0; i < head.size(); ++i) {
+            den += (head[i] - hm) * (head[i] - hm);
+            if (i >= lag) num += (head[i] - hm) * (head[i - lag] - hm);
+        }
+        ok = ok && std::abs(direct[lag] - num / den) < 1e-12;
+    }
+    // Every lag of a short series in one transform; constant series is all zeros.
+    const std::span<const double> shortx(x.data(), 1000);
+    const auto all_fft = k::acf_fft(shortx, 5000), all_direct = k::acf_direct(shortx, 5000);
+    ok = ok && all_fft.size() == 1000 && all_direct.size() == 1000;
+    for (size_t lag = 0; ok && lag < 1000; ++lag) ok = std::abs(all_fft[lag] - all_direct[lag]) < 1e-12;
+    const std::vector<double> flat(100, 2.0);
+    ok = ok && k::acf(flat, 50) == std::vector<double>(51, 0.0);
+
+    // Log returns skip non-positive prices, and unchanged prices are exact zeros.
+    const std::vector<double> px = {100, 101, 101, 0, 99, 98};
+    const auto lr = k::log_returns(px);
+    ok = ok && lr.size() == 3 && lr[0] == std::log(101.0 / 100.0) && lr[1] == 0.0
+       && lr[2] == std::log(98.0 / 99.0);
+
+    (void)ok;
+    assert(ok);
+    std::cout << "PASSED (" << k::isa_name(k::detected_isa()) << ", ACF(1) " << std::fixed
+              << std::setprecision(3) << direct[1] << std::defaultfloat << ")\n";
+}
+
 int main() {
     std::cout << "\n══════════════════════════════════════════════\n";
     std::cout << "  MicroExchange — Invariant Test Suite\n";
@@ -510,6 +2650,35 @@ int main() {
     test_stop_limit_triggers_and_rests();
     test_stop_cancel();
     test_multi_listener_fanout();
+    test_array_book_stops_and_amend();
+    test_array_book_recenter();
+    test_array_book_band_cap();
+    test_array_matching_engine();
+    test_symbol_id_routing();
+    test_order_index_fuzz();
+    test_stop_book_fuzz();
+    test_arena_backing();
+    test_compact_level_matches_price_level();
+    test_static_sink_dispatch();
+    test_sharded_engine_determinism();
+    test_sharded_submit_drains_output();
+    test_batch_matches_sequential();
+    test_checkpoint_warm_restart();
+    test_feed_quote_modes();
+    test_depth_feed();
+    test_feed_compact_stream();
+    test_mapped_feed_replay();
+    test_ring_buffers();
+    test_latency_probes();
+    test_event_clock();
+    test_simulation_batch();
+    test_hawkes_stream();
+    test_hawkes_clustering();
+    test_streaming_collection();
+    test_agent_order_tracking();
+    test_multi_symbol_simulation();
+    test_online_analytics();
+    test_series_kernels();
 
     std::cout << "\n══════════════════════════════════════════════\n";
     std::cout << "  ALL TESTS PASSED ✓\n";
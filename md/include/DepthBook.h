@@ -0,0 +1,88 @@
+#pragma once
+
+#include "FeedMessage.h"
+#include "BookConcept.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace micro_exchange::md {
+
+using namespace micro_exchange::core;
+
+/**
+ * DepthBook — consumer side of the market-by-price feed.
+ *
+ * Keeps the top levels of one symbol from FeedPublisher LevelUpdate and
+ * depth-snapshot messages alone; no order-by-order state. An S header
+ * clears both sides and the LevelSnapshots that follow rebuild them, so a
+ * consumer that joins late (or detects a gap) waits for the next snapshot.
+ * Everything else on the feed is ignored.
+ */
+class DepthBook {
+public:
+    explicit DepthBook(const std::string& symbol) {
+        std::memcpy(symbol_, symbol.data(), std::min(symbol.size(), sizeof(symbol_) - 1));
+    }
+
+    /// Apply one feed message. False if it was not depth for this symbol,
+    /// or named a rank this view does not have (the stream is out of sync).
+    bool apply(const FeedMessage& msg) {
+        if (std::memcmp(msg.symbol, symbol_, sizeof(symbol_)) != 0) return false;
+        switch (msg.type) {
+            case FeedMessageType::Snapshot:
+                bids_.clear();
+                asks_.clear();
+                return true;
+            case FeedMessageType::LevelSnapshot: {
+                auto& side = side_of(msg.side);
+                if (msg.level_index != side.size()) return false;
+                side.push_back(level_of(msg));
+                return true;
+            }
+            case FeedMessageType::LevelUpdate:
+                return apply_update(msg);
+            default:
+                return false;
+        }
+    }
+
+    [[nodiscard]] const std::vector<BookLevel>& bids() const noexcept { return bids_; }
+    [[nodiscard]] const std::vector<BookLevel>& asks() const noexcept { return asks_; }
+
+private:
+    static BookLevel level_of(const FeedMessage& m) {
+        return {m.price, m.quantity, m.level_orders};
+    }
+
+    std::vector<BookLevel>& side_of(Side s) { return s == Side::Buy ? bids_ : asks_; }
+
+    bool apply_update(const FeedMessage& msg) {
+        auto& side = side_of(msg.side);
+        const size_t i = msg.level_index;
+        switch (msg.level_action) {
+            case LevelAction::Add:
+                if (i > side.size()) return false;
+                side.insert(side.begin() + static_cast<std::ptrdiff_t>(i), level_of(msg));
+                return true;
+            case LevelAction::Update:
+                if (i >= side.size() || side[i].price != msg.price) return false;
+                side[i] = level_of(msg);
+                return true;
+            case LevelAction::Delete:
+                if (i >= side.size() || side[i].price != msg.price) return false;
+                side.erase(side.begin() + static_cast<std::ptrdiff_t>(i));
+                return true;
+        }
+        return false;
+    }
+
+    char symbol_[16] = {};
+    std::vector<BookLevel> bids_;
+    std::vector<BookLevel> asks_;
+};
+
+} // namespace micro_exchange::md
@@ -0,0 +1,206 @@
+#pragma once
+
+#include "FeedMessage.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace micro_exchange::md {
+
+/**
+ * Compact feed encoding — ITCH-style packed frames with per-type layouts.
+ *
+ * The in-memory FeedMessage is a flat 192-byte struct whatever its type; on
+ * disk (and later on the wire) each message carries only its own fields:
+ *
+ *   frame   u16 length (bytes that follow) | u8 type | common | body
+ *   common  u64 sequence, u64 timestamp_ns, u8 symbol length, symbol bytes
+ *
+ *   A  u64 order_id, u8 side, u8 order_type, u8 order_status, i64 price,
+ *      u64 quantity, [i64 stop_price — only when non-zero]
+ *   T  u64 buy order_id, u64 sell match_id, i64 price, u64 quantity,
+ *      u8 aggressor_side
+ *   D  u64 order_id, u8 side, u8 order_type, i64 price
+ *   Q  i64 bid_price, u64 bid_size, i64 ask_price, u64 ask_size
+ *   S  i64 best_bid, i64 best_ask, u64 bid_depth, u64 ask_depth
+ *   L, M  u8 side, u8 level_action, u32 level_index, i64 price,
+ *         u64 quantity, u32 level_orders
+ *   E, X, U  common only
+ *
+ * Fields are packed with no padding in host byte order, like the rest of
+ * the binary formats here. A 4-character-symbol Add is 51 bytes, a Trade
+ * 57. A compact file starts with FEED_FILE_MAGIC; a file without it is the
+ * legacy run of raw FeedMessages, and FeedReplayer reads both.
+ */
+
+enum class FeedFormat : uint8_t {
+    Fixed,     // raw FeedMessage records (dump_to_file's original format)
+    Compact,   // FEED_FILE_MAGIC + length-prefixed frames
+};
+
+inline constexpr char   FEED_FILE_MAGIC[8] = {'M', 'X', 'F', 'E', 'E', 'D', '\0', '\1'};
+inline constexpr size_t MAX_FRAME_BYTES    = 96;   // largest frame, 15-char symbol
+
+namespace detail {
+
+template <typename T>
+inline std::byte* put(std::byte* p, T v) {
+    std::memcpy(p, &v, sizeof(v));
+    return p + sizeof(v);
+}
+
+struct FrameReader {
+    const std::byte* p;
+    const std::byte* end;
+    bool ok = true;
+
+    template <typename T>
+    T take() {
+        T v{};
+        if (static_cast<size_t>(end - p) < sizeof(T)) { ok = false; return v; }
+        std::memcpy(&v, p, sizeof(v));
+        p += sizeof(v);
+        return v;
+    }
+};
+
+} // namespace detail
+
+/// Encode `m` as one frame at `out` (room for MAX_FRAME_BYTES). Returns its size.
+inline size_t encode_frame(const FeedMessage& m, std::byte* out) {
+    using detail::put;
+    std::byte* p = out + sizeof(uint16_t);
+    p = put(p, static_cast<uint8_t>(m.type));
+    p = put(p, m.sequence);
+    p = put(p, m.timestamp_ns);
+    const auto sym_len = static_cast<uint8_t>(strnlen(m.symbol, sizeof(m.symbol) - 1));
+    p = put(p, sym_len);
+    std::memcpy(p, m.symbol, sym_len);
+    p += sym_len;
+
+    switch (m.type) {
+        case FeedMessageType::AddOrder:
+            p = put(p, m.order_id);
+            p = put(p, m.side);
+            p = put(p, m.order_type);
+            p = put(p, m.order_status);
+            p = put(p, m.price);
+            p = put(p, m.quantity);
+            if (m.stop_price != 0) p = put(p, m.stop_price);
+            break;
+        case FeedMessageType::Trade:
+            p = put(p, m.order_id);
+            p = put(p, m.match_id);
+            p = put(p, m.price);
+            p = put(p, m.quantity);
+            p = put(p, m.aggressor_side);
+            break;
+        case FeedMessageType::DeleteOrder:
+            p = put(p, m.order_id);
+            p = put(p, m.side);
+            p = put(p, m.order_type);
+            p = put(p, m.price);
+            break;
+        case FeedMessageType::QuoteUpdate:
+            p = put(p, m.bid_price);
+            p = put(p, m.bid_size);
+            p = put(p, m.ask_price);
+            p = put(p, m.ask_size);
+            break;
+        case FeedMessageType::Snapshot:
+            p = put(p, m.best_bid);
+            p = put(p, m.best_ask);
+            p = put(p, m.bid_depth);
+            p = put(p, m.ask_depth);
+            break;
+        case FeedMessageType::LevelUpdate:
+        case FeedMessageType::LevelSnapshot:
+            p = put(p, m.side);
+            p = put(p, m.level_action);
+            p = put(p, m.level_index);
+            p = put(p, m.price);
+            p = put(p, m.quantity);
+            p = put(p, m.level_orders);
+            break;
+        default:
+            break;
+    }
+    const auto len = static_cast<size_t>(p - out);
+    put(out, static_cast<uint16_t>(len - sizeof(uint16_t)));
+    return len;
+}
+
+/**
+ * Decode the frame at `in` into `m`. Returns the frame's size, or 0 if
+ * `avail` bytes do not hold a whole frame or the frame is malformed (its
+ * length disagrees with its type's layout).
+ */
+inline size_t decode_frame(const std::byte* in, size_t avail, FeedMessage& m) {
+    if (avail < sizeof(uint16_t)) return 0;
+    uint16_t len;
+    std::memcpy(&len, in, sizeof(len));
+    const size_t total = sizeof(len) + len;
+    if (avail < total) return 0;
+
+    detail::FrameReader r{in + sizeof(len), in + total};
+    m = FeedMessage{};
+    m.type         = static_cast<FeedMessageType>(r.take<uint8_t>());
+    m.sequence     = r.take<SeqNum>();
+    m.timestamp_ns = r.take<uint64_t>();
+    const auto sym_len = r.take<uint8_t>();
+    if (!r.ok || sym_len >= sizeof(m.symbol) || static_cast<size_t>(r.end - r.p) < sym_len) return 0;
+    std::memcpy(m.symbol, r.p, sym_len);
+    r.p += sym_len;
+
+    switch (m.type) {
+        case FeedMessageType::AddOrder:
+            m.order_id     = r.take<OrderId>();
+            m.side         = r.take<Side>();
+            m.order_type   = r.take<OrderType>();
+            m.order_status = r.take<OrderStatus>();
+            m.price        = r.take<Price>();
+            m.quantity     = r.take<Quantity>();
+            if (r.p != r.end) m.stop_price = r.take<Price>();   // length says it's there
+            break;
+        case FeedMessageType::Trade:
+            m.order_id       = r.take<OrderId>();
+            m.match_id       = r.take<OrderId>();
+            m.price          = r.take<Price>();
+            m.quantity       = r.take<Quantity>();
+            m.aggressor_side = r.take<Side>();
+            break;
+        case FeedMessageType::DeleteOrder:
+            m.order_id   = r.take<OrderId>();
+            m.side       = r.take<Side>();
+            m.order_type = r.take<OrderType>();
+            m.price      = r.take<Price>();
+            break;
+        case FeedMessageType::QuoteUpdate:
+            m.bid_price = r.take<Price>();
+            m.bid_size  = r.take<Quantity>();
+            m.ask_price = r.take<Price>();
+            m.ask_size  = r.take<Quantity>();
+            break;
+        case FeedMessageType::Snapshot:
+            m.best_bid  = r.take<Price>();
+            m.best_ask  = r.take<Price>();
+            m.bid_depth = r.take<Quantity>();
+            m.ask_depth = r.take<Quantity>();
+            break;
+        case FeedMessageType::LevelUpdate:
+        case FeedMessageType::LevelSnapshot:
+            m.side         = r.take<Side>();
+            m.level_action = r.take<LevelAction>();
+            m.level_index  = r.take<uint32_t>();
+            m.price        = r.take<Price>();
+            m.quantity     = r.take<Quantity>();
+            m.level_orders = r.take<uint32_t>();
+            break;
+        default:
+            break;
+    }
+    return r.ok && r.p == r.end ? total : 0;
+}
+
+} // namespace micro_exchange::md
@@ -23,6 +23,8 @@ using namespace micro_exchange::core;
  *   S — Snapshot (full book state)
  *   T — Trade (execution report)
  *   Q — Quote update (BBO change)
+ *   L — Level update (market-by-price: one level's new aggregate)
+ *   M — Level snapshot (one level of a depth snapshot, after an S)
  */
 
 enum class FeedMessageType : uint8_t {
@@ -34,17 +36,26 @@ enum class FeedMessageType : uint8_t {
     Trade           = 'T',
     QuoteUpdate     = 'Q',
     SystemEvent     = 'E',
+    LevelUpdate     = 'L',
+    LevelSnapshot   = 'M',
+};
+
+/// What a LevelUpdate does to the level at `level_index` (0 = best).
+enum class LevelAction : uint8_t {
+    Add    = 'N',   // new level at level_index; deeper levels move down one
+    Update = 'C',   // level at level_index has a new quantity / order count
+    Delete = 'X',   // level at level_index is gone; deeper levels move up one
 };
 
 /**
  * Fixed-size feed message for zero-copy transport over the SPSC buffer.
- * 128 bytes — fits two cache lines.
+ * 192 bytes — three cache lines.
  */
 struct alignas(64) FeedMessage {
     // ── Header (common to all message types) ──
     FeedMessageType type     = FeedMessageType::SystemEvent;
     SeqNum          sequence = 0;
-    uint64_t        timestamp_ns = 0;  // Nanoseconds since epoch
+    uint64_t        timestamp_ns = 0;  // EventClock ns (core/Clock.h)
     char            symbol[16] = {};
 
     // ── Payload (union-style, type-dependent) ──
@@ -53,6 +64,10 @@ struct alignas(64) FeedMessage {
 
     OrderId  order_id     = 0;
     Side     side         = Side::Buy;
+    OrderType   order_type   = OrderType::Limit;   // Add / Delete: Stop or StopLimit = parked
+    OrderStatus order_status = OrderStatus::New;   // Add: New, Amended or PartiallyFilled
+    LevelAction level_action = LevelAction::Add;   // L only
+    uint32_t    level_orders = 0;                  // L / M: orders at the level
     Price    price        = 0;
     Quantity quantity     = 0;
     Quantity leaves_qty   = 0;
@@ -73,17 +88,27 @@ struct alignas(64) FeedMessage {
     Quantity bid_size     = 0;
     Quantity ask_size     = 0;
 
+    // For adds of parked stops
+    Price    stop_price   = 0;
+
+    // For level updates / snapshots: rank from the touch (price, side and
+    // quantity above carry the level itself)
+    uint32_t level_index  = 0;
+
     // ── Factory methods ──
 
     static FeedMessage make_add(SeqNum seq, const Order& order) {
         FeedMessage msg{};
         msg.type = FeedMessageType::AddOrder;
         msg.sequence = seq;
-        msg.timestamp_ns = timestamp_ns_val(order.entry_time);
+        msg.timestamp_ns = core::timestamp_ns(order.entry_time);
         std::memcpy(msg.symbol, order.symbol, sizeof(msg.symbol));
         msg.order_id = order.id;
         msg.side = order.side;
+        msg.order_type = order.type;
+        msg.order_status = order.status;
         msg.price = order.price;
+        msg.stop_price = order.stop_price;
         msg.quantity = order.leaves_qty;
         return msg;
     }
@@ -92,7 +117,7 @@ struct alignas(64) FeedMessage {
         FeedMessage msg{};
         msg.type = FeedMessageType::Trade;
         msg.sequence = seq;
-        msg.timestamp_ns = timestamp_ns_val(trade.exec_time);
+        msg.timestamp_ns = core::timestamp_ns(trade.exec_time);
         std::memcpy(msg.symbol, trade.symbol, sizeof(msg.symbol));
         msg.order_id = trade.buy_order_id;
         msg.match_id = trade.sell_order_id;
@@ -106,10 +131,11 @@ struct alignas(64) FeedMessage {
         FeedMessage msg{};
         msg.type = FeedMessageType::DeleteOrder;
         msg.sequence = seq;
-        msg.timestamp_ns = timestamp_ns_val(order.last_update);
+        msg.timestamp_ns = core::timestamp_ns(order.last_update);
         std::memcpy(msg.symbol, order.symbol, sizeof(msg.symbol));
         msg.order_id = order.id;
         msg.side = order.side;
+        msg.order_type = order.type;
         msg.price = order.price;
         return msg;
     }
@@ -120,7 +146,7 @@ struct alignas(64) FeedMessage {
         FeedMessage msg{};
         msg.type = FeedMessageType::QuoteUpdate;
         msg.sequence = seq;
-        msg.timestamp_ns = timestamp_ns_val(now());
+        msg.timestamp_ns = core::timestamp_ns(now());
         std::memcpy(msg.symbol, sym, std::min(strlen(sym), sizeof(msg.symbol)));
         msg.bid_price = bid_p;
         msg.bid_size = bid_s;
@@ -129,17 +155,25 @@ struct alignas(64) FeedMessage {
         return msg;
     }
 
-private:
-    static uint64_t timestamp_ns_val(Timestamp ts) {
-        return static_cast<uint64_t>(
-            std::chrono::duration_cast<std::chrono::nanoseconds>(
-                ts.time_since_epoch()
-            ).count()
-        );
+    static FeedMessage make_level(SeqNum seq, FeedMessageType type, const char* sym,
+                                  Side side, LevelAction action, uint32_t index,
+                                  Price price, Quantity qty, uint32_t orders, uint64_t ts_ns) {
+        FeedMessage msg{};
+        msg.type = type;
+        msg.sequence = seq;
+        msg.timestamp_ns = ts_ns;
+        std::memcpy(msg.symbol, sym, std::min(strlen(sym), sizeof(msg.symbol)));
+        msg.side = side;
+        msg.level_action = action;
+        msg.level_index = index;
+        msg.price = price;
+        msg.quantity = qty;
+        msg.level_orders = orders;
+        return msg;
     }
 };
 
-static_assert(sizeof(FeedMessage) <= 256,
-    "FeedMessage should fit in a small number of cache lines");
+static_assert(sizeof(FeedMessage) == 192,
+    "FeedMessage is three cache lines; new fields go in padding");
 
 } // namespace micro_exchange::md
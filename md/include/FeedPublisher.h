@@ -1,11 +1,19 @@
 #pragma once
 
 #include "FeedMessage.h"
+#include "FeedCodec.h"
+#include "FeedWriter.h"
+#include "MappedFeed.h"
 #include "SPSCRingBuffer.h"
+#include "BookConcept.h"
+#include "EventSink.h"
 #include "OrderBook.h"
 
+#include <algorithm>
 #include <vector>
 #include <functional>
+#include <optional>
+#include <span>
 #include <fstream>
 #include <string>
 
@@ -32,34 +40,150 @@ public:
 
     using MessageCallback = std::function<void(const FeedMessage&)>;
 
+    /**
+     * When a QuoteUpdate (BBO) goes out.
+     *
+     *   EveryEvent  — after every trade and order event while both sides are
+     *                 quoted, unchanged or not (the original behaviour)
+     *   ChangeOnly  — only when the best bid / ask price or size differs from
+     *                 the last quote published for that book (default)
+     *   Conflated   — change-only, and at most one quote per inbound event
+     *                 (one add / cancel / amend / batch call on the book) or,
+     *                 with `conflation_ns`, per slice of that much event time.
+     *                 An interval's quote goes out ahead of the first message
+     *                 of the next one, or on flush().
+     */
+    enum class QuoteMode : uint8_t { EveryEvent, ChangeOnly, Conflated };
+
+    /**
+     * Market-by-price (L2) depth. With `depth_levels` > 0 the publisher keeps
+     * the top `depth_levels` of each side from the books' level events and
+     * publishes a LevelUpdate for every change there: Add / Update / Delete
+     * at a rank from the touch, with the level's new quantity and order
+     * count. Levels sliding in from below the cut-off go out as Adds. A
+     * depth snapshot (an S header, then one LevelSnapshot per level, best
+     * first) goes out on attach to a non-empty book, every
+     * `depth_snapshot_every` level updates of a book, and on request.
+     */
+    struct Options {
+        QuoteMode quote_mode    = QuoteMode::ChangeOnly;
+        uint64_t  conflation_ns = 0;   // Conflated: 0 = per inbound event
+        size_t    depth_levels  = 0;   // L2 feed: levels per side, 0 = off
+        uint64_t  depth_snapshot_every = 0;   // 0 = only on attach / request
+        bool      retain_messages = true;     // keep every message for messages() / dump_to_file
+    };
+
     FeedPublisher() = default;
+    explicit FeedPublisher(Options opts) : opts_(opts) {}
 
     /**
-     * Wire up to an OrderBook's callbacks.
+     * Wire up to a book's callbacks (any `OrderBookLike` backend).
      *
-     * Uses the multi-listener fan-out so the engine's own trade routing and
+     * If the book's compile-time sink chains a `FeedSink`, the publisher
+     * binds itself there and is called directly from matching. Otherwise it
+     * uses the multi-listener fan-out so the engine's own trade routing and
      * any other subscribers continue to receive events alongside us.
      */
-    void attach(OrderBook& book) {
-        book.add_trade_listener([this, &book](const Trade& trade) {
-            publish_trade(trade);
-            publish_bbo_update(book);
+    template <OrderBookLike Book>
+    void attach(Book& book);
+
+    // ── Sink interface (called by the book, statically or via a listener) ──
+
+    template <OrderBookLike Book>
+    void on_trade(const Book& book, const Trade& trade) {
+        event_ns_ = timestamp_ns(trade.exec_time);
+        last_aggressor_ = trade.aggressor == Side::Buy ? trade.buy_order_id : trade.sell_order_id;
+        begin_event(book, trade.exec_time);
+        publish_trade(trade);
+        end_event(book);
+    }
+
+    // Every order that comes to rest — new, amended, or the remainder of an
+    // aggressor that traded first (PartiallyFilled, reported right after its
+    // own prints) — is an Add; together with Trade and Delete that is enough
+    // to rebuild the book from the feed (FeedRecovery.h).
+    template <OrderBookLike Book>
+    void on_order(const Book& book, const Order& order) {
+        event_ns_ = timestamp_ns(order.last_update);
+        begin_event(book, order.last_update);
+        const bool rests_after_trading = order.status == OrderStatus::PartiallyFilled
+                                      && order.id == last_aggressor_;
+        if (order.status == OrderStatus::New || order.status == OrderStatus::Amended
+            || rests_after_trading) {
+            publish_add(order);
+        } else if (order.status == OrderStatus::Cancelled) {
+            publish_delete(order);
+        }
+        end_event(book);
+    }
+
+    // A level's aggregate changed. Books report it after the trade / order
+    // event that caused it, so L messages follow that event's A / T / D.
+    template <OrderBookLike Book>
+    void on_level(const Book& book, Side side, const BookLevel& level) {
+        if (opts_.depth_levels == 0) return;
+        BookState& st = state_for(book);
+        auto& view = st.depth[side_index(side)];
+        const size_t n = opts_.depth_levels;
+
+        auto it = std::find_if(view.begin(), view.end(), [&](const BookLevel& l) {
+            return !better(side, l.price, level.price);
         });
+        const auto rank = static_cast<uint32_t>(it - view.begin());
+        const bool known = it != view.end() && it->price == level.price;
 
-        book.add_order_listener([this, &book](const Order& order) {
-            if (order.status == OrderStatus::New || order.status == OrderStatus::Amended) {
-                publish_add(order);
-            } else if (order.status == OrderStatus::Cancelled) {
-                publish_delete(order);
+        if (level.order_count == 0) {
+            if (!known) return;
+            view.erase(it);
+            publish_level(st, side, LevelAction::Delete, rank, {level.price, 0, 0});
+            if (view.size() == n - 1) refill_depth(book, st, side);   // was full: pull one up
+        } else if (known) {
+            if (it->quantity == level.quantity && it->order_count == level.order_count) return;
+            *it = level;
+            publish_level(st, side, LevelAction::Update, rank, level);
+        } else {
+            if (rank >= n) return;   // below the cut-off
+            view.insert(it, level);
+            publish_level(st, side, LevelAction::Add, rank, level);
+            if (view.size() > n) {
+                const BookLevel out = view.back();
+                view.pop_back();
+                publish_level(st, side, LevelAction::Delete, static_cast<uint32_t>(n), out);
             }
-            publish_bbo_update(book);
-        });
+        }
+        if (opts_.depth_snapshot_every && ++st.depth_updates >= opts_.depth_snapshot_every) {
+            publish_depth_snapshot(st);
+        }
+    }
+
+    /// Publish a depth snapshot of `book` now (requires depth_levels > 0).
+    template <OrderBookLike Book>
+    void generate_depth_snapshot(const Book& book) {
+        if (opts_.depth_levels) publish_depth_snapshot(state_for(book));
+    }
+
+    /// The top `depth_levels` of one side as last published, best first.
+    template <OrderBookLike Book>
+    [[nodiscard]] std::span<const BookLevel> depth(const Book& book, Side side) const {
+        for (const auto& st : book_states_) {
+            if (st.book == &book) return st.depth[side_index(side)];
+        }
+        return {};
+    }
+
+    /// Publish every conflated quote still pending (end of session, before
+    /// dump_to_file, or whenever a consumer needs the current top now).
+    void flush() {
+        for (auto& st : book_states_) close_interval(st);
     }
 
+    [[nodiscard]] const Options& options() const noexcept { return opts_; }
+
     /**
      * Generate a full book snapshot for recovery.
      */
-    FeedMessage generate_snapshot(const OrderBook& book) {
+    template <OrderBookLike Book>
+    FeedMessage generate_snapshot(const Book& book) {
         FeedMessage snap{};
         snap.type = FeedMessageType::Snapshot;
         snap.sequence = next_seq_++;
@@ -74,23 +198,37 @@ public:
         const char* sym = book.symbol().c_str();
         std::memcpy(snap.symbol, sym, std::min(book.symbol().size(), size_t(16)));
 
-        if (callback_) callback_(snap);
-        messages_.push_back(snap);
+        emit(snap);
         return snap;
     }
 
     void set_callback(MessageCallback cb) { callback_ = std::move(cb); }
 
+    /// Stream every message to `writer` as it is published (null = off).
+    /// With `retain_messages = false` this is the bounded-memory setup for
+    /// long sessions: nothing accumulates in the publisher.
+    void set_writer(FeedWriter* writer) noexcept { writer_ = writer; }
+
     [[nodiscard]] const std::vector<FeedMessage>& messages() const { return messages_; }
     [[nodiscard]] SeqNum sequence() const { return next_seq_; }
 
     /**
-     * Write all messages to binary file for replay.
+     * Write all retained messages to a binary file for replay: raw
+     * FeedMessage records (Fixed, the original layout) or Compact frames.
      */
-    void dump_to_file(const std::string& path) const {
+    void dump_to_file(const std::string& path, FeedFormat format = FeedFormat::Fixed) const {
         std::ofstream ofs(path, std::ios::binary);
+        if (format == FeedFormat::Fixed) {
+            for (const auto& msg : messages_) {
+                ofs.write(reinterpret_cast<const char*>(&msg), sizeof(FeedMessage));
+            }
+            return;
+        }
+        ofs.write(FEED_FILE_MAGIC, sizeof(FEED_FILE_MAGIC));
+        std::byte frame[MAX_FRAME_BYTES];
         for (const auto& msg : messages_) {
-            ofs.write(reinterpret_cast<const char*>(&msg), sizeof(FeedMessage));
+            const size_t n = encode_frame(msg, frame);
+            ofs.write(reinterpret_cast<const char*>(frame), static_cast<std::streamsize>(n));
         }
     }
 
@@ -104,44 +242,55 @@ public:
         uint64_t delete_count   = 0;
         uint64_t snapshot_count = 0;
         uint64_t quote_count    = 0;
+        uint64_t level_update_count   = 0;
+        uint64_t level_snapshot_count = 0;
+        uint64_t quotes_suppressed = 0;   // top of book unchanged: no quote
+        uint64_t quotes_conflated  = 0;   // changed top merged into a later quote
     };
 
+    /// Counted as messages are published, so they cover streamed-only runs.
     [[nodiscard]] FeedStats get_stats() const {
-        FeedStats s{};
-        s.total_messages = messages_.size();
-        for (const auto& m : messages_) {
-            switch (m.type) {
-                case FeedMessageType::AddOrder:    ++s.add_count; break;
-                case FeedMessageType::Trade:       ++s.trade_count; break;
-                case FeedMessageType::DeleteOrder:  ++s.delete_count; break;
-                case FeedMessageType::Snapshot:     ++s.snapshot_count; break;
-                case FeedMessageType::QuoteUpdate:  ++s.quote_count; break;
-                default: break;
-            }
-        }
+        FeedStats s = counts_;
+        s.quotes_suppressed = quotes_suppressed_;
+        s.quotes_conflated  = quotes_conflated_;
         return s;
     }
 
 private:
+    void emit(const FeedMessage& msg) {
+        ++counts_.total_messages;
+        switch (msg.type) {
+            case FeedMessageType::AddOrder:      ++counts_.add_count; break;
+            case FeedMessageType::Trade:         ++counts_.trade_count; break;
+            case FeedMessageType::DeleteOrder:   ++counts_.delete_count; break;
+            case FeedMessageType::Snapshot:      ++counts_.snapshot_count; break;
+            case FeedMessageType::QuoteUpdate:   ++counts_.quote_count; break;
+            case FeedMessageType::LevelUpdate:   ++counts_.level_update_count; break;
+            case FeedMessageType::LevelSnapshot: ++counts_.level_snapshot_count; break;
+            default: break;
+        }
+        if (callback_) callback_(msg);
+        if (writer_) writer_->push(msg);
+        if (opts_.retain_messages) messages_.push_back(msg);
+    }
+
     void publish_trade(const Trade& trade) {
         auto msg = FeedMessage::make_trade(next_seq_++, trade);
-        if (callback_) callback_(msg);
-        messages_.push_back(msg);
+        emit(msg);
     }
 
     void publish_add(const Order& order) {
         auto msg = FeedMessage::make_add(next_seq_++, order);
-        if (callback_) callback_(msg);
-        messages_.push_back(msg);
+        emit(msg);
     }
 
     void publish_delete(const Order& order) {
         auto msg = FeedMessage::make_delete(next_seq_++, order);
-        if (callback_) callback_(msg);
-        messages_.push_back(msg);
+        emit(msg);
     }
 
-    void publish_bbo_update(const OrderBook& book) {
+    template <OrderBookLike Book>
+    void publish_bbo_update(const Book& book) {
         auto bb = book.best_bid();
         auto ba = book.best_ask();
         if (bb && ba) {
@@ -153,18 +302,234 @@ private:
                 *bb, bids.empty() ? 0 : bids[0].quantity,
                 *ba, asks.empty() ? 0 : asks[0].quantity
             );
-            if (callback_) callback_(msg);
-            messages_.push_back(msg);
+            emit(msg);
+        }
+    }
+
+    // ── Change-only / conflated quotes ──
+
+    struct Bbo {
+        Price    bid_price = 0;
+        Quantity bid_size  = 0;
+        Price    ask_price = 0;
+        Quantity ask_size  = 0;
+        bool operator==(const Bbo&) const = default;
+    };
+
+    // Per-book quote and depth state; nullopt = not two-sided.
+    struct BookState {
+        const void*        book = nullptr;
+        char               symbol[16] = {};
+        std::vector<BookLevel> depth[2];       // bids, asks: top depth_levels, best first
+        uint64_t           depth_updates = 0;  // level updates since the last snapshot
+        std::optional<Bbo> published;          // last QuoteUpdate sent
+        std::optional<Bbo> latest;             // top after the last event seen
+        uint64_t           changes      = 0;   // distinct tops seen this interval
+        uint64_t           interval_ns  = 0;   // event time that opened it
+        uint64_t           last_ns      = 0;   // event time of the last event
+        bool               open         = false;
+    };
+
+    // Top of book as a quote would show it. Mid-match, a level whose last
+    // order just filled is still the best until the book erases it, so an
+    // empty best level is skipped for the next one (the rare slow path).
+    template <OrderBookLike Book>
+    static std::optional<Bbo> top_of_book(const Book& book) {
+        auto bb = book.best_bid();
+        auto ba = book.best_ask();
+        if (!bb || !ba) return std::nullopt;
+        Bbo q{*bb, book.bid_depth(1), *ba, book.ask_depth(1)};
+        if (q.bid_size == 0) {
+            auto lv = book.get_bids(2);
+            if (lv.size() < 2) return std::nullopt;
+            q.bid_price = lv[1].price;
+            q.bid_size  = lv[1].quantity;
+        }
+        if (q.ask_size == 0) {
+            auto lv = book.get_asks(2);
+            if (lv.size() < 2) return std::nullopt;
+            q.ask_price = lv[1].price;
+            q.ask_size  = lv[1].quantity;
+        }
+        return q;
+    }
+
+    template <OrderBookLike Book>
+    BookState& state_for(const Book& book) {
+        const void* key = &book;
+        if (last_state_ < book_states_.size() && book_states_[last_state_].book == key) {
+            return book_states_[last_state_];
+        }
+        for (size_t i = 0; i < book_states_.size(); ++i) {
+            if (book_states_[i].book == key) { last_state_ = i; return book_states_[i]; }
+        }
+        BookState& st = book_states_.emplace_back();
+        st.book = key;
+        std::memcpy(st.symbol, book.symbol().c_str(), std::min(book.symbol().size(), size_t(15)));
+        last_state_ = book_states_.size() - 1;
+        return st;
+    }
+
+    // Conflated: the first message of a new interval first releases the
+    // previous interval's quote, so quotes stay in event order on the feed.
+    template <OrderBookLike Book>
+    void begin_event(const Book& book, Timestamp ts) {
+        if (opts_.quote_mode != QuoteMode::Conflated) return;
+        BookState& st = state_for(book);
+        const uint64_t t = timestamp_ns(ts);
+        const bool next_interval = opts_.conflation_ns == 0
+            ? t != st.last_ns
+            : t - st.interval_ns >= opts_.conflation_ns;
+        if (st.open && next_interval) close_interval(st);
+        if (!st.open) { st.open = true; st.interval_ns = t; st.changes = 0; }
+        st.last_ns = t;
+    }
+
+    template <OrderBookLike Book>
+    void end_event(const Book& book) {
+        if (opts_.quote_mode == QuoteMode::EveryEvent) { publish_bbo_update(book); return; }
+
+        BookState& st = state_for(book);
+        const std::optional<Bbo> top = top_of_book(book);
+        if (opts_.quote_mode == QuoteMode::ChangeOnly) {
+            if (!top)                      st.published.reset();
+            else if (top == st.published)  ++quotes_suppressed_;
+            else                           publish_quote(st, *top);
+            return;
+        }
+        if (top && top == st.latest) ++quotes_suppressed_;
+        else if (top)                ++st.changes;
+        st.latest = top;
+    }
+
+    void close_interval(BookState& st) {
+        if (!st.open) return;
+        st.open = false;
+        if (!st.latest) {
+            st.published.reset();
+            quotes_conflated_ += st.changes;
+        } else if (st.latest != st.published) {
+            publish_quote(st, *st.latest);
+            quotes_conflated_ += st.changes - 1;
+        } else {
+            quotes_conflated_ += st.changes;   // moved and came back
+        }
+    }
+
+    // ── Market-by-price depth ──
+
+    static size_t side_index(Side side) { return side == Side::Buy ? 0 : 1; }
+    static bool better(Side side, Price a, Price b) { return side == Side::Buy ? a > b : a < b; }
+
+    // A full top-n lost a level: the next one down comes from the book. Skip
+    // a level emptied mid-match that the book has not erased yet.
+    template <OrderBookLike Book>
+    void refill_depth(const Book& book, BookState& st, Side side) {
+        auto& view = st.depth[side_index(side)];
+        const size_t n = opts_.depth_levels;
+        const auto levels = side == Side::Buy ? book.get_bids(n + 1) : book.get_asks(n + 1);
+        for (const BookLevel& l : levels) {
+            if (l.order_count == 0) continue;
+            if (!view.empty() && !better(side, view.back().price, l.price)) continue;
+            view.push_back(l);
+            publish_level(st, side, LevelAction::Add, static_cast<uint32_t>(view.size() - 1), l);
+            return;
+        }
+    }
+
+    // Load the view from a book that already has orders, and say so.
+    template <OrderBookLike Book>
+    void sync_depth(const Book& book) {
+        if (opts_.depth_levels == 0) return;
+        BookState& st = state_for(book);
+        st.depth[0] = book.get_bids(opts_.depth_levels);
+        st.depth[1] = book.get_asks(opts_.depth_levels);
+        if (!st.depth[0].empty() || !st.depth[1].empty()) publish_depth_snapshot(st);
+    }
+
+    void publish_level(BookState& st, Side side, LevelAction action, uint32_t rank,
+                       const BookLevel& l) {
+        auto msg = FeedMessage::make_level(next_seq_++, FeedMessageType::LevelUpdate, st.symbol,
+                                           side, action, rank, l.price, l.quantity,
+                                           l.order_count, event_ns_);
+        emit(msg);
+    }
+
+    void publish_depth_snapshot(BookState& st) {
+        FeedMessage head{};
+        head.type = FeedMessageType::Snapshot;
+        head.sequence = next_seq_++;
+        head.timestamp_ns = event_ns_;
+        std::memcpy(head.symbol, st.symbol, sizeof(head.symbol));
+        if (!st.depth[0].empty()) head.best_bid = st.depth[0].front().price;
+        if (!st.depth[1].empty()) head.best_ask = st.depth[1].front().price;
+        for (const auto& l : st.depth[0]) head.bid_depth += l.quantity;
+        for (const auto& l : st.depth[1]) head.ask_depth += l.quantity;
+        emit(head);
+
+        for (Side side : {Side::Buy, Side::Sell}) {
+            const auto& view = st.depth[side_index(side)];
+            for (size_t i = 0; i < view.size(); ++i) {
+                auto msg = FeedMessage::make_level(next_seq_++, FeedMessageType::LevelSnapshot,
+                                                   st.symbol, side, LevelAction::Add,
+                                                   static_cast<uint32_t>(i), view[i].price,
+                                                   view[i].quantity, view[i].order_count, event_ns_);
+                emit(msg);
+            }
         }
+        st.depth_updates = 0;
     }
 
+    void publish_quote(BookState& st, const Bbo& q) {
+        auto msg = FeedMessage::make_quote(next_seq_++, st.symbol,
+                                           q.bid_price, q.bid_size, q.ask_price, q.ask_size);
+        emit(msg);
+        st.published = q;
+    }
+
+    Options opts_{};
     SeqNum next_seq_ = 1;
+    OrderId last_aggressor_ = 0;   // aggressor of the latest trade
+    uint64_t event_ns_ = 0;        // event time of the latest trade / order event
     MessageCallback callback_;
+    FeedWriter* writer_ = nullptr;
     std::vector<FeedMessage> messages_;
+    FeedStats counts_{};
+
+    std::vector<BookState> book_states_;
+    size_t   last_state_        = 0;
+    uint64_t quotes_suppressed_ = 0;
+    uint64_t quotes_conflated_  = 0;
 };
 
+/// Static sink slot for a FeedPublisher: `BasicOrderBook<FeedSink>` or a
+/// `SinkChain<..., FeedSink>`; bound by FeedPublisher::attach.
+using FeedSink = SinkRef<FeedPublisher>;
+
+template <OrderBookLike Book>
+void FeedPublisher::attach(Book& book) {
+    if constexpr (has_sink_v<FeedSink, Book>) {
+        sink_get<FeedSink>(book).target = this;
+    } else {
+        book.add_trade_listener([this, &book](const Trade& trade) { on_trade(book, trade); });
+        book.add_order_listener([this, &book](const Order& order) { on_order(book, order); });
+        if (opts_.depth_levels) {
+            book.add_level_listener([this, &book](Side side, const BookLevel& level) {
+                on_level(book, side, level);
+            });
+        }
+    }
+    sync_depth(book);
+}
+
 /**
  * FeedReplayer — Reads binary feed files and replays messages.
+ *
+ * Reads both file formats through a MappedFeed: Compact (starts with
+ * FEED_FILE_MAGIC; frames are decoded back into FeedMessages) and the
+ * legacy raw FeedMessage records. A truncated or malformed compact frame
+ * ends the replay. For seeking, pacing or partitioned replays use
+ * MappedFeed directly.
  */
 class FeedReplayer {
 public:
@@ -179,26 +544,18 @@ public:
      * Returns total message count.
      */
     size_t replay(MessageCallback cb) {
-        std::ifstream ifs(path_, std::ios::binary);
-        if (!ifs) return 0;
-
-        size_t count = 0;
-        FeedMessage msg;
-        while (ifs.read(reinterpret_cast<char*>(&msg), sizeof(FeedMessage))) {
-            if (cb) cb(msg);
-            ++count;
-        }
-        return count;
+        MappedFeed feed(path_);
+        return feed.replay([&](const FeedMessage& msg) { if (cb) cb(msg); });
     }
 
     /**
      * Load all messages into memory for analysis.
      */
     std::vector<FeedMessage> load_all() {
+        MappedFeed feed(path_);
         std::vector<FeedMessage> messages;
-        replay([&](const FeedMessage& msg) {
-            messages.push_back(msg);
-        });
+        messages.reserve(feed.size());
+        feed.replay([&](const FeedMessage& msg) { messages.push_back(msg); });
         return messages;
     }
 
@@ -0,0 +1,219 @@
+#pragma once
+
+#include "FeedMessage.h"
+#include "FeedPublisher.h"
+#include "MappedFeed.h"
+#include "BookCheckpoint.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace micro_exchange::md {
+
+using namespace micro_exchange::core;
+
+/**
+ * FeedRecovery — bring a checkpoint-restored book up to date from the feed.
+ *
+ * Applies FeedPublisher messages for one symbol with sequence >=
+ * `from_sequence` (the checkpoint's feed_sequence) straight through the
+ * book's restore_* entry points; nothing is matched and no events fire.
+ *
+ *   A  Add     — rest / park the order, or replace the live one with that
+ *                id (an amend, or a triggered StopLimit going to its level);
+ *                zero quantity removes it
+ *   T  Trade   — fill the passive side; an aggressor that is still live
+ *                here was re-matched by an amend or released as a stop, so
+ *                it comes out of the book first (its remainder, if any,
+ *                follows as an Add)
+ *   D  Delete  — remove the order; ids never added (IOC / market / FOK
+ *                remainders) are skipped
+ *   Q, S       — skipped
+ *
+ * The result matches the live book level by level — same FIFO order, same
+ * leaves, same parked stops, last price and trade / stop counters. Two
+ * things the feed does not carry are approximated: orders added from the
+ * tail take fresh book sequences (monotone within each level, but not the
+ * live book's numbers), and their `quantity` is their leaves (filled
+ * history is only in a checkpoint). Take a new checkpoint after recovery
+ * rather than chaining tails indefinitely.
+ */
+template <RestorableBook Book>
+class FeedRecovery {
+public:
+    struct Stats {
+        uint64_t applied   = 0;   // messages that changed the book
+        uint64_t skipped   = 0;   // before from_sequence, other symbol, Q/S, unknown delete
+        uint64_t unmatched = 0;   // trades against an order this book doesn't have
+        uint64_t gaps      = 0;   // sequence jumps in the tail
+    };
+
+    /// `whole_stream = false` when the caller passes only this symbol's
+    /// messages (a partitioned replay): sequence jumps are then other
+    /// symbols, not gaps.
+    FeedRecovery(Book& book, SeqNum from_sequence, bool whole_stream = true)
+        : book_(book), next_expected_(from_sequence), from_(from_sequence), whole_stream_(whole_stream)
+    {
+        core::detail::copy_symbol(symbol_, book.symbol());
+    }
+
+    /// Apply one feed message. Returns true if it changed the book.
+    bool apply(const FeedMessage& msg) {
+        if (msg.sequence < from_) { ++stats_.skipped; return false; }
+        if (whole_stream_ && msg.sequence != next_expected_) ++stats_.gaps;
+        next_expected_ = msg.sequence + 1;
+        if (std::memcmp(msg.symbol, symbol_, sizeof(symbol_)) != 0) { ++stats_.skipped; return false; }
+
+        bool changed = false;
+        switch (msg.type) {
+            case FeedMessageType::AddOrder:    changed = on_add(msg);    break;
+            case FeedMessageType::Trade:       changed = on_trade(msg);  break;
+            case FeedMessageType::DeleteOrder: changed = on_delete(msg); break;
+            default: break;
+        }
+        ++(changed ? stats_.applied : stats_.skipped);
+        return changed;
+    }
+
+    [[nodiscard]] const Stats& stats() const noexcept { return stats_; }
+
+private:
+    static bool is_stop(OrderType t) { return t == OrderType::Stop || t == OrderType::StopLimit; }
+
+    static Timestamp to_ts(uint64_t ns) {
+        return Timestamp(std::chrono::duration_cast<Timestamp::duration>(std::chrono::nanoseconds(ns)));
+    }
+
+    // A parked stop leaving as anything but a stop was released by a print.
+    void count_trigger() {
+        BookCounters c = book_.counters();
+        ++c.stop_triggered_count;
+        book_.restore_counters(c);
+    }
+
+    bool on_add(const FeedMessage& msg) {
+        // An amend down to (or below) the filled quantity leaves nothing to rest.
+        if (msg.quantity == 0) return book_.restore_remove(msg.order_id);
+
+        Order o;
+        o.id          = msg.order_id;
+        o.side        = msg.side;
+        o.type        = msg.order_type;
+        o.tif         = TimeInForce::GTC;   // only GTC orders rest or park
+        o.price       = msg.price;
+        o.stop_price  = msg.stop_price;
+        o.quantity    = msg.quantity;
+        o.leaves_qty  = msg.quantity;
+        o.status      = msg.order_status;
+        o.entry_time  = to_ts(msg.timestamp_ns);
+        o.last_update = o.entry_time;
+        std::memcpy(o.symbol, symbol_, sizeof(o.symbol));
+
+        const Order* live = book_.find_order(o.id);
+        if (live && is_stop(live->type) && !is_stop(o.type)) count_trigger();
+        book_.restore_amend(o);
+        return true;
+    }
+
+    bool on_trade(const FeedMessage& msg) {
+        const bool buy_aggr = msg.aggressor_side == Side::Buy;
+        const OrderId aggressor = buy_aggr ? msg.order_id : msg.match_id;
+        const OrderId passive   = buy_aggr ? msg.match_id : msg.order_id;
+
+        if (const Order* live = book_.find_order(aggressor)) {
+            if (is_stop(live->type)) count_trigger();
+            book_.restore_remove(aggressor);
+        }
+        if (!book_.restore_fill(passive, msg.quantity, msg.price, to_ts(msg.timestamp_ns))) {
+            ++stats_.unmatched;
+            return false;
+        }
+        return true;
+    }
+
+    bool on_delete(const FeedMessage& msg) {
+        const Order* live = book_.find_order(msg.order_id);
+        if (!live) return false;
+        if (is_stop(live->type) && !is_stop(msg.order_type)) count_trigger();
+        return book_.restore_remove(msg.order_id);
+    }
+
+    Book&  book_;
+    SeqNum next_expected_;
+    SeqNum from_;
+    bool   whole_stream_;
+    char   symbol_[16] = {};
+    Stats  stats_;
+};
+
+/**
+ * Warm restart in one call: load `checkpoint_path` into the (empty) `book`,
+ * then apply the tail of the FeedPublisher dump at `feed_path` from the
+ * checkpoint's feed sequence on. nullopt if the checkpoint doesn't load.
+ */
+template <RestorableBook Book>
+std::optional<typename FeedRecovery<Book>::Stats>
+recover_book(Book& book, const std::string& checkpoint_path, const std::string& feed_path) {
+    auto header = load_checkpoint(book, checkpoint_path);
+    if (!header) return std::nullopt;
+    FeedRecovery<Book> recovery(book, header->feed_sequence);
+    FeedReplayer(feed_path).replay([&](const FeedMessage& m) { recovery.apply(m); });
+    return recovery.stats();
+}
+
+/// One symbol's book rebuilt from a recorded feed.
+template <RestorableBook Book>
+struct RebuiltBook {
+    std::string                        symbol;
+    std::unique_ptr<Book>              book;
+    typename FeedRecovery<Book>::Stats stats;
+};
+
+/**
+ * Rebuild every symbol's book from a recorded feed, from empty, with the
+ * symbols split round-robin across `threads` workers. Each worker walks the
+ * shared mapping and applies only its own symbols' messages, so nothing is
+ * copied or queued between threads. `make_book(symbol)` returns a
+ * std::unique_ptr<Book> (the symbol plus whatever else the book takes).
+ * Results are in MappedFeed::symbols() order.
+ */
+template <RestorableBook Book, typename MakeBook>
+std::vector<RebuiltBook<Book>> rebuild_books(const MappedFeed& feed, size_t threads, MakeBook make_book) {
+    const auto& symbols = feed.symbols();
+    std::vector<RebuiltBook<Book>> out(symbols.size());
+    for (size_t i = 0; i < symbols.size(); ++i) {
+        out[i].symbol = symbols[i];
+        out[i].book   = make_book(symbols[i]);
+    }
+    threads = std::clamp<size_t>(threads, 1, std::max<size_t>(symbols.size(), 1));
+
+    auto work = [&](size_t part) {
+        std::vector<std::unique_ptr<FeedRecovery<Book>>> recovery(symbols.size());
+        for (size_t i = part; i < symbols.size(); i += threads) {
+            recovery[i] = std::make_unique<FeedRecovery<Book>>(*out[i].book, 1, false);
+        }
+        feed.replay_partition(part, threads, [&](uint32_t sym, const FeedMessage& m) {
+            recovery[sym]->apply(m);
+        });
+        for (size_t i = part; i < symbols.size(); i += threads) out[i].stats = recovery[i]->stats();
+    };
+
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < threads; ++t) pool.emplace_back(work, t);
+    work(0);
+    for (auto& th : pool) th.join();
+    return out;
+}
+
+template <RestorableBook Book>
+std::vector<RebuiltBook<Book>> rebuild_books(const MappedFeed& feed, size_t threads) {
+    return rebuild_books<Book>(feed, threads, [](const std::string& sym) { return std::make_unique<Book>(sym); });
+}
+
+} // namespace micro_exchange::md
@@ -0,0 +1,207 @@
+#pragma once
+
+#include "FeedMessage.h"
+#include "FeedCodec.h"
+#include "SPSCRingBuffer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace micro_exchange::md {
+
+/**
+ * FeedWriter — streams a feed to disk from its own thread.
+ *
+ *   [FeedPublisher] → push() → SPSCRingBuffer → [writer thread] → encode → file
+ *
+ * The publisher hands each message over the ring and moves on; the writer
+ * thread encodes it (Compact frames by default, or Fixed raw records) into
+ * a page-aligned buffer and writes the buffer out whole. Memory stays
+ * bounded however long the session runs. push() never drops a message: on
+ * a full ring it yields until the writer catches up (counted in `stalls`).
+ *
+ * With `direct`, the file is opened O_DIRECT (Linux) so the feed bypasses
+ * the page cache: writes are whole pages from the aligned buffer, and the
+ * last partial page goes out with O_DIRECT cleared at close(). Filesystems
+ * that refuse O_DIRECT (tmpfs) and other platforms use buffered writes;
+ * `direct_active()` says which one is in force.
+ */
+class FeedWriter {
+public:
+    static constexpr size_t RING_SIZE  = 1 << 14;   // messages in flight
+    static constexpr size_t PAGE_BYTES = 4096;
+
+    struct Options {
+        FeedFormat format       = FeedFormat::Compact;
+        bool       direct       = false;
+        size_t     buffer_bytes = 1 << 20;   // rounded up to whole pages
+    };
+
+    struct Stats {
+        uint64_t messages = 0;   // encoded so far
+        uint64_t bytes    = 0;   // written to the file
+        uint64_t writes   = 0;   // write(2) calls
+        uint64_t stalls   = 0;   // push() found the ring full
+    };
+
+    explicit FeedWriter(const std::string& path) : FeedWriter(path, Options{}) {}
+
+    FeedWriter(const std::string& path, Options opts)
+        : opts_(opts), ring_(std::make_unique<Ring>())
+    {
+        cap_ = (std::max(opts_.buffer_bytes, PAGE_BYTES * 2) + PAGE_BYTES - 1) / PAGE_BYTES * PAGE_BYTES;
+        buf_ = static_cast<std::byte*>(std::aligned_alloc(PAGE_BYTES, cap_));
+        if (!buf_) return;
+
+        const int flags = O_WRONLY | O_CREAT | O_TRUNC;
+#ifdef O_DIRECT
+        if (opts_.direct) {
+            fd_ = ::open(path.c_str(), flags | O_DIRECT, 0644);
+            direct_ = fd_ >= 0;
+        }
+#endif
+        if (fd_ < 0) fd_ = ::open(path.c_str(), flags, 0644);
+        if (fd_ < 0) return;
+
+        if (opts_.format == FeedFormat::Compact) {
+            std::memcpy(buf_, FEED_FILE_MAGIC, sizeof(FEED_FILE_MAGIC));
+            len_ = sizeof(FEED_FILE_MAGIC);
+        }
+        thread_ = std::thread([this] { run(); });
+    }
+
+    ~FeedWriter() {
+        close();
+        std::free(buf_);
+    }
+
+    FeedWriter(const FeedWriter&) = delete;
+    FeedWriter& operator=(const FeedWriter&) = delete;
+
+    [[nodiscard]] bool ok() const noexcept { return fd_ >= 0 && !failed_.load(std::memory_order_relaxed); }
+    [[nodiscard]] bool direct_active() const noexcept { return direct_; }
+
+    /// Queue one message (producer thread only).
+    void push(const FeedMessage& msg) {
+        while (!ring_->push(msg)) {
+            ++stalls_;
+            std::this_thread::yield();
+        }
+    }
+
+    /// Drain the ring, write the tail and close the file. Returns ok().
+    bool close() {
+        if (thread_.joinable()) {
+            stop_.store(true, std::memory_order_release);
+            thread_.join();
+            flush_tail();
+        }
+        if (fd_ >= 0) {
+            if (::close(fd_) != 0) failed_ = true;
+            fd_ = -1;
+            closed_ok_ = !failed_;
+        }
+        return closed_ok_;
+    }
+
+    /// Counters; exact once close() has returned.
+    [[nodiscard]] Stats stats() const noexcept {
+        Stats s;
+        s.messages = messages_.load(std::memory_order_relaxed);
+        s.bytes    = bytes_.load(std::memory_order_relaxed);
+        s.writes   = writes_.load(std::memory_order_relaxed);
+        s.stalls   = stalls_;
+        return s;
+    }
+
+private:
+    using Ring = SPSCRingBuffer<FeedMessage, RING_SIZE>;
+
+    // Check the stop flag before draining: anything pushed before it was
+    // set is visible to the drain that follows, so nothing is left behind.
+    void run() {
+        while (true) {
+            const bool stopping = stop_.load(std::memory_order_acquire);
+            size_t drained = 0;
+            while (size_t got = ring_->consume([this](const FeedMessage& m) { append(m); }, 256))
+                drained += got;
+            if (drained == 0) {
+                if (stopping) return;
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        }
+    }
+
+    void append(const FeedMessage& msg) {
+        constexpr size_t room = std::max(MAX_FRAME_BYTES, sizeof(FeedMessage));
+        if (cap_ - len_ < room) write_out(false);
+        if (opts_.format == FeedFormat::Compact) {
+            len_ += encode_frame(msg, buf_ + len_);
+        } else {
+            std::memcpy(buf_ + len_, &msg, sizeof(msg));
+            len_ += sizeof(msg);
+        }
+        messages_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Write the buffer. O_DIRECT takes whole pages only, so mid-stream the
+    // partial last page stays behind at the front of the buffer.
+    void write_out(bool tail) {
+        const size_t n = (direct_ && !tail) ? len_ / PAGE_BYTES * PAGE_BYTES : len_;
+        size_t done = 0;
+        while (done < n) {
+            const ssize_t w = ::write(fd_, buf_ + done, n - done);
+            if (w < 0 && errno == EINTR) continue;
+#ifdef O_DIRECT
+            if (w < 0 && errno == EINVAL && direct_ && done == 0) {
+                // Opened O_DIRECT but the filesystem won't take it: buffer.
+                ::fcntl(fd_, F_SETFL, ::fcntl(fd_, F_GETFL) & ~O_DIRECT);
+                direct_ = false;
+                continue;
+            }
+#endif
+            if (w <= 0) { failed_ = true; break; }
+            done += static_cast<size_t>(w);
+            writes_.fetch_add(1, std::memory_order_relaxed);
+        }
+        bytes_.fetch_add(done, std::memory_order_relaxed);
+        std::memmove(buf_, buf_ + n, len_ - n);
+        len_ -= n;
+    }
+
+    void flush_tail() {
+        if (fd_ < 0 || len_ == 0) return;
+#ifdef O_DIRECT
+        if (direct_) ::fcntl(fd_, F_SETFL, ::fcntl(fd_, F_GETFL) & ~O_DIRECT);
+#endif
+        write_out(true);
+    }
+
+    Options                 opts_;
+    std::unique_ptr<Ring>   ring_;
+    std::byte*              buf_ = nullptr;
+    size_t                  cap_ = 0;
+    size_t                  len_ = 0;   // writer thread only (and close() after join)
+    int                     fd_  = -1;
+    bool                    direct_    = false;
+    bool                    closed_ok_ = false;
+    std::thread             thread_;
+    std::atomic<bool>       stop_{false};
+    std::atomic<bool>       failed_{false};
+    std::atomic<uint64_t>   messages_{0};
+    std::atomic<uint64_t>   bytes_{0};
+    std::atomic<uint64_t>   writes_{0};
+    uint64_t                stalls_ = 0;   // producer thread only
+};
+
+} // namespace micro_exchange::md
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <optional>
+#include <utility>
+
+namespace micro_exchange::md {
+
+/**
+ * MPSCRingBuffer — bounded lock-free Multi-Producer Single-Consumer ring.
+ *
+ *   [gateway thread 0] ─┐
+ *   [gateway thread 1] ─┼─▶ buffer ─▶ [matching shard]
+ *   [gateway thread 2] ─┘
+ *
+ * The per-slot sequence design (Vyukov's bounded queue): every slot carries
+ * a sequence number that says whose turn it is. A producer claims position
+ * `p` with one CAS on the shared tail, fills slot p & MASK, and publishes
+ * it by storing p + 1 into the slot's sequence; the consumer takes slot
+ * p once its sequence reads p + 1, then hands it to the producer one lap
+ * later by storing p + Capacity. Producers contend only on the tail; the
+ * consumer's head is private to it, and it never touches the tail at all.
+ *
+ * Items from one producer come out in that producer's order; items from
+ * different producers interleave in claim order. All Capacity slots are
+ * usable (the sequences tell full from empty).
+ *
+ * Capacity must be a power of 2.
+ */
+template <typename T, size_t Capacity>
+class MPSCRingBuffer {
+    static_assert((Capacity & (Capacity - 1)) == 0,
+        "Capacity must be a power of 2");
+    static_assert(Capacity > 1, "Capacity must be at least 2");
+
+    static constexpr size_t MASK = Capacity - 1;
+
+public:
+    MPSCRingBuffer() {
+        for (size_t i = 0; i < Capacity; ++i) slots_[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    MPSCRingBuffer(const MPSCRingBuffer&) = delete;
+    MPSCRingBuffer& operator=(const MPSCRingBuffer&) = delete;
+
+    /**
+     * Push an element (any producer thread).
+     * Returns false if the buffer is full (back-pressure signal).
+     */
+    bool push(const T& item) noexcept {
+        return push_with([&](T& slot) { slot = item; });
+    }
+
+    /**
+     * Claim a slot and let `fill(T&)` write the item in place (any producer
+     * thread). Returns false, without calling `fill`, if the buffer is full.
+     */
+    template <typename F>
+    bool push_with(F&& fill) noexcept {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& s = slots_[pos & MASK];
+            const size_t seq = s.seq.load(std::memory_order_acquire);
+            const auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    fill(s.value);
+                    s.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;   // the slot a lap ago is still unconsumed: full
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);   // another producer took it
+            }
+        }
+    }
+
+    /**
+     * Pop an element (consumer only).
+     * Returns nullopt if the buffer is empty — or if the oldest claimed slot
+     * is still being filled; the items behind it wait for it.
+     */
+    std::optional<T> pop() noexcept {
+        std::optional<T> out;
+        consume([&](const T& item) { out = item; }, 1);
+        return out;
+    }
+
+    /**
+     * Pass up to `max` ready elements to `f(const T&)` in place, oldest
+     * first, releasing each slot after it (consumer only). Returns the count.
+     */
+    template <typename F>
+    size_t consume(F&& f, size_t max = Capacity) {
+        size_t n = 0;
+        while (n < max) {
+            Slot& s = slots_[head_ & MASK];
+            if (s.seq.load(std::memory_order_acquire) != head_ + 1) break;
+            f(std::as_const(s.value));
+            s.seq.store(head_ + Capacity, std::memory_order_release);
+            ++head_;
+            ++n;
+        }
+        return n;
+    }
+
+    /// Nothing ready at the head (consumer only).
+    [[nodiscard]] bool empty() const noexcept {
+        return slots_[head_ & MASK].seq.load(std::memory_order_acquire) != head_ + 1;
+    }
+
+    /// Consumer only; approximate while producers are active.
+    [[nodiscard]] size_t size() const noexcept {
+        return tail_.load(std::memory_order_acquire) - head_;
+    }
+
+    [[nodiscard]] static constexpr size_t capacity() noexcept { return Capacity; }
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<size_t> seq{0};
+        T                   value{};
+    };
+
+    alignas(64) std::atomic<size_t> tail_{0};   // next position to claim (producers)
+    alignas(64) size_t              head_ = 0;  // next position to take (consumer-owned)
+    std::array<Slot, Capacity>      slots_;
+};
+
+} // namespace micro_exchange::md
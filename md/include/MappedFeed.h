@@ -0,0 +1,284 @@
+#pragma once
+
+#include "FeedMessage.h"
+#include "FeedCodec.h"
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace micro_exchange::md {
+
+/**
+ * MappedFeed — a recorded feed file (either format) mmapped for replay.
+ *
+ * Nothing is read into the heap. In a Fixed file the records are the
+ * messages, so `messages()` is a span straight over the mapping; a Compact
+ * file is decoded frame by frame as it is walked, one FeedMessage on the
+ * stack at a time.
+ *
+ * Opening the file walks it once to build:
+ *   • a sparse index — every `index_stride`-th message's position, sequence
+ *     and the feed clock (running maximum timestamp) there — so
+ *     seek_sequence / seek_time jump close and scan at most one stride;
+ *   • the symbol table, and a symbol id per message (4 bytes each), so a
+ *     partitioned replay skips other symbols' frames without decoding them.
+ *
+ * Replays run as fast as possible, or paced against the recorded
+ * timestamps at a multiple of real time (a load generator).
+ */
+class MappedFeed {
+public:
+    static constexpr size_t DEFAULT_INDEX_STRIDE = 1024;
+
+    struct Pacing {
+        enum class Mode : uint8_t { AsFastAsPossible, RealTime };
+        Mode   mode  = Mode::AsFastAsPossible;
+        double speed = 1.0;   // RealTime: 2.0 replays twice as fast as recorded
+    };
+
+    /// A position in the stream: message ordinal and its byte offset.
+    struct Cursor {
+        size_t ordinal = 0;
+        size_t offset  = 0;
+        friend bool operator==(const Cursor&, const Cursor&) = default;
+    };
+
+    explicit MappedFeed(const std::string& path, size_t index_stride = DEFAULT_INDEX_STRIDE)
+        : file_(path), stride_(std::max<size_t>(index_stride, 1))
+    {
+        if (!file_.ok()) return;
+        const bool compact = file_.size() >= sizeof(FEED_FILE_MAGIC)
+                          && std::memcmp(file_.data(), FEED_FILE_MAGIC, sizeof(FEED_FILE_MAGIC)) == 0;
+        format_ = compact ? FeedFormat::Compact : FeedFormat::Fixed;
+        build_index();
+    }
+
+    [[nodiscard]] bool       ok()     const noexcept { return file_.ok(); }
+    [[nodiscard]] FeedFormat format() const noexcept { return format_; }
+    [[nodiscard]] size_t     size()   const noexcept { return count_; }
+    [[nodiscard]] size_t     bytes()  const noexcept { return file_.size(); }
+    [[nodiscard]] uint64_t   gaps()   const noexcept { return gaps_; }   // sequence jumps in the file
+
+    /// Symbols in order of first appearance; a message's symbol id indexes this.
+    [[nodiscard]] const std::vector<std::string>& symbols() const noexcept { return symbols_; }
+    [[nodiscard]] uint32_t symbol_id(size_t ordinal) const noexcept { return sym_ids_[ordinal]; }
+
+    /// Every message, in place (Fixed files; empty for Compact).
+    [[nodiscard]] std::span<const FeedMessage> messages() const noexcept {
+        if (format_ != FeedFormat::Fixed) return {};
+        return {reinterpret_cast<const FeedMessage*>(file_.data()), count_};
+    }
+
+    [[nodiscard]] Cursor begin() const noexcept { return {0, first_offset()}; }
+    [[nodiscard]] Cursor end()   const noexcept { return {count_, end_offset_}; }
+
+    /// First message with sequence >= `seq` (end() if none).
+    [[nodiscard]] Cursor seek_sequence(SeqNum seq) const {
+        auto it = std::upper_bound(index_.begin(), index_.end(), seq,
+                                   [](SeqNum s, const IndexEntry& e) { return s < e.sequence; });
+        return scan_from(it == index_.begin() ? begin() : std::prev(it)->at,
+                         [&](const Header& h) { return h.sequence >= seq; });
+    }
+
+    /// First message at which the feed clock (the running maximum of the
+    /// timestamps so far) reaches `ts_ns` (end() if it never does).
+    [[nodiscard]] Cursor seek_time(uint64_t ts_ns) const {
+        auto it = std::lower_bound(index_.begin(), index_.end(), ts_ns,
+                                   [](const IndexEntry& e, uint64_t t) { return e.clock_ns < t; });
+        return scan_from(it == index_.begin() ? begin() : std::prev(it)->at,
+                         [&](const Header& h) { return h.timestamp_ns >= ts_ns; });
+    }
+
+    /// Replay [from, to). Returns the number of messages delivered.
+    template <typename F>
+    size_t replay(Cursor from, Cursor to, F&& cb, Pacing pacing = {}) const {
+        Pacer pacer(pacing);
+        return walk(from, to, [&](size_t, const FeedMessage& m) {
+            pacer.wait(m.timestamp_ns);
+            cb(m);
+            return true;
+        });
+    }
+
+    template <typename F>
+    size_t replay(F&& cb, Pacing pacing = {}) const { return replay(begin(), end(), cb, pacing); }
+
+    /**
+     * Replay only the messages whose symbol id is `part` modulo `parts`
+     * (round-robin by first appearance, like the sharded engine). Other
+     * symbols' frames are stepped over undecoded. cb(symbol_id, message).
+     */
+    template <typename F>
+    size_t replay_partition(size_t part, size_t parts, F&& cb) const {
+        size_t delivered = 0;
+        step_all([&](size_t ordinal, size_t offset) {
+            const uint32_t sym = sym_ids_[ordinal];
+            if (sym % parts != part) return;
+            FeedMessage scratch;
+            cb(sym, message_at(offset, scratch));
+            ++delivered;
+        });
+        return delivered;
+    }
+
+private:
+    struct Header {
+        SeqNum           sequence;
+        uint64_t         timestamp_ns;
+        std::string_view symbol;
+        size_t           length;   // bytes to the next message
+    };
+
+    struct IndexEntry {
+        Cursor   at;
+        SeqNum   sequence;
+        uint64_t clock_ns;   // max timestamp up to and including this message
+    };
+
+    // Sleeps until a message's recorded offset from the first one, scaled.
+    struct Pacer {
+        explicit Pacer(Pacing p) : pacing(p) {}
+        void wait(uint64_t ts_ns) {
+            if (pacing.mode != Pacing::Mode::RealTime || pacing.speed <= 0) return;
+            if (!started) {
+                started = true;
+                first_ns = ts_ns;
+                start = std::chrono::steady_clock::now();
+                return;
+            }
+            if (ts_ns <= first_ns) return;
+            const auto due = start + std::chrono::nanoseconds(
+                static_cast<int64_t>(static_cast<double>(ts_ns - first_ns) / pacing.speed));
+            if (std::chrono::steady_clock::now() < due) std::this_thread::sleep_until(due);
+        }
+        Pacing pacing;
+        bool started = false;
+        uint64_t first_ns = 0;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    [[nodiscard]] size_t first_offset() const noexcept {
+        return format_ == FeedFormat::Compact ? sizeof(FEED_FILE_MAGIC) : 0;
+    }
+
+    // Common fields without a full decode; length 0 = torn / malformed tail.
+    // Compact frame: u16 length | u8 type | u64 seq | u64 ts | u8 symlen | symbol.
+    [[nodiscard]] Header peek(size_t offset) const noexcept {
+        const std::byte* p = file_.data() + offset;
+        const size_t avail = file_.size() - offset;
+        Header h{};
+        if (format_ == FeedFormat::Fixed) {
+            if (avail < sizeof(FeedMessage)) return h;
+            const auto* m = reinterpret_cast<const FeedMessage*>(p);
+            h.sequence     = m->sequence;
+            h.timestamp_ns = m->timestamp_ns;
+            h.symbol       = {m->symbol, ::strnlen(m->symbol, sizeof(m->symbol))};
+            h.length       = sizeof(FeedMessage);
+            return h;
+        }
+        uint16_t len = 0;
+        if (avail < 20) return h;
+        std::memcpy(&len, p, sizeof(len));
+        const auto sym_len = static_cast<size_t>(p[19]);
+        if (avail < sizeof(len) + len || len < 18 + sym_len) return h;
+        std::memcpy(&h.sequence, p + 3, sizeof(h.sequence));
+        std::memcpy(&h.timestamp_ns, p + 11, sizeof(h.timestamp_ns));
+        h.symbol = {reinterpret_cast<const char*>(p + 20), sym_len};
+        h.length = sizeof(len) + len;
+        return h;
+    }
+
+    // Fixed: the record in place. Compact: decoded into `scratch`.
+    const FeedMessage& message_at(size_t offset, FeedMessage& scratch) const noexcept {
+        if (format_ == FeedFormat::Fixed) return *reinterpret_cast<const FeedMessage*>(file_.data() + offset);
+        decode_frame(file_.data() + offset, file_.size() - offset, scratch);
+        return scratch;
+    }
+
+    void build_index() {
+        std::unordered_map<std::string_view, uint32_t> ids;
+        size_t offset = first_offset();
+        uint64_t clock = 0;
+        SeqNum expect = 0;
+        while (offset < file_.size()) {
+            const Header h = peek(offset);
+            if (h.length == 0) break;
+            // A compact frame must also decode; a bad one ends the file here.
+            if (format_ == FeedFormat::Compact) {
+                FeedMessage m;
+                if (decode_frame(file_.data() + offset, file_.size() - offset, m) == 0) break;
+            }
+            clock = std::max(clock, h.timestamp_ns);
+            if (count_ % stride_ == 0) index_.push_back({{count_, offset}, h.sequence, clock});
+            if (expect && h.sequence != expect) ++gaps_;
+            expect = h.sequence + 1;
+
+            auto [it, fresh] = ids.try_emplace(h.symbol, static_cast<uint32_t>(symbols_.size()));
+            if (fresh) symbols_.emplace_back(h.symbol);
+            sym_ids_.push_back(it->second);
+            ++count_;
+            offset += h.length;
+        }
+        end_offset_ = offset;
+    }
+
+    template <typename Pred>
+    [[nodiscard]] Cursor scan_from(Cursor c, Pred done) const {
+        while (c.ordinal < count_) {
+            const Header h = peek(c.offset);
+            if (done(h)) return c;
+            ++c.ordinal;
+            c.offset += h.length;
+        }
+        return end();
+    }
+
+    // f(ordinal, offset) for every message.
+    template <typename F>
+    void step_all(F&& f) const {
+        size_t offset = first_offset();
+        for (size_t i = 0; i < count_; ++i) {
+            f(i, offset);
+            offset += format_ == FeedFormat::Fixed ? sizeof(FeedMessage) : frame_length(offset);
+        }
+    }
+
+    [[nodiscard]] size_t frame_length(size_t offset) const noexcept {
+        uint16_t len;
+        std::memcpy(&len, file_.data() + offset, sizeof(len));
+        return sizeof(len) + len;
+    }
+
+    template <typename F>
+    size_t walk(Cursor from, Cursor to, F&& f) const {
+        size_t n = 0;
+        FeedMessage scratch;
+        for (Cursor c = from; c.ordinal < std::min(to.ordinal, count_); ++c.ordinal) {
+            const FeedMessage& m = message_at(c.offset, scratch);
+            if (!f(c.ordinal, m)) break;
+            ++n;
+            c.offset += format_ == FeedFormat::Fixed ? sizeof(FeedMessage) : frame_length(c.offset);
+        }
+        return n;
+    }
+
+    core::MappedFile         file_;
+    FeedFormat               format_ = FeedFormat::Fixed;
+    size_t                   stride_;
+    size_t                   count_ = 0;
+    size_t                   end_offset_ = 0;
+    uint64_t                 gaps_ = 0;
+    std::vector<IndexEntry>  index_;
+    std::vector<std::string> symbols_;
+    std::vector<uint32_t>    sym_ids_;
+};
+
+} // namespace micro_exchange::md
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <cstdint>
 #include <cstddef>
@@ -7,6 +8,7 @@
 #include <new>
 #include <array>
 #include <optional>
+#include <utility>
 
 namespace micro_exchange::md {
 
@@ -33,6 +35,18 @@ namespace micro_exchange::md {
  *
  * False sharing prevention: positions are on separate cache lines.
  *
+ * Cached indices: each side keeps a private copy of the other side's
+ * position on its own cache line and reloads the shared one only when the
+ * ring looks full (producer) or empty (consumer). In steady state a push
+ * or pop touches no line the other thread writes, so the position lines
+ * move between cores once per wrap-around's worth of slack, not per item.
+ *
+ * Bulk and in-place access, for items too big to copy twice:
+ *   • push_n / pop_n     — many items, one index publish
+ *   • claim / commit     — producer writes the next slot in place
+ *   • consume(f, max)    — consumer reads up to `max` items in place,
+ *                          then frees them with one publish
+ *
  * Capacity must be a power of 2 for efficient modular arithmetic (mask).
  */
 template <typename T, size_t Capacity>
@@ -51,16 +65,38 @@ public:
      * Returns false if buffer is full (back-pressure signal).
      */
     bool push(const T& item) noexcept {
+        T* slot = claim();
+        if (!slot) return false;  // Full — apply back-pressure
+        *slot = item;
+        commit();
+        return true;
+    }
+
+    /**
+     * Push up to `n` elements (producer only); returns how many fit.
+     */
+    size_t push_n(const T* items, size_t n) noexcept {
         const size_t write = write_pos_.load(std::memory_order_relaxed);
-        const size_t next  = (write + 1) & MASK;
+        n = std::min(n, free_slots(write, n));
+        const size_t first = std::min(n, Capacity - write);
+        std::copy_n(items, first, buffer_.begin() + static_cast<std::ptrdiff_t>(write));
+        std::copy_n(items + first, n - first, buffer_.begin());
+        if (n) write_pos_.store((write + n) & MASK, std::memory_order_release);
+        return n;
+    }
 
-        if (next == read_pos_.load(std::memory_order_acquire)) {
-            return false;  // Full — apply back-pressure
-        }
+    /**
+     * Claim the next slot to fill in place (producer only); nullptr if the
+     * ring is full. The item becomes visible at commit().
+     */
+    [[nodiscard]] T* claim() noexcept {
+        const size_t write = write_pos_.load(std::memory_order_relaxed);
+        return free_slots(write, 1) ? &buffer_[write] : nullptr;
+    }
 
-        buffer_[write] = item;
-        write_pos_.store(next, std::memory_order_release);
-        return true;
+    void commit() noexcept {
+        const size_t write = write_pos_.load(std::memory_order_relaxed);
+        write_pos_.store((write + 1) & MASK, std::memory_order_release);
     }
 
     /**
@@ -69,16 +105,39 @@ public:
      */
     std::optional<T> pop() noexcept {
         const size_t read = read_pos_.load(std::memory_order_relaxed);
-
-        if (read == write_pos_.load(std::memory_order_acquire)) {
-            return std::nullopt;  // Empty
-        }
+        if (ready_slots(read, 1) == 0) return std::nullopt;  // Empty
 
         T item = buffer_[read];
         read_pos_.store((read + 1) & MASK, std::memory_order_release);
         return item;
     }
 
+    /**
+     * Pop up to `max` elements into `out` (consumer only); returns the count.
+     */
+    size_t pop_n(T* out, size_t max) noexcept {
+        const size_t read = read_pos_.load(std::memory_order_relaxed);
+        const size_t n = std::min(max, ready_slots(read, max));
+        const size_t first = std::min(n, Capacity - read);
+        std::copy_n(buffer_.begin() + static_cast<std::ptrdiff_t>(read), first, out);
+        std::copy_n(buffer_.begin(), n - first, out + first);
+        if (n) read_pos_.store((read + n) & MASK, std::memory_order_release);
+        return n;
+    }
+
+    /**
+     * Pass up to `max` elements to `f(const T&)` in place, oldest first,
+     * then free them together (consumer only). Returns the count.
+     */
+    template <typename F>
+    size_t consume(F&& f, size_t max = Capacity) {
+        const size_t read = read_pos_.load(std::memory_order_relaxed);
+        const size_t n = std::min(max, ready_slots(read, max));
+        for (size_t i = 0; i < n; ++i) f(std::as_const(buffer_[(read + i) & MASK]));
+        if (n) read_pos_.store((read + n) & MASK, std::memory_order_release);
+        return n;
+    }
+
     /**
      * Peek without consuming (consumer only).
      */
@@ -108,9 +167,33 @@ public:
     }
 
 private:
-    // Separate cache lines to prevent false sharing
+    // Free slots from `write`, reloading the consumer's position only if
+    // the cached copy shows fewer than `want` (producer only).
+    size_t free_slots(size_t write, size_t want) noexcept {
+        size_t free = (read_cache_ - write - 1) & MASK;
+        if (free < want) {
+            read_cache_ = read_pos_.load(std::memory_order_acquire);
+            free = (read_cache_ - write - 1) & MASK;
+        }
+        return free;
+    }
+
+    // Filled slots from `read`, likewise (consumer only).
+    size_t ready_slots(size_t read, size_t want) noexcept {
+        size_t ready = (write_cache_ - read) & MASK;
+        if (ready < want) {
+            write_cache_ = write_pos_.load(std::memory_order_acquire);
+            ready = (write_cache_ - read) & MASK;
+        }
+        return ready;
+    }
+
+    // Separate cache lines to prevent false sharing; each side's cached
+    // copy of the other's position sits on its own line.
     alignas(64) std::atomic<size_t>  write_pos_{0};
+    size_t                           read_cache_ = 0;    // producer-owned
     alignas(64) std::atomic<size_t>  read_pos_{0};
+    size_t                           write_cache_ = 0;   // consumer-owned
     alignas(64) std::array<T, Capacity> buffer_{};
 };
 
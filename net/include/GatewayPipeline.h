@@ -0,0 +1,486 @@
+#pragma once
+
+// ─────────────────────────────────────────────────────────────────────────
+// GatewayPipeline — the order gateway as three stages on three threads:
+//
+//   I/O thread ──SPSC──▶ matching thread ──SPSC──▶ egress thread
+//   recv, decode          claim, match, Ack/Exec     frame, send
+//
+// Inline, one thread decodes, matches and writes, so a send() that crawls
+// for one client holds up matching for everyone. Pipelined, the thread that
+// drives the gateway (run() / poll_once()) only reads sockets and decodes
+// frames into NewOrderRequest / CancelRequest commands; a core-pinned
+// matching thread owns the engine and the order-ownership table; an egress
+// thread owns every session's output buffer and does all the writing.
+//
+// Session lifetime rides the rings in order. The I/O stage sends Open —
+// carrying a dup() of the socket, which the egress stage writes to and
+// finally closes — before a session's first request and Close after its
+// last, and the matching stage passes both along, so egress never sees a
+// reply for a session it has not opened. Egress opens its sessions in the
+// same order as the I/O stage, so both tables give a session the same id.
+// A session whose output passes its bound is cut off by the egress stage,
+// which shuts the socket down; the I/O stage then reads EOF and closes its
+// side.
+//
+// Every stage keeps StageStats: items and batches, the depth of its input
+// ring at the start of each batch, how long items waited in that ring, time
+// spent busy, and how often its output ring was full. A ring that stays deep
+// in front of a busy stage is where backpressure is building. A timed order's
+// OrderTrace (LatencyProbe.h) rides along with its command and its Ack, and
+// the egress stage records it once the Ack's send() has returned.
+// ─────────────────────────────────────────────────────────────────────────
+
+#include "Order.h"
+#include "LatencyRecorder.h"
+#include "OrderEntryProtocol.h"
+#include "GatewaySession.h"
+#include "Poller.h"
+#include "SPSCRingBuffer.h"
+
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace micro_exchange::net {
+
+using core::NewOrderRequest;
+using core::CancelRequest;
+using core::OrderTrace;
+using core::LatencyRecorder;
+
+/// I/O stage → matching stage.
+struct PipelineCommand {
+    enum class Kind : uint8_t { Open, Close, Logon, NewOrder, Cancel };
+
+    Kind      kind    = Kind::Open;
+    SessionId session = 0;
+    int       fd      = -1;   // Open: the egress stage's dup of the socket
+    uint64_t  stamp   = 0;    // ns, when the I/O stage pushed it
+    OrderTrace trace;         // NewOrder: trace_id 0 unless timed
+    union {
+        NewOrderRequest new_order;
+        CancelRequest   cancel;
+        WireLogon       logon;
+    };
+
+    PipelineCommand() : new_order{} {}
+};
+
+/// Matching stage → egress stage: one frame to write, or Open / Close
+/// passed along.
+struct PipelineReply {
+    enum class Kind : uint8_t { Open, Close, Frame };
+
+    Kind      kind    = Kind::Frame;
+    MsgType   type    = MsgType::Ack;
+    SessionId session = 0;
+    int       fd      = -1;
+    uint32_t  len     = 0;
+    uint64_t  stamp   = 0;    // ns, when the matching stage pushed it
+    OrderTrace trace;         // an Ack of a timed order, else trace_id 0
+    alignas(8) char payload[sizeof(WireExec)] = {};
+};
+
+static_assert(sizeof(WireAck) <= sizeof(PipelineReply::payload)
+           && sizeof(WireLogonAck) <= sizeof(PipelineReply::payload),
+              "PipelineReply payload must hold every reply message");
+
+struct StageStats {
+    uint64_t items       = 0;   // taken off the input ring (I/O stage: pushed)
+    uint64_t batches     = 0;
+    uint64_t depth_max   = 0;   // input ring depth at the start of a batch
+    uint64_t depth_total = 0;   // summed over batches
+    uint64_t wait_ns     = 0;   // time items sat in the input ring, summed
+    uint64_t wait_ns_max = 0;
+    uint64_t busy_ns     = 0;   // time spent handling batches
+    uint64_t stalls      = 0;   // pushes that found the output ring full
+
+    [[nodiscard]] double mean_depth() const noexcept {
+        return batches ? static_cast<double>(depth_total) / static_cast<double>(batches) : 0.0;
+    }
+    [[nodiscard]] double mean_wait_ns() const noexcept {
+        return items ? static_cast<double>(wait_ns) / static_cast<double>(items) : 0.0;
+    }
+};
+
+struct PipelineStats {
+    StageStats io;         // no input ring: items pushed, stalls on the command ring
+    StageStats matching;
+    StageStats egress;     // no output ring: stalls stay 0
+};
+
+/**
+ * One stage's counters: written by that stage's thread only, readable from
+ * any thread while it runs.
+ */
+class StageMeter {
+public:
+    void batch(uint64_t items, uint64_t depth, uint64_t wait_ns, uint64_t wait_max,
+               uint64_t busy_ns) noexcept {
+        add(items_, items);
+        add(batches_, 1);
+        add(depth_total_, depth);
+        raise(depth_max_, depth);
+        add(wait_ns_, wait_ns);
+        raise(wait_max_, wait_max);
+        add(busy_ns_, busy_ns);
+    }
+
+    void stall() noexcept { add(stalls_, 1); }
+
+    [[nodiscard]] StageStats snapshot() const noexcept {
+        StageStats s;
+        s.items       = items_.load(std::memory_order_relaxed);
+        s.batches     = batches_.load(std::memory_order_relaxed);
+        s.depth_max   = depth_max_.load(std::memory_order_relaxed);
+        s.depth_total = depth_total_.load(std::memory_order_relaxed);
+        s.wait_ns     = wait_ns_.load(std::memory_order_relaxed);
+        s.wait_ns_max = wait_max_.load(std::memory_order_relaxed);
+        s.busy_ns     = busy_ns_.load(std::memory_order_relaxed);
+        s.stalls      = stalls_.load(std::memory_order_relaxed);
+        return s;
+    }
+
+private:
+    // Single writer: a plain load + store, no read-modify-write.
+    static void add(std::atomic<uint64_t>& a, uint64_t v) noexcept {
+        a.store(a.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+    }
+    static void raise(std::atomic<uint64_t>& a, uint64_t v) noexcept {
+        if (v > a.load(std::memory_order_relaxed)) a.store(v, std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t> items_{0}, batches_{0}, depth_max_{0}, depth_total_{0};
+    std::atomic<uint64_t> wait_ns_{0}, wait_max_{0}, busy_ns_{0}, stalls_{0};
+};
+
+class GatewayPipeline {
+public:
+    static constexpr size_t COMMAND_RING = 4096;
+    static constexpr size_t REPLY_RING   = 16384;   // a sweep turns one command into many replies
+
+    // Matching runs on core `first_core`, egress on the next one (modulo the
+    // hardware threads), when `pin_threads` is set on Linux. Egress records
+    // timed orders into `probes` (may be null).
+    GatewayPipeline(size_t max_output_bytes, bool pin_threads, unsigned first_core,
+                    LatencyRecorder* probes = nullptr)
+        : commands_(std::make_unique<CommandRing>()),
+          replies_(std::make_unique<ReplyRing>()),
+          owners_(0, 0),
+          egress_(max_output_bytes, 0),
+          probes_(probes),
+          pin_threads_(pin_threads),
+          first_core_(first_core)
+    {
+        owners_.forward_execs([](void* p, SessionId id, const WireExec& e) {
+            static_cast<GatewayPipeline*>(p)->reply(id, MsgType::Exec, &e, sizeof(e));
+        }, this);
+    }
+
+    ~GatewayPipeline() { stop(); }
+
+    GatewayPipeline(const GatewayPipeline&) = delete;
+    GatewayPipeline& operator=(const GatewayPipeline&) = delete;
+
+    // Start the matching and egress threads; the matching thread passes each
+    // Logon / NewOrder / Cancel command to `execute`.
+    template <typename F>
+    void start(F execute) {
+        if (running_) return;
+        stop_.store(false, std::memory_order_relaxed);
+        matched_.store(false, std::memory_order_relaxed);
+        matcher_ = std::thread([this, execute]() mutable { run_matching(execute); });
+        egress_thread_ = std::thread([this] { run_egress(); });
+        if (pin_threads_) {
+            pin(matcher_, 0);
+            pin(egress_thread_, 1);
+        }
+        running_ = true;
+    }
+
+    // Let both stages drain their rings, then join them. Call from the I/O
+    // thread once it has stopped pushing; counters are exact afterwards.
+    void stop() {
+        if (!running_) return;
+        stop_.store(true, std::memory_order_release);
+        matcher_.join();
+        egress_thread_.join();
+        running_ = false;
+    }
+
+    [[nodiscard]] bool running() const noexcept { return running_; }
+
+    // ── I/O stage ──
+
+    // Announce a new session; egress gets its own non-blocking dup of `fd`.
+    void open(SessionId id, int fd) {
+        const int out_fd = ::dup(fd);
+        if (out_fd >= 0) set_nonblocking(out_fd);
+        push([&](PipelineCommand& c) {
+            c.kind    = PipelineCommand::Kind::Open;
+            c.session = id;
+            c.fd      = out_fd;
+            return true;
+        });
+    }
+
+    void close(SessionId id) {
+        push([&](PipelineCommand& c) {
+            c.kind    = PipelineCommand::Kind::Close;
+            c.session = id;
+            return true;
+        });
+    }
+
+    // Fill the next command slot in place with `fill(cmd)` and publish it,
+    // unless fill returns false. Spins (counting a stall) while the ring is
+    // full. Returns whether a command was pushed.
+    template <typename F>
+    bool push(F&& fill) {
+        PipelineCommand* c;
+        while (!(c = commands_->claim())) {
+            io_.stall();
+            std::this_thread::yield();
+        }
+        if (!fill(*c)) return false;
+        c->stamp = core::timestamp_ns(core::now());
+        commands_->commit();
+        ++io_pending_;
+        return true;
+    }
+
+    // Close an I/O batch that started at `started_ns`.
+    void end_io_batch(uint64_t started_ns) noexcept {
+        if (!io_pending_) return;
+        io_.batch(io_pending_, 0, 0, 0, core::timestamp_ns(core::now()) - started_ns);
+        io_pending_ = 0;
+    }
+
+    // ── Matching stage ──
+
+    // Ownership table of the matching stage; its Execs go to egress.
+    [[nodiscard]] SessionTable& owners() noexcept { return owners_; }
+
+    // Queue one reply frame for the egress stage; `trace` is a timed
+    // order's, to record once its Ack is written.
+    void reply(SessionId id, MsgType type, const void* payload, uint32_t len,
+               const OrderTrace* trace = nullptr) {
+        PipelineReply* r = claim_reply();
+        r->kind    = PipelineReply::Kind::Frame;
+        r->type    = type;
+        r->session = id;
+        r->len     = len;
+        std::memcpy(r->payload, payload, len);
+        if (trace) r->trace = *trace;
+        else       r->trace.trace_id = 0;
+        r->stamp   = core::timestamp_ns(core::now());
+        replies_->commit();
+    }
+
+    // ── Counters ──
+
+    [[nodiscard]] PipelineStats stats() const noexcept {
+        return {io_.snapshot(), matching_.snapshot(), egress_meter_.snapshot()};
+    }
+
+    // Output-side session counters (slow consumers, execs, unrouted, frames
+    // and sends of closed sessions), as of the egress stage's last batch.
+    [[nodiscard]] SessionTable::Counters egress_counters() const noexcept {
+        SessionTable::Counters c;
+        c.slow_consumers = slow_consumers_.load(std::memory_order_relaxed);
+        c.execs          = execs_.load(std::memory_order_relaxed);
+        c.unrouted       = unrouted_.load(std::memory_order_relaxed);
+        c.frames_out     = frames_out_.load(std::memory_order_relaxed);
+        c.send_calls     = send_calls_.load(std::memory_order_relaxed);
+        return c;
+    }
+
+private:
+    using CommandRing = md::SPSCRingBuffer<PipelineCommand, COMMAND_RING>;
+    using ReplyRing   = md::SPSCRingBuffer<PipelineReply, REPLY_RING>;
+
+    PipelineReply* claim_reply() {
+        PipelineReply* r;
+        while (!(r = replies_->claim())) {
+            matching_.stall();
+            std::this_thread::yield();
+        }
+        return r;
+    }
+
+    // Open / Close go straight through to egress, in order with the replies.
+    void pass(const PipelineCommand& c) {
+        PipelineReply* r = claim_reply();
+        r->kind    = c.kind == PipelineCommand::Kind::Open ? PipelineReply::Kind::Open
+                                                           : PipelineReply::Kind::Close;
+        r->session = c.session;
+        r->fd      = c.fd;
+        r->trace.trace_id = 0;
+        r->stamp   = core::timestamp_ns(core::now());
+        replies_->commit();
+    }
+
+    // Stop is read before draining: whatever was pushed before stop() is
+    // handled before the thread exits.
+    template <typename F>
+    void run_matching(F& execute) {
+        unsigned idle = 0;
+        for (;;) {
+            const bool   stopping = stop_.load(std::memory_order_acquire);
+            const size_t depth    = commands_->size();
+            const uint64_t t0     = core::timestamp_ns(core::now());
+            uint64_t wait = 0, wait_max = 0;
+            const size_t got = commands_->consume([&](const PipelineCommand& c) {
+                const uint64_t w = t0 > c.stamp ? t0 - c.stamp : 0;
+                wait += w;
+                wait_max = std::max(wait_max, w);
+                if (c.kind == PipelineCommand::Kind::Open || c.kind == PipelineCommand::Kind::Close) {
+                    pass(c);
+                } else {
+                    execute(c);
+                }
+            }, 64);
+            if (got) {
+                matching_.batch(got, depth, wait, wait_max, core::timestamp_ns(core::now()) - t0);
+                idle = 0;
+                continue;
+            }
+            if (stopping) break;
+            // Spin briefly for latency, then give the core away.
+            if (++idle > 64) std::this_thread::yield();
+        }
+        matched_.store(true, std::memory_order_release);
+    }
+
+    void run_egress() {
+        unsigned idle = 0;
+        for (;;) {
+            const bool   matched = matched_.load(std::memory_order_acquire);
+            const size_t depth   = replies_->size();
+            const uint64_t t0    = core::timestamp_ns(core::now());
+            uint64_t wait = 0, wait_max = 0;
+            const size_t got = replies_->consume([&](const PipelineReply& r) {
+                const uint64_t w = t0 > r.stamp ? t0 - r.stamp : 0;
+                wait += w;
+                wait_max = std::max(wait_max, w);
+                deliver(r);
+            }, 256);
+            if (got) {
+                flush_egress();
+                if (probes_) probes_->acks_written();
+                egress_meter_.batch(got, depth, wait, wait_max, core::timestamp_ns(core::now()) - t0);
+                publish();
+                idle = 0;
+                continue;
+            }
+            if (!blocked_.empty()) {   // sockets that were full: try them again
+                retry_blocked();
+                publish();
+            }
+            if (matched) break;
+            if (++idle > 64) std::this_thread::yield();
+        }
+        publish();
+    }
+
+    void deliver(const PipelineReply& r) {
+        switch (r.kind) {
+            case PipelineReply::Kind::Open:
+                egress_.open(r.fd);   // same id as the I/O stage's session
+                break;
+            case PipelineReply::Kind::Close:
+                egress_.close(r.session);
+                break;
+            case PipelineReply::Kind::Frame:
+                if (r.type == MsgType::Exec) {
+                    WireExec e;
+                    std::memcpy(&e, r.payload, sizeof(e));
+                    egress_.send_exec(r.session, e);
+                } else if (Session* s = egress_.get(r.session)) {
+                    egress_.queue(*s, r.type, r.payload, r.len);
+                }
+                if (r.trace.trace_id && probes_) probes_->ack_queued(r.trace);
+                break;
+        }
+    }
+
+    // Send what each session got in the batch; an overflowed session is
+    // shut down (the I/O stage then sees EOF and closes its side).
+    void flush_egress() {
+        egress_.drain_dirty([this](Session& s) {
+            if (s.overflowed() || !s.flush()) {
+                ::shutdown(s.fd(), SHUT_RDWR);
+                egress_.close(s.id());
+                return;
+            }
+            if (s.pending_output() && !s.want_write) {
+                s.want_write = true;
+                blocked_.push_back(s.id());
+            }
+        });
+    }
+
+    void retry_blocked() {
+        retry_.swap(blocked_);
+        for (SessionId id : retry_) {
+            if (Session* s = egress_.get(id)) {
+                s->want_write = false;
+                egress_.mark_dirty(*s);
+            }
+        }
+        retry_.clear();
+        flush_egress();
+    }
+
+    void publish() noexcept {
+        const auto& c = egress_.counters();
+        slow_consumers_.store(c.slow_consumers, std::memory_order_relaxed);
+        execs_.store(c.execs, std::memory_order_relaxed);
+        unrouted_.store(c.unrouted, std::memory_order_relaxed);
+        frames_out_.store(c.frames_out, std::memory_order_relaxed);
+        send_calls_.store(c.send_calls, std::memory_order_relaxed);
+    }
+
+    void pin([[maybe_unused]] std::thread& t, [[maybe_unused]] unsigned stage) const {
+#ifdef __linux__
+        unsigned n = std::thread::hardware_concurrency();
+        if (n == 0) return;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET((first_core_ + stage) % n, &set);
+        pthread_setaffinity_np(t.native_handle(), sizeof(set), &set);
+#endif
+    }
+
+    std::unique_ptr<CommandRing> commands_;
+    std::unique_ptr<ReplyRing>   replies_;
+    SessionTable                 owners_;    // matching thread
+    SessionTable                 egress_;    // egress thread
+    std::vector<SessionId>       blocked_;   // egress sessions with unsent output
+    std::vector<SessionId>       retry_;
+    StageMeter                   io_, matching_, egress_meter_;
+    uint64_t                     io_pending_ = 0;   // pushed since the last end_io_batch()
+    std::thread                  matcher_;
+    std::thread                  egress_thread_;
+    std::atomic<bool>            stop_{false};
+    std::atomic<bool>            matched_{false};   // matching stage has drained and exited
+    std::atomic<uint64_t>        slow_consumers_{0}, execs_{0}, unrouted_{0}, frames_out_{0}, send_calls_{0};
+    LatencyRecorder*             probes_;
+    bool                         pin_threads_;
+    unsigned                     first_core_;
+    bool                         running_ = false;
+};
+
+} // namespace micro_exchange::net
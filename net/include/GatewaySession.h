@@ -0,0 +1,392 @@
+#pragma once
+
+// ─────────────────────────────────────────────────────────────────────────
+// GatewaySession — per-connection state for the order-entry gateway.
+//
+// A Session owns one client socket, a receive buffer that frames are
+// decoded from in place, and a bounded output buffer that Acks and Execs
+// are queued into and flushed from without blocking. One recv() takes in as
+// many frames as the socket holds, and everything queued while handling
+// them leaves in one send(), so a sweep that reports five Execs costs two
+// syscalls rather than a dozen. The SessionTable holds
+// every open session and which session owns each live order, so a trade
+// print goes to the owners of its two sides only (once if both are the same
+// session) instead of to whoever happens to be connected.
+//
+// A session whose output would grow past its bound is a slow consumer: it is
+// marked overflowed, nothing more is queued for it, and the gateway
+// disconnects it after the current event. Matching never waits on a socket.
+// ─────────────────────────────────────────────────────────────────────────
+
+#include "Order.h"
+#include "OrderEntryProtocol.h"
+
+#include <sys/socket.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+namespace micro_exchange::net {
+
+using core::Order;
+using core::OrderId;
+using core::OrderStatus;
+using core::Trade;
+using core::SymbolId;
+using core::SYMBOL_ID_NONE;
+
+using SessionId = uint32_t;
+inline constexpr SessionId SESSION_NONE = UINT32_MAX;
+
+// Largest payload any inbound message may declare; bigger is a framing error.
+inline constexpr uint32_t MAX_INBOUND_PAYLOAD = 1024;
+
+class Session {
+public:
+    static constexpr size_t RECV_BUFFER = 64 * 1024;
+
+    Session(int fd, SessionId id, size_t max_output, size_t recv_buffer = RECV_BUFFER)
+        : fd_(fd), id_(id), max_output_(max_output), in_(recv_buffer) {}
+
+    ~Session() { if (fd_ >= 0) ::close(fd_); }
+
+    Session(const Session&) = delete;
+    Session& operator=(const Session&) = delete;
+
+    [[nodiscard]] int       fd() const noexcept { return fd_; }
+    [[nodiscard]] SessionId id() const noexcept { return id_; }
+
+    SymbolId symbol_id = SYMBOL_ID_NONE;   // from Logon
+    bool     want_write = false;           // poller has write interest
+    bool     dirty      = false;           // queued to since the last flush pass
+    uint64_t recv_ns    = 0;               // when the last read returned (latency probes)
+
+    // ── Inbound ──
+
+    // Read what the socket has (non-blocking fd) into the receive buffer.
+    // False once the peer has closed or the socket failed; frames already
+    // buffered can still be decoded. A short read means the socket is
+    // drained, so it stops there instead of paying for an EAGAIN recv().
+    bool read_available() {
+        compact();
+        while (in_len_ < in_.size()) {
+            const size_t room = in_.size() - in_len_;
+            const ssize_t r = ::recv(fd_, in_.data() + in_len_, room, 0);
+            ++recv_calls_;
+            if (r > 0) {
+                in_len_ += static_cast<size_t>(r);
+                if (static_cast<size_t>(r) < room) return true;
+                continue;
+            }
+            if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+            if (r < 0 && errno == EINTR) continue;
+            return false;
+        }
+        return true;   // buffer full: the rest is read on the next event
+    }
+
+    // Blocking fd: wait for at least one byte and take whatever else has
+    // arrived. False on EOF / error.
+    bool read_blocking() {
+        compact();
+        for (;;) {
+            const ssize_t r = ::recv(fd_, in_.data() + in_len_, in_.size() - in_len_, 0);
+            ++recv_calls_;
+            if (r > 0) { in_len_ += static_cast<size_t>(r); return true; }
+            if (r < 0 && errno == EINTR) continue;
+            return false;
+        }
+    }
+
+    // Copy bytes the kernel already received (an io_uring completion) into
+    // the receive buffer. False if they don't fit, which a caller that
+    // decodes after every append never sees.
+    bool append_input(const char* data, size_t n) {
+        compact();
+        if (n > in_.size() - in_len_) return false;
+        std::memcpy(in_.data() + in_len_, data, n);
+        in_len_ += n;
+        return true;
+    }
+
+    // Pass every complete buffered frame to f(type, payload, len). Returns
+    // false on a framing error (declared length over MAX_INBOUND_PAYLOAD).
+    template <typename F>
+    bool for_each_frame(F&& f) {
+        while (in_len_ - in_off_ >= sizeof(WireHeader)) {
+            WireHeader h;
+            std::memcpy(&h, in_.data() + in_off_, sizeof(h));
+            if (h.len > MAX_INBOUND_PAYLOAD) return false;
+            if (in_len_ - in_off_ < sizeof(h) + h.len) break;
+            f(static_cast<MsgType>(h.type), in_.data() + in_off_ + sizeof(h), h.len);
+            in_off_ += sizeof(h) + h.len;
+            ++frames_in_;
+        }
+        return true;
+    }
+
+    // ── Outbound ──
+
+    // Queue one framed message. False (and the session is overflowed) if it
+    // would take the output past its bound.
+    bool queue(MsgType type, const void* payload, uint32_t len) {
+        if (overflowed_ || shut_) return false;
+        if (out_.size() - out_off_ + in_flight_ + sizeof(WireHeader) + len > max_output_) {
+            overflowed_ = true;
+            return false;
+        }
+        if (out_off_ && out_off_ == out_.size()) { out_.clear(); out_off_ = 0; }
+        WireHeader h{};
+        h.type = static_cast<uint8_t>(type);
+        h.len  = len;
+        const auto* hp = reinterpret_cast<const char*>(&h);
+        const auto* pp = static_cast<const char*>(payload);
+        out_.insert(out_.end(), hp, hp + sizeof(h));
+        out_.insert(out_.end(), pp, pp + len);
+        ++frames_out_;
+        return true;
+    }
+
+    // Send as much queued output as the socket takes without blocking.
+    // False on a socket error.
+    bool flush() {
+        while (out_off_ < out_.size()) {
+            const ssize_t w = ::send(fd_, out_.data() + out_off_, out_.size() - out_off_, 0);
+            ++send_calls_;
+            if (w > 0) { out_off_ += static_cast<size_t>(w); bytes_out_ += static_cast<uint64_t>(w); continue; }
+            if (w < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            if (w < 0 && errno == EINTR) continue;
+            return false;
+        }
+        if (out_off_ == out_.size()) { out_.clear(); out_off_ = 0; }
+        return true;
+    }
+
+    // Blocking fd: write everything queued.
+    bool flush_blocking() {
+        if (out_off_ == out_.size()) return true;
+        const bool ok = write_full(fd_, out_.data() + out_off_, out_.size() - out_off_);
+        ++send_calls_;
+        if (ok) bytes_out_ += out_.size() - out_off_;
+        out_.clear();
+        out_off_ = 0;
+        return ok;
+    }
+
+    // ── Asynchronous output (io_uring) ──
+
+    // Swap the queued bytes into `buf` for a send the kernel completes
+    // later. They count against the bound until sent_in_flight() retires
+    // them.
+    void detach_output(std::vector<char>& buf) {
+        buf.clear();
+        buf.swap(out_);
+        if (out_off_) buf.erase(buf.begin(), buf.begin() + static_cast<std::ptrdiff_t>(out_off_));
+        out_off_ = 0;
+        in_flight_ += buf.size();
+    }
+
+    void sent_in_flight(size_t n) noexcept {
+        in_flight_ -= n;
+        bytes_out_ += n;
+    }
+
+    // Closing with operations still in flight: queue nothing more.
+    void shut() noexcept { shut_ = true; }
+    [[nodiscard]] bool is_shut() const noexcept { return shut_; }
+
+    [[nodiscard]] bool     pending_output() const noexcept { return out_off_ < out_.size(); }
+    [[nodiscard]] size_t   output_bytes()   const noexcept { return out_.size() - out_off_; }
+    [[nodiscard]] bool     overflowed()     const noexcept { return overflowed_; }
+    [[nodiscard]] uint64_t frames_in()      const noexcept { return frames_in_; }
+    [[nodiscard]] uint64_t frames_out()     const noexcept { return frames_out_; }
+    [[nodiscard]] uint64_t bytes_out()      const noexcept { return bytes_out_; }
+    [[nodiscard]] uint64_t recv_calls()     const noexcept { return recv_calls_; }
+    [[nodiscard]] uint64_t send_calls()     const noexcept { return send_calls_; }
+
+private:
+    // Slide unread bytes to the front so the buffer always has room for a
+    // maximal frame.
+    void compact() {
+        if (in_off_ == 0) return;
+        std::memmove(in_.data(), in_.data() + in_off_, in_len_ - in_off_);
+        in_len_ -= in_off_;
+        in_off_ = 0;
+    }
+
+    int               fd_;
+    SessionId         id_;
+    size_t            max_output_;
+    std::vector<char> in_;
+    size_t            in_len_ = 0;   // bytes received
+    size_t            in_off_ = 0;   // bytes decoded
+    std::vector<char> out_;
+    size_t            out_off_ = 0;  // bytes already sent
+    size_t            in_flight_ = 0;   // detached, not yet confirmed sent
+    bool              overflowed_ = false;
+    bool              shut_       = false;
+    uint64_t          frames_in_  = 0;
+    uint64_t          frames_out_ = 0;
+    uint64_t          bytes_out_  = 0;
+    uint64_t          recv_calls_ = 0;   // recv() syscalls, EAGAIN included
+    uint64_t          send_calls_ = 0;
+};
+
+class SessionTable {
+public:
+    struct Counters {
+        uint64_t opened          = 0;
+        uint64_t closed          = 0;
+        uint64_t slow_consumers  = 0;   // disconnected for overflowing their output bound
+        uint64_t protocol_errors = 0;
+        uint64_t execs           = 0;   // Exec messages queued
+        uint64_t unrouted        = 0;   // trade sides whose owner had disconnected
+        // Wire totals of closed sessions.
+        uint64_t frames_in       = 0;
+        uint64_t frames_out      = 0;
+        uint64_t recv_calls      = 0;
+        uint64_t send_calls      = 0;
+    };
+
+    // Sessions that only write (the pipelined gateway's egress stage) need
+    // no receive buffer: pass recv_buffer = 0.
+    explicit SessionTable(size_t max_output_bytes, size_t recv_buffer = Session::RECV_BUFFER)
+        : max_output_(max_output_bytes), recv_buffer_(recv_buffer) {}
+
+    Session& open(int fd) {
+        const auto id = static_cast<SessionId>(sessions_.size());
+        sessions_.push_back(std::make_unique<Session>(fd, id, max_output_, recv_buffer_));
+        ++counters_.opened;
+        ++active_;
+        return *sessions_.back();
+    }
+
+    // Close the socket and forget the session. Its resting orders stay in
+    // the book; their executions are counted as unrouted.
+    void close(SessionId id) {
+        if (!get(id)) return;
+        const Session& s = *sessions_[id];
+        if (s.overflowed()) ++counters_.slow_consumers;
+        counters_.frames_in  += s.frames_in();
+        counters_.frames_out += s.frames_out();
+        counters_.recv_calls += s.recv_calls();
+        counters_.send_calls += s.send_calls();
+        sessions_[id].reset();
+        ++counters_.closed;
+        --active_;
+    }
+
+    // Session ids are never reused, so a stale owner entry cannot reach a
+    // later connection.
+    [[nodiscard]] Session* get(SessionId id) noexcept {
+        return id < sessions_.size() ? sessions_[id].get() : nullptr;
+    }
+
+    // ── Order ownership ──
+
+    // Record `session` as the owner of `id`. False if `id` is already live.
+    bool claim(OrderId id, SessionId session) {
+        return owners_.try_emplace(id, session).second;
+    }
+    void release(OrderId id) { owners_.erase(id); }
+
+    [[nodiscard]] SessionId owner(OrderId id) const {
+        auto it = owners_.find(id);
+        return it == owners_.end() ? SESSION_NONE : it->second;
+    }
+
+    // Hand Execs to `f(ctx, owner, exec)` instead of queueing them here: the
+    // pipelined gateway's matching stage keeps ownership in a table of its
+    // own and forwards to the egress stage, which owns the sessions.
+    using ExecForward = void (*)(void* ctx, SessionId owner, const WireExec& e);
+    void forward_execs(ExecForward f, void* ctx) noexcept {
+        forward_     = f;
+        forward_ctx_ = ctx;
+    }
+
+    // A trade print: one Exec to each side's owner.
+    void on_trade(const Trade& t) {
+        WireExec e{};
+        e.buy_order_id  = t.buy_order_id;
+        e.sell_order_id = t.sell_order_id;
+        e.price         = t.price;
+        e.quantity      = t.quantity;
+        e.aggressor     = static_cast<uint8_t>(t.aggressor);
+        const SessionId buyer = owner(t.buy_order_id), seller = owner(t.sell_order_id);
+        if (forward_) {
+            if (buyer != SESSION_NONE) forward_(forward_ctx_, buyer, e);
+            if (seller != buyer && seller != SESSION_NONE) forward_(forward_ctx_, seller, e);
+            return;
+        }
+        send_exec(buyer, e);
+        if (seller != buyer) send_exec(seller, e);
+    }
+
+    // Queue an Exec on its owner's session, or count it unrouted if that
+    // session has gone.
+    void send_exec(SessionId id, const WireExec& e) {
+        if (id == SESSION_NONE) return;
+        Session* s = get(id);
+        if (!s) { ++counters_.unrouted; return; }
+        if (queue(*s, MsgType::Exec, &e, sizeof(e))) ++counters_.execs;
+    }
+
+    // Done orders give up their id.
+    void on_order(const Order& o) {
+        if (o.status == OrderStatus::Filled || o.status == OrderStatus::Cancelled
+            || o.status == OrderStatus::Rejected) {
+            release(o.id);
+        }
+    }
+
+    // Queue on a session and remember it needs a flush (or, overflowed, a
+    // disconnect).
+    bool queue(Session& s, MsgType type, const void* payload, uint32_t len) {
+        mark_dirty(s);
+        return s.queue(type, payload, len);
+    }
+
+    void mark_dirty(Session& s) {
+        if (s.dirty) return;
+        s.dirty = true;
+        dirty_.push_back(s.id());
+    }
+
+    // f(session) for each session queued to since the last call, once each;
+    // the session may be closed from inside f.
+    template <typename F>
+    void drain_dirty(F&& f) {
+        scratch_.swap(dirty_);
+        for (SessionId id : scratch_) {
+            if (Session* s = get(id)) {
+                s->dirty = false;
+                f(*s);
+            }
+        }
+        scratch_.clear();
+    }
+
+    void count_protocol_error() noexcept { ++counters_.protocol_errors; }
+
+    [[nodiscard]] const Counters& counters() const noexcept { return counters_; }
+    [[nodiscard]] size_t active() const noexcept { return active_; }
+    [[nodiscard]] size_t live_orders() const noexcept { return owners_.size(); }
+
+private:
+    size_t                                    max_output_;
+    size_t                                    recv_buffer_;
+    std::vector<std::unique_ptr<Session>>     sessions_;
+    std::unordered_map<OrderId, SessionId>    owners_;
+    std::vector<SessionId>                    dirty_;
+    std::vector<SessionId>                    scratch_;
+    Counters                                  counters_;
+    size_t                                    active_ = 0;
+    ExecForward                               forward_     = nullptr;
+    void*                                     forward_ctx_ = nullptr;
+};
+
+} // namespace micro_exchange::net
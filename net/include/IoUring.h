@@ -0,0 +1,330 @@
+#pragma once
+
+// ─────────────────────────────────────────────────────────────────────────
+// IoUring — a minimal io_uring ring for the gateway's completion backend.
+//
+// Straight on the kernel ABI (<linux/io_uring.h>), no liburing: setup and
+// mmap of the submission / completion rings, an SQE builder per operation
+// the gateway uses (multishot accept, multishot recv from a provided-buffer
+// group, send, cancel), and one io_uring_enter() that submits everything prepared
+// since the last call and waits for completions with a timeout.
+//
+// Receive buffers are a registered buffer ring (IORING_REGISTER_PBUF_RING):
+// the kernel picks a free buffer for each completion and reports its id;
+// the caller hands it back with recycle() once the bytes are consumed.
+//
+// With `sqpoll` a kernel thread drains the submission ring, so submitting
+// costs no syscall while that thread is awake.
+//
+// Linux only; MICRO_EXCHANGE_HAS_IO_URING is 0 elsewhere and the gateway
+// rejects the backend at construction.
+// ─────────────────────────────────────────────────────────────────────────
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define MICRO_EXCHANGE_HAS_IO_URING 1
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <stdexcept>
+#include <vector>
+
+namespace micro_exchange::net {
+
+class IoUring {
+public:
+    struct Completion {
+        uint64_t user_data;
+        int32_t  res;
+        uint32_t flags;
+
+        [[nodiscard]] bool     more()       const noexcept { return flags & IORING_CQE_F_MORE; }
+        [[nodiscard]] bool     has_buffer() const noexcept { return flags & IORING_CQE_F_BUFFER; }
+        [[nodiscard]] uint16_t buffer_id()  const noexcept {
+            return static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+        }
+    };
+
+    static constexpr uint16_t BUFFER_GROUP = 0;
+
+    // `entries` SQ slots (CQ is twice that); `buffers` × `buffer_size`
+    // bytes of provided receive buffers (`buffers` a power of two).
+    IoUring(unsigned entries, unsigned buffers, unsigned buffer_size, bool sqpoll)
+        : buffer_size_(buffer_size), buffer_count_(buffers)
+    {
+        io_uring_params p{};
+        if (sqpoll) {
+            p.flags |= IORING_SETUP_SQPOLL;
+            p.sq_thread_idle = 2000;   // ms before the poll thread sleeps
+        }
+        ring_fd_ = setup(entries, p);
+        if (ring_fd_ < 0 && sqpoll) {   // not permitted here: run without it
+            p = io_uring_params{};
+            ring_fd_ = setup(entries, p);
+        }
+        if (ring_fd_ < 0) throw std::runtime_error("io_uring_setup() failed");
+        sqpoll_ = p.flags & IORING_SETUP_SQPOLL;
+        try {
+            if (!(p.features & IORING_FEAT_EXT_ARG))
+                throw std::runtime_error("io_uring: kernel lacks IORING_FEAT_EXT_ARG");
+            map_rings(p);
+            register_buffers();
+        } catch (...) {
+            release();
+            throw;
+        }
+    }
+
+    ~IoUring() { release(); }
+
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    [[nodiscard]] bool     sqpoll()   const noexcept { return sqpoll_; }
+    [[nodiscard]] uint64_t syscalls() const noexcept { return enters_; }   // io_uring_enter calls
+
+    // ── Preparing submissions (false if the SQ is full; submit and retry) ──
+
+    bool accept_multishot(int listen_fd, uint64_t user_data) {
+        io_uring_sqe* sqe = next_sqe();
+        if (!sqe) return false;
+        sqe->opcode    = IORING_OP_ACCEPT;
+        sqe->fd        = listen_fd;
+        sqe->ioprio    = IORING_ACCEPT_MULTISHOT;
+        sqe->user_data = user_data;
+        return true;
+    }
+
+    bool recv_multishot(int fd, uint64_t user_data) {
+        io_uring_sqe* sqe = next_sqe();
+        if (!sqe) return false;
+        sqe->opcode    = IORING_OP_RECV;
+        sqe->fd        = fd;
+        sqe->ioprio    = IORING_RECV_MULTISHOT;
+        sqe->flags     = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = BUFFER_GROUP;
+        sqe->user_data = user_data;
+        return true;
+    }
+
+    bool send(int fd, const void* buf, size_t len, uint64_t user_data) {
+        io_uring_sqe* sqe = next_sqe();
+        if (!sqe) return false;
+        sqe->opcode    = IORING_OP_SEND;
+        sqe->fd        = fd;
+        sqe->addr      = reinterpret_cast<uint64_t>(buf);
+        sqe->len       = static_cast<uint32_t>(len);
+        sqe->msg_flags = MSG_NOSIGNAL;
+        sqe->user_data = user_data;
+        return true;
+    }
+
+    // Cancel the operation submitted with `target` user_data; it completes
+    // with -ECANCELED (if still running), the cancel itself with `user_data`.
+    bool cancel(uint64_t target, uint64_t user_data) {
+        io_uring_sqe* sqe = next_sqe();
+        if (!sqe) return false;
+        sqe->opcode    = IORING_OP_ASYNC_CANCEL;
+        sqe->fd        = -1;
+        sqe->addr      = target;
+        sqe->user_data = user_data;
+        return true;
+    }
+
+    // Publish prepared SQEs and wait up to `timeout_ms` for at least one
+    // completion (0 = don't wait). One syscall, or none under SQPOLL when
+    // not waiting and the poll thread is awake.
+    void submit_and_wait(int timeout_ms) {
+        std::atomic_ref<unsigned>(*sq_tail_).store(sqe_tail_, std::memory_order_release);
+        // Everything the kernel has not consumed, including SQEs an earlier
+        // enter() left behind (-EBUSY while the CQ was backed up).
+        const unsigned pending = sqe_tail_ - std::atomic_ref<unsigned>(*sq_head_).load(std::memory_order_acquire);
+
+        unsigned flags = 0, to_submit = pending;
+        if (sqpoll_) {
+            to_submit = 0;
+            if (std::atomic_ref<unsigned>(*sq_flags_).load(std::memory_order_acquire) & IORING_SQ_NEED_WAKEUP)
+                flags |= IORING_ENTER_SQ_WAKEUP;
+        }
+        if (timeout_ms == 0) {
+            if (to_submit || flags) enter(to_submit, 0, flags, nullptr);
+            return;
+        }
+        if (ready()) {   // completions already waiting: just submit
+            if (to_submit || flags) enter(to_submit, 0, flags, nullptr);
+            return;
+        }
+        __kernel_timespec ts{};
+        ts.tv_sec  = timeout_ms / 1000;
+        ts.tv_nsec = static_cast<long long>(timeout_ms % 1000) * 1'000'000;
+        io_uring_getevents_arg arg{};
+        arg.ts = reinterpret_cast<uint64_t>(&ts);
+        enter(to_submit, 1, flags | IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg);
+    }
+
+    // Hand every ready completion to f(Completion) and retire them.
+    template <typename F>
+    size_t drain(F&& f) {
+        unsigned head = *cq_head_;
+        const unsigned tail = std::atomic_ref<unsigned>(*cq_tail_).load(std::memory_order_acquire);
+        size_t n = 0;
+        for (; head != tail; ++head, ++n) {
+            const io_uring_cqe& c = cqes_[head & cq_mask_];
+            f(Completion{c.user_data, c.res, c.flags});
+        }
+        std::atomic_ref<unsigned>(*cq_head_).store(head, std::memory_order_release);
+        return n;
+    }
+
+    // ── Provided receive buffers ──
+
+    [[nodiscard]] const char* buffer(uint16_t id) const noexcept {
+        return buffers_.data() + size_t(id) * buffer_size_;
+    }
+
+    // Give buffer `id` back to the kernel.
+    void recycle(uint16_t id) {
+        add_buffer(id, buf_tail_++);
+        std::atomic_ref<uint16_t>(buf_ring_->tail).store(buf_tail_, std::memory_order_release);
+    }
+
+private:
+    static int setup(unsigned entries, io_uring_params& p) {
+        p.flags |= IORING_SETUP_CQSIZE;
+        p.cq_entries = entries * 2;
+        return static_cast<int>(::syscall(__NR_io_uring_setup, entries, &p));
+    }
+
+    int enter(unsigned to_submit, unsigned min_complete, unsigned flags, io_uring_getevents_arg* arg) {
+        ++enters_;
+        const int r = static_cast<int>(::syscall(__NR_io_uring_enter, ring_fd_, to_submit, min_complete,
+                                                 flags, arg, arg ? sizeof(*arg) : 0));
+        return r < 0 ? -errno : r;   // -ETIME / -EINTR: nothing ready, caller polls again
+    }
+
+    [[nodiscard]] bool ready() const noexcept {
+        return *cq_head_ != std::atomic_ref<unsigned>(*cq_tail_).load(std::memory_order_acquire);
+    }
+
+    io_uring_sqe* next_sqe() {
+        const unsigned head = std::atomic_ref<unsigned>(*sq_head_).load(std::memory_order_acquire);
+        if (sqe_tail_ - head >= sq_entries_) return nullptr;
+        const unsigned idx = sqe_tail_ & sq_mask_;
+        io_uring_sqe* sqe = &sqes_[idx];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sq_array_[idx] = idx;
+        ++sqe_tail_;
+        return sqe;
+    }
+
+    void release() noexcept {
+        if (buf_ring_) ::munmap(buf_ring_, buf_ring_bytes_);
+        if (sqes_) ::munmap(sqes_, sqes_bytes_);
+        if (cq_ptr_ && cq_ptr_ != sq_ptr_) ::munmap(cq_ptr_, cq_bytes_);
+        if (sq_ptr_) ::munmap(sq_ptr_, sq_bytes_);
+        if (ring_fd_ >= 0) ::close(ring_fd_);
+    }
+
+    void* map(size_t bytes, off_t offset) {
+        void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, offset);
+        if (p == MAP_FAILED) throw std::runtime_error("io_uring: ring mmap failed");
+        return p;
+    }
+
+    void map_rings(const io_uring_params& p) {
+        sq_bytes_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cq_bytes_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        const bool single = p.features & IORING_FEAT_SINGLE_MMAP;
+        if (single) sq_bytes_ = cq_bytes_ = std::max(sq_bytes_, cq_bytes_);
+        sq_ptr_ = map(sq_bytes_, IORING_OFF_SQ_RING);
+        cq_ptr_ = single ? sq_ptr_ : map(cq_bytes_, IORING_OFF_CQ_RING);
+        sqes_bytes_ = p.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe*>(map(sqes_bytes_, IORING_OFF_SQES));
+
+        auto* sq = static_cast<char*>(sq_ptr_);
+        sq_head_    = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+        sq_tail_    = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+        sq_flags_   = reinterpret_cast<unsigned*>(sq + p.sq_off.flags);
+        sq_array_   = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+        sq_mask_    = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+        sq_entries_ = p.sq_entries;
+        sqe_tail_ = *sq_tail_;
+
+        auto* cq = static_cast<char*>(cq_ptr_);
+        cq_head_ = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+        cqes_    = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+    }
+
+    void register_buffers() {
+        buffers_.resize(size_t(buffer_count_) * buffer_size_);
+        buf_ring_bytes_ = buffer_count_ * sizeof(io_uring_buf);
+        void* mem = ::mmap(nullptr, buf_ring_bytes_, PROT_READ | PROT_WRITE,
+                           MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+        if (mem == MAP_FAILED) { buf_ring_bytes_ = 0; throw std::runtime_error("io_uring: buffer ring mmap failed"); }
+        buf_ring_ = static_cast<io_uring_buf_ring*>(mem);
+
+        io_uring_buf_reg reg{};
+        reg.ring_addr    = reinterpret_cast<uint64_t>(buf_ring_);
+        reg.ring_entries = buffer_count_;
+        reg.bgid         = BUFFER_GROUP;
+        if (::syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_PBUF_RING, &reg, 1) < 0)
+            throw std::runtime_error("io_uring: IORING_REGISTER_PBUF_RING failed");
+
+        for (unsigned i = 0; i < buffer_count_; ++i) add_buffer(static_cast<uint16_t>(i), buf_tail_++);
+        std::atomic_ref<uint16_t>(buf_ring_->tail).store(buf_tail_, std::memory_order_release);
+    }
+
+    // Entries are indexed off the ring base, not through `bufs`: in C++ the
+    // header's flexible-array wrapper has a 1-byte empty member, which moves
+    // `bufs` 8 bytes off the kernel's layout.
+    void add_buffer(uint16_t id, uint16_t slot) {
+        io_uring_buf& b = reinterpret_cast<io_uring_buf*>(buf_ring_)[slot & (buffer_count_ - 1)];
+        b.addr = reinterpret_cast<uint64_t>(buffers_.data() + size_t(id) * buffer_size_);
+        b.len  = buffer_size_;
+        b.bid  = id;
+    }
+
+    int      ring_fd_ = -1;
+    bool     sqpoll_  = false;
+    uint64_t enters_  = 0;
+
+    void*   sq_ptr_ = nullptr;
+    void*   cq_ptr_ = nullptr;
+    size_t  sq_bytes_ = 0, cq_bytes_ = 0, sqes_bytes_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+
+    unsigned* sq_head_  = nullptr;
+    unsigned* sq_tail_  = nullptr;
+    unsigned* sq_flags_ = nullptr;
+    unsigned* sq_array_ = nullptr;
+    unsigned  sq_mask_  = 0, sq_entries_ = 0;
+    unsigned  sqe_tail_ = 0;    // next SQE to prepare
+
+    unsigned*     cq_head_ = nullptr;
+    unsigned*     cq_tail_ = nullptr;
+    unsigned      cq_mask_ = 0;
+    io_uring_cqe* cqes_    = nullptr;
+
+    unsigned           buffer_size_;
+    unsigned           buffer_count_;
+    std::vector<char>  buffers_;
+    io_uring_buf_ring* buf_ring_ = nullptr;
+    size_t             buf_ring_bytes_ = 0;
+    uint16_t           buf_tail_ = 0;
+};
+
+} // namespace micro_exchange::net
+
+#else
+#define MICRO_EXCHANGE_HAS_IO_URING 0
+#endif
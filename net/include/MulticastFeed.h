@@ -0,0 +1,728 @@
+#pragma once
+
+// ─────────────────────────────────────────────────────────────────────────
+// MulticastFeed — market data over UDP multicast, with TCP gap fill.
+//
+//   [FeedPublisher] → push() → SPSCRingBuffer → [sender thread] → UDP packets
+//                                                      │
+//                                                      └→ FeedHistory ← [FeedRetransmitServer] ← TCP
+//
+// Packets are MoldUDP64-style: a 20-byte header (10-byte session, the
+// sequence number of the first message, a message count) and then the
+// messages as FeedCodec Compact frames, whose u16 length prefix is exactly
+// a MoldUDP64 message block. Consecutive messages share a packet until the
+// next one would push it past `max_payload` (sized for a 1500-byte MTU) or
+// the oldest one has waited `flush_us`; whichever comes first sends it.
+// With nothing to send, a heartbeat (count 0, the next sequence) goes out
+// every `heartbeat_ms` so receivers notice a lost tail; close() sends the
+// end-of-session packet (count 0xFFFF).
+//
+// The matching thread only pushes into the ring: every syscall happens on
+// the sender thread. After each packet the sender records its frames in a
+// FeedHistory, which also keeps the latest snapshot block (an S header and
+// the LevelSnapshots that follow it) of every symbol. FeedRetransmitServer
+// answers gap-fill requests from that history over TCP; a request older
+// than the history gets the snapshots and the history after them instead.
+// The snapshots are the ones the publisher puts on the feed itself
+// (generate_snapshot / generate_depth_snapshot / depth_snapshot_every), so
+// the service never touches a book from its own thread.
+//
+// Numeric fields are host byte order, as in OrderEntryProtocol.h (real
+// MoldUDP64 is big-endian). Receivers on the same host as the publisher
+// need IP_MULTICAST_LOOP, which is on by default here; a unicast `group`
+// (127.0.0.1) works too, for hosts without a multicast route.
+// ─────────────────────────────────────────────────────────────────────────
+
+#include "FeedMessage.h"
+#include "FeedCodec.h"
+#include "SPSCRingBuffer.h"
+#include "OrderEntryProtocol.h"
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace micro_exchange::net {
+
+using md::FeedMessage;
+using md::FeedMessageType;
+using md::SeqNum;
+
+// ── MoldUDP64 framing ──
+
+inline constexpr size_t   MOLD_HEADER_BYTES = 20;
+inline constexpr uint16_t MOLD_END_OF_SESSION = 0xFFFF;
+inline constexpr size_t   MOLD_MAX_PACKET   = 65507;   // largest UDP payload
+
+struct MoldHeader {
+    char     session[10] = {};
+    SeqNum   sequence    = 0;   // first message in the packet (next one, if count is 0)
+    uint16_t count       = 0;   // messages that follow; 0 = heartbeat
+};
+
+inline void put_mold_header(std::byte* out, const MoldHeader& h) {
+    std::memcpy(out, h.session, sizeof(h.session));
+    std::memcpy(out + 10, &h.sequence, sizeof(h.sequence));
+    std::memcpy(out + 18, &h.count, sizeof(h.count));
+}
+
+inline bool get_mold_header(const std::byte* in, size_t n, MoldHeader& h) {
+    if (n < MOLD_HEADER_BYTES) return false;
+    std::memcpy(h.session, in, sizeof(h.session));
+    std::memcpy(&h.sequence, in + 10, sizeof(h.sequence));
+    std::memcpy(&h.count, in + 18, sizeof(h.count));
+    return true;
+}
+
+/// Decode a packet's message blocks into `out` (appended). False if the
+/// packet is truncated or a frame is malformed.
+inline bool decode_mold_packet(const std::byte* in, size_t n, MoldHeader& h,
+                               std::vector<FeedMessage>& out) {
+    if (!get_mold_header(in, n, h)) return false;
+    if (h.count == MOLD_END_OF_SESSION) return true;
+    size_t off = MOLD_HEADER_BYTES;
+    for (uint16_t i = 0; i < h.count; ++i) {
+        FeedMessage m;
+        const size_t used = md::decode_frame(in + off, n - off, m);
+        if (used == 0) return false;
+        out.push_back(m);
+        off += used;
+    }
+    return off == n;
+}
+
+// ── Gap-fill protocol (TCP, WireHeader framing from OrderEntryProtocol.h) ──
+//
+//  client → server  Retransmit      { first sequence, count }
+//  server → client  FeedPackets*    payload = one MoldUDP64 packet
+//                   RetransmitDone  { what was sent }
+
+enum class FeedMsgType : uint8_t {
+    Retransmit     = 20,
+    FeedPackets    = 21,
+    RetransmitDone = 22,
+};
+
+enum class RetransmitStatus : uint8_t {
+    Replayed = 0,   // the requested range, from history
+    Snapshot = 1,   // too old: latest snapshots, then the history after them
+    Empty    = 2,   // nothing to send (no history yet, or a future range)
+};
+
+struct WireRetransmit {
+    uint64_t sequence;
+    uint32_t count;
+    uint8_t  pad[4];
+};
+
+struct WireRetransmitDone {
+    uint64_t first_sequence;   // first message sent from history
+    uint64_t next_sequence;    // one past the last message sent
+    uint32_t snapshots;        // snapshot blocks sent ahead of the history
+    uint8_t  status;           // RetransmitStatus
+    uint8_t  pad[3];
+};
+
+/**
+ * FeedHistory — the last `capacity` messages as encoded frames, plus the
+ * latest snapshot block of each symbol. Written by the sender thread once
+ * per packet, read by the retransmit server; a mutex covers both (the
+ * sender holds it for one packet's worth of copies).
+ */
+class FeedHistory {
+public:
+    explicit FeedHistory(size_t capacity) : slots_(std::max<size_t>(capacity, 1)) {}
+
+    /// Record the `count` frames of a packet whose first message is `first`.
+    void record(SeqNum first, const std::byte* frames, size_t bytes, uint16_t count) {
+        std::lock_guard lock(mu_);
+        if (next_ != first) begin_ = first;   // (re)start: history must be contiguous
+        size_t off = 0;
+        for (uint16_t i = 0; i < count && off + 2 <= bytes; ++i) {
+            uint16_t len;
+            std::memcpy(&len, frames + off, sizeof(len));
+            const size_t n = sizeof(len) + len;
+            const SeqNum seq = first + i;
+            Slot& s = slots_[seq % slots_.size()];
+            s.len = static_cast<uint16_t>(n);
+            std::memcpy(s.bytes.data(), frames + off, n);
+            track_snapshot(seq, s);
+            off += n;
+        }
+        next_ = first + count;
+        if (next_ - begin_ > slots_.size()) begin_ = next_ - slots_.size();
+    }
+
+    /// Held sequence range [first, next).
+    [[nodiscard]] std::pair<SeqNum, SeqNum> range() const {
+        std::lock_guard lock(mu_);
+        return {begin_, next_};
+    }
+
+private:
+    friend class FeedRetransmitServer;
+
+    struct Slot {
+        uint16_t len = 0;
+        std::array<std::byte, md::MAX_FRAME_BYTES> bytes{};
+    };
+    struct SnapshotBlock {
+        SeqNum first = 0;
+        std::vector<Slot> frames;
+    };
+
+    // Frame layout: u16 length | u8 type | u64 seq | u64 ts | u8 symlen | symbol.
+    void track_snapshot(SeqNum seq, const Slot& s) {
+        const auto type = static_cast<FeedMessageType>(s.bytes[2]);
+        if (type != FeedMessageType::Snapshot && type != FeedMessageType::LevelSnapshot) return;
+        const auto sym_len = static_cast<size_t>(s.bytes[19]);
+        std::string sym(reinterpret_cast<const char*>(s.bytes.data() + 20), sym_len);
+        SnapshotBlock& block = snapshots_[sym];
+        if (type == FeedMessageType::Snapshot) {
+            block.first = seq;
+            block.frames.assign(1, s);
+        } else if (!block.frames.empty() && block.first + block.frames.size() == seq) {
+            block.frames.push_back(s);
+        }
+    }
+
+    mutable std::mutex                   mu_;
+    std::vector<Slot>                    slots_;
+    SeqNum                               begin_ = 0;
+    SeqNum                               next_  = 0;
+    std::map<std::string, SnapshotBlock> snapshots_;
+};
+
+/**
+ * MulticastFeedPublisher — packs feed messages into MoldUDP64 packets and
+ * sends them from its own thread. Wire it to a FeedPublisher with
+ * `feed.set_callback([&](const FeedMessage& m) { mcast.push(m); })`.
+ */
+class MulticastFeedPublisher {
+public:
+    static constexpr size_t RING_SIZE = 1 << 14;
+
+    struct Options {
+        std::string group        = "239.192.0.1";
+        uint16_t    port         = 31001;
+        std::string interface    = "127.0.0.1";   // multicast egress interface
+        int         ttl          = 1;
+        bool        loopback     = true;          // deliver to receivers on this host
+        size_t      max_payload  = 1472;          // 1500 MTU - IP/UDP headers
+        uint32_t    flush_us     = 50;            // oldest message waits at most this long
+        uint32_t    heartbeat_ms = 1000;
+        uint32_t    idle_sleep_us = 20;           // sender naps this long with nothing open
+        size_t      history      = 1 << 16;       // messages kept for retransmission
+        char        session[10]  = {'M', 'X', 'F', 'E', 'E', 'D'};
+    };
+
+    struct Stats {
+        uint64_t messages     = 0;
+        uint64_t packets      = 0;   // data packets (heartbeats not counted)
+        uint64_t bytes        = 0;   // UDP payload bytes, data packets
+        uint64_t flush_size   = 0;   // sent because the next message didn't fit
+        uint64_t flush_timer  = 0;   // sent because flush_us expired
+        uint64_t heartbeats   = 0;
+        uint64_t send_errors  = 0;
+        uint64_t stalls       = 0;   // push() found the ring full
+    };
+
+    explicit MulticastFeedPublisher(Options opts)
+        : opts_(std::move(opts)), ring_(std::make_unique<Ring>()), history_(opts_.history)
+    {
+        opts_.max_payload = std::clamp(opts_.max_payload, MOLD_HEADER_BYTES + md::MAX_FRAME_BYTES,
+                                       MOLD_MAX_PACKET);
+        fd_ = ::socket(AF_INET, SOCK_DGRAM, 0);
+        if (fd_ < 0) throw std::runtime_error("socket() failed");
+
+        dest_.sin_family = AF_INET;
+        dest_.sin_port   = htons(opts_.port);
+        if (::inet_pton(AF_INET, opts_.group.c_str(), &dest_.sin_addr) != 1) {
+            ::close(fd_);
+            throw std::runtime_error("bad multicast group address");
+        }
+        if (IN_MULTICAST(ntohl(dest_.sin_addr.s_addr))) {
+            in_addr ifc{};
+            ::inet_pton(AF_INET, opts_.interface.c_str(), &ifc);
+            const unsigned char ttl  = static_cast<unsigned char>(opts_.ttl);
+            const unsigned char loop = opts_.loopback ? 1 : 0;
+            ::setsockopt(fd_, IPPROTO_IP, IP_MULTICAST_IF, &ifc, sizeof(ifc));
+            ::setsockopt(fd_, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+            ::setsockopt(fd_, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+        }
+        int sndbuf = 4 << 20;
+        ::setsockopt(fd_, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+
+        packet_.resize(opts_.max_payload);
+        thread_ = std::thread([this] { run(); });
+    }
+
+    ~MulticastFeedPublisher() {
+        close();
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    MulticastFeedPublisher(const MulticastFeedPublisher&) = delete;
+    MulticastFeedPublisher& operator=(const MulticastFeedPublisher&) = delete;
+
+    /// Queue one message (producer thread only). Yields while the ring is full.
+    void push(const FeedMessage& msg) {
+        while (!ring_->push(msg)) {
+            ++stalls_;
+            std::this_thread::yield();
+        }
+    }
+
+    /// Send everything queued, then the end-of-session packet, and stop.
+    void close() {
+        if (!thread_.joinable()) return;
+        stop_.store(true, std::memory_order_release);
+        thread_.join();
+    }
+
+    [[nodiscard]] FeedHistory& history() noexcept { return history_; }
+    [[nodiscard]] const Options& options() const noexcept { return opts_; }
+
+    /// Counters; exact once close() has returned.
+    [[nodiscard]] Stats stats() const noexcept {
+        Stats s;
+        s.messages    = messages_.load(std::memory_order_relaxed);
+        s.packets     = packets_.load(std::memory_order_relaxed);
+        s.bytes       = bytes_.load(std::memory_order_relaxed);
+        s.flush_size  = flush_size_.load(std::memory_order_relaxed);
+        s.flush_timer = flush_timer_.load(std::memory_order_relaxed);
+        s.heartbeats  = heartbeats_.load(std::memory_order_relaxed);
+        s.send_errors = send_errors_.load(std::memory_order_relaxed);
+        s.stalls      = stalls_;
+        return s;
+    }
+
+private:
+    using Ring  = md::SPSCRingBuffer<FeedMessage, RING_SIZE>;
+    using Clock = std::chrono::steady_clock;
+
+    // Stop is read before draining, as in FeedWriter: whatever was pushed
+    // before close() is sent before the end-of-session packet.
+    void run() {
+        last_send_ = Clock::now();
+        while (true) {
+            const bool stopping = stop_.load(std::memory_order_acquire);
+            bool drained = false;
+            while (ring_->consume([this](const FeedMessage& m) { append(m); }, 256)) drained = true;
+            const auto t = Clock::now();
+            if (count_ && t - opened_ >= std::chrono::microseconds(opts_.flush_us)) {
+                send_packet();
+                flush_timer_.fetch_add(1, std::memory_order_relaxed);
+            }
+            if (drained) continue;
+            if (stopping) break;
+            if (count_) {
+                std::this_thread::yield();   // a packet is open: keep its deadline
+                continue;
+            }
+            if (t - last_send_ >= std::chrono::milliseconds(opts_.heartbeat_ms)) send_control(0);
+            std::this_thread::sleep_for(std::chrono::microseconds(opts_.idle_sleep_us));
+        }
+        if (count_) send_packet();
+        send_control(MOLD_END_OF_SESSION);
+    }
+
+    void append(const FeedMessage& msg) {
+        std::byte frame[md::MAX_FRAME_BYTES];
+        const size_t n = md::encode_frame(msg, frame);
+        if (count_ && (len_ + n > opts_.max_payload || msg.sequence != next_seq_)) {
+            send_packet();
+            flush_size_.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (count_ == 0) {
+            first_seq_ = msg.sequence;
+            len_       = MOLD_HEADER_BYTES;
+            opened_    = Clock::now();
+        }
+        std::memcpy(packet_.data() + len_, frame, n);
+        len_ += n;
+        ++count_;
+        next_seq_ = msg.sequence + 1;
+        messages_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void send_packet() {
+        MoldHeader h;
+        std::memcpy(h.session, opts_.session, sizeof(h.session));
+        h.sequence = first_seq_;
+        h.count    = count_;
+        put_mold_header(packet_.data(), h);
+        transmit(packet_.data(), len_);
+        packets_.fetch_add(1, std::memory_order_relaxed);
+        bytes_.fetch_add(len_, std::memory_order_relaxed);
+        history_.record(first_seq_, packet_.data() + MOLD_HEADER_BYTES, len_ - MOLD_HEADER_BYTES, count_);
+        count_ = 0;
+    }
+
+    void send_control(uint16_t count) {
+        std::byte buf[MOLD_HEADER_BYTES];
+        MoldHeader h;
+        std::memcpy(h.session, opts_.session, sizeof(h.session));
+        h.sequence = next_seq_;
+        h.count    = count;
+        put_mold_header(buf, h);
+        transmit(buf, sizeof(buf));
+        if (count == 0) heartbeats_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void transmit(const std::byte* p, size_t n) {
+        const auto w = ::sendto(fd_, p, n, 0, reinterpret_cast<const sockaddr*>(&dest_), sizeof(dest_));
+        if (w != static_cast<ssize_t>(n)) send_errors_.fetch_add(1, std::memory_order_relaxed);
+        last_send_ = Clock::now();
+    }
+
+    Options                 opts_;
+    std::unique_ptr<Ring>   ring_;
+    FeedHistory             history_;
+    int                     fd_ = -1;
+    sockaddr_in             dest_{};
+    std::thread             thread_;
+    std::atomic<bool>       stop_{false};
+
+    // Sender thread only.
+    std::vector<std::byte>  packet_;
+    size_t                  len_       = 0;
+    uint16_t                count_     = 0;
+    SeqNum                  first_seq_ = 0;
+    SeqNum                  next_seq_  = 1;
+    Clock::time_point       opened_{};
+    Clock::time_point       last_send_{};
+
+    std::atomic<uint64_t>   messages_{0}, packets_{0}, bytes_{0};
+    std::atomic<uint64_t>   flush_size_{0}, flush_timer_{0}, heartbeats_{0}, send_errors_{0};
+    uint64_t                stalls_ = 0;   // producer thread only
+};
+
+/**
+ * FeedRetransmitServer — TCP gap fill from a FeedHistory, on its own
+ * thread. Binds 127.0.0.1 (port 0 = ephemeral, see port()); serves one
+ * connection at a time, any number of requests per connection.
+ */
+class FeedRetransmitServer {
+public:
+    FeedRetransmitServer(FeedHistory& history, uint16_t port, const char (&session)[10])
+        : history_(history)
+    {
+        std::signal(SIGPIPE, SIG_IGN);
+        std::memcpy(session_, session, sizeof(session_));
+
+        listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (listen_fd_ < 0) throw std::runtime_error("socket() failed");
+        int yes = 1;
+        ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(port);
+        if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0
+            || ::listen(listen_fd_, 16) < 0) {
+            ::close(listen_fd_);
+            throw std::runtime_error("retransmit server bind/listen failed");
+        }
+        sockaddr_in bound{};
+        socklen_t blen = sizeof(bound);
+        ::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&bound), &blen);
+        port_ = ntohs(bound.sin_port);
+
+        thread_ = std::thread([this] { run(); });
+    }
+
+    ~FeedRetransmitServer() {
+        stop_.store(true, std::memory_order_release);
+        if (thread_.joinable()) thread_.join();
+        if (listen_fd_ >= 0) ::close(listen_fd_);
+    }
+
+    FeedRetransmitServer(const FeedRetransmitServer&) = delete;
+    FeedRetransmitServer& operator=(const FeedRetransmitServer&) = delete;
+
+    [[nodiscard]] uint16_t port() const noexcept { return port_; }
+    [[nodiscard]] uint64_t requests() const noexcept { return requests_.load(std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t snapshots_served() const noexcept { return snapshots_.load(std::memory_order_relaxed); }
+
+private:
+    using Slot = FeedHistory::Slot;
+
+    // poll() with a timeout rather than a blocking accept/read, so the
+    // destructor's stop flag is seen within 50 ms.
+    bool wait_readable(int fd) {
+        pollfd p{fd, POLLIN, 0};
+        while (!stop_.load(std::memory_order_acquire)) {
+            if (::poll(&p, 1, 50) > 0) return true;
+        }
+        return false;
+    }
+
+    void run() {
+        while (wait_readable(listen_fd_)) {
+            const int fd = ::accept(listen_fd_, nullptr, nullptr);
+            if (fd < 0) continue;
+            int yes = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+            WireHeader h{};
+            while (wait_readable(fd) && recv_header(fd, h)) {
+                WireRetransmit req{};
+                if (static_cast<FeedMsgType>(h.type) != FeedMsgType::Retransmit || h.len != sizeof(req)
+                    || !read_full(fd, &req, sizeof(req)) || !serve(fd, req)) break;
+            }
+            ::close(fd);
+        }
+    }
+
+    // Copy what to send under the lock, send it after.
+    bool serve(int fd, const WireRetransmit& req) {
+        requests_.fetch_add(1, std::memory_order_relaxed);
+        std::vector<std::pair<SeqNum, std::vector<Slot>>> blocks;
+        WireRetransmitDone done{};
+        {
+            std::lock_guard lock(history_.mu_);
+            const SeqNum begin = history_.begin_, end = history_.next_;
+            SeqNum from = req.sequence;
+            const SeqNum to = std::min<SeqNum>(req.sequence + req.count, end);
+            done.status = static_cast<uint8_t>(RetransmitStatus::Replayed);
+            if (from < begin) {
+                // The gap is older than the history: snapshots, then what follows them.
+                SeqNum oldest = end;
+                for (const auto& [sym, block] : history_.snapshots_) {
+                    blocks.emplace_back(block.first, block.frames);
+                    oldest = std::min(oldest, block.first + block.frames.size());
+                }
+                from = std::max(oldest, begin);
+                done.status    = static_cast<uint8_t>(RetransmitStatus::Snapshot);
+                done.snapshots = static_cast<uint32_t>(blocks.size());
+            }
+            std::vector<Slot> tail;
+            for (SeqNum s = from; s < to; ++s) tail.push_back(history_.slots_[s % history_.slots_.size()]);
+            if (blocks.empty() && tail.empty()) done.status = static_cast<uint8_t>(RetransmitStatus::Empty);
+            done.first_sequence = from;
+            done.next_sequence  = std::max(from, to);
+            if (!tail.empty()) blocks.emplace_back(from, std::move(tail));
+        }
+        if (done.status == static_cast<uint8_t>(RetransmitStatus::Snapshot)) snapshots_.fetch_add(1, std::memory_order_relaxed);
+
+        for (const auto& [first, frames] : blocks) {
+            if (!send_block(fd, first, frames)) return false;
+        }
+        return send_msg(fd, static_cast<MsgType>(FeedMsgType::RetransmitDone), &done, sizeof(done));
+    }
+
+    // One FeedPackets message per MoldUDP64 packet's worth of frames.
+    bool send_block(int fd, SeqNum first, const std::vector<Slot>& frames) {
+        std::vector<std::byte> pkt(MOLD_MAX_PACKET);
+        size_t i = 0;
+        while (i < frames.size()) {
+            MoldHeader h;
+            std::memcpy(h.session, session_, sizeof(h.session));
+            h.sequence = first + i;
+            size_t len = MOLD_HEADER_BYTES;
+            while (i < frames.size() && len + frames[i].len <= pkt.size() && h.count < MOLD_END_OF_SESSION - 1) {
+                std::memcpy(pkt.data() + len, frames[i].bytes.data(), frames[i].len);
+                len += frames[i].len;
+                ++h.count;
+                ++i;
+            }
+            put_mold_header(pkt.data(), h);
+            if (!send_msg(fd, static_cast<MsgType>(FeedMsgType::FeedPackets), pkt.data(),
+                          static_cast<uint32_t>(len))) return false;
+        }
+        return true;
+    }
+
+    FeedHistory&          history_;
+    char                  session_[10] = {};
+    int                   listen_fd_ = -1;
+    uint16_t              port_      = 0;
+    std::thread           thread_;
+    std::atomic<bool>     stop_{false};
+    std::atomic<uint64_t> requests_{0};
+    std::atomic<uint64_t> snapshots_{0};
+};
+
+/**
+ * MulticastFeedReceiver — the consumer end: joins the group, receives
+ * packets and tracks the expected sequence so the caller can see gaps.
+ * A unicast `group` just binds the port.
+ */
+class MulticastFeedReceiver {
+public:
+    struct Packet {
+        MoldHeader               header;
+        std::vector<FeedMessage> messages;
+        SeqNum                   gap_first = 0;   // messages [gap_first, header.sequence) were missed
+        uint64_t                 gap_count = 0;
+        [[nodiscard]] bool end_of_session() const noexcept { return header.count == MOLD_END_OF_SESSION; }
+    };
+
+    MulticastFeedReceiver(const std::string& group, uint16_t port, const std::string& interface = "127.0.0.1") {
+        fd_ = ::socket(AF_INET, SOCK_DGRAM, 0);
+        if (fd_ < 0) throw std::runtime_error("socket() failed");
+        int yes = 1;
+        ::setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+#ifdef SO_REUSEPORT
+        ::setsockopt(fd_, SOL_SOCKET, SO_REUSEPORT, &yes, sizeof(yes));
+#endif
+        int rcvbuf = 8 << 20;
+        ::setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+        in_addr grp{};
+        if (::inet_pton(AF_INET, group.c_str(), &grp) != 1) {
+            ::close(fd_);
+            throw std::runtime_error("bad multicast group address");
+        }
+        const bool multicast = IN_MULTICAST(ntohl(grp.s_addr));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = multicast ? htonl(INADDR_ANY) : grp.s_addr;
+        addr.sin_port = htons(port);
+        if (::bind(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            ::close(fd_);
+            throw std::runtime_error("receiver bind() failed");
+        }
+        if (multicast) {
+            ip_mreq mreq{};
+            mreq.imr_multiaddr = grp;
+            ::inet_pton(AF_INET, interface.c_str(), &mreq.imr_interface);
+            joined_ = ::setsockopt(fd_, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) == 0;
+        } else {
+            joined_ = true;
+        }
+        sockaddr_in bound{};
+        socklen_t blen = sizeof(bound);
+        ::getsockname(fd_, reinterpret_cast<sockaddr*>(&bound), &blen);
+        port_ = ntohs(bound.sin_port);
+        buf_.resize(MOLD_MAX_PACKET);
+    }
+
+    ~MulticastFeedReceiver() { if (fd_ >= 0) ::close(fd_); }
+
+    MulticastFeedReceiver(const MulticastFeedReceiver&) = delete;
+    MulticastFeedReceiver& operator=(const MulticastFeedReceiver&) = delete;
+
+    /// False if the group could not be joined (no multicast route here).
+    [[nodiscard]] bool joined() const noexcept { return joined_; }
+    [[nodiscard]] uint16_t port() const noexcept { return port_; }
+    [[nodiscard]] SeqNum expected() const noexcept { return expected_; }
+    [[nodiscard]] uint64_t malformed() const noexcept { return malformed_; }
+
+    /// Move the expected sequence on (after the caller filled a gap).
+    void set_expected(SeqNum seq) noexcept { expected_ = std::max(expected_, seq); }
+
+    /**
+     * Wait up to `timeout_ms` for one packet. Messages already seen
+     * (below expected()) are dropped from it; a jump ahead is reported as a
+     * gap and expected() moves past the packet. Heartbeats report gaps too.
+     */
+    std::optional<Packet> receive(int timeout_ms) {
+        pollfd p{fd_, POLLIN, 0};
+        if (::poll(&p, 1, timeout_ms) <= 0) return std::nullopt;
+        const auto n = ::recv(fd_, buf_.data(), buf_.size(), 0);
+        if (n <= 0) return std::nullopt;
+
+        Packet pkt;
+        if (!decode_mold_packet(buf_.data(), static_cast<size_t>(n), pkt.header, pkt.messages)) {
+            ++malformed_;
+            return std::nullopt;
+        }
+        const SeqNum first = pkt.header.sequence;
+        if (first > expected_) {
+            pkt.gap_first = expected_;
+            pkt.gap_count = first - expected_;
+        }
+        std::erase_if(pkt.messages, [&](const FeedMessage& m) { return m.sequence < expected_; });
+        const uint64_t count = pkt.end_of_session() ? 0 : pkt.header.count;
+        expected_ = std::max(expected_, first + count);
+        return pkt;
+    }
+
+private:
+    int                    fd_ = -1;
+    bool                   joined_ = false;
+    uint16_t               port_ = 0;
+    SeqNum                 expected_ = 1;
+    uint64_t               malformed_ = 0;
+    std::vector<std::byte> buf_;
+};
+
+/**
+ * RetransmitClient — requests a sequence range from a FeedRetransmitServer
+ * and collects the messages it sends back, in order.
+ */
+class RetransmitClient {
+public:
+    explicit RetransmitClient(uint16_t port) {
+        fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(port);
+        int yes = 1;
+        ::setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+        timeval tv{}; tv.tv_sec = 5;
+        ::setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        connected_ = fd_ >= 0
+                  && ::connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+    }
+
+    ~RetransmitClient() { if (fd_ >= 0) ::close(fd_); }
+
+    RetransmitClient(const RetransmitClient&) = delete;
+    RetransmitClient& operator=(const RetransmitClient&) = delete;
+
+    [[nodiscard]] bool connected() const noexcept { return connected_; }
+
+    /// Request [sequence, sequence + count). Messages are appended to `out`;
+    /// nullopt if the connection failed mid-reply.
+    std::optional<WireRetransmitDone> request(SeqNum sequence, uint64_t count, std::vector<FeedMessage>& out) {
+        if (!connected_) return std::nullopt;
+        WireRetransmit req{};
+        req.sequence = sequence;
+        req.count    = static_cast<uint32_t>(std::min<uint64_t>(count, UINT32_MAX));
+        if (!send_msg(fd_, static_cast<MsgType>(FeedMsgType::Retransmit), &req, sizeof(req))) return std::nullopt;
+
+        std::vector<std::byte> buf;
+        WireHeader h{};
+        while (recv_header(fd_, h)) {
+            const auto type = static_cast<FeedMsgType>(h.type);
+            if (type == FeedMsgType::RetransmitDone) {
+                WireRetransmitDone done{};
+                if (h.len != sizeof(done) || !read_full(fd_, &done, sizeof(done))) break;
+                return done;
+            }
+            buf.resize(h.len);
+            if (!read_full(fd_, buf.data(), h.len)) break;
+            MoldHeader mh;
+            if (type == FeedMsgType::FeedPackets && !decode_mold_packet(buf.data(), h.len, mh, out)) break;
+        }
+        connected_ = false;
+        return std::nullopt;
+    }
+
+private:
+    int  fd_ = -1;
+    bool connected_ = false;
+};
+
+} // namespace micro_exchange::net
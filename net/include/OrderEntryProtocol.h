@@ -10,12 +10,17 @@
 //     └───────────────────────────────────────────────────────────┘
 //     ┌─────────────────────── payload (`len` bytes) ────────────┐
 //
-// Inbound (client → gateway):  NewOrder, Cancel
-// Outbound (gateway → client): Exec (one per fill), Ack (one per request)
+// Inbound (client → gateway):  Logon, NewOrder, Cancel
+// Outbound (gateway → client): LogonAck, Exec (one per fill), Ack (one per request)
 //
 // A NewOrder elicits zero or more Exec messages (in match order) followed by
 // exactly one Ack, so the client always knows when a request is complete.
 //
+// Symbol routing: a client may Logon with a symbol and receive the engine's
+// dense SymbolId in the LogonAck, then stamp it into every NewOrder/Cancel.
+// A zero symbol_id is still accepted and routed by the char[16] symbol on the
+// gateway's slow path, so clients that never log on keep working.
+//
 // Endianness: this demo assumes a homogeneous little-endian deployment (x86-64
 // / ARM64 on both ends) and copies POD structs on the wire. A production
 // protocol would byte-order-normalise the header length and numeric fields
@@ -26,6 +31,7 @@
 
 #include <cstdint>
 #include <cstring>
+#include <sys/uio.h>
 #include <unistd.h>
 
 namespace micro_exchange::net {
@@ -33,13 +39,16 @@ namespace micro_exchange::net {
 using core::Price;
 using core::Quantity;
 using core::OrderId;
+using core::SymbolId;
 
 enum class MsgType : uint8_t {
     NewOrder = 1,
     Cancel   = 2,
+    Logon    = 3,
     Ack      = 10,
     Exec     = 11,
     Reject   = 12,
+    LogonAck = 13,
 };
 
 enum class AckStatus : uint8_t {
@@ -67,12 +76,26 @@ struct WireNewOrder {
     uint8_t  side;      // 0 = buy, 1 = sell
     uint8_t  type;      // core::OrderType
     uint8_t  tif;       // core::TimeInForce
-    uint8_t  pad[5];
+    uint8_t  pad[1];
+    uint32_t symbol_id; // from LogonAck; 0 = route by `symbol`
     char     symbol[16];
 };
 
 struct WireCancel {
     uint64_t id;
+    uint32_t symbol_id; // from LogonAck; 0 = route by `symbol`
+    uint8_t  pad[4];
+    char     symbol[16];
+};
+
+struct WireLogon {
+    char     symbol[16];
+};
+
+struct WireLogonAck {
+    uint32_t symbol_id;     // 0 = unknown symbol (logon rejected)
+    uint8_t  status;        // AckStatus
+    uint8_t  pad[3];
     char     symbol[16];
 };
 
@@ -92,6 +115,9 @@ struct WireExec {
     uint8_t  pad[7];
 };
 
+static_assert(sizeof(WireNewOrder) == 48, "WireNewOrder layout changed");
+static_assert(sizeof(WireCancel) == 32,   "WireCancel layout changed");
+
 // ── Blocking, partial-aware socket I/O ──
 
 // Read exactly `n` bytes (loops over short recv()s). False on EOF/error.
@@ -118,14 +144,29 @@ inline bool write_full(int fd, const void* buf, size_t n) {
     return true;
 }
 
-// Send one framed message (header + payload).
+// Write every byte of `iov[0..n)` (loops over short writev()s; `iov` is
+// consumed). False on error.
+inline bool writev_full(int fd, iovec* iov, int n) {
+    while (n > 0) {
+        ssize_t w = ::writev(fd, iov, n);
+        if (w <= 0) return false;
+        auto done = static_cast<size_t>(w);
+        while (n > 0 && done >= iov->iov_len) { done -= iov->iov_len; ++iov; --n; }
+        if (n > 0) {
+            iov->iov_base = static_cast<char*>(iov->iov_base) + done;
+            iov->iov_len -= done;
+        }
+    }
+    return true;
+}
+
+// Send one framed message (header + payload) in a single writev().
 inline bool send_msg(int fd, MsgType type, const void* payload, uint32_t len) {
     WireHeader h{};
     h.type = static_cast<uint8_t>(type);
     h.len  = len;
-    if (!write_full(fd, &h, sizeof(h))) return false;
-    if (len && !write_full(fd, payload, len)) return false;
-    return true;
+    iovec iov[2] = {{&h, sizeof(h)}, {const_cast<void*>(payload), len}};
+    return writev_full(fd, iov, len ? 2 : 1);
 }
 
 // Receive one framed message header; caller then reads `out_hdr.len` bytes.
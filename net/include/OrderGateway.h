@@ -1,7 +1,7 @@
 #pragma once
 
 // ─────────────────────────────────────────────────────────────────────────
-// OrderGateway — a single-threaded TCP order-entry gateway.
+// OrderGateway — the TCP order-entry gateway.
 //
 // This is the network front-end a real exchange puts in front of its matching
 // engine: clients open a socket, stream binary order messages in, and receive
@@ -10,57 +10,157 @@
 // matching core, which keeps the hot path lock-free and the event order
 // deterministic.
 //
+// Two ways to serve:
+//   • serve_one_client() — blocking: accept one client, process its stream
+//     until it disconnects. The original single-session model.
+//   • run() / poll_once() — event-driven: any number of concurrent sessions,
+//     each with its own receive buffer and bounded output buffer
+//     (GatewaySession.h). stop() ends run() from another thread. The I/O
+//     backend is picked at construction (GatewayOptions::backend):
+//       Epoll   — non-blocking sockets on a Poller (epoll on Linux, poll
+//                 elsewhere); readiness, then recv()/send() per session.
+//       IoUring — completions from an IoUring (IoUring.h): multishot accept
+//                 and recv into registered provided buffers, sends prepared
+//                 for every session with output and submitted together in
+//                 the same io_uring_enter() that waits for the next
+//                 completions; optionally SQPOLL. Linux only.
+//     Both run the same session, ownership and protocol handling.
+//   • Pipelined (GatewayOptions::pipelined) — either backend, but the event
+//     loop only reads and decodes: requests go over an SPSC ring to a
+//     core-pinned matching thread, and Acks / Execs over another to an
+//     egress thread that owns all socket writes (GatewayPipeline.h). A slow
+//     send() then delays that client's replies, not matching.
+//   • Latency probes (GatewayOptions::probes, LatencyProbe.h) time 1 NewOrder
+//     in N from the read that brought it in to the send() of its Ack, with
+//     book entry and first fill stamped by the book, into per-span
+//     histograms; latency() reads them, and an export path gets a report
+//     every export_ms. Under io_uring "written" means handed to the ring.
+//
 // Design notes:
 //   • Binds to 127.0.0.1 only (a demo gateway should never be world-reachable).
 //   • Port 0 lets the OS pick a free port — handy for tests; read it via port().
-//   • Trade prints are pushed to the connected client synchronously from the
-//     matching callback, so Exec messages for a NewOrder arrive before its Ack.
+//   • Every order is owned by the session that entered it. An Exec goes to the
+//     owners of the trade's two sides, queued from the matching callback, so
+//     a session's Execs for its NewOrder still arrive before that order's Ack.
+//     A live order id already owned by any session is rejected, and a session
+//     may only cancel its own orders.
+//   • Output is only ever written without blocking the event loop; a session
+//     whose queued output passes `max_output_bytes` is cut off as a slow
+//     consumer (its resting orders stay in the book).
 //   • SIGPIPE is ignored so a client disconnect mid-write can't kill the server.
 //
-// Scope: one client at a time, processed sequentially (the common single-
-// gateway model). Multiplexing many clients (epoll/kqueue) is a natural
-// extension and is noted as future work.
+// The gateway is a template over the book backend; `OrderGateway` is the
+// std::map default and `ArrayOrderGateway` fronts the tick-indexed book.
+// Trailing constructor arguments are forwarded to the book (its price band).
+// If the book's compile-time sink chains an ExecWriterSink, Execs are routed
+// straight from matching instead of through runtime listeners;
+// `StaticArrayOrderGateway` is that fully static configuration.
 // ─────────────────────────────────────────────────────────────────────────
 
 #include "MatchingEngine.h"
 #include "OrderEntryProtocol.h"
+#include "GatewaySession.h"
+#include "Poller.h"
+#include "IoUring.h"
+#include "GatewayPipeline.h"
+#include "LatencyRecorder.h"
 
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
 #include <arpa/inet.h>
 #include <unistd.h>
+#include <atomic>
 #include <csignal>
 #include <cstring>
 #include <cstdint>
+#include <memory>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace micro_exchange::net {
 
 using namespace micro_exchange::core;
 
-class OrderGateway {
+enum class GatewayBackend : uint8_t {
+    Epoll,     // readiness: epoll (poll off Linux)
+    IoUring,   // completions: io_uring
+};
+
+struct GatewayOptions {
+    uint16_t       port             = 0;         // 0 = ephemeral
+    size_t         max_output_bytes = 1 << 20;   // per-session output bound (slow-consumer cut-off)
+    int            send_buffer      = 0;         // SO_SNDBUF per session; 0 = OS default
+    int            backlog          = 128;
+    GatewayBackend backend          = GatewayBackend::Epoll;
+    bool           sqpoll           = false;     // IoUring: kernel SQ poll thread (falls back if refused)
+    bool           pipelined        = false;     // matching and egress on their own threads
+    bool           pin_threads      = true;      // pipelined: pin matching to first_core, egress to the next
+    unsigned       first_core       = 1;
+    ProbeOptions   probes           = {};        // latency probes; off unless probes.sample_every > 0
+};
+
+/**
+ * Static sink that routes each trade print as a WireExec to the sessions
+ * owning its two sides, and releases done orders' ids. Bound by the gateway
+ * to its session table (pipelined: the matching stage's ownership table).
+ */
+struct ExecWriterSink {
+    SessionTable* sessions = nullptr;
+
+    template <typename Book> void on_trade(const Book&, const Trade& t) {
+        if (sessions) sessions->on_trade(t);
+    }
+    template <typename Book> void on_order(const Book&, const Order& o) {
+        if (sessions) sessions->on_order(o);
+    }
+};
+
+template <OrderBookLike Book = OrderBook>
+class BasicOrderGateway {
 public:
-    OrderGateway(uint16_t port, const std::string& symbol)
-        : symbol_(symbol)
+    template <typename... BookArgs>
+    BasicOrderGateway(uint16_t port, const std::string& symbol, BookArgs&&... book_args)
+        : BasicOrderGateway(GatewayOptions{port}, symbol, std::forward<BookArgs>(book_args)...) {}
+
+    template <typename... BookArgs>
+    BasicOrderGateway(const GatewayOptions& opts, const std::string& symbol, BookArgs&&... book_args)
+        : symbol_(symbol), opts_(opts), sessions_(opts.max_output_bytes)
     {
         std::signal(SIGPIPE, SIG_IGN);   // a dead client must not kill us
 
-        engine_.add_symbol(symbol_);
-
-        // Stream every trade print to the currently-connected client.
-        engine_.set_trade_callback([this](const Trade& t) {
-            if (client_fd_ < 0) return;
-            WireExec e{};
-            e.buy_order_id  = t.buy_order_id;
-            e.sell_order_id = t.sell_order_id;
-            e.price         = t.price;
-            e.quantity      = t.quantity;
-            e.aggressor     = static_cast<uint8_t>(t.aggressor);
-            send_msg(client_fd_, MsgType::Exec, &e, sizeof(e));
-            ++execs_sent_;
-        });
+        if (opts_.backend == GatewayBackend::IoUring) {
+#if MICRO_EXCHANGE_HAS_IO_URING
+            uring_ = std::make_unique<IoUring>(URING_ENTRIES, URING_BUFFERS, URING_BUFFER_SIZE, opts_.sqpoll);
+#else
+            throw std::runtime_error("io_uring backend is not available on this platform");
+#endif
+        }
+
+#if MICRO_EXCHANGE_PROBES
+        if (opts_.probes.sample_every) {
+            probes_ = std::make_unique<LatencyRecorder>(opts_.probes);
+            if (!opts_.probes.export_path.empty())
+                exporter_ = std::make_unique<LatencyExporter>(*probes_, opts_.probes.export_path,
+                                                              opts_.probes.export_ms);
+        }
+#endif
+        if (opts_.pipelined)
+            pipeline_ = std::make_unique<GatewayPipeline>(opts_.max_output_bytes, opts_.pin_threads,
+                                                          opts_.first_core, probes_.get());
+
+        Book& book = engine_.add_symbol(symbol_, std::forward<BookArgs>(book_args)...);
+
+        // Route every trade print to the sessions that own its orders.
+        ExecWriterSink writer{&owners()};
+        if constexpr (has_sink_v<ExecWriterSink, Book>) {
+            sink_get<ExecWriterSink>(book) = writer;
+        } else {
+            book.add_trade_listener([writer, &book](const Trade& t) mutable { writer.on_trade(book, t); });
+            book.add_order_listener([writer, &book](const Order& o) mutable { writer.on_order(book, o); });
+        }
 
         listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
         if (listen_fd_ < 0) throw std::runtime_error("socket() failed");
@@ -71,12 +171,12 @@ public:
         sockaddr_in addr{};
         addr.sin_family = AF_INET;
         addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
-        addr.sin_port = htons(port);
+        addr.sin_port = htons(opts_.port);
         if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
             ::close(listen_fd_);
             throw std::runtime_error("bind() failed");
         }
-        if (::listen(listen_fd_, 16) < 0) {
+        if (::listen(listen_fd_, opts_.backlog) < 0) {
             ::close(listen_fd_);
             throw std::runtime_error("listen() failed");
         }
@@ -88,103 +188,558 @@ public:
         port_ = ntohs(bound.sin_port);
     }
 
-    ~OrderGateway() {
+    ~BasicOrderGateway() {
+        if (pipeline_) pipeline_->stop();   // the matching thread runs on engine_
         if (listen_fd_ >= 0) ::close(listen_fd_);
     }
 
-    OrderGateway(const OrderGateway&) = delete;
-    OrderGateway& operator=(const OrderGateway&) = delete;
+    BasicOrderGateway(const BasicOrderGateway&) = delete;
+    BasicOrderGateway& operator=(const BasicOrderGateway&) = delete;
 
     [[nodiscard]] uint16_t port() const { return port_; }
 
     // Accept ONE client and process its order stream until it disconnects.
-    // Returns the number of inbound requests handled.
+    // Returns the number of inbound requests handled. Inline gateways only.
     uint64_t serve_one_client() {
+        if (pipeline_) throw std::logic_error("serve_one_client() needs an inline gateway");
         int fd = ::accept(listen_fd_, nullptr, nullptr);
         if (fd < 0) return 0;
+        configure(fd);
+
+        Session& s = sessions_.open(fd);
+        uint64_t handled = 0;
+
+        // Decode every frame one recv() brought in, then answer them with
+        // one write.
+        while (s.read_blocking()) {
+            if (probes_) s.recv_ns = probe_now();
+            const bool framed = s.for_each_frame([&](MsgType type, const char* p, uint32_t len) {
+                handled += handle_frame(s, type, p, len);
+            });
+            sessions_.drain_dirty([](Session& d) { d.flush_blocking(); });
+            if (probes_) probes_->acks_written();
+            if (!framed) { sessions_.count_protocol_error(); break; }
+        }
+
+        sessions_.close(s.id());
+        return handled;
+    }
+
+    // ── Event-driven serving ──
 
-        // Disable Nagle: order entry wants each message out immediately.
+    // Run the event loop until stop(). A pipelined gateway's stages are
+    // drained and joined before it returns.
+    void run() {
+        while (!stop_.load(std::memory_order_acquire)) poll_once(50);
+        if (pipeline_) pipeline_->stop();
+    }
+
+    void stop() noexcept { stop_.store(true, std::memory_order_release); }
+
+    // Wait up to `timeout_ms` for socket events and handle them: accept new
+    // sessions, decode and process every complete inbound frame, then flush
+    // each session that got output once for the whole batch of events.
+    // Returns the number of inbound requests handled (pipelined: decoded and
+    // passed on to the matching stage).
+    uint64_t poll_once(int timeout_ms) {
+        if (pipeline_ && !pipeline_->running())
+            pipeline_->start([this](const PipelineCommand& c) { execute(c); });
+#if MICRO_EXCHANGE_HAS_IO_URING
+        if (uring_) return poll_uring(timeout_ms);
+#endif
+        if (!listening_) {
+            set_nonblocking(listen_fd_);
+            poller_.add(listen_fd_, LISTENER);
+            listening_ = true;
+        }
+        uint64_t handled = 0;
+        poller_.wait(events_, timeout_ms);
+        const uint64_t started = pipeline_ ? timestamp_ns(now()) : 0;
+        for (const auto& ev : events_) {
+            if (ev.token == LISTENER) { accept_all(); continue; }
+            Session* s = sessions_.get(static_cast<SessionId>(ev.token));
+            if (!s) continue;
+            if (ev.writable) sessions_.mark_dirty(*s);
+            if (ev.readable || ev.hangup) handled += service(*s);
+        }
+        flush_dirty();
+        if (probes_ && !pipeline_) probes_->acks_written();
+        if (pipeline_) pipeline_->end_io_batch(started);
+        return handled;
+    }
+
+    // Pipelined: read engine stats once run() has returned.
+    [[nodiscard]] EngineStats stats() const { return engine_.get_stats(); }
+    [[nodiscard]] uint64_t execs_sent() const { return session_counters().execs; }
+    [[nodiscard]] size_t sessions_active() const { return sessions_.active(); }
+
+    // Pipelined, the output-side counters come from the egress stage.
+    [[nodiscard]] SessionTable::Counters session_counters() const {
+        SessionTable::Counters c = sessions_.counters();
+        if (pipeline_) {
+            const auto e     = pipeline_->egress_counters();
+            c.slow_consumers = e.slow_consumers;
+            c.execs          = e.execs;
+            c.unrouted       = e.unrouted;
+            c.frames_out     = e.frames_out;
+            c.send_calls     = e.send_calls;
+        }
+        return c;
+    }
+
+    // Queue depth and latency per stage; all zero unless pipelined.
+    [[nodiscard]] PipelineStats pipeline_stats() const {
+        return pipeline_ ? pipeline_->stats() : PipelineStats{};
+    }
+
+    // Probe histograms so far; empty unless probes are on.
+    [[nodiscard]] LatencySnapshot latency() const {
+        return probes_ ? probes_->snapshot() : LatencySnapshot{};
+    }
+
+    // Write the probe report and traces now (no-op without an export path).
+    void export_latency() {
+        if (exporter_) exporter_->write_now();
+    }
+
+    // Kernel crossings of the event loop so far: recv/send of closed
+    // sessions plus epoll_wait/epoll_ctl, or io_uring_enter. Pipelined,
+    // the egress thread's sends are included.
+    [[nodiscard]] uint64_t io_syscalls() const {
+        const auto c = session_counters();
+        uint64_t n = c.recv_calls + c.send_calls + poller_.syscalls();
+#if MICRO_EXCHANGE_HAS_IO_URING
+        if (uring_) n += uring_->syscalls();
+#endif
+        return n;
+    }
+
+    // False if SQPOLL was asked for but the kernel refused it.
+    [[nodiscard]] bool sqpoll_active() const {
+#if MICRO_EXCHANGE_HAS_IO_URING
+        return uring_ && uring_->sqpoll();
+#else
+        return false;
+#endif
+    }
+
+private:
+    static constexpr uint64_t LISTENER = UINT64_MAX;
+
+    // Disable Nagle: order entry wants each message out immediately.
+    void configure(int fd) {
         int yes = 1;
         ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+        if (opts_.send_buffer > 0)
+            ::setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &opts_.send_buffer, sizeof(opts_.send_buffer));
+    }
+
+    void accept_all() {
+        for (;;) {
+            int fd = ::accept(listen_fd_, nullptr, nullptr);
+            if (fd < 0) return;   // EAGAIN: backlog drained
+            configure(fd);
+            if (!set_nonblocking(fd)) { ::close(fd); continue; }
+            Session& s = open_session(fd);
+            if (!poller_.add(fd, s.id())) close_session(s.id());
+        }
+    }
+
+    // Read, process every complete frame, and close on EOF / framing error.
+    uint64_t service(Session& s) {
+        const bool open = s.read_available();
+        if (probes_) s.recv_ns = probe_now();
+        uint64_t handled = 0;
+        const bool framed = s.for_each_frame([&](MsgType type, const char* p, uint32_t len) {
+            handled += handle_frame(s, type, p, len);
+        });
+        if (!framed) sessions_.count_protocol_error();
+        if (!open || !framed) close_session(s.id());
+        return handled;
+    }
+
+    // Flush every session queued to during the events (including the
+    // counterparties of their trades); cut off overflowed ones.
+    void flush_dirty() {
+        auto visit = [this](Session& s) {
+            if (s.overflowed() || !s.flush()) { close_session(s.id()); return; }
+            if (s.pending_output() != s.want_write) {
+                s.want_write = s.pending_output();
+                poller_.modify(s.fd(), s.id(), s.want_write);
+            }
+        };
+        sessions_.drain_dirty(visit);
+    }
+
+    Session& open_session(int fd) {
+        Session& s = sessions_.open(fd);
+        if (pipeline_) pipeline_->open(s.id(), fd);
+        return s;
+    }
+
+    void close_session(SessionId id) {
+        if (Session* s = sessions_.get(id)) poller_.remove(s->fd());
+        retire(id);
+    }
 
-        client_fd_ = fd;
+    // Forget a session; pipelined, egress closes its end after the replies
+    // already on their way.
+    void retire(SessionId id) {
+        if (pipeline_ && sessions_.get(id)) pipeline_->close(id);
+        sessions_.close(id);
+    }
+
+#if MICRO_EXCHANGE_HAS_IO_URING
+    // ── io_uring backend ──
+    //
+    // user_data carries the operation in the high word and the SessionId in
+    // the low one. A session stays in the table until its recv and send have
+    // both completed, since the kernel still holds its send buffer; shut()
+    // stops anything new being queued meanwhile.
+
+    static constexpr unsigned URING_ENTRIES     = 1024;
+    static constexpr unsigned URING_BUFFERS     = 1024;
+    static constexpr unsigned URING_BUFFER_SIZE = 4096;
+
+    enum UringOp : uint64_t { OP_ACCEPT = 1, OP_RECV = 2, OP_SEND = 3, OP_CANCEL = 4 };
+
+    struct UringSlot {
+        std::vector<char> sending;      // detached output the kernel is sending
+        size_t            sent       = 0;
+        bool              recv_armed = false;
+        bool              send_busy  = false;
+    };
+
+    static uint64_t tag(UringOp op, SessionId id) { return (uint64_t(op) << 32) | id; }
+
+    // Prepare an SQE, submitting what is queued if the ring is full.
+    template <typename F>
+    void prep(F&& f) {
+        while (!f()) uring_->submit_and_wait(0);
+    }
+
+    uint64_t poll_uring(int timeout_ms) {
+        if (!listening_) {
+            prep([&] { return uring_->accept_multishot(listen_fd_, tag(OP_ACCEPT, 0)); });
+            listening_ = true;
+        }
+        uring_->submit_and_wait(timeout_ms);
+        const uint64_t started = pipeline_ ? timestamp_ns(now()) : 0;
+        uint64_t handled = 0;
+        uring_->drain([&](const IoUring::Completion& c) { handled += on_completion(c); });
+        flush_uring();
+        if (probes_ && !pipeline_) probes_->acks_written();
+        if (pipeline_) pipeline_->end_io_batch(started);
+        return handled;
+    }
+
+    uint64_t on_completion(const IoUring::Completion& c) {
+        const auto op = static_cast<UringOp>(c.user_data >> 32);
+        const auto id = static_cast<SessionId>(c.user_data);
         uint64_t handled = 0;
 
-        WireHeader h{};
-        while (recv_header(fd, h)) {
-            switch (static_cast<MsgType>(h.type)) {
-                case MsgType::NewOrder: handled += handle_new_order(fd, h); break;
-                case MsgType::Cancel:   handled += handle_cancel(fd, h);    break;
-                default:                drain(fd, h.len);                   break;
+        if (op == OP_ACCEPT) {
+            if (c.res >= 0) {
+                configure(c.res);
+                Session& s = open_session(c.res);
+                if (uring_slots_.size() <= s.id()) uring_slots_.resize(s.id() + 1);
+                arm_recv(s);
+            }
+            if (!c.more() && !stop_.load(std::memory_order_relaxed))
+                prep([&] { return uring_->accept_multishot(listen_fd_, tag(OP_ACCEPT, 0)); });
+            return 0;
+        }
+        if (op == OP_CANCEL) return 0;   // the cancelled recv reports itself
+
+        Session* s = sessions_.get(id);
+        if (!s) {   // cannot happen: a session outlives its operations
+            if (c.has_buffer()) uring_->recycle(c.buffer_id());
+            return 0;
+        }
+        UringSlot& slot = uring_slots_[id];
+
+        if (op == OP_RECV) {
+            slot.recv_armed = c.more();
+            if (c.has_buffer()) {
+                if (c.res > 0 && !s->is_shut()) {
+                    if (probes_) s->recv_ns = probe_now();
+                    s->append_input(uring_->buffer(c.buffer_id()), static_cast<size_t>(c.res));
+                    const bool framed = s->for_each_frame([&](MsgType type, const char* p, uint32_t len) {
+                        handled += handle_frame(*s, type, p, len);
+                    });
+                    if (!framed) { sessions_.count_protocol_error(); begin_shut_uring(*s); }
+                }
+                uring_->recycle(c.buffer_id());
+            }
+            if (c.res == -ENOBUFS || (c.res > 0 && !c.more())) {
+                if (!s->is_shut()) arm_recv(*s);   // ran out of buffers / ended: re-arm
+            } else if (c.res <= 0) {
+                begin_shut_uring(*s);   // EOF or error
+            }
+        } else if (op == OP_SEND) {
+            slot.send_busy = false;
+            const size_t left = slot.sending.size() - slot.sent;
+            if (c.res < 0) {
+                s->sent_in_flight(left);
+                begin_shut_uring(*s);
+            } else {
+                s->sent_in_flight(static_cast<size_t>(c.res));
+                slot.sent += static_cast<size_t>(c.res);
+                if (slot.sent < slot.sending.size() && !s->is_shut()) {
+                    send_uring(*s, slot);   // short send: the rest
+                } else {
+                    sessions_.mark_dirty(*s);   // anything queued meanwhile
+                }
             }
         }
 
-        client_fd_ = -1;
-        ::close(fd);
+        if (s->is_shut() && !slot.recv_armed && !slot.send_busy) retire(id);
         return handled;
     }
 
-    [[nodiscard]] MatchingEngine::EngineStats stats() const { return engine_.get_stats(); }
-    [[nodiscard]] uint64_t execs_sent() const { return execs_sent_; }
+    void arm_recv(Session& s) {
+        prep([&] { return uring_->recv_multishot(s.fd(), tag(OP_RECV, s.id())); });
+        uring_slots_[s.id()].recv_armed = true;
+    }
 
-private:
-    uint64_t handle_new_order(int fd, const WireHeader& h) {
-        WireNewOrder w{};
-        if (h.len != sizeof(w) || !read_full(fd, &w, sizeof(w))) { drain(fd, h.len); return 0; }
-
-        NewOrderRequest req{};
-        req.id       = w.id;
-        req.side     = static_cast<Side>(w.side);
-        req.type     = static_cast<OrderType>(w.type);
-        req.tif      = static_cast<TimeInForce>(w.tif);
-        req.price    = w.price;
-        req.quantity = w.quantity;
-        std::memcpy(req.symbol, w.symbol, sizeof(req.symbol));
-
-        // Exec messages for this order are emitted synchronously by the trade
-        // callback during submit_order(); the Ack follows them.
-        Order* o = engine_.submit_order(req);
+    void send_uring(Session& s, UringSlot& slot) {
+        prep([&] {
+            return uring_->send(s.fd(), slot.sending.data() + slot.sent, slot.sending.size() - slot.sent,
+                                tag(OP_SEND, s.id()));
+        });
+        slot.send_busy = true;
+    }
 
-        WireAck ack{};
-        ack.id         = w.id;
-        ack.status     = static_cast<uint8_t>(o ? AckStatus::Accepted : AckStatus::Rejected);
-        ack.filled_qty = o ? o->filled_qty : 0;
-        send_msg(fd, MsgType::Ack, &ack, sizeof(ack));
-        return 1;
+    // Cancel the multishot recv (a shut-down socket keeps delivering what
+    // the peer still sends) and shut the socket down to fail a pending
+    // send; the session is dropped once both have come back.
+    void shut_uring(Session& s) {
+        if (s.is_shut()) return;
+        begin_shut_uring(s);
+        const UringSlot& slot = uring_slots_[s.id()];
+        if (!slot.recv_armed && !slot.send_busy) retire(s.id());
     }
 
-    uint64_t handle_cancel(int fd, const WireHeader& h) {
-        WireCancel w{};
-        if (h.len != sizeof(w) || !read_full(fd, &w, sizeof(w))) { drain(fd, h.len); return 0; }
+    // The shutdown without the retire: on_completion still holds the
+    // Session and retires it itself once the operation is accounted for.
+    void begin_shut_uring(Session& s) {
+        if (s.is_shut()) return;
+        s.shut();
+        if (uring_slots_[s.id()].recv_armed)
+            prep([&] { return uring_->cancel(tag(OP_RECV, s.id()), tag(OP_CANCEL, s.id())); });
+        ::shutdown(s.fd(), SHUT_RDWR);
+    }
 
-        CancelRequest req{};
-        req.order_id = w.id;
-        std::memcpy(req.symbol, w.symbol, sizeof(req.symbol));
-        bool ok = engine_.cancel_order(req);
+    // One send per session with output, all submitted by the next
+    // io_uring_enter(); overflowed sessions are cut off.
+    void flush_uring() {
+        sessions_.drain_dirty([this](Session& s) {
+            if (s.is_shut()) return;
+            if (s.overflowed()) { shut_uring(s); return; }
+            UringSlot& slot = uring_slots_[s.id()];
+            if (slot.send_busy || !s.pending_output()) return;
+            s.detach_output(slot.sending);
+            slot.sent = 0;
+            send_uring(s, slot);
+        });
+    }
+#endif
 
-        WireAck ack{};
-        ack.id     = w.id;
-        ack.status = static_cast<uint8_t>(ok ? AckStatus::Cancelled : AckStatus::Unknown);
-        send_msg(fd, MsgType::Ack, &ack, sizeof(ack));
+    // Decode one frame into a request. Pipelined, it goes to the matching
+    // stage; inline, it is executed here. Unrecognised types and bad lengths
+    // are skipped with framing intact.
+    uint64_t handle_frame(Session& s, MsgType type, const char* payload, uint32_t len) {
+        if (pipeline_) {
+            return pipeline_->push([&](PipelineCommand& c) { return decode_frame(s, type, payload, len, c); });
+        }
+        PipelineCommand c;
+        if (!decode_frame(s, type, payload, len, c)) return 0;
+        execute(c);
         return 1;
     }
 
-    // Discard an unrecognised / malformed payload so framing stays in sync.
-    void drain(int fd, uint32_t len) {
-        char buf[256];
-        while (len > 0) {
-            size_t chunk = len < sizeof(buf) ? len : sizeof(buf);
-            if (!read_full(fd, buf, chunk)) return;
-            len -= static_cast<uint32_t>(chunk);
+    // Decode, and start a trace for a NewOrder that is due to be timed.
+    //
+    // The session's SymbolId is resolved here, on the I/O side, at Logon
+    // (the symbol table is fixed once the gateway is constructed, so the
+    // lookup is safe off the matching thread), and the wire id is checked
+    // against it; see trusted_symbol_id().
+    bool decode_frame(Session& s, MsgType type, const char* payload, uint32_t len, PipelineCommand& c) {
+        c.session = s.id();
+        c.trace.trace_id = 0;
+        if (!decode(type, payload, len, c)) return false;
+        switch (c.kind) {
+            case PipelineCommand::Kind::NewOrder:
+                c.new_order.symbol_id = trusted_symbol_id(s, c.new_order.symbol_id, c.new_order.symbol);
+                if (probes_) probes_->start(c.trace, c.new_order.id, s.recv_ns);
+                break;
+            case PipelineCommand::Kind::Cancel:
+                c.cancel.symbol_id = trusted_symbol_id(s, c.cancel.symbol_id, c.cancel.symbol);
+                break;
+            case PipelineCommand::Kind::Logon:
+                s.symbol_id = engine_.symbol_id(
+                    std::string_view(c.logon.symbol, ::strnlen(c.logon.symbol, sizeof(c.logon.symbol))));
+                break;
+            default:
+                break;
         }
+        return true;
     }
 
-    std::string     symbol_;
-    MatchingEngine  engine_;
-    int             listen_fd_ = -1;
-    int             client_fd_ = -1;
-    uint16_t        port_      = 0;
-    uint64_t        execs_sent_ = 0;
+    // The engine routes a non-zero SymbolId without looking at the symbol,
+    // so a client-supplied id is only kept if it is the one the session
+    // logged on with and the symbol is blank or names the same book.
+    // Anything else drops to SYMBOL_ID_NONE and the symbol decides (an
+    // unknown or blank one is rejected by the engine).
+    SymbolId trusted_symbol_id(const Session& s, SymbolId wire, const char (&symbol)[16]) const {
+        if (wire == SYMBOL_ID_NONE || wire != s.symbol_id) return SYMBOL_ID_NONE;
+        const size_t n = ::strnlen(symbol, sizeof(symbol));
+        return (n == 0 || std::string_view(symbol, n) == symbol_) ? wire : SYMBOL_ID_NONE;
+    }
+
+    static bool decode(MsgType type, const char* payload, uint32_t len, PipelineCommand& c) {
+        switch (type) {
+            case MsgType::NewOrder: {
+                WireNewOrder w{};
+                if (len != sizeof(w)) return false;
+                std::memcpy(&w, payload, sizeof(w));
+                c.kind = PipelineCommand::Kind::NewOrder;
+                NewOrderRequest& req = c.new_order;
+                req          = NewOrderRequest{};
+                req.id       = w.id;
+                req.side     = static_cast<Side>(w.side);
+                req.type     = static_cast<OrderType>(w.type);
+                req.tif      = static_cast<TimeInForce>(w.tif);
+                req.price    = w.price;
+                req.quantity = w.quantity;
+                req.symbol_id = w.symbol_id;
+                std::memcpy(req.symbol, w.symbol, sizeof(req.symbol));
+                return true;
+            }
+            case MsgType::Cancel: {
+                WireCancel w{};
+                if (len != sizeof(w)) return false;
+                std::memcpy(&w, payload, sizeof(w));
+                c.kind = PipelineCommand::Kind::Cancel;
+                c.cancel.order_id  = w.id;
+                c.cancel.symbol_id = w.symbol_id;
+                std::memcpy(c.cancel.symbol, w.symbol, sizeof(c.cancel.symbol));
+                return true;
+            }
+            case MsgType::Logon:
+                if (len != sizeof(WireLogon)) return false;
+                c.kind = PipelineCommand::Kind::Logon;
+                std::memcpy(&c.logon, payload, sizeof(WireLogon));
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // Matching side of a request (the matching thread, when pipelined).
+    void execute(const PipelineCommand& c) {
+        switch (c.kind) {
+            case PipelineCommand::Kind::NewOrder: execute_new_order(c.session, c.new_order, c.trace); break;
+            case PipelineCommand::Kind::Cancel:   execute_cancel(c.session, c.cancel);       break;
+            case PipelineCommand::Kind::Logon:    execute_logon(c.session, c.logon);         break;
+            default: break;
+        }
+    }
+
+    // Whoever tracks order ownership: the session table, or the matching
+    // stage's own table.
+    SessionTable& owners() { return pipeline_ ? pipeline_->owners() : sessions_; }
+
+    // `trace`: a timed order's Ack, recorded once the send() carrying it returns.
+    void reply(SessionId id, MsgType type, const void* payload, uint32_t len,
+               const OrderTrace* trace = nullptr) {
+        if (pipeline_) { pipeline_->reply(id, type, payload, len, trace); return; }
+        if (Session* s = sessions_.get(id)) sessions_.queue(*s, type, payload, len);
+        if (trace) probes_->ack_queued(*trace);
+    }
+
+    // Tell the client the SymbolId its session resolved to (decode_frame
+    // has already recorded it on the session), so every subsequent order
+    // can route without a string lookup.
+    void execute_logon(SessionId id, const WireLogon& w) {
+        WireLogonAck ack{};
+        ack.symbol_id = engine_.symbol_id(std::string_view(w.symbol, ::strnlen(w.symbol, sizeof(w.symbol))));
+        ack.status    = static_cast<uint8_t>(ack.symbol_id != SYMBOL_ID_NONE ? AckStatus::Accepted
+                                                                             : AckStatus::Rejected);
+        std::memcpy(ack.symbol, w.symbol, sizeof(ack.symbol));
+        reply(id, MsgType::LogonAck, &ack, sizeof(ack));
+    }
+
+    void execute_new_order(SessionId id, const NewOrderRequest& req, const OrderTrace& traced) {
+        WireAck ack{};
+        ack.id = req.id;
+
+        // A timed order's trace is the thread's active one while it matches,
+        // so the book can stamp its entry and first fill.
+        OrderTrace trace;
+        const OrderTrace* timed = nullptr;
+        if (traced.trace_id) {
+            trace = traced;
+            timed = &trace;
+        }
+
+        // The session owns the order from here; a live id is not reusable.
+        if (!owners().claim(req.id, id)) {
+            ack.status = static_cast<uint8_t>(AckStatus::Rejected);
+            reply(id, MsgType::Ack, &ack, sizeof(ack), timed);
+            return;
+        }
+
+        // Exec messages for this order are queued by the trade callback
+        // during submit_order(); the Ack follows them.
+        Order* o;
+        {
+            probe::Scope scope(timed ? &trace : nullptr);
+            o = engine_.submit_order(req);
+        }
+        // The book may refuse the order outright (an ArrayOrderBook limit
+        // price beyond its band cap): that is a reject too.
+        const bool accepted = o && o->status != OrderStatus::Rejected;
+        if (!accepted) owners().release(req.id);
+
+        ack.status     = static_cast<uint8_t>(accepted ? AckStatus::Accepted : AckStatus::Rejected);
+        ack.filled_qty = o ? o->filled_qty : 0;
+        reply(id, MsgType::Ack, &ack, sizeof(ack), timed);
+    }
+
+    void execute_cancel(SessionId id, const CancelRequest& req) {
+        const bool ok = owners().owner(req.order_id) == id && engine_.cancel_order(req);
+
+        WireAck ack{};
+        ack.id     = req.order_id;
+        ack.status = static_cast<uint8_t>(ok ? AckStatus::Cancelled : AckStatus::Unknown);
+        reply(id, MsgType::Ack, &ack, sizeof(ack));
+    }
+
+    std::string               symbol_;
+    GatewayOptions            opts_;
+    BasicMatchingEngine<Book> engine_;
+    SessionTable              sessions_;
+    Poller                    poller_;
+    std::vector<Poller::Event> events_;
+    std::atomic<bool>         stop_{false};
+    bool                      listening_  = false;
+    int                       listen_fd_  = -1;
+    uint16_t                  port_       = 0;
+    std::unique_ptr<LatencyRecorder> probes_;
+    std::unique_ptr<LatencyExporter> exporter_;   // after probes_: stopped before it goes
+    std::unique_ptr<GatewayPipeline> pipeline_;
+#if MICRO_EXCHANGE_HAS_IO_URING
+    std::vector<UringSlot>    uring_slots_;
+    std::unique_ptr<IoUring>  uring_;   // declared last: torn down before the buffers it sends from
+#endif
 };
 
+using OrderGateway      = BasicOrderGateway<OrderBook>;
+using ArrayOrderGateway = BasicOrderGateway<ArrayOrderBook>;
+
+// Array book with engine stats and Exec routing dispatched at compile time.
+using StaticArrayOrderGateway =
+    BasicOrderGateway<BasicArrayOrderBook<SinkChain<EngineStatsSink, ExecWriterSink>>>;
+
 } // namespace micro_exchange::net
@@ -0,0 +1,164 @@
+#pragma once
+
+// ─────────────────────────────────────────────────────────────────────────
+// Poller — readiness notification for the event-driven gateway.
+//
+// epoll on Linux; poll(2) elsewhere (macOS CI), behind the same four calls.
+// Each registered fd carries a caller-chosen 64-bit token that comes back
+// with its events, so the gateway maps an event to its session without a
+// lookup. Level-triggered in both implementations: a session that leaves
+// bytes unread or unsent is reported again on the next wait.
+//
+// Single-threaded: the gateway's event loop owns it.
+// ─────────────────────────────────────────────────────────────────────────
+
+#include <cstdint>
+#include <fcntl.h>
+#include <unistd.h>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#else
+#include <poll.h>
+#include <unordered_map>
+#endif
+
+namespace micro_exchange::net {
+
+// Put `fd` in non-blocking mode. False if fcntl fails.
+inline bool set_nonblocking(int fd) {
+    const int flags = ::fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+class Poller {
+public:
+    struct Event {
+        uint64_t token;
+        bool     readable;
+        bool     writable;
+        bool     hangup;     // peer closed or socket error
+    };
+
+#ifdef __linux__
+    Poller() : epfd_(::epoll_create1(EPOLL_CLOEXEC)) {}
+    ~Poller() { if (epfd_ >= 0) ::close(epfd_); }
+#else
+    Poller() = default;
+#endif
+
+    Poller(const Poller&) = delete;
+    Poller& operator=(const Poller&) = delete;
+
+    [[nodiscard]] bool ok() const noexcept {
+#ifdef __linux__
+        return epfd_ >= 0;
+#else
+        return true;
+#endif
+    }
+
+    // Watch `fd` for reads, and for writes too if `want_write`.
+    bool add(int fd, uint64_t token, bool want_write = false) {
+#ifdef __linux__
+        ++syscalls_;
+        epoll_event ev = make(token, want_write);
+        return ::epoll_ctl(epfd_, EPOLL_CTL_ADD, fd, &ev) == 0;
+#else
+        slot_[fd] = fds_.size();
+        fds_.push_back({fd, mask(want_write), 0});
+        tokens_.push_back(token);
+        return true;
+#endif
+    }
+
+    // Change write interest (read interest is always on).
+    bool modify(int fd, uint64_t token, bool want_write) {
+#ifdef __linux__
+        ++syscalls_;
+        epoll_event ev = make(token, want_write);
+        return ::epoll_ctl(epfd_, EPOLL_CTL_MOD, fd, &ev) == 0;
+#else
+        auto it = slot_.find(fd);
+        if (it == slot_.end()) return false;
+        fds_[it->second].events = mask(want_write);
+        tokens_[it->second] = token;
+        return true;
+#endif
+    }
+
+    void remove(int fd) {
+#ifdef __linux__
+        ++syscalls_;
+        ::epoll_ctl(epfd_, EPOLL_CTL_DEL, fd, nullptr);
+#else
+        auto it = slot_.find(fd);
+        if (it == slot_.end()) return;
+        const size_t i = it->second, last = fds_.size() - 1;
+        slot_.erase(it);
+        if (i != last) {
+            fds_[i] = fds_[last];
+            tokens_[i] = tokens_[last];
+            slot_[fds_[i].fd] = i;
+        }
+        fds_.pop_back();
+        tokens_.pop_back();
+#endif
+    }
+
+    // Wait up to `timeout_ms` (-1 = forever) and fill `out`. Returns the
+    // number of events; 0 on timeout or EINTR.
+    size_t wait(std::vector<Event>& out, int timeout_ms) {
+        out.clear();
+        ++syscalls_;
+#ifdef __linux__
+        epoll_event evs[MAX_EVENTS];
+        const int n = ::epoll_wait(epfd_, evs, MAX_EVENTS, timeout_ms);
+        for (int i = 0; i < n; ++i) {
+            out.push_back({evs[i].data.u64,
+                           (evs[i].events & EPOLLIN) != 0,
+                           (evs[i].events & EPOLLOUT) != 0,
+                           (evs[i].events & (EPOLLHUP | EPOLLERR)) != 0});
+        }
+#else
+        const int n = ::poll(fds_.data(), static_cast<nfds_t>(fds_.size()), timeout_ms);
+        for (size_t i = 0; n > 0 && i < fds_.size(); ++i) {
+            const short re = fds_[i].revents;
+            if (!re) continue;
+            out.push_back({tokens_[i], (re & POLLIN) != 0, (re & POLLOUT) != 0,
+                           (re & (POLLHUP | POLLERR | POLLNVAL)) != 0});
+        }
+#endif
+        return out.size();
+    }
+
+    // epoll_wait / epoll_ctl (or poll) calls so far.
+    [[nodiscard]] uint64_t syscalls() const noexcept { return syscalls_; }
+
+private:
+    uint64_t syscalls_ = 0;
+
+#ifdef __linux__
+    static constexpr int MAX_EVENTS = 64;
+
+    static epoll_event make(uint64_t token, bool want_write) {
+        epoll_event ev{};
+        ev.events   = EPOLLIN | (want_write ? EPOLLOUT : 0u);
+        ev.data.u64 = token;
+        return ev;
+    }
+
+    int epfd_ = -1;
+#else
+    static short mask(bool want_write) {
+        return static_cast<short>(POLLIN | (want_write ? POLLOUT : 0));
+    }
+
+    std::vector<pollfd>             fds_;
+    std::vector<uint64_t>           tokens_;
+    std::unordered_map<int, size_t> slot_;   // fd → index in fds_ / tokens_
+#endif
+};
+
+} // namespace micro_exchange::net
@@ -7,6 +7,21 @@
  * MatchingEngine reference and asserts the networked path produced an identical
  * number of executions and identical traded volume — i.e. serialising orders
  * over TCP and parsing them back changes nothing about the matching outcome.
+ * The flow runs twice: through the default OrderGateway (runtime listeners)
+ * and through StaticArrayOrderGateway (Exec writing via a compile-time sink).
+ *
+ * The event-driven path, on the epoll and (on Linux) io_uring backends, is
+ * then loaded with many concurrent loopback sessions: it reports throughput and round-trip percentiles, checks every
+ * Exec reaches exactly the owners of the trade's two sides, and checks a
+ * client that stops reading is cut off without stalling the others. Every
+ * order is timed by the latency probes there, and the exported report and
+ * traces are checked too.
+ *
+ * A third pass publishes the same flow's market data over UDP multicast
+ * (MulticastFeed.h) and rebuilds the depth book on the receiving end while
+ * losing packets on purpose — single packets, filled from the TCP
+ * retransmit history, and one outage longer than the history, recovered
+ * from a snapshot — and checks it ends up identical to the publisher's.
  *
  * Doubles as a usage demo for the protocol and as a CTest gate.
  */
@@ -14,6 +29,9 @@
 #include "OrderGateway.h"
 #include "OrderEntryProtocol.h"
 #include "MatchingEngine.h"
+#include "MulticastFeed.h"
+#include "FeedPublisher.h"
+#include "DepthBook.h"
 
 #include <sys/socket.h>
 #include <netinet/in.h>
@@ -26,6 +44,13 @@
 #include <random>
 #include <iostream>
 #include <cstring>
+#include <memory>
+#include <algorithm>
+#include <chrono>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
 
 using namespace micro_exchange;
 using namespace micro_exchange::core;
@@ -60,21 +85,13 @@ static std::vector<NewOrderRequest> make_flow(size_t n, const char* sym) {
     return v;
 }
 
-int main() {
-    const char* SYM = "TEST";
-    auto orders = make_flow(3000, SYM);
-
-    // ── Reference: same flow, in-process (no network) ──
-    uint64_t ref_trades = 0, ref_volume = 0;
-    {
-        MatchingEngine ref;
-        ref.add_symbol(SYM);
-        ref.set_trade_callback([&](const Trade& t) { ++ref_trades; ref_volume += t.quantity; });
-        for (const auto& r : orders) ref.submit_order(r);
-    }
-
+// Stream `orders` through a gateway of type G over loopback and check the
+// wire-level executions against the in-process reference.
+template <typename G, typename... BookArgs>
+bool run_over_tcp(const char* label, const std::vector<NewOrderRequest>& orders, const char* SYM,
+                  uint64_t ref_trades, uint64_t ref_volume, BookArgs... book_args) {
     // ── Gateway on an ephemeral port, served on its own thread ──
-    OrderGateway gateway(0, SYM);
+    G gateway(0, SYM, book_args...);
     uint16_t port = gateway.port();
     std::thread server([&] { gateway.serve_one_client(); });
 
@@ -100,7 +117,23 @@ int main() {
         if (::connect(cfd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) { connected = true; break; }
         usleep(2000);
     }
-    if (!connected) { std::cerr << "client could not connect to gateway\n"; return 1; }
+    if (!connected) { std::cerr << "client could not connect to gateway\n"; return false; }
+
+    // ── Logon: resolve the symbol to its SymbolId once for the session ──
+    SymbolId session_sym = SYMBOL_ID_NONE;
+    {
+        WireLogon lg{};
+        std::strncpy(lg.symbol, SYM, sizeof(lg.symbol) - 1);
+        if (!send_msg(cfd, MsgType::Logon, &lg, sizeof(lg))) { std::cerr << "logon send failed\n"; return false; }
+        WireHeader h{};
+        WireLogonAck la{};
+        if (!recv_header(cfd, h) || static_cast<MsgType>(h.type) != MsgType::LogonAck
+            || !read_full(cfd, &la, sizeof(la))
+            || la.status != static_cast<uint8_t>(AckStatus::Accepted)) {
+            std::cerr << "logon failed\n"; return 1;
+        }
+        session_sym = la.symbol_id;
+    }
 
     uint64_t wire_execs = 0, wire_exec_volume = 0, acks = 0;
 
@@ -112,8 +145,11 @@ int main() {
         w.tif      = static_cast<uint8_t>(r.tif);
         w.price    = r.price;
         w.quantity = r.quantity;
+        // Odd ids take the SymbolId fast path, even ids the by-name slow path;
+        // both must route to the same book.
+        w.symbol_id = (r.id & 1) ? session_sym : SYMBOL_ID_NONE;
         std::memcpy(w.symbol, r.symbol, sizeof(w.symbol));
-        if (!send_msg(cfd, MsgType::NewOrder, &w, sizeof(w))) { std::cerr << "send failed\n"; return 1; }
+        if (!send_msg(cfd, MsgType::NewOrder, &w, sizeof(w))) { std::cerr << "send failed\n"; return false; }
 
         // Read execs until this order's Ack arrives.
         WireHeader h{};
@@ -121,12 +157,12 @@ int main() {
         while (!acked && recv_header(cfd, h)) {
             if (static_cast<MsgType>(h.type) == MsgType::Exec) {
                 WireExec e{};
-                if (!read_full(cfd, &e, sizeof(e))) { std::cerr << "exec read failed\n"; return 1; }
+                if (!read_full(cfd, &e, sizeof(e))) { std::cerr << "exec read failed\n"; return false; }
                 ++wire_execs;
                 wire_exec_volume += e.quantity;
             } else if (static_cast<MsgType>(h.type) == MsgType::Ack) {
                 WireAck a{};
-                if (!read_full(cfd, &a, sizeof(a))) { std::cerr << "ack read failed\n"; return 1; }
+                if (!read_full(cfd, &a, sizeof(a))) { std::cerr << "ack read failed\n"; return false; }
                 ++acks;
                 acked = true;
             } else {
@@ -134,7 +170,7 @@ int main() {
                 read_full(cfd, tmp.data(), h.len);
             }
         }
-        if (!acked) { std::cerr << "no ack for order " << r.id << "\n"; return 1; }
+        if (!acked) { std::cerr << "no ack for order " << r.id << "\n"; return false; }
     }
 
     ::close(cfd);          // client done → server's read loop ends
@@ -142,18 +178,471 @@ int main() {
 
     auto gs = gateway.stats();
 
-    std::cout << "\n──────────── Gateway end-to-end test ────────────\n";
+    std::cout << "\n  [" << label << "]\n";
+    std::cout << "  session SymbolId     : " << session_sym << "\n";
     std::cout << "  orders sent over TCP : " << orders.size() << "\n";
     std::cout << "  acks received        : " << acks << "\n";
     std::cout << "  execs over the wire  : " << wire_execs << " (vol " << wire_exec_volume << ")\n";
     std::cout << "  in-process reference : " << ref_trades << " (vol " << ref_volume << ")\n";
     std::cout << "  gateway engine trades: " << gs.total_trades << "\n";
 
-    bool ok = (acks == orders.size())
+    bool ok = (session_sym != SYMBOL_ID_NONE)
+           && (acks == orders.size())
            && (wire_execs == ref_trades)
            && (wire_exec_volume == ref_volume)
            && (gs.total_trades == ref_trades);
 
+    return ok;
+}
+
+// Connect a loopback client to `port` (Nagle off, 5s receive timeout,
+// SO_RCVBUF `rcvbuf` if non-zero — set before connect so the advertised
+// window never exceeds it).
+static int connect_client(uint16_t port, int rcvbuf = 0) {
+    int cfd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (rcvbuf > 0) ::setsockopt(cfd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    int nodelay = 1;
+    ::setsockopt(cfd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+    timeval tv{}; tv.tv_sec = 5; tv.tv_usec = 0;
+    ::setsockopt(cfd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    for (int i = 0; i < 200; ++i) {
+        if (::connect(cfd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) return cfd;
+        usleep(2000);
+    }
+    ::close(cfd);
+    return -1;
+}
+
+// Many concurrent sessions on one event-driven gateway. Client k enters the
+// orders with (id - 1) % N == k, lock-step. Interleaving across sessions is
+// up to the scheduler, so instead of a reference trade count this checks the
+// routing: every Exec a client sees names one of its own orders, and each
+// trade side reaches its owner exactly once (owned buy volume summed over
+// clients == owned sell volume == the engine's traded volume). A final
+// client floods cancels without reading and must be cut off as a slow
+// consumer while the rest of the gateway carries on. Pipelined, the same
+// checks cover the matching and egress stages, and every request decoded
+// must have passed through both. Probes time every order: each must show up
+// wire to wire exactly once, and the exported report and traces must exist.
+static bool run_multi_session(const char* label, GatewayBackend backend, bool pipelined,
+                              const std::vector<NewOrderRequest>& orders, const char* SYM, size_t N) {
+    GatewayOptions opts;
+    opts.max_output_bytes = 64 * 1024;
+    opts.send_buffer      = 16 * 1024;
+    opts.backend          = backend;
+    opts.pipelined        = pipelined;
+    const auto report_path = std::filesystem::temp_directory_path()
+                           / ("gateway_latency_" + std::to_string(::getpid()) + ".txt");
+    std::filesystem::remove(report_path.string() + ".traces");
+    opts.probes.sample_every = 1;
+    opts.probes.export_path  = report_path.string();
+    opts.probes.export_ms    = 20;
+    OrderGateway gateway(opts, SYM);
+    std::thread server([&] { gateway.run(); });
+
+    struct ClientResult {
+        bool     ok = true;
+        uint64_t acks = 0, execs = 0, buy_volume = 0, sell_volume = 0, foreign = 0;
+        std::vector<double> rtt_us;
+    };
+    std::vector<ClientResult> results(N);
+    auto owns = [N](size_t k, OrderId id) { return id != 0 && (id - 1) % N == k; };
+    std::atomic<size_t> finished{0};
+
+    auto client = [&](size_t k) {
+        ClientResult& res = results[k];
+        int cfd = connect_client(gateway.port());
+        if (cfd < 0) { res.ok = false; finished.fetch_add(1); return; }
+
+        WireLogon lg{};
+        std::strncpy(lg.symbol, SYM, sizeof(lg.symbol) - 1);
+        WireHeader h{};
+        WireLogonAck la{};
+        if (!send_msg(cfd, MsgType::Logon, &lg, sizeof(lg)) || !recv_header(cfd, h)
+            || static_cast<MsgType>(h.type) != MsgType::LogonAck || !read_full(cfd, &la, sizeof(la))) {
+            res.ok = false; finished.fetch_add(1); ::close(cfd); return;
+        }
+
+        for (size_t i = k; i < orders.size(); i += N) {
+            const auto& r = orders[i];
+            WireNewOrder w{};
+            w.id        = r.id;
+            w.side      = static_cast<uint8_t>(r.side);
+            w.type      = static_cast<uint8_t>(r.type);
+            w.tif       = static_cast<uint8_t>(r.tif);
+            w.price     = r.price;
+            w.quantity  = r.quantity;
+            w.symbol_id = la.symbol_id;
+            std::memcpy(w.symbol, r.symbol, sizeof(w.symbol));
+
+            auto t0 = std::chrono::steady_clock::now();
+            if (!send_msg(cfd, MsgType::NewOrder, &w, sizeof(w))) { res.ok = false; break; }
+
+            // Execs for other clients' aggressors can arrive at any time;
+            // read until this order's Ack.
+            bool acked = false;
+            while (!acked && recv_header(cfd, h)) {
+                if (static_cast<MsgType>(h.type) == MsgType::Exec) {
+                    WireExec e{};
+                    if (!read_full(cfd, &e, sizeof(e))) break;
+                    ++res.execs;
+                    const bool buy = owns(k, e.buy_order_id), sell = owns(k, e.sell_order_id);
+                    if (buy)  res.buy_volume  += e.quantity;
+                    if (sell) res.sell_volume += e.quantity;
+                    if (!buy && !sell) ++res.foreign;
+                } else {
+                    std::vector<char> tmp(h.len);
+                    if (!read_full(cfd, tmp.data(), h.len)) break;
+                    acked = static_cast<MsgType>(h.type) == MsgType::Ack;
+                }
+            }
+            if (!acked) { res.ok = false; break; }
+            ++res.acks;
+            res.rtt_us.push_back(std::chrono::duration<double, std::micro>(
+                std::chrono::steady_clock::now() - t0).count());
+        }
+
+        // Once every client has its last Ack, every Exec has been queued;
+        // read the tail that is still in flight, then hang up.
+        finished.fetch_add(1);
+        while (finished.load() < N) usleep(1000);
+        timeval tv{}; tv.tv_usec = 100 * 1000;
+        ::setsockopt(cfd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        while (recv_header(cfd, h) && static_cast<MsgType>(h.type) == MsgType::Exec) {
+            WireExec e{};
+            if (!read_full(cfd, &e, sizeof(e))) break;
+            ++res.execs;
+            if (owns(k, e.buy_order_id))  res.buy_volume  += e.quantity;
+            if (owns(k, e.sell_order_id)) res.sell_volume += e.quantity;
+        }
+        ::close(cfd);
+    };
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> clients;
+    for (size_t k = 0; k < N; ++k) clients.emplace_back(client, k);
+    while (finished.load() < N) usleep(100);
+    const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    for (auto& t : clients) t.join();
+
+    // Let the gateway notice the closes before opening the slow consumer.
+    for (int i = 0; i < 200 && gateway.sessions_active() > 0; ++i) usleep(5000);
+
+    // ── Slow consumer: flood cancels for unknown ids and never read ──
+    bool slow_cut = false;
+    {
+        int cfd = connect_client(gateway.port(), 4096);
+        WireCancel c{};
+        std::strncpy(c.symbol, SYM, sizeof(c.symbol) - 1);
+        for (uint64_t i = 0; i < 200000 && cfd >= 0; ++i) {
+            c.id = UINT64_MAX - i;
+            if (!send_msg(cfd, MsgType::Cancel, &c, sizeof(c))) break;   // gateway hung up
+            if (gateway.session_counters().slow_consumers > 0) break;
+        }
+        for (int i = 0; i < 200 && gateway.session_counters().slow_consumers == 0; ++i) usleep(5000);
+        slow_cut = gateway.session_counters().slow_consumers == 1;
+        if (cfd >= 0) ::close(cfd);
+    }
+
+    gateway.stop();
+    server.join();
+
+    uint64_t acks = 0, execs = 0, buy_volume = 0, sell_volume = 0, foreign = 0;
+    bool clients_ok = true;
+    std::vector<double> rtt;
+    for (const auto& r : results) {
+        clients_ok = clients_ok && r.ok;
+        acks += r.acks; execs += r.execs; foreign += r.foreign;
+        buy_volume += r.buy_volume; sell_volume += r.sell_volume;
+        rtt.insert(rtt.end(), r.rtt_us.begin(), r.rtt_us.end());
+    }
+    std::sort(rtt.begin(), rtt.end());
+    auto pct = [&](double p) { return rtt.empty() ? 0.0 : rtt[static_cast<size_t>(p * (rtt.size() - 1))]; };
+
+    auto gs = gateway.stats();
+    const auto& sc = gateway.session_counters();
+    const auto ps = gateway.pipeline_stats();
+
+    std::cout << "\n  [" << label << ", " << N << " concurrent sessions]\n";
+    std::cout << "  orders / acks        : " << orders.size() << " / " << acks << "\n";
+    std::cout << "  throughput           : " << static_cast<uint64_t>(acks / secs) << " orders/s\n";
+    std::cout << "  round trip (us)      : p50 " << pct(0.50) << "  p99 " << pct(0.99)
+              << "  max " << pct(1.0) << "\n";
+    std::cout << "  execs received       : " << execs << " (gateway queued " << sc.execs
+              << ", foreign " << foreign << ")\n";
+    std::cout << "  owned volume b/s     : " << buy_volume << " / " << sell_volume
+              << " (engine " << gs.total_volume << ")\n";
+    std::cout << "  slow consumer cut    : " << (slow_cut ? "yes" : "NO")
+              << " (sessions opened " << sc.opened << ", closed " << sc.closed << ")\n";
+    bool stages_ok = true;
+    if (pipelined) {
+        auto stage = [](const char* name, const StageStats& st) {
+            std::cout << "  " << name << " : " << st.items << " items, depth mean "
+                      << st.mean_depth() << " max " << st.depth_max << ", wait mean "
+                      << st.mean_wait_ns() / 1000.0 << " us max " << st.wait_ns_max / 1000.0
+                      << " us, stalls " << st.stalls << "\n";
+        };
+        stage("stage io       ", ps.io);
+        stage("stage matching ", ps.matching);
+        stage("stage egress   ", ps.egress);
+        // Every command pushed was matched; replies outnumber commands.
+        stages_ok = ps.io.items == ps.matching.items && ps.egress.items >= ps.matching.items;
+    }
+
+    const auto lat = gateway.latency();
+    gateway.export_latency();
+    std::stringstream report, traces;
+    report << std::ifstream(report_path).rdbuf();
+    traces << std::ifstream(report_path.string() + ".traces").rdbuf();
+    std::filesystem::remove(report_path);
+    std::filesystem::remove(report_path.string() + ".traces");
+    const auto& w2w = lat[ProbeSpan::WireToWire];
+    std::cout << "  wire to wire (us)    : p50 " << w2w.percentile(0.50) / 1e3 << "  p99 "
+              << w2w.percentile(0.99) / 1e3 << "  max " << w2w.max / 1e3 << " (" << w2w.count
+              << " timed, " << lat[ProbeSpan::BookToFill].count << " filled, "
+              << lat.traces_kept << " traces kept)\n";
+    const bool probes_ok = !MICRO_EXCHANGE_PROBES
+        || (w2w.count == orders.size()
+            && lat[ProbeSpan::RecvToDecode].count == orders.size()
+            && lat[ProbeSpan::DecodeToBook].count == orders.size()
+            && lat[ProbeSpan::BookToFill].count > 0
+            && lat[ProbeSpan::BookToFill].count < orders.size()
+            && w2w.percentile(0.5) >= lat[ProbeSpan::RecvToDecode].percentile(0.5)
+            && report.str().find("wire_to_wire") != std::string::npos
+            && traces.str().find("trace 1 ") != std::string::npos);
+
+    return clients_ok && slow_cut && stages_ok && probes_ok
+        && acks == orders.size()
+        && foreign == 0
+        && execs == sc.execs
+        && buy_volume == gs.total_volume
+        && sell_volume == gs.total_volume
+        && sc.opened == N + 1 && sc.closed == N + 1;
+}
+
+// A client-supplied SymbolId is only a routing hint: the gateway keeps it
+// only when it is the session's own id and the symbol agrees, otherwise the
+// symbol decides. Each order rests (no trades), so the next message is its Ack.
+static bool run_untrusted_symbol_id(const char* SYM) {
+    OrderGateway gateway(0, SYM);
+    std::thread server([&] { gateway.serve_one_client(); });
+    const int cfd = connect_client(gateway.port());
+    if (cfd < 0) { server.join(); std::cerr << "client could not connect to gateway\n"; return false; }
+
+    auto ack_status = [&](OrderId id, SymbolId sid, const char* sym) -> int {
+        WireNewOrder w{};
+        w.id        = id;
+        w.side      = static_cast<uint8_t>(Side::Buy);
+        w.type      = static_cast<uint8_t>(OrderType::Limit);
+        w.tif       = static_cast<uint8_t>(TimeInForce::GTC);
+        w.price     = 100;
+        w.quantity  = 100;
+        w.symbol_id = sid;
+        std::strncpy(w.symbol, sym, sizeof(w.symbol) - 1);
+        WireHeader h{};
+        WireAck a{};
+        if (!send_msg(cfd, MsgType::NewOrder, &w, sizeof(w)) || !recv_header(cfd, h)
+            || static_cast<MsgType>(h.type) != MsgType::Ack || !read_full(cfd, &a, sizeof(a))) return -1;
+        return a.status;
+    };
+    const int accepted = static_cast<int>(AckStatus::Accepted);
+    const int rejected = static_cast<int>(AckStatus::Rejected);
+
+    // Before Logon no id is trusted: an unknown symbol is rejected even
+    // with the book's id on the wire.
+    bool ok = ack_status(1, 1, "OTHER") == rejected;
+
+    WireLogon lg{};
+    std::strncpy(lg.symbol, SYM, sizeof(lg.symbol) - 1);
+    WireHeader h{};
+    WireLogonAck la{};
+    ok = ok && send_msg(cfd, MsgType::Logon, &lg, sizeof(lg)) && recv_header(cfd, h)
+            && read_full(cfd, &la, sizeof(la)) && la.symbol_id != SYMBOL_ID_NONE;
+
+    ok = ok && ack_status(2, la.symbol_id, SYM) == accepted        // agreeing id: fast path
+            && ack_status(3, la.symbol_id, "") == accepted         // id only
+            && ack_status(4, la.symbol_id + 6, SYM) == accepted    // wrong id: routed by name
+            && ack_status(5, la.symbol_id, "OTHER") == rejected    // id disagrees with the symbol
+            && ack_status(6, la.symbol_id + 6, "") == rejected;    // wrong id, no symbol
+
+    ::close(cfd);
+    server.join();
+    const EngineStats st = gateway.stats();
+
+    std::cout << "\n  [untrusted SymbolId]\n";
+    std::cout << "  acks as expected     : " << (ok ? "yes" : "NO") << "\n";
+    std::cout << "  routed / rejected    : " << st.total_orders << " / " << st.total_rejects << " (expect 3 / 3)\n";
+    return ok && st.total_orders == 3 && st.total_rejects == 3;
+}
+
+// Publish `orders`' market data over multicast and rebuild the L2 book from
+// the packets. Every 9th data packet is "lost", plus everything in an outage
+// three histories long; the first kind comes back from the retransmit
+// history, the outage from a snapshot.
+static bool run_multicast_feed(const std::vector<NewOrderRequest>& orders, const char* SYM) {
+    std::string group = "239.192.0.1";
+    auto rx = std::make_unique<MulticastFeedReceiver>(group, 0);
+    if (!rx->joined()) {   // no multicast route on this host: unicast to ourselves
+        group = "127.0.0.1";
+        rx = std::make_unique<MulticastFeedReceiver>(group, 0);
+    }
+
+    MulticastFeedPublisher::Options mo;
+    mo.group    = group;
+    mo.port     = rx->port();
+    mo.history  = 8192;
+    mo.flush_us = 20;
+    MulticastFeedPublisher mcast(mo);
+    FeedRetransmitServer retransmit(mcast.history(), 0, mcast.options().session);
+
+    MatchingEngine engine;
+    OrderBook& book = engine.add_symbol(SYM);
+    md::FeedPublisher::Options fo;
+    fo.depth_levels         = 5;
+    fo.depth_snapshot_every = 150;
+    fo.retain_messages      = false;
+    md::FeedPublisher feed(fo);
+    feed.set_callback([&](const md::FeedMessage& m) { mcast.push(m); });
+    feed.attach(book);
+
+    md::DepthBook depth(SYM);
+    uint64_t packets = 0, dropped = 0, replays = 0, snapshots = 0, replayed_msgs = 0;
+    bool     consistent = true;
+    const SeqNum outage_begin = 3000, outage_end = outage_begin + 3 * mo.history;
+
+    std::thread consumer([&] {
+        RetransmitClient client(retransmit.port());
+        SeqNum lost_from  = 0;   // first message of the packets dropped so far
+        SeqNum applied_to = 1;   // next sequence the depth book has not seen
+        auto apply = [&](const md::FeedMessage& m) {
+            if (m.sequence < applied_to) return;   // already covered by a fill
+            const bool is_depth = m.type == md::FeedMessageType::LevelUpdate
+                               || m.type == md::FeedMessageType::LevelSnapshot
+                               || m.type == md::FeedMessageType::Snapshot;
+            if (!depth.apply(m) && is_depth) consistent = false;   // out of sync
+            applied_to = m.sequence + 1;
+        };
+        int    idle_ms   = 0;
+        while (idle_ms < 3000) {
+            auto pkt = rx->receive(10);
+            if (!pkt) { idle_ms += 10; continue; }
+            idle_ms = 0;
+
+            const SeqNum first  = pkt->header.sequence;
+            const SeqNum missed = pkt->gap_count ? pkt->gap_first : first;
+            const bool   data   = pkt->header.count != 0 && !pkt->end_of_session();
+            if (data && (++packets % 9 == 0 || (first >= outage_begin && first < outage_end))) {
+                ++dropped;
+                lost_from = lost_from ? std::min(lost_from, missed) : missed;
+                continue;
+            }
+
+            // Fill what is missing ahead of this packet: our drops and any real loss.
+            const SeqNum miss_from = lost_from ? std::min(lost_from, missed) : missed;
+            if (miss_from < first) {
+                std::vector<md::FeedMessage> fill;
+                auto done = client.request(miss_from, first - miss_from, fill);
+                if (!done) { consistent = false; return; }
+                if (done->status == static_cast<uint8_t>(RetransmitStatus::Snapshot)) {
+                    ++snapshots;
+                } else {
+                    ++replays;
+                    if (fill.size() != first - miss_from) consistent = false;
+                }
+                replayed_msgs += fill.size();
+                // A snapshot restarts the book, so what follows it applies
+                // whatever was applied before.
+                if (done->status == static_cast<uint8_t>(RetransmitStatus::Snapshot)) applied_to = 0;
+                for (const auto& m : fill) apply(m);
+                applied_to = std::max(applied_to, done->next_sequence);
+                rx->set_expected(done->next_sequence);
+                lost_from = 0;
+            }
+            if (!data) {
+                if (pkt->end_of_session()) return;
+                continue;   // heartbeat
+            }
+            for (const auto& m : pkt->messages) apply(m);
+        }
+        consistent = false;   // no end-of-session packet
+    });
+
+    for (const auto& r : orders) engine.submit_order(r);
+    // The flow tends to sweep the book; leave levels on both sides to compare.
+    OrderId id = orders.size();
+    for (Price p = 0; p < 8; ++p) {
+        for (Side side : {Side::Buy, Side::Sell}) {
+            NewOrderRequest r{};
+            r.id       = ++id;
+            r.side     = side;
+            r.price    = side == Side::Buy ? 90 - p : 110 + p;
+            r.quantity = 100 + 100 * static_cast<Quantity>(p);
+            std::strncpy(r.symbol, SYM, sizeof(r.symbol) - 1);
+            engine.submit_order(r);
+        }
+    }
+    feed.flush();
+    mcast.close();
+    consumer.join();
+
+    auto same = [&](Side side, const std::vector<BookLevel>& got) {
+        auto want = feed.depth(book, side);
+        return std::equal(want.begin(), want.end(), got.begin(), got.end(), [](const BookLevel& a, const BookLevel& b) {
+            return a.price == b.price && a.quantity == b.quantity && a.order_count == b.order_count;
+        });
+    };
+    const auto ms = mcast.stats();
+
+    std::cout << "\n  [MulticastFeed (" << group << ")]\n";
+    std::cout << "  feed messages        : " << ms.messages << " in " << ms.packets << " packets ("
+              << ms.flush_size << " full, " << ms.flush_timer << " on timer)\n";
+    std::cout << "  packets dropped      : " << dropped << "\n";
+    std::cout << "  gap fills            : " << replays << " replayed, " << snapshots
+              << " from snapshot (" << replayed_msgs << " msgs over TCP)\n";
+    std::cout << "  rebuilt depth        : " << depth.bids().size() << " bids, " << depth.asks().size() << " asks\n";
+
+    return consistent
+        && ms.messages == feed.sequence() - 1
+        && ms.send_errors == 0
+        && dropped > 0 && replays > 0 && snapshots > 0
+        && same(Side::Buy, depth.bids()) && same(Side::Sell, depth.asks());
+}
+
+int main() {
+    const char* SYM = "TEST";
+    auto orders = make_flow(3000, SYM);
+
+    // ── Reference: same flow, in-process (no network) ──
+    uint64_t ref_trades = 0, ref_volume = 0;
+    {
+        MatchingEngine ref;
+        ref.add_symbol(SYM);
+        ref.set_trade_callback([&](const Trade& t) { ++ref_trades; ref_volume += t.quantity; });
+        for (const auto& r : orders) ref.submit_order(r);
+    }
+
+    std::cout << "\n──────────── Gateway end-to-end test ────────────\n";
+    bool ok = run_over_tcp<OrderGateway>("OrderGateway (runtime listeners)",
+                                         orders, SYM, ref_trades, ref_volume);
+    // Same flow with Exec writing and stats dispatched through static sinks.
+    ok = run_over_tcp<StaticArrayOrderGateway>("StaticArrayOrderGateway (static sinks)",
+                                               orders, SYM, ref_trades, ref_volume,
+                                               Price{0}, Price{200}) && ok;
+    ok = run_multi_session("OrderGateway epoll", GatewayBackend::Epoll, false, make_flow(32 * 500, SYM), SYM, 32) && ok;
+    ok = run_multi_session("OrderGateway epoll, pipelined", GatewayBackend::Epoll, true,
+                           make_flow(32 * 500, SYM), SYM, 32) && ok;
+#if MICRO_EXCHANGE_HAS_IO_URING
+    ok = run_multi_session("OrderGateway io_uring", GatewayBackend::IoUring, false, make_flow(32 * 500, SYM), SYM, 32) && ok;
+    ok = run_multi_session("OrderGateway io_uring, pipelined", GatewayBackend::IoUring, true,
+                           make_flow(32 * 500, SYM), SYM, 32) && ok;
+#endif
+    ok = run_untrusted_symbol_id(SYM) && ok;
+    ok = run_multicast_feed(make_flow(20000, SYM), SYM) && ok;
+
     std::cout << (ok ? "  GATEWAY TEST PASSED ✓\n" : "  GATEWAY TEST FAILED ✗\n");
     std::cout << "─────────────────────────────────────────────────\n";
     return ok ? 0 : 1;
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "../../core/include/Order.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace micro_exchange::sim {
+
+using namespace micro_exchange::core;
+
+/**
+ * AgentOrders — each agent's resting orders, for strategic cancels.
+ *
+ * Every agent owns a dense vector of {id, price}; an id → slot map finds an
+ * order's entry, so removing one (when the book reports it filled or
+ * cancelled) is a swap with the agent's last entry and a pop: O(1), no
+ * scan. The set only ever holds orders that are live in the book, so its
+ * size is the agents' share of book depth.
+ *
+ * review() walks an agent's orders round-robin, a few per call, resuming
+ * where the previous call stopped. Spreading the walk over the event loop
+ * replaces a periodic sweep over everything with a constant trickle.
+ */
+class AgentOrders {
+public:
+    struct Live {
+        OrderId id    = 0;
+        Price   price = 0;
+    };
+
+    explicit AgentOrders(size_t agents, size_t expected_orders = 4096)
+        : live_(agents), cursor_(agents, 0) {
+        where_.reserve(expected_orders);
+    }
+
+    void add(size_t agent, OrderId id, Price price) {
+        auto& v = live_[agent];
+        where_[id] = Slot{static_cast<uint32_t>(agent), static_cast<uint32_t>(v.size())};
+        v.push_back(Live{id, price});
+        if (++size_ > peak_) peak_ = size_;
+    }
+
+    /// Drop `id` if tracked; false if it isn't (e.g. an order that never rested).
+    bool remove(OrderId id) {
+        auto it = where_.find(id);
+        if (it == where_.end()) return false;
+        const Slot s = it->second;
+        where_.erase(it);
+        auto& v = live_[s.agent];
+        if (s.index + 1 != v.size()) {
+            v[s.index] = v.back();
+            where_[v[s.index].id].index = s.index;
+        }
+        v.pop_back();
+        --size_;
+        return true;
+    }
+
+    /**
+     * Visit up to `count` of `agent`'s orders, resuming where the last
+     * review stopped. `decide(live)` returns true when it cancelled the
+     * order; the cancel is expected to remove() it (the order listener does),
+     * which moves another order into the slot, so the cursor stays put.
+     * Returns the number cancelled.
+     */
+    template <typename Decide>
+    size_t review(size_t agent, size_t count, Decide&& decide) {
+        const auto& v = live_[agent];
+        size_t& c = cursor_[agent];
+        size_t cancelled = 0;
+        for (size_t k = 0; k < count && !v.empty(); ++k) {
+            if (c >= v.size()) c = 0;
+            const size_t before = v.size();
+            if (decide(v[c]) && v.size() < before) ++cancelled;
+            else ++c;
+        }
+        return cancelled;
+    }
+
+    [[nodiscard]] size_t size() const noexcept { return size_; }
+    [[nodiscard]] size_t size(size_t agent) const noexcept { return live_[agent].size(); }
+    [[nodiscard]] size_t peak() const noexcept { return peak_; }
+    [[nodiscard]] const std::vector<Live>& of(size_t agent) const noexcept { return live_[agent]; }
+
+private:
+    struct Slot {
+        uint32_t agent = 0;
+        uint32_t index = 0;
+    };
+
+    std::vector<std::vector<Live>>       live_;
+    std::vector<size_t>                  cursor_;
+    std::unordered_map<OrderId, Slot>    where_;
+    size_t size_ = 0;
+    size_t peak_ = 0;
+};
+
+} // namespace micro_exchange::sim
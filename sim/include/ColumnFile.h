@@ -0,0 +1,126 @@
+#pragma once
+
+#include "MappedFile.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace micro_exchange::sim {
+
+/**
+ * Column files — one typed series per file, appended to as it's produced.
+ *
+ *   header  u8[4] "MXC1", u8 type, u8 width, u16 reserved, u64 reserved
+ *   body    width-byte little-endian values, back to back
+ *
+ * The row count is (file size - 16) / width, so a column can be appended
+ * to indefinitely and read back without a footer or an index. Long
+ * simulations stream each series through a ColumnWriter's fixed buffer, so
+ * memory doesn't grow with the run. read_column() maps the file and copies
+ * the values out; analysis tools (numpy.fromfile(..., offset=16)) can read
+ * the body directly.
+ */
+enum class ColumnType : uint8_t { F64 = 1, I64 = 2, U64 = 3, U8 = 4 };
+
+template <typename T> constexpr ColumnType column_type_of() {
+    if constexpr (std::is_same_v<T, double>)        return ColumnType::F64;
+    else if constexpr (std::is_same_v<T, int64_t>)  return ColumnType::I64;
+    else if constexpr (std::is_same_v<T, uint64_t>) return ColumnType::U64;
+    else {
+        static_assert(std::is_same_v<T, uint8_t>, "column values are f64, i64, u64 or u8");
+        return ColumnType::U8;
+    }
+}
+
+inline constexpr size_t COLUMN_HEADER = 16;
+
+template <typename T>
+class ColumnWriter {
+public:
+    static constexpr size_t BUFFER = 64 * 1024;
+
+    ColumnWriter() = default;
+    explicit ColumnWriter(const std::string& path) { open(path); }
+    ~ColumnWriter() { close(); }
+
+    ColumnWriter(const ColumnWriter&) = delete;
+    ColumnWriter& operator=(const ColumnWriter&) = delete;
+
+    bool open(const std::string& path) {
+        close();
+        fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        ok_ = fd_ >= 0;
+        rows_ = 0;
+        if (!ok_) return false;
+        buf_.resize(BUFFER);
+        uint8_t head[COLUMN_HEADER] = {'M', 'X', 'C', '1',
+                                       static_cast<uint8_t>(column_type_of<T>()),
+                                       static_cast<uint8_t>(sizeof(T))};
+        std::memcpy(buf_.data(), head, COLUMN_HEADER);
+        used_ = COLUMN_HEADER;
+        return true;
+    }
+
+    void append(T v) {
+        if (!ok_) return;
+        if (used_ + sizeof(T) > buf_.size()) flush();
+        std::memcpy(buf_.data() + used_, &v, sizeof(T));
+        used_ += sizeof(T);
+        ++rows_;
+    }
+
+    /// Write out what's buffered and close; false if any write failed.
+    bool close() {
+        if (fd_ < 0) return ok_;
+        flush();
+        if (::close(fd_) != 0) ok_ = false;
+        fd_ = -1;
+        return ok_;
+    }
+
+    [[nodiscard]] bool     ok()   const noexcept { return ok_; }
+    [[nodiscard]] uint64_t rows() const noexcept { return rows_; }
+
+private:
+    void flush() {
+        size_t off = 0;
+        while (ok_ && off < used_) {
+            const ssize_t n = ::write(fd_, buf_.data() + off, used_ - off);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) { ok_ = false; break; }
+            off += static_cast<size_t>(n);
+        }
+        used_ = 0;
+    }
+
+    int                  fd_ = -1;
+    bool                 ok_ = false;
+    std::vector<uint8_t> buf_;
+    size_t               used_ = 0;
+    uint64_t             rows_ = 0;
+};
+
+/// Every value in column file `path`; empty if it's missing or of another type.
+template <typename T>
+std::vector<T> read_column(const std::string& path) {
+    core::MappedFile f(path);
+    std::vector<T> out;
+    if (!f.ok() || f.size() < COLUMN_HEADER) return out;
+    const auto* p = reinterpret_cast<const uint8_t*>(f.data());
+    if (std::memcmp(p, "MXC1", 4) != 0 || p[4] != static_cast<uint8_t>(column_type_of<T>())
+        || p[5] != sizeof(T)) {
+        return out;
+    }
+    out.resize((f.size() - COLUMN_HEADER) / sizeof(T));
+    if (!out.empty()) std::memcpy(out.data(), p + COLUMN_HEADER, out.size() * sizeof(T));
+    return out;
+}
+
+} // namespace micro_exchange::sim
@@ -0,0 +1,354 @@
+#pragma once
+
+#include "ColumnFile.h"
+#include "Order.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace micro_exchange::sim {
+
+using namespace micro_exchange::core;
+
+/**
+ * Mean / variance / min / max of a stream of values (Welford), mergeable
+ * with another partial result (Chan et al.). Merging the same partials in
+ * the same order gives the same bits, whichever threads produced them.
+ */
+struct StreamingStat {
+    uint64_t n    = 0;
+    double   mean = 0;
+    double   m2   = 0;
+    double   min  = std::numeric_limits<double>::infinity();
+    double   max  = -std::numeric_limits<double>::infinity();
+
+    void add(double x) noexcept {
+        ++n;
+        const double d = x - mean;
+        mean += d / static_cast<double>(n);
+        m2   += d * (x - mean);
+        min = std::min(min, x);
+        max = std::max(max, x);
+    }
+
+    void merge(const StreamingStat& o) noexcept {
+        if (o.n == 0) return;
+        if (n == 0) { *this = o; return; }
+        const double na = static_cast<double>(n), nb = static_cast<double>(o.n);
+        const double d  = o.mean - mean;
+        n    += o.n;
+        mean += d * nb / (na + nb);
+        m2   += o.m2 + d * d * na * nb / (na + nb);
+        min = std::min(min, o.min);
+        max = std::max(max, o.max);
+    }
+
+    [[nodiscard]] double variance() const noexcept { return n > 1 ? m2 / static_cast<double>(n - 1) : 0; }
+    [[nodiscard]] double stddev() const noexcept { return std::sqrt(variance()); }
+};
+
+/**
+ * How a simulation records its series.
+ *
+ *   dir           — "" keeps everything in memory (SimulationData vectors);
+ *                   otherwise each series streams to a column file in this
+ *                   directory (ColumnFile.h) and nothing accumulates.
+ *   decimate      — keep one event sample (time, mid, spread) in N.
+ *   bar_sec       — > 0: aggregate events into bars this many simulated
+ *                   seconds long instead of keeping event samples.
+ *   horizon_short — seconds after a trade at which mid_after_short is read
+ *   horizon_long  — ... and mid_after_long (realized spread / impact).
+ */
+struct CollectOptions {
+    std::string dir;
+    size_t      decimate      = 1;
+    double      bar_sec       = 0;
+    double      horizon_short = 1.0;
+    double      horizon_long  = 5.0;
+};
+
+/// A trade with the midpoint before it and at both horizons after it.
+struct TradeSample {
+    double   time            = 0;
+    Price    price           = 0;
+    Quantity quantity        = 0;
+    Side     aggressor       = Side::Buy;
+    Price    mid_before      = 0;
+    Price    mid_after_short = 0;
+    Price    mid_after_long  = 0;
+};
+
+/// Events (and the trades they caused) within one bar_sec slice.
+struct Bar {
+    double   start       = 0;
+    Price    open        = 0;
+    Price    high        = 0;
+    Price    low         = 0;
+    Price    close       = 0;
+    double   mean_spread = 0;
+    uint64_t events      = 0;
+    uint64_t trades      = 0;
+    Quantity volume      = 0;
+};
+
+/// Whole-run figures a DataCollector keeps in O(1) space, whatever it records.
+struct CollectStats {
+    uint64_t      events       = 0;
+    uint64_t      samples      = 0;
+    uint64_t      bars         = 0;
+    uint64_t      trades       = 0;
+    uint64_t      buy_trades   = 0;   // buyer-initiated
+    Quantity      volume       = 0;
+    double        notional     = 0;   // Σ price · quantity, ticks
+    StreamingStat spread;             // quoted spread per event
+    StreamingStat mid_change;         // event-to-event midprice change
+    Price         last_mid     = 0;
+    size_t        peak_pending = 0;   // most trades waiting on a horizon at once
+};
+
+/**
+ * Power-of-two FIFO ring that doubles only when full: its size tracks the
+ * most items ever pending at once (trades inside the long horizon), not
+ * how many went through.
+ */
+template <typename T>
+class WindowRing {
+public:
+    void push_back(const T& v) {
+        if (size_ == buf_.size()) grow();
+        buf_[(head_ + size_) & (buf_.size() - 1)] = v;
+        ++size_;
+    }
+    void pop_front() noexcept { head_ = (head_ + 1) & (buf_.size() - 1); --size_; }
+    [[nodiscard]] T&       operator[](size_t i)       noexcept { return buf_[(head_ + i) & (buf_.size() - 1)]; }
+    [[nodiscard]] T&       front()                    noexcept { return (*this)[0]; }
+    [[nodiscard]] size_t   size()     const noexcept { return size_; }
+    [[nodiscard]] bool     empty()    const noexcept { return size_ == 0; }
+    [[nodiscard]] size_t   capacity() const noexcept { return buf_.size(); }
+
+private:
+    void grow() {
+        std::vector<T> next(std::max<size_t>(16, buf_.size() * 2));
+        for (size_t i = 0; i < size_; ++i) next[i] = (*this)[i];
+        buf_.swap(next);
+        head_ = 0;
+    }
+
+    std::vector<T> buf_;
+    size_t head_ = 0;
+    size_t size_ = 0;
+};
+
+/**
+ * ColumnSink — a DataCollector sink writing each series to its own column
+ * file under `dir`: event_time / mid / spread (samples), bar_* (bars), and
+ * trade_time / trade_price / trade_qty / trade_side / mid_before /
+ * mid_after_short / mid_after_long (trades).
+ */
+class ColumnSink {
+public:
+    explicit ColumnSink(const std::string& dir) : dir_(dir) {
+        std::error_code ec;
+        std::filesystem::create_directories(dir_, ec);
+    }
+
+    void sample(double t, Price mid, Price spread) {
+        if (!samples_) open_samples();
+        time_.append(t);
+        mid_.append(mid);
+        spread_.append(spread);
+    }
+
+    void bar(const Bar& b) {
+        if (!bars_) open_bars();
+        bar_start_.append(b.start);
+        bar_open_.append(b.open);
+        bar_high_.append(b.high);
+        bar_low_.append(b.low);
+        bar_close_.append(b.close);
+        bar_spread_.append(b.mean_spread);
+        bar_events_.append(b.events);
+        bar_trades_.append(b.trades);
+        bar_volume_.append(b.volume);
+    }
+
+    void trade(const TradeSample& s) {
+        if (!trades_) open_trades();
+        trade_time_.append(s.time);
+        trade_price_.append(s.price);
+        trade_qty_.append(s.quantity);
+        trade_side_.append(static_cast<uint8_t>(s.aggressor));
+        mid_before_.append(s.mid_before);
+        mid_short_.append(s.mid_after_short);
+        mid_long_.append(s.mid_after_long);
+    }
+
+    /// Close every column written to; false if any open or write failed.
+    bool close() {
+        bool ok = true;
+        if (samples_) ok = time_.close() & mid_.close() & spread_.close() & ok;
+        if (bars_) {
+            ok = bar_start_.close() & bar_open_.close() & bar_high_.close() & bar_low_.close()
+               & bar_close_.close() & bar_spread_.close() & bar_events_.close()
+               & bar_trades_.close() & bar_volume_.close() & ok;
+        }
+        if (trades_) {
+            ok = trade_time_.close() & trade_price_.close() & trade_qty_.close()
+               & trade_side_.close() & mid_before_.close() & mid_short_.close()
+               & mid_long_.close() & ok;
+        }
+        return ok;
+    }
+
+    [[nodiscard]] std::string path(const char* column) const { return dir_ + "/" + column + ".col"; }
+
+private:
+    void open_samples() {
+        samples_ = true;
+        time_.open(path("event_time"));
+        mid_.open(path("mid"));
+        spread_.open(path("spread"));
+    }
+    void open_bars() {
+        bars_ = true;
+        bar_start_.open(path("bar_start"));
+        bar_open_.open(path("bar_open"));
+        bar_high_.open(path("bar_high"));
+        bar_low_.open(path("bar_low"));
+        bar_close_.open(path("bar_close"));
+        bar_spread_.open(path("bar_spread"));
+        bar_events_.open(path("bar_events"));
+        bar_trades_.open(path("bar_trades"));
+        bar_volume_.open(path("bar_volume"));
+    }
+    void open_trades() {
+        trades_ = true;
+        trade_time_.open(path("trade_time"));
+        trade_price_.open(path("trade_price"));
+        trade_qty_.open(path("trade_qty"));
+        trade_side_.open(path("trade_side"));
+        mid_before_.open(path("mid_before"));
+        mid_short_.open(path("mid_after_short"));
+        mid_long_.open(path("mid_after_long"));
+    }
+
+    std::string dir_;
+    bool samples_ = false, bars_ = false, trades_ = false;
+    ColumnWriter<double>   time_, bar_start_, bar_spread_, trade_time_;
+    ColumnWriter<int64_t>  mid_, spread_, bar_open_, bar_high_, bar_low_, bar_close_;
+    ColumnWriter<int64_t>  trade_price_, mid_before_, mid_short_, mid_long_;
+    ColumnWriter<uint64_t> bar_events_, bar_trades_, bar_volume_, trade_qty_;
+    ColumnWriter<uint8_t>  trade_side_;
+};
+
+/**
+ * DataCollector — turns the event loop's per-event state and trades into
+ * the recorded series, in one pass and bounded memory.
+ *
+ * event() is called once per inbound event with the book state the order
+ * sees (before it is submitted); trade() for each print it causes. Trades
+ * wait in a WindowRing until the first event at least horizon_short and
+ * then horizon_long after them, whose pre-order mid they take as
+ * mid_after_short / _long; a trade is handed to the sink the moment its
+ * long horizon resolves. Anything still pending at finish() takes the last
+ * mid, as a lookup past the end of the series would.
+ *
+ * The Sink receives sample(t, mid, spread) (every `decimate`-th event),
+ * bar(const Bar&) (when bar_sec > 0, instead of samples) and
+ * trade(const TradeSample&).
+ */
+template <typename Sink>
+class DataCollector {
+public:
+    DataCollector(const CollectOptions& opts, Sink& sink) : opts_(opts), sink_(sink) {
+        if (opts_.decimate == 0) opts_.decimate = 1;
+    }
+
+    void event(double t, Price mid, Price spread) {
+        resolve(t, mid);
+        if (stats_.events) stats_.mid_change.add(static_cast<double>(mid - stats_.last_mid));
+        stats_.spread.add(static_cast<double>(spread));
+        stats_.last_mid = mid;
+        if (opts_.bar_sec > 0) {
+            const double start = std::floor(t / opts_.bar_sec) * opts_.bar_sec;
+            if (bar_.events == 0 || start != bar_.start) {
+                close_bar();
+                bar_ = Bar{start, mid, mid, mid, mid, 0, 0, 0, 0};
+            }
+            bar_.high = std::max(bar_.high, mid);
+            bar_.low  = std::min(bar_.low, mid);
+            bar_.close = mid;
+            spread_sum_ += static_cast<double>(spread);
+            ++bar_.events;
+        } else if (stats_.events % opts_.decimate == 0) {
+            sink_.sample(t, mid, spread);
+            ++stats_.samples;
+        }
+        ++stats_.events;
+    }
+
+    void trade(double t, const Trade& tr, Price mid_before) {
+        pending_.push_back(TradeSample{t, tr.price, tr.quantity, tr.aggressor, mid_before, 0, 0});
+        stats_.peak_pending = std::max(stats_.peak_pending, pending_.size());
+        ++stats_.trades;
+        stats_.buy_trades += tr.aggressor == Side::Buy;
+        stats_.volume += tr.quantity;
+        stats_.notional += static_cast<double>(tr.price) * static_cast<double>(tr.quantity);
+        if (opts_.bar_sec > 0) {
+            ++bar_.trades;
+            bar_.volume += tr.quantity;
+        }
+    }
+
+    /// Flush pending trades (at the last mid) and the open bar.
+    void finish() {
+        for (; resolved_short_ < pending_.size(); ++resolved_short_)
+            pending_[resolved_short_].mid_after_short = stats_.last_mid;
+        while (!pending_.empty()) emit_front(stats_.last_mid);
+        close_bar();
+    }
+
+    [[nodiscard]] const CollectStats& stats() const noexcept { return stats_; }
+    [[nodiscard]] size_t window_capacity() const noexcept { return pending_.capacity(); }
+
+private:
+    void resolve(double t, Price mid) {
+        for (; resolved_short_ < pending_.size()
+               && pending_[resolved_short_].time + opts_.horizon_short <= t; ++resolved_short_) {
+            pending_[resolved_short_].mid_after_short = mid;
+        }
+        while (!pending_.empty() && pending_.front().time + opts_.horizon_long <= t) emit_front(mid);
+    }
+
+    void emit_front(Price mid) {
+        TradeSample& s = pending_.front();
+        s.mid_after_long = mid;
+        sink_.trade(s);
+        pending_.pop_front();
+        if (resolved_short_) --resolved_short_;
+    }
+
+    void close_bar() {
+        if (bar_.events == 0) return;
+        bar_.mean_spread = spread_sum_ / static_cast<double>(bar_.events);
+        sink_.bar(bar_);
+        ++stats_.bars;
+        bar_ = Bar{};
+        spread_sum_ = 0;
+    }
+
+    CollectOptions           opts_;
+    Sink&                    sink_;
+    WindowRing<TradeSample>  pending_;
+    size_t                   resolved_short_ = 0;   // pending_[0, this) have mid_after_short
+    Bar                      bar_;
+    double                   spread_sum_ = 0;
+    CollectStats             stats_;
+};
+
+} // namespace micro_exchange::sim
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <cstdint>
+#include <cstddef>
+#include <array>
+#include <optional>
 #include <vector>
 #include <random>
 #include <cmath>
@@ -40,8 +43,167 @@ namespace micro_exchange::sim {
  * the stylized facts we verify: volatility clustering, fat tails in returns,
  * and time-varying spread behavior.
  *
- * Simulation algorithm: Ogata's thinning method (Ogata, 1981).
+ * Simulation algorithm: Ogata's thinning method (Ogata, 1981), on the
+ * exponential kernel's recursion: the excitation sum decays as a whole,
+ *
+ *   E(t) = E(s) · exp(-β · (t - s)),   E += α at each event,
+ *
+ * so one state variable replaces the walk back over past events and each
+ * thinning step is O(1) however clustered the flow gets.
+ *
+ * Events are pulled one at a time with next() / next_sided(), so a
+ * consumer (Simulator) never holds the whole sequence; generate() and
+ * generate_sided() still build the vector for callers that want one.
+ * MultivariateHawkes<D> is the engine underneath, with D mutually exciting
+ * dimensions; BuySellHawkes is its two-sided (buy/sell cross-excitation)
+ * form.
  */
+
+template <size_t D>
+class MultivariateHawkes {
+public:
+    /// λ_i(t) = μ_i + Σ_j Σ_{t_k in j} α_ij · exp(-β_i · (t - t_k)). Each
+    /// dimension decays at its own β_i, which keeps the state one number per
+    /// dimension (O(D) per event rather than O(D²)).
+    struct Parameters {
+        std::array<double, D>                    mu{};
+        std::array<std::array<double, D>, D>     alpha{};   // alpha[i][j]: j's event excites i
+        std::array<double, D>                    beta{};
+
+        /// Spectral radius of the branching matrix α_ij / β_i (≥ 1: explosive).
+        /// Exact for D ≤ 2; power iteration beyond.
+        [[nodiscard]] double branching_ratio() const {
+            if constexpr (D == 1) {
+                return alpha[0][0] / beta[0];
+            } else if constexpr (D == 2) {
+                const double a = alpha[0][0] / beta[0], b = alpha[0][1] / beta[0];
+                const double c = alpha[1][0] / beta[1], d = alpha[1][1] / beta[1];
+                const double tr = a + d, det = a * d - b * c;
+                const double disc = std::sqrt(std::max(0.0, tr * tr / 4 - det));
+                return tr / 2 + disc;
+            } else {
+                std::array<double, D> v;
+                v.fill(1.0);
+                double r = 0;
+                for (int it = 0; it < 200; ++it) {
+                    std::array<double, D> w{};
+                    for (size_t i = 0; i < D; ++i)
+                        for (size_t j = 0; j < D; ++j) w[i] += alpha[i][j] / beta[i] * v[j];
+                    r = *std::max_element(w.begin(), w.end());
+                    if (r <= 0) return 0;
+                    for (size_t i = 0; i < D; ++i) v[i] = w[i] / r;
+                }
+                return r;
+            }
+        }
+        [[nodiscard]] bool is_stationary() const { return branching_ratio() < 1.0; }
+    };
+
+    struct Event {
+        double timestamp;
+        size_t dim;
+    };
+
+    explicit MultivariateHawkes(Parameters params, uint64_t seed = 42)
+        : params_(params)
+        , rng_(seed)
+        , exp_dist_(1.0)
+        , uniform_(0.0, 1.0)
+    {
+        const double n = params_.branching_ratio();
+        if (n >= 1.0) {
+            // Force stationarity by scaling every alpha down to n = 0.95
+            for (auto& row : params_.alpha)
+                for (auto& a : row) a *= 0.95 / n;
+        }
+    }
+
+    /**
+     * Next event strictly before `horizon`, or nullopt if there is none. In
+     * that case the process is advanced to `horizon` (memorylessness makes
+     * this exact), so calling again with a later horizon continues the same
+     * path in chunks.
+     */
+    std::optional<Event> next(double horizon) {
+        while (t_ < horizon) {
+            // Intensity only decays between events: its current value bounds it.
+            double lambda_bar = 0;
+            for (size_t i = 0; i < D; ++i) lambda_bar += params_.mu[i] + excitation_[i];
+
+            const double t = t_ + exp_dist_(rng_) / lambda_bar;
+            if (t >= horizon) {
+                decay_to(horizon);
+                return std::nullopt;
+            }
+            decay_to(t);
+
+            double lambda = 0;
+            for (size_t i = 0; i < D; ++i) lambda += params_.mu[i] + excitation_[i];
+
+            // Accept/reject (thinning)
+            const double u = uniform_(rng_) * lambda_bar;
+            if (u > lambda) continue;
+
+            // Accepted: u / λ(t) is uniform on [0,1), and picks the dimension.
+            size_t dim = 0;
+            if constexpr (D > 1) {
+                double acc = params_.mu[0] + excitation_[0];
+                while (dim + 1 < D && u >= acc) {
+                    ++dim;
+                    acc += params_.mu[dim] + excitation_[dim];
+                }
+            }
+            for (size_t i = 0; i < D; ++i) excitation_[i] += params_.alpha[i][dim];
+            return Event{t, dim};
+        }
+        return std::nullopt;
+    }
+
+    /// Add `jump` to dimension `i`'s excitation at the current time: an event
+    /// from outside the process (another symbol's, applied at a barrier)
+    /// that then decays at β_i like the process's own.
+    void excite(size_t i, double jump) noexcept { excitation_[i] += jump; }
+
+    /// Current time and intensity of dimension `i` (μ_i + decayed excitation).
+    [[nodiscard]] double time() const noexcept { return t_; }
+    [[nodiscard]] double intensity(size_t i = 0) const noexcept { return params_.mu[i] + excitation_[i]; }
+
+    [[nodiscard]] const Parameters& params() const { return params_; }
+
+private:
+    void decay_to(double t) {
+        const double dt = t - t_;
+        for (size_t i = 0; i < D; ++i) excitation_[i] *= std::exp(-params_.beta[i] * dt);
+        t_ = t;
+    }
+
+    Parameters params_;
+    std::mt19937_64 rng_;
+    std::exponential_distribution<double> exp_dist_;
+    std::uniform_real_distribution<double> uniform_;
+    double t_ = 0;
+    std::array<double, D> excitation_{};
+};
+
+/**
+ * BuySellHawkes — buys (dim 0) and sells (dim 1) exciting themselves and
+ * each other: a buy raises the buy intensity by alpha_self and the sell
+ * intensity by alpha_cross. Flow imbalance episodes come out of the
+ * process itself rather than a side coin.
+ */
+class BuySellHawkes : public MultivariateHawkes<2> {
+public:
+    using MultivariateHawkes<2>::MultivariateHawkes;
+
+    static Parameters symmetric(double mu, double alpha_self, double alpha_cross, double beta) {
+        Parameters p;
+        p.mu    = {mu, mu};
+        p.alpha = {{{alpha_self, alpha_cross}, {alpha_cross, alpha_self}}};
+        p.beta  = {beta, beta};
+        return p;
+    }
+};
+
 class HawkesProcess {
 public:
     struct Parameters {
@@ -54,15 +216,17 @@ public:
     };
 
     explicit HawkesProcess(Parameters params, uint64_t seed = 42)
-        : params_(params)
-        , rng_(seed)
-        , exp_dist_(1.0)
+        : params_(stationary(params))
+        , engine_(engine_params(params_), seed)
+        , side_rng_(seed ^ 0x9E3779B97F4A7C15ull)
         , uniform_(0.0, 1.0)
-    {
-        if (!params_.is_stationary()) {
-            // Force stationarity by capping alpha
-            params_.alpha = params_.beta * 0.95;
-        }
+    {}
+
+    /// Next event time before `horizon` (see MultivariateHawkes::next).
+    std::optional<double> next(double horizon) {
+        auto e = engine_.next(horizon);
+        if (!e) return std::nullopt;
+        return e->timestamp;
     }
 
     /**
@@ -74,31 +238,7 @@ public:
     std::vector<double> generate(double duration) {
         std::vector<double> events;
         events.reserve(static_cast<size_t>(duration * params_.mu * 2));
-
-        double t = 0.0;
-        double intensity = params_.mu;
-
-        while (t < duration) {
-            // Upper bound on intensity (current value)
-            double lambda_bar = intensity;
-
-            // Generate candidate time (exponential with rate lambda_bar)
-            double dt = exp_dist_(rng_) / lambda_bar;
-            t += dt;
-
-            if (t >= duration) break;
-
-            // Decay existing intensity
-            intensity = compute_intensity(t, events);
-
-            // Accept/reject (thinning)
-            if (uniform_(rng_) <= intensity / lambda_bar) {
-                events.push_back(t);
-                // Self-excitation: intensity jumps by alpha
-                intensity += params_.alpha;
-            }
-        }
-
+        while (auto t = next(duration)) events.push_back(*t);
         return events;
     }
 
@@ -111,52 +251,53 @@ public:
         bool   is_buy;
     };
 
+    /// Next event with a side. Sides are persistent rather than excited:
+    /// a follow-up keeps the last side with probability 0.6 (models informed
+    /// flow persistence); BuySellHawkes is the cross-excited alternative.
+    std::optional<SidedEvent> next_sided(double horizon, double buy_bias = 0.5) {
+        auto t = next(horizon);
+        if (!t) return std::nullopt;
+        constexpr double persistence = 0.6;   // Probability of same-side follow-up
+        if (!(uniform_(side_rng_) < persistence)) last_side_ = uniform_(side_rng_) < buy_bias;
+        return SidedEvent{*t, last_side_};
+    }
+
     std::vector<SidedEvent> generate_sided(double duration, double buy_bias = 0.5) {
-        auto times = generate(duration);
         std::vector<SidedEvent> events;
-        events.reserve(times.size());
-
-        // Introduce autocorrelation in buy/sell direction
-        // (models informed flow persistence)
-        bool last_side = true;
-        double persistence = 0.6;  // Probability of same-side follow-up
-
-        for (double t : times) {
-            bool is_buy;
-            if (uniform_(rng_) < persistence) {
-                is_buy = last_side;  // Follow previous direction
-            } else {
-                is_buy = uniform_(rng_) < buy_bias;
-            }
-            events.push_back({t, is_buy});
-            last_side = is_buy;
-        }
-
+        events.reserve(static_cast<size_t>(duration * params_.mu * 2));
+        while (auto e = next_sided(duration, buy_bias)) events.push_back(*e);
         return events;
     }
 
+    /// See MultivariateHawkes::excite.
+    void excite(double jump) noexcept { engine_.excite(0, jump); }
+
+    [[nodiscard]] double intensity() const noexcept { return engine_.intensity(); }
     [[nodiscard]] const Parameters& params() const { return params_; }
 
 private:
-    double compute_intensity(double t, const std::vector<double>& events) const {
-        double intensity = params_.mu;
-
-        // Sum over recent events (optimization: only look back a few decay times)
-        double lookback = 5.0 / params_.beta;  // ~99.3% of excitation decayed
-
-        for (auto it = events.rbegin(); it != events.rend(); ++it) {
-            double dt = t - *it;
-            if (dt > lookback) break;
-            intensity += params_.alpha * std::exp(-params_.beta * dt);
+    static Parameters stationary(Parameters p) {
+        if (!p.is_stationary()) {
+            // Force stationarity by capping alpha
+            p.alpha = p.beta * 0.95;
         }
-
-        return intensity;
+        return p;
+    }
+    static MultivariateHawkes<1>::Parameters engine_params(const Parameters& p) {
+        MultivariateHawkes<1>::Parameters e;
+        e.mu[0] = p.mu;
+        e.alpha[0][0] = p.alpha;
+        e.beta[0] = p.beta;
+        return e;
     }
 
     Parameters params_;
-    std::mt19937_64 rng_;
-    std::exponential_distribution<double> exp_dist_;
+    MultivariateHawkes<1> engine_;
+    // Sides draw from their own stream, so the event times for a seed don't
+    // depend on whether sides are asked for.
+    std::mt19937_64 side_rng_;
     std::uniform_real_distribution<double> uniform_;
+    bool last_side_ = true;
 };
 
 } // namespace micro_exchange::sim
@@ -0,0 +1,262 @@
+#pragma once
+
+#include "Simulator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <cmath>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace micro_exchange::sim {
+
+/**
+ * MultiSymbolSimulator — many instruments, each with its own Hawkes stream
+ * and agent population, spread over worker threads.
+ *
+ * Symbols are dealt round-robin to `threads` workers, the placement
+ * ShardedMatchingEngine uses. Each worker is a shard: one
+ * BasicMatchingEngine holding its symbols' books. Unlike the ring-fed
+ * sharded engine, a worker also generates its symbols' flow (a
+ * Simulator::Flow per symbol), so order generation scales with the matching
+ * and each agent reads its own book without crossing threads.
+ *
+ * Time advances in slices of `slice_sec` simulated seconds. Every worker
+ * runs each of its symbols up to the slice boundary and then waits at a
+ * barrier. With `cross_alpha` > 0, every event excites every other symbol:
+ * at each barrier a symbol's intensity jumps by cross_alpha / (N - 1) per
+ * event the other symbols had in the slice just finished, and then decays
+ * at its own β. A market-wide burst therefore spreads to every symbol one
+ * slice later. A symbol's path depends only on its seed and on those
+ * barrier-published counts, never on which thread ran it or when. Results
+ * are bitwise identical for any thread count (timings aside).
+ */
+class MultiSymbolSimulator {
+public:
+    struct Config {
+        Simulator::Config base;           // per-symbol template (symbol name, seed overridden)
+        size_t   symbols     = 16;
+        size_t   threads     = 0;         // 0 = std::thread::hardware_concurrency()
+        uint64_t seed        = 1;         // symbol i is seeded seed + i
+        double   slice_sec   = 0.1;       // barrier interval, simulated seconds
+        double   cross_alpha = 0.0;       // excitation one event adds across all other symbols;
+                                          // keep (alpha + cross_alpha) / beta below 1
+        bool     pin_threads = false;     // pin worker i to core (first_core + i)
+        unsigned first_core  = 0;
+    };
+
+    struct SymbolResult {
+        std::string symbol;
+        size_t   thread   = 0;
+        uint64_t events   = 0;
+        uint64_t trades   = 0;
+        uint64_t volume   = 0;
+        uint64_t cancels  = 0;
+        uint64_t peak_live_orders = 0;
+        double   mean_spread   = 0;
+        double   mid_change_sd = 0;
+        Price    final_mid     = 0;
+        double   busy_sec      = 0;   // worker time spent on this symbol
+
+        [[nodiscard]] double events_per_sec() const noexcept {
+            return busy_sec > 0 ? static_cast<double>(events) / busy_sec : 0;
+        }
+    };
+
+    struct Result {
+        std::vector<SymbolResult> symbols;   // symbol order
+        uint64_t events  = 0;
+        uint64_t trades  = 0;
+        uint64_t volume  = 0;
+        uint64_t cancels = 0;
+        uint64_t slices  = 0;
+        size_t   threads = 0;
+        double   elapsed_sec = 0;            // wall clock, setup included
+        double   barrier_wait_sec = 0;       // summed over workers
+
+        [[nodiscard]] double events_per_sec() const noexcept {
+            return elapsed_sec > 0 ? static_cast<double>(events) / elapsed_sec : 0;
+        }
+    };
+
+    explicit MultiSymbolSimulator(Config cfg) : cfg_(std::move(cfg)) {}
+
+    /// Symbol i's per-symbol config: name SYM0001.., seed `seed + i`.
+    [[nodiscard]] Simulator::Config symbol_config(size_t i) const {
+        Simulator::Config c = cfg_.base;
+        char name[16];
+        std::snprintf(name, sizeof(name), "SYM%04zu", i + 1);
+        c.symbol = name;
+        c.seed   = cfg_.seed + i;
+        c.collect = CollectOptions{};   // per-symbol stats only; no series
+        return c;
+    }
+
+    Result run() {
+        return cfg_.base.book_backend == Simulator::BookBackend::Array ? run_on<ArrayOrderBook>()
+                                                                      : run_on<OrderBook>();
+    }
+
+private:
+    // Flows keep their O(1) CollectStats; nothing is recorded per event.
+    struct NullSink {
+        void sample(double, Price, Price) {}
+        void bar(const Bar&) {}
+        void trade(const TradeSample&) {}
+        void print(const Trade&) {}
+    };
+
+    template <OrderBookLike Book>
+    Result run_on() {
+        using Engine = BasicMatchingEngine<Book>;
+        using Flow   = Simulator::Flow<Engine, NullSink>;
+
+        const auto start = std::chrono::steady_clock::now();
+        const size_t n = cfg_.symbols;
+        size_t threads = cfg_.threads ? cfg_.threads : std::thread::hardware_concurrency();
+        threads = std::max<size_t>(1, std::min(threads, n));
+        const double slice = cfg_.slice_sec > 0 ? cfg_.slice_sec : cfg_.base.duration;
+        const auto slices = static_cast<uint64_t>(std::ceil(cfg_.base.duration / slice));
+        const double jump = n > 1 ? cfg_.cross_alpha / static_cast<double>(n - 1) : 0;
+
+        Result res;
+        res.symbols.resize(n);
+        res.threads = threads;
+        res.slices  = slices;
+
+        // Events per symbol in a slice, double-buffered: slice k writes
+        // counts[k & 1] and reads the complete counts[(k - 1) & 1].
+        std::vector<uint64_t> counts[2] = {std::vector<uint64_t>(n, 0), std::vector<uint64_t>(n, 0)};
+        std::barrier sync(static_cast<std::ptrdiff_t>(threads));
+        std::atomic<bool> failed{false};
+        std::exception_ptr error;
+        std::mutex error_lock;
+        std::vector<double> waited(threads, 0);
+
+        auto worker = [&](size_t w) {
+            // Built on the worker thread, so books and arenas are first
+            // touched by the core that matches on them.
+            std::vector<size_t> owned;
+            for (size_t i = w; i < n; i += threads) owned.push_back(i);
+            std::vector<Simulator::Config> cfgs;
+            std::unique_ptr<Engine> engine;
+            std::vector<std::unique_ptr<Flow>> flows;
+            std::vector<double> busy(owned.size(), 0);
+            NullSink sink;
+            try {
+                engine = std::make_unique<Engine>();
+                cfgs.reserve(owned.size());
+                for (size_t i : owned) cfgs.push_back(symbol_config(i));
+                for (auto& c : cfgs)
+                    flows.push_back(std::make_unique<Flow>(c, *engine, Simulator::add_book(*engine, c), sink));
+            } catch (...) {
+                fail(failed, error, error_lock);
+            }
+
+            for (uint64_t k = 0; k < slices; ++k) {
+                if (!failed.load(std::memory_order_relaxed)) {
+                    try {
+                        const double horizon = std::min(cfg_.base.duration, static_cast<double>(k + 1) * slice);
+                        const auto& prev = counts[(k + 1) & 1];
+                        auto& cur = counts[k & 1];
+                        uint64_t total = 0;
+                        if (jump > 0 && k > 0) for (uint64_t c : prev) total += c;
+                        for (size_t j = 0; j < owned.size(); ++j) {
+                            const size_t i = owned[j];
+                            Flow& f = *flows[j];
+                            if (jump > 0 && k > 0) f.excite(jump * static_cast<double>(total - prev[i]));
+                            const uint64_t before = f.events();
+                            const auto t0 = std::chrono::steady_clock::now();
+                            f.advance(horizon);
+                            busy[j] += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+                            cur[i] = f.events() - before;
+                        }
+                    } catch (...) {
+                        fail(failed, error, error_lock);
+                    }
+                }
+                const auto t0 = std::chrono::steady_clock::now();
+                sync.arrive_and_wait();
+                waited[w] += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            }
+            if (failed.load(std::memory_order_relaxed)) return;
+
+            for (size_t j = 0; j < flows.size(); ++j) {
+                Flow& f = *flows[j];
+                f.finish();
+                const CollectStats& c = f.stats();
+                SymbolResult& r = res.symbols[owned[j]];
+                r.symbol  = cfgs[j].symbol;
+                r.thread  = w;
+                r.events  = f.events();
+                r.trades  = c.trades;
+                r.volume  = c.volume;
+                r.cancels = f.cancels();
+                r.peak_live_orders = f.live().peak();
+                r.mean_spread   = c.spread.mean;
+                r.mid_change_sd = c.mid_change.stddev();
+                r.final_mid     = c.last_mid;
+                r.busy_sec      = busy[j];
+            }
+        };
+
+        if (threads == 1) {
+            worker(0);
+        } else {
+            std::vector<std::thread> pool;
+            pool.reserve(threads);
+            for (size_t t = 0; t < threads; ++t) {
+                pool.emplace_back(worker, t);
+                if (cfg_.pin_threads) pin(pool.back(), t);
+            }
+            for (auto& t : pool) t.join();
+        }
+        if (error) std::rethrow_exception(error);
+
+        for (const auto& r : res.symbols) {
+            res.events  += r.events;
+            res.trades  += r.trades;
+            res.volume  += r.volume;
+            res.cancels += r.cancels;
+        }
+        for (double w : waited) res.barrier_wait_sec += w;
+        res.elapsed_sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return res;
+    }
+
+    // A failed worker keeps arriving at the barrier (so the others don't
+    // hang) but stops simulating; the first exception is rethrown by run().
+    static void fail(std::atomic<bool>& failed, std::exception_ptr& error, std::mutex& lock) {
+        std::lock_guard<std::mutex> g(lock);
+        if (!error) error = std::current_exception();
+        failed.store(true, std::memory_order_relaxed);
+    }
+
+    void pin([[maybe_unused]] std::thread& t, [[maybe_unused]] size_t worker) const {
+#ifdef __linux__
+        unsigned n = std::thread::hardware_concurrency();
+        if (n == 0) return;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET((cfg_.first_core + worker) % n, &set);
+        pthread_setaffinity_np(t.native_handle(), sizeof(set), &set);
+#endif
+    }
+
+    Config cfg_;
+};
+
+} // namespace micro_exchange::sim
@@ -0,0 +1,188 @@
+#pragma once
+
+#include "Simulator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace micro_exchange::sim {
+
+/**
+ * What one Simulator run reduces to, from the run's CollectStats. The batch
+ * keeps only these: a run's SimulationData (trades, mid and spread series)
+ * is dropped as soon as the run finishes.
+ */
+struct RunSummary {
+    uint64_t run    = 0;
+    uint64_t seed   = 0;
+    uint64_t orders = 0;
+    uint64_t trades = 0;
+    uint64_t volume = 0;
+    uint64_t cancels = 0;
+    double   mean_spread   = 0;   // ticks, per event
+    double   mid_change_sd = 0;   // ticks, event-to-event midprice change
+    double   vwap          = 0;   // ticks
+    double   buy_aggressor = 0;   // fraction of trades a buyer initiated
+    Price    final_mid     = 0;
+    double   wall_time_sec = 0;   // the only field that isn't a function of the seed
+
+    static RunSummary of(const Simulator::SimulationData& d, uint64_t run, uint64_t seed) {
+        const CollectStats& c = d.collected;
+        RunSummary r;
+        r.run     = run;
+        r.seed    = seed;
+        r.orders  = d.total_orders;
+        r.trades  = c.trades;
+        r.volume  = c.volume;
+        r.cancels = d.total_cancels;
+        r.wall_time_sec = d.wall_time_sec;
+        r.mean_spread   = c.spread.mean;
+        r.mid_change_sd = c.mid_change.stddev();
+        r.final_mid     = c.last_mid;
+        r.vwap = c.volume ? c.notional / static_cast<double>(c.volume) : 0;
+        r.buy_aggressor = c.trades ? static_cast<double>(c.buy_trades) / static_cast<double>(c.trades) : 0;
+        return r;
+    }
+};
+
+/**
+ * SimulationBatch — many independent Simulator runs across a thread pool.
+ *
+ * Run i gets its own Simulator (and with it its own engine, order arena,
+ * agents and Hawkes process) seeded with base_seed + i; `configure` can
+ * also vary its parameters for a sweep. Workers take the next run index
+ * from a shared counter, so the pool stays busy however uneven the runs.
+ *
+ * Results are reduced as they stream in, but strictly in run order: a
+ * finished run waits in its slot until every run before it has been
+ * folded into the Summary (and passed to `on_run`). Every run depends only
+ * on its seed and config, and the merge order is fixed, so the Summary is
+ * bitwise identical for any thread count (wall times aside).
+ */
+class SimulationBatch {
+public:
+    struct Options {
+        size_t   runs      = 1;
+        size_t   threads   = 0;   // 0 = std::thread::hardware_concurrency()
+        uint64_t base_seed = 1;   // run i uses base_seed + i (seed 0 = Simulator's fixed seeds)
+
+        // Per-run parameter override (sweeps); called on the worker thread.
+        std::function<void(size_t run, Simulator::Config&)> configure;
+    };
+
+    struct Summary {
+        uint64_t runs    = 0;
+        uint64_t orders  = 0;
+        uint64_t trades  = 0;
+        uint64_t volume  = 0;
+        uint64_t cancels = 0;
+
+        // Distribution of the per-run figures across runs.
+        StreamingStat trades_per_run;
+        StreamingStat mean_spread;
+        StreamingStat mid_change_sd;
+        StreamingStat vwap;
+        StreamingStat buy_aggressor;
+        StreamingStat final_mid;
+
+        double run_time_sec = 0;   // summed over runs (CPU-ish)
+        double elapsed_sec  = 0;   // wall clock for the whole batch
+        size_t threads      = 0;
+
+        void add(const RunSummary& r) {
+            ++runs;
+            orders  += r.orders;
+            trades  += r.trades;
+            volume  += r.volume;
+            cancels += r.cancels;
+            trades_per_run.add(static_cast<double>(r.trades));
+            mean_spread.add(r.mean_spread);
+            mid_change_sd.add(r.mid_change_sd);
+            vwap.add(r.vwap);
+            buy_aggressor.add(r.buy_aggressor);
+            final_mid.add(static_cast<double>(r.final_mid));
+            run_time_sec += r.wall_time_sec;
+        }
+    };
+
+    using OnRun = std::function<void(const RunSummary&)>;
+
+    SimulationBatch(Simulator::Config base, Options opts)
+        : base_(std::move(base)), opts_(std::move(opts)) {}
+
+    /**
+     * Execute every run and return the merged summary. `on_run` sees each
+     * run's summary in run order, under the reduction lock. The first
+     * exception a run throws stops the batch and is rethrown here.
+     */
+    Summary run(const OnRun& on_run = {}) {
+        const auto start = std::chrono::steady_clock::now();
+        const size_t n = opts_.runs;
+        size_t threads = opts_.threads ? opts_.threads : std::thread::hardware_concurrency();
+        threads = std::max<size_t>(1, std::min(threads, n));
+
+        Summary total;
+        std::vector<std::optional<RunSummary>> pending(n);
+        size_t merged = 0;
+        std::mutex lock;
+        std::atomic<size_t> next{0};
+        std::exception_ptr error;
+
+        auto worker = [&] {
+            for (;;) {
+                const size_t i = next.fetch_add(1, std::memory_order_relaxed);
+                if (i >= n) return;
+                try {
+                    Simulator::Config cfg = base_;
+                    cfg.seed = opts_.base_seed + i;
+                    if (opts_.configure) opts_.configure(i, cfg);
+                    const RunSummary r = RunSummary::of(Simulator(cfg).run(), i, cfg.seed);
+
+                    std::lock_guard<std::mutex> g(lock);
+                    pending[i] = r;
+                    for (; merged < n && pending[merged]; ++merged) {
+                        total.add(*pending[merged]);
+                        if (on_run) on_run(*pending[merged]);
+                        pending[merged].reset();
+                    }
+                } catch (...) {
+                    std::lock_guard<std::mutex> g(lock);
+                    if (!error) error = std::current_exception();
+                    next.store(n, std::memory_order_relaxed);
+                    return;
+                }
+            }
+        };
+
+        if (threads == 1) {
+            worker();
+        } else {
+            std::vector<std::thread> pool;
+            pool.reserve(threads);
+            for (size_t t = 0; t < threads; ++t) pool.emplace_back(worker);
+            for (auto& t : pool) t.join();
+        }
+        if (error) std::rethrow_exception(error);
+
+        total.threads = threads;
+        total.elapsed_sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return total;
+    }
+
+private:
+    Simulator::Config base_;
+    Options           opts_;
+};
+
+} // namespace micro_exchange::sim
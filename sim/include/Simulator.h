@@ -2,8 +2,9 @@
 
 #include "HawkesProcess.h"
 #include "ZIAgent.h"
+#include "AgentOrders.h"
+#include "DataCollector.h"
 #include "MatchingEngine.h"
-#include "FeedPublisher.h"
 
 #include <string>
 #include <vector>
@@ -14,27 +15,54 @@
 #include <numeric>
 #include <cmath>
 #include <algorithm>
+#include <optional>
+#include <type_traits>
 
 namespace micro_exchange::sim {
 
 using namespace micro_exchange::core;
-using namespace micro_exchange::md;
 
 // Full pipeline: hawkes events -> ZI agents -> matching -> feed -> analytics
-// Took a while to get the cancellation logic right, kept getting stale orders
-// clogging the book in early versions. Current approach is "good enough" but
-// not how a real exchange handles it (they track per-session order lists).
+// Each agent keeps its own list of resting orders (AgentOrders), the way a
+// session tracks its open orders, and cancels from it by the ZI rule; the
+// book's order listener drops fills and cancels from the lists.
 class Simulator {
 public:
+    // Which order-book implementation backs the engine. Both produce the same
+    // trade stream; the array book is the faster one on the matching path.
+    enum class BookBackend : uint8_t { Map, Array };
+
     struct Config {
         std::string symbol     = "AAPL";
         double      duration   = 3600.0;
         Price       init_price = 15000;
         size_t      num_agents = 10;
 
+        BookBackend book_backend   = BookBackend::Map;
+        Price       array_half_band = 1024;   // initial band is init_price ± this
+        size_t      order_capacity  = 65536;  // pre-sizes the book's order index + arena
+        ArenaOptions arena;                   // order-arena backing (mmap / huge pages / prefault)
+
+        // RNG streams: 0 keeps the historical fixed seeds (agents 42 + i,
+        // Hawkes 12345); anything else derives an independent stream per
+        // agent and for the Hawkes process from it (see stream_seed).
+        uint64_t    seed = 0;
+
+        // Each resting agent order is reviewed for cancellation about once
+        // per this many events, a slice at a time (see AgentOrders::review).
+        double      cancel_interval = 50.0;
+
         HawkesProcess::Parameters hawkes_params;
         ZIAgent::Parameters agent_params;
 
+        // Set: order sides come from a cross-exciting buy/sell Hawkes process
+        // instead of hawkes_params with persistent sides.
+        std::optional<BuySellHawkes::Parameters> buy_sell;
+
+        // What's recorded and where: in memory (default) or streamed to
+        // column files, per event / decimated / as bars (DataCollector.h).
+        CollectOptions collect;
+
         Config() {
             hawkes_params.mu = 50.0;
             hawkes_params.alpha = 35.0;
@@ -48,119 +76,233 @@ public:
         }
     };
 
-    // Collected data for downstream analytics
+    // Collected data for downstream analytics. With collect.dir set the
+    // vectors stay empty (the series are in column files there); with
+    // collect.bar_sec set the event series are replaced by `bars`.
     struct SimulationData {
         std::vector<Trade> trades;
         std::vector<Price> midprices;         // Time series of midpoints
         std::vector<Price> quoted_spreads;    // Spread at each event
         std::vector<double> event_times;      // Hawkes timestamps
+        std::vector<Bar>   bars;
 
         // Per-trade analytics inputs
         struct TradeRecord {
             Price  trade_price;
             Price  mid_before;
-            Price  mid_after_1s;   // Midpoint ~1 second later
-            Price  mid_after_5s;
+            Price  mid_after_1s;   // Mid horizon_short (1 s) later
+            Price  mid_after_5s;   // Mid horizon_long (5 s) later
             Quantity volume;
             Side   aggressor;
         };
         std::vector<TradeRecord> trade_records;
 
+        // Whole-run figures, kept in every collection mode
+        CollectStats collected;
+        bool         columns_ok = true;   // every column write succeeded
+
         // Engine stats
         uint64_t total_orders  = 0;
         uint64_t total_cancels = 0;
+        uint64_t peak_live_orders = 0;   // most agent orders resting at once
+        uint64_t live_orders      = 0;   // agent orders still resting at the end
         double   wall_time_sec = 0;
     };
 
     explicit Simulator(Config config = {}) : config_(config) {}
 
+    /// Seed for RNG stream `stream` of run `seed` (stream 0 = Hawkes, 1 + i =
+    /// agent i). splitmix64 of both, so nearby seeds and streams don't give
+    /// correlated mt19937_64 states.
+    static uint64_t stream_seed(uint64_t seed, uint64_t stream) noexcept {
+        uint64_t z = seed * 0x9E3779B97F4A7C15ull + stream + 1;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
     /**
      * Run full simulation and return collected data.
      */
     SimulationData run() {
-        auto wall_start = std::chrono::high_resolution_clock::now();
-        SimulationData data;
+        return config_.book_backend == BookBackend::Array ? run_on<ArrayOrderBook>()
+                                                          : run_on<OrderBook>();
+    }
 
-        // ── Setup ──
-        MatchingEngine engine;
-        engine.add_symbol(config_.symbol);
-        auto* book = engine.get_book(config_.symbol);
-
-        FeedPublisher feed;
-        feed.attach(*book);
-
-        // Initialize agents
-        std::vector<ZIAgent> agents;
-        for (size_t i = 0; i < config_.num_agents; ++i) {
-            auto params = config_.agent_params;
-            params.agent_id = i;
-            agents.emplace_back(params, 42 + i);
+    /// Register `cfg.symbol` on `engine` with the book sizing from `cfg`.
+    template <typename Engine>
+    static SymbolId add_book(Engine& engine, const Config& cfg) {
+        if constexpr (std::is_same_v<typename Engine::book_type, ArrayOrderBook>) {
+            engine.add_symbol(cfg.symbol,
+                              cfg.init_price - cfg.array_half_band,
+                              cfg.init_price + cfg.array_half_band,
+                              cfg.order_capacity, cfg.arena);
+        } else {
+            engine.add_symbol(cfg.symbol, cfg.order_capacity, cfg.arena);
         }
+        return engine.symbol_id(cfg.symbol);
+    }
 
-        // Collect trades
-        engine.set_trade_callback([&](const Trade& trade) {
-            data.trades.push_back(trade);
-        });
+    /**
+     * One symbol's closed loop: its Hawkes stream says when and which side,
+     * a ZI agent what, the order goes into `engine`, and the agents' resting
+     * orders are tracked and reviewed for cancellation. Trades and the
+     * per-event book state go to a DataCollector over `sink` (sample / bar /
+     * trade as in DataCollector, plus print(const Trade&) for the raw trade).
+     *
+     * advance(t) runs every event before simulated time t, so run() drives
+     * one Flow straight through while MultiSymbolSimulator steps many in
+     * lockstep. The book must already be on `engine`; the constructor seeds
+     * it. Listeners capture the Flow, so it never moves.
+     */
+    template <typename Engine, typename Sink>
+    class Flow {
+    public:
+        Flow(const Config& cfg, Engine& engine, SymbolId sym, Sink& sink)
+            : cfg_(cfg)
+            , engine_(engine)
+            , sym_(sym)
+            , book_(engine.get_book(sym))
+            , sink_(sink)
+            , collector_(cfg.collect, sink)
+            , live_(cfg.num_agents)
+            , review_rate_(static_cast<double>(cfg.num_agents) / std::max(1.0, cfg.cancel_interval))
+            , review_credit_(cfg.num_agents, 0.0)
+            , hawkes_(cfg.hawkes_params, hawkes_seed(cfg))
+        {
+            for (size_t i = 0; i < cfg.num_agents; ++i) {
+                auto params = cfg.agent_params;
+                params.agent_id = i;
+                agents_.emplace_back(params, cfg.seed ? stream_seed(cfg.seed, 1 + i) : 42 + i);
+            }
+            if (cfg.buy_sell) buy_sell_.emplace(*cfg.buy_sell, hawkes_seed(cfg));
+
+            // Resting orders per agent; an order leaves its list the moment
+            // the book reports it filled or cancelled.
+            book_->add_order_listener([this](const Order& o) {
+                if (!o.is_active()) live_.remove(o.id);
+            });
+            book_->add_trade_listener([this](const Trade& trade) {
+                sink_.print(trade);
+                collector_.trade(event_time_, trade, mid_before_);
+            });
+            seed_book(engine, cfg.symbol, cfg.init_price);
+        }
 
-        // ── Seed the book ──
-        seed_book(engine, config_.symbol, config_.init_price);
+        Flow(const Flow&) = delete;
+        Flow& operator=(const Flow&) = delete;
 
-        // ── Generate event times ──
-        HawkesProcess hawkes(config_.hawkes_params, 12345);
-        auto events = hawkes.generate_sided(config_.duration);
-        data.event_times.reserve(events.size());
+        /// Process every event before simulated time `horizon`.
+        void advance(double horizon) {
+            while (auto next = next_event(horizon)) step(*next);
+        }
 
-        // ── Process events ──
-        OrderId next_id = 10000;
+        /// An outside kick to the arrival intensity (cross-symbol excitation).
+        void excite(double jump) {
+            if (buy_sell_) { buy_sell_->excite(0, jump / 2); buy_sell_->excite(1, jump / 2); }
+            else hawkes_.excite(jump);
+        }
 
-        for (size_t idx = 0; idx < events.size(); ++idx) {
-            const auto& event = events[idx];
-            data.event_times.push_back(event.timestamp);
+        void finish() { collector_.finish(); }
 
-            auto mid = book->midprice().value_or(config_.init_price);
-            auto sprd = book->spread().value_or(2);
+        [[nodiscard]] uint64_t events()  const noexcept { return events_; }
+        [[nodiscard]] uint64_t cancels() const noexcept { return cancels_; }
+        [[nodiscard]] const AgentOrders&  live()  const noexcept { return live_; }
+        [[nodiscard]] const CollectStats& stats() const noexcept { return collector_.stats(); }
 
-            data.midprices.push_back(mid);
-            data.quoted_spreads.push_back(sprd);
+    private:
+        static uint64_t hawkes_seed(const Config& cfg) {
+            return cfg.seed ? stream_seed(cfg.seed, 0) : 12345;
+        }
+
+        std::optional<HawkesProcess::SidedEvent> next_event(double horizon) {
+            if (!buy_sell_) return hawkes_.next_sided(horizon);
+            auto e = buy_sell_->next(horizon);
+            if (!e) return std::nullopt;
+            return HawkesProcess::SidedEvent{e->timestamp, e->dim == 0};
+        }
+
+        void step(const HawkesProcess::SidedEvent& event) {
+            event_time_ = event.timestamp;
+
+            auto mid = book_->midprice().value_or(cfg_.init_price);
+            auto sprd = book_->spread().value_or(2);
+            collector_.event(event_time_, mid, sprd);
 
             // Select agent
-            size_t agent_idx = next_id % config_.num_agents;
-            auto& agent = agents[agent_idx];
+            size_t agent_idx = next_id_ % cfg_.num_agents;
+            auto& agent = agents_[agent_idx];
 
             // Record pre-trade midpoint for impact analysis
-            Price mid_before = mid;
-
-            // Generate and submit order
-            auto req = agent.generate_order(mid, sprd, event.is_buy, next_id++,
-                                             config_.symbol.c_str());
-            size_t trades_before = data.trades.size();
-            engine.submit_order(req);
-
-            // If a trade occurred, record analytics
-            if (data.trades.size() > trades_before) {
-                Price mid_after = book->midprice().value_or(mid_before);
-                for (size_t t = trades_before; t < data.trades.size(); ++t) {
-                    SimulationData::TradeRecord rec;
-                    rec.trade_price = data.trades[t].price;
-                    rec.mid_before = mid_before;
-                    rec.mid_after_1s = mid_after;  // Approximate
-                    rec.mid_after_5s = mid_after;  // Will refine in analytics
-                    rec.volume = data.trades[t].quantity;
-                    rec.aggressor = data.trades[t].aggressor;
-                    data.trade_records.push_back(rec);
-                }
-            }
-
-            // Periodic cancellation sweep
-            if (idx % 50 == 0) {
-                data.total_cancels += cancel_stale_orders(engine, agents, book, config_.symbol);
+            mid_before_ = mid;
+
+            // Generate and submit order; its trades reach the collector
+            auto req = agent.generate_order(mid, sprd, event.is_buy, next_id_++,
+                                             cfg_.symbol.c_str());
+            req.symbol_id = sym_;
+            const Order* placed = engine_.submit_order(req);
+            if (placed && placed->is_active()) live_.add(agent_idx, placed->id, placed->price);
+            ++events_;
+
+            // The agent reconsiders a slice of its resting orders: enough
+            // that each is looked at about once per cancel_interval events
+            // (fractional slices carry over to the agent's next turn).
+            double& credit = review_credit_[agent_idx];
+            credit += static_cast<double>(live_.size(agent_idx)) * review_rate_;
+            if (credit >= 1.0) {
+                const auto slice = static_cast<size_t>(credit);
+                credit -= static_cast<double>(slice);
+                const Price now_mid = book_->midprice().value_or(mid);
+                cancels_ += live_.review(agent_idx, slice, [&](const AgentOrders::Live& o) {
+                    return agent.should_cancel(o.price, now_mid)
+                        && engine_.cancel_order(CancelRequest{o.id, sym_, {}});
+                });
             }
         }
 
-        data.total_orders = events.size();
+        const Config&                 cfg_;
+        Engine&                       engine_;
+        SymbolId                      sym_;
+        typename Engine::book_type*   book_;
+        Sink&                         sink_;
+        DataCollector<Sink>           collector_;
+        std::vector<ZIAgent>          agents_;
+        AgentOrders                   live_;
+        double                        review_rate_;
+        std::vector<double>           review_credit_;
+        HawkesProcess                 hawkes_;
+        std::optional<BuySellHawkes>  buy_sell_;
+        OrderId                       next_id_    = 10000;
+        uint64_t                      events_     = 0;
+        uint64_t                      cancels_    = 0;
+        double                        event_time_ = 0;
+        Price                         mid_before_ = 0;
+    };
 
-        // Backfill mid_after_5s using forward-looking midprices
-        backfill_future_midprices(data);
+private:
+    template <OrderBookLike Book>
+    SimulationData run_on() {
+        auto wall_start = std::chrono::high_resolution_clock::now();
+        SimulationData data;
+
+        // ── Setup ──
+        BasicMatchingEngine<Book> engine;
+        const SymbolId sym_id = add_book(engine, config_);
+
+        // Collect: into `data`, or column files under collect.dir
+        Sink sink(data, config_.collect.dir);
+        Flow<BasicMatchingEngine<Book>, Sink> flow(config_, engine, sym_id, sink);
+
+        // ── Event stream: pulled one event at a time, never materialised ──
+        flow.advance(config_.duration);
+        flow.finish();
+
+        data.total_orders     = flow.events();
+        data.total_cancels    = flow.cancels();
+        data.peak_live_orders = flow.live().peak();
+        data.live_orders      = flow.live().size();
+        data.collected  = flow.stats();
+        data.columns_ok = sink.close();
 
         auto wall_end = std::chrono::high_resolution_clock::now();
         data.wall_time_sec = std::chrono::duration<double>(wall_end - wall_start).count();
@@ -168,11 +310,11 @@ public:
         return data;
     }
 
-private:
     /**
      * Seed the book with initial limit orders to create a reasonable spread.
      */
-    void seed_book(MatchingEngine& engine, const std::string& symbol, Price init_price) {
+    template <typename Engine>
+    static void seed_book(Engine& engine, const std::string& symbol, Price init_price) {
         // Place 10 levels of bids and asks
         for (int i = 1; i <= 10; ++i) {
             for (int j = 0; j < 5; ++j) {
@@ -203,51 +345,34 @@ private:
         }
     }
 
-    /**
-     * Cancel orders far from mid (strategic cancellation).
-     */
-    size_t cancel_stale_orders(MatchingEngine& engine, std::vector<ZIAgent>& agents,
-                                OrderBook* book, const std::string& symbol) {
-        // Simplified: in production we'd track agent → order mapping
-        // Here we just cancel a small random fraction
-        size_t cancelled = 0;
-        auto mid = book->midprice().value_or(config_.init_price);
-
-        // Get all active bid/ask levels
-        auto bids = book->get_bids(20);
-        auto asks = book->get_asks(20);
-
-        // Cancel orders at far-out levels
-        for (const auto& level : bids) {
-            if (std::abs(level.price - mid) > 15) {
-                // Would need order-level tracking; approximate here
-                ++cancelled;
-            }
+    // DataCollector sink: SimulationData in memory, or column files.
+    struct Sink {
+        SimulationData&           data;
+        std::optional<ColumnSink> columns;
+
+        Sink(SimulationData& d, const std::string& dir) : data(d) {
+            if (!dir.empty()) columns.emplace(dir);
         }
-        for (const auto& level : asks) {
-            if (std::abs(level.price - mid) > 15) {
-                ++cancelled;
-            }
+        void sample(double t, Price mid, Price spread) {
+            if (columns) return columns->sample(t, mid, spread);
+            data.event_times.push_back(t);
+            data.midprices.push_back(mid);
+            data.quoted_spreads.push_back(spread);
         }
-
-        return cancelled;
-    }
-
-    /**
-     * Backfill future midprices for realized spread calculation.
-     */
-    void backfill_future_midprices(SimulationData& data) {
-        if (data.midprices.empty() || data.trade_records.empty()) return;
-
-        // Approximate: for each trade, look ~100 events ahead for 1s,
-        // and ~500 events ahead for 5s (assuming ~100 events/sec)
-        for (size_t i = 0; i < data.trade_records.size(); ++i) {
-            size_t idx_1s = std::min(i + 100, data.midprices.size() - 1);
-            size_t idx_5s = std::min(i + 500, data.midprices.size() - 1);
-            data.trade_records[i].mid_after_1s = data.midprices[idx_1s];
-            data.trade_records[i].mid_after_5s = data.midprices[idx_5s];
+        void bar(const Bar& b) {
+            if (columns) return columns->bar(b);
+            data.bars.push_back(b);
         }
-    }
+        void print(const Trade& t) {
+            if (!columns) data.trades.push_back(t);
+        }
+        void trade(const TradeSample& s) {
+            if (columns) return columns->trade(s);
+            data.trade_records.push_back({s.price, s.mid_before, s.mid_after_short,
+                                          s.mid_after_long, s.quantity, s.aggressor});
+        }
+        bool close() { return !columns || columns->close(); }
+    };
 
     Config config_;
 };
@@ -119,12 +119,12 @@ public:
      */
     bool should_cancel(const Order& order, Price mid_price) {
         if (!order.is_active()) return false;
+        return should_cancel(order.price, mid_price);
+    }
 
-        Price distance = std::abs(order.price - mid_price);
-        double cancel_prob = params_.cancel_base_prob
-                           + params_.cancel_distance_mult * distance;
-
-        return uniform_(rng_) < cancel_prob;
+    /// Same rule for a resting order known only by its price (AgentOrders).
+    bool should_cancel(Price price, Price mid_price) {
+        return uniform_(rng_) < cancel_probability(std::abs(price - mid_price));
     }
 
     /**
@@ -137,16 +137,19 @@ public:
     {
         std::vector<OrderId> to_cancel;
         for (const auto& [id, price] : resting_orders) {
-            Price distance = std::abs(price - mid_price);
-            double cancel_prob = params_.cancel_base_prob
-                               + params_.cancel_distance_mult * distance;
-            if (uniform_(rng_) < cancel_prob) {
+            if (should_cancel(price, mid_price)) {
                 to_cancel.push_back(id);
             }
         }
         return to_cancel;
     }
 
+    /// Per-review cancel probability for an order `distance` ticks from mid.
+    [[nodiscard]] double cancel_probability(Price distance) const noexcept {
+        return params_.cancel_base_prob
+             + params_.cancel_distance_mult * static_cast<double>(distance);
+    }
+
     [[nodiscard]] const Parameters& params() const { return params_; }
 
 private:
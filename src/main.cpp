@@ -9,6 +9,16 @@
  *   ./micro_exchange --duration 7200      # 2hr simulation
  *   ./micro_exchange --symbol AAPL        # set the symbol
  *   ./micro_exchange --output results/    # custom output dir
+ *   ./micro_exchange --book array         # tick-indexed ArrayOrderBook backend
+ *   ./micro_exchange --arena huge         # prefaulted huge-page order arena
+ *   ./micro_exchange --duration 86400 --stream-to cols --bar-sec 1
+ *                                         # constant-memory run: series stream to
+ *                                         # column files (1 s bars), no CSVs/analytics
+ *   ./micro_exchange --symbols 256 --threads 8 --cross 5
+ *                                         # 256 cross-excited instruments on 8 cores
+ *   ./micro_exchange --runs 200 --threads 8 --seed 1
+ *                                         # 200 seeded Simulator runs on 8 threads,
+ *                                         # merged into one summary (SimulationBatch)
  *   ./micro_exchange -v                   # verbose
  */
 
@@ -18,14 +28,18 @@
 #include "FeedPublisher.h"
 #include "HawkesProcess.h"
 #include "ZIAgent.h"
-#include "SpreadAnalyzer.h"
-#include "ImpactAnalyzer.h"
+#include "SimulationBatch.h"
+#include "MultiSymbolSimulator.h"
+#include "DataCollector.h"
+#include "OnlineAnalytics.h"
 #include "StylizedFacts.h"
 
 #include <iostream>
 #include <fstream>
 #include <iomanip>
 #include <chrono>
+#include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 #include <numeric>
@@ -33,6 +47,7 @@
 #include <cstring>
 #include <algorithm>
 #include <filesystem>
+#include <type_traits>
 
 using namespace micro_exchange::core;
 using namespace micro_exchange::md;
@@ -49,6 +64,22 @@ struct RunConfig {
     Price       init_mid  = 15000;  // $150.00
     size_t      n_agents  = 10;
     std::string out_dir   = "output";
+    std::string book      = "map";   // "map" (OrderBook) or "array" (ArrayOrderBook)
+    std::string arena     = "heap";  // "heap", "mmap" (prefaulted) or "huge" (+ huge pages)
+    size_t      order_capacity = 65536;
+    std::string quotes    = "change";  // "every", "change" or "conflate"
+    double      quote_slice_us = 0;    // conflate: 0 = one quote per inbound event
+    size_t      depth_levels = 0;      // L2 feed levels per side, 0 = off
+    std::string feed_out;              // stream the compact feed here ("" = off)
+    size_t      runs      = 1;         // > 1: Monte Carlo batch of Simulator runs
+    size_t      threads   = 0;         // batch workers, 0 = one per core
+    uint64_t    seed      = 1;         // batch: run i is seeded seed + i (symbol i, multi-symbol)
+    size_t      symbols   = 1;         // > 1: multi-symbol simulation across --threads workers
+    double      cross     = 0;         // multi-symbol: cross-symbol excitation (cross_alpha)
+    double      slice_sec = 0.1;       // multi-symbol: simulated-time barrier interval
+    std::string stream_to;             // stream series to column files here ("" = in memory)
+    size_t      decimate  = 1;         // streaming: keep one event sample in N
+    double      bar_sec   = 0;         // streaming: 1 s etc. bars instead of event samples
     bool        verbose   = false;
 };
 
@@ -59,9 +90,31 @@ RunConfig parse_args(int argc, char* argv[]) {
         if (arg == "--duration" && i + 1 < argc) cfg.duration = std::stod(argv[++i]);
         else if (arg == "--symbol" && i + 1 < argc) cfg.symbol = argv[++i];
         else if (arg == "--output" && i + 1 < argc) cfg.out_dir = argv[++i];
+        else if (arg == "--book" && i + 1 < argc) cfg.book = argv[++i];
+        else if (arg == "--arena" && i + 1 < argc) cfg.arena = argv[++i];
+        else if (arg == "--order-capacity" && i + 1 < argc) cfg.order_capacity = std::stoull(argv[++i]);
+        else if (arg == "--quotes" && i + 1 < argc) cfg.quotes = argv[++i];
+        else if (arg == "--quote-slice-us" && i + 1 < argc) cfg.quote_slice_us = std::stod(argv[++i]);
+        else if (arg == "--depth" && i + 1 < argc) cfg.depth_levels = std::stoull(argv[++i]);
+        else if (arg == "--feed-out" && i + 1 < argc) cfg.feed_out = argv[++i];
+        else if (arg == "--runs" && i + 1 < argc) cfg.runs = std::stoull(argv[++i]);
+        else if (arg == "--threads" && i + 1 < argc) cfg.threads = std::stoull(argv[++i]);
+        else if (arg == "--seed" && i + 1 < argc) cfg.seed = std::stoull(argv[++i]);
+        else if (arg == "--symbols" && i + 1 < argc) cfg.symbols = std::stoull(argv[++i]);
+        else if (arg == "--cross" && i + 1 < argc) cfg.cross = std::stod(argv[++i]);
+        else if (arg == "--slice" && i + 1 < argc) cfg.slice_sec = std::stod(argv[++i]);
+        else if (arg == "--stream-to" && i + 1 < argc) cfg.stream_to = argv[++i];
+        else if (arg == "--decimate" && i + 1 < argc) cfg.decimate = std::stoull(argv[++i]);
+        else if (arg == "--bar-sec" && i + 1 < argc) cfg.bar_sec = std::stod(argv[++i]);
         else if (arg == "-v" || arg == "--verbose") cfg.verbose = true;
         else if (arg == "--help") {
-            std::cout << "Usage: micro_exchange [--duration SEC] [--symbol SYM] [--output DIR] [-v]\n";
+            std::cout << "Usage: micro_exchange [--duration SEC] [--symbol SYM] [--output DIR]"
+                         " [--book map|array] [--arena heap|mmap|huge]"
+                         " [--order-capacity N] [--quotes every|change|conflate]"
+                         " [--quote-slice-us US] [--depth N] [--feed-out FILE]"
+                         " [--runs N] [--threads T] [--seed S]"
+                         " [--symbols N [--cross A] [--slice SEC]]"
+                         " [--stream-to DIR [--decimate N] [--bar-sec S]] [-v]\n";
             std::exit(0);
         }
     }
@@ -70,7 +123,8 @@ RunConfig parse_args(int argc, char* argv[]) {
 
 // ── Helpers ──
 
-void seed_book(MatchingEngine& engine, const std::string& symbol, Price mid) {
+template <typename Engine>
+void seed_book(Engine& engine, const std::string& symbol, Price mid) {
     // 10 levels each side, 5 orders per level
     // this gives a reasonable starting book so the first few market orders
     // don't just sail through into the void
@@ -129,37 +183,150 @@ void write_spreads_csv(const std::string& path, const std::vector<Price>& spread
     }
 }
 
-// ── Main ──
+// ── Pipeline ──
 
-int main(int argc, char* argv[]) {
-    auto cfg = parse_args(argc, argv);
+// The feed-driven analytics, shared by both reports.
+template <typename Also>
+void report_live(const OnlineAnalytics& live, Also&& also) {
+    auto fmt = [](double v, int prec = 2) {
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(prec) << v;
+        return oss.str();
+    };
+    auto sci = [](double v) {
+        std::ostringstream oss;
+        oss << std::scientific << std::setprecision(3) << v;
+        return oss.str();
+    };
+    const auto spread = live.spread();
+    const auto kyle   = live.kyle();
+    const auto ofi    = live.imbalance();
+
+    also("  Spread Decomposition (Huang-Stoll)");
+    also("  ─────────────────────────────────────────");
+    also("  Quoted spread:      " + fmt(spread.avg_quoted_spread) + " ticks");
+    also("  Effective spread:   " + fmt(spread.avg_effective_spread) + " ticks (median "
+         + fmt(spread.median_effective_spread) + ", p95 " + fmt(spread.p95_effective_spread) + ")");
+    also("  Realized spread:    " + fmt(spread.avg_realized_spread) + " ticks");
+    also("  Price impact:       " + fmt(spread.avg_price_impact) + " ticks");
+    also("  Adverse selection:  " + fmt(spread.adverse_selection_pct) + "%");
+
+    also("");
+    also("  Kyle's Lambda");
+    also("  ─────────────────────────────────────────");
+    also("  lambda:   " + sci(kyle.lambda) + " (ticks per share, signed)");
+    also("  R²:       " + fmt(kyle.r_squared));
+    also("  t-stat:   " + fmt(kyle.t_statistic, 1));
+    also("  N:        " + std::to_string(kyle.num_intervals));
+
+    also("");
+    also("  Order Flow Imbalance (10 s)");
+    also("  ─────────────────────────────────────────");
+    also("  beta:     " + sci(ofi.ofi_beta) + " (bps per share, next interval)");
+    also("  R²:       " + fmt(ofi.ofi_r_squared));
+    also("  t-stat:   " + fmt(ofi.ofi_t_stat, 1));
+    also("  Volume imbalance:   " + fmt(ofi.avg_volume_imbalance) + " avg, "
+         + fmt(ofi.max_volume_imbalance) + " max");
+}
 
-    std::cout << "\n";
-    std::cout << "  ╔══════════════════════════════════════════╗\n";
-    std::cout << "  ║       MicroExchange v1.0.0               ║\n";
-    std::cout << "  ║   CLOB + Market Data + Analytics         ║\n";
-    std::cout << "  ╚══════════════════════════════════════════╝\n\n";
+// --stream-to: the series are on disk as column files, so the report is the
+// engine and feed counters plus what the collector accumulated on the way.
+template <typename Engine>
+int report_streamed(const RunConfig& cfg, Engine& engine, const FeedPublisher& feed,
+                    const OnlineAnalytics& live, const CollectStats& c, size_t n_events,
+                    std::chrono::high_resolution_clock::time_point wall_start) {
+    const double wall_sec = std::chrono::duration<double>(
+        std::chrono::high_resolution_clock::now() - wall_start).count();
+    std::ofstream rpt(cfg.out_dir + "/report.txt");
+    auto also = [&](const std::string& line) {
+        rpt << line << "\n";
+        std::cout << line << "\n";
+    };
+    auto fmt = [](double v) {
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(2) << v;
+        return oss.str();
+    };
 
-    std::cout << "  Symbol:   " << cfg.symbol << "\n";
-    std::cout << "  Duration: " << cfg.duration << " sec\n";
-    std::cout << "  Init mid: " << cfg.init_mid << " ($"
-              << std::fixed << std::setprecision(2) << cfg.init_mid / 100.0 << ")\n";
-    std::cout << "  Agents:   " << cfg.n_agents << "\n\n";
+    std::cout << "  [3/4] Streamed to " << cfg.stream_to << "/ (stylized facts need the in-memory mode)\n\n";
+    const auto stats  = engine.get_stats();
+    const auto fstats = feed.get_stats();
+    also("  ═══════════════════════════════════════════");
+    also("  MicroExchange — Simulation Report (streamed)");
+    also("  ═══════════════════════════════════════════");
+    also("");
+    also("  Total orders:    " + std::to_string(stats.total_orders));
+    also("  Total trades:    " + std::to_string(stats.total_trades));
+    also("  Total volume:    " + std::to_string(stats.total_volume));
+    also("  Feed messages:   " + std::to_string(fstats.total_messages));
+    also("  Wall time:       " + fmt(wall_sec) + " sec");
+    also("  Throughput:      " + fmt(n_events / wall_sec) + " events/sec");
+    also("");
+    also("  Collected (" + std::string(cfg.bar_sec > 0 ? fmt(cfg.bar_sec) + " s bars" :
+                                       "1 in " + std::to_string(std::max<size_t>(1, cfg.decimate)) + " events") + ")");
+    also("  ─────────────────────────────────────────");
+    also("  Samples / bars:  " + std::to_string(c.samples) + " / " + std::to_string(c.bars));
+    also("  Trades:          " + std::to_string(c.trades) + " (peak " + std::to_string(c.peak_pending)
+         + " awaiting the 5 s mid)");
+    also("  VWAP:            " + fmt(c.volume ? c.notional / static_cast<double>(c.volume) : 0));
+    also("  Quoted spread:   " + fmt(c.spread.mean) + " ticks (sd " + fmt(c.spread.stddev()) + ")");
+    also("  Mid change sd:   " + fmt(c.mid_change.stddev()) + " ticks per event");
+    also("");
+    report_live(live, also);
+    also("");
+    also("  Columns in " + cfg.stream_to + "/ (*.col: 16-byte header, then raw values)");
+    also("");
+    return 0;
+}
 
+template <OrderBookLike Book>
+int run(const RunConfig& cfg) {
     fs::create_directories(cfg.out_dir);
 
     auto wall_start = std::chrono::high_resolution_clock::now();
 
     // ── Engine setup ──
-    MatchingEngine engine;
-    engine.add_symbol(cfg.symbol);
-    auto* book = engine.get_book(cfg.symbol);
+    ArenaOptions arena;
+    arena.use_mmap   = cfg.arena != "heap";
+    arena.prefault   = arena.use_mmap;
+    arena.huge_pages = cfg.arena == "huge";
+
+    BasicMatchingEngine<Book> engine;
+    if constexpr (std::is_same_v<Book, ArrayOrderBook>) {
+        // Initial band only — the array book re-centers if the mid drifts out.
+        engine.add_symbol(cfg.symbol, cfg.init_mid - 1024, cfg.init_mid + 1024,
+                          cfg.order_capacity, arena);
+    } else {
+        engine.add_symbol(cfg.symbol, cfg.order_capacity, arena);
+    }
+    const SymbolId sym_id = engine.symbol_id(cfg.symbol);
+    auto* book = engine.get_book(sym_id);
 
     // The OrderBook now supports multi-listener fan-out, so attaching the
     // feed publisher no longer clobbers the engine's internal trade routing.
-    FeedPublisher feed;
+    FeedPublisher::Options feed_opts;
+    feed_opts.quote_mode = cfg.quotes == "every"    ? FeedPublisher::QuoteMode::EveryEvent
+                         : cfg.quotes == "conflate" ? FeedPublisher::QuoteMode::Conflated
+                                                    : FeedPublisher::QuoteMode::ChangeOnly;
+    feed_opts.conflation_ns = static_cast<uint64_t>(cfg.quote_slice_us * 1e3);
+    feed_opts.depth_levels  = cfg.depth_levels;
+    feed_opts.retain_messages = false;   // counted live; streamed if --feed-out
+    FeedPublisher feed(feed_opts);
+    std::unique_ptr<FeedWriter> feed_writer;
+    if (!cfg.feed_out.empty()) {
+        feed_writer = std::make_unique<FeedWriter>(cfg.feed_out);
+        feed.set_writer(feed_writer.get());
+    }
     feed.attach(*book);
 
+    // Spread, impact and OFI analytics follow the feed as it is published,
+    // stamped with the simulated time of the event being matched.
+    double current_event_time = 0.0;       // updated in the main loop
+    OnlineAnalytics::Options live_opts;
+    live_opts.initial_mid = cfg.init_mid;
+    OnlineAnalytics live(live_opts);
+    feed.set_callback([&](const FeedMessage& m) { live.on_message(m, current_event_time); });
+
     // ── Agents ──
     std::vector<ZIAgent> agents;
     for (size_t i = 0; i < cfg.n_agents; ++i) {
@@ -175,111 +342,96 @@ int main(int argc, char* argv[]) {
 
     seed_book(engine, cfg.symbol, cfg.init_mid);
 
-    // ── Generate events ──
+    // ── Event stream ──
     HawkesProcess::Parameters hp;
     hp.mu = 50.0;
     hp.alpha = 35.0;
     hp.beta = 50.0;
     HawkesProcess hawkes(hp, 12345);
-    auto events = hawkes.generate_sided(cfg.duration);
+    const auto expected = static_cast<size_t>(hp.mu / (1 - hp.branching_ratio()) * cfg.duration);
 
-    std::cout << "  [1/4] Generated " << events.size() << " events (Hawkes n="
+    std::cout << "  [1/4] Hawkes stream: ~" << expected << " events expected (n="
               << std::fixed << std::setprecision(2) << hp.alpha / hp.beta << ")\n";
 
     // ── Run matching ──
+    // In memory, every trade and per-event mid/spread is kept for the CSVs
+    // and the stylized facts. With --stream-to, a DataCollector writes them
+    // to column files as they happen and nothing accumulates.
+    const bool streaming = !cfg.stream_to.empty();
     std::vector<Trade> trades;
-    std::vector<double> trade_times;       // simulated wall-clock seconds
-    trades.reserve(events.size() / 3);
-    trade_times.reserve(events.size() / 3);
-
     std::vector<Price> midprices;
     std::vector<Price> spreads;
     std::vector<double> mid_times;
-    midprices.reserve(events.size());
-    spreads.reserve(events.size());
-    mid_times.reserve(events.size());
+    std::optional<ColumnSink> columns;
+    std::optional<DataCollector<ColumnSink>> collector;
+    if (streaming) {
+        CollectOptions co;
+        co.dir      = cfg.stream_to;
+        co.decimate = cfg.decimate;
+        co.bar_sec  = cfg.bar_sec;
+        columns.emplace(co.dir);
+        collector.emplace(co, *columns);
+    } else {
+        trades.reserve(expected / 3);
+        midprices.reserve(expected);
+        spreads.reserve(expected);
+        mid_times.reserve(expected);
+    }
 
-    double current_event_time = 0.0;       // updated in the main loop
+    Price  mid_before = cfg.init_mid;
     engine.set_trade_callback([&](const Trade& t) {
+        if (collector) return collector->trade(current_event_time, t, mid_before);
         trades.push_back(t);
-        trade_times.push_back(current_event_time);
     });
 
     OrderId next_id = 10000;
-    size_t progress_step = events.size() / 10;
-
-    for (size_t i = 0; i < events.size(); ++i) {
-        if (progress_step > 0 && i % progress_step == 0 && i > 0) {
-            std::cout << "  [2/4] Processing... "
-                      << (i * 100 / events.size()) << "%\r" << std::flush;
+    size_t n_events = 0;
+    int progress = 0;
+
+    while (auto event = hawkes.next_sided(cfg.duration)) {
+        current_event_time = event->timestamp;
+        const int pct = static_cast<int>(current_event_time * 10 / cfg.duration) * 10;
+        if (pct > progress) {
+            progress = pct;
+            std::cout << "  [2/4] Processing... " << pct << "%\r" << std::flush;
         }
 
-        current_event_time = events[i].timestamp;
-
         auto mid = book->midprice().value_or(cfg.init_mid);
         auto sprd = book->spread().value_or(2);
-        midprices.push_back(mid);
-        spreads.push_back(sprd);
-        mid_times.push_back(current_event_time);
+        if (collector) {
+            collector->event(current_event_time, mid, sprd);
+        } else {
+            midprices.push_back(mid);
+            spreads.push_back(sprd);
+            mid_times.push_back(current_event_time);
+        }
+        mid_before = mid;
 
         size_t agent_idx = next_id % cfg.n_agents;
         auto req = agents[agent_idx].generate_order(
-            mid, sprd, events[i].is_buy, next_id++, cfg.symbol.c_str());
+            mid, sprd, event->is_buy, next_id++, cfg.symbol.c_str());
+        req.symbol_id = sym_id;
         engine.submit_order(req);
+        ++n_events;
     }
 
-    std::cout << "  [2/4] Matching complete: " << trades.size() << " trades from "
-              << events.size() << " orders\n";
-
-    // ── Analytics ──
-    std::cout << "  [3/4] Computing analytics...\n";
-
-    // Helper: lookup mid at a given simulated time using sorted mid_times
-    auto mid_at_time = [&](double t) -> Price {
-        if (mid_times.empty()) return cfg.init_mid;
-        auto it = std::lower_bound(mid_times.begin(), mid_times.end(), t);
-        if (it == mid_times.begin()) return midprices.front();
-        if (it == mid_times.end())   return midprices.back();
-        size_t idx = static_cast<size_t>(std::distance(mid_times.begin(), it));
-        return midprices[idx];
-    };
+    std::cout << "  [2/4] Matching complete: " << engine.get_stats().total_trades
+              << " trades from " << n_events << " orders\n";
 
-    // Spread decomposition (Huang-Stoll). 5-second post-trade reversion window.
-    SpreadAnalyzer spread_analyzer;
-    std::vector<SpreadAnalyzer::TradeInput> spread_inputs;
-
-    for (size_t i = 0; i < trades.size(); ++i) {
-        SpreadAnalyzer::TradeInput ti;
-        ti.trade_price = trades[i].price;
-        ti.mid_before  = mid_at_time(trade_times[i]);
-        ti.mid_after   = mid_at_time(trade_times[i] + 5.0);
-        ti.volume      = trades[i].quantity;
-        ti.aggressor   = trades[i].aggressor;
-        spread_inputs.push_back(ti);
+    feed.flush();   // release the last conflated quote
+    live.finish();
+    if (feed_writer && !feed_writer->close()) {
+        std::cerr << "  warning: feed write to " << cfg.feed_out << " failed\n";
     }
 
-    auto spread_result = spread_analyzer.compute(spread_inputs, spreads);
-
-    // Kyle's lambda — properly time-indexed now
-    ImpactAnalyzer impact_analyzer;
-    std::vector<ImpactAnalyzer::TradeInput> impact_inputs;
-    std::vector<std::pair<double, Price>> timed_mids;
-    impact_inputs.reserve(trades.size());
-    timed_mids.reserve(midprices.size());
-
-    for (size_t i = 0; i < trades.size(); ++i) {
-        ImpactAnalyzer::TradeInput ti;
-        ti.timestamp = trade_times[i];
-        ti.price     = trades[i].price;
-        ti.volume    = trades[i].quantity;
-        ti.aggressor = trades[i].aggressor;
-        impact_inputs.push_back(ti);
-    }
-    for (size_t i = 0; i < midprices.size(); ++i) {
-        timed_mids.push_back({mid_times[i], midprices[i]});
+    if (collector) {
+        collector->finish();
+        if (!columns->close()) std::cerr << "  warning: column write to " << cfg.stream_to << " failed\n";
+        return report_streamed(cfg, engine, feed, live, collector->stats(), n_events, wall_start);
     }
 
-    auto kyle_result = impact_analyzer.estimate_kyle_lambda(impact_inputs, timed_mids, 5.0);
+    // ── Analytics ──
+    std::cout << "  [3/4] Computing analytics...\n";
 
     // Stylized facts — sampled on 1-second clock-time bars (log returns),
     // not per-event, to avoid the zero-inflated integer-tick artifact.
@@ -316,13 +468,25 @@ int main(int argc, char* argv[]) {
         also(rpt, "  Total trades:    " + std::to_string(stats.total_trades));
         also(rpt, "  Total volume:    " + std::to_string(stats.total_volume));
         also(rpt, "  Active orders:   " + std::to_string(stats.active_orders));
+        also(rpt, "  Order arena:     " + std::to_string(stats.arena_allocated) + " / "
+                  + std::to_string(stats.arena_capacity) + " slots, "
+                  + std::to_string(stats.arena_slabs) + " slab(s), "
+                  + std::to_string(stats.arena_bytes >> 20) + " MiB"
+                  + (stats.arena_huge_slabs ? " (huge pages)" : ""));
 
         auto fstats = feed.get_stats();
         also(rpt, "  Feed messages:   " + std::to_string(fstats.total_messages)
                   + " (A=" + std::to_string(fstats.add_count)
                   + " T=" + std::to_string(fstats.trade_count)
                   + " D=" + std::to_string(fstats.delete_count)
-                  + " Q=" + std::to_string(fstats.quote_count) + ")");
+                  + " Q=" + std::to_string(fstats.quote_count)
+                  + " L=" + std::to_string(fstats.level_update_count) + ")");
+        if (feed_writer) {
+            also(rpt, "  Feed file:       " + cfg.feed_out + " ("
+                      + std::to_string(feed_writer->stats().bytes >> 10) + " KiB compact)");
+        }
+        also(rpt, "  Quotes held:     " + std::to_string(fstats.quotes_suppressed) + " unchanged, "
+                  + std::to_string(fstats.quotes_conflated) + " conflated (" + cfg.quotes + ")");
 
         {
             std::ostringstream oss;
@@ -331,44 +495,18 @@ int main(int argc, char* argv[]) {
         }
         {
             std::ostringstream oss;
-            oss << std::fixed << std::setprecision(0) << events.size() / wall_sec;
+            oss << std::fixed << std::setprecision(0) << n_events / wall_sec;
             also(rpt, "  Throughput:      " + oss.str() + " events/sec");
         }
 
         also(rpt, "");
-        also(rpt, "  Spread Decomposition (Huang-Stoll)");
-        also(rpt, "  ─────────────────────────────────────────");
+        report_live(live, [&](const std::string& line) { also(rpt, line); });
 
         auto fmt = [](double v) {
             std::ostringstream oss;
             oss << std::fixed << std::setprecision(2) << v;
             return oss.str();
         };
-
-        also(rpt, "  Quoted spread:      " + fmt(spread_result.avg_quoted_spread) + " ticks");
-        also(rpt, "  Effective spread:   " + fmt(spread_result.avg_effective_spread) + " ticks");
-        also(rpt, "  Realized spread:    " + fmt(spread_result.avg_realized_spread) + " ticks");
-        also(rpt, "  Price impact:       " + fmt(spread_result.avg_price_impact) + " ticks");
-        also(rpt, "  Adverse selection:  " + fmt(spread_result.adverse_selection_pct) + "%");
-
-        also(rpt, "");
-        also(rpt, "  Kyle's Lambda");
-        also(rpt, "  ─────────────────────────────────────────");
-        {
-            std::ostringstream oss;
-            oss << std::scientific << std::setprecision(3) << kyle_result.lambda;
-            also(rpt, "  lambda:   " + oss.str() + " (ticks per share, signed)");
-        }
-        also(rpt, "  R²:       " + fmt(kyle_result.r_squared));
-
-        {
-            std::ostringstream oss;
-            oss << std::fixed << std::setprecision(1) << kyle_result.t_statistic;
-            also(rpt, "  t-stat:   " + oss.str());
-        }
-
-        also(rpt, "  N:        " + std::to_string(kyle_result.num_intervals));
-
         also(rpt, "");
         also(rpt, "  Stylized Facts");
         also(rpt, "  ─────────────────────────────────────────");
@@ -397,3 +535,179 @@ int main(int argc, char* argv[]) {
 
     return 0;
 }
+
+// ── Monte Carlo batch ──
+
+// --runs N > 1: N independent Simulator runs (its agent model, not the
+// per-agent mix run() above uses) on a thread pool. Only per-run summaries
+// are kept; they go to batch_runs.csv and are merged into batch_report.txt.
+// The Simulator side of the command line (batch and multi-symbol modes).
+Simulator::Config simulator_config(const RunConfig& cfg) {
+    Simulator::Config sc;
+    sc.symbol         = cfg.symbol;
+    sc.duration       = cfg.duration;
+    sc.init_price     = cfg.init_mid;
+    sc.num_agents     = cfg.n_agents;
+    sc.book_backend   = cfg.book == "array" ? Simulator::BookBackend::Array
+                                            : Simulator::BookBackend::Map;
+    sc.order_capacity = cfg.order_capacity;
+    sc.arena.use_mmap   = cfg.arena != "heap";
+    sc.arena.prefault   = sc.arena.use_mmap;
+    sc.arena.huge_pages = cfg.arena == "huge";
+    return sc;
+}
+
+int run_batch(const RunConfig& cfg) {
+    fs::create_directories(cfg.out_dir);
+    const Simulator::Config sc = simulator_config(cfg);
+
+    SimulationBatch::Options opts;
+    opts.runs      = cfg.runs;
+    opts.threads   = cfg.threads;
+    opts.base_seed = cfg.seed;
+
+    std::ofstream csv(cfg.out_dir + "/batch_runs.csv");
+    csv << "run,seed,orders,trades,volume,mean_spread,mid_change_sd,vwap,buy_aggressor,final_mid,wall_sec\n";
+    size_t done = 0;
+    auto summary = SimulationBatch(sc, opts).run([&](const RunSummary& r) {
+        csv << r.run << "," << r.seed << "," << r.orders << "," << r.trades << "," << r.volume << ","
+            << r.mean_spread << "," << r.mid_change_sd << "," << r.vwap << ","
+            << r.buy_aggressor << "," << r.final_mid << "," << r.wall_time_sec << "\n";
+        std::cout << "  Runs complete: " << ++done << "/" << cfg.runs << "\r" << std::flush;
+    });
+
+    std::ofstream rpt(cfg.out_dir + "/batch_report.txt");
+    auto also = [&](const std::string& line) {
+        rpt << line << "\n";
+        std::cout << line << "\n";
+    };
+    auto fmt = [](double v, int prec = 2) {
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(prec) << v;
+        return oss.str();
+    };
+    auto row = [&](const std::string& name, const StreamingStat& s) {
+        also("  " + name + fmt(s.mean) + " ± " + fmt(s.stddev()) + "  [" + fmt(s.min) + ", " + fmt(s.max) + "]");
+    };
+
+    also("\n  ═══════════════════════════════════════════");
+    also("  MicroExchange — Monte Carlo Batch Report");
+    also("  ═══════════════════════════════════════════");
+    also("");
+    also("  Runs:            " + std::to_string(summary.runs) + " (seeds " + std::to_string(cfg.seed)
+         + ".." + std::to_string(cfg.seed + cfg.runs - 1) + ")");
+    also("  Threads:         " + std::to_string(summary.threads));
+    also("  Total orders:    " + std::to_string(summary.orders));
+    also("  Total trades:    " + std::to_string(summary.trades));
+    also("  Total volume:    " + std::to_string(summary.volume));
+    also("  Wall time:       " + fmt(summary.elapsed_sec) + " sec (" + fmt(summary.run_time_sec)
+         + " sec summed over runs, " + fmt(summary.run_time_sec / std::max(summary.elapsed_sec, 1e-9), 1)
+         + "x)");
+    also("");
+    also("  Across runs      mean ± sd  [min, max]");
+    also("  ─────────────────────────────────────────");
+    row("Trades / run:    ", summary.trades_per_run);
+    row("Quoted spread:   ", summary.mean_spread);
+    row("Mid change sd:   ", summary.mid_change_sd);
+    row("VWAP:            ", summary.vwap);
+    row("Buy-initiated:   ", summary.buy_aggressor);
+    row("Final mid:       ", summary.final_mid);
+    also("");
+    also("  Output files:");
+    also("    " + cfg.out_dir + "/batch_runs.csv");
+    also("    " + cfg.out_dir + "/batch_report.txt");
+    also("");
+    return 0;
+}
+
+int run_multi(const RunConfig& cfg) {
+    fs::create_directories(cfg.out_dir);
+
+    MultiSymbolSimulator::Config mc;
+    mc.base        = simulator_config(cfg);
+    mc.symbols     = cfg.symbols;
+    mc.threads     = cfg.threads;
+    mc.seed        = cfg.seed;
+    mc.slice_sec   = cfg.slice_sec;
+    mc.cross_alpha = cfg.cross;
+
+    std::cout << "  Simulating " << cfg.symbols << " symbols x " << cfg.duration << " s...\n" << std::flush;
+    const auto res = MultiSymbolSimulator(mc).run();
+
+    std::ofstream csv(cfg.out_dir + "/multi_symbols.csv");
+    csv << "symbol,thread,events,trades,volume,cancels,peak_live_orders,mean_spread,mid_change_sd,final_mid,busy_sec,events_per_sec\n";
+    StreamingStat per_symbol_rate;
+    for (const auto& r : res.symbols) {
+        csv << r.symbol << "," << r.thread << "," << r.events << "," << r.trades << "," << r.volume << ","
+            << r.cancels << "," << r.peak_live_orders << "," << r.mean_spread << "," << r.mid_change_sd << ","
+            << r.final_mid << "," << r.busy_sec << "," << r.events_per_sec() << "\n";
+        per_symbol_rate.add(r.events_per_sec());
+    }
+
+    std::ofstream rpt(cfg.out_dir + "/multi_report.txt");
+    auto also = [&](const std::string& line) {
+        rpt << line << "\n";
+        std::cout << line << "\n";
+    };
+    auto fmt = [](double v, int prec = 2) {
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(prec) << v;
+        return oss.str();
+    };
+
+    also("\n  ═══════════════════════════════════════════");
+    also("  MicroExchange — Multi-Symbol Report");
+    also("  ═══════════════════════════════════════════");
+    also("");
+    also("  Symbols:         " + std::to_string(res.symbols.size()) + " (seeds " + std::to_string(cfg.seed)
+         + ".." + std::to_string(cfg.seed + cfg.symbols - 1) + ", cross_alpha " + fmt(cfg.cross) + ")");
+    also("  Threads:         " + std::to_string(res.threads) + " (" + std::to_string(res.slices)
+         + " barriers, every " + fmt(cfg.slice_sec, 3) + " s simulated)");
+    also("  Total events:    " + std::to_string(res.events));
+    also("  Total trades:    " + std::to_string(res.trades));
+    also("  Total cancels:   " + std::to_string(res.cancels));
+    also("  Total volume:    " + std::to_string(res.volume));
+    also("  Wall time:       " + fmt(res.elapsed_sec) + " sec (" + fmt(res.barrier_wait_sec)
+         + " sec waiting at barriers, summed over threads)");
+    also("  Throughput:      " + fmt(res.events_per_sec(), 0) + " events/sec aggregate");
+    also("  Per symbol:      " + fmt(per_symbol_rate.mean, 0) + " events/sec of busy time (min "
+         + fmt(per_symbol_rate.min, 0) + ", max " + fmt(per_symbol_rate.max, 0) + ")");
+    also("");
+    also("  Output files:");
+    also("    " + cfg.out_dir + "/multi_symbols.csv");
+    also("    " + cfg.out_dir + "/multi_report.txt");
+    also("");
+    return 0;
+}
+
+// ── Main ──
+
+int main(int argc, char* argv[]) {
+    auto cfg = parse_args(argc, argv);
+
+    std::cout << "\n";
+    std::cout << "  ╔══════════════════════════════════════════╗\n";
+    std::cout << "  ║       MicroExchange v1.0.0               ║\n";
+    std::cout << "  ║   CLOB + Market Data + Analytics         ║\n";
+    std::cout << "  ╚══════════════════════════════════════════╝\n\n";
+
+    std::cout << "  Symbol:   " << cfg.symbol << "\n";
+    std::cout << "  Duration: " << cfg.duration << " sec\n";
+    std::cout << "  Init mid: " << cfg.init_mid << " ($"
+              << std::fixed << std::setprecision(2) << cfg.init_mid / 100.0 << ")\n";
+    std::cout << "  Agents:   " << cfg.n_agents << "\n";
+    std::cout << "  Book:     " << cfg.book << "\n\n";
+
+    if (cfg.arena != "heap" && cfg.arena != "mmap" && cfg.arena != "huge") {
+        std::cerr << "unknown --arena '" << cfg.arena << "' (expected heap|mmap|huge)\n";
+        return 1;
+    }
+    if (cfg.book != "map" && cfg.book != "array") {
+        std::cerr << "unknown --book '" << cfg.book << "' (expected map|array)\n";
+        return 1;
+    }
+    if (cfg.symbols > 1) return run_multi(cfg);
+    if (cfg.runs > 1) return run_batch(cfg);
+    if (cfg.book == "array") return run<ArrayOrderBook>(cfg);
+    return run<OrderBook>(cfg);
+}